@@ -1755,9 +1755,21 @@ bool _File::file_exists(const String &p_name) const {
 	return FileAccess::exists(p_name);
 }
 
-void _File::store_var(const Variant &p_var) {
+void _File::store_var(const Variant &p_var, bool p_compact) {
 
 	ERR_FAIL_COND(!f);
+
+	if (p_compact) {
+		Vector<uint8_t> buff;
+		int len = 0;
+		Error err = encode_variant_compact(p_var, buff, len);
+		ERR_FAIL_COND(err != OK);
+
+		store_32(len);
+		f->store_buffer(buff.ptr(), len);
+		return;
+	}
+
 	int len;
 	Error err = encode_variant(p_var, NULL, len);
 	ERR_FAIL_COND(err != OK);
@@ -1837,7 +1849,7 @@ void _File::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("store_buffer", "buffer"), &_File::store_buffer);
 	ClassDB::bind_method(D_METHOD("store_line", "line"), &_File::store_line);
 	ClassDB::bind_method(D_METHOD("store_string", "string"), &_File::store_string);
-	ClassDB::bind_method(D_METHOD("store_var", "value"), &_File::store_var);
+	ClassDB::bind_method(D_METHOD("store_var", "value", "compact"), &_File::store_var, DEFVAL(false));
 
 	ClassDB::bind_method(D_METHOD("store_pascal_string", "string"), &_File::store_pascal_string);
 	ClassDB::bind_method(D_METHOD("get_pascal_string"), &_File::get_pascal_string);
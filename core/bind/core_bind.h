@@ -462,7 +462,7 @@ public:
 
 	void store_buffer(const PoolVector<uint8_t> &p_buffer); ///< store an array of bytes
 
-	void store_var(const Variant &p_var);
+	void store_var(const Variant &p_var, bool p_compact = false);
 
 	bool file_exists(const String &p_name) const; ///< return true if a file exists
 
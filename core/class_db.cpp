@@ -522,6 +522,24 @@ Object *ClassDB::instance(const StringName &p_class) {
 
 	return ti->creation_func();
 }
+Object *(*ClassDB::get_creation_func(const StringName &p_class, StringName *r_class))() {
+
+	OBJTYPE_RLOCK;
+
+	ClassInfo *ti = classes.getptr(p_class);
+	if (!ti || ti->disabled || !ti->creation_func) {
+		if (compat_classes.has(p_class)) {
+			ti = classes.getptr(compat_classes[p_class]);
+		}
+	}
+	if (!ti || ti->disabled || !ti->creation_func)
+		return NULL;
+
+	if (r_class)
+		*r_class = ti->name;
+	return ti->creation_func;
+}
+
 bool ClassDB::can_instance(const StringName &p_class) {
 
 	OBJTYPE_RLOCK;
@@ -1147,6 +1165,20 @@ StringName ClassDB::get_property_setter(StringName p_class, const StringName p_p
 	return StringName();
 }
 
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
+
+	ClassInfo *check = classes.getptr(p_class);
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg)
+			return psg;
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 StringName ClassDB::get_property_getter(StringName p_class, const StringName p_property) {
 
 	ClassInfo *type = classes.getptr(p_class);
@@ -114,9 +114,9 @@ public:
 
 		APIType api;
 		ClassInfo *inherits_ptr;
-		HashMap<StringName, MethodBind *, StringNameHasher> method_map;
-		HashMap<StringName, int, StringNameHasher> constant_map;
-		HashMap<StringName, MethodInfo, StringNameHasher> signal_map;
+		SwissHashMap<StringName, MethodBind *, StringNameHasher> method_map;
+		SwissHashMap<StringName, int, StringNameHasher> constant_map;
+		SwissHashMap<StringName, MethodInfo, StringNameHasher> signal_map;
 		List<PropertyInfo> property_list;
 #ifdef DEBUG_METHODS_ENABLED
 		HashMap<StringName, List<StringName> > enum_map;
@@ -126,7 +126,7 @@ public:
 		List<MethodInfo> virtual_methods;
 		StringName category;
 #endif
-		HashMap<StringName, PropertySetGet, StringNameHasher> property_setget;
+		SwissHashMap<StringName, PropertySetGet, StringNameHasher> property_setget;
 
 		StringName inherits;
 		StringName name;
@@ -214,6 +214,8 @@ public:
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
+	// the function instance() would call, for callers that create many objects of one class; r_class is set to the class it creates
+	static Object *(*get_creation_func(const StringName &p_class, StringName *r_class = NULL))();
 	static APIType get_api_type(const StringName &p_class);
 
 	static uint64_t get_api_hash(APIType p_api);
@@ -329,6 +331,7 @@ public:
 	static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
 	static StringName get_property_setter(StringName p_class, const StringName p_property);
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
 	static StringName get_property_getter(StringName p_class, const StringName p_property);
 
 	static bool has_method(StringName p_class, StringName p_method, bool p_no_inheritance = false);
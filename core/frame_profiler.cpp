@@ -0,0 +1,380 @@
+/*************************************************************************/
+/*  frame_profiler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "frame_profiler.h"
+
+#include "map.h"
+#include "os/file_access.h"
+#include "os/os.h"
+#include "safe_refcount.h"
+#include "script_language.h"
+
+FrameProfiler *FrameProfiler::singleton = NULL;
+
+FrameProfiler *FrameProfiler::get_singleton() {
+
+	return singleton;
+}
+
+// the buffer of the calling thread, only valid while generation matches the current profiler
+static thread_local FrameProfiler::ThreadBuffer *thread_buffer = NULL;
+static thread_local uint32_t thread_generation = 0;
+static uint32_t generation = 0;
+
+FrameProfiler::ThreadBuffer *FrameProfiler::_get_thread_buffer() {
+
+	if (thread_generation != generation) {
+		thread_buffer = _register_thread();
+		thread_generation = generation;
+	}
+
+	return thread_buffer;
+}
+
+FrameProfiler::ThreadBuffer *FrameProfiler::_register_thread() {
+
+	mutex->lock();
+
+	ThreadBuffer *buffer = NULL;
+	for (uint32_t i = 0; i < thread_count; i++) {
+		if (threads[i]->free) {
+			buffer = threads[i];
+			break;
+		}
+	}
+
+	if (!buffer && thread_count < MAX_THREADS) {
+
+		buffer = memnew(ThreadBuffer);
+		buffer->index = thread_count;
+		buffer->write = 0;
+		buffer->read = 0;
+
+		threads[thread_count] = buffer;
+		atomic_increment(&thread_count);
+	}
+
+	if (buffer) {
+
+		buffer->thread_id = Thread::get_caller_id();
+		buffer->exited = 0;
+		buffer->free = false;
+		buffer->depth = 0;
+		for (int i = 0; i <= MAX_DEPTH; i++) {
+			buffer->child_time[i] = 0;
+		}
+	}
+
+	mutex->unlock();
+
+	return buffer;
+}
+
+void FrameProfiler::thread_exit() {
+
+	if (singleton && thread_generation == generation && thread_buffer) {
+		// the events pushed so far are still drained by the main thread, full barrier
+		atomic_increment(&thread_buffer->exited);
+	}
+
+	thread_buffer = NULL;
+	thread_generation = 0;
+}
+
+void FrameProfiler::_free_exited(ThreadBuffer *p_buffer) {
+
+	mutex->lock();
+	p_buffer->free = true;
+	mutex->unlock();
+}
+
+FrameProfiler::ThreadBuffer *FrameProfiler::_begin(uint64_t &r_begin) {
+
+	ThreadBuffer *buffer = _get_thread_buffer();
+	if (!buffer || buffer->depth >= MAX_DEPTH)
+		return NULL;
+
+	buffer->depth++;
+	r_begin = OS::get_singleton()->get_ticks_usec();
+	return buffer;
+}
+
+void FrameProfiler::_end(ThreadBuffer *p_buffer, const char *p_name, uint64_t p_begin) {
+
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+	p_buffer->depth--;
+	_push(p_buffer, p_name, p_begin, end, p_buffer->depth);
+}
+
+void FrameProfiler::_add_event(const char *p_name, uint64_t p_begin, uint64_t p_end) {
+
+	ThreadBuffer *buffer = _get_thread_buffer();
+	if (buffer && buffer->depth < MAX_DEPTH) {
+		_push(buffer, p_name, p_begin, p_end, buffer->depth);
+	}
+}
+
+void FrameProfiler::_push(ThreadBuffer *p_buffer, const char *p_name, uint64_t p_begin, uint64_t p_end, uint32_t p_depth) {
+
+	Event &e = p_buffer->events[p_buffer->write & (THREAD_BUFFER_SIZE - 1)];
+	e.name = p_name;
+	e.begin = p_begin;
+	e.end = p_end;
+	e.depth = p_depth;
+
+	// publishes the event to the reader, full barrier
+	atomic_increment(&p_buffer->write);
+}
+
+void FrameProfiler::_update_active() {
+
+	active = streaming || (capturing && !capture_full);
+}
+
+void FrameProfiler::set_streaming(bool p_enable) {
+
+	streaming = p_enable;
+	_update_active();
+}
+
+bool FrameProfiler::is_streaming() const {
+
+	return streaming;
+}
+
+void FrameProfiler::start_capture() {
+
+	capture.clear();
+	capture_full = false;
+	capturing = true;
+	_update_active();
+}
+
+void FrameProfiler::stop_capture() {
+
+	capturing = false;
+	_update_active();
+}
+
+bool FrameProfiler::is_capturing() const {
+
+	return capturing;
+}
+
+int FrameProfiler::get_capture_event_count() const {
+
+	return capture.size();
+}
+
+uint64_t FrameProfiler::get_dropped_event_count() const {
+
+	return dropped_events;
+}
+
+void FrameProfiler::frame_end(uint64_t p_frame_begin) {
+
+	if (!active) {
+		// nothing is read, buffers of ended threads can be reused right away
+		uint32_t count = atomic_add(&thread_count, 0);
+		for (uint32_t i = 0; i < count; i++) {
+			ThreadBuffer *b = threads[i];
+			if (!b->free && atomic_add(&b->exited, 0)) {
+				b->read = b->write;
+				_free_exited(b);
+			}
+		}
+		return;
+	}
+
+	ThreadBuffer *main_buffer = _get_thread_buffer();
+	if (main_buffer) {
+		_push(main_buffer, "main/frame", p_frame_begin, OS::get_singleton()->get_ticks_usec(), main_buffer->depth);
+	}
+
+	Map<String, uint64_t> self_times;
+
+	uint32_t count = atomic_add(&thread_count, 0);
+	for (uint32_t i = 0; i < count; i++) {
+
+		ThreadBuffer *b = threads[i];
+		if (b->free)
+			continue;
+
+		// read before write, so an ended thread has pushed everything up to it
+		bool exited = atomic_add(&b->exited, 0);
+		uint32_t write = atomic_add(&b->write, 0);
+
+		for (; b->read != write; b->read++) {
+
+			if (write - b->read > THREAD_BUFFER_SIZE) {
+				// the owning thread lapped the reader, these events are gone
+				dropped_events += write - b->read - THREAD_BUFFER_SIZE;
+				b->read = write - THREAD_BUFFER_SIZE;
+			}
+
+			Event e = b->events[b->read & (THREAD_BUFFER_SIZE - 1)];
+
+			if (atomic_add(&b->write, 0) - b->read > THREAD_BUFFER_SIZE) {
+				// overwritten while copying
+				dropped_events++;
+				continue;
+			}
+
+			uint64_t time = e.end - e.begin;
+			uint64_t children = b->child_time[e.depth + 1];
+			b->child_time[e.depth + 1] = 0;
+			b->child_time[e.depth] += time;
+
+			if (streaming) {
+				self_times[e.name] += time > children ? time - children : 0;
+			}
+
+			if (capturing && !capture_full) {
+
+				if (capture.size() >= MAX_CAPTURE_EVENTS) {
+					WARN_PRINT("Frame profiler capture is full, further events are ignored.");
+					capture_full = true;
+					_update_active();
+					continue;
+				}
+
+				CaptureEvent ce;
+				ce.name = e.name;
+				ce.begin = e.begin;
+				ce.end = e.end;
+				ce.thread = b->index;
+				capture.push_back(ce);
+			}
+		}
+
+		if (exited) {
+			_free_exited(b);
+		}
+	}
+
+	if (!streaming || !ScriptDebugger::get_singleton() || self_times.empty())
+		return;
+
+	// names are sorted, so each subsystem forms a contiguous run
+	String category;
+	Array values;
+	for (Map<String, uint64_t>::Element *E = self_times.front(); E; E = E->next()) {
+
+		int slash = E->key().find("/");
+		String subsystem = slash == -1 ? String("engine") : E->key().substr(0, slash);
+		String item = E->key().substr(slash + 1, E->key().length());
+
+		if (subsystem != category) {
+			if (values.size()) {
+				ScriptDebugger::get_singleton()->add_profiling_frame_data("engine_" + category, values);
+			}
+			category = subsystem;
+			values = Array();
+		}
+
+		values.push_back(item);
+		values.push_back(USEC_TO_SEC(E->get()));
+	}
+
+	if (values.size()) {
+		ScriptDebugger::get_singleton()->add_profiling_frame_data("engine_" + category, values);
+	}
+}
+
+Error FrameProfiler::save_capture(const String &p_path) const {
+
+	Error err;
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_EXPLAIN("Can't open file for writing: " + p_path);
+	ERR_FAIL_COND_V(!f, err);
+
+	uint64_t origin = capture.size() ? capture[0].begin : 0;
+	for (int i = 1; i < capture.size(); i++) {
+		origin = MIN(origin, capture[i].begin);
+	}
+
+	f->store_string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	uint32_t count = thread_count;
+	for (uint32_t i = 0; i < count; i++) {
+
+		String name = threads[i]->thread_id == Thread::get_main_id() ? String("Main Thread") : "Thread " + itos(i);
+		f->store_string("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + itos(i) + ",\"args\":{\"name\":\"" + name + "\"}},\n");
+	}
+
+	for (int i = 0; i < capture.size(); i++) {
+
+		const CaptureEvent &e = capture[i];
+		String name = String(e.name).json_escape();
+		int slash = name.find("/");
+		String cat = slash == -1 ? String("engine") : name.substr(0, slash);
+
+		String line = "{\"name\":\"" + name + "\",\"cat\":\"" + cat + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + itos(e.thread);
+		line += ",\"ts\":" + itos(e.begin - origin) + ",\"dur\":" + itos(e.end - e.begin) + "}";
+		if (i < capture.size() - 1)
+			line += ",";
+		f->store_string(line + "\n");
+	}
+
+	f->store_string("]}\n");
+
+	f->close();
+	memdelete(f);
+
+	return OK;
+}
+
+FrameProfiler::FrameProfiler() {
+
+	ERR_FAIL_COND(singleton != NULL);
+	singleton = this;
+
+	thread_count = 0;
+	mutex = Mutex::create();
+	generation++; // buffers of a previous profiler are gone
+
+	active = false;
+	streaming = false;
+	capturing = false;
+	capture_full = false;
+	dropped_events = 0;
+}
+
+FrameProfiler::~FrameProfiler() {
+
+	singleton = NULL;
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		memdelete(threads[i]);
+	}
+
+	memdelete(mutex);
+}
@@ -0,0 +1,172 @@
+/*************************************************************************/
+/*  frame_profiler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "os/mutex.h"
+#include "os/thread.h"
+#include "typedefs.h"
+#include "vector.h"
+
+/**
+ * Low overhead CPU profiler for engine code.
+ *
+ * Scopes are named with static strings of the form "subsystem/item" and
+ * recorded into a ring buffer owned by the calling thread, so recording
+ * never takes a lock. The buffer is found through thread local storage and
+ * handed to another thread once its owner ended and it was drained. Once per frame the main thread drains all buffers,
+ * streams per scope self times to the editor profiler (one "Engine <Subsystem>"
+ * category per subsystem) and appends the events to a capture, which can be
+ * saved as a Chrome trace (chrome://tracing, Perfetto).
+ *
+ * Nothing is recorded unless the editor profiler is running or a capture
+ * is active. Without DEBUG_ENABLED the scope macro compiles to nothing.
+ */
+
+class FrameProfiler {
+public:
+	enum {
+		THREAD_BUFFER_SIZE = 8192, // power of two
+		MAX_THREADS = 64,
+		MAX_DEPTH = 64,
+		MAX_CAPTURE_EVENTS = 1 << 21
+	};
+
+	struct Event {
+		const char *name;
+		uint64_t begin;
+		uint64_t end;
+		uint32_t depth;
+	};
+
+	struct ThreadBuffer {
+		Thread::ID thread_id;
+		int index;
+		uint32_t exited; // set by the owning thread when it ends
+		bool free; // drained after the thread ended, the slot can be given to a new thread
+		uint32_t depth;
+		uint32_t write; // total pushed, only advanced by the owning thread
+
+		// reader side, only touched by the main thread
+		uint32_t read;
+		uint64_t child_time[MAX_DEPTH + 1];
+
+		Event events[THREAD_BUFFER_SIZE];
+	};
+
+	class Scope {
+
+		ThreadBuffer *buffer;
+		const char *name;
+		uint64_t begin;
+
+	public:
+		_FORCE_INLINE_ Scope(const char *p_name) {
+			buffer = (singleton && singleton->active) ? singleton->_begin(begin) : NULL;
+			name = p_name;
+		}
+		_FORCE_INLINE_ ~Scope() {
+			if (buffer)
+				singleton->_end(buffer, name, begin);
+		}
+	};
+
+private:
+	struct CaptureEvent {
+		const char *name;
+		uint64_t begin;
+		uint64_t end;
+		int thread;
+	};
+
+	static FrameProfiler *singleton;
+
+	ThreadBuffer *threads[MAX_THREADS];
+	uint32_t thread_count;
+	Mutex *mutex;
+
+	bool active;
+	bool streaming;
+	bool capturing;
+	bool capture_full;
+	uint64_t dropped_events;
+
+	Vector<CaptureEvent> capture;
+
+	ThreadBuffer *_get_thread_buffer();
+	ThreadBuffer *_register_thread();
+	void _free_exited(ThreadBuffer *p_buffer);
+	ThreadBuffer *_begin(uint64_t &r_begin);
+	void _end(ThreadBuffer *p_buffer, const char *p_name, uint64_t p_begin);
+	void _push(ThreadBuffer *p_buffer, const char *p_name, uint64_t p_begin, uint64_t p_end, uint32_t p_depth);
+	void _add_event(const char *p_name, uint64_t p_begin, uint64_t p_end);
+	void _update_active();
+
+public:
+	static FrameProfiler *get_singleton();
+
+	// for code that already measures its own intervals
+	static _FORCE_INLINE_ void add_event(const char *p_name, uint64_t p_begin, uint64_t p_end) {
+		if (singleton && singleton->active)
+			singleton->_add_event(p_name, p_begin, p_end);
+	}
+
+	// called by the Thread implementations when a thread ends, so its buffer can be reused
+	static void thread_exit();
+
+	void set_streaming(bool p_enable);
+	bool is_streaming() const;
+
+	void start_capture();
+	void stop_capture();
+	bool is_capturing() const;
+	int get_capture_event_count() const;
+	uint64_t get_dropped_event_count() const;
+	Error save_capture(const String &p_path) const;
+
+	void frame_end(uint64_t p_frame_begin);
+
+	FrameProfiler();
+	~FrameProfiler();
+};
+
+#ifdef DEBUG_ENABLED
+#define _FRAME_PROFILE_SCOPE_NAME(m_line) _frame_profile_scope_##m_line
+#define _FRAME_PROFILE_SCOPE(m_name, m_line) FrameProfiler::Scope _FRAME_PROFILE_SCOPE_NAME(m_line)(m_name)
+#define FRAME_PROFILE_SCOPE(m_name) _FRAME_PROFILE_SCOPE(m_name, __LINE__)
+#define FRAME_PROFILE_EVENT(m_name, m_begin, m_end) FrameProfiler::add_event(m_name, m_begin, m_end)
+#else
+#define FRAME_PROFILE_SCOPE(m_name)
+#define FRAME_PROFILE_EVENT(m_name, m_begin, m_end)
+#endif
+
+#endif // FRAME_PROFILER_H
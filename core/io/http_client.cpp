@@ -106,11 +106,50 @@ Ref<StreamPeer> HTTPClient::get_connection() const {
 	return connection;
 }
 
+bool HTTPClient::_can_send_request() const {
+
+	if (status == STATUS_CONNECTED)
+		return true;
+
+	// Pipelining, more requests can be queued on the connection while responses are being read
+	return (status == STATUS_REQUESTING || status == STATUS_BODY) && pending_requests > 0 && pending_requests < max_pipelined_requests;
+}
+
+Error HTTPClient::_send_request(Method p_method, const uint8_t *p_data, int p_size) {
+
+	Error err = connection->put_data(p_data, p_size);
+	if (err) {
+		close();
+		status = STATUS_CONNECTION_ERROR;
+		return err;
+	}
+
+	pending_methods[(pending_first + pending_requests) % PIPELINE_MAX] = p_method;
+	pending_requests++;
+
+	if (status == STATUS_CONNECTED) {
+		status = STATUS_REQUESTING;
+	}
+
+	return OK;
+}
+
+void HTTPClient::_response_done() {
+
+	ERR_FAIL_COND(pending_requests == 0);
+
+	pending_first = (pending_first + 1) % PIPELINE_MAX;
+	pending_requests--;
+
+	// Responses arrive in the order requests were sent, start reading the next one if pipelined
+	status = pending_requests > 0 ? STATUS_REQUESTING : STATUS_CONNECTED;
+}
+
 Error HTTPClient::request_raw(Method p_method, const String &p_url, const Vector<String> &p_headers, const PoolVector<uint8_t> &p_body) {
 
 	ERR_FAIL_INDEX_V(p_method, METHOD_MAX, ERR_INVALID_PARAMETER);
 	ERR_FAIL_COND_V(!p_url.begins_with("/"), ERR_INVALID_PARAMETER);
-	ERR_FAIL_COND_V(status != STATUS_CONNECTED, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!_can_send_request(), ERR_INVALID_PARAMETER);
 	ERR_FAIL_COND_V(connection.is_null(), ERR_INVALID_DATA);
 
 	String request = String(_methods[p_method]) + " " + p_url + " HTTP/1.1\r\n";
@@ -146,24 +185,14 @@ Error HTTPClient::request_raw(Method p_method, const String &p_url, const Vector
 	data.append_array(p_body);
 
 	PoolVector<uint8_t>::Read r = data.read();
-	Error err = connection->put_data(&r[0], data.size());
-
-	if (err) {
-		close();
-		status = STATUS_CONNECTION_ERROR;
-		return err;
-	}
-
-	status = STATUS_REQUESTING;
-
-	return OK;
+	return _send_request(p_method, r.ptr(), data.size());
 }
 
 Error HTTPClient::request(Method p_method, const String &p_url, const Vector<String> &p_headers, const String &p_body) {
 
 	ERR_FAIL_INDEX_V(p_method, METHOD_MAX, ERR_INVALID_PARAMETER);
 	ERR_FAIL_COND_V(!p_url.begins_with("/"), ERR_INVALID_PARAMETER);
-	ERR_FAIL_COND_V(status != STATUS_CONNECTED, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!_can_send_request(), ERR_INVALID_PARAMETER);
 	ERR_FAIL_COND_V(connection.is_null(), ERR_INVALID_DATA);
 
 	String request = String(_methods[p_method]) + " " + p_url + " HTTP/1.1\r\n";
@@ -188,16 +217,7 @@ Error HTTPClient::request(Method p_method, const String &p_url, const Vector<Str
 	request += p_body;
 
 	CharString cs = request.utf8();
-	Error err = connection->put_data((const uint8_t *)cs.ptr(), cs.length());
-	if (err) {
-		close();
-		status = STATUS_CONNECTION_ERROR;
-		return err;
-	}
-
-	status = STATUS_REQUESTING;
-
-	return OK;
+	return _send_request(p_method, (const uint8_t *)cs.ptr(), cs.length());
 }
 
 bool HTTPClient::has_response() const {
@@ -248,7 +268,11 @@ void HTTPClient::close() {
 	body_size = 0;
 	body_left = 0;
 	chunk_left = 0;
+	chunk_header_len = 0;
+	chunk_trailer = false;
 	response_num = 0;
+	pending_first = 0;
+	pending_requests = 0;
 }
 
 Error HTTPClient::poll() {
@@ -352,6 +376,8 @@ Error HTTPClient::poll() {
 					chunked = false;
 					body_left = 0;
 					chunk_left = 0;
+					chunk_header_len = 0;
+					chunk_trailer = false;
 					response_str.clear();
 					response_headers.clear();
 					response_num = RESPONSE_OK;
@@ -384,9 +410,17 @@ Error HTTPClient::poll() {
 						}
 					}
 
+					bool is_head = pending_requests > 0 && pending_methods[pending_first] == METHOD_HEAD;
+					if (is_head || response_num == RESPONSE_NO_CONTENT || response_num == RESPONSE_NOT_MODIFIED) {
+						// These responses never carry a body, even if they announce a length
+						body_size = 0;
+						body_left = 0;
+						chunked = false;
+					}
+
 					if (body_size == 0 && !chunked) {
 
-						status = STATUS_CONNECTED; // Ready for new requests
+						_response_done(); // Ready for new requests
 					} else {
 						status = STATUS_BODY;
 					}
@@ -422,126 +456,163 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 
 	ERR_FAIL_COND_V(status != STATUS_BODY, PoolByteArray());
 
+	int to_read = chunked ? read_chunk_size : MIN(body_left, read_chunk_size);
+	PoolByteArray ret;
+	ret.resize(to_read);
+	int read = 0;
+	{
+		PoolByteArray::Write w = ret.write();
+		read_response_body(w.ptr(), to_read, read);
+	}
+	if (read < to_read) // Ended up reading less
+		ret.resize(read);
+
+	return ret;
+}
+
+Error HTTPClient::_read_chunk_header(bool &r_done) {
+
+	// Reads the chunk size line (or the trailer once the last chunk arrived), one byte at a time
+	r_done = false;
+
+	while (true) {
+
+		uint8_t b;
+		int rec = 0;
+		Error err = _get_http_data(&b, 1, rec);
+		if (err != OK)
+			return err;
+		if (rec == 0)
+			return OK;
+
+		if (chunk_header_len >= CHUNK_HEADER_MAX) {
+			ERR_PRINT("HTTP Invalid chunk hex len");
+			return ERR_INVALID_DATA;
+		}
+		chunk_header[chunk_header_len++] = b;
+
+		if (b != '\n')
+			continue;
+
+		int line_len = chunk_header_len - 1;
+		if (line_len > 0 && chunk_header[line_len - 1] == '\r')
+			line_len--;
+		chunk_header_len = 0;
+
+		if (chunk_trailer) {
+			// Trailer headers are ignored, an empty line ends the body
+			if (line_len == 0) {
+				r_done = true;
+				return OK;
+			}
+			continue;
+		}
+
+		int len = 0;
+		for (int i = 0; i < line_len; i++) {
+			char c = chunk_header[i];
+			int v = 0;
+			if (c >= '0' && c <= '9')
+				v = c - '0';
+			else if (c >= 'a' && c <= 'f')
+				v = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				v = c - 'A' + 10;
+			else if (c == ';' || c == ' ' || c == '\t') // Chunk extensions
+				break;
+			else {
+				ERR_PRINT("HTTP Chunk len not in hex!!");
+				return ERR_INVALID_DATA;
+			}
+			len <<= 4;
+			len |= v;
+			if (len > (1 << 24)) {
+				ERR_PRINT("HTTP Chunk too big!! >16mb");
+				return ERR_INVALID_DATA;
+			}
+		}
+
+		if (len == 0) {
+			// Last chunk, skip the trailer
+			chunk_trailer = true;
+			continue;
+		}
+
+		chunk_left = len + 2; // Data plus CRLF terminator
+		return OK;
+	}
+}
+
+Error HTTPClient::read_response_body(uint8_t *p_buffer, int p_max_bytes, int &r_read) {
+
+	r_read = 0;
+	ERR_FAIL_COND_V(status != STATUS_BODY, ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(p_max_bytes < 0, ERR_INVALID_PARAMETER);
+
 	Error err = OK;
+	bool done = false;
 
 	if (chunked) {
 
-		while (true) {
+		// Chunk framing is consumed even when the buffer is full, so the response can complete
+		while (!done) {
 
 			if (chunk_left == 0) {
-				// Reading length
-				uint8_t b;
-				int rec = 0;
-				err = _get_http_data(&b, 1, rec);
 
-				if (rec == 0)
+				err = _read_chunk_header(done);
+				if (err != OK || (chunk_left == 0 && !done))
 					break;
 
-				chunk.push_back(b);
-
-				if (chunk.size() > 32) {
-					ERR_PRINT("HTTP Invalid chunk hex len");
-					status = STATUS_CONNECTION_ERROR;
-					return PoolByteArray();
-				}
+			} else if (chunk_left > 2) {
 
-				if (chunk.size() > 2 && chunk[chunk.size() - 2] == '\r' && chunk[chunk.size() - 1] == '\n') {
-
-					int len = 0;
-					for (int i = 0; i < chunk.size() - 2; i++) {
-						char c = chunk[i];
-						int v = 0;
-						if (c >= '0' && c <= '9')
-							v = c - '0';
-						else if (c >= 'a' && c <= 'f')
-							v = c - 'a' + 10;
-						else if (c >= 'A' && c <= 'F')
-							v = c - 'A' + 10;
-						else {
-							ERR_PRINT("HTTP Chunk len not in hex!!");
-							status = STATUS_CONNECTION_ERROR;
-							return PoolByteArray();
-						}
-						len <<= 4;
-						len |= v;
-						if (len > (1 << 24)) {
-							ERR_PRINT("HTTP Chunk too big!! >16mb");
-							status = STATUS_CONNECTION_ERROR;
-							return PoolByteArray();
-						}
-					}
-
-					if (len == 0) {
-						// End reached!
-						status = STATUS_CONNECTED;
-						chunk.clear();
-						return PoolByteArray();
-					}
-
-					chunk_left = len + 2;
-					chunk.resize(chunk_left);
-				}
-			} else {
+				if (r_read == p_max_bytes)
+					break;
 
 				int rec = 0;
-				err = _get_http_data(&chunk[chunk.size() - chunk_left], chunk_left, rec);
-				if (rec == 0) {
+				err = _get_http_data(p_buffer + r_read, MIN(chunk_left - 2, p_max_bytes - r_read), rec);
+				if (err != OK || rec == 0)
 					break;
-				}
 				chunk_left -= rec;
+				r_read += rec;
 
-				if (chunk_left == 0) {
-
-					if (chunk[chunk.size() - 2] != '\r' || chunk[chunk.size() - 1] != '\n') {
-						ERR_PRINT("HTTP Invalid chunk terminator (not \\r\\n)");
-						status = STATUS_CONNECTION_ERROR;
-						return PoolByteArray();
-					}
-
-					PoolByteArray ret;
-					ret.resize(chunk.size() - 2);
-					{
-						PoolByteArray::Write w = ret.write();
-						copymem(w.ptr(), chunk.ptr(), chunk.size() - 2);
-					}
-					chunk.clear();
+			} else {
 
-					return ret;
+				uint8_t b;
+				int rec = 0;
+				err = _get_http_data(&b, 1, rec);
+				if (err != OK || rec == 0)
+					break;
+				if (b != (chunk_left == 2 ? '\r' : '\n')) {
+					ERR_PRINT("HTTP Invalid chunk terminator (not \\r\\n)");
+					err = ERR_INVALID_DATA;
+					break;
 				}
+				chunk_left--;
 
-				break;
+				if (chunk_left == 0 && blocking && r_read > 0)
+					break; // Don't block waiting for the next chunk when there is data to return
 			}
 		}
 
 	} else {
 
-		int to_read = MIN(body_left, read_chunk_size);
-		PoolByteArray ret;
-		ret.resize(to_read);
-		int _offset = 0;
+		int to_read = MIN(body_left, p_max_bytes);
 		while (to_read > 0) {
 			int rec = 0;
-			{
-				PoolByteArray::Write w = ret.write();
-				err = _get_http_data(w.ptr() + _offset, to_read, rec);
-			}
-			if (rec > 0) {
-				body_left -= rec;
-				to_read -= rec;
-				_offset += rec;
-			} else {
-				if (to_read > 0) // Ended up reading less
-					ret.resize(_offset);
+			err = _get_http_data(p_buffer + r_read, to_read, rec);
+			if (err != OK || rec == 0)
 				break;
-			}
+			body_left -= rec;
+			to_read -= rec;
+			r_read += rec;
 		}
-		if (body_left == 0) {
-			status = STATUS_CONNECTED;
-		}
-		return ret;
+		done = body_left == 0;
 	}
 
-	if (err != OK) {
+	if (err == ERR_INVALID_DATA) {
+		close();
+		status = STATUS_CONNECTION_ERROR;
+	} else if (err != OK) {
 		close();
 		if (err == ERR_FILE_EOF) {
 
@@ -550,12 +621,12 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 
 			status = STATUS_CONNECTION_ERROR;
 		}
-	} else if (body_left == 0 && !chunked) {
+	} else if (done) {
 
-		status = STATUS_CONNECTED;
+		_response_done();
 	}
 
-	return PoolByteArray();
+	return err;
 }
 
 HTTPClient::Status HTTPClient::get_status() const {
@@ -593,6 +664,21 @@ void HTTPClient::set_read_chunk_size(int p_size) {
 	read_chunk_size = p_size;
 }
 
+void HTTPClient::set_max_pipelined_requests(int p_max) {
+	ERR_FAIL_COND(p_max < 1 || p_max > PIPELINE_MAX);
+	max_pipelined_requests = p_max;
+}
+
+int HTTPClient::get_max_pipelined_requests() const {
+
+	return max_pipelined_requests;
+}
+
+int HTTPClient::get_pending_request_count() const {
+
+	return pending_requests;
+}
+
 HTTPClient::HTTPClient() {
 
 	tcp_connection = StreamPeerTCP::create_ref();
@@ -603,7 +689,12 @@ HTTPClient::HTTPClient() {
 	chunked = false;
 	body_left = 0;
 	chunk_left = 0;
+	chunk_header_len = 0;
+	chunk_trailer = false;
 	response_num = 0;
+	pending_first = 0;
+	pending_requests = 0;
+	max_pipelined_requests = 1;
 	ssl = false;
 	blocking = false;
 	read_chunk_size = 4096;
@@ -674,6 +765,10 @@ void HTTPClient::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("read_response_body_chunk"), &HTTPClient::read_response_body_chunk);
 	ClassDB::bind_method(D_METHOD("set_read_chunk_size", "bytes"), &HTTPClient::set_read_chunk_size);
 
+	ClassDB::bind_method(D_METHOD("set_max_pipelined_requests", "max"), &HTTPClient::set_max_pipelined_requests);
+	ClassDB::bind_method(D_METHOD("get_max_pipelined_requests"), &HTTPClient::get_max_pipelined_requests);
+	ClassDB::bind_method(D_METHOD("get_pending_request_count"), &HTTPClient::get_pending_request_count);
+
 	ClassDB::bind_method(D_METHOD("set_blocking_mode", "enabled"), &HTTPClient::set_blocking_mode);
 	ClassDB::bind_method(D_METHOD("is_blocking_mode_enabled"), &HTTPClient::is_blocking_mode_enabled);
 
@@ -684,6 +779,7 @@ void HTTPClient::_bind_methods() {
 
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "blocking_mode_enabled"), "set_blocking_mode", "is_blocking_mode_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "connection", PROPERTY_HINT_RESOURCE_TYPE, "StreamPeer", 0), "set_connection", "get_connection");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_pipelined_requests", PROPERTY_HINT_RANGE, "1,32"), "set_max_pipelined_requests", "get_max_pipelined_requests");
 
 	BIND_ENUM_CONSTANT(METHOD_GET);
 	BIND_ENUM_CONSTANT(METHOD_HEAD);
@@ -146,6 +146,10 @@ public:
 
 	};
 
+	enum {
+		PIPELINE_MAX = 32
+	};
+
 private:
 	static const char *_methods[METHOD_MAX];
 	static const int HOST_MIN_LEN = 4;
@@ -157,6 +161,10 @@ private:
 
 	};
 
+	enum {
+		CHUNK_HEADER_MAX = 32
+	};
+
 #ifndef JAVASCRIPT_ENABLED
 	Status status;
 	IP::ResolverID resolving;
@@ -169,11 +177,18 @@ private:
 	Vector<uint8_t> response_str;
 
 	bool chunked;
-	Vector<uint8_t> chunk;
+	bool chunk_trailer;
+	uint8_t chunk_header[CHUNK_HEADER_MAX];
+	int chunk_header_len;
 	int chunk_left;
 	int body_size;
 	int body_left;
 
+	Method pending_methods[PIPELINE_MAX];
+	int pending_first;
+	int pending_requests;
+	int max_pipelined_requests;
+
 	Ref<StreamPeerTCP> tcp_connection;
 	Ref<StreamPeer> connection;
 
@@ -182,6 +197,10 @@ private:
 	int read_chunk_size;
 
 	Error _get_http_data(uint8_t *p_buffer, int p_bytes, int &r_received);
+	bool _can_send_request() const;
+	Error _send_request(Method p_method, const uint8_t *p_data, int p_size);
+	Error _read_chunk_header(bool &r_done);
+	void _response_done();
 
 #else
 #include "platform/javascript/http_client.h.inc"
@@ -212,12 +231,17 @@ public:
 	int get_response_body_length() const;
 
 	PoolByteArray read_response_body_chunk(); // Can't get body as partial text because of most encodings UTF8, gzip, etc.
+	Error read_response_body(uint8_t *p_buffer, int p_max_bytes, int &r_read); // Same, but writes into a caller buffer without allocating.
 
 	void set_blocking_mode(bool p_enable); // Useful mostly if running in a thread
 	bool is_blocking_mode_enabled() const;
 
 	void set_read_chunk_size(int p_size);
 
+	void set_max_pipelined_requests(int p_max); // Requests that may be sent before the previous responses arrive.
+	int get_max_pipelined_requests() const;
+	int get_pending_request_count() const;
+
 	Error poll();
 
 	String query_string_from_dict(const Dictionary &p_dict);
@@ -0,0 +1,584 @@
+/*************************************************************************/
+/*  http_client_pool.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "http_client_pool.h"
+
+Error HTTPClientPool::connect_to_host(const String &p_host, int p_port, bool p_ssl, bool p_verify_host) {
+
+	close();
+
+	ERR_FAIL_COND_V(p_host.empty(), ERR_INVALID_PARAMETER);
+
+	host = p_host;
+	port = p_port;
+	use_ssl = p_ssl;
+	verify_host = p_verify_host;
+
+	// Connections are only opened once requests need them
+	connections.resize(max_connections);
+	for (int i = 0; i < connections.size(); i++) {
+
+		Connection &c = connections[i];
+		c.client.instance();
+		c.client->set_blocking_mode(false);
+		c.client->set_max_pipelined_requests(max_pipelined_requests);
+		c.client->set_read_chunk_size(read_chunk_size);
+	}
+
+	return OK;
+}
+
+void HTTPClientPool::close() {
+
+	for (int i = 0; i < connections.size(); i++) {
+		connections[i].client->close();
+	}
+	connections.clear();
+
+	for (Map<int, Request>::Element *E = requests.front(); E; E = E->next()) {
+		if (E->get().file)
+			memdelete(E->get().file);
+	}
+	requests.clear();
+	queue.clear();
+	completed.clear();
+}
+
+void HTTPClientPool::set_max_connections(int p_max) {
+
+	ERR_FAIL_COND(p_max < 1);
+	max_connections = p_max; // Applied on the next connect_to_host()
+}
+
+int HTTPClientPool::get_max_connections() const {
+
+	return max_connections;
+}
+
+void HTTPClientPool::set_max_pipelined_requests(int p_max) {
+
+	ERR_FAIL_COND(p_max < 1 || p_max > HTTPClient::PIPELINE_MAX);
+	max_pipelined_requests = p_max;
+
+	for (int i = 0; i < connections.size(); i++) {
+		connections[i].client->set_max_pipelined_requests(p_max);
+	}
+}
+
+int HTTPClientPool::get_max_pipelined_requests() const {
+
+	return max_pipelined_requests;
+}
+
+void HTTPClientPool::set_read_chunk_size(int p_size) {
+
+	ERR_FAIL_COND(p_size < 256 || p_size > (1 << 24));
+	read_chunk_size = p_size;
+
+	for (int i = 0; i < connections.size(); i++) {
+		connections[i].client->set_read_chunk_size(p_size);
+	}
+}
+
+int HTTPClientPool::get_read_chunk_size() const {
+
+	return read_chunk_size;
+}
+
+int HTTPClientPool::_queue_request(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, const String &p_body, const String &p_download_file, uint8_t *p_buffer, int p_buffer_size, BodySink *p_sink) {
+
+	ERR_FAIL_COND_V(connections.empty(), -1);
+	ERR_FAIL_INDEX_V(p_method, HTTPClient::METHOD_MAX, -1);
+	ERR_FAIL_COND_V(!p_url.begins_with("/"), -1);
+
+	int id = ++last_id;
+
+	Request &r = requests[id];
+	r.method = p_method;
+	r.url = p_url;
+	r.headers = p_headers;
+	r.body = p_body;
+	r.download_file = p_download_file;
+	r.buffer = p_buffer;
+	r.buffer_size = p_buffer_size;
+	r.sink = p_sink;
+
+	queue.push_back(id);
+
+	return id;
+}
+
+int HTTPClientPool::request(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, const String &p_body, const String &p_download_file) {
+
+	return _queue_request(p_method, p_url, p_headers, p_body, p_download_file, NULL, 0, NULL);
+}
+
+int HTTPClientPool::request_to_buffer(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, uint8_t *p_buffer, int p_buffer_size) {
+
+	ERR_FAIL_COND_V(!p_buffer, -1);
+	ERR_FAIL_COND_V(p_buffer_size < 0, -1);
+
+	return _queue_request(p_method, p_url, p_headers, String(), String(), p_buffer, p_buffer_size, NULL);
+}
+
+int HTTPClientPool::request_to_sink(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, BodySink *p_sink) {
+
+	ERR_FAIL_COND_V(!p_sink, -1);
+
+	return _queue_request(p_method, p_url, p_headers, String(), String(), NULL, 0, p_sink);
+}
+
+int HTTPClientPool::get_received_bytes(int p_id) const {
+
+	const Map<int, Request>::Element *E = requests.find(p_id);
+	ERR_FAIL_COND_V(!E, 0);
+
+	return E->get().received;
+}
+
+int HTTPClientPool::get_pending_request_count() const {
+
+	return requests.size();
+}
+
+int HTTPClientPool::get_open_connection_count() const {
+
+	int count = 0;
+	for (int i = 0; i < connections.size(); i++) {
+		if (connections[i].client->get_status() != HTTPClient::STATUS_DISCONNECTED)
+			count++;
+	}
+
+	return count;
+}
+
+void HTTPClientPool::_finish_request(int p_id, Error p_error) {
+
+	Map<int, Request>::Element *E = requests.find(p_id);
+	ERR_FAIL_COND(!E);
+
+	Request &r = E->get();
+	if (r.file) {
+		memdelete(r.file);
+		r.file = NULL;
+	}
+	if (p_error == OK) {
+		r.response_body.resize(r.buffer || r.sink || r.download_file != String() ? 0 : r.received);
+	} else {
+		r.response_body.resize(0);
+	}
+	r.error = p_error;
+
+	completed.push_back(p_id);
+}
+
+// Only these may be sent twice, or sent behind another request that could still fail (RFC 7231, 4.2.2)
+static bool _is_idempotent(HTTPClient::Method p_method) {
+
+	switch (p_method) {
+		case HTTPClient::METHOD_GET:
+		case HTTPClient::METHOD_HEAD:
+		case HTTPClient::METHOD_PUT:
+		case HTTPClient::METHOD_DELETE:
+		case HTTPClient::METHOD_OPTIONS:
+		case HTTPClient::METHOD_TRACE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void HTTPClientPool::_drop_connection(Connection &c, Error p_error) {
+
+	c.client->close();
+	c.closing = false;
+
+	// Requests sent but not answered go back to the front of the queue, in order
+	for (int i = c.in_flight.size() - 1; i >= 0; i--) {
+
+		int id = c.in_flight[i];
+		Map<int, Request>::Element *E = requests.find(id);
+		if (!E)
+			continue;
+
+		Request &r = E->get();
+		// The server may have acted on a POST or PATCH already, the caller decides whether to send it again
+		if (r.retries >= MAX_RETRIES || (r.sink && r.received > 0) || !_is_idempotent(r.method)) {
+			_finish_request(id, p_error);
+			continue;
+		}
+
+		r.retries++;
+		if (r.file) {
+			memdelete(r.file);
+			r.file = NULL;
+		}
+		r.response_body.resize(0);
+		r.response_headers.resize(0);
+		r.response_code = 0;
+		r.received = 0;
+		r.got_response = false;
+
+		queue.push_front(id);
+	}
+
+	c.in_flight.clear();
+}
+
+void HTTPClientPool::_send_requests(Connection &c) {
+
+	if (c.closing)
+		return;
+
+	while (queue.size() && c.in_flight.size() < max_pipelined_requests) {
+
+		int id = queue.front()->get();
+		const Request &r = requests[id];
+
+		// Non-idempotent requests get the connection to themselves, so a failure never takes them down with others
+		if (c.in_flight.size() && (!_is_idempotent(r.method) || !_is_idempotent(requests[c.in_flight[c.in_flight.size() - 1]].method)))
+			return;
+
+		if (c.client->request(r.method, r.url, r.headers, r.body) != OK)
+			return; // The connection failed, the request stays queued for the next one
+
+		queue.pop_front();
+		c.in_flight.push_back(id);
+	}
+}
+
+Error HTTPClientPool::_begin_response(Connection &c, Request &r) {
+
+	r.got_response = true;
+	r.response_code = c.client->get_response_code();
+
+	List<String> rheaders;
+	c.client->get_response_headers(&rheaders);
+	r.response_headers.resize(0);
+	for (List<String>::Element *E = rheaders.front(); E; E = E->next()) {
+
+		r.response_headers.push_back(E->get());
+
+		String h = E->get().to_lower();
+		if (h.begins_with("connection:") && h.find("close") != -1)
+			c.closing = true;
+	}
+
+	if (r.download_file != String()) {
+		r.file = FileAccess::open(r.download_file, FileAccess::WRITE);
+		if (!r.file)
+			return ERR_FILE_CANT_OPEN;
+	}
+
+	if (c.client->get_status() == HTTPClient::STATUS_BODY && !c.client->is_response_chunked()) {
+
+		int len = c.client->get_response_body_length();
+		if (r.buffer && len > r.buffer_size)
+			return ERR_OUT_OF_MEMORY;
+		if (!r.buffer && !r.sink && !r.file)
+			r.response_body.resize(MIN(len, read_chunk_size)); // Grown as data arrives, a bogus Content-Length can't force a huge allocation
+	}
+
+	return OK;
+}
+
+Error HTTPClientPool::_read_body(Connection &c, Request &r) {
+
+	int pending = c.client->get_pending_request_count();
+
+	while (c.client->get_status() == HTTPClient::STATUS_BODY && c.client->get_pending_request_count() == pending) {
+
+		int read = 0;
+
+		if (r.buffer && r.received < r.buffer_size) {
+
+			c.client->read_response_body(r.buffer + r.received, r.buffer_size - r.received, read);
+
+		} else if (r.buffer || r.file || r.sink) {
+
+			c.client->read_response_body(read_buffer.ptrw(), read_buffer.size(), read);
+			if (read > 0) {
+				if (r.buffer)
+					return ERR_OUT_OF_MEMORY; // Body is larger than the caller buffer
+
+				if (r.file) {
+					r.file->store_buffer(read_buffer.ptr(), read);
+					if (r.file->get_error() != OK)
+						return ERR_FILE_CANT_WRITE;
+				} else {
+					Error err = r.sink->write(read_buffer.ptr(), read);
+					if (err != OK)
+						return err;
+				}
+			}
+
+		} else {
+
+			if (r.response_body.size() == r.received) {
+				r.response_body.resize(MAX(r.received + read_chunk_size, r.received * 2));
+			}
+
+			PoolVector<uint8_t>::Write w = r.response_body.write();
+			c.client->read_response_body(w.ptr() + r.received, r.response_body.size() - r.received, read);
+		}
+
+		r.received += read;
+		if (read == 0)
+			break;
+	}
+
+	return OK;
+}
+
+void HTTPClientPool::_read_responses(Connection &c) {
+
+	while (c.in_flight.size()) {
+
+		int id = c.in_flight[0];
+		Map<int, Request>::Element *E = requests.find(id);
+		ERR_FAIL_COND(!E);
+
+		Request &r = E->get();
+		int pending = c.client->get_pending_request_count();
+
+		if (!r.got_response) {
+
+			if (c.client->get_status() == HTTPClient::STATUS_REQUESTING)
+				c.client->poll();
+
+			HTTPClient::Status status = c.client->get_status();
+			if (status != HTTPClient::STATUS_CONNECTED && status != HTTPClient::STATUS_REQUESTING && status != HTTPClient::STATUS_BODY)
+				return; // Connection failed, handled on next poll
+			if (status == HTTPClient::STATUS_REQUESTING && c.client->get_pending_request_count() == pending)
+				return; // Headers not here yet
+
+			Error err = _begin_response(c, r);
+			if (err != OK) {
+				c.in_flight.remove(0);
+				_finish_request(id, err);
+				_drop_connection(c, ERR_CONNECTION_ERROR);
+				return;
+			}
+		}
+
+		if (c.client->get_pending_request_count() == pending) {
+
+			Error err = _read_body(c, r);
+			if (err != OK) {
+				c.in_flight.remove(0);
+				_finish_request(id, err);
+				_drop_connection(c, ERR_CONNECTION_ERROR);
+				return;
+			}
+
+			if (c.client->get_pending_request_count() == pending)
+				return; // Body not complete, or connection failed (handled on next poll)
+		}
+
+		c.in_flight.remove(0);
+		_finish_request(id, OK);
+
+		if (c.closing) {
+			// Server announced it will close, whatever was pipelined after this must be sent again
+			_drop_connection(c, ERR_CONNECTION_ERROR);
+			return;
+		}
+	}
+}
+
+void HTTPClientPool::_poll_connection(Connection &c) {
+
+	HTTPClient::Status status = c.client->get_status();
+
+	switch (status) {
+
+		case HTTPClient::STATUS_DISCONNECTED: {
+
+			// Server closed a kept-alive connection
+			if (c.in_flight.size())
+				_drop_connection(c, ERR_CONNECTION_ERROR);
+		} break;
+		case HTTPClient::STATUS_RESOLVING:
+		case HTTPClient::STATUS_CONNECTING: {
+
+			c.client->poll();
+		} break;
+		case HTTPClient::STATUS_CANT_RESOLVE:
+		case HTTPClient::STATUS_CANT_CONNECT:
+		case HTTPClient::STATUS_SSL_HANDSHAKE_ERROR: {
+
+			Error err = status == HTTPClient::STATUS_CANT_RESOLVE ? ERR_CANT_RESOLVE : ERR_CANT_CONNECT;
+			_drop_connection(c, err);
+
+			bool alive = false;
+			for (int i = 0; i < connections.size(); i++) {
+				if (connections[i].client->get_status() != HTTPClient::STATUS_DISCONNECTED)
+					alive = true;
+			}
+
+			if (!alive) {
+				// Nothing can reach the host, give up on the queue as well
+				while (queue.size()) {
+					int id = queue.front()->get();
+					queue.pop_front();
+					_finish_request(id, err);
+				}
+			}
+		} break;
+		case HTTPClient::STATUS_CONNECTION_ERROR: {
+
+			_drop_connection(c, ERR_CONNECTION_ERROR);
+		} break;
+		case HTTPClient::STATUS_CONNECTED:
+		case HTTPClient::STATUS_REQUESTING:
+		case HTTPClient::STATUS_BODY: {
+
+			_send_requests(c);
+			_read_responses(c);
+		} break;
+	}
+}
+
+void HTTPClientPool::_flush_completed() {
+
+	// Emitted after all connections were polled, so handlers may queue new requests or close the pool
+	Vector<int> done = completed;
+	completed.clear();
+
+	for (int i = 0; i < done.size(); i++) {
+
+		Map<int, Request>::Element *E = requests.find(done[i]);
+		if (!E)
+			continue;
+
+		const Request &r = E->get();
+		emit_signal("request_completed", done[i], r.error, r.response_code, r.response_headers, r.response_body);
+
+		E = requests.find(done[i]); // Handler might have closed the pool
+		if (E)
+			requests.erase(E);
+	}
+}
+
+Error HTTPClientPool::poll() {
+
+	ERR_FAIL_COND_V(connections.empty(), ERR_UNCONFIGURED);
+
+	if (read_buffer.size() != read_chunk_size)
+		read_buffer.resize(read_chunk_size);
+
+	// Only open more connections while the ones already open can't take the queue
+	int capacity = 0;
+	for (int i = 0; i < connections.size(); i++) {
+
+		const Connection &c = connections[i];
+		switch (c.client->get_status()) {
+			case HTTPClient::STATUS_RESOLVING:
+			case HTTPClient::STATUS_CONNECTING: {
+				capacity += max_pipelined_requests;
+			} break;
+			case HTTPClient::STATUS_CONNECTED:
+			case HTTPClient::STATUS_REQUESTING:
+			case HTTPClient::STATUS_BODY: {
+				if (!c.closing)
+					capacity += MAX(0, max_pipelined_requests - c.in_flight.size());
+			} break;
+			default: {
+			}
+		}
+	}
+
+	for (int i = 0; i < connections.size(); i++) {
+
+		Connection &c = connections[i];
+
+		if (c.client->get_status() == HTTPClient::STATUS_DISCONNECTED && c.in_flight.empty() && queue.size() > capacity) {
+
+			Error err = c.client->connect_to_host(host, port, use_ssl, verify_host);
+			if (err != OK) {
+				while (queue.size()) {
+					int id = queue.front()->get();
+					queue.pop_front();
+					_finish_request(id, err);
+				}
+				break;
+			}
+			capacity += max_pipelined_requests;
+		}
+
+		_poll_connection(c);
+	}
+
+	_flush_completed();
+
+	return OK;
+}
+
+void HTTPClientPool::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("connect_to_host", "host", "port", "use_ssl", "verify_host"), &HTTPClientPool::connect_to_host, DEFVAL(-1), DEFVAL(false), DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("close"), &HTTPClientPool::close);
+	ClassDB::bind_method(D_METHOD("request", "method", "url", "headers", "body", "download_file"), &HTTPClientPool::request, DEFVAL(String()), DEFVAL(String()));
+	ClassDB::bind_method(D_METHOD("poll"), &HTTPClientPool::poll);
+
+	ClassDB::bind_method(D_METHOD("get_received_bytes", "id"), &HTTPClientPool::get_received_bytes);
+	ClassDB::bind_method(D_METHOD("get_pending_request_count"), &HTTPClientPool::get_pending_request_count);
+	ClassDB::bind_method(D_METHOD("get_open_connection_count"), &HTTPClientPool::get_open_connection_count);
+
+	ClassDB::bind_method(D_METHOD("set_max_connections", "max"), &HTTPClientPool::set_max_connections);
+	ClassDB::bind_method(D_METHOD("get_max_connections"), &HTTPClientPool::get_max_connections);
+	ClassDB::bind_method(D_METHOD("set_max_pipelined_requests", "max"), &HTTPClientPool::set_max_pipelined_requests);
+	ClassDB::bind_method(D_METHOD("get_max_pipelined_requests"), &HTTPClientPool::get_max_pipelined_requests);
+	ClassDB::bind_method(D_METHOD("set_read_chunk_size", "bytes"), &HTTPClientPool::set_read_chunk_size);
+	ClassDB::bind_method(D_METHOD("get_read_chunk_size"), &HTTPClientPool::get_read_chunk_size);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_connections", PROPERTY_HINT_RANGE, "1,64"), "set_max_connections", "get_max_connections");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_pipelined_requests", PROPERTY_HINT_RANGE, "1,32"), "set_max_pipelined_requests", "get_max_pipelined_requests");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "read_chunk_size", PROPERTY_HINT_RANGE, "256,16777216"), "set_read_chunk_size", "get_read_chunk_size");
+
+	ADD_SIGNAL(MethodInfo("request_completed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::INT, "response_code"), PropertyInfo(Variant::POOL_STRING_ARRAY, "headers"), PropertyInfo(Variant::POOL_BYTE_ARRAY, "body")));
+}
+
+HTTPClientPool::HTTPClientPool() {
+
+	port = -1;
+	use_ssl = false;
+	verify_host = true;
+	max_connections = 4;
+	max_pipelined_requests = 1;
+	read_chunk_size = 65536;
+	last_id = 0;
+}
+
+HTTPClientPool::~HTTPClientPool() {
+
+	close();
+}
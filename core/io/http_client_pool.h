@@ -0,0 +1,162 @@
+/*************************************************************************/
+/*  http_client_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef HTTP_CLIENT_POOL_H
+#define HTTP_CLIENT_POOL_H
+
+#include "io/http_client.h"
+#include "list.h"
+#include "map.h"
+#include "os/file_access.h"
+
+// Spreads many requests to a single host over a few keep-alive (and optionally
+// pipelined) connections. Response bodies are written straight to their
+// destination (memory, file, caller buffer or sink) as they arrive.
+
+class HTTPClientPool : public Reference {
+
+	GDCLASS(HTTPClientPool, Reference);
+
+public:
+	class BodySink {
+	public:
+		virtual Error write(const uint8_t *p_data, int p_bytes) = 0;
+		virtual ~BodySink() {}
+	};
+
+private:
+	enum {
+		MAX_RETRIES = 1
+	};
+
+	struct Request {
+
+		HTTPClient::Method method;
+		String url;
+		Vector<String> headers;
+		String body;
+
+		String download_file;
+		FileAccess *file;
+		BodySink *sink;
+		uint8_t *buffer;
+		int buffer_size;
+
+		PoolVector<uint8_t> response_body;
+		PoolStringArray response_headers;
+		int response_code;
+		int received;
+		bool got_response;
+		int retries;
+		Error error;
+
+		Request() {
+			method = HTTPClient::METHOD_GET;
+			file = NULL;
+			sink = NULL;
+			buffer = NULL;
+			buffer_size = 0;
+			response_code = 0;
+			received = 0;
+			got_response = false;
+			retries = 0;
+			error = OK;
+		}
+	};
+
+	struct Connection {
+
+		Ref<HTTPClient> client;
+		Vector<int> in_flight; // In the order responses will arrive
+		bool closing;
+
+		Connection() { closing = false; }
+	};
+
+	String host;
+	int port;
+	bool use_ssl;
+	bool verify_host;
+
+	int max_connections;
+	int max_pipelined_requests;
+	int read_chunk_size;
+
+	Vector<Connection> connections;
+	Map<int, Request> requests;
+	List<int> queue;
+	Vector<int> completed;
+	Vector<uint8_t> read_buffer;
+	int last_id;
+
+	int _queue_request(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, const String &p_body, const String &p_download_file, uint8_t *p_buffer, int p_buffer_size, BodySink *p_sink);
+
+	void _poll_connection(Connection &c);
+	void _send_requests(Connection &c);
+	void _read_responses(Connection &c);
+	Error _begin_response(Connection &c, Request &r);
+	Error _read_body(Connection &c, Request &r);
+	void _drop_connection(Connection &c, Error p_error);
+	void _finish_request(int p_id, Error p_error);
+	void _flush_completed();
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error connect_to_host(const String &p_host, int p_port = -1, bool p_ssl = false, bool p_verify_host = true);
+	void close();
+
+	void set_max_connections(int p_max);
+	int get_max_connections() const;
+
+	void set_max_pipelined_requests(int p_max);
+	int get_max_pipelined_requests() const;
+
+	void set_read_chunk_size(int p_size);
+	int get_read_chunk_size() const;
+
+	// All return a request id, passed back by the "request_completed" signal, or -1 on error.
+	int request(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, const String &p_body = String(), const String &p_download_file = String());
+	int request_to_buffer(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, uint8_t *p_buffer, int p_buffer_size);
+	int request_to_sink(HTTPClient::Method p_method, const String &p_url, const Vector<String> &p_headers, BodySink *p_sink);
+
+	int get_received_bytes(int p_id) const;
+	int get_pending_request_count() const;
+	int get_open_connection_count() const;
+
+	Error poll();
+
+	HTTPClientPool();
+	~HTTPClientPool();
+};
+
+#endif // HTTP_CLIENT_POOL_H
@@ -57,6 +57,9 @@ EncodedObjectAsID::EncodedObjectAsID() {
 #define ENCODE_FLAG_64 1 << 16
 #define ENCODE_FLAG_OBJECT_AS_ID 1 << 16
 
+// Never a valid type in the first byte of the regular encoding
+#define ENCODE_COMPACT_MARKER 0xFF
+
 static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r_string) {
 	ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
 
@@ -86,6 +89,10 @@ static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r
 
 Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_objects) {
 
+	if (p_len >= 1 && p_buffer[0] == ENCODE_COMPACT_MARKER) {
+		return decode_variant_compact(r_variant, p_buffer, p_len, r_len, NULL, p_allow_objects);
+	}
+
 	const uint8_t *buf = p_buffer;
 	int len = p_len;
 
@@ -1415,3 +1422,882 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
 	return OK;
 }
+
+/* Compact encoding */
+
+int MarshallKeyTable::add_key(const String &p_key) {
+
+	const int *idx = indices.getptr(p_key);
+	if (idx)
+		return *idx;
+
+	int index = keys.size();
+	keys.push_back(p_key);
+	indices[p_key] = index;
+	return index;
+}
+
+int MarshallKeyTable::find_key(const String &p_key) const {
+
+	const int *idx = indices.getptr(p_key);
+	return idx ? *idx : -1;
+}
+
+String MarshallKeyTable::get_key(int p_index) const {
+
+	ERR_FAIL_INDEX_V(p_index, keys.size(), String());
+	return keys[p_index];
+}
+
+int MarshallKeyTable::get_key_count() const {
+
+	return keys.size();
+}
+
+void MarshallKeyTable::clear() {
+
+	keys.clear();
+	indices.clear();
+}
+
+#define COMPACT_TYPE_MASK 0x1F
+#define COMPACT_FLAG_A 0x20 // BOOL: true, REAL: 64 bits, STRING: key table index, OBJECT: as ID
+#define COMPACT_FLAG_B 0x40 // OBJECT: null
+#define COMPACT_MAX_DEPTH 256 // Nesting allowed when decoding, corrupt data could otherwise overflow the stack
+
+struct _CompactWriter {
+
+	Vector<uint8_t> &buffer;
+	uint8_t *w;
+	int pos;
+
+	// Returns room for p_bytes at the current position, without advancing
+	_FORCE_INLINE_ uint8_t *reserve(int p_bytes) {
+
+		if (pos + p_bytes > buffer.size()) {
+			buffer.resize(MAX(MAX(pos + p_bytes, 64), buffer.size() * 2));
+			w = buffer.ptrw();
+		}
+		return w + pos;
+	}
+
+	_FORCE_INLINE_ uint8_t *put(int p_bytes) {
+
+		uint8_t *ptr = reserve(p_bytes);
+		pos += p_bytes;
+		return ptr;
+	}
+
+	_FORCE_INLINE_ void put_u8(uint8_t p_byte) {
+
+		*put(1) = p_byte;
+	}
+
+	_FORCE_INLINE_ void put_varint(uint64_t p_value) {
+
+		uint8_t *ptr = reserve(10);
+		int n = 0;
+		while (p_value >= 0x80) {
+			ptr[n++] = uint8_t(p_value | 0x80);
+			p_value >>= 7;
+		}
+		ptr[n++] = uint8_t(p_value);
+		pos += n;
+	}
+
+	_FORCE_INLINE_ void put_float(float p_value) {
+
+		encode_float(p_value, put(4));
+	}
+
+	void put_string(const String &p_string) {
+
+		// UTF-8 is written in place, String::utf8() would allocate a CharString per string
+		int l = p_string.length();
+		const CharType *d = p_string.c_str();
+
+		int fl = 0;
+		for (int i = 0; i < l; i++) {
+			uint32_t c = d[i];
+			fl += c <= 0x7f ? 1 : c <= 0x7ff ? 2 : c <= 0xffff ? 3 : c <= 0x001fffff ? 4 : c <= 0x03ffffff ? 5 : c <= 0x7fffffff ? 6 : 0;
+		}
+
+		put_varint(fl);
+		uint8_t *cdst = put(fl);
+
+		for (int i = 0; i < l; i++) {
+
+			uint32_t c = d[i];
+			if (c <= 0x7f) {
+				*(cdst++) = c;
+			} else if (c <= 0x7ff) {
+				*(cdst++) = 0xc0 | ((c >> 6) & 0x1f);
+				*(cdst++) = 0x80 | (c & 0x3f);
+			} else if (c <= 0xffff) {
+				*(cdst++) = 0xe0 | ((c >> 12) & 0x0f);
+				*(cdst++) = 0x80 | ((c >> 6) & 0x3f);
+				*(cdst++) = 0x80 | (c & 0x3f);
+			} else if (c <= 0x001fffff) {
+				*(cdst++) = 0xf0 | ((c >> 18) & 0x07);
+				*(cdst++) = 0x80 | ((c >> 12) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 6) & 0x3f);
+				*(cdst++) = 0x80 | (c & 0x3f);
+			} else if (c <= 0x03ffffff) {
+				*(cdst++) = 0xf8 | ((c >> 24) & 0x03);
+				*(cdst++) = 0x80 | ((c >> 18) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 12) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 6) & 0x3f);
+				*(cdst++) = 0x80 | (c & 0x3f);
+			} else if (c <= 0x7fffffff) {
+				*(cdst++) = 0xfc | ((c >> 30) & 0x01);
+				*(cdst++) = 0x80 | ((c >> 24) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 18) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 12) & 0x3f);
+				*(cdst++) = 0x80 | ((c >> 6) & 0x3f);
+				*(cdst++) = 0x80 | (c & 0x3f);
+			}
+		}
+	}
+
+	_CompactWriter(Vector<uint8_t> &p_buffer, int p_pos) :
+			buffer(p_buffer),
+			w(p_buffer.ptrw()),
+			pos(p_pos) {}
+};
+
+template <class T>
+static void _encode_compact_pool_array(_CompactWriter &w, const Variant &p_variant, int p_components) {
+
+	// Arrays of floats and ints keep a fixed layout, so they are copied in bulk on little endian hosts
+	PoolVector<T> data = p_variant;
+	int len = data.size();
+	w.put_varint(len);
+	if (!len)
+		return;
+
+	int bytes = len * p_components * 4;
+	uint8_t *dst = w.put(bytes);
+	typename PoolVector<T>::Read r = data.read();
+#ifndef BIG_ENDIAN_ENABLED
+	if (sizeof(T) == size_t(p_components * 4)) {
+		copymem(dst, r.ptr(), bytes);
+		return;
+	}
+#endif
+	const float *src_f = (const float *)r.ptr();
+	const real_t *src_r = (const real_t *)r.ptr();
+	for (int i = 0; i < len * p_components; i++) {
+		// Colors are always float, other vector types follow real_t
+		if (sizeof(T) == size_t(p_components * sizeof(float)))
+			encode_float(src_f[i], dst + i * 4);
+		else
+			encode_float(src_r[i], dst + i * 4);
+	}
+}
+
+static Error _encode_compact(const Variant &p_variant, _CompactWriter &w, const MarshallKeyTable *p_key_table, bool p_object_as_id) {
+
+	Variant::Type type = p_variant.get_type();
+
+	switch (type) {
+
+		case Variant::NIL:
+		case Variant::_RID: {
+
+			w.put_u8(type);
+		} break;
+		case Variant::BOOL: {
+
+			w.put_u8(type | (p_variant.operator bool() ? COMPACT_FLAG_A : 0));
+		} break;
+		case Variant::INT: {
+
+			int64_t val = p_variant;
+			w.put_u8(type);
+			w.put_varint((uint64_t(val) << 1) ^ uint64_t(val >> 63)); // Zig-zag, small negatives stay small
+		} break;
+		case Variant::REAL: {
+
+			double d = p_variant;
+			float f = d;
+			if (double(f) != d) {
+				w.put_u8(type | COMPACT_FLAG_A);
+				encode_double(d, w.put(8));
+			} else {
+				w.put_u8(type);
+				w.put_float(f);
+			}
+		} break;
+		case Variant::STRING: {
+
+			String str = p_variant;
+			int key = p_key_table ? p_key_table->find_key(str) : -1;
+			if (key >= 0) {
+				w.put_u8(type | COMPACT_FLAG_A);
+				w.put_varint(key);
+			} else {
+				w.put_u8(type);
+				w.put_string(str);
+			}
+		} break;
+		case Variant::VECTOR2: {
+
+			Vector2 v = p_variant;
+			w.put_u8(type);
+			w.put_float(v.x);
+			w.put_float(v.y);
+		} break;
+		case Variant::RECT2: {
+
+			Rect2 r = p_variant;
+			w.put_u8(type);
+			w.put_float(r.position.x);
+			w.put_float(r.position.y);
+			w.put_float(r.size.x);
+			w.put_float(r.size.y);
+		} break;
+		case Variant::VECTOR3: {
+
+			Vector3 v = p_variant;
+			w.put_u8(type);
+			w.put_float(v.x);
+			w.put_float(v.y);
+			w.put_float(v.z);
+		} break;
+		case Variant::TRANSFORM2D: {
+
+			Transform2D t = p_variant;
+			w.put_u8(type);
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 2; j++) {
+					w.put_float(t.elements[i][j]);
+				}
+			}
+		} break;
+		case Variant::PLANE: {
+
+			Plane p = p_variant;
+			w.put_u8(type);
+			w.put_float(p.normal.x);
+			w.put_float(p.normal.y);
+			w.put_float(p.normal.z);
+			w.put_float(p.d);
+		} break;
+		case Variant::QUAT: {
+
+			Quat q = p_variant;
+			w.put_u8(type);
+			w.put_float(q.x);
+			w.put_float(q.y);
+			w.put_float(q.z);
+			w.put_float(q.w);
+		} break;
+		case Variant::AABB: {
+
+			AABB aabb = p_variant;
+			w.put_u8(type);
+			w.put_float(aabb.position.x);
+			w.put_float(aabb.position.y);
+			w.put_float(aabb.position.z);
+			w.put_float(aabb.size.x);
+			w.put_float(aabb.size.y);
+			w.put_float(aabb.size.z);
+		} break;
+		case Variant::BASIS: {
+
+			Basis b = p_variant;
+			w.put_u8(type);
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					w.put_float(b.elements[i][j]);
+				}
+			}
+		} break;
+		case Variant::TRANSFORM: {
+
+			Transform t = p_variant;
+			w.put_u8(type);
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					w.put_float(t.basis.elements[i][j]);
+				}
+			}
+			w.put_float(t.origin.x);
+			w.put_float(t.origin.y);
+			w.put_float(t.origin.z);
+		} break;
+		case Variant::COLOR: {
+
+			Color c = p_variant;
+			w.put_u8(type);
+			w.put_float(c.r);
+			w.put_float(c.g);
+			w.put_float(c.b);
+			w.put_float(c.a);
+		} break;
+		case Variant::NODE_PATH: {
+
+			NodePath np = p_variant;
+			w.put_u8(type);
+			w.put_varint(np.get_name_count());
+			w.put_varint(np.get_subname_count());
+			w.put_u8(np.is_absolute() ? 1 : 0);
+			for (int i = 0; i < np.get_name_count(); i++) {
+				w.put_string(np.get_name(i));
+			}
+			for (int i = 0; i < np.get_subname_count(); i++) {
+				w.put_string(np.get_subname(i));
+			}
+		} break;
+		case Variant::OBJECT: {
+
+			Object *obj = p_variant;
+
+			if (p_object_as_id) {
+
+				ObjectID id = 0;
+				if (obj && ObjectDB::instance_validate(obj)) {
+					id = obj->get_instance_id();
+				}
+				w.put_u8(type | COMPACT_FLAG_A);
+				w.put_varint(id);
+
+			} else if (!obj) {
+
+				w.put_u8(type | COMPACT_FLAG_B);
+
+			} else {
+
+				w.put_u8(type);
+				w.put_string(obj->get_class());
+
+				List<PropertyInfo> props;
+				obj->get_property_list(&props);
+
+				int pc = 0;
+				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+					if (E->get().usage & PROPERTY_USAGE_STORAGE)
+						pc++;
+				}
+				w.put_varint(pc);
+
+				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+					if (!(E->get().usage & PROPERTY_USAGE_STORAGE))
+						continue;
+
+					w.put_string(E->get().name);
+					Error err = _encode_compact(obj->get(E->get().name), w, p_key_table, p_object_as_id);
+					if (err)
+						return err;
+				}
+			}
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary d = p_variant;
+			w.put_u8(type);
+			w.put_varint(d.size());
+
+			// Walks the dictionary in place, get_key_list() would copy every key into a List
+			const Variant *key = NULL;
+			while ((key = d.next(key))) {
+
+				Error err = _encode_compact(*key, w, p_key_table, p_object_as_id);
+				if (err)
+					return err;
+				err = _encode_compact(d[*key], w, p_key_table, p_object_as_id);
+				if (err)
+					return err;
+			}
+		} break;
+		case Variant::ARRAY: {
+
+			Array a = p_variant;
+			w.put_u8(type);
+			w.put_varint(a.size());
+
+			for (int i = 0; i < a.size(); i++) {
+
+				Error err = _encode_compact(a[i], w, p_key_table, p_object_as_id);
+				if (err)
+					return err;
+			}
+		} break;
+		case Variant::POOL_BYTE_ARRAY: {
+
+			PoolVector<uint8_t> data = p_variant;
+			int len = data.size();
+			w.put_u8(type);
+			w.put_varint(len);
+			if (len) {
+				PoolVector<uint8_t>::Read r = data.read();
+				copymem(w.put(len), r.ptr(), len);
+			}
+		} break;
+		case Variant::POOL_INT_ARRAY: {
+
+			w.put_u8(type);
+			_encode_compact_pool_array<int>(w, p_variant, 1);
+		} break;
+		case Variant::POOL_REAL_ARRAY: {
+
+			w.put_u8(type);
+			_encode_compact_pool_array<real_t>(w, p_variant, 1);
+		} break;
+		case Variant::POOL_STRING_ARRAY: {
+
+			PoolVector<String> data = p_variant;
+			int len = data.size();
+			w.put_u8(type);
+			w.put_varint(len);
+
+			PoolVector<String>::Read r = data.read();
+			for (int i = 0; i < len; i++) {
+				w.put_string(r[i]);
+			}
+		} break;
+		case Variant::POOL_VECTOR2_ARRAY: {
+
+			w.put_u8(type);
+			_encode_compact_pool_array<Vector2>(w, p_variant, 2);
+		} break;
+		case Variant::POOL_VECTOR3_ARRAY: {
+
+			w.put_u8(type);
+			_encode_compact_pool_array<Vector3>(w, p_variant, 3);
+		} break;
+		case Variant::POOL_COLOR_ARRAY: {
+
+			w.put_u8(type);
+			_encode_compact_pool_array<Color>(w, p_variant, 4);
+		} break;
+		default: { ERR_FAIL_V(ERR_BUG); }
+	}
+
+	return OK;
+}
+
+Error encode_variant_compact(const Variant &p_variant, Vector<uint8_t> &r_buffer, int &r_len, int p_offset, const MarshallKeyTable *p_key_table, bool p_object_as_id) {
+
+	ERR_FAIL_COND_V(p_offset < 0, ERR_INVALID_PARAMETER);
+
+	_CompactWriter w(r_buffer, p_offset);
+	w.put_u8(ENCODE_COMPACT_MARKER);
+
+	Error err = _encode_compact(p_variant, w, p_key_table, p_object_as_id);
+	r_len = err == OK ? w.pos - p_offset : 0;
+
+	return err;
+}
+
+struct _CompactReader {
+
+	const uint8_t *ptr;
+	const uint8_t *end;
+
+	_FORCE_INLINE_ bool has(int p_bytes) const {
+		return p_bytes >= 0 && end - ptr >= p_bytes;
+	}
+
+	_FORCE_INLINE_ bool get_varint(uint64_t &r_value) {
+
+		r_value = 0;
+		for (int shift = 0; shift < 64 && ptr < end; shift += 7) {
+			uint8_t b = *(ptr++);
+			r_value |= uint64_t(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	_FORCE_INLINE_ bool get_count(int &r_count) {
+
+		// Every element takes at least one byte, this guards against huge allocations on corrupt data
+		uint64_t v;
+		if (!get_varint(v) || v > uint64_t(end - ptr) || v > 0x7FFFFFFF)
+			return false;
+		r_count = int(v);
+		return true;
+	}
+
+	_FORCE_INLINE_ bool get_float(float &r_value) {
+
+		if (!has(4))
+			return false;
+		r_value = decode_float(ptr);
+		ptr += 4;
+		return true;
+	}
+
+	_FORCE_INLINE_ bool get_floats(real_t *r_values, int p_count) {
+
+		if (!has(p_count * 4))
+			return false;
+		for (int i = 0; i < p_count; i++) {
+			r_values[i] = decode_float(ptr + i * 4);
+		}
+		ptr += p_count * 4;
+		return true;
+	}
+
+	_FORCE_INLINE_ bool get_string(String &r_string) {
+
+		int len;
+		if (!get_count(len))
+			return false;
+		r_string = String();
+		if (len) {
+			r_string.parse_utf8((const char *)ptr, len);
+			ptr += len;
+		}
+		return true;
+	}
+};
+
+#define COMPACT_READ_FAIL(m_cond) ERR_FAIL_COND_V(!(m_cond), ERR_INVALID_DATA)
+
+template <class T>
+static Error _decode_compact_pool_array(Variant &r_variant, _CompactReader &r, int p_components) {
+
+	int len;
+	COMPACT_READ_FAIL(r.get_count(len));
+	COMPACT_READ_FAIL(len <= 0x7FFFFFFF / (p_components * 4)); // len * p_components * 4 must not overflow
+	COMPACT_READ_FAIL(r.has(len * p_components * 4));
+
+	PoolVector<T> data;
+	if (len) {
+		data.resize(len);
+		typename PoolVector<T>::Write w = data.write();
+#ifndef BIG_ENDIAN_ENABLED
+		if (sizeof(T) == size_t(p_components * 4)) {
+			copymem(w.ptr(), r.ptr, len * p_components * 4);
+		} else
+#endif
+		{
+			float *dst_f = (float *)w.ptr();
+			real_t *dst_r = (real_t *)w.ptr();
+			for (int i = 0; i < len * p_components; i++) {
+				if (sizeof(T) == size_t(p_components * sizeof(float)))
+					dst_f[i] = decode_float(r.ptr + i * 4);
+				else
+					dst_r[i] = decode_float(r.ptr + i * 4);
+			}
+		}
+		r.ptr += len * p_components * 4;
+	}
+
+	r_variant = data;
+	return OK;
+}
+
+static Error _decode_compact(Variant &r_variant, _CompactReader &r, const MarshallKeyTable *p_key_table, bool p_allow_objects, int p_depth) {
+
+	ERR_FAIL_COND_V(p_depth > COMPACT_MAX_DEPTH, ERR_INVALID_DATA);
+	COMPACT_READ_FAIL(r.has(1));
+	uint8_t header = *(r.ptr++);
+	int type = header & COMPACT_TYPE_MASK;
+
+	ERR_FAIL_COND_V(type >= Variant::VARIANT_MAX, ERR_INVALID_DATA);
+
+	switch (type) {
+
+		case Variant::NIL: {
+
+			r_variant = Variant();
+		} break;
+		case Variant::_RID: {
+
+			r_variant = RID();
+		} break;
+		case Variant::BOOL: {
+
+			r_variant = bool(header & COMPACT_FLAG_A);
+		} break;
+		case Variant::INT: {
+
+			uint64_t v;
+			COMPACT_READ_FAIL(r.get_varint(v));
+			r_variant = int64_t(v >> 1) ^ -int64_t(v & 1);
+		} break;
+		case Variant::REAL: {
+
+			if (header & COMPACT_FLAG_A) {
+				COMPACT_READ_FAIL(r.has(8));
+				r_variant = decode_double(r.ptr);
+				r.ptr += 8;
+			} else {
+				float f;
+				COMPACT_READ_FAIL(r.get_float(f));
+				r_variant = f;
+			}
+		} break;
+		case Variant::STRING: {
+
+			if (header & COMPACT_FLAG_A) {
+				uint64_t key;
+				COMPACT_READ_FAIL(r.get_varint(key));
+				ERR_EXPLAIN("Data was encoded with a key table, which must also be given to decode it");
+				ERR_FAIL_COND_V(!p_key_table, ERR_UNAVAILABLE);
+				ERR_FAIL_COND_V(key >= uint64_t(p_key_table->get_key_count()), ERR_INVALID_DATA);
+				r_variant = p_key_table->get_key(key);
+			} else {
+				String str;
+				COMPACT_READ_FAIL(r.get_string(str));
+				r_variant = str;
+			}
+		} break;
+		case Variant::VECTOR2: {
+
+			Vector2 v;
+			COMPACT_READ_FAIL(r.get_floats(&v.x, 2));
+			r_variant = v;
+		} break;
+		case Variant::RECT2: {
+
+			real_t f[4];
+			COMPACT_READ_FAIL(r.get_floats(f, 4));
+			r_variant = Rect2(f[0], f[1], f[2], f[3]);
+		} break;
+		case Variant::VECTOR3: {
+
+			Vector3 v;
+			COMPACT_READ_FAIL(r.get_floats(&v.x, 3));
+			r_variant = v;
+		} break;
+		case Variant::TRANSFORM2D: {
+
+			Transform2D t;
+			for (int i = 0; i < 3; i++) {
+				COMPACT_READ_FAIL(r.get_floats(&t.elements[i].x, 2));
+			}
+			r_variant = t;
+		} break;
+		case Variant::PLANE: {
+
+			real_t f[4];
+			COMPACT_READ_FAIL(r.get_floats(f, 4));
+			r_variant = Plane(f[0], f[1], f[2], f[3]);
+		} break;
+		case Variant::QUAT: {
+
+			real_t f[4];
+			COMPACT_READ_FAIL(r.get_floats(f, 4));
+			r_variant = Quat(f[0], f[1], f[2], f[3]);
+		} break;
+		case Variant::AABB: {
+
+			real_t f[6];
+			COMPACT_READ_FAIL(r.get_floats(f, 6));
+			r_variant = AABB(Vector3(f[0], f[1], f[2]), Vector3(f[3], f[4], f[5]));
+		} break;
+		case Variant::BASIS: {
+
+			Basis b;
+			for (int i = 0; i < 3; i++) {
+				COMPACT_READ_FAIL(r.get_floats(&b.elements[i].x, 3));
+			}
+			r_variant = b;
+		} break;
+		case Variant::TRANSFORM: {
+
+			Transform t;
+			for (int i = 0; i < 3; i++) {
+				COMPACT_READ_FAIL(r.get_floats(&t.basis.elements[i].x, 3));
+			}
+			COMPACT_READ_FAIL(r.get_floats(&t.origin.x, 3));
+			r_variant = t;
+		} break;
+		case Variant::COLOR: {
+
+			Color c;
+			COMPACT_READ_FAIL(r.get_float(c.r) && r.get_float(c.g) && r.get_float(c.b) && r.get_float(c.a));
+			r_variant = c;
+		} break;
+		case Variant::NODE_PATH: {
+
+			int name_count, subname_count;
+			COMPACT_READ_FAIL(r.get_count(name_count) && r.get_count(subname_count) && r.has(1));
+			bool absolute = *(r.ptr++) & 1;
+
+			Vector<StringName> names;
+			Vector<StringName> subnames;
+			names.resize(name_count);
+			subnames.resize(subname_count);
+
+			String str;
+			for (int i = 0; i < name_count; i++) {
+				COMPACT_READ_FAIL(r.get_string(str));
+				names[i] = str;
+			}
+			for (int i = 0; i < subname_count; i++) {
+				COMPACT_READ_FAIL(r.get_string(str));
+				subnames[i] = str;
+			}
+
+			r_variant = NodePath(names, subnames, absolute);
+		} break;
+		case Variant::OBJECT: {
+
+			if (header & COMPACT_FLAG_A) {
+
+				uint64_t id;
+				COMPACT_READ_FAIL(r.get_varint(id));
+				if (id == 0) {
+					r_variant = (Object *)NULL;
+				} else {
+					Ref<EncodedObjectAsID> obj_as_id;
+					obj_as_id.instance();
+					obj_as_id->set_object_id(id);
+					r_variant = obj_as_id;
+				}
+
+			} else if (header & COMPACT_FLAG_B) {
+
+				r_variant = (Object *)NULL;
+
+			} else {
+
+				ERR_FAIL_COND_V(!p_allow_objects, ERR_UNAUTHORIZED);
+
+				String str;
+				COMPACT_READ_FAIL(r.get_string(str));
+
+				Object *obj = ClassDB::instance(str);
+				ERR_FAIL_COND_V(!obj, ERR_UNAVAILABLE);
+
+				// Hold references right away, so they are freed if decoding fails
+				if (Object::cast_to<Reference>(obj)) {
+					r_variant = REF(Object::cast_to<Reference>(obj));
+				} else {
+					r_variant = obj;
+				}
+
+				int count;
+				COMPACT_READ_FAIL(r.get_count(count));
+
+				Variant value;
+				for (int i = 0; i < count; i++) {
+
+					COMPACT_READ_FAIL(r.get_string(str));
+					Error err = _decode_compact(value, r, p_key_table, p_allow_objects, p_depth + 1);
+					if (err)
+						return err;
+
+					obj->set(str, value);
+				}
+			}
+		} break;
+		case Variant::DICTIONARY: {
+
+			int count;
+			COMPACT_READ_FAIL(r.get_count(count));
+
+			Dictionary d;
+			Variant key;
+			for (int i = 0; i < count; i++) {
+
+				Error err = _decode_compact(key, r, p_key_table, p_allow_objects, p_depth + 1);
+				if (err)
+					return err;
+
+				// Decodes straight into the dictionary slot
+				err = _decode_compact(d[key], r, p_key_table, p_allow_objects, p_depth + 1);
+				if (err)
+					return err;
+			}
+
+			r_variant = d;
+		} break;
+		case Variant::ARRAY: {
+
+			int count;
+			COMPACT_READ_FAIL(r.get_count(count));
+
+			Array a;
+			a.resize(count);
+			for (int i = 0; i < count; i++) {
+
+				Error err = _decode_compact(a[i], r, p_key_table, p_allow_objects, p_depth + 1);
+				if (err)
+					return err;
+			}
+
+			r_variant = a;
+		} break;
+		case Variant::POOL_BYTE_ARRAY: {
+
+			int len;
+			COMPACT_READ_FAIL(r.get_count(len));
+
+			PoolVector<uint8_t> data;
+			if (len) {
+				data.resize(len);
+				PoolVector<uint8_t>::Write w = data.write();
+				copymem(w.ptr(), r.ptr, len);
+				r.ptr += len;
+			}
+
+			r_variant = data;
+		} break;
+		case Variant::POOL_INT_ARRAY: {
+
+			return _decode_compact_pool_array<int>(r_variant, r, 1);
+		} break;
+		case Variant::POOL_REAL_ARRAY: {
+
+			return _decode_compact_pool_array<real_t>(r_variant, r, 1);
+		} break;
+		case Variant::POOL_STRING_ARRAY: {
+
+			int len;
+			COMPACT_READ_FAIL(r.get_count(len));
+
+			PoolVector<String> data;
+			if (len) {
+				data.resize(len);
+				PoolVector<String>::Write w = data.write();
+				for (int i = 0; i < len; i++) {
+					COMPACT_READ_FAIL(r.get_string(w[i]));
+				}
+			}
+
+			r_variant = data;
+		} break;
+		case Variant::POOL_VECTOR2_ARRAY: {
+
+			return _decode_compact_pool_array<Vector2>(r_variant, r, 2);
+		} break;
+		case Variant::POOL_VECTOR3_ARRAY: {
+
+			return _decode_compact_pool_array<Vector3>(r_variant, r, 3);
+		} break;
+		case Variant::POOL_COLOR_ARRAY: {
+
+			return _decode_compact_pool_array<Color>(r_variant, r, 4);
+		} break;
+		default: { ERR_FAIL_V(ERR_BUG); }
+	}
+
+	return OK;
+}
+
+Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, const MarshallKeyTable *p_key_table, bool p_allow_objects) {
+
+	ERR_FAIL_COND_V(p_len < 2, ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(p_buffer[0] != ENCODE_COMPACT_MARKER, ERR_INVALID_DATA);
+
+	_CompactReader r;
+	r.ptr = p_buffer + 1;
+	r.end = p_buffer + p_len;
+
+	Error err = _decode_compact(r_variant, r, p_key_table, p_allow_objects, 0);
+	if (err)
+		return err;
+
+	if (r_len)
+		*r_len = r.ptr - p_buffer;
+
+	return OK;
+}
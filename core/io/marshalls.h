@@ -33,6 +33,7 @@
 
 #include "typedefs.h"
 
+#include "hash_map.h"
 #include "reference.h"
 #include "variant.h"
 /**
@@ -199,7 +200,36 @@ public:
 	EncodedObjectAsID();
 };
 
+/**
+  * Strings shared by both ends of a compact encoding (e.g. the keys of save
+  * game dictionaries), so they are written as a small index instead.
+  */
+
+class MarshallKeyTable {
+
+	Vector<String> keys;
+	HashMap<String, int> indices;
+
+public:
+	int add_key(const String &p_key);
+	int find_key(const String &p_key) const;
+	String get_key(int p_index) const;
+	int get_key_count() const;
+	void clear();
+};
+
 Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = NULL, bool p_allow_objects = true);
 Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_object_as_id = false);
 
+/**
+  * Compact encoding: written in a single pass into a growing buffer, with
+  * varint integers and lengths, no padding and raw little endian pool arrays.
+  * It is tagged so decode_variant() recognizes it too (without a key table).
+  * The buffer is written from p_offset and may be left larger than needed,
+  * r_len returns the amount of bytes actually encoded.
+  */
+
+Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = NULL, const MarshallKeyTable *p_key_table = NULL, bool p_allow_objects = true);
+Error encode_variant_compact(const Variant &p_variant, Vector<uint8_t> &r_buffer, int &r_len, int p_offset = 0, const MarshallKeyTable *p_key_table = NULL, bool p_object_as_id = false);
+
 #endif
@@ -37,6 +37,7 @@
 PacketPeer::PacketPeer() {
 
 	allow_object_decoding = false;
+	compact_encoding = false;
 	last_get_error = OK;
 }
 
@@ -50,6 +51,16 @@ bool PacketPeer::is_object_decoding_allowed() const {
 	return allow_object_decoding;
 }
 
+void PacketPeer::set_compact_encoding(bool p_enable) {
+
+	compact_encoding = p_enable;
+}
+
+bool PacketPeer::is_compact_encoding_enabled() const {
+
+	return compact_encoding;
+}
+
 Error PacketPeer::get_packet_buffer(PoolVector<uint8_t> &r_buffer) {
 
 	const uint8_t *buffer;
@@ -92,6 +103,15 @@ Error PacketPeer::get_var(Variant &r_variant) {
 
 Error PacketPeer::put_var(const Variant &p_packet) {
 
+	if (compact_encoding) {
+		// single pass, the buffer is kept around so steady traffic does not allocate
+		int len = 0;
+		Error err = encode_variant_compact(p_packet, encode_buffer, len, 0, NULL, !allow_object_decoding);
+		ERR_FAIL_COND_V(err, err);
+
+		return put_packet(encode_buffer.ptr(), len);
+	}
+
 	int len;
 	Error err = encode_variant(p_packet, NULL, len, !allow_object_decoding); // compute len first
 	if (err)
@@ -142,7 +162,11 @@ void PacketPeer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_allow_object_decoding", "enable"), &PacketPeer::set_allow_object_decoding);
 	ClassDB::bind_method(D_METHOD("is_object_decoding_allowed"), &PacketPeer::is_object_decoding_allowed);
 
+	ClassDB::bind_method(D_METHOD("set_compact_encoding", "enable"), &PacketPeer::set_compact_encoding);
+	ClassDB::bind_method(D_METHOD("is_compact_encoding_enabled"), &PacketPeer::is_compact_encoding_enabled);
+
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "allow_object_decoding"), "set_allow_object_decoding", "is_object_decoding_allowed");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compact_encoding"), "set_compact_encoding", "is_compact_encoding_enabled");
 };
 
 /***************/
@@ -50,6 +50,9 @@ class PacketPeer : public Reference {
 	mutable Error last_get_error;
 
 	bool allow_object_decoding;
+	bool compact_encoding;
+
+	Vector<uint8_t> encode_buffer;
 
 public:
 	virtual int get_available_packet_count() const = 0;
@@ -69,6 +72,9 @@ public:
 	void set_allow_object_decoding(bool p_enable);
 	bool is_object_decoding_allowed() const;
 
+	void set_compact_encoding(bool p_enable);
+	bool is_compact_encoding_enabled() const;
+
 	PacketPeer();
 	~PacketPeer() {}
 };
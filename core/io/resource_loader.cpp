@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "resource_loader.h"
+#include "frame_profiler.h"
 #include "io/resource_import.h"
 #include "os/file_access.h"
 #include "os/os.h"
@@ -189,6 +190,8 @@ RES ResourceLoader::_load(const String &p_path, const String &p_original_path, c
 
 RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
 
+	FRAME_PROFILE_SCOPE("loader/load");
+
 	if (r_error)
 		*r_error = ERR_CANT_OPEN;
 
@@ -0,0 +1,260 @@
+/*************************************************************************/
+/*  local_vector.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef LOCAL_VECTOR_H
+#define LOCAL_VECTOR_H
+
+#include "error_macros.h"
+#include "os/memory.h"
+#include "sort.h"
+#include "vector.h"
+
+/**
+ * @class LocalVector
+ *
+ * Array that is never shared: no refcount, no copy on write, and it keeps a
+ * capacity so push_back() only reallocates when it doubles. Meant for engine
+ * internals that own their arrays and access them in hot loops. Copying it
+ * copies the elements, so pass it by reference.
+ *
+ * Like Vector, elements are moved with realloc and must not hold pointers to
+ * themselves.
+ */
+
+template <class T>
+class LocalVector {
+
+	T *data;
+	uint32_t count;
+	uint32_t capacity;
+
+public:
+	_FORCE_INLINE_ T *ptr() { return data; }
+	_FORCE_INLINE_ const T *ptr() const { return data; }
+
+	_FORCE_INLINE_ int size() const { return count; }
+	_FORCE_INLINE_ bool empty() const { return count == 0; }
+	_FORCE_INLINE_ int get_capacity() const { return capacity; }
+
+	_FORCE_INLINE_ void push_back(const T &p_elem) {
+
+		if (unlikely(count == capacity)) {
+			T value = p_elem; // may be an element of this vector
+			reserve(capacity ? capacity * 2 : 4);
+			memnew_placement(&data[count++], T(value));
+			return;
+		}
+		memnew_placement(&data[count++], T(p_elem));
+	}
+
+	void reserve(int p_size) {
+
+		ERR_FAIL_COND(p_size < 0);
+		if (uint32_t(p_size) > capacity) {
+			capacity = p_size;
+			data = (T *)memrealloc(data, capacity * sizeof(T));
+			CRASH_COND(!data);
+		}
+	}
+
+	void resize(int p_size) {
+
+		ERR_FAIL_COND(p_size < 0);
+		if (uint32_t(p_size) < count) {
+			for (uint32_t i = p_size; i < count; i++) {
+				data[i].~T();
+			}
+			count = p_size;
+		} else if (uint32_t(p_size) > count) {
+			reserve(p_size);
+			for (uint32_t i = count; i < uint32_t(p_size); i++) {
+				memnew_placement(&data[i], T);
+			}
+			count = p_size;
+		}
+	}
+
+	// keeps the memory for reuse
+	_FORCE_INLINE_ void clear() { resize(0); }
+
+	// frees the memory
+	void reset() {
+
+		clear();
+		if (data) {
+			memfree(data);
+			data = NULL;
+			capacity = 0;
+		}
+	}
+
+	void remove(int p_index) {
+
+		ERR_FAIL_INDEX(p_index, int(count));
+		count--;
+		for (uint32_t i = p_index; i < count; i++) {
+			data[i] = data[i + 1];
+		}
+		data[count].~T();
+	}
+
+	// moves the last element in place of the removed one, doesn't keep the order
+	void remove_unordered(int p_index) {
+
+		ERR_FAIL_INDEX(p_index, int(count));
+		count--;
+		if (uint32_t(p_index) < count) {
+			data[p_index] = data[count];
+		}
+		data[count].~T();
+	}
+
+	void erase(const T &p_val) {
+
+		int idx = find(p_val);
+		if (idx >= 0)
+			remove(idx);
+	}
+
+	void insert(int p_pos, const T &p_val) {
+
+		ERR_FAIL_INDEX(p_pos, int(count) + 1);
+		if (uint32_t(p_pos) == count) {
+			push_back(p_val);
+			return;
+		}
+		T value = p_val; // may be an element of this vector
+		resize(count + 1);
+		for (uint32_t i = count - 1; i > uint32_t(p_pos); i--) {
+			data[i] = data[i - 1];
+		}
+		data[p_pos] = value;
+	}
+
+	void invert() {
+
+		for (uint32_t i = 0; i < count / 2; i++) {
+			SWAP(data[i], data[count - i - 1]);
+		}
+	}
+
+	template <class T_val>
+	int find(const T_val &p_val, int p_from = 0) const {
+
+		for (uint32_t i = MAX(0, p_from); i < count; i++) {
+			if (data[i] == p_val)
+				return i;
+		}
+		return -1;
+	}
+
+	template <class C>
+	void sort_custom() {
+
+		if (count == 0)
+			return;
+		SortArray<T, C> sorter;
+		sorter.sort(data, count);
+	}
+
+	void sort() {
+
+		sort_custom<_DefaultComparator<T> >();
+	}
+
+	_FORCE_INLINE_ T &operator[](int p_index) {
+
+		CRASH_BAD_INDEX(p_index, int(count));
+		return data[p_index];
+	}
+
+	_FORCE_INLINE_ const T &operator[](int p_index) const {
+
+		CRASH_BAD_INDEX(p_index, int(count));
+		return data[p_index];
+	}
+
+	operator Vector<T>() const {
+
+		Vector<T> ret;
+		ret.resize(count);
+		T *w = ret.ptrw();
+		for (uint32_t i = 0; i < count; i++) {
+			w[i] = data[i];
+		}
+		return ret;
+	}
+
+	void operator=(const LocalVector &p_from) {
+
+		if (&p_from == this)
+			return;
+		clear();
+		reserve(p_from.count);
+		for (uint32_t i = 0; i < p_from.count; i++) {
+			memnew_placement(&data[i], T(p_from.data[i]));
+		}
+		count = p_from.count;
+	}
+
+	void operator=(const Vector<T> &p_from) {
+
+		clear();
+		reserve(p_from.size());
+		const T *r = p_from.ptr();
+		for (int i = 0; i < p_from.size(); i++) {
+			memnew_placement(&data[i], T(r[i]));
+		}
+		count = p_from.size();
+	}
+
+	LocalVector(const LocalVector &p_from) {
+
+		data = NULL;
+		count = 0;
+		capacity = 0;
+		*this = p_from;
+	}
+
+	_FORCE_INLINE_ LocalVector() {
+
+		data = NULL;
+		count = 0;
+		capacity = 0;
+	}
+
+	_FORCE_INLINE_ ~LocalVector() {
+
+		reset();
+	}
+};
+
+#endif // LOCAL_VECTOR_H
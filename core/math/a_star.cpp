@@ -30,16 +30,25 @@
 
 #include "a_star.h"
 #include "geometry.h"
+#include "os/thread_work_pool.h"
 #include "scene/scene_string_names.h"
 #include "script_language.h"
 
 int AStar::get_available_point_id() const {
 
-	if (points.empty()) {
+	if (point_list.empty()) {
 		return 1;
 	}
 
-	return points.back()->key() + 1;
+	if (last_id_dirty) {
+		last_id = 0;
+		for (int i = 0; i < point_list.size(); i++) {
+			last_id = MAX(last_id, point_list[i]->id);
+		}
+		last_id_dirty = false;
+	}
+
+	return last_id + 1;
 }
 
 void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
@@ -47,287 +56,680 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 	ERR_FAIL_COND(p_id < 0);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	if (!points.has(p_id)) {
-		Point *pt = memnew(Point);
-		pt->id = p_id;
-		pt->pos = p_pos;
-		pt->weight_scale = p_weight_scale;
-		pt->prev_point = NULL;
-		pt->last_pass = 0;
-		points[p_id] = pt;
+	Point *found = _get_point(p_id);
+	if (found) {
+		found->pos = p_pos;
+		found->weight_scale = p_weight_scale;
+		point_grid_dirty = true;
+		segment_grid_dirty = true;
+		return;
+	}
+
+	Point *pt = memnew(Point);
+	pt->id = p_id;
+	pt->index = point_list.size();
+	pt->pos = p_pos;
+	pt->weight_scale = p_weight_scale;
+	point_list.push_back(pt);
+
+	if (p_id < dense_points.size() || p_id < point_list.size() * 2 + DENSE_POINTS_MIN) {
+		if (p_id >= dense_points.size()) {
+			int from = dense_points.size();
+			dense_points.resize(next_power_of_2(p_id + 1));
+			for (int i = from; i < dense_points.size(); i++) {
+				dense_points[i] = NULL;
+			}
+		}
+		dense_points[p_id] = pt;
 	} else {
-		points[p_id]->pos = p_pos;
-		points[p_id]->weight_scale = p_weight_scale;
+		sparse_points.set(p_id, pt);
 	}
+
+	if (!last_id_dirty && p_id > last_id) {
+		last_id = p_id;
+	}
+	point_grid_dirty = true;
 }
 
 Vector3 AStar::get_point_position(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), Vector3());
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, Vector3());
 
-	return points[p_id]->pos;
+	return p->pos;
 }
 
 void AStar::set_point_position(int p_id, const Vector3 &p_pos) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 
-	points[p_id]->pos = p_pos;
+	p->pos = p_pos;
+	point_grid_dirty = true;
+	segment_grid_dirty = true;
 }
 
 real_t AStar::get_point_weight_scale(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), 0);
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, 0);
 
-	return points[p_id]->weight_scale;
+	return p->weight_scale;
 }
 
 void AStar::set_point_weight_scale(int p_id, real_t p_weight_scale) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	points[p_id]->weight_scale = p_weight_scale;
+	p->weight_scale = p_weight_scale;
 }
 
 void AStar::remove_point(int p_id) {
 
-	ERR_FAIL_COND(!points.has(p_id));
-
-	Point *p = points[p_id];
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 
 	for (int i = 0; i < p->neighbours.size(); i++) {
+		Point *n = p->neighbours[i];
+		n->neighbours.erase(p);
+		n->unlinked_neighbours.erase(p);
+	}
 
-		Segment s(p_id, p->neighbours[i]->id);
-		segments.erase(s);
-		p->neighbours[i]->neighbours.erase(p);
+	for (int i = 0; i < p->unlinked_neighbours.size(); i++) {
+		p->unlinked_neighbours[i]->neighbours.erase(p);
+	}
+
+	if (p_id < dense_points.size() && dense_points[p_id] == p) {
+		dense_points[p_id] = NULL;
+	} else {
+		sparse_points.erase(p_id);
+	}
+
+	point_list.remove_unordered(p->index);
+	if (p->index < point_list.size()) {
+		point_list[p->index]->index = p->index;
 	}
 
 	memdelete(p);
-	points.erase(p_id);
+
+	last_id_dirty = true;
+	point_grid_dirty = true;
+	segment_grid_dirty = true;
+}
+
+void AStar::_link(Point *p_from, Point *p_to) {
+
+	if (p_from->neighbours.find(p_to) != -1)
+		return;
+
+	p_from->neighbours.push_back(p_to);
+	// a one way connection in the other direction becomes a regular one
+	p_from->unlinked_neighbours.erase(p_to);
+
+	if (p_to->neighbours.find(p_from) == -1 && p_to->unlinked_neighbours.find(p_from) == -1) {
+		p_to->unlinked_neighbours.push_back(p_from);
+	}
+}
+
+void AStar::_unlink(Point *p_from, Point *p_to) {
+
+	p_from->neighbours.erase(p_to);
+	p_from->unlinked_neighbours.erase(p_to);
 }
 
 void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 
-	ERR_FAIL_COND(!points.has(p_id));
-	ERR_FAIL_COND(!points.has(p_with_id));
+	Point *a = _get_point(p_id);
+	Point *b = _get_point(p_with_id);
+	ERR_FAIL_COND(!a);
+	ERR_FAIL_COND(!b);
 	ERR_FAIL_COND(p_id == p_with_id);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.push_back(b);
+	_link(a, b);
 
 	if (bidirectional)
-		b->neighbours.push_back(a);
-
-	Segment s(p_id, p_with_id);
-	if (s.from == p_id) {
-		s.from_point = a;
-		s.to_point = b;
-	} else {
-		s.from_point = b;
-		s.to_point = a;
-	}
+		_link(b, a);
 
-	segments.insert(s);
+	segment_grid_dirty = true;
 }
 void AStar::disconnect_points(int p_id, int p_with_id) {
 
-	Segment s(p_id, p_with_id);
-	ERR_FAIL_COND(!segments.has(s));
+	ERR_FAIL_COND(!are_points_connected(p_id, p_with_id));
 
-	segments.erase(s);
+	Point *a = _get_point(p_id);
+	Point *b = _get_point(p_with_id);
+	_unlink(a, b);
+	_unlink(b, a);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.erase(b);
-	b->neighbours.erase(a);
+	segment_grid_dirty = true;
 }
 
 bool AStar::has_point(int p_id) const {
 
-	return points.has(p_id);
+	return _get_point(p_id) != NULL;
 }
 
 Array AStar::get_points() {
 
-	Array point_list;
+	// ids were listed in order when points were kept in a Map, keep it that way
+	LocalVector<int> ids;
+	ids.resize(point_list.size());
+	for (int i = 0; i < point_list.size(); i++) {
+		ids[i] = point_list[i]->id;
+	}
+	ids.sort();
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
-		point_list.push_back(E->key());
+	Array ret;
+	ret.resize(ids.size());
+	for (int i = 0; i < ids.size(); i++) {
+		ret[i] = ids[i];
 	}
 
-	return point_list;
+	return ret;
 }
 
 PoolVector<int> AStar::get_point_connections(int p_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_id), PoolVector<int>());
-
-	PoolVector<int> point_list;
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, PoolVector<int>());
 
-	Point *p = points[p_id];
+	PoolVector<int> connections;
+	connections.resize(p->neighbours.size());
 
-	for (int i = 0; i < p->neighbours.size(); i++) {
-		point_list.push_back(p->neighbours[i]->id);
+	{
+		PoolVector<int>::Write w = connections.write();
+		for (int i = 0; i < p->neighbours.size(); i++) {
+			w[i] = p->neighbours[i]->id;
+		}
 	}
 
-	return point_list;
+	return connections;
 }
 
 bool AStar::are_points_connected(int p_id, int p_with_id) const {
 
-	Segment s(p_id, p_with_id);
-	return segments.has(s);
+	Point *a = _get_point(p_id);
+	Point *b = _get_point(p_with_id);
+	if (!a || !b)
+		return false;
+
+	return a->neighbours.find(b) != -1 || a->unlinked_neighbours.find(b) != -1;
 }
 
 void AStar::clear() {
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
+	for (int i = 0; i < point_list.size(); i++) {
 
-		memdelete(E->get());
+		memdelete(point_list[i]);
 	}
-	segments.clear();
-	points.clear();
+	point_list.clear();
+	dense_points.reset();
+	sparse_points.clear();
+	search.nodes.reset();
+	search.open_heap.reset();
+
+	last_id_dirty = true;
+	point_grid_dirty = true;
+	segment_grid_dirty = true;
 }
 
-int AStar::get_closest_point(const Vector3 &p_point) const {
+void AStar::SpatialGrid::build(const LocalVector<AABB> &p_bounds) {
 
-	int closest_id = -1;
-	real_t closest_dist = 1e20;
+	cell_start.clear();
+	items.clear();
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
+	int count = p_bounds.size();
+	if (count == 0) {
+		dims[0] = dims[1] = dims[2] = 0;
+		return;
+	}
 
-		real_t d = p_point.distance_squared_to(E->get()->pos);
-		if (closest_id < 0 || d < closest_dist) {
-			closest_dist = d;
-			closest_id = E->key();
+	AABB bounds = p_bounds[0];
+	for (int i = 1; i < count; i++) {
+		bounds.merge_with(p_bounds[i]);
+	}
+
+	// aim for a couple of items per cell, flat axes (like in 2D graphs) get a single cell
+	int axes = 0;
+	real_t volume = 1;
+	for (int i = 0; i < 3; i++) {
+		if (bounds.size[i] > CMP_EPSILON) {
+			axes++;
+			volume *= bounds.size[i];
 		}
 	}
 
-	return closest_id;
+	real_t cell = axes ? Math::pow(volume / MAX(count / 2, 1), real_t(1.0) / axes) : 1;
+	int cell_count = 1;
+	for (int i = 0; i < 3; i++) {
+		dims[i] = bounds.size[i] > CMP_EPSILON ? int(MIN(bounds.size[i] / cell, real_t(4096))) + 1 : 1;
+		cell_count *= dims[i];
+	}
+
+	// very elongated bounds can round up to many more cells than items
+	while (cell_count > count * 4 + 64) {
+		int largest = dims[0] >= dims[1] ? (dims[0] >= dims[2] ? 0 : 2) : (dims[1] >= dims[2] ? 1 : 2);
+		cell_count /= dims[largest];
+		dims[largest] = MAX(dims[largest] / 2, 1);
+		cell_count *= dims[largest];
+	}
+
+	origin = bounds.position;
+	for (int i = 0; i < 3; i++) {
+		cell_size[i] = bounds.size[i] > CMP_EPSILON ? bounds.size[i] / dims[i] : 1;
+	}
+
+	// two passes, count the items per cell and then fill them in
+	cell_start.resize(cell_count + 1);
+	for (int i = 0; i <= cell_count; i++) {
+		cell_start[i] = 0;
+	}
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		for (int i = 0; i < count; i++) {
+
+			int from[3], to[3];
+			for (int j = 0; j < 3; j++) {
+				from[j] = CLAMP(int(Math::floor((p_bounds[i].position[j] - origin[j]) / cell_size[j])), 0, dims[j] - 1);
+				to[j] = CLAMP(int(Math::floor((p_bounds[i].position[j] + p_bounds[i].size[j] - origin[j]) / cell_size[j])), 0, dims[j] - 1);
+			}
+
+			for (int z = from[2]; z <= to[2]; z++) {
+				for (int y = from[1]; y <= to[1]; y++) {
+					for (int x = from[0]; x <= to[0]; x++) {
+						int c = (z * dims[1] + y) * dims[0] + x;
+						if (pass == 0) {
+							cell_start[c + 1]++;
+						} else {
+							items[cell_start[c]++] = i;
+						}
+					}
+				}
+			}
+		}
+
+		if (pass == 0) {
+			for (int i = 0; i < cell_count; i++) {
+				cell_start[i + 1] += cell_start[i];
+			}
+			items.resize(cell_start[cell_count]);
+		} else {
+			// filling advanced every start to the next cell's, shift them back
+			for (int i = cell_count; i > 0; i--) {
+				cell_start[i] = cell_start[i - 1];
+			}
+			cell_start[0] = 0;
+		}
+	}
 }
 
-Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
+template <class F>
+void AStar::SpatialGrid::query_nearest(const Vector3 &p_point, F &r_visitor) const {
+
+	if (items.empty())
+		return;
+
+	int c[3];
+	for (int i = 0; i < 3; i++) {
+		c[i] = CLAMP(int(Math::floor((p_point[i] - origin[i]) / cell_size[i])), 0, dims[i] - 1);
+	}
+
+	// visit the cells in growing shells around the closest cell, until nothing
+	// outside the visited ones can be closer than the best item found so far
+	for (int r = 0;; r++) {
+
+		int from[3], to[3];
+		for (int i = 0; i < 3; i++) {
+			from[i] = MAX(c[i] - r, 0);
+			to[i] = MIN(c[i] + r, dims[i] - 1);
+		}
+
+		for (int z = from[2]; z <= to[2]; z++) {
+			bool z_shell = ABS(z - c[2]) == r;
+			for (int y = from[1]; y <= to[1]; y++) {
+				bool yz_shell = z_shell || ABS(y - c[1]) == r;
+				for (int x = from[0]; x <= to[0]; x++) {
+
+					if (!yz_shell && ABS(x - c[0]) != r)
+						continue;
+
+					int cell = (z * dims[1] + y) * dims[0] + x;
+					for (int i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+						r_visitor(items[i]);
+					}
+				}
+			}
+		}
+
+		bool remaining = false;
+		real_t bound = 1e20;
+		for (int i = 0; i < 3; i++) {
+			if (c[i] - r > 0) {
+				remaining = true;
+				bound = MIN(bound, p_point[i] - (origin[i] + (c[i] - r) * cell_size[i]));
+			}
+			if (c[i] + r < dims[i] - 1) {
+				remaining = true;
+				bound = MIN(bound, origin[i] + (c[i] + r + 1) * cell_size[i] - p_point[i]);
+			}
+		}
+
+		if (!remaining)
+			break;
+		if (r_visitor.found && bound > 0 && bound * bound >= r_visitor.closest_dist)
+			break;
+	}
+}
+
+void AStar::_update_point_grid() const {
+
+	if (!point_grid_dirty)
+		return;
+
+	LocalVector<AABB> bounds;
+	bounds.resize(point_list.size());
+	for (int i = 0; i < point_list.size(); i++) {
+		bounds[i] = AABB(point_list[i]->pos, Vector3());
+	}
+	point_grid.build(bounds);
+	point_grid_dirty = false;
+}
+
+void AStar::_update_segment_grid() const {
+
+	if (!segment_grid_dirty)
+		return;
+
+	segment_list.clear();
+	LocalVector<AABB> bounds;
+
+	for (int i = 0; i < point_list.size(); i++) {
+
+		Point *p = point_list[i];
+		for (int j = 0; j < p->neighbours.size(); j++) {
+
+			Point *n = p->neighbours[j];
+			// two way connections are listed by both points, keep one
+			if (n->id < p->id && n->neighbours.find(p) != -1)
+				continue;
+
+			Segment s;
+			s.from_point = p;
+			s.to_point = n;
+			segment_list.push_back(s);
+
+			AABB aabb(p->pos, Vector3());
+			aabb.expand_to(n->pos);
+			bounds.push_back(aabb);
+		}
+	}
+
+	segment_grid.build(bounds);
+	segment_grid_dirty = false;
+}
+
+struct AStar::ClosestPointQuery {
+
+	Vector3 point;
+	const LocalVector<Point *> &points;
+	bool found;
+	real_t closest_dist;
+	int closest_id;
+
+	_FORCE_INLINE_ void operator()(int p_item) {
+
+		const Point *p = points[p_item];
+		real_t d = point.distance_squared_to(p->pos);
+		// on ties keep the lowest id, like a scan in id order would
+		if (!found || d < closest_dist || (d == closest_dist && p->id < closest_id)) {
+			closest_dist = d;
+			closest_id = p->id;
+			found = true;
+		}
+	}
 
-	real_t closest_dist = 1e20;
-	bool found = false;
+	ClosestPointQuery(const Vector3 &p_point, const LocalVector<Point *> &p_points) :
+			points(p_points) {
+		point = p_point;
+		found = false;
+		closest_dist = 1e20;
+		closest_id = -1;
+	}
+};
+
+struct AStar::ClosestSegmentQuery {
+
+	Vector3 point;
+	const LocalVector<Segment> &segments;
+	bool found;
+	real_t closest_dist;
 	Vector3 closest_point;
 
-	for (const Set<Segment>::Element *E = segments.front(); E; E = E->next()) {
+	_FORCE_INLINE_ void operator()(int p_item) {
 
 		Vector3 segment[2] = {
-			E->get().from_point->pos,
-			E->get().to_point->pos,
+			segments[p_item].from_point->pos,
+			segments[p_item].to_point->pos,
 		};
 
-		Vector3 p = Geometry::get_closest_point_to_segment(p_point, segment);
-		real_t d = p_point.distance_squared_to(p);
+		Vector3 p = Geometry::get_closest_point_to_segment(point, segment);
+		real_t d = point.distance_squared_to(p);
 		if (!found || d < closest_dist) {
-
 			closest_point = p;
 			closest_dist = d;
 			found = true;
 		}
 	}
 
-	return closest_point;
+	ClosestSegmentQuery(const Vector3 &p_point, const LocalVector<Segment> &p_segments) :
+			segments(p_segments) {
+		point = p_point;
+		found = false;
+		closest_dist = 1e20;
+	}
+};
+
+int AStar::get_closest_point(const Vector3 &p_point) const {
+
+	_update_point_grid();
+
+	ClosestPointQuery query(p_point, point_list);
+	point_grid.query_nearest(p_point, query);
+
+	return query.closest_id;
 }
 
-bool AStar::_solve(Point *begin_point, Point *end_point) {
+Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
+
+	_update_segment_grid();
+
+	ClosestSegmentQuery query(p_point, segment_list);
+	segment_grid.query_nearest(p_point, query);
+
+	return query.closest_point;
+}
+
+void AStar::SearchState::begin(int p_point_count) {
+
+	if (nodes.size() < p_point_count) {
+		int from = nodes.size();
+		nodes.resize(p_point_count);
+		for (int i = from; i < p_point_count; i++) {
+			nodes[i].pass = 0;
+		}
+	}
 
 	pass++;
+	if (pass == 0) {
+		// wrapped around, old passes could be taken for this one
+		for (int i = 0; i < nodes.size(); i++) {
+			nodes[i].pass = 0;
+		}
+		pass = 1;
+	}
 
-	SelfList<Point>::List open_list;
+	open_heap.clear();
+}
 
-	bool found_route = false;
+void AStar::SearchState::sift_up(int p_index) {
 
-	for (int i = 0; i < begin_point->neighbours.size(); i++) {
+	Point **heap = open_heap.ptr();
+	SearchNode *n = nodes.ptr();
 
-		Point *n = begin_point->neighbours[i];
-		n->prev_point = begin_point;
-		n->distance = _compute_cost(begin_point->id, n->id) * n->weight_scale;
-		n->last_pass = pass;
-		open_list.add(&n->list);
+	Point *p = heap[p_index];
+	real_t f = n[p->index].f_score;
 
-		if (end_point == n) {
-			found_route = true;
+	while (p_index > 0) {
+		int parent = (p_index - 1) / 2;
+		if (n[heap[parent]->index].f_score <= f)
 			break;
-		}
+		heap[p_index] = heap[parent];
+		n[heap[p_index]->index].heap_index = p_index;
+		p_index = parent;
 	}
 
-	while (!found_route) {
+	heap[p_index] = p;
+	n[p->index].heap_index = p_index;
+}
+
+void AStar::SearchState::sift_down(int p_index) {
+
+	Point **heap = open_heap.ptr();
+	SearchNode *n = nodes.ptr();
+	int count = open_heap.size();
+
+	Point *p = heap[p_index];
+	real_t f = n[p->index].f_score;
 
-		if (open_list.first() == NULL) {
-			// No path found
+	while (true) {
+		int child = p_index * 2 + 1;
+		if (child >= count)
 			break;
-		}
-		// Check open list
+		if (child + 1 < count && n[heap[child + 1]->index].f_score < n[heap[child]->index].f_score)
+			child++;
+		if (f <= n[heap[child]->index].f_score)
+			break;
+		heap[p_index] = heap[child];
+		n[heap[p_index]->index].heap_index = p_index;
+		p_index = child;
+	}
 
-		SelfList<Point> *least_cost_point = NULL;
-		real_t least_cost = 1e30;
+	heap[p_index] = p;
+	n[p->index].heap_index = p_index;
+}
 
-		// TODO: Cache previous results
-		for (SelfList<Point> *E = open_list.first(); E; E = E->next()) {
+void AStar::SearchState::push(Point *p_point) {
 
-			Point *p = E->self();
+	open_heap.push_back(p_point);
+	sift_up(open_heap.size() - 1);
+}
 
-			real_t cost = p->distance;
-			cost += _estimate_cost(p->id, end_point->id);
+AStar::Point *AStar::SearchState::pop() {
 
-			if (cost < least_cost) {
+	Point *p = open_heap[0];
+	Point *last = open_heap[open_heap.size() - 1];
+	open_heap.resize(open_heap.size() - 1);
 
-				least_cost_point = E;
-				least_cost = cost;
-			}
-		}
+	if (open_heap.size()) {
+		open_heap[0] = last;
+		sift_down(0);
+	}
 
-		Point *p = least_cost_point->self();
-		// Open the neighbours for search
-		int es = p->neighbours.size();
+	nodes[p->index].heap_index = -1;
+	return p;
+}
 
-		for (int i = 0; i < es; i++) {
+AStar::CostMode AStar::_get_cost_mode() const {
 
-			Point *e = p->neighbours[i];
+	CostMode mode;
+	ScriptInstance *si = get_script_instance();
+	mode.script_estimate = si && si->has_method(SceneStringNames::get_singleton()->_estimate_cost);
+	mode.script_compute = si && si->has_method(SceneStringNames::get_singleton()->_compute_cost);
+	return mode;
+}
 
-			real_t distance = _compute_cost(p->id, e->id) * e->weight_scale + p->distance;
+real_t AStar::_get_estimate(const CostMode &p_mode, Point *p_from, Point *p_to) {
 
-			if (e->last_pass == pass) {
-				// Already visited, is this cheaper?
+	if (p_mode.script_estimate)
+		return _estimate_cost(p_from->id, p_to->id);
 
-				if (e->distance > distance) {
+	return p_from->pos.distance_to(p_to->pos);
+}
 
-					e->prev_point = p;
-					e->distance = distance;
-				}
-			} else {
-				// Add to open neighbours
-
-				e->prev_point = p;
-				e->distance = distance;
-				e->last_pass = pass; // Mark as used
-				open_list.add(&e->list);
-
-				if (e == end_point) {
-					// End reached; stop algorithm
-					found_route = true;
-					break;
-				}
+real_t AStar::_get_cost(const CostMode &p_mode, Point *p_from, Point *p_to) {
+
+	if (p_mode.script_compute)
+		return _compute_cost(p_from->id, p_to->id);
+
+	return p_from->pos.distance_to(p_to->pos);
+}
+
+bool AStar::_solve(SearchState &r_state, const CostMode &p_mode, Point *begin_point, Point *end_point) {
+
+	r_state.begin(point_list.size());
+	uint32_t pass = r_state.pass;
+
+	SearchNode &begin = r_state.nodes[begin_point->index];
+	begin.pass = pass;
+	begin.g_score = 0;
+	begin.f_score = _get_estimate(p_mode, begin_point, end_point);
+	begin.prev_point = NULL;
+	r_state.push(begin_point);
+
+	while (r_state.open_heap.size()) {
+
+		// least estimated cost first, the open list is a binary heap
+		Point *p = r_state.pop();
+		if (p == end_point)
+			return true;
+
+		real_t g_score = r_state.nodes[p->index].g_score;
+
+		for (int i = 0; i < p->neighbours.size(); i++) {
+
+			Point *e = p->neighbours[i];
+			SearchNode *n = &r_state.nodes[e->index];
+
+			if (n->pass == pass && n->heap_index < 0)
+				continue; // Already closed
+
+			real_t tentative_g_score = g_score + _get_cost(p_mode, p, e) * e->weight_scale;
+
+			if (n->pass != pass) {
+				// Add to the open list
+				n->pass = pass;
+				n->g_score = tentative_g_score;
+				n->f_score = tentative_g_score + _get_estimate(p_mode, e, end_point);
+				n->prev_point = p;
+				r_state.push(e);
+			} else if (tentative_g_score < n->g_score) {
+				// Cheaper through this point, move it up in the open list
+				n->f_score -= n->g_score - tentative_g_score;
+				n->g_score = tentative_g_score;
+				n->prev_point = p;
+				r_state.sift_up(n->heap_index);
 			}
 		}
+	}
 
-		if (found_route)
-			break;
+	// No path found
+	return false;
+}
 
-		open_list.remove(least_cost_point);
-	}
+void AStar::_get_path(const SearchState &p_state, Point *begin_point, Point *end_point, LocalVector<Point *> &r_path) const {
 
-	// Clear the openf list
-	while (open_list.first()) {
-		open_list.remove(open_list.first());
-	}
+	r_path.clear();
 
-	return found_route;
+	Point *p = end_point;
+	while (p != begin_point) {
+		r_path.push_back(p);
+		p = p_state.nodes[p->index].prev_point;
+	}
+	r_path.push_back(begin_point);
+	r_path.invert();
 }
 
 float AStar::_estimate_cost(int p_from_id, int p_to_id) {
@@ -335,7 +737,11 @@ float AStar::_estimate_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_estimate_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_estimate_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from = _get_point(p_from_id);
+	Point *to = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!from || !to, 0);
+
+	return from->pos.distance_to(to->pos);
 }
 
 float AStar::_compute_cost(int p_from_id, int p_to_id) {
@@ -343,18 +749,19 @@ float AStar::_compute_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_compute_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_compute_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from = _get_point(p_from_id);
+	Point *to = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!from || !to, 0);
+
+	return from->pos.distance_to(to->pos);
 }
 
 PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<Vector3>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<Vector3>());
-
-	pass++;
-
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *a = _get_point(p_from_id);
+	Point *b = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!a, PoolVector<Vector3>());
+	ERR_FAIL_COND_V(!b, PoolVector<Vector3>());
 
 	if (a == b) {
 		PoolVector<Vector3> ret;
@@ -362,36 +769,22 @@ PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	Point *begin_point = a;
-	Point *end_point = b;
-
-	bool found_route = _solve(begin_point, end_point);
+	bool found_route = _solve(search, _get_cost_mode(), a, b);
 
 	if (!found_route)
 		return PoolVector<Vector3>();
 
-	// Midpoints
-	Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
+	LocalVector<Point *> points;
+	_get_path(search, a, b, points);
 
 	PoolVector<Vector3> path;
-	path.resize(pc);
+	path.resize(points.size());
 
 	{
 		PoolVector<Vector3>::Write w = path.write();
-
-		Point *p = end_point;
-		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->pos;
-			p = p->prev_point;
+		for (int i = 0; i < points.size(); i++) {
+			w[i] = points[i]->pos;
 		}
-
-		w[0] = p->pos; // Assign first
 	}
 
 	return path;
@@ -399,13 +792,10 @@ PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 
 PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<int>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<int>());
-
-	pass++;
-
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *a = _get_point(p_from_id);
+	Point *b = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!a, PoolVector<int>());
+	ERR_FAIL_COND_V(!b, PoolVector<int>());
 
 	if (a == b) {
 		PoolVector<int> ret;
@@ -413,39 +803,104 @@ PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	Point *begin_point = a;
-	Point *end_point = b;
-
-	bool found_route = _solve(begin_point, end_point);
+	bool found_route = _solve(search, _get_cost_mode(), a, b);
 
 	if (!found_route)
 		return PoolVector<int>();
 
-	// Midpoints
-	Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
+	LocalVector<Point *> points;
+	_get_path(search, a, b, points);
 
 	PoolVector<int> path;
-	path.resize(pc);
+	path.resize(points.size());
 
 	{
 		PoolVector<int>::Write w = path.write();
+		for (int i = 0; i < points.size(); i++) {
+			w[i] = points[i]->id;
+		}
+	}
 
-		p = end_point;
-		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
+	return path;
+}
+
+void AStar::_solve_batch(uint32_t p_state, BatchQuery *p_query) {
+
+	SearchState &state = p_query->states[p_state];
+	LocalVector<Point *> points;
+
+	// each state takes queries until none are left, so slow queries don't hold a whole chunk back
+	while (true) {
+
+		uint32_t q = atomic_increment(&p_query->next) - 1;
+		if (q >= uint32_t(p_query->paths.size()))
+			break;
+
+		Point *a = p_query->from_points[q];
+		Point *b = p_query->to_points[q];
+		if (!a || !b)
+			continue;
+
+		if (a == b) {
+			points.clear();
+			points.push_back(a);
+		} else if (_solve(state, p_query->mode, a, b)) {
+			_get_path(state, a, b, points);
+		} else {
+			continue;
 		}
 
-		w[0] = p->id; // Assign first
+		PoolVector<int> &path = p_query->paths[q];
+		path.resize(points.size());
+		PoolVector<int>::Write w = path.write();
+		for (int i = 0; i < points.size(); i++) {
+			w[i] = points[i]->id;
+		}
 	}
+}
 
-	return path;
+Array AStar::get_id_paths(const PoolVector<int> &p_from_ids, const PoolVector<int> &p_to_ids) {
+
+	ERR_FAIL_COND_V(p_from_ids.size() != p_to_ids.size(), Array());
+
+	int count = p_from_ids.size();
+
+	BatchQuery query;
+	query.from_points.resize(count);
+	query.to_points.resize(count);
+	query.paths.resize(count);
+	query.mode = _get_cost_mode();
+	query.next = 0;
+
+	{
+		PoolVector<int>::Read from = p_from_ids.read();
+		PoolVector<int>::Read to = p_to_ids.read();
+		for (int i = 0; i < count; i++) {
+			query.from_points[i] = _get_point(from[i]);
+			query.to_points[i] = _get_point(to[i]);
+		}
+	}
+
+	// script costs can't be called from other threads
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	bool threaded = count > 1 && !query.mode.script_estimate && !query.mode.script_compute && pool && pool->get_thread_count() > 0;
+
+	if (threaded) {
+		int state_count = MIN(int(pool->get_thread_count()) + 1, count);
+		query.states.resize(state_count);
+		pool->do_work(state_count, this, &AStar::_solve_batch, &query);
+	} else {
+		query.states.resize(1);
+		_solve_batch(0, &query);
+	}
+
+	Array paths;
+	paths.resize(count);
+	for (int i = 0; i < count; i++) {
+		paths[i] = query.paths[i];
+	}
+
+	return paths;
 }
 
 void AStar::_bind_methods() {
@@ -473,6 +928,7 @@ void AStar::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_point_path", "from_id", "to_id"), &AStar::get_point_path);
 	ClassDB::bind_method(D_METHOD("get_id_path", "from_id", "to_id"), &AStar::get_id_path);
+	ClassDB::bind_method(D_METHOD("get_id_paths", "from_ids", "to_ids"), &AStar::get_id_paths);
 
 	BIND_VMETHOD(MethodInfo(Variant::REAL, "_estimate_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
 	BIND_VMETHOD(MethodInfo(Variant::REAL, "_compute_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
@@ -480,11 +936,13 @@ void AStar::_bind_methods() {
 
 AStar::AStar() {
 
-	pass = 1;
+	last_id = 0;
+	last_id_dirty = false;
+	point_grid_dirty = true;
+	segment_grid_dirty = true;
 }
 
 AStar::~AStar() {
 
-	pass = 1;
 	clear();
 }
@@ -31,8 +31,10 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 
+#include "hash_map.h"
+#include "local_vector.h"
 #include "reference.h"
-#include "self_list.h"
+
 /**
 	A* pathfinding algorithm
 
@@ -43,56 +45,127 @@ class AStar : public Reference {
 
 	GDCLASS(AStar, Reference)
 
-	uint64_t pass;
-
 	struct Point {
 
-		SelfList<Point> list;
-
 		int id;
+		int index; // position in point_list, also indexes the search state
 		Vector3 pos;
 		real_t weight_scale;
-		uint64_t last_pass;
 
-		Vector<Point *> neighbours;
+		LocalVector<Point *> neighbours; // points that can be reached from this one
+		LocalVector<Point *> unlinked_neighbours; // points connected one way to this one, which can't be reached from it
+	};
+
+	enum {
+		DENSE_POINTS_MIN = 1024,
+	};
+
+	// Ids below a few times the point count index dense_points directly, so the usual
+	// "x + y * width" numbering never hashes. Larger ids go to sparse_points.
+	LocalVector<Point *> point_list;
+	LocalVector<Point *> dense_points;
+	HashMap<int, Point *> sparse_points;
 
-		// Used for pathfinding
+	mutable int last_id;
+	mutable bool last_id_dirty;
+
+	_FORCE_INLINE_ Point *_get_point(int p_id) const {
+
+		if (p_id >= 0 && p_id < dense_points.size()) {
+			Point *p = dense_points[p_id];
+			if (p)
+				return p;
+		}
+		if (sparse_points.empty())
+			return NULL;
+		Point *const *p = sparse_points.getptr(p_id);
+		return p ? *p : NULL;
+	}
+
+	void _link(Point *p_from, Point *p_to);
+	void _unlink(Point *p_from, Point *p_to);
+
+	// Search data lives apart from the points, indexed by Point::index, so several
+	// searches can run at the same time on the same graph.
+	struct SearchNode {
+		real_t g_score;
+		real_t f_score;
 		Point *prev_point;
-		real_t distance;
+		uint32_t pass;
+		int heap_index; // -1 once the point is closed
+	};
+
+	struct SearchState {
+
+		LocalVector<SearchNode> nodes;
+		LocalVector<Point *> open_heap;
+		uint32_t pass;
+
+		void begin(int p_point_count);
+		void push(Point *p_point);
+		Point *pop();
+		void sift_up(int p_index);
+		void sift_down(int p_index);
 
-		Point() :
-				list(this) {}
+		SearchState() { pass = 0; }
 	};
 
-	Map<int, Point *> points;
+	SearchState search;
 
-	struct Segment {
-		union {
-			struct {
-				int32_t from;
-				int32_t to;
-			};
-			uint64_t key;
-		};
+	struct CostMode {
+		bool script_estimate;
+		bool script_compute;
+	};
 
-		Point *from_point;
-		Point *to_point;
+	CostMode _get_cost_mode() const;
+	_FORCE_INLINE_ real_t _get_estimate(const CostMode &p_mode, Point *p_from, Point *p_to);
+	_FORCE_INLINE_ real_t _get_cost(const CostMode &p_mode, Point *p_from, Point *p_to);
 
-		bool operator<(const Segment &p_s) const { return key < p_s.key; }
-		Segment() { key = 0; }
-		Segment(int p_from, int p_to) {
-			if (p_from > p_to) {
-				SWAP(p_from, p_to);
-			}
+	bool _solve(SearchState &r_state, const CostMode &p_mode, Point *begin_point, Point *end_point);
+	void _get_path(const SearchState &p_state, Point *begin_point, Point *end_point, LocalVector<Point *> &r_path) const;
 
-			from = p_from;
-			to = p_to;
-		}
+	// Uniform grid over the points and segments for the closest point queries,
+	// rebuilt on the next query after the graph changes.
+	struct SpatialGrid {
+
+		Vector3 origin;
+		Vector3 cell_size;
+		int dims[3];
+		LocalVector<int> cell_start;
+		LocalVector<int> items;
+
+		void build(const LocalVector<AABB> &p_bounds);
+		template <class F>
+		void query_nearest(const Vector3 &p_point, F &r_visitor) const;
 	};
 
-	Set<Segment> segments;
+	struct Segment {
+		Point *from_point;
+		Point *to_point;
+	};
+
+	mutable SpatialGrid point_grid;
+	mutable SpatialGrid segment_grid;
+	mutable LocalVector<Segment> segment_list;
+	mutable bool point_grid_dirty;
+	mutable bool segment_grid_dirty;
+
+	void _update_point_grid() const;
+	void _update_segment_grid() const;
+
+	struct ClosestPointQuery;
+	struct ClosestSegmentQuery;
+
+	struct BatchQuery {
+		LocalVector<Point *> from_points;
+		LocalVector<Point *> to_points;
+		LocalVector<PoolVector<int> > paths;
+		LocalVector<SearchState> states;
+		CostMode mode;
+		uint32_t next;
+	};
 
-	bool _solve(Point *begin_point, Point *end_point);
+	void _solve_batch(uint32_t p_state, BatchQuery *p_query);
 
 protected:
 	static void _bind_methods();
@@ -124,6 +197,7 @@ public:
 
 	PoolVector<Vector3> get_point_path(int p_from_id, int p_to_id);
 	PoolVector<int> get_id_path(int p_from_id, int p_to_id);
+	Array get_id_paths(const PoolVector<int> &p_from_ids, const PoolVector<int> &p_to_ids);
 
 	AStar();
 	~AStar();
@@ -0,0 +1,509 @@
+/*************************************************************************/
+/*  triangle_bvh.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "triangle_bvh.h"
+
+#include "os/thread_work_pool.h"
+
+#define BVH_BINS 16
+// meshes with more primitives than this build their lower subtrees as separate tasks
+#define BVH_PARALLEL_MIN_PRIMITIVES 32768
+
+#define BVH_SERIALIZE_MAGIC 0x34485642 // "BVH4"
+#define BVH_SERIALIZE_VERSION 1
+#define BVH_SERIALIZE_HEADER_SIZE (6 * sizeof(uint32_t))
+
+static _FORCE_INLINE_ real_t _get_half_surface(const AABB &p_aabb) {
+
+	return p_aabb.size.x * p_aabb.size.y + p_aabb.size.y * p_aabb.size.z + p_aabb.size.z * p_aabb.size.x;
+}
+
+void TriangleBVH::_alloc_nodes(int p_count) {
+
+	// nodes are two cache lines, keep them from straddling a third one
+	node_memory = memalloc(sizeof(Node) * p_count + 63);
+	nodes = (Node *)(((uintptr_t)node_memory + 63) & ~(uintptr_t)63);
+	node_count = p_count;
+}
+
+AABB TriangleBVH::_get_range_aabb(const BuildContext &p_context, int p_from, int p_count) {
+
+	AABB aabb = p_context.aabbs[p_context.primitives[p_from]];
+	for (int i = p_from + 1; i < p_from + p_count; i++) {
+		aabb.merge_with(p_context.aabbs[p_context.primitives[i]]);
+	}
+	return aabb;
+}
+
+void TriangleBVH::_split(BuildContext &p_context, const BuildRange &p_range, BuildRange &r_left, BuildRange &r_right) {
+
+	uint32_t *prims = &p_context.primitives[p_range.from];
+	const Vector3 *centers = p_context.centers.ptr();
+
+	AABB center_bounds(centers[prims[0]], Vector3());
+	for (int i = 1; i < p_range.count; i++) {
+		center_bounds.expand_to(centers[prims[i]]);
+	}
+
+	int best_axis = -1;
+	int best_split = 0;
+	real_t best_cost = 0;
+
+	for (int axis = 0; axis < 3; axis++) {
+
+		real_t extent = center_bounds.size[axis];
+		if (extent <= CMP_EPSILON)
+			continue;
+
+		real_t origin = center_bounds.position[axis];
+		real_t scale = BVH_BINS / extent;
+
+		int bin_counts[BVH_BINS] = {};
+		AABB bin_aabbs[BVH_BINS];
+
+		for (int i = 0; i < p_range.count; i++) {
+
+			int bin = MIN(int((centers[prims[i]][axis] - origin) * scale), BVH_BINS - 1);
+			if (bin_counts[bin]) {
+				bin_aabbs[bin].merge_with(p_context.aabbs[prims[i]]);
+			} else {
+				bin_aabbs[bin] = p_context.aabbs[prims[i]];
+			}
+			bin_counts[bin]++;
+		}
+
+		// surface area of everything on the right of each split, swept from the end
+		real_t right_costs[BVH_BINS];
+		AABB right_aabb;
+		int right_count = 0;
+		for (int i = BVH_BINS - 1; i > 0; i--) {
+
+			if (bin_counts[i]) {
+				right_aabb = right_count ? right_aabb.merge(bin_aabbs[i]) : bin_aabbs[i];
+				right_count += bin_counts[i];
+			}
+			right_costs[i] = right_count ? _get_half_surface(right_aabb) * right_count : 0;
+		}
+
+		AABB left_aabb;
+		int left_count = 0;
+		for (int i = 1; i < BVH_BINS; i++) {
+
+			if (bin_counts[i - 1]) {
+				left_aabb = left_count ? left_aabb.merge(bin_aabbs[i - 1]) : bin_aabbs[i - 1];
+				left_count += bin_counts[i - 1];
+			}
+
+			if (left_count == 0 || left_count == p_range.count)
+				continue;
+
+			real_t cost = _get_half_surface(left_aabb) * left_count + right_costs[i];
+			if (best_axis == -1 || cost < best_cost) {
+				best_axis = axis;
+				best_split = i;
+				best_cost = cost;
+			}
+		}
+	}
+
+	int left_count = p_range.count / 2;
+
+	if (best_axis != -1) {
+
+		real_t origin = center_bounds.position[best_axis];
+		real_t scale = BVH_BINS / center_bounds.size[best_axis];
+
+		int i = 0;
+		int j = p_range.count - 1;
+		while (i <= j) {
+			int bin = MIN(int((centers[prims[i]][best_axis] - origin) * scale), BVH_BINS - 1);
+			if (bin < best_split) {
+				i++;
+			} else {
+				SWAP(prims[i], prims[j]);
+				j--;
+			}
+		}
+
+		if (i > 0 && i < p_range.count) {
+			left_count = i;
+		}
+	}
+	// otherwise all the centers are in the same spot, and any split is as good as the others
+
+	r_left.from = p_range.from;
+	r_left.count = left_count;
+	r_left.aabb = _get_range_aabb(p_context, r_left.from, r_left.count);
+	r_right.from = p_range.from + left_count;
+	r_right.count = p_range.count - left_count;
+	r_right.aabb = _get_range_aabb(p_context, r_right.from, r_right.count);
+}
+
+int TriangleBVH::_build_node(BuildContext &p_context, LocalVector<Node> &r_nodes, const BuildRange &p_range, int p_depth, int &r_max_depth, bool p_make_tasks) {
+
+	int index = r_nodes.size();
+	r_nodes.push_back(Node());
+
+	if (p_depth > r_max_depth) {
+		r_max_depth = p_depth;
+	}
+
+	// open up the largest child until there are four of them
+	BuildRange ranges[4];
+	int range_count = 1;
+	ranges[0] = p_range;
+
+	while (range_count < 4) {
+
+		int best = -1;
+		real_t best_surface = 0;
+		for (int i = 0; i < range_count; i++) {
+
+			if (ranges[i].count <= LEAF_SIZE)
+				continue;
+
+			real_t surface = _get_half_surface(ranges[i].aabb);
+			if (best == -1 || surface > best_surface) {
+				best = i;
+				best_surface = surface;
+			}
+		}
+
+		if (best == -1)
+			break;
+
+		BuildRange left, right;
+		_split(p_context, ranges[best], left, right);
+		ranges[best] = left;
+		ranges[range_count++] = right;
+	}
+
+	for (int i = 0; i < 4; i++) {
+
+		// children are built right away, so the node has to be looked up again every time
+		Node &node = r_nodes[index];
+
+		if (i >= range_count) {
+			node.min_x[i] = node.min_y[i] = node.min_z[i] = 1e30;
+			node.max_x[i] = node.max_y[i] = node.max_z[i] = -1e30;
+			node.children[i] = -1;
+			node.counts[i] = -1;
+			continue;
+		}
+
+		const BuildRange &range = ranges[i];
+		Vector3 end = range.aabb.position + range.aabb.size;
+		node.min_x[i] = range.aabb.position.x;
+		node.min_y[i] = range.aabb.position.y;
+		node.min_z[i] = range.aabb.position.z;
+		node.max_x[i] = end.x;
+		node.max_y[i] = end.y;
+		node.max_z[i] = end.z;
+
+		if (range.count <= LEAF_SIZE) {
+			node.children[i] = range.from;
+			node.counts[i] = range.count;
+		} else if (p_make_tasks && range.count <= p_context.task_size) {
+			BuildTask task;
+			task.range = range;
+			task.parent = index;
+			task.slot = i;
+			task.depth = p_depth + 1;
+			task.max_depth = 0;
+			p_context.tasks.push_back(task);
+			node.children[i] = -1; // patched when the task is merged
+			node.counts[i] = 0;
+		} else {
+			node.counts[i] = 0;
+			int child = _build_node(p_context, r_nodes, range, p_depth + 1, r_max_depth, p_make_tasks);
+			r_nodes[index].children[i] = child;
+		}
+	}
+
+	return index;
+}
+
+void TriangleBVH::_build_task(uint32_t p_index, BuildContext *p_context) {
+
+	BuildTask &task = p_context->tasks[p_index];
+	_build_node(*p_context, task.nodes, task.range, task.depth, task.max_depth, false);
+}
+
+void TriangleBVH::build(const AABB *p_aabbs, int p_count) {
+
+	clear();
+
+	if (p_count <= 0)
+		return;
+
+	primitives.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		primitives[i] = i;
+	}
+
+	BuildContext context;
+	context.aabbs = p_aabbs;
+	context.primitives = primitives.ptr();
+	context.centers.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		context.centers[i] = p_aabbs[i].position + p_aabbs[i].size * 0.5;
+	}
+
+	// the task split only depends on the primitive count, so the tree is the same whether the tasks run in parallel or not
+	bool make_tasks = p_count >= BVH_PARALLEL_MIN_PRIMITIVES;
+	context.task_size = MAX(p_count / 64, 2048);
+
+	BuildRange root;
+	root.from = 0;
+	root.count = p_count;
+	root.aabb = _get_range_aabb(context, 0, p_count);
+
+	LocalVector<Node> build_nodes;
+	build_nodes.reserve(p_count / 2 + 1);
+	max_depth = 0;
+	_build_node(context, build_nodes, root, 1, max_depth, make_tasks);
+
+	if (context.tasks.size()) {
+
+		ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+		if (pool) {
+			pool->do_work(context.tasks.size(), this, &TriangleBVH::_build_task, &context);
+		} else {
+			for (int i = 0; i < context.tasks.size(); i++) {
+				_build_task(i, &context);
+			}
+		}
+
+		// subtrees go after the top of the tree, in task order
+		for (int i = 0; i < context.tasks.size(); i++) {
+
+			BuildTask &task = context.tasks[i];
+			int offset = build_nodes.size();
+
+			for (int j = 0; j < task.nodes.size(); j++) {
+
+				Node node = task.nodes[j];
+				for (int k = 0; k < 4; k++) {
+					if (node.counts[k] == 0) {
+						node.children[k] += offset;
+					}
+				}
+				build_nodes.push_back(node);
+			}
+
+			build_nodes[task.parent].children[task.slot] = offset;
+			max_depth = MAX(max_depth, task.max_depth);
+		}
+	}
+
+	_alloc_nodes(build_nodes.size());
+	memcpy(nodes, build_nodes.ptr(), sizeof(Node) * node_count);
+}
+
+void TriangleBVH::clear() {
+
+	if (node_memory) {
+		memfree(node_memory);
+	}
+	node_memory = NULL;
+	nodes = NULL;
+	node_count = 0;
+	max_depth = 0;
+	primitives.reset();
+}
+
+PoolVector<uint8_t> TriangleBVH::serialize() const {
+
+	PoolVector<uint8_t> data;
+	data.resize(BVH_SERIALIZE_HEADER_SIZE + sizeof(uint32_t) * primitives.size() + sizeof(Node) * node_count);
+
+	PoolVector<uint8_t>::Write w = data.write();
+	uint32_t header[6] = { BVH_SERIALIZE_MAGIC, BVH_SERIALIZE_VERSION, sizeof(real_t), uint32_t(primitives.size()), uint32_t(node_count), uint32_t(max_depth) };
+	memcpy(w.ptr(), header, BVH_SERIALIZE_HEADER_SIZE);
+	memcpy(w.ptr() + BVH_SERIALIZE_HEADER_SIZE, primitives.ptr(), sizeof(uint32_t) * primitives.size());
+	memcpy(w.ptr() + BVH_SERIALIZE_HEADER_SIZE + sizeof(uint32_t) * primitives.size(), nodes, sizeof(Node) * node_count);
+
+	return data;
+}
+
+// bounds are stored as merged position/size pairs, so allow for the rounding of position + size
+static _FORCE_INLINE_ bool _bound_below(real_t p_bound, real_t p_value) {
+
+	return p_bound <= p_value + CMP_EPSILON * (1.0 + Math::abs(p_value));
+}
+
+static _FORCE_INLINE_ bool _slot_contains(const TriangleBVH::Node &p_node, int p_slot, const Vector3 &p_min, const Vector3 &p_max) {
+
+	return _bound_below(p_node.min_x[p_slot], p_min.x) && _bound_below(p_node.min_y[p_slot], p_min.y) && _bound_below(p_node.min_z[p_slot], p_min.z) &&
+		   _bound_below(-p_node.max_x[p_slot], -p_max.x) && _bound_below(-p_node.max_y[p_slot], -p_max.y) && _bound_below(-p_node.max_z[p_slot], -p_max.z);
+}
+
+bool TriangleBVH::deserialize(const PoolVector<uint8_t> &p_data, const AABB *p_aabbs, int p_primitive_count) {
+
+	clear();
+
+	ERR_FAIL_COND_V(p_data.size() < int(BVH_SERIALIZE_HEADER_SIZE), false);
+
+	PoolVector<uint8_t>::Read r = p_data.read();
+
+	uint32_t header[6];
+	memcpy(header, r.ptr(), BVH_SERIALIZE_HEADER_SIZE);
+
+	// data from another platform or an older version is simply rebuilt
+	if (header[0] != BVH_SERIALIZE_MAGIC || header[1] != BVH_SERIALIZE_VERSION || header[2] != sizeof(real_t))
+		return false;
+
+	int primitive_count = header[3];
+	int count = header[4];
+	ERR_FAIL_COND_V(primitive_count != p_primitive_count, false);
+	ERR_FAIL_COND_V(count < 0 || (count == 0) != (primitive_count == 0), false);
+	ERR_FAIL_COND_V(uint64_t(p_data.size()) != BVH_SERIALIZE_HEADER_SIZE + sizeof(uint32_t) * uint64_t(primitive_count) + sizeof(Node) * uint64_t(count), false);
+
+	primitives.resize(primitive_count);
+	memcpy(primitives.ptr(), r.ptr() + BVH_SERIALIZE_HEADER_SIZE, sizeof(uint32_t) * primitive_count);
+	_alloc_nodes(count);
+	memcpy(nodes, r.ptr() + BVH_SERIALIZE_HEADER_SIZE + sizeof(uint32_t) * primitive_count, sizeof(Node) * count);
+
+	bool valid = true;
+
+	// the primitive list must be a permutation, and every entry must be in exactly one leaf
+	LocalVector<uint8_t> seen;
+	seen.resize(primitive_count);
+	for (int i = 0; i < primitive_count; i++) {
+		seen[i] = 0;
+	}
+	for (int i = 0; i < primitive_count && valid; i++) {
+		valid = primitives[i] < uint32_t(primitive_count) && !seen[primitives[i]];
+		if (valid) {
+			seen[primitives[i]] = 1;
+		}
+	}
+
+	LocalVector<uint8_t> in_leaf;
+	in_leaf.resize(primitive_count);
+	for (int i = 0; i < primitive_count; i++) {
+		in_leaf[i] = 0;
+	}
+
+	// children always come after their parent, which also rules out cycles, and the depth
+	// (which sizes the traversal stacks) is computed instead of trusted
+	LocalVector<int> depths;
+	depths.resize(count);
+	for (int i = 0; i < count; i++) {
+		depths[i] = 0;
+	}
+	if (count) {
+		depths[0] = 1;
+	}
+
+	for (int i = 0; i < count && valid; i++) {
+
+		const Node &node = nodes[i];
+		valid = depths[i] > 0; // unreachable nodes would mean a broken tree
+
+		for (int j = 0; j < 4 && valid; j++) {
+
+			if (node.counts[j] == 0) {
+				valid = node.children[j] > i && node.children[j] < count;
+				if (!valid)
+					break;
+
+				depths[node.children[j]] = MAX(depths[node.children[j]], depths[i] + 1);
+
+				// a slot bounds everything in the child node, stale trees from other faces fail here or at the leaves
+				const Node &child = nodes[node.children[j]];
+				for (int k = 0; k < 4 && valid; k++) {
+					if (child.counts[k] != -1) {
+						valid = _slot_contains(node, j, Vector3(child.min_x[k], child.min_y[k], child.min_z[k]), Vector3(child.max_x[k], child.max_y[k], child.max_z[k]));
+					}
+				}
+			} else if (node.counts[j] > 0) {
+				valid = node.counts[j] <= LEAF_SIZE && node.children[j] >= 0 && node.children[j] + node.counts[j] <= primitive_count;
+				for (int k = node.children[j]; k < node.children[j] + node.counts[j] && valid; k++) {
+					const AABB &aabb = p_aabbs[primitives[k]];
+					valid = !in_leaf[k] && _slot_contains(node, j, aabb.position, aabb.position + aabb.size);
+					in_leaf[k] = 1;
+				}
+			} else {
+				valid = node.counts[j] == -1;
+			}
+		}
+
+		max_depth = MAX(max_depth, depths[i]);
+	}
+
+	for (int i = 0; i < primitive_count && valid; i++) {
+		valid = in_leaf[i];
+	}
+
+	if (!valid) {
+		clear();
+		ERR_EXPLAIN("Invalid BVH data, it will be rebuilt.");
+		ERR_FAIL_V(false);
+	}
+
+	return true;
+}
+
+void TriangleBVH::operator=(const TriangleBVH &p_from) {
+
+	if (&p_from == this)
+		return;
+
+	clear();
+	primitives = p_from.primitives;
+	max_depth = p_from.max_depth;
+	if (p_from.node_count) {
+		_alloc_nodes(p_from.node_count);
+		memcpy(nodes, p_from.nodes, sizeof(Node) * node_count);
+	}
+}
+
+TriangleBVH::TriangleBVH(const TriangleBVH &p_from) {
+
+	nodes = NULL;
+	node_memory = NULL;
+	node_count = 0;
+	max_depth = 0;
+	*this = p_from;
+}
+
+TriangleBVH::TriangleBVH() {
+
+	nodes = NULL;
+	node_memory = NULL;
+	node_count = 0;
+	max_depth = 0;
+}
+
+TriangleBVH::~TriangleBVH() {
+
+	clear();
+}
@@ -0,0 +1,250 @@
+/*************************************************************************/
+/*  triangle_bvh.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include "aabb.h"
+#include "local_vector.h"
+#include "dvector.h"
+
+/**
+ * @class TriangleBVH
+ *
+ * Bounding volume hierarchy over a list of primitive AABBs (usually the faces of a
+ * static mesh), shared by TriangleMesh and the concave polygon shape of the physics
+ * server.
+ *
+ * Nodes have four children whose bounds are stored axis by axis, so a node is tested
+ * against a box or a ray with fixed length loops the compiler can vectorize, and are
+ * 128 bytes aligned to the cache line. Splits are chosen with a binned surface area
+ * heuristic, and large meshes build their subtrees in parallel.
+ *
+ * Leaves reference up to LEAF_SIZE primitives, the queries report primitives whose
+ * leaf overlaps the query so callbacks still have to test the primitive itself.
+ */
+
+class TriangleBVH {
+
+public:
+	enum {
+		LEAF_SIZE = 4,
+	};
+
+	struct Node {
+
+		real_t min_x[4];
+		real_t min_y[4];
+		real_t min_z[4];
+		real_t max_x[4];
+		real_t max_y[4];
+		real_t max_z[4];
+		int32_t children[4]; // node index, or first entry in the primitive list for leaves
+		int32_t counts[4]; // primitives in a leaf, 0 for nodes, -1 for empty slots
+	};
+
+private:
+	struct BuildRange {
+
+		AABB aabb;
+		int from;
+		int count;
+	};
+
+	struct BuildTask {
+
+		BuildRange range;
+		int parent;
+		int slot;
+		int depth;
+		LocalVector<Node> nodes;
+		int max_depth;
+	};
+
+	struct BuildContext {
+
+		const AABB *aabbs;
+		LocalVector<Vector3> centers;
+		uint32_t *primitives;
+		int task_size;
+		LocalVector<BuildTask> tasks;
+	};
+
+	Node *nodes;
+	void *node_memory;
+	int node_count;
+	LocalVector<uint32_t> primitives;
+	int max_depth;
+
+	void _alloc_nodes(int p_count);
+	static AABB _get_range_aabb(const BuildContext &p_context, int p_from, int p_count);
+	static void _split(BuildContext &p_context, const BuildRange &p_range, BuildRange &r_left, BuildRange &r_right);
+	static int _build_node(BuildContext &p_context, LocalVector<Node> &r_nodes, const BuildRange &p_range, int p_depth, int &r_max_depth, bool p_make_tasks);
+	void _build_task(uint32_t p_index, BuildContext *p_context);
+
+public:
+	bool is_empty() const { return node_count == 0; }
+	int get_node_count() const { return node_count; }
+	int get_primitive_count() const { return primitives.size(); }
+
+	void build(const AABB *p_aabbs, int p_count);
+	void clear();
+
+	// the layout is the same on every platform with the same real_t and endianness
+	PoolVector<uint8_t> serialize() const;
+	bool deserialize(const PoolVector<uint8_t> &p_data, const AABB *p_aabbs, int p_primitive_count);
+
+	// p_callback(primitive) returns false to stop
+	template <class C>
+	void cull_aabb(const AABB &p_aabb, C &p_callback) const {
+
+		if (!node_count)
+			return;
+
+		const Vector3 bmin = p_aabb.position;
+		const Vector3 bmax = p_aabb.position + p_aabb.size;
+		const uint32_t *prims = primitives.ptr();
+
+		int32_t *stack = (int32_t *)alloca(sizeof(int32_t) * (max_depth * 3 + 1));
+		int stack_size = 1;
+		stack[0] = 0;
+
+		while (stack_size) {
+
+			const Node &node = nodes[stack[--stack_size]];
+
+			bool overlap[4];
+			for (int i = 0; i < 4; i++) {
+				overlap[i] = (node.min_x[i] <= bmax.x) & (node.max_x[i] >= bmin.x) & (node.min_y[i] <= bmax.y) & (node.max_y[i] >= bmin.y) & (node.min_z[i] <= bmax.z) & (node.max_z[i] >= bmin.z);
+			}
+
+			for (int i = 0; i < 4; i++) {
+
+				if (!overlap[i])
+					continue;
+
+				if (node.counts[i] == 0) {
+					stack[stack_size++] = node.children[i];
+					continue;
+				}
+
+				for (int j = node.children[i]; j < node.children[i] + node.counts[i]; j++) {
+					if (!p_callback(prims[j]))
+						return;
+				}
+			}
+		}
+	}
+
+	// p_callback(primitive, r_max_t) returns false to stop, and can lower r_max_t to skip everything farther than a hit;
+	// t is measured in multiples of p_dir, so a segment is p_dir = to - from and p_max_t = 1
+	template <class C>
+	void cull_ray(const Vector3 &p_from, const Vector3 &p_dir, real_t p_max_t, C &p_callback) const {
+
+		if (!node_count)
+			return;
+
+		// a huge inverse instead of an infinite one, so a ray starting on a slab doesn't produce 0 * inf
+		const Vector3 inv(p_dir.x != 0 ? 1.0 / p_dir.x : 1e30, p_dir.y != 0 ? 1.0 / p_dir.y : 1e30, p_dir.z != 0 ? 1.0 / p_dir.z : 1e30);
+		const uint32_t *prims = primitives.ptr();
+		real_t max_t = p_max_t;
+
+		int32_t *stack = (int32_t *)alloca(sizeof(int32_t) * (max_depth * 3 + 1));
+		int stack_size = 1;
+		stack[0] = 0;
+
+		while (stack_size) {
+
+			const Node &node = nodes[stack[--stack_size]];
+
+			real_t nears[4];
+			bool hit[4];
+			for (int i = 0; i < 4; i++) {
+
+				real_t x0 = (node.min_x[i] - p_from.x) * inv.x;
+				real_t x1 = (node.max_x[i] - p_from.x) * inv.x;
+				real_t y0 = (node.min_y[i] - p_from.y) * inv.y;
+				real_t y1 = (node.max_y[i] - p_from.y) * inv.y;
+				real_t z0 = (node.min_z[i] - p_from.z) * inv.z;
+				real_t z1 = (node.max_z[i] - p_from.z) * inv.z;
+
+				real_t t_near = MAX(MAX(MIN(x0, x1), MIN(y0, y1)), MAX(MIN(z0, z1), 0));
+				real_t t_far = MIN(MIN(MAX(x0, x1), MAX(y0, y1)), MIN(MAX(z0, z1), max_t));
+
+				nears[i] = t_near;
+				hit[i] = (t_near <= t_far) & (node.counts[i] >= 0);
+			}
+
+			// closest children first: leaves are tested right away, nodes are pushed farthest first
+			int order[4];
+			int order_count = 0;
+			for (int i = 0; i < 4; i++) {
+
+				if (!hit[i])
+					continue;
+
+				int j = order_count++;
+				while (j > 0 && nears[order[j - 1]] > nears[i]) {
+					order[j] = order[j - 1];
+					j--;
+				}
+				order[j] = i;
+			}
+
+			for (int k = 0; k < order_count; k++) {
+
+				int i = order[k];
+				if (node.counts[i] == 0 || nears[i] > max_t)
+					continue;
+
+				for (int j = node.children[i]; j < node.children[i] + node.counts[i]; j++) {
+					if (!p_callback(prims[j], max_t))
+						return;
+				}
+			}
+
+			for (int k = order_count - 1; k >= 0; k--) {
+
+				int i = order[k];
+				if (node.counts[i] == 0) {
+					stack[stack_size++] = node.children[i];
+				}
+			}
+		}
+	}
+
+	void operator=(const TriangleBVH &p_from);
+
+	TriangleBVH(const TriangleBVH &p_from);
+	TriangleBVH();
+	~TriangleBVH();
+};
+
+#endif // TRIANGLE_BVH_H
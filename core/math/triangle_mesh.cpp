@@ -29,64 +29,6 @@
 /*************************************************************************/
 
 #include "triangle_mesh.h"
-#include "sort.h"
-
-int TriangleMesh::_create_bvh(BVH *p_bvh, BVH **p_bb, int p_from, int p_size, int p_depth, int &max_depth, int &max_alloc) {
-
-	if (p_depth > max_depth) {
-		max_depth = p_depth;
-	}
-
-	if (p_size == 1) {
-
-		return p_bb[p_from] - p_bvh;
-	} else if (p_size == 0) {
-
-		return -1;
-	}
-
-	AABB aabb;
-	aabb = p_bb[p_from]->aabb;
-	for (int i = 1; i < p_size; i++) {
-
-		aabb.merge_with(p_bb[p_from + i]->aabb);
-	}
-
-	int li = aabb.get_longest_axis_index();
-
-	switch (li) {
-
-		case Vector3::AXIS_X: {
-			SortArray<BVH *, BVHCmpX> sort_x;
-			sort_x.nth_element(0, p_size, p_size / 2, &p_bb[p_from]);
-			//sort_x.sort(&p_bb[p_from],p_size);
-		} break;
-		case Vector3::AXIS_Y: {
-			SortArray<BVH *, BVHCmpY> sort_y;
-			sort_y.nth_element(0, p_size, p_size / 2, &p_bb[p_from]);
-			//sort_y.sort(&p_bb[p_from],p_size);
-		} break;
-		case Vector3::AXIS_Z: {
-			SortArray<BVH *, BVHCmpZ> sort_z;
-			sort_z.nth_element(0, p_size, p_size / 2, &p_bb[p_from]);
-			//sort_z.sort(&p_bb[p_from],p_size);
-
-		} break;
-	}
-
-	int left = _create_bvh(p_bvh, p_bb, p_from, p_size / 2, p_depth + 1, max_depth, max_alloc);
-	int right = _create_bvh(p_bvh, p_bb, p_from + p_size / 2, p_size - p_size / 2, p_depth + 1, max_depth, max_alloc);
-
-	int index = max_alloc++;
-	BVH *_new = &p_bvh[index];
-	_new->aabb = aabb;
-	_new->center = aabb.position + aabb.size * 0.5;
-	_new->face_index = -1;
-	_new->left = left;
-	_new->right = right;
-
-	return index;
-}
 
 void TriangleMesh::create(const PoolVector<Vector3> &p_faces) {
 
@@ -97,12 +39,12 @@ void TriangleMesh::create(const PoolVector<Vector3> &p_faces) {
 	fc /= 3;
 	triangles.resize(fc);
 
-	bvh.resize(fc * 3); //will never be larger than this (todo make better)
-	PoolVector<BVH>::Write bw = bvh.write();
+	LocalVector<AABB> aabbs;
+	aabbs.resize(fc);
 
 	{
 
-		//create faces and indices and base bvh
+		//create faces and indices and their bounds
 		//except for the Set for repeated triangles, everything
 		//goes in-place.
 
@@ -129,17 +71,12 @@ void TriangleMesh::create(const PoolVector<Vector3> &p_faces) {
 
 				f.indices[j] = vidx;
 				if (j == 0)
-					bw[i].aabb.position = vs;
+					aabbs[i].position = vs;
 				else
-					bw[i].aabb.expand_to(vs);
+					aabbs[i].expand_to(vs);
 			}
 
 			f.normal = Face3(r[i * 3 + 0], r[i * 3 + 1], r[i * 3 + 2]).get_plane().get_normal();
-
-			bw[i].left = -1;
-			bw[i].right = -1;
-			bw[i].face_index = i;
-			bw[i].center = bw[i].aabb.position + bw[i].aabb.size * 0.5;
 		}
 
 		vertices.resize(db.size());
@@ -149,345 +86,182 @@ void TriangleMesh::create(const PoolVector<Vector3> &p_faces) {
 		}
 	}
 
-	PoolVector<BVH *> bwptrs;
-	bwptrs.resize(fc);
-	PoolVector<BVH *>::Write bwp = bwptrs.write();
-	for (int i = 0; i < fc; i++) {
-
-		bwp[i] = &bw[i];
-	}
-
-	max_depth = 0;
-	int max_alloc = fc;
-	_create_bvh(bw.ptr(), bwp.ptr(), 0, fc, 1, max_depth, max_alloc);
-
-	bw = PoolVector<BVH>::Write(); //clearup
-	bvh.resize(max_alloc); //resize back
+	bvh.build(aabbs.ptr(), fc);
 
 	valid = true;
 }
 
 Vector3 TriangleMesh::get_area_normal(const AABB &p_aabb) const {
 
-	uint32_t *stack = (uint32_t *)alloca(sizeof(int) * max_depth);
-
-	enum {
-		TEST_AABB_BIT = 0,
-		VISIT_LEFT_BIT = 1,
-		VISIT_RIGHT_BIT = 2,
-		VISIT_DONE_BIT = 3,
-		VISITED_BIT_SHIFT = 29,
-		NODE_IDX_MASK = (1 << VISITED_BIT_SHIFT) - 1,
-		VISITED_BIT_MASK = ~NODE_IDX_MASK,
-
-	};
-
-	int n_count = 0;
-	Vector3 n;
-
-	int level = 0;
+	struct AreaNormalCull {
 
-	PoolVector<Triangle>::Read trianglesr = triangles.read();
-	PoolVector<Vector3>::Read verticesr = vertices.read();
-	PoolVector<BVH>::Read bvhr = bvh.read();
-
-	const Triangle *triangleptr = trianglesr.ptr();
-	int pos = bvh.size() - 1;
-	const BVH *bvhptr = bvhr.ptr();
-
-	stack[0] = pos;
-	while (true) {
-
-		uint32_t node = stack[level] & NODE_IDX_MASK;
-		const BVH &b = bvhptr[node];
-		bool done = false;
-
-		switch (stack[level] >> VISITED_BIT_SHIFT) {
-			case TEST_AABB_BIT: {
-
-				bool valid = b.aabb.intersects(p_aabb);
-				if (!valid) {
-
-					stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-
-				} else {
-
-					if (b.face_index >= 0) {
-
-						const Triangle &s = triangleptr[b.face_index];
-						n += s.normal;
-						n_count++;
-
-						stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
+		AABB aabb;
+		const Triangle *triangles;
+		const Vector3 *vertices;
+		Vector3 normal;
+		int count;
 
-					} else {
+		_FORCE_INLINE_ bool operator()(uint32_t p_index) {
 
-						stack[level] = (VISIT_LEFT_BIT << VISITED_BIT_SHIFT) | node;
-					}
-				}
-				continue;
-			}
-			case VISIT_LEFT_BIT: {
-
-				stack[level] = (VISIT_RIGHT_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.left | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_RIGHT_BIT: {
+			const Triangle &s = triangles[p_index];
+			AABB face_aabb(vertices[s.indices[0]], Vector3());
+			face_aabb.expand_to(vertices[s.indices[1]]);
+			face_aabb.expand_to(vertices[s.indices[2]]);
 
-				stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.right | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_DONE_BIT: {
-
-				if (level == 0) {
-					done = true;
-					break;
-				} else
-					level--;
-				continue;
+			if (face_aabb.intersects(aabb)) {
+				normal += s.normal;
+				count++;
 			}
+			return true;
 		}
-
-		if (done)
-			break;
-	}
-
-	if (n_count > 0)
-		n /= n_count;
-
-	return n;
-}
-
-bool TriangleMesh::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
-
-	uint32_t *stack = (uint32_t *)alloca(sizeof(int) * max_depth);
-
-	enum {
-		TEST_AABB_BIT = 0,
-		VISIT_LEFT_BIT = 1,
-		VISIT_RIGHT_BIT = 2,
-		VISIT_DONE_BIT = 3,
-		VISITED_BIT_SHIFT = 29,
-		NODE_IDX_MASK = (1 << VISITED_BIT_SHIFT) - 1,
-		VISITED_BIT_MASK = ~NODE_IDX_MASK,
-
 	};
 
-	Vector3 n = (p_end - p_begin).normalized();
-	real_t d = 1e10;
-	bool inters = false;
-
-	int level = 0;
-
 	PoolVector<Triangle>::Read trianglesr = triangles.read();
 	PoolVector<Vector3>::Read verticesr = vertices.read();
-	PoolVector<BVH>::Read bvhr = bvh.read();
-
-	const Triangle *triangleptr = trianglesr.ptr();
-	const Vector3 *vertexptr = verticesr.ptr();
-	int pos = bvh.size() - 1;
-	const BVH *bvhptr = bvhr.ptr();
-
-	stack[0] = pos;
-	while (true) {
 
-		uint32_t node = stack[level] & NODE_IDX_MASK;
-		const BVH &b = bvhptr[node];
-		bool done = false;
+	AreaNormalCull cull;
+	cull.aabb = p_aabb;
+	cull.triangles = trianglesr.ptr();
+	cull.vertices = verticesr.ptr();
+	cull.count = 0;
+	bvh.cull_aabb(p_aabb, cull);
 
-		switch (stack[level] >> VISITED_BIT_SHIFT) {
-			case TEST_AABB_BIT: {
+	Vector3 n = cull.normal;
+	if (cull.count > 0)
+		n /= cull.count;
 
-				bool valid = b.aabb.intersects_segment(p_begin, p_end);
-				//bool valid = b.aabb.intersects(ray_aabb);
-
-				if (!valid) {
-
-					stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-
-				} else {
-
-					if (b.face_index >= 0) {
+	return n;
+}
 
-						const Triangle &s = triangleptr[b.face_index];
-						Face3 f3(vertexptr[s.indices[0]], vertexptr[s.indices[1]], vertexptr[s.indices[2]]);
+bool TriangleMesh::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
 
-						Vector3 res;
+	struct SegmentCull {
 
-						if (f3.intersects_segment(p_begin, p_end, &res)) {
+		Vector3 begin;
+		Vector3 end;
+		Vector3 dir;
+		real_t dir_len_sq;
+		const Triangle *triangles;
+		const Vector3 *vertices;
+		Vector3 point;
+		Vector3 normal;
+		real_t min_t;
+		bool found;
 
-							real_t nd = n.dot(res);
-							if (nd < d) {
+		_FORCE_INLINE_ bool operator()(uint32_t p_index, real_t &r_max_t) {
 
-								d = nd;
-								r_point = res;
-								r_normal = f3.get_plane().get_normal();
-								inters = true;
-							}
-						}
+			const Triangle &s = triangles[p_index];
+			Face3 f3(vertices[s.indices[0]], vertices[s.indices[1]], vertices[s.indices[2]]);
 
-						stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
+			Vector3 res;
+			if (f3.intersects_segment(begin, end, &res)) {
 
-					} else {
+				real_t t = (res - begin).dot(dir) / dir_len_sq;
+				if (!found || t < min_t) {
 
-						stack[level] = (VISIT_LEFT_BIT << VISITED_BIT_SHIFT) | node;
-					}
+					min_t = t;
+					point = res;
+					normal = f3.get_plane().get_normal();
+					found = true;
+					r_max_t = MIN(r_max_t, MAX(t, 0));
 				}
-				continue;
-			}
-			case VISIT_LEFT_BIT: {
-
-				stack[level] = (VISIT_RIGHT_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.left | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_RIGHT_BIT: {
-
-				stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.right | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_DONE_BIT: {
-
-				if (level == 0) {
-					done = true;
-					break;
-				} else
-					level--;
-				continue;
 			}
+			return true;
 		}
+	};
 
-		if (done)
-			break;
-	}
+	Vector3 dir = p_end - p_begin;
+	real_t dir_len_sq = dir.length_squared();
+	if (dir_len_sq == 0)
+		return false;
 
-	if (inters) {
+	PoolVector<Triangle>::Read trianglesr = triangles.read();
+	PoolVector<Vector3>::Read verticesr = vertices.read();
 
-		if (n.dot(r_normal) > 0)
+	SegmentCull cull;
+	cull.begin = p_begin;
+	cull.end = p_end;
+	cull.dir = dir;
+	cull.dir_len_sq = dir_len_sq;
+	cull.triangles = trianglesr.ptr();
+	cull.vertices = verticesr.ptr();
+	cull.min_t = 0;
+	cull.found = false;
+	bvh.cull_ray(p_begin, dir, 1, cull);
+
+	if (cull.found) {
+
+		r_point = cull.point;
+		r_normal = cull.normal;
+		if (dir.dot(r_normal) > 0)
 			r_normal = -r_normal;
 	}
 
-	return inters;
+	return cull.found;
 }
 
 bool TriangleMesh::intersect_ray(const Vector3 &p_begin, const Vector3 &p_dir, Vector3 &r_point, Vector3 &r_normal) const {
 
-	uint32_t *stack = (uint32_t *)alloca(sizeof(int) * max_depth);
-
-	enum {
-		TEST_AABB_BIT = 0,
-		VISIT_LEFT_BIT = 1,
-		VISIT_RIGHT_BIT = 2,
-		VISIT_DONE_BIT = 3,
-		VISITED_BIT_SHIFT = 29,
-		NODE_IDX_MASK = (1 << VISITED_BIT_SHIFT) - 1,
-		VISITED_BIT_MASK = ~NODE_IDX_MASK,
-
-	};
-
-	Vector3 n = p_dir;
-	real_t d = 1e20;
-	bool inters = false;
-
-	int level = 0;
-
-	PoolVector<Triangle>::Read trianglesr = triangles.read();
-	PoolVector<Vector3>::Read verticesr = vertices.read();
-	PoolVector<BVH>::Read bvhr = bvh.read();
-
-	const Triangle *triangleptr = trianglesr.ptr();
-	const Vector3 *vertexptr = verticesr.ptr();
-	int pos = bvh.size() - 1;
-	const BVH *bvhptr = bvhr.ptr();
-
-	stack[0] = pos;
-	while (true) {
-
-		uint32_t node = stack[level] & NODE_IDX_MASK;
-		const BVH &b = bvhptr[node];
-		bool done = false;
-
-		switch (stack[level] >> VISITED_BIT_SHIFT) {
-			case TEST_AABB_BIT: {
-
-				bool valid = b.aabb.intersects_ray(p_begin, p_dir);
-				if (!valid) {
-
-					stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-
-				} else {
-
-					if (b.face_index >= 0) {
-
-						const Triangle &s = triangleptr[b.face_index];
-						Face3 f3(vertexptr[s.indices[0]], vertexptr[s.indices[1]], vertexptr[s.indices[2]]);
-
-						Vector3 res;
+	struct RayCull {
 
-						if (f3.intersects_ray(p_begin, p_dir, &res)) {
+		Vector3 begin;
+		Vector3 dir;
+		real_t dir_len_sq;
+		const Triangle *triangles;
+		const Vector3 *vertices;
+		Vector3 point;
+		Vector3 normal;
+		real_t min_t;
+		bool found;
 
-							real_t nd = n.dot(res);
-							if (nd < d) {
+		_FORCE_INLINE_ bool operator()(uint32_t p_index, real_t &r_max_t) {
 
-								d = nd;
-								r_point = res;
-								r_normal = f3.get_plane().get_normal();
-								inters = true;
-							}
-						}
+			const Triangle &s = triangles[p_index];
+			Face3 f3(vertices[s.indices[0]], vertices[s.indices[1]], vertices[s.indices[2]]);
 
-						stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
+			Vector3 res;
+			if (f3.intersects_ray(begin, dir, &res)) {
 
-					} else {
+				real_t t = (res - begin).dot(dir) / dir_len_sq;
+				if (!found || t < min_t) {
 
-						stack[level] = (VISIT_LEFT_BIT << VISITED_BIT_SHIFT) | node;
-					}
+					min_t = t;
+					point = res;
+					normal = f3.get_plane().get_normal();
+					found = true;
+					r_max_t = MIN(r_max_t, MAX(t, 0));
 				}
-				continue;
-			}
-			case VISIT_LEFT_BIT: {
-
-				stack[level] = (VISIT_RIGHT_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.left | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_RIGHT_BIT: {
-
-				stack[level] = (VISIT_DONE_BIT << VISITED_BIT_SHIFT) | node;
-				stack[level + 1] = b.right | TEST_AABB_BIT;
-				level++;
-				continue;
-			}
-			case VISIT_DONE_BIT: {
-
-				if (level == 0) {
-					done = true;
-					break;
-				} else
-					level--;
-				continue;
 			}
+			return true;
 		}
+	};
 
-		if (done)
-			break;
-	}
+	real_t dir_len_sq = p_dir.length_squared();
+	if (dir_len_sq == 0)
+		return false;
 
-	if (inters) {
+	PoolVector<Triangle>::Read trianglesr = triangles.read();
+	PoolVector<Vector3>::Read verticesr = vertices.read();
 
-		if (n.dot(r_normal) > 0)
+	RayCull cull;
+	cull.begin = p_begin;
+	cull.dir = p_dir;
+	cull.dir_len_sq = dir_len_sq;
+	cull.triangles = trianglesr.ptr();
+	cull.vertices = verticesr.ptr();
+	cull.min_t = 0;
+	cull.found = false;
+	bvh.cull_ray(p_begin, p_dir, 1e20, cull);
+
+	if (cull.found) {
+
+		r_point = cull.point;
+		r_normal = cull.normal;
+		if (p_dir.dot(r_normal) > 0)
 			r_normal = -r_normal;
 	}
 
-	return inters;
+	return cull.found;
 }
 
 bool TriangleMesh::is_valid() const {
@@ -521,5 +295,4 @@ PoolVector<Face3> TriangleMesh::get_faces() const {
 TriangleMesh::TriangleMesh() {
 
 	valid = false;
-	max_depth = 0;
 }
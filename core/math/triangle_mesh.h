@@ -33,6 +33,8 @@
 
 #include "face3.h"
 #include "reference.h"
+#include "triangle_bvh.h"
+
 class TriangleMesh : public Reference {
 
 	GDCLASS(TriangleMesh, Reference);
@@ -46,43 +48,7 @@ class TriangleMesh : public Reference {
 	PoolVector<Triangle> triangles;
 	PoolVector<Vector3> vertices;
 
-	struct BVH {
-
-		AABB aabb;
-		Vector3 center; //used for sorting
-		int left;
-		int right;
-
-		int face_index;
-	};
-
-	struct BVHCmpX {
-
-		bool operator()(const BVH *p_left, const BVH *p_right) const {
-
-			return p_left->center.x < p_right->center.x;
-		}
-	};
-
-	struct BVHCmpY {
-
-		bool operator()(const BVH *p_left, const BVH *p_right) const {
-
-			return p_left->center.y < p_right->center.y;
-		}
-	};
-	struct BVHCmpZ {
-
-		bool operator()(const BVH *p_left, const BVH *p_right) const {
-
-			return p_left->center.z < p_right->center.z;
-		}
-	};
-
-	int _create_bvh(BVH *p_bvh, BVH **p_bb, int p_from, int p_size, int p_depth, int &max_depth, int &max_alloc);
-
-	PoolVector<BVH> bvh;
-	int max_depth;
+	TriangleBVH bvh;
 	bool valid;
 
 public:
@@ -30,6 +30,7 @@
 
 #include "message_queue.h"
 
+#include "frame_profiler.h"
 #include "project_settings.h"
 #include "script_language.h"
 
@@ -266,6 +267,8 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 
 void MessageQueue::flush() {
 
+	FRAME_PROFILE_SCOPE("core/message_queue_flush");
+
 	if (buffer_end > buffer_max_used) {
 		buffer_max_used = buffer_end;
 		//statistics();
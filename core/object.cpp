@@ -1143,24 +1143,27 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		return ERR_UNAVAILABLE;
 	}
 
-	List<_ObjectSignalDisconnectData> disconnect_data;
+	List<_ObjectSignalDisconnectData> disconnect_data; // only allocates for one shot connections
 
 	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
 	//this happens automatically and will not change the performance of calling.
 	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	const VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map; // const, so reading it never triggers the copy
 
 	int ssize = slot_map.size();
 
 	OBJ_DEBUG_LOCK
 
+	// arguments plus binds are passed from the stack, unless a connection has a lot of binds
+	const Variant *stack_args[VARIANT_ARG_MAX * 2];
 	Vector<const Variant *> bind_mem;
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slot_map.getv(i);
+		const Connection &c = slot.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
@@ -1175,24 +1178,37 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			argc = p_argcount + c.binds.size();
+
+			const Variant **bind_args = stack_args;
+			if (argc > VARIANT_ARG_MAX * 2) {
+				bind_mem.resize(argc);
+				bind_args = bind_mem.ptrw();
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem[j] = p_args[j];
+				bind_args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem[p_argcount + j] = &c.binds[j];
+				bind_args[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_id(), c.method, args, argc, true);
 		} else {
 			Variant::CallError ce;
-			target->call(c.method, args, argc, ce);
+			if (slot.method_bind && !target->script_instance) {
+				// native target, skip the method lookup of Object::call
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock target_lock(target);
+#endif
+				slot.method_bind->call(target, args, argc, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 
 			if (ce.error != Variant::CallError::CALL_OK) {
 
@@ -1424,6 +1440,9 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	conn.binds = p_binds;
 	slot.conn = conn;
 	slot.cE = p_to_object->connections.push_back(conn);
+	if (p_to_method != CoreStringNames::get_singleton()->_free) {
+		slot.method_bind = ClassDB::get_method(p_to_object->get_class_name(), p_to_method);
+	}
 	s->slot_map[target] = slot;
 
 	return OK;
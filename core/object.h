@@ -35,6 +35,7 @@
 #include "map.h"
 #include "os/rw_lock.h"
 #include "set.h"
+#include "swiss_hash_map.h"
 #include "variant.h"
 #include "vmap.h"
 
@@ -381,6 +382,7 @@ public:                                                        \
 private:
 
 class ScriptInstance;
+class MethodBind;
 typedef uint64_t ObjectID;
 
 class Object {
@@ -442,6 +444,12 @@ private:
 
 			Connection conn;
 			List<Connection>::Element *cE;
+			MethodBind *method_bind; // resolved on connect, used when the target has no script
+
+			Slot() {
+				cE = NULL;
+				method_bind = NULL;
+			}
 		};
 
 		MethodInfo user;
@@ -450,7 +458,7 @@ private:
 		Signal() { lock = 0; }
 	};
 
-	HashMap<StringName, Signal, StringNameHasher> signal_map;
+	SwissHashMap<StringName, Signal, StringNameHasher> signal_map;
 	List<Connection> connections;
 #ifdef DEBUG_ENABLED
 	SafeRefCount _lock_index;
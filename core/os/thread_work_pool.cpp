@@ -0,0 +1,154 @@
+/*************************************************************************/
+/*  thread_work_pool.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "thread_work_pool.h"
+
+#include "os/os.h"
+
+ThreadWorkPool *ThreadWorkPool::singleton = NULL;
+
+void ThreadWorkPool::_thread_function(void *p_user) {
+
+	ThreadData *thread = (ThreadData *)p_user;
+
+	while (true) {
+		thread->start->wait();
+		if (thread->exit) {
+			break;
+		}
+		thread->work->work();
+		thread->completed->post();
+	}
+}
+
+void ThreadWorkPool::init(int p_thread_count, Thread::Priority p_priority) {
+
+	ERR_FAIL_COND(threads != NULL);
+
+#ifdef NO_THREADS
+	p_thread_count = 0;
+#endif
+
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count() - 1;
+	}
+
+	if (p_thread_count <= 0) {
+		return;
+	}
+
+	threads = memnew_arr(ThreadData, p_thread_count);
+
+	Thread::Settings settings;
+	settings.priority = p_priority;
+
+	for (int i = 0; i < p_thread_count; i++) {
+
+		ThreadData &td = threads[thread_count];
+		td.work = NULL;
+		td.exit = false;
+		td.start = Semaphore::create();
+		td.completed = Semaphore::create();
+		td.thread = NULL;
+
+		if (td.start && td.completed) {
+			td.thread = Thread::create(&ThreadWorkPool::_thread_function, &td, settings);
+		}
+
+		if (!td.thread) {
+			//threads not available on this platform, work is done by the calling thread alone
+			if (td.start) {
+				memdelete(td.start);
+			}
+			if (td.completed) {
+				memdelete(td.completed);
+			}
+			break;
+		}
+
+		thread_count++;
+	}
+}
+
+void ThreadWorkPool::finish() {
+
+	if (!threads) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].exit = true;
+		threads[i].start->post();
+	}
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+		memdelete(threads[i].start);
+		memdelete(threads[i].completed);
+	}
+
+	memdelete_arr(threads);
+	threads = NULL;
+	thread_count = 0;
+}
+
+ThreadWorkPool *ThreadWorkPool::get_singleton() {
+
+	return singleton;
+}
+
+void ThreadWorkPool::create_singleton() {
+
+	ERR_FAIL_COND(singleton != NULL);
+	singleton = memnew(ThreadWorkPool);
+	singleton->init();
+}
+
+void ThreadWorkPool::free_singleton() {
+
+	if (singleton) {
+		memdelete(singleton);
+		singleton = NULL;
+	}
+}
+
+ThreadWorkPool::ThreadWorkPool() {
+
+	threads = NULL;
+	thread_count = 0;
+	users = 0;
+}
+
+ThreadWorkPool::~ThreadWorkPool() {
+
+	finish();
+}
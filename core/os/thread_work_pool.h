@@ -0,0 +1,156 @@
+/*************************************************************************/
+/*  thread_work_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef THREAD_WORK_POOL_H
+#define THREAD_WORK_POOL_H
+
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
+
+/**
+ * Persistent pool of worker threads that process the elements of an array in parallel.
+ *
+ * Unlike thread_process_array(), threads are created once in init() and sleep on a
+ * semaphore between jobs, so do_work() neither creates threads nor allocates memory
+ * and can be used from time-critical threads (like the audio mix). Elements are
+ * claimed with an atomic counter, and the calling thread processes elements too,
+ * so a job always makes progress even if the workers are slow to wake up.
+ *
+ * The engine owns one pool shared by everything that parallelizes work (see
+ * get_singleton()), which is created with the core types and has one thread per
+ * extra processor. A pool only runs one job at a time: do_work() called while it's
+ * busy, from a job or from another thread, processes its elements on the calling
+ * thread instead of waiting, so nesting and concurrent callers are safe.
+ */
+
+class ThreadWorkPool {
+
+	struct BaseWork {
+		uint32_t index;
+		uint32_t max_elements;
+
+		virtual void work() = 0;
+		virtual ~BaseWork() {}
+	};
+
+	template <class C, class M, class U>
+	struct Work : public BaseWork {
+
+		C *instance;
+		M method;
+		U userdata;
+
+		virtual void work() {
+
+			while (true) {
+				uint32_t work_index = atomic_increment(&this->index) - 1;
+				if (work_index >= this->max_elements) {
+					break;
+				}
+				(instance->*method)(work_index, userdata);
+			}
+		}
+	};
+
+	struct ThreadData {
+		Thread *thread;
+		Semaphore *start;
+		Semaphore *completed;
+		BaseWork *work;
+		bool exit;
+	};
+
+	ThreadData *threads;
+	uint32_t thread_count;
+	uint32_t users;
+
+	static ThreadWorkPool *singleton;
+
+	static void _thread_function(void *p_user);
+
+public:
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+
+		if (p_elements == 0) {
+			return;
+		}
+
+		if (atomic_increment(&users) != 1 || thread_count == 0 || p_elements == 1) {
+			//busy with another job (or nothing to share), the caller does it all
+			for (uint32_t i = 0; i < p_elements; i++) {
+				(p_instance->*p_method)(i, p_userdata);
+			}
+			atomic_decrement(&users);
+			return;
+		}
+
+		Work<C, M, U> w;
+		w.index = 0;
+		w.max_elements = p_elements;
+		w.instance = p_instance;
+		w.method = p_method;
+		w.userdata = p_userdata;
+
+		// the calling thread takes part, so only wake as many workers as there are elements left for them
+		uint32_t wake_count = MIN(thread_count, p_elements - 1);
+
+		for (uint32_t i = 0; i < wake_count; i++) {
+			threads[i].work = &w;
+			threads[i].start->post();
+		}
+
+		w.work();
+
+		for (uint32_t i = 0; i < wake_count; i++) {
+			threads[i].completed->wait();
+			threads[i].work = NULL;
+		}
+
+		atomic_decrement(&users);
+	}
+
+	_FORCE_INLINE_ uint32_t get_thread_count() const { return thread_count; }
+
+	static ThreadWorkPool *get_singleton();
+	static void create_singleton();
+	static void free_singleton();
+
+	// p_thread_count is the amount of worker threads besides the calling one, -1 uses one less than the processor count
+	void init(int p_thread_count = -1, Thread::Priority p_priority = Thread::PRIORITY_NORMAL);
+	void finish();
+
+	ThreadWorkPool();
+	~ThreadWorkPool();
+};
+
+#endif // THREAD_WORK_POOL_H
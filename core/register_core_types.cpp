@@ -41,6 +41,7 @@
 #include "input_map.h"
 #include "io/config_file.h"
 #include "io/http_client.h"
+#include "io/http_client_pool.h"
 #include "io/marshalls.h"
 #include "io/networked_multiplayer_peer.h"
 #include "io/packet_peer.h"
@@ -55,6 +56,7 @@
 #include "math/triangle_mesh.h"
 #include "os/input.h"
 #include "os/main_loop.h"
+#include "os/thread_work_pool.h"
 #include "packed_data_container.h"
 #include "path_remap.h"
 #include "project_settings.h"
@@ -92,6 +94,8 @@ void register_core_types() {
 
 	_global_mutex = Mutex::create();
 
+	ThreadWorkPool::create_singleton();
+
 	StringName::setup();
 
 	register_global_constants();
@@ -151,6 +155,7 @@ void register_core_types() {
 	ClassDB::register_class<PHashTranslation>();
 	ClassDB::register_class<UndoRedo>();
 	ClassDB::register_class<HTTPClient>();
+	ClassDB::register_class<HTTPClientPool>();
 	ClassDB::register_class<TriangleMesh>();
 
 	ClassDB::register_virtual_class<ResourceInteractiveLoader>();
@@ -225,6 +230,8 @@ void register_core_singletons() {
 
 void unregister_core_types() {
 
+	ThreadWorkPool::free_singleton();
+
 	memdelete(_resource_loader);
 	memdelete(_resource_saver);
 	memdelete(_os);
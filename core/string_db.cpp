@@ -33,6 +33,8 @@
 #include "os/os.h"
 #include "print_string.h"
 
+#include <string.h>
+
 StaticCString StaticCString::create(const char *p_ptr) {
 	StaticCString scs;
 	scs.ptr = p_ptr;
@@ -93,6 +95,67 @@ void StringName::cleanup() {
 	memdelete(lock);
 }
 
+bool StringName::_Data::is_name(const char *p_name) const {
+
+	if (cname)
+		return strcmp(cname, p_name) == 0;
+
+	return name == p_name;
+}
+
+bool StringName::_Data::is_name(const CharType *p_name) const {
+
+	if (!cname)
+		return name == p_name;
+
+	int i = 0;
+	for (; cname[i]; i++) {
+		if (CharType(cname[i]) != p_name[i])
+			return false;
+	}
+
+	return p_name[i] == 0;
+}
+
+String StringName::_Data::get_cached_name() {
+
+	// widened once, so converting the same name again only shares the String
+	if (!atomic_add(&name_cached, 0)) {
+
+		lock->lock();
+		if (!name_cached) {
+			name = String(cname);
+			atomic_increment(&name_cached);
+		}
+		lock->unlock();
+	}
+
+	return name;
+}
+
+void StringName::_Data::set_name(const String &p_name) {
+
+	const int len = p_name.length();
+	const CharType *src = p_name.c_str();
+
+	for (int i = 0; i < len; i++) {
+		if (src[i] < 1 || src[i] > 0x7F) {
+			// needs the wide representation
+			name = p_name;
+			cname = NULL;
+			return;
+		}
+	}
+
+	ascii.resize(len + 1);
+	char *dst = ascii.ptrw();
+	for (int i = 0; i < len; i++) {
+		dst[i] = char(src[i]);
+	}
+	dst[len] = 0;
+	cname = ascii.ptr();
+}
+
 void StringName::unref() {
 
 	ERR_FAIL_COND(!configured);
@@ -127,7 +190,7 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return (_data->is_name(p_name));
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -137,7 +200,7 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return (_data->is_name(p_name));
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -203,7 +266,7 @@ StringName::StringName(const char *p_name) {
 	while (_data) {
 
 		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
+		if (_data->hash == hash && _data->is_name(p_name))
 			break;
 		_data = _data->next;
 	}
@@ -218,11 +281,10 @@ StringName::StringName(const char *p_name) {
 	}
 
 	_data = memnew(_Data);
-	_data->name = p_name;
+	_data->set_name(p_name);
 	_data->refcount.init();
 	_data->hash = hash;
 	_data->idx = idx;
-	_data->cname = NULL;
 	_data->next = _table[idx];
 	_data->prev = NULL;
 	if (_table[idx])
@@ -251,7 +313,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 	while (_data) {
 
 		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
+		if (_data->hash == hash && _data->is_name(p_static_string.ptr))
 			break;
 		_data = _data->next;
 	}
@@ -299,7 +361,7 @@ StringName::StringName(const String &p_name) {
 
 	while (_data) {
 
-		if (_data->hash == hash && _data->get_name() == p_name)
+		if (_data->hash == hash && _data->is_name(p_name))
 			break;
 		_data = _data->next;
 	}
@@ -314,11 +376,10 @@ StringName::StringName(const String &p_name) {
 	}
 
 	_data = memnew(_Data);
-	_data->name = p_name;
+	_data->set_name(p_name);
 	_data->refcount.init();
 	_data->hash = hash;
 	_data->idx = idx;
-	_data->cname = NULL;
 	_data->next = _table[idx];
 	_data->prev = NULL;
 	if (_table[idx])
@@ -328,6 +389,17 @@ StringName::StringName(const String &p_name) {
 	lock->unlock();
 }
 
+CharString StringName::utf8() const {
+
+	if (!_data)
+		return CharString();
+
+	if (_data->cname && _data->ascii.size())
+		return _data->ascii; // already UTF-8, shared
+
+	return operator String().utf8();
+}
+
 StringName StringName::search(const char *p_name) {
 
 	ERR_FAIL_COND_V(!configured, StringName());
@@ -347,7 +419,7 @@ StringName StringName::search(const char *p_name) {
 	while (_data) {
 
 		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
+		if (_data->hash == hash && _data->is_name(p_name))
 			break;
 		_data = _data->next;
 	}
@@ -381,7 +453,7 @@ StringName StringName::search(const CharType *p_name) {
 	while (_data) {
 
 		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
+		if (_data->hash == hash && _data->is_name(p_name))
 			break;
 		_data = _data->next;
 	}
@@ -409,7 +481,7 @@ StringName StringName::search(const String &p_name) {
 	while (_data) {
 
 		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
+		if (_data->hash == hash && _data->is_name(p_name))
 			break;
 		_data = _data->next;
 	}
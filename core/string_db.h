@@ -57,15 +57,23 @@ class StringName {
 	struct _Data {
 		SafeRefCount refcount;
 		const char *cname;
-		String name;
+		CharString ascii; // one byte per character for 7-bit names created at runtime, cname points into it
+		String name; // for names with a cname, only set once they were converted to String
+		uint32_t name_cached;
 
 		String get_name() const { return cname ? String(cname) : name; }
+		String get_cached_name();
+		bool is_name(const String &p_name) const { return cname ? p_name == cname : name == p_name; }
+		bool is_name(const char *p_name) const;
+		bool is_name(const CharType *p_name) const;
+		void set_name(const String &p_name);
 		int idx;
 		uint32_t hash;
 		_Data *prev;
 		_Data *next;
 		_Data() {
 			cname = NULL;
+			name_cached = 0;
 			next = prev = NULL;
 			hash = 0;
 		}
@@ -123,7 +131,7 @@ public:
 
 		if (_data) {
 			if (_data->cname)
-				return String(_data->cname);
+				return _data->get_cached_name();
 			else
 				return _data->name;
 		}
@@ -131,6 +139,8 @@ public:
 		return String();
 	}
 
+	CharString utf8() const;
+
 	static StringName search(const char *p_name);
 	static StringName search(const CharType *p_name);
 	static StringName search(const String &p_name);
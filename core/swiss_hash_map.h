@@ -0,0 +1,466 @@
+/*************************************************************************/
+/*  swiss_hash_map.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef SWISS_HASH_MAP_H
+#define SWISS_HASH_MAP_H
+
+#include "error_macros.h"
+#include "hash_map.h"
+#include "hashfuncs.h"
+#include "list.h"
+#include "os/memory.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWISS_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/**
+ * @class SwissHashMap
+ *
+ * Open addressing hash map with a separate array of one-byte control entries
+ * per slot, probed a group of slots at a time: 16 with SSE2, 8 in a 64-bit word
+ * otherwise.
+ *
+ * Each control byte is either empty, deleted (tombstone) or holds the low 7 bits
+ * of the hash of the key stored in that slot, so a lookup compares a whole group
+ * of candidates with a single instruction and only touches the keys whose bits
+ * match. Keys and values are stored inline, which avoids the per-element
+ * allocation and pointer chasing of HashMap.
+ *
+ * The interface mirrors HashMap (set/get/getptr/has/erase/next/operator[]), so it
+ * can replace it where the caveat below holds.
+ *
+ * Unlike HashMap, inserting may move elements: pointers obtained through
+ * getptr(), get() or next() are invalidated by any insertion. Erasing never moves
+ * other elements.
+ */
+
+template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey> >
+class SwissHashMap {
+public:
+	struct Pair {
+
+		TKey key;
+		TData data;
+
+		Pair() {}
+		Pair(const TKey &p_key, const TData &p_data) :
+				key(p_key),
+				data(p_data) {
+		}
+	};
+
+private:
+#ifdef SWISS_HASH_MAP_SSE2
+	typedef uint32_t GroupMask; // one bit per slot
+#else
+	typedef uint64_t GroupMask; // high bit of one byte per slot
+#endif
+
+	enum {
+#ifdef SWISS_HASH_MAP_SSE2
+		GROUP_SIZE = 16,
+#else
+		GROUP_SIZE = 8,
+#endif
+		MIN_CAPACITY = 16,
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE,
+		H2_MASK = 0x7F
+	};
+
+	uint8_t *ctrl;
+	Pair *slots;
+	uint32_t capacity;
+	uint32_t elements;
+	uint32_t tombstones;
+
+#ifdef SWISS_HASH_MAP_SSE2
+	static _FORCE_INLINE_ __m128i _load(const uint8_t *p_group) {
+		return _mm_loadu_si128((const __m128i *)p_group);
+	}
+
+	// Bit i of the result is set when control byte i of the group equals p_byte.
+	static _FORCE_INLINE_ GroupMask _match(const uint8_t *p_group, uint8_t p_byte) {
+		return (GroupMask)_mm_movemask_epi8(_mm_cmpeq_epi8(_load(p_group), _mm_set1_epi8((char)p_byte)));
+	}
+
+	static _FORCE_INLINE_ GroupMask _match_empty(const uint8_t *p_group) {
+		return _match(p_group, CTRL_EMPTY);
+	}
+
+	// Empty and deleted are the only control values with the high bit set.
+	static _FORCE_INLINE_ GroupMask _match_free(const uint8_t *p_group) {
+		return (GroupMask)_mm_movemask_epi8(_load(p_group));
+	}
+
+	static _FORCE_INLINE_ uint32_t _first(GroupMask p_mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long idx;
+		_BitScanForward(&idx, p_mask);
+		return idx;
+#else
+		return __builtin_ctz(p_mask);
+#endif
+	}
+#else
+	// Without SSE2 the group is matched eight bytes at a time in a 64-bit word.
+	static _FORCE_INLINE_ uint64_t _load(const uint8_t *p_group) {
+		uint64_t word;
+		memcpy(&word, p_group, sizeof(word));
+#ifdef BIG_ENDIAN_ENABLED
+		word = BSWAP64(word);
+#endif
+		return word;
+	}
+
+	// May report a false positive next to a real match, which the key comparison rejects.
+	static _FORCE_INLINE_ GroupMask _match(const uint8_t *p_group, uint8_t p_byte) {
+		uint64_t x = _load(p_group) ^ (0x0101010101010101ULL * p_byte);
+		return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+	}
+
+	// Empty is the only value with the high bit set and bit 1 clear.
+	static _FORCE_INLINE_ GroupMask _match_empty(const uint8_t *p_group) {
+		uint64_t word = _load(p_group);
+		return word & (~word << 6) & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ GroupMask _match_free(const uint8_t *p_group) {
+		return _load(p_group) & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ uint32_t _first(GroupMask p_mask) {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(p_mask) >> 3;
+#else
+		uint32_t idx = 0;
+		while (!(p_mask & 0x80)) {
+			p_mask >>= 8;
+			idx++;
+		}
+		return idx;
+#endif
+	}
+#endif
+
+	_FORCE_INLINE_ int _find(const TKey &p_key, uint32_t p_hash) const {
+
+		if (unlikely(!capacity))
+			return -1;
+
+		const uint8_t h2 = p_hash & H2_MASK;
+		const uint32_t group_mask = (capacity / GROUP_SIZE) - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+
+		// Triangular probing visits every group when the group count is a power of two.
+		for (uint32_t i = 1;; i++) {
+
+			const uint32_t base = group * GROUP_SIZE;
+			GroupMask match = _match(&ctrl[base], h2);
+			while (match) {
+				uint32_t idx = base + _first(match);
+				if (Comparator::compare(slots[idx].key, p_key))
+					return idx;
+				match &= match - 1;
+			}
+
+			if (_match_empty(&ctrl[base]))
+				return -1;
+
+			group = (group + i) & group_mask;
+		}
+	}
+
+	_FORCE_INLINE_ uint32_t _find_free(uint32_t p_hash) const {
+
+		const uint32_t group_mask = (capacity / GROUP_SIZE) - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+
+		for (uint32_t i = 1;; i++) {
+
+			const uint32_t base = group * GROUP_SIZE;
+			GroupMask mask = _match_free(&ctrl[base]);
+			if (mask)
+				return base + _first(mask);
+
+			group = (group + i) & group_mask;
+		}
+	}
+
+	void _rehash(uint32_t p_capacity) {
+
+		uint8_t *old_ctrl = ctrl;
+		Pair *old_slots = slots;
+		uint32_t old_capacity = capacity;
+
+		capacity = p_capacity;
+		ctrl = (uint8_t *)memalloc(capacity);
+		slots = (Pair *)memalloc(sizeof(Pair) * capacity);
+		memset(ctrl, CTRL_EMPTY, capacity);
+		tombstones = 0;
+
+		for (uint32_t i = 0; i < old_capacity; i++) {
+
+			if (old_ctrl[i] & CTRL_EMPTY)
+				continue;
+
+			uint32_t hash = Hasher::hash(old_slots[i].key);
+			uint32_t idx = _find_free(hash);
+			ctrl[idx] = hash & H2_MASK;
+			memnew_placement(&slots[idx], Pair(old_slots[i].key, old_slots[i].data));
+			old_slots[i].~Pair();
+		}
+
+		if (old_ctrl) {
+			memfree(old_ctrl);
+			memfree(old_slots);
+		}
+	}
+
+	Pair *_insert(const TKey &p_key, const TData &p_data, uint32_t p_hash) {
+
+		if (unlikely(!capacity)) {
+			_rehash(MIN_CAPACITY);
+		} else if ((elements + tombstones + 1) * 8 > capacity * 7) {
+			// Keep at least 1/8 of the slots empty so probing always terminates.
+			// Only grow when live elements need it, otherwise just flush the tombstones.
+			_rehash((elements + 1) * 16 > capacity * 7 ? capacity << 1 : capacity);
+		}
+
+		uint32_t idx = _find_free(p_hash);
+		if (ctrl[idx] == CTRL_DELETED)
+			tombstones--;
+		ctrl[idx] = p_hash & H2_MASK;
+		memnew_placement(&slots[idx], Pair(p_key, p_data));
+		elements++;
+		return &slots[idx];
+	}
+
+	void _copy_from(const SwissHashMap &p_from) {
+
+		if (!p_from.capacity)
+			return;
+
+		capacity = p_from.capacity;
+		elements = p_from.elements;
+		tombstones = p_from.tombstones;
+		ctrl = (uint8_t *)memalloc(capacity);
+		slots = (Pair *)memalloc(sizeof(Pair) * capacity);
+		memcpy(ctrl, p_from.ctrl, capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY))
+				memnew_placement(&slots[i], Pair(p_from.slots[i]));
+		}
+	}
+
+public:
+	void set(const TKey &p_key, const TData &p_data) {
+
+		uint32_t hash = Hasher::hash(p_key);
+		int idx = _find(p_key, hash);
+		if (idx >= 0)
+			slots[idx].data = p_data;
+		else
+			_insert(p_key, p_data, hash);
+	}
+
+	bool has(const TKey &p_key) const {
+
+		return _find(p_key, Hasher::hash(p_key)) >= 0;
+	}
+
+	const TData &get(const TKey &p_key) const {
+
+		const TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	TData &get(const TKey &p_key) {
+
+		TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	_FORCE_INLINE_ TData *getptr(const TKey &p_key) {
+
+		int idx = _find(p_key, Hasher::hash(p_key));
+		return idx >= 0 ? &slots[idx].data : NULL;
+	}
+
+	_FORCE_INLINE_ const TData *getptr(const TKey &p_key) const {
+
+		int idx = _find(p_key, Hasher::hash(p_key));
+		return idx >= 0 ? &slots[idx].data : NULL;
+	}
+
+	bool erase(const TKey &p_key) {
+
+		int idx = _find(p_key, Hasher::hash(p_key));
+		if (idx < 0)
+			return false;
+
+		slots[idx].~Pair();
+		elements--;
+
+		// A group that still has an empty slot never made a probe continue past it,
+		// so the slot can become empty again instead of a tombstone.
+		const uint8_t *group = &ctrl[idx & ~uint32_t(GROUP_SIZE - 1)];
+		if (_match_empty(group)) {
+			ctrl[idx] = CTRL_EMPTY;
+		} else {
+			ctrl[idx] = CTRL_DELETED;
+			tombstones++;
+		}
+		return true;
+	}
+
+	inline const TData &operator[](const TKey &p_key) const {
+
+		return get(p_key);
+	}
+
+	inline TData &operator[](const TKey &p_key) {
+
+		uint32_t hash = Hasher::hash(p_key);
+		int idx = _find(p_key, hash);
+		if (idx >= 0)
+			return slots[idx].data;
+		return _insert(p_key, TData(), hash)->data;
+	}
+
+	/**
+	 * Same iteration scheme as HashMap::next(): pass NULL to get the first key,
+	 * then the previous key to get the following one. NULL means the end.
+	 */
+	const TKey *next(const TKey *p_key) const {
+
+		uint32_t idx = 0;
+		if (p_key) {
+			// The key is the first member of Pair, so its address is the address of the slot.
+			idx = uint32_t(reinterpret_cast<const Pair *>(p_key) - slots) + 1;
+		}
+
+		for (; idx < capacity; idx++) {
+			if (!(ctrl[idx] & CTRL_EMPTY))
+				return &slots[idx].key;
+		}
+
+		return NULL;
+	}
+
+	/**
+	 * Make room for p_elements without further rehashing.
+	 */
+	void reserve(uint32_t p_elements) {
+
+		uint32_t new_capacity = capacity ? capacity : MIN_CAPACITY;
+		while (p_elements * 8 > new_capacity * 7)
+			new_capacity <<= 1;
+		if (new_capacity > capacity)
+			_rehash(new_capacity);
+	}
+
+	void clear() {
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY))
+				slots[i].~Pair();
+		}
+
+		if (ctrl) {
+			memfree(ctrl);
+			memfree(slots);
+		}
+
+		ctrl = NULL;
+		slots = NULL;
+		capacity = 0;
+		elements = 0;
+		tombstones = 0;
+	}
+
+	inline unsigned int size() const { return elements; }
+	inline bool empty() const { return elements == 0; }
+	inline uint32_t get_capacity() const { return capacity; }
+
+	void get_key_list(List<TKey> *p_keys) const {
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY))
+				p_keys->push_back(slots[i].key);
+		}
+	}
+
+	void operator=(const SwissHashMap &p_table) {
+
+		if (this == &p_table)
+			return;
+		clear();
+		_copy_from(p_table);
+	}
+
+	SwissHashMap(const SwissHashMap &p_table) {
+
+		ctrl = NULL;
+		slots = NULL;
+		capacity = 0;
+		elements = 0;
+		tombstones = 0;
+		_copy_from(p_table);
+	}
+
+	SwissHashMap() {
+
+		ctrl = NULL;
+		slots = NULL;
+		capacity = 0;
+		elements = 0;
+		tombstones = 0;
+	}
+
+	~SwissHashMap() {
+
+		clear();
+	}
+};
+
+#endif // SWISS_HASH_MAP_H
@@ -40,6 +40,7 @@
 #include "thirdparty/misc/md5.h"
 #include "thirdparty/misc/sha256.h"
 
+#include <string.h>
 #include <wchar.h>
 
 #ifndef NO_USE_STDLIB
@@ -51,12 +52,72 @@
 #define snprintf _snprintf
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USTRING_SSE2
+#include <emmintrin.h>
+#endif
+
 #define MAX_DIGITS 6
 #define UPPERCASE(m_c) (((m_c) >= 'a' && (m_c) <= 'z') ? ((m_c) - ('a' - 'A')) : (m_c))
 #define LOWERCASE(m_c) (((m_c) >= 'A' && (m_c) <= 'Z') ? ((m_c) + ('a' - 'A')) : (m_c))
 #define IS_DIGIT(m_d) ((m_d) >= '0' && (m_d) <= '9')
 #define IS_HEX_DIGIT(m_d) (((m_d) >= '0' && (m_d) <= '9') || ((m_d) >= 'a' && (m_d) <= 'f') || ((m_d) >= 'A' && (m_d) <= 'F'))
 
+/* Wide string helpers. The SSE2 paths read four characters per lane and are only
+ * used when CharType is 32 bits wide (not on Windows, where it is UTF-16) */
+
+#ifdef USTRING_SSE2
+#define USTRING_SIMD_ENABLED (sizeof(CharType) == 4)
+#else
+#define USTRING_SIMD_ENABLED false
+#endif
+
+// length of the leading run of 7-bit characters
+static int _ascii_prefix_len(const CharType *p_str, int p_len) {
+
+	int i = 0;
+#ifdef USTRING_SSE2
+	if (USTRING_SIMD_ENABLED) {
+		const __m128i high = _mm_set1_epi32(~0x7F);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= p_len; i += 8) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(p_str + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(p_str + i + 4));
+			__m128i bits = _mm_and_si128(_mm_or_si128(a, b), high);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(bits, zero)) != 0xFFFF)
+				break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		if (uint32_t(p_str[i]) > 0x7F)
+			break;
+	}
+
+	return i;
+}
+
+// narrows 7-bit characters to bytes
+static void _pack_ascii(const CharType *p_src, uint8_t *p_dst, int p_len) {
+
+	int i = 0;
+#ifdef USTRING_SSE2
+	if (USTRING_SIMD_ENABLED) {
+		for (; i + 16 <= p_len; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(p_src + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(p_src + i + 4));
+			__m128i c = _mm_loadu_si128((const __m128i *)(p_src + i + 8));
+			__m128i d = _mm_loadu_si128((const __m128i *)(p_src + i + 12));
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+			_mm_storeu_si128((__m128i *)(p_dst + i), packed);
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		p_dst[i] = uint8_t(p_src[i]);
+	}
+}
+
 bool is_symbol(CharType c) {
 	return c != '_' && ((c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~') || c == '\t' || c == ' ');
 }
@@ -110,6 +171,31 @@ const char *CharString::get_data() const {
 		return "";
 }
 
+CharType *String::_get_static_char(CharType p_char) {
+
+	struct StaticChar {
+		uint32_t refcount;
+		uint32_t size;
+		CharType data[2];
+	};
+
+	struct StaticChars {
+		StaticChar chars[STATIC_CHAR_MAX];
+
+		StaticChars(uint32_t p_refcount) {
+			for (int i = 0; i < STATIC_CHAR_MAX; i++) {
+				chars[i].refcount = p_refcount;
+				chars[i].size = 2;
+				chars[i].data[0] = i;
+				chars[i].data[1] = 0;
+			}
+		}
+	};
+
+	static StaticChars static_chars(STATIC_REFCOUNT);
+	return static_chars.chars[p_char].data;
+}
+
 void String::copy_from(const char *p_cstr) {
 
 	if (!p_cstr) {
@@ -129,6 +215,12 @@ void String::copy_from(const char *p_cstr) {
 		return;
 	}
 
+	if (len == 1) {
+
+		copy_from(CharType(p_cstr[0]));
+		return;
+	}
+
 	resize(len + 1); // include 0
 
 	CharType *dst = this->ptrw();
@@ -161,22 +253,36 @@ void String::copy_from(const CharType *p_cstr, int p_clip_to) {
 		return;
 	}
 
+	if (len == 1) {
+
+		copy_from(p_cstr[0]);
+		return;
+	}
+
 	resize(len + 1);
-	set(len, 0);
 
-	CharType *dst = &operator[](0);
+	CharType *dst = ptrw();
 
 	for (int i = 0; i < len; i++) {
 
 		dst[i] = p_cstr[i];
 	}
+	dst[len] = 0;
 }
 
 void String::copy_from(const CharType &p_char) {
 
+	if (p_char > 0 && p_char < STATIC_CHAR_MAX) {
+
+		_set_static(_get_static_char(p_char));
+		return;
+	}
+
 	resize(2);
-	set(0, p_char);
-	set(1, 0);
+
+	CharType *dst = ptrw();
+	dst[0] = p_char;
+	dst[1] = 0;
 }
 
 bool String::operator==(const String &p_str) const {
@@ -186,19 +292,13 @@ bool String::operator==(const String &p_str) const {
 	if (empty())
 		return true;
 
-	int l = length();
-
 	const CharType *src = c_str();
 	const CharType *dst = p_str.c_str();
 
-	/* Compare char by char */
-	for (int i = 0; i < l; i++) {
-
-		if (src[i] != dst[i])
-			return false;
-	}
+	if (src == dst)
+		return true; // shared copy
 
-	return true;
+	return memcmp(src, dst, length() * sizeof(CharType)) == 0;
 }
 
 bool String::operator!=(const String &p_str) const {
@@ -232,16 +332,16 @@ String &String::operator+=(const String &p_str) {
 		return *this;
 
 	int from = length();
+	int src_len = p_str.length();
 
-	resize(length() + p_str.size());
+	resize(from + p_str.size());
 
 	const CharType *src = p_str.c_str();
-	CharType *dst = &operator[](0);
+	CharType *dst = ptrw();
 
-	set(length(), 0);
-
-	for (int i = 0; i < p_str.length(); i++)
+	for (int i = 0; i < src_len; i++)
 		dst[from + i] = src[i];
+	dst[from + src_len] = 0;
 
 	return *this;
 }
@@ -254,9 +354,12 @@ String &String::operator+=(const CharType *p_str) {
 
 String &String::operator+=(CharType p_char) {
 
-	resize(size() ? size() + 1 : 2);
-	set(length(), 0);
-	set(length() - 1, p_char);
+	int from = length();
+	resize(from + 2);
+
+	CharType *dst = ptrw();
+	dst[from] = p_char;
+	dst[from + 1] = 0;
 
 	return *this;
 }
@@ -275,12 +378,11 @@ String &String::operator+=(const char *p_str) {
 
 	resize(from + src_len + 1);
 
-	CharType *dst = &operator[](0);
-
-	set(length(), 0);
+	CharType *dst = ptrw();
 
 	for (int i = 0; i < src_len; i++)
 		dst[from + i] = p_str[i];
+	dst[from + src_len] = 0;
 
 	return *this;
 }
@@ -319,11 +421,7 @@ bool String::operator==(const StrRange &p_str_range) const {
 
 bool String::operator==(const char *p_str) const {
 
-	int len = 0;
-	const char *aux = p_str;
-
-	while (*(aux++) != 0)
-		len++;
+	int len = strlen(p_str);
 
 	if (length() != len)
 		return false;
@@ -334,8 +432,29 @@ bool String::operator==(const char *p_str) const {
 
 	const CharType *dst = c_str();
 
+	int i = 0;
+#ifdef USTRING_SSE2
+	if (USTRING_SIMD_ENABLED) {
+		for (; i + 16 <= l; i += 16) {
+			// widen with sign extension, the same as the char to CharType conversion below
+			__m128i bytes = _mm_loadu_si128((const __m128i *)(p_str + i));
+			__m128i lo = _mm_unpacklo_epi8(bytes, bytes);
+			__m128i hi = _mm_unpackhi_epi8(bytes, bytes);
+			__m128i c0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24);
+			__m128i c1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24);
+			__m128i c2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24);
+			__m128i c3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24);
+			__m128i eq = _mm_and_si128(
+					_mm_and_si128(_mm_cmpeq_epi32(c0, _mm_loadu_si128((const __m128i *)(dst + i))), _mm_cmpeq_epi32(c1, _mm_loadu_si128((const __m128i *)(dst + i + 4)))),
+					_mm_and_si128(_mm_cmpeq_epi32(c2, _mm_loadu_si128((const __m128i *)(dst + i + 8))), _mm_cmpeq_epi32(c3, _mm_loadu_si128((const __m128i *)(dst + i + 12)))));
+			if (_mm_movemask_epi8(eq) != 0xFFFF)
+				return false;
+		}
+	}
+#endif
+
 	/* Compare char by char */
-	for (int i = 0; i < l; i++) {
+	for (; i < l; i++) {
 
 		if (p_str[i] != dst[i])
 			return false;
@@ -346,29 +465,14 @@ bool String::operator==(const char *p_str) const {
 
 bool String::operator==(const CharType *p_str) const {
 
-	int len = 0;
-	const CharType *aux = p_str;
-
-	while (*(aux++) != 0)
-		len++;
+	int len = wcslen(p_str);
 
 	if (length() != len)
 		return false;
 	if (empty())
 		return true;
 
-	int l = length();
-
-	const CharType *dst = c_str();
-
-	/* Compare char by char */
-	for (int i = 0; i < l; i++) {
-
-		if (p_str[i] != dst[i])
-			return false;
-	}
-
-	return true;
+	return memcmp(p_str, c_str(), len * sizeof(CharType)) == 0;
 }
 
 bool String::operator!=(const char *p_str) const {
@@ -883,12 +987,19 @@ String String::to_upper() const {
 
 	String upper = *this;
 
-	for (int i = 0; i < upper.size(); i++) {
+	int len = size();
+	const CharType *src = ptr();
+	CharType *dst = NULL;
 
-		const char s = upper[i];
+	for (int i = 0; i < len; i++) {
+
+		const char s = src[i];
 		const char t = _find_upper(s);
-		if (s != t) // avoid copy on write
-			upper[i] = t;
+		if (s != t) {
+			if (!dst) // avoid copy on write until something changes
+				dst = upper.ptrw();
+			dst[i] = t;
+		}
 	}
 
 	return upper;
@@ -898,12 +1009,19 @@ String String::to_lower() const {
 
 	String lower = *this;
 
-	for (int i = 0; i < lower.size(); i++) {
+	int len = size();
+	const CharType *src = ptr();
+	CharType *dst = NULL;
+
+	for (int i = 0; i < len; i++) {
 
-		const char s = lower[i];
+		const char s = src[i];
 		const char t = _find_lower(s);
-		if (s != t) // avoid copy on write
-			lower[i] = t;
+		if (s != t) {
+			if (!dst) // avoid copy on write until something changes
+				dst = lower.ptrw();
+			dst[i] = t;
+		}
 	}
 
 	return lower;
@@ -1245,8 +1363,11 @@ CharString String::ascii(bool p_allow_extended) const {
 	CharString cs;
 	cs.resize(size());
 
-	for (int i = 0; i < size(); i++)
-		cs[i] = operator[](i);
+	int len = size();
+	const CharType *src = ptr();
+	char *dst = cs.ptrw();
+	for (int i = 0; i < len; i++)
+		dst[i] = src[i];
 
 	return cs;
 }
@@ -1419,8 +1540,20 @@ CharString String::utf8() const {
 		return CharString();
 
 	const CharType *d = &operator[](0);
-	int fl = 0;
-	for (int i = 0; i < l; i++) {
+
+	// plain ASCII, which most strings are, is narrowed without encoding
+	const int ascii_len = _ascii_prefix_len(d, l);
+	if (ascii_len == l) {
+		CharString utf8s;
+		utf8s.resize(l + 1);
+		uint8_t *cdst = (uint8_t *)utf8s.get_data();
+		_pack_ascii(d, cdst, l);
+		cdst[l] = 0;
+		return utf8s;
+	}
+
+	int fl = ascii_len;
+	for (int i = ascii_len; i < l; i++) {
 
 		uint32_t c = d[i];
 		if (c <= 0x7f) // 7 bits.
@@ -1447,9 +1580,12 @@ CharString String::utf8() const {
 	utf8s.resize(fl + 1);
 	uint8_t *cdst = (uint8_t *)utf8s.get_data();
 
+	_pack_ascii(d, cdst, ascii_len);
+	cdst += ascii_len;
+
 #define APPEND_CHAR(m_c) *(cdst++) = m_c
 
-	for (int i = 0; i < l; i++) {
+	for (int i = ascii_len; i < l; i++) {
 
 		uint32_t c = d[i];
 
@@ -2058,7 +2194,13 @@ uint32_t String::hash(const char *p_cstr, int p_len) {
 uint32_t String::hash(const CharType *p_cstr, int p_len) {
 
 	uint32_t hashv = 5381;
-	for (int i = 0; i < p_len; i++)
+	int i = 0;
+
+	// four characters per step, the same as four single steps but with a shorter dependency chain
+	for (; i + 4 <= p_len; i += 4) {
+		hashv = hashv * 1185921 + uint32_t(p_cstr[i]) * 35937 + uint32_t(p_cstr[i + 1]) * 1089 + uint32_t(p_cstr[i + 2]) * 33 + uint32_t(p_cstr[i + 3]);
+	}
+	for (; i < p_len; i++)
 		hashv = ((hashv << 5) + hashv) + p_cstr[i]; /* hash * 33 + c */
 
 	return hashv;
@@ -2080,9 +2222,20 @@ uint32_t String::hash() const {
 	/* simple djb2 hashing */
 
 	const CharType *chr = c_str();
+	const int len = length();
 	uint32_t hashv = 5381;
-	uint32_t c;
+	int i = 0;
+
+	// unrolled as in hash(const CharType *, int), still stopping at an embedded zero
+	for (; i + 4 <= len; i += 4) {
+		const uint32_t c0 = chr[i], c1 = chr[i + 1], c2 = chr[i + 2], c3 = chr[i + 3];
+		if (!c0 || !c1 || !c2 || !c3)
+			break;
+		hashv = hashv * 1185921 + c0 * 35937 + c1 * 1089 + c2 * 33 + c3;
+	}
 
+	uint32_t c;
+	chr += i;
 	while ((c = *chr++))
 		hashv = ((hashv << 5) + hashv) + c; /* hash * 33 + c */
 
@@ -2222,26 +2375,29 @@ int String::find(const String &p_str, int p_from) const {
 	const CharType *src = c_str();
 	const CharType *str = p_str.c_str();
 
-	for (int i = p_from; i <= (len - src_len); i++) {
-
-		bool found = true;
-		for (int j = 0; j < src_len; j++) {
-
-			int read_pos = i + j;
-
-			if (read_pos >= len) {
-
-				ERR_PRINT("read_pos>=len");
-				return -1;
-			};
-
-			if (src[read_pos] != str[j]) {
-				found = false;
-				break;
+	// scan for the first character, then verify the rest of the match
+	const CharType first = str[0];
+	const size_t rest_size = (src_len - 1) * sizeof(CharType);
+	const int last = len - src_len;
+	int i = p_from;
+
+#ifdef USTRING_SSE2
+	if (USTRING_SIMD_ENABLED) {
+		const __m128i first_v = _mm_set1_epi32(first);
+		for (; i + 3 <= last; i += 4) {
+			__m128i chars = _mm_loadu_si128((const __m128i *)(src + i));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chars, first_v)));
+			for (int j = 0; mask; j++, mask >>= 1) {
+				if ((mask & 1) && memcmp(src + i + j + 1, str + 1, rest_size) == 0)
+					return i + j;
 			}
 		}
+	}
+#endif
 
-		if (found)
+	for (; i <= last; i++) {
+
+		if (src[i] == first && memcmp(src + i + 1, str + 1, rest_size) == 0)
 			return i;
 	}
 
@@ -62,9 +62,14 @@ struct StrRange {
 
 class String : public Vector<CharType> {
 
+	enum {
+		STATIC_CHAR_MAX = 256 // strings of a single Latin-1 character are shared static data, not allocated
+	};
+
 	void copy_from(const char *p_cstr);
 	void copy_from(const CharType *p_cstr, int p_clip_to = -1);
 	void copy_from(const CharType &p_char);
+	static CharType *_get_static_char(CharType p_char);
 	bool _base_is_subsequence_of(const String &p_string, bool case_insensitive) const;
 
 public:
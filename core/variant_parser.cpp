@@ -35,34 +35,40 @@
 #include "os/input_event.h"
 #include "os/keyboard.h"
 
-CharType VariantParser::StreamFile::get_char() {
+uint32_t VariantParser::StreamFile::_read_buffer(CharType *p_buffer, uint32_t p_num_chars) {
 
-	return f->get_8();
+	uint8_t temp[READAHEAD_SIZE];
+	int read = f->get_buffer(temp, MIN(p_num_chars, (uint32_t)READAHEAD_SIZE));
+	for (int i = 0; i < read; i++) {
+		p_buffer[i] = temp[i];
+	}
+	return read;
 }
 
 bool VariantParser::StreamFile::is_utf8() const {
 
 	return true;
 }
-bool VariantParser::StreamFile::is_eof() const {
 
-	return f->eof_reached();
+uint64_t VariantParser::StreamFile::get_position() const {
+
+	return f->get_position() - get_readahead_count() - (saved ? 1 : 0);
 }
 
-CharType VariantParser::StreamString::get_char() {
+uint32_t VariantParser::StreamString::_read_buffer(CharType *p_buffer, uint32_t p_num_chars) {
 
-	if (pos >= s.length())
+	int read = MIN((int)p_num_chars, s.length() - pos);
+	if (read <= 0)
 		return 0;
-	else
-		return s[pos++];
+
+	memcpy(p_buffer, s.ptr() + pos, read * sizeof(CharType));
+	pos += read;
+	return read;
 }
 
 bool VariantParser::StreamString::is_utf8() const {
 	return false;
 }
-bool VariantParser::StreamString::is_eof() const {
-	return pos > s.length();
-}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -85,6 +91,89 @@ const char *VariantParser::tk_name[TK_MAX] = {
 	"ERROR"
 };
 
+// Reads a number starting with p_char and leaves the character that ended it in p_stream->saved.
+// Returns true and sets r_real for floats, sets r_int otherwise.
+bool VariantParser::_read_number(Stream *p_stream, CharType p_char, int64_t &r_int, double &r_real) {
+
+	StringBuffer<> num;
+#define READING_SIGN 0
+#define READING_INT 1
+#define READING_DEC 2
+#define READING_EXP 3
+#define READING_DONE 4
+	int reading = READING_INT;
+	int64_t integer = 0;
+	int64_t sign = 1;
+
+	if (p_char == '-') {
+		num += '-';
+		sign = -1;
+		p_char = p_stream->get_char();
+	}
+
+	CharType c = p_char;
+	bool exp_sign = false;
+	bool exp_beg = false;
+	bool is_float = false;
+
+	while (true) {
+
+		switch (reading) {
+			case READING_INT: {
+
+				if (c >= '0' && c <= '9') {
+					integer = integer * 10 + (c - '0');
+				} else if (c == '.') {
+					reading = READING_DEC;
+					is_float = true;
+				} else if (c == 'e') {
+					reading = READING_EXP;
+					is_float = true;
+				} else {
+					reading = READING_DONE;
+				}
+
+			} break;
+			case READING_DEC: {
+
+				if (c >= '0' && c <= '9') {
+
+				} else if (c == 'e') {
+					reading = READING_EXP;
+				} else {
+					reading = READING_DONE;
+				}
+
+			} break;
+			case READING_EXP: {
+
+				if (c >= '0' && c <= '9') {
+					exp_beg = true;
+
+				} else if ((c == '-' || c == '+') && !exp_sign && !exp_beg) {
+					exp_sign = true;
+
+				} else {
+					reading = READING_DONE;
+				}
+			} break;
+		}
+
+		if (reading == READING_DONE)
+			break;
+		num += c;
+		c = p_stream->get_char();
+	}
+
+	p_stream->saved = c;
+
+	if (is_float)
+		r_real = num.as_double();
+	else
+		r_int = sign * integer;
+	return is_float;
+}
+
 Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, String &r_err_str) {
 
 	while (true) {
@@ -200,7 +289,8 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 			};
 			case '"': {
 
-				String str;
+				StringBuffer<> str;
+				bool ascii = true;
 				while (true) {
 
 					CharType ch = p_stream->get_char();
@@ -274,19 +364,25 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 						}
 
 						str += res;
+						ascii = ascii && res < 128;
 
 					} else {
 						if (ch == '\n')
 							line++;
 						str += ch;
+						ascii = ascii && ch < 128;
 					}
 				}
 
-				if (p_stream->is_utf8()) {
-					str.parse_utf8(str.ascii(true).get_data());
-				}
 				r_token.type = TK_STRING;
-				r_token.value = str;
+				if (p_stream->is_utf8() && !ascii) {
+					String utf8;
+					utf8.parse_utf8(str.as_string().ascii(true).get_data());
+					r_token.value = utf8;
+				} else {
+					// plain ASCII decodes to itself, skip the UTF-8 round trip
+					r_token.value = str.as_string();
+				}
 				return OK;
 
 			} break;
@@ -299,81 +395,13 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 				if (cchar == '-' || (cchar >= '0' && cchar <= '9')) {
 					//a number
 
-					StringBuffer<> num;
-#define READING_SIGN 0
-#define READING_INT 1
-#define READING_DEC 2
-#define READING_EXP 3
-#define READING_DONE 4
-					int reading = READING_INT;
-
-					if (cchar == '-') {
-						num += '-';
-						cchar = p_stream->get_char();
-					}
-
-					CharType c = cchar;
-					bool exp_sign = false;
-					bool exp_beg = false;
-					bool is_float = false;
-
-					while (true) {
-
-						switch (reading) {
-							case READING_INT: {
-
-								if (c >= '0' && c <= '9') {
-									//pass
-								} else if (c == '.') {
-									reading = READING_DEC;
-									is_float = true;
-								} else if (c == 'e') {
-									reading = READING_EXP;
-									is_float = true;
-								} else {
-									reading = READING_DONE;
-								}
-
-							} break;
-							case READING_DEC: {
-
-								if (c >= '0' && c <= '9') {
-
-								} else if (c == 'e') {
-									reading = READING_EXP;
-								} else {
-									reading = READING_DONE;
-								}
-
-							} break;
-							case READING_EXP: {
-
-								if (c >= '0' && c <= '9') {
-									exp_beg = true;
-
-								} else if ((c == '-' || c == '+') && !exp_sign && !exp_beg) {
-									exp_sign = true;
-
-								} else {
-									reading = READING_DONE;
-								}
-							} break;
-						}
-
-						if (reading == READING_DONE)
-							break;
-						num += c;
-						c = p_stream->get_char();
-					}
-
-					p_stream->saved = c;
-
+					int64_t int_value;
+					double real_value;
 					r_token.type = TK_NUMBER;
-
-					if (is_float)
-						r_token.value = num.as_double();
+					if (_read_number(p_stream, cchar, int_value, real_value))
+						r_token.value = real_value;
 					else
-						r_token.value = num.as_int();
+						r_token.value = int_value;
 					return OK;
 
 				} else if ((cchar >= 'A' && cchar <= 'Z') || (cchar >= 'a' && cchar <= 'z') || cchar == '_') {
@@ -440,6 +468,33 @@ Error VariantParser::_parse_enginecfg(Stream *p_stream, Vector<String> &strings,
 	return OK;
 }
 
+CharType VariantParser::_skip_blanks(Stream *p_stream, int &line) {
+
+	CharType c;
+	if (p_stream->saved) {
+		c = p_stream->saved;
+		p_stream->saved = 0;
+	} else {
+		c = p_stream->get_char();
+	}
+
+	while (true) {
+
+		if (c == '\n') {
+			line++;
+		} else if (c == ';') {
+			do {
+				c = p_stream->get_char();
+			} while (c != '\n' && c != 0);
+			continue;
+		} else if (c > 32 || c == 0) {
+			return c;
+		}
+
+		c = p_stream->get_char();
+	}
+}
+
 template <class T>
 Error VariantParser::_parse_construct(Stream *p_stream, Vector<T> &r_construct, int &line, String &r_err_str) {
 
@@ -450,33 +505,48 @@ Error VariantParser::_parse_construct(Stream *p_stream, Vector<T> &r_construct,
 		return ERR_PARSE_ERROR;
 	}
 
+	// Arguments are scanned straight from the stream instead of going through get_token(),
+	// as the Pool*Array constructors of big scenes and meshes are mostly made of these.
+	int count = 0;
+	T *w = NULL;
+
 	bool first = true;
 	while (true) {
 
+		CharType c = _skip_blanks(p_stream, line);
+
 		if (!first) {
-			get_token(p_stream, token, line, r_err_str);
-			if (token.type == TK_COMMA) {
-				//do none
-			} else if (token.type == TK_PARENTHESIS_CLOSE) {
+			if (c == ',') {
+				c = _skip_blanks(p_stream, line);
+			} else if (c == ')') {
 				break;
 			} else {
 				r_err_str = "Expected ',' or ')' in constructor";
 				return ERR_PARSE_ERROR;
 			}
 		}
-		get_token(p_stream, token, line, r_err_str);
 
-		if (first && token.type == TK_PARENTHESIS_CLOSE) {
+		if (first && c == ')') {
 			break;
-		} else if (token.type != TK_NUMBER) {
+		} else if (c != '-' && (c < '0' || c > '9')) {
 			r_err_str = "Expected float in constructor";
 			return ERR_PARSE_ERROR;
 		}
 
-		r_construct.push_back(token.value);
+		int64_t int_value;
+		double real_value;
+		bool is_float = _read_number(p_stream, c, int_value, real_value);
+
+		if (count == r_construct.size()) {
+			r_construct.resize(MAX(count * 2, 16));
+			w = r_construct.ptrw();
+		}
+		w[count++] = is_float ? T(real_value) : T(int_value);
 		first = false;
 	}
 
+	r_construct.resize(count);
+
 	return OK;
 }
 
@@ -1070,9 +1140,7 @@ Error VariantParser::parse_value(Token &token, Variant &value, Stream *p_stream,
 				int len = args.size();
 				arr.resize(len);
 				PoolVector<uint8_t>::Write w = arr.write();
-				for (int i = 0; i < len; i++) {
-					w[i] = args[i];
-				}
+				copymem(w.ptr(), args.ptr(), len * sizeof(uint8_t));
 			}
 
 			value = arr;
@@ -1091,9 +1159,7 @@ Error VariantParser::parse_value(Token &token, Variant &value, Stream *p_stream,
 				int len = args.size();
 				arr.resize(len);
 				PoolVector<int>::Write w = arr.write();
-				for (int i = 0; i < len; i++) {
-					w[i] = int(args[i]);
-				}
+				copymem(w.ptr(), args.ptr(), len * sizeof(int));
 			}
 
 			value = arr;
@@ -1112,9 +1178,7 @@ Error VariantParser::parse_value(Token &token, Variant &value, Stream *p_stream,
 				int len = args.size();
 				arr.resize(len);
 				PoolVector<float>::Write w = arr.write();
-				for (int i = 0; i < len; i++) {
-					w[i] = args[i];
-				}
+				copymem(w.ptr(), args.ptr(), len * sizeof(float));
 			}
 
 			value = arr;
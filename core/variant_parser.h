@@ -39,35 +39,79 @@ class VariantParser {
 public:
 	struct Stream {
 
-		virtual CharType get_char() = 0;
+	protected:
+		enum {
+			READAHEAD_SIZE = 2048
+		};
+
+	private:
+		CharType readahead_buffer[READAHEAD_SIZE];
+		uint32_t readahead_pointer;
+		uint32_t readahead_filled;
+		bool eof;
+
+	protected:
+		// Fills p_buffer with up to p_num_chars characters, returns how many were read (0 at the end).
+		virtual uint32_t _read_buffer(CharType *p_buffer, uint32_t p_num_chars) = 0;
+
+	public:
+		CharType saved;
+
+		_FORCE_INLINE_ CharType get_char() {
+
+			if (likely(readahead_pointer < readahead_filled))
+				return readahead_buffer[readahead_pointer++];
+
+			readahead_pointer = 0;
+			readahead_filled = eof ? 0 : _read_buffer(readahead_buffer, READAHEAD_SIZE);
+			if (readahead_filled == 0) {
+				eof = true;
+				return 0;
+			}
+
+			return readahead_buffer[readahead_pointer++];
+		}
+
 		virtual bool is_utf8() const = 0;
-		virtual bool is_eof() const = 0;
+		_FORCE_INLINE_ bool is_eof() const { return eof; }
 
-		CharType saved;
+		// Characters read ahead from the source but not yet returned by get_char().
+		uint32_t get_readahead_count() const { return readahead_filled - readahead_pointer; }
 
-		Stream() { saved = 0; }
+		Stream() {
+			readahead_pointer = 0;
+			readahead_filled = 0;
+			eof = false;
+			saved = 0;
+		}
 		virtual ~Stream() {}
 	};
 
 	struct StreamFile : public Stream {
 
+	protected:
+		virtual uint32_t _read_buffer(CharType *p_buffer, uint32_t p_num_chars);
+
+	public:
 		FileAccess *f;
 
-		virtual CharType get_char();
 		virtual bool is_utf8() const;
-		virtual bool is_eof() const;
+		// Position in f of the next character get_char() will return.
+		uint64_t get_position() const;
 
 		StreamFile() { f = NULL; }
 	};
 
 	struct StreamString : public Stream {
 
+	protected:
+		virtual uint32_t _read_buffer(CharType *p_buffer, uint32_t p_num_chars);
+
+	public:
 		String s;
 		int pos;
 
-		virtual CharType get_char();
 		virtual bool is_utf8() const;
-		virtual bool is_eof() const;
 
 		StreamString() { pos = 0; }
 	};
@@ -125,6 +169,9 @@ public:
 private:
 	static const char *tk_name[TK_MAX];
 
+	static bool _read_number(Stream *p_stream, CharType p_char, int64_t &r_int, double &r_real);
+	static CharType _skip_blanks(Stream *p_stream, int &line);
+
 	template <class T>
 	static Error _parse_construct(Stream *p_stream, Vector<T> &r_construct, int &line, String &r_err_str);
 	static Error _parse_enginecfg(Stream *p_stream, Vector<String> &strings, int &line, String &r_err_str);
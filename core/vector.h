@@ -35,6 +35,10 @@
  * @class Vector
  * @author Juan Linietsky
  * Vector container. Regular Vector Container. Use with care and for smaller arrays when possible. Use PoolVector for large arrays.
+ *
+ * Copy on write: every non-const access checks whether the data is shared. Loops
+ * writing many elements should take a Write handle (or ptrw()) once instead, and
+ * engine internals that never share their arrays can use LocalVector.
 */
 #include "error_macros.h"
 #include "os/memory.h"
@@ -96,7 +100,41 @@ class Vector {
 	void _copy_from(const Vector &p_from);
 	void _copy_on_write();
 
+protected:
+	// refcount of static data that is never freed, sharing it needs no atomics
+	enum {
+		STATIC_REFCOUNT = 0x7FFFFFFF
+	};
+
+	// shares data laid out as resize() allocates it (refcount, size, elements) with
+	// a STATIC_REFCOUNT refcount, writing to it makes a copy first
+	_FORCE_INLINE_ void _set_static(T *p_data) {
+		_unref(_ptr);
+		_ptr = p_data;
+	}
+
 public:
+	/**
+	 * Writes without the copy on write check of every access, which is done once
+	 * when the handle is taken. It's invalidated by resizing the vector, and the
+	 * vector must not be copied while it's used.
+	 */
+	class Write {
+
+		friend class Vector;
+		T *_ptr;
+
+		_FORCE_INLINE_ Write(T *p_ptr) { _ptr = p_ptr; }
+
+	public:
+		_FORCE_INLINE_ T &operator[](int p_index) const { return _ptr[p_index]; }
+		_FORCE_INLINE_ T *ptr() const { return _ptr; }
+
+		_FORCE_INLINE_ Write() { _ptr = NULL; }
+	};
+
+	_FORCE_INLINE_ Write write() { return Write(ptrw()); }
+
 	_FORCE_INLINE_ T *ptrw() {
 		if (!_ptr) return NULL;
 		_copy_on_write();
@@ -170,9 +208,11 @@ public:
 
 	void ordered_insert(const T &p_val) {
 		int i;
-		for (i = 0; i < size(); i++) {
+		int len = size();
+		const T *p = ptr();
+		for (i = 0; i < len; i++) {
 
-			if (p_val < operator[](i)) {
+			if (p_val < p[i]) {
 				break;
 			};
 		};
@@ -194,8 +234,12 @@ void Vector<T>::_unref(void *p_data) {
 
 	uint32_t *refc = _get_refcount();
 
-	if (atomic_decrement(refc) > 0)
-		return; // still in use
+	// nobody else can be referencing it when this is the only reference, so the atomic can be skipped
+	uint32_t rc = *refc;
+	if (rc != 1) {
+		if (rc == STATIC_REFCOUNT || atomic_decrement(refc) > 0)
+			return; // still in use, or static and never freed
+	}
 	// clean up
 
 	uint32_t *count = _get_size();
@@ -330,9 +374,11 @@ Error Vector<T>::resize(int p_size) {
 template <class T>
 void Vector<T>::invert() {
 
-	for (int i = 0; i < size() / 2; i++) {
+	int len = size();
+	T *p = ptrw();
+	for (int i = 0; i < len / 2; i++) {
 
-		SWAP(operator[](i), operator[](size() - i - 1));
+		SWAP(p[i], p[len - i - 1]);
 	}
 }
 
@@ -353,7 +399,7 @@ bool Vector<T>::push_back(const T &p_elem) {
 
 	Error err = resize(size() + 1);
 	ERR_FAIL_COND_V(err, true)
-	set(size() - 1, p_elem);
+	_get_data()[size() - 1] = p_elem; // resize() already made it unique
 
 	return false;
 }
@@ -384,6 +430,11 @@ void Vector<T>::_copy_from(const Vector &p_from) {
 	if (!p_from._ptr)
 		return; //nothing to do
 
+	if (*p_from._get_refcount() == STATIC_REFCOUNT) {
+		_ptr = p_from._ptr;
+		return;
+	}
+
 	if (atomic_conditional_increment(p_from._get_refcount()) > 0) { // could reference
 		_ptr = p_from._ptr;
 	}
@@ -400,9 +451,10 @@ Error Vector<T>::insert(int p_pos, const T &p_val) {
 
 	ERR_FAIL_INDEX_V(p_pos, size() + 1, ERR_INVALID_PARAMETER);
 	resize(size() + 1);
+	T *p = _get_data(); // resize() already made it unique
 	for (int i = (size() - 1); i > p_pos; i--)
-		set(i, get(i - 1));
-	set(p_pos, p_val);
+		p[i] = p[i - 1];
+	p[p_pos] = p_val;
 
 	return OK;
 }
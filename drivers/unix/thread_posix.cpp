@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "thread_posix.h"
+#include "frame_profiler.h"
 #include "script_language.h"
 
 #if defined(UNIX_ENABLED) || defined(PTHREAD_ENABLED)
@@ -70,6 +71,7 @@ void *ThreadPosix::thread_callback(void *userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	FrameProfiler::thread_exit();
 
 	return NULL;
 }
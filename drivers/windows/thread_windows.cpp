@@ -32,6 +32,7 @@
 
 #if defined(WINDOWS_ENABLED) && !defined(UWP_ENABLED)
 
+#include "frame_profiler.h"
 #include "os/memory.h"
 
 Thread::ID ThreadWindows::get_id() const {
@@ -54,6 +55,7 @@ DWORD ThreadWindows::thread_callback(LPVOID userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	FrameProfiler::thread_exit();
 
 	return 0;
 }
@@ -33,6 +33,7 @@
 #include "app_icon.gen.h"
 #include "core/register_core_types.h"
 #include "drivers/register_driver_types.h"
+#include "frame_profiler.h"
 #include "message_queue.h"
 #include "modules/register_module_types.h"
 #include "os/os.h"
@@ -62,6 +63,11 @@
 #include "scene/main/viewport.h"
 #include "scene/resources/packed_scene.h"
 
+#if defined(TOOLS_ENABLED) && !defined(_3D_DISABLED)
+#include "io/resource_saver.h"
+#include "scene/3d/baked_lightmap.h"
+#endif
+
 #ifdef TOOLS_ENABLED
 #include "editor/doc/doc_data.h"
 #include "editor/doc/doc_data_class_path.gen.h"
@@ -93,6 +99,7 @@ PhysicsServer *physics_server = NULL;
 Physics2DServer *physics_2d_server = NULL;
 
 static MessageQueue *message_queue = NULL;
+static FrameProfiler *frame_profiler = NULL;
 static Performance *performance = NULL;
 
 static PackedData *packed_data = NULL;
@@ -111,6 +118,7 @@ static bool init_use_custom_pos = false;
 #ifdef DEBUG_ENABLED
 static bool debug_collisions = false;
 static bool debug_navigation = false;
+static String profile_trace_path;
 #endif
 static int frame_delay = 0;
 static Vector2 init_custom_pos;
@@ -248,6 +256,7 @@ void Main::print_help(const char *p_binary) {
 #ifdef DEBUG_ENABLED
 	OS::get_singleton()->print("  --debug-collisions               Show collisions shapes when running the scene.\n");
 	OS::get_singleton()->print("  --debug-navigation               Show navigation polygons when running the scene.\n");
+	OS::get_singleton()->print("  --profile-trace <file>           Record engine profiler scopes and save them as a Chrome trace (JSON) on exit.\n");
 #endif
 	OS::get_singleton()->print("  --frame-delay <ms>               Simulate high CPU load (delay each frame by <ms> milliseconds).\n");
 	OS::get_singleton()->print("  --time-scale <scale>             Force time scale (higher values are faster, 1.0 is normal speed).\n");
@@ -259,6 +268,9 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("Standalone tools:\n");
 	OS::get_singleton()->print("  -s, --script <script>            Run a script.\n");
 #ifdef TOOLS_ENABLED
+#ifndef _3D_DISABLED
+	OS::get_singleton()->print("  --bake-lightmaps                 Bake the BakedLightmap nodes of the scene given as path without running its scripts, save the scene and quit.\n");
+#endif
 	OS::get_singleton()->print("  --export <target>                Export the project using the given export target.\n");
 	OS::get_singleton()->print("  --export-debug                   Use together with --export, enables debug mode for the template.\n");
 	OS::get_singleton()->print("  --doctool <path>                 Dump the engine API reference to the given <path> in XML format, merging if existing files are found.\n");
@@ -276,6 +288,9 @@ void Main::print_help(const char *p_binary) {
 		comma = ", ";
 	}
 	OS::get_singleton()->print(").\n");
+	OS::get_singleton()->print("  --bench-filter <text>            With '--test benchmark', only run benchmarks whose name contains <text>.\n");
+	OS::get_singleton()->print("  --bench-samples <n>              With '--test benchmark', number of timed samples per benchmark (default 20).\n");
+	OS::get_singleton()->print("  --bench-json <file>              With '--test benchmark', save the results as JSON.\n");
 #endif
 }
 
@@ -285,6 +300,7 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	OS::get_singleton()->initialize_core();
 
 	engine = memnew(Engine);
+	frame_profiler = memnew(FrameProfiler);
 
 	ClassDB::init();
 
@@ -629,6 +645,15 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 			debug_collisions = true;
 		} else if (I->get() == "--debug-navigation") {
 			debug_navigation = true;
+		} else if (I->get() == "--profile-trace") {
+			if (I->next()) {
+
+				profile_trace_path = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing profile trace file argument, aborting.\n");
+				goto error;
+			}
 #endif
 		} else if (I->get() == "--remote-debug") {
 			if (I->next()) {
@@ -1016,6 +1041,8 @@ error:
 
 	if (message_queue)
 		memdelete(message_queue);
+	if (frame_profiler)
+		memdelete(frame_profiler);
 	OS::get_singleton()->finalize_core();
 	locale = String();
 
@@ -1202,6 +1229,12 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	if (use_debug_profiler && script_debugger) {
 		script_debugger->profiling_start();
 	}
+
+#ifdef DEBUG_ENABLED
+	if (profile_trace_path != "") {
+		frame_profiler->start_capture();
+	}
+#endif
 	_start_success = true;
 	locale = String();
 
@@ -1216,6 +1249,106 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	return OK;
 }
 
+#if defined(TOOLS_ENABLED) && !defined(_3D_DISABLED)
+
+static int bake_lightmap_steps = 0;
+
+static void _bake_lightmap_begin(int p_steps) {
+
+	bake_lightmap_steps = p_steps;
+}
+
+static bool _bake_lightmap_step(int p_step, const String &p_description) {
+
+	print_line("[" + itos(p_step) + "/" + itos(bake_lightmap_steps) + "] " + p_description);
+	return false;
+}
+
+static void _bake_lightmap_end() {
+}
+
+static void _find_baked_lightmaps(Node *p_node, List<BakedLightmap *> *r_lightmaps) {
+
+	BakedLightmap *lightmap = Object::cast_to<BakedLightmap>(p_node);
+	if (lightmap) {
+		r_lightmaps->push_back(lightmap);
+	}
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		_find_baked_lightmaps(p_node->get_child(i), r_lightmaps);
+	}
+}
+
+// bakes every BakedLightmap of the scene as the editor would, with only tool scripts running and the
+// edit state kept, then saves the scene the way the editor saves it
+static bool _bake_scene_lightmaps(SceneTree *p_tree, const String &p_path) {
+
+	ScriptServer::set_scripting_enabled(false);
+
+	Node *scene = NULL;
+	Ref<PackedScene> scenedata = ResourceLoader::load(p_path);
+	if (scenedata.is_valid())
+		scene = scenedata->instance(PackedScene::GEN_EDIT_STATE_MAIN);
+
+	if (!scene) {
+		ERR_PRINTS("Failed loading scene: " + p_path);
+		return false;
+	}
+
+	List<BakedLightmap *> lightmaps;
+	_find_baked_lightmaps(scene, &lightmaps);
+
+	if (lightmaps.empty()) {
+		ERR_PRINTS("No BakedLightmap nodes found in scene: " + p_path);
+		memdelete(scene);
+		return false;
+	}
+
+	BakedLightmap::bake_begin_function = _bake_lightmap_begin;
+	BakedLightmap::bake_step_function = _bake_lightmap_step;
+	BakedLightmap::bake_end_function = _bake_lightmap_end;
+
+	// the bake reads global transforms, so the scene has to be inside the tree, but it is not made the current scene
+	p_tree->get_root()->add_child(scene);
+
+	bool ok = true;
+	for (List<BakedLightmap *>::Element *E = lightmaps.front(); E && ok; E = E->next()) {
+
+		BakedLightmap *lightmap = E->get();
+		String name = scene->get_path_to(lightmap);
+		print_line("Baking lightmaps: " + name);
+
+		uint64_t begin_time = OS::get_singleton()->get_ticks_msec();
+		BakedLightmap::BakeError err = lightmap->bake(lightmap == scene ? lightmap : lightmap->get_parent());
+		if (err != BakedLightmap::BAKE_ERROR_OK) {
+			ERR_PRINTS("Failed baking lightmaps: " + name + " (error " + itos(err) + ")");
+			ok = false;
+		} else {
+			print_line("Baked " + name + " in " + rtos((OS::get_singleton()->get_ticks_msec() - begin_time) / 1000.0) + " s");
+		}
+	}
+
+	p_tree->get_root()->remove_child(scene);
+
+	if (ok) {
+		Ref<PackedScene> packed;
+		packed.instance();
+		Error err = packed->pack(scene);
+		if (err == OK) {
+			err = ResourceSaver::save(p_path, packed);
+		}
+		if (err != OK) {
+			ERR_PRINTS("Failed saving baked scene: " + p_path);
+			ok = false;
+		}
+	}
+
+	memdelete(scene);
+	return ok;
+}
+
+#endif
+
 bool Main::start() {
 
 	ERR_FAIL_COND_V(!_start_success, false);
@@ -1229,6 +1362,7 @@ bool Main::start() {
 	String test;
 	String _export_preset;
 	bool export_debug = false;
+	bool bake_lightmaps = false;
 
 	List<String> args = OS::get_singleton()->get_cmdline_args();
 	for (int i = 0; i < args.size(); i++) {
@@ -1236,6 +1370,8 @@ bool Main::start() {
 		if (args[i] == "--no-docbase") {
 			doc_base = false;
 #ifdef TOOLS_ENABLED
+		} else if (args[i] == "--bake-lightmaps") {
+			bake_lightmaps = true;
 		} else if (args[i] == "-e" || args[i] == "--editor") {
 			editor = true;
 		} else if (args[i] == "-p" || args[i] == "--project-manager") {
@@ -1565,7 +1701,20 @@ bool Main::start() {
 #endif
 		}
 
-		if (!project_manager && !editor) { // game
+#if defined(TOOLS_ENABLED) && !defined(_3D_DISABLED)
+		if (bake_lightmaps && !project_manager && !editor) {
+
+			if (game_path == "") {
+				ERR_PRINT("No scene to bake lightmaps for.");
+				OS::get_singleton()->set_exit_code(1);
+			} else if (!_bake_scene_lightmaps(sml, local_game_path)) {
+				OS::get_singleton()->set_exit_code(1);
+			}
+			auto_quit = true;
+		}
+#endif
+
+		if (!project_manager && !editor && !bake_lightmaps) { // game
 			if (game_path != "" || script != "") {
 				//autoload
 				List<PropertyInfo> props;
@@ -1672,7 +1821,7 @@ bool Main::start() {
 		}
 
 #ifdef TOOLS_ENABLED
-		if (project_manager || (script == "" && test == "" && game_path == "" && !editor)) {
+		if (project_manager || (script == "" && test == "" && game_path == "" && !editor && !bake_lightmaps)) {
 
 			ProjectManager *pmanager = memnew(ProjectManager);
 			ProgressDialog *progress_dialog = memnew(ProgressDialog);
@@ -1809,6 +1958,9 @@ bool Main::iteration() {
 		ScriptServer::get_language(i)->frame();
 	}
 
+	frame_profiler->set_streaming(script_debugger && script_debugger->is_profiling());
+	frame_profiler->frame_end(ticks);
+
 	if (script_debugger) {
 		if (script_debugger->is_profiling()) {
 			script_debugger->profiling_set_frame_times(USEC_TO_SEC(frame_time), USEC_TO_SEC(idle_process_ticks), USEC_TO_SEC(physics_process_ticks), frame_slice);
@@ -1880,6 +2032,15 @@ void Main::cleanup() {
 	message_queue->flush();
 	memdelete(message_queue);
 
+#ifdef DEBUG_ENABLED
+	if (profile_trace_path != "") {
+		frame_profiler->stop_capture();
+		if (frame_profiler->save_capture(profile_trace_path) == OK) {
+			print_line("Profile trace saved to: " + profile_trace_path);
+		}
+	}
+#endif
+
 	if (script_debugger) {
 		if (use_debug_profiler) {
 			script_debugger->profiling_end();
@@ -1936,6 +2097,8 @@ void Main::cleanup() {
 		memdelete(globals);
 	if (engine)
 		memdelete(engine);
+	if (frame_profiler)
+		memdelete(frame_profiler);
 
 	unregister_core_driver_types();
 	unregister_core_types();
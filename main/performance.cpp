@@ -32,6 +32,7 @@
 #include "message_queue.h"
 #include "os/os.h"
 #include "scene/main/scene_tree.h"
+#include "servers/audio_server.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
 #include "servers/visual_server.h"
@@ -68,6 +69,8 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(AUDIO_REAL_VOICES);
+	BIND_ENUM_CONSTANT(AUDIO_VIRTUAL_VOICES);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -104,6 +107,8 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/active_objects",
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
+		"audio/real_voices",
+		"audio/virtual_voices",
 
 	};
 
@@ -147,6 +152,8 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_ACTIVE_OBJECTS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ACTIVE_OBJECTS);
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
+		case AUDIO_REAL_VOICES: return AudioServer::get_singleton()->get_real_voice_count();
+		case AUDIO_VIRTUAL_VOICES: return AudioServer::get_singleton()->get_virtual_voice_count();
 
 		default: {}
 	}
@@ -186,6 +193,8 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
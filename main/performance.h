@@ -77,6 +77,8 @@ public:
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
+		AUDIO_REAL_VOICES,
+		AUDIO_VIRTUAL_VOICES,
 		MONITOR_MAX
 	};
 
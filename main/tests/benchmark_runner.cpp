@@ -0,0 +1,251 @@
+/*************************************************************************/
+/*  benchmark_runner.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "benchmark_runner.h"
+
+#include "io/json.h"
+#include "math/math_funcs.h"
+#include "os/file_access.h"
+#include "os/os.h"
+#include "sort.h"
+#include "version.h"
+#include "version_hash.gen.h"
+
+void BenchmarkRunner::add_benchmark(Benchmark *p_benchmark) {
+
+	ERR_FAIL_NULL(p_benchmark);
+	benchmarks.push_back(p_benchmark);
+}
+
+void BenchmarkRunner::add_function(const String &p_name, Function p_function) {
+
+	FunctionBenchmark *fb = memnew(FunctionBenchmark);
+	fb->name = p_name;
+	fb->function = p_function;
+	add_benchmark(fb);
+}
+
+void BenchmarkRunner::parse_arguments(const List<String> &p_args) {
+
+	for (const List<String>::Element *E = p_args.front(); E; E = E->next()) {
+
+		if (E->get() == "--bench-list") {
+			list_only = true;
+		}
+
+		if (!E->next())
+			continue;
+
+		if (E->get() == "--bench-filter") {
+			filter = E->next()->get();
+		} else if (E->get() == "--bench-json") {
+			json_path = E->next()->get();
+		} else if (E->get() == "--bench-samples") {
+			samples = MAX(1, E->next()->get().to_int());
+		} else if (E->get() == "--bench-warmup") {
+			warmup_usec = MAX(0, E->next()->get().to_int()) * 1000;
+		}
+	}
+}
+
+double BenchmarkRunner::_percentile(const Vector<double> &p_sorted, double p_percent) {
+
+	// nearest rank
+	int rank = (int)Math::ceil(p_percent / 100.0 * p_sorted.size());
+	return p_sorted[CLAMP(rank - 1, 0, p_sorted.size() - 1)];
+}
+
+bool BenchmarkRunner::_run_benchmark(Benchmark *p_benchmark, Result &r_result) {
+
+	// every benchmark sees the same random sequence, so workloads are reproducible
+	Math::seed(0x5eed);
+
+	if (!p_benchmark->setup()) {
+		p_benchmark->teardown();
+		return false;
+	}
+
+	OS *os = OS::get_singleton();
+
+	// warmup, doubling the iteration count until a single run is long enough to time reliably
+	int iterations = 1;
+	uint64_t warmup_begin = os->get_ticks_usec();
+	while (true) {
+
+		uint64_t begin = os->get_ticks_usec();
+		p_benchmark->run(iterations);
+		uint64_t elapsed = os->get_ticks_usec() - begin;
+
+		if (elapsed < (uint64_t)min_sample_usec && iterations < (1 << 24)) {
+			iterations *= 2;
+		} else if (os->get_ticks_usec() - warmup_begin >= (uint64_t)warmup_usec) {
+			break;
+		}
+	}
+
+	Vector<double> times;
+	times.resize(samples);
+	for (int i = 0; i < samples; i++) {
+
+		uint64_t begin = os->get_ticks_usec();
+		p_benchmark->run(iterations);
+		times[i] = double(os->get_ticks_usec() - begin) / iterations;
+	}
+
+	p_benchmark->teardown();
+
+	times.sort();
+
+	double sum = 0;
+	for (int i = 0; i < times.size(); i++) {
+		sum += times[i];
+	}
+	double mean = sum / times.size();
+
+	double variance = 0;
+	for (int i = 0; i < times.size(); i++) {
+		variance += (times[i] - mean) * (times[i] - mean);
+	}
+
+	r_result.name = p_benchmark->get_name();
+	r_result.iterations = iterations;
+	r_result.samples = samples;
+	r_result.min = times[0];
+	r_result.p50 = _percentile(times, 50);
+	r_result.p90 = _percentile(times, 90);
+	r_result.p99 = _percentile(times, 99);
+	r_result.max = times[times.size() - 1];
+	r_result.mean = mean;
+	r_result.stddev = Math::sqrt(variance / times.size());
+
+	return true;
+}
+
+Error BenchmarkRunner::_save_json(const Vector<Result> &p_results) const {
+
+	Dictionary root;
+	root["engine"] = VERSION_FULL_NAME;
+	root["hash"] = VERSION_HASH;
+	root["os"] = OS::get_singleton()->get_name();
+	root["processor_count"] = OS::get_singleton()->get_processor_count();
+	root["samples"] = samples;
+	root["warmup_usec"] = warmup_usec;
+	root["min_sample_usec"] = min_sample_usec;
+
+	Array results;
+	for (int i = 0; i < p_results.size(); i++) {
+
+		const Result &r = p_results[i];
+		Dictionary d;
+		d["name"] = r.name;
+		d["iterations"] = r.iterations;
+		d["samples"] = r.samples;
+		d["min_usec"] = r.min;
+		d["p50_usec"] = r.p50;
+		d["p90_usec"] = r.p90;
+		d["p99_usec"] = r.p99;
+		d["max_usec"] = r.max;
+		d["mean_usec"] = r.mean;
+		d["stddev_usec"] = r.stddev;
+		results.push_back(d);
+	}
+	root["benchmarks"] = results;
+
+	Error err;
+	FileAccess *f = FileAccess::open(json_path, FileAccess::WRITE, &err);
+	ERR_EXPLAIN("Can't open file for writing: " + json_path);
+	ERR_FAIL_COND_V(!f, err);
+
+	f->store_string(JSON::print(root, "\t"));
+	f->close();
+	memdelete(f);
+
+	return OK;
+}
+
+int BenchmarkRunner::run() {
+
+	OS *os = OS::get_singleton();
+
+	if (list_only) {
+		for (int i = 0; i < benchmarks.size(); i++) {
+			os->print("%s\n", benchmarks[i]->get_name().utf8().get_data());
+		}
+		return 0;
+	}
+
+	os->print("%-44s %9s %12s %12s %12s %12s %12s\n", "benchmark (usec/iteration)", "iters", "min", "p50", "p90", "p99", "max");
+
+	Vector<Result> results;
+	int skipped = 0;
+
+	for (int i = 0; i < benchmarks.size(); i++) {
+
+		String name = benchmarks[i]->get_name();
+		if (filter != "" && name.find(filter) == -1)
+			continue;
+
+		Result r;
+		if (!_run_benchmark(benchmarks[i], r)) {
+			os->print("%-44s skipped\n", name.utf8().get_data());
+			skipped++;
+			continue;
+		}
+
+		os->print("%-44s %9d %12.3f %12.3f %12.3f %12.3f %12.3f\n", name.utf8().get_data(), r.iterations, r.min, r.p50, r.p90, r.p99, r.max);
+		results.push_back(r);
+	}
+
+	os->print("\n%d benchmarks run, %d skipped.\n", results.size(), skipped);
+
+	if (json_path != "") {
+		if (_save_json(results) != OK)
+			return 1;
+		os->print("Results saved to: %s\n", json_path.utf8().get_data());
+	}
+
+	return 0;
+}
+
+BenchmarkRunner::BenchmarkRunner() {
+
+	samples = 20;
+	warmup_usec = 100000;
+	min_sample_usec = 2000;
+	list_only = false;
+}
+
+BenchmarkRunner::~BenchmarkRunner() {
+
+	for (int i = 0; i < benchmarks.size(); i++) {
+		memdelete(benchmarks[i]);
+	}
+}
@@ -0,0 +1,114 @@
+/*************************************************************************/
+/*  benchmark_runner.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+#include "list.h"
+#include "ustring.h"
+#include "variant.h"
+#include "vector.h"
+
+/**
+ * A benchmark times run(), which must perform the requested number of
+ * iterations of its workload and leave the state as it found it, since it
+ * is called repeatedly for warmup and for every sample. setup() and
+ * teardown() are called once around all of that and are not timed.
+ */
+class Benchmark {
+public:
+	virtual String get_name() const = 0;
+
+	virtual bool setup() { return true; } // return false to skip the benchmark
+	virtual void run(int p_iterations) = 0;
+	virtual void teardown() {}
+
+	virtual ~Benchmark() {}
+};
+
+class BenchmarkRunner {
+public:
+	typedef void (*Function)(int p_iterations);
+
+	struct Result {
+		String name;
+		int iterations; // per sample
+		int samples;
+		// all times are per iteration, in microseconds
+		double min;
+		double p50;
+		double p90;
+		double p99;
+		double max;
+		double mean;
+		double stddev;
+	};
+
+private:
+	class FunctionBenchmark : public Benchmark {
+	public:
+		String name;
+		Function function;
+
+		virtual String get_name() const { return name; }
+		virtual void run(int p_iterations) { function(p_iterations); }
+	};
+
+	Vector<Benchmark *> benchmarks;
+
+	String filter;
+	String json_path;
+	int samples;
+	int warmup_usec;
+	int min_sample_usec;
+	bool list_only;
+
+	static double _percentile(const Vector<double> &p_sorted, double p_percent);
+	bool _run_benchmark(Benchmark *p_benchmark, Result &r_result);
+	Error _save_json(const Vector<Result> &p_results) const;
+
+public:
+	void add_benchmark(Benchmark *p_benchmark); // takes ownership
+	void add_function(const String &p_name, Function p_function);
+
+	void parse_arguments(const List<String> &p_args);
+
+	void set_filter(const String &p_filter) { filter = p_filter; }
+	void set_json_path(const String &p_path) { json_path = p_path; }
+	void set_samples(int p_samples) { samples = p_samples; }
+
+	int run();
+
+	BenchmarkRunner();
+	~BenchmarkRunner();
+};
+
+#endif // BENCHMARK_RUNNER_H
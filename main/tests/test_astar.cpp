@@ -0,0 +1,333 @@
+/*************************************************************************/
+/*  test_astar.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_astar.h"
+
+#include "core/local_vector.h"
+#include "core/math/a_star.h"
+#include "core/math/geometry.h"
+#include "core/os/os.h"
+
+namespace TestAStar {
+
+static Ref<AStar> _make_random_graph(int p_count, int p_connections, bool p_flat) {
+
+	Ref<AStar> a;
+	a.instance();
+
+	for (int i = 0; i < p_count; i++) {
+		Vector3 pos(Math::randf() * 100, p_flat ? 0 : Math::randf() * 100, Math::randf() * 100);
+		a->add_point(i, pos, 1 + Math::randf() * 3);
+	}
+
+	for (int i = 0; i < p_connections; i++) {
+		int from = Math::rand() % p_count;
+		int to = Math::rand() % p_count;
+		if (from != to)
+			a->connect_points(from, to, Math::rand() % 4 != 0);
+	}
+
+	return a;
+}
+
+static real_t _path_cost(Ref<AStar> p_astar, const PoolVector<int> &p_path) {
+
+	real_t cost = 0;
+	for (int i = 1; i < p_path.size(); i++) {
+		Vector3 from = p_astar->get_point_position(p_path[i - 1]);
+		Vector3 to = p_astar->get_point_position(p_path[i]);
+		cost += from.distance_to(to) * p_astar->get_point_weight_scale(p_path[i]);
+	}
+	return cost;
+}
+
+// plain Dijkstra over the public API, returns -1 when there is no route
+static real_t _shortest_cost(Ref<AStar> p_astar, int p_from, int p_to, int p_count) {
+
+	LocalVector<real_t> cost;
+	LocalVector<bool> done;
+	cost.resize(p_count);
+	done.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		cost[i] = -1;
+		done[i] = false;
+	}
+	cost[p_from] = 0;
+
+	while (true) {
+		int best = -1;
+		for (int i = 0; i < p_count; i++) {
+			if (!done[i] && cost[i] >= 0 && (best < 0 || cost[i] < cost[best]))
+				best = i;
+		}
+		if (best < 0)
+			return -1;
+		if (best == p_to)
+			return cost[best];
+		done[best] = true;
+
+		PoolVector<int> c = p_astar->get_point_connections(best);
+		for (int i = 0; i < c.size(); i++) {
+			int n = c[i];
+			real_t d = cost[best] + p_astar->get_point_position(best).distance_to(p_astar->get_point_position(n)) * p_astar->get_point_weight_scale(n);
+			if (cost[n] < 0 || d < cost[n])
+				cost[n] = d;
+		}
+	}
+}
+
+bool test_shortest_path() {
+
+	const int count = 300;
+	Ref<AStar> a = _make_random_graph(count, 900, false);
+
+	for (int i = 0; i < 100; i++) {
+		int from = Math::rand() % count;
+		int to = Math::rand() % count;
+
+		PoolVector<int> path = a->get_id_path(from, to);
+		real_t expected = _shortest_cost(a, from, to, count);
+
+		if (expected < 0) {
+			if (path.size() != 0)
+				return false;
+			continue;
+		}
+
+		if (path.size() == 0 || path[0] != from || path[path.size() - 1] != to)
+			return false;
+		for (int j = 1; j < path.size(); j++) {
+			PoolVector<int> c = a->get_point_connections(path[j - 1]);
+			bool linked = false;
+			for (int k = 0; k < c.size(); k++) {
+				linked = linked || c[k] == path[j];
+			}
+			if (!linked)
+				return false;
+		}
+		if (Math::abs(_path_cost(a, path) - expected) > 0.01)
+			return false;
+	}
+
+	return true;
+}
+
+bool test_closest_point() {
+
+	for (int flat = 0; flat < 2; flat++) {
+
+		Ref<AStar> a = _make_random_graph(2000, 3000, flat);
+
+		for (int i = 0; i < 200; i++) {
+			// also ask from outside the graph bounds
+			Vector3 p(Math::randf() * 160 - 30, Math::randf() * 160 - 30, Math::randf() * 160 - 30);
+
+			int closest = -1;
+			real_t closest_dist = 1e20;
+			for (int j = 0; j < 2000; j++) {
+				real_t d = p.distance_squared_to(a->get_point_position(j));
+				if (closest < 0 || d < closest_dist) {
+					closest_dist = d;
+					closest = j;
+				}
+			}
+
+			if (a->get_closest_point(p) != closest)
+				return false;
+		}
+	}
+
+	Ref<AStar> empty;
+	empty.instance();
+	return empty->get_closest_point(Vector3()) == -1;
+}
+
+bool test_closest_segment() {
+
+	const int count = 500;
+	Ref<AStar> a = _make_random_graph(count, 700, false);
+
+	for (int i = 0; i < 200; i++) {
+		Vector3 p(Math::randf() * 160 - 30, Math::randf() * 160 - 30, Math::randf() * 160 - 30);
+
+		real_t closest_dist = 1e20;
+		for (int j = 0; j < count; j++) {
+			PoolVector<int> c = a->get_point_connections(j);
+			for (int k = 0; k < c.size(); k++) {
+				Vector3 segment[2] = { a->get_point_position(j), a->get_point_position(c[k]) };
+				closest_dist = MIN(closest_dist, p.distance_to(Geometry::get_closest_point_to_segment(p, segment)));
+			}
+		}
+
+		if (Math::abs(p.distance_to(a->get_closest_position_in_segment(p)) - closest_dist) > 0.001)
+			return false;
+	}
+
+	return true;
+}
+
+bool test_connections() {
+
+	Ref<AStar> a;
+	a.instance();
+	a->add_point(1, Vector3(0, 0, 0));
+	a->add_point(2, Vector3(1, 0, 0));
+	a->add_point(3, Vector3(2, 0, 0));
+
+	a->connect_points(1, 2, false);
+	a->connect_points(2, 3);
+
+	bool ok = a->are_points_connected(1, 2) && a->are_points_connected(2, 1);
+	ok = ok && a->get_id_path(1, 3).size() == 3;
+	ok = ok && a->get_id_path(3, 1).size() == 0;
+
+	// a one way connection in the other direction makes it two way
+	a->connect_points(2, 1, false);
+	ok = ok && a->get_id_path(3, 1).size() == 3;
+
+	a->disconnect_points(2, 1);
+	ok = ok && !a->are_points_connected(1, 2) && a->get_id_path(1, 3).size() == 0;
+
+	// removing the target of a one way connection must not leave it behind
+	a->connect_points(1, 2, false);
+	a->remove_point(2);
+	ok = ok && a->get_point_connections(1).size() == 0 && !a->are_points_connected(1, 2);
+	a->add_point(2, Vector3(1, 0, 0));
+	ok = ok && a->get_id_path(1, 2).size() == 0;
+
+	return ok;
+}
+
+bool test_ids() {
+
+	Ref<AStar> a;
+	a.instance();
+
+	bool ok = a->get_available_point_id() == 1;
+
+	// dense and sparse ids
+	a->add_point(5, Vector3(5, 0, 0));
+	a->add_point(1000000, Vector3(6, 0, 0));
+	a->add_point(3, Vector3(3, 0, 0));
+	a->add_point(2000000000, Vector3(7, 0, 0));
+	a->connect_points(3, 5);
+	a->connect_points(5, 1000000);
+	a->connect_points(1000000, 2000000000);
+
+	ok = ok && a->has_point(1000000) && !a->has_point(4) && !a->has_point(-1);
+	ok = ok && a->get_point_position(2000000000) == Vector3(7, 0, 0);
+	ok = ok && a->get_available_point_id() == 2000000001;
+	ok = ok && a->get_id_path(3, 2000000000).size() == 4;
+
+	Array points = a->get_points();
+	ok = ok && points.size() == 4 && int(points[0]) == 3 && int(points[1]) == 5 && int(points[2]) == 1000000 && int(points[3]) == 2000000000;
+
+	a->remove_point(2000000000);
+	ok = ok && a->get_available_point_id() == 1000001;
+	a->remove_point(3);
+	ok = ok && a->get_id_path(5, 1000000).size() == 2 && a->get_closest_point(Vector3(0, 0, 0)) == 5;
+
+	a->clear();
+	ok = ok && a->get_points().size() == 0 && a->get_available_point_id() == 1;
+
+	return ok;
+}
+
+bool test_batch() {
+
+	const int count = 1000;
+	Ref<AStar> a = _make_random_graph(count, 3000, true);
+
+	PoolVector<int> from;
+	PoolVector<int> to;
+	for (int i = 0; i < 64; i++) {
+		from.push_back(Math::rand() % count);
+		to.push_back(Math::rand() % count);
+	}
+	// unknown points give empty paths
+	from.push_back(count + 10);
+	to.push_back(0);
+
+	Array paths = a->get_id_paths(from, to);
+	if (paths.size() != from.size())
+		return false;
+
+	for (int i = 0; i < from.size() - 1; i++) {
+		PoolVector<int> path = paths[i];
+		PoolVector<int> expected = a->get_id_path(from[i], to[i]);
+		if (path.size() != expected.size() || Math::abs(_path_cost(a, path) - _path_cost(a, expected)) > 0.01)
+			return false;
+	}
+
+	PoolVector<int> unknown = paths[from.size() - 1];
+	return unknown.size() == 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_shortest_path,
+	test_closest_point,
+	test_closest_segment,
+	test_connections,
+	test_ids,
+	test_batch,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestAStar
@@ -0,0 +1,738 @@
+/*************************************************************************/
+/*  test_audio_stream.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_audio_stream.h"
+
+#include "core/class_db.h"
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "servers/audio/audio_stream_streamer.h"
+#include "servers/audio/effects/audio_effect_compressor.h"
+#include "servers/audio_server.h"
+
+#include <math.h>
+
+namespace TestAudioStream {
+
+enum {
+	MIX_RATE = 44100,
+	BLOCK_LEN = 512,
+	RAMP_LEN = 1000
+};
+
+// frame N of the stream holds 1 + N % RAMP_LEN, so silence and gaps are easy to spot
+static _FORCE_INLINE_ float _ramp(uint64_t p_frame) {
+
+	return 1 + p_frame % RAMP_LEN;
+}
+
+class AudioStreamPlaybackRamp : public AudioStreamPlaybackStreamed {
+
+	uint64_t position;
+	uint64_t length;
+	uint64_t loop_begin;
+	bool loop;
+	int decode_cost;
+	float decode_result;
+
+protected:
+	virtual float get_stream_sampling_rate() { return MIX_RATE; }
+
+	virtual void _stream_seek(uint64_t p_frame) {
+		position = p_frame;
+	}
+
+	virtual int _stream_decode(AudioFrame *p_buffer, int p_frames) {
+
+		if (checking && Thread::get_caller_id() != AudioStreamStreamer::get_singleton()->get_thread_id()) {
+			atomic_increment(&foreign_decodes);
+		}
+
+		int todo = MIN(uint64_t(p_frames), length - position);
+		for (int i = 0; i < todo; i++) {
+			float v = _ramp(position + i);
+			//pretend decoding is expensive
+			float work = 0;
+			for (int j = 0; j < decode_cost; j++) {
+				work += sinf(v + j);
+			}
+			decode_result += work;
+			p_buffer[i] = AudioFrame(v, v);
+		}
+		position += todo;
+		return todo;
+	}
+
+	virtual uint64_t _stream_get_length() const { return length; }
+	virtual bool _stream_has_loop() const { return loop; }
+	virtual uint64_t _stream_get_loop_begin() const { return loop_begin; }
+
+public:
+	volatile bool checking;
+	uint32_t foreign_decodes;
+
+	void read(AudioFrame *p_buffer, int p_frames) {
+		_mix_internal(p_buffer, p_frames);
+	}
+
+	AudioStreamPlaybackRamp(uint64_t p_length, bool p_loop = false, uint64_t p_loop_begin = 0, int p_decode_cost = 0) {
+
+		position = 0;
+		length = p_length;
+		loop = p_loop;
+		loop_begin = p_loop_begin;
+		decode_cost = p_decode_cost;
+		decode_result = 0;
+		checking = false;
+		foreign_decodes = 0;
+
+		_stream_init();
+		checking = true;
+	}
+
+	~AudioStreamPlaybackRamp() {
+		_stream_finish();
+	}
+};
+
+// let the streamer catch up after every block, instead of depending on how fast it is
+static void _wait_streamer() {
+
+	AudioStreamStreamer::get_singleton()->flush();
+}
+
+static bool _check_ramp(const AudioFrame *p_buffer, int p_frames, uint64_t p_from) {
+
+	for (int i = 0; i < p_frames; i++) {
+		if (p_buffer[i].l != _ramp(p_from + i))
+			return false;
+	}
+	return true;
+}
+
+bool test_no_mixing_thread_decode() {
+
+	const int stream_count = 64;
+	const int block_count = 2 * MIX_RATE / BLOCK_LEN;
+
+	Ref<AudioStreamPlaybackRamp> playbacks[stream_count];
+	uint64_t positions[stream_count];
+	for (int i = 0; i < stream_count; i++) {
+		playbacks[i] = Ref<AudioStreamPlaybackRamp>(memnew(AudioStreamPlaybackRamp(MIX_RATE * 10, false, 0, 4)));
+		playbacks[i]->start();
+		positions[i] = 0;
+	}
+
+	bool ok = AudioStreamStreamer::get_singleton()->is_threaded();
+	AudioFrame buffer[BLOCK_LEN];
+
+	for (int b = 0; b < block_count && ok; b++) {
+		for (int i = 0; i < stream_count; i++) {
+			playbacks[i]->read(buffer, BLOCK_LEN);
+			ok = ok && _check_ramp(buffer, BLOCK_LEN, positions[i]);
+			positions[i] += BLOCK_LEN;
+		}
+		_wait_streamer();
+	}
+
+	uint32_t underruns = 0;
+	uint32_t foreign_decodes = 0;
+	for (int i = 0; i < stream_count; i++) {
+		underruns += playbacks[i]->get_underrun_count();
+		foreign_decodes += playbacks[i]->foreign_decodes;
+	}
+
+	OS::get_singleton()->print("\t%d streams: %d underruns, %d decodes outside the streamer\n", stream_count, underruns, foreign_decodes);
+
+	return ok && underruns == 0 && foreign_decodes == 0;
+}
+
+bool test_seek() {
+
+	Ref<AudioStreamPlaybackRamp> playback = Ref<AudioStreamPlaybackRamp>(memnew(AudioStreamPlaybackRamp(MIX_RATE * 10)));
+	AudioFrame buffer[BLOCK_LEN];
+
+	// times that convert to frames exactly
+	float times[] = { 0.25, 6.5, 0.75, 0, 9.5 };
+	for (int t = 0; t < 5; t++) {
+
+		playback->start(times[t]);
+
+		// the streamer decodes from the new position before the next read
+		_wait_streamer();
+		playback->read(buffer, BLOCK_LEN);
+
+		if (!_check_ramp(buffer, BLOCK_LEN, uint64_t(times[t] * MIX_RATE)))
+			return false;
+	}
+
+	return playback->foreign_decodes == 0;
+}
+
+bool test_loop() {
+
+	Ref<AudioStreamPlaybackRamp> playback = Ref<AudioStreamPlaybackRamp>(memnew(AudioStreamPlaybackRamp(10000, true, 2000)));
+	playback->start();
+
+	AudioFrame buffer[BLOCK_LEN];
+	uint64_t position = 0;
+
+	for (int b = 0; b < 30000 / BLOCK_LEN; b++) {
+
+		playback->read(buffer, BLOCK_LEN);
+		for (int i = 0; i < BLOCK_LEN; i++) {
+			if (buffer[i].l != _ramp(position))
+				return false;
+			position = position + 1 < 10000 ? position + 1 : 2000;
+		}
+		_wait_streamer();
+	}
+
+	return playback->get_loop_count() == 3 && playback->get_underrun_count() == 0;
+}
+
+bool test_end() {
+
+	Ref<AudioStreamPlaybackRamp> playback = Ref<AudioStreamPlaybackRamp>(memnew(AudioStreamPlaybackRamp(5000)));
+	playback->start();
+
+	AudioFrame buffer[BLOCK_LEN];
+	int frames = 0;
+	int blocks = 0;
+
+	while (playback->is_playing() && blocks++ < 100) {
+
+		playback->read(buffer, BLOCK_LEN);
+		for (int i = 0; i < BLOCK_LEN; i++) {
+			frames += buffer[i].l != 0;
+		}
+		_wait_streamer();
+	}
+
+	return frames == 5000 && playback->get_underrun_count() == 0;
+}
+
+static Ref<AudioStreamSample> _make_sample(AudioStreamSample::LoopMode p_loop_mode) {
+
+	const int frames = 3000;
+	PoolVector<uint8_t> data;
+	data.resize(frames * 2);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		for (int i = 0; i < frames; i++) {
+			int16_t v = (i * 37) % 20000 - 10000;
+			w[i * 2 + 0] = v & 0xFF;
+			w[i * 2 + 1] = (v >> 8) & 0xFF;
+		}
+	}
+
+	Ref<AudioStreamSample> sample;
+	sample.instance();
+	sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+	sample->set_mix_rate(AudioServer::get_singleton()->get_mix_rate());
+	sample->set_loop_mode(p_loop_mode);
+	sample->set_loop_begin(500);
+	sample->set_loop_end(2200);
+	sample->set_data(data);
+	return sample;
+}
+
+// a virtual voice is skipped instead of mixed, it must come back where a real one would be
+bool test_sample_skip() {
+
+	AudioStreamSample::LoopMode modes[] = { AudioStreamSample::LOOP_DISABLED, AudioStreamSample::LOOP_FORWARD, AudioStreamSample::LOOP_PING_PONG };
+	float rate_scales[] = { 1.0, 1.37, 0.61 };
+	int skip_lengths[] = { 1, 100, 777, 2500 };
+
+	AudioFrame mixed[BLOCK_LEN];
+	AudioFrame skipped[BLOCK_LEN];
+
+	for (int m = 0; m < 3; m++) {
+		Ref<AudioStreamSample> sample = _make_sample(modes[m]);
+
+		for (int r = 0; r < 3; r++) {
+			for (int l = 0; l < 4; l++) {
+
+				Ref<AudioStreamPlayback> real = sample->instance_playback();
+				Ref<AudioStreamPlayback> virt = sample->instance_playback();
+				real->start();
+				virt->start();
+
+				// several rounds, so ping pong voices get skipped while going backwards too
+				for (int round = 0; round < 6; round++) {
+
+					for (int done = 0; done < skip_lengths[l]; done += BLOCK_LEN) {
+						int todo = MIN(BLOCK_LEN, skip_lengths[l] - done);
+						real->mix(mixed, rate_scales[r], todo);
+						virt->skip(rate_scales[r], todo);
+					}
+
+					if (real->is_playing() != virt->is_playing())
+						return false;
+					if (!real->is_playing())
+						break;
+
+					real->mix(mixed, rate_scales[r], BLOCK_LEN);
+					virt->mix(skipped, rate_scales[r], BLOCK_LEN);
+					for (int i = 0; i < BLOCK_LEN; i++) {
+						if (mixed[i].l != skipped[i].l || mixed[i].r != skipped[i].r)
+							return false;
+					}
+				}
+
+				if (modes[m] != AudioStreamSample::LOOP_DISABLED && !virt->is_playing())
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// mixes from the test instead of the audio thread, which waits on the server lock meanwhile
+class AudioDriverManual : public AudioDriver {
+
+public:
+	virtual const char *get_name() const { return "Manual"; }
+	virtual Error init() { return OK; }
+	virtual void start() {}
+	virtual int get_mix_rate() const { return AudioDriver::get_singleton()->get_mix_rate(); }
+	virtual SpeakerMode get_speaker_mode() const { return AudioDriver::get_singleton()->get_speaker_mode(); }
+	virtual void lock() {}
+	virtual void unlock() {}
+	virtual void finish() {}
+
+	void mix(int32_t *p_buffer, int p_frames) {
+		audio_server_process(p_frames, p_buffer, false);
+	}
+};
+
+static uint64_t sidechain_frame = 0;
+
+static void _sidechain_feed(void *p_userdata) {
+
+	AudioServer *as = AudioServer::get_singleton();
+	int frames = as->thread_get_mix_buffer_size();
+	AudioFrame *read = as->thread_get_channel_mix_buffer(1, 0);
+	AudioFrame *reader = as->thread_get_channel_mix_buffer(2, 0);
+	AudioFrame *sender = as->thread_get_channel_mix_buffer(3, 0);
+
+	for (int i = 0; i < frames; i++) {
+
+		float t = float(sidechain_frame + i) / as->get_mix_rate();
+		read[i] += AudioFrame(0.01, 0.01) * sinf(t * 300);
+		reader[i] += AudioFrame(0.5, 0.5) * sinf(t * 440);
+		// bursts, so the compressor keeps attacking and releasing
+		float burst = (sidechain_frame + i) % 8000 < 2000 ? 0.9 : 0.0;
+		sender[i] += AudioFrame(burst, burst) * sinf(t * 97);
+	}
+	sidechain_frame += frames;
+}
+
+static void _mix_sidechain_layout(int p_effect_threads, Vector<int32_t> &r_output) {
+
+	AudioServer *as = AudioServer::get_singleton();
+
+	// Master, R, P reading R in its compressor sidechain, S sending to R
+	as->set_bus_count(1);
+	as->set_bus_count(4);
+	as->set_bus_name(1, "R");
+	as->set_bus_name(2, "P");
+	as->set_bus_name(3, "S");
+	as->set_bus_send(1, "Master");
+	as->set_bus_send(2, "Master");
+	as->set_bus_send(3, "R");
+
+	Ref<AudioEffectCompressor> compressor;
+	compressor.instance();
+	compressor->set_threshold(-30);
+	compressor->set_sidechain("R");
+	as->add_bus_effect(2, compressor);
+
+	as->set_bus_effect_thread_count(p_effect_threads);
+
+	AudioDriverManual driver;
+	int frames = as->thread_get_mix_buffer_size();
+	int channels = as->get_channel_count() * 2;
+	int blocks = 40;
+
+	sidechain_frame = 0;
+	r_output.resize(blocks * frames * channels);
+
+	as->add_callback(_sidechain_feed, NULL);
+	as->lock();
+	for (int i = 0; i < blocks; i++) {
+		driver.mix(r_output.ptrw() + i * frames * channels, frames);
+	}
+	as->unlock();
+	as->remove_callback(_sidechain_feed, NULL);
+}
+
+// the compressor must hear the same sidechain as with serial mixing, including the sends into the bus it reads
+bool test_sidechain_schedule() {
+
+	AudioServer *as = AudioServer::get_singleton();
+	Ref<AudioBusLayout> layout = as->generate_bus_layout();
+	int effect_threads = as->get_bus_effect_thread_count();
+
+	Vector<int32_t> serial;
+	Vector<int32_t> parallel;
+	_mix_sidechain_layout(0, serial);
+	_mix_sidechain_layout(2, parallel);
+
+	as->set_bus_effect_thread_count(effect_threads);
+	as->set_bus_layout(layout);
+
+	// the first block can still hold what was mixed before the layout changed
+	int skip = as->thread_get_mix_buffer_size() * as->get_channel_count() * 2;
+	for (int i = skip; i < serial.size(); i++) {
+		if (serial[i] != parallel[i])
+			return false;
+	}
+
+	return serial.size() > skip;
+}
+
+// packs fields the way vorbis headers and packets do, starting from the lowest bit
+class VorbisBitWriter {
+
+	Vector<uint8_t> data;
+	int bits;
+
+public:
+	void write(uint32_t p_value, int p_bits) {
+
+		for (int i = 0; i < p_bits; i++) {
+			if ((bits & 7) == 0)
+				data.push_back(0);
+			if ((p_value >> i) & 1)
+				data[bits >> 3] |= 1 << (bits & 7);
+			bits++;
+		}
+	}
+
+	void write_header(int p_type) {
+
+		write(p_type, 8);
+		const char *magic = "vorbis";
+		for (int i = 0; i < 6; i++) {
+			write(magic[i], 8);
+		}
+	}
+
+	const Vector<uint8_t> &get_data() const { return data; }
+
+	VorbisBitWriter() { bits = 0; }
+};
+
+static uint32_t _ogg_crc(const uint8_t *p_data, int p_len) {
+
+	uint32_t crc = 0;
+	for (int i = 0; i < p_len; i++) {
+		crc ^= uint32_t(p_data[i]) << 24;
+		for (int j = 0; j < 8; j++) {
+			crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+//all packets written are shorter than a lacing segment
+static void _ogg_page(Vector<uint8_t> &r_stream, const Vector<Vector<uint8_t> > &p_packets, uint8_t p_flags, uint64_t p_granule, uint32_t p_sequence) {
+
+	int segments = p_packets.size();
+	int len = 27 + segments;
+	for (int i = 0; i < segments; i++) {
+		len += p_packets[i].size();
+	}
+
+	int begin = r_stream.size();
+	r_stream.resize(begin + len);
+	uint8_t *page = r_stream.ptrw() + begin;
+
+	page[0] = 'O';
+	page[1] = 'g';
+	page[2] = 'g';
+	page[3] = 'S';
+	page[4] = 0;
+	page[5] = p_flags;
+	encode_uint64(p_granule, &page[6]);
+	encode_uint32(1, &page[14]);
+	encode_uint32(p_sequence, &page[18]);
+	encode_uint32(0, &page[22]);
+	page[26] = segments;
+
+	uint8_t *body = &page[27 + segments];
+	for (int i = 0; i < segments; i++) {
+		page[27 + i] = p_packets[i].size();
+		copymem(body, p_packets[i].ptr(), p_packets[i].size());
+		body += p_packets[i].size();
+	}
+
+	encode_uint32(_ogg_crc(page, len), &page[22]);
+}
+
+// the smallest setup a decoder accepts: mono, 256 frame blocks, a flat floor and a residue of
+// one bit codes for -1 and 1, so each audio packet after the first decodes to 128 frames of noise
+static PoolVector<uint8_t> _make_vorbis_stream(int p_packets) {
+
+	Vector<uint8_t> stream;
+	Vector<Vector<uint8_t> > packets;
+
+	VorbisBitWriter id;
+	id.write_header(1);
+	id.write(0, 32); //version
+	id.write(1, 8); //channels
+	id.write(MIX_RATE, 32);
+	id.write(0, 32); //bitrates
+	id.write(0, 32);
+	id.write(0, 32);
+	id.write(8, 4); //block sizes, as powers of two
+	id.write(8, 4);
+	id.write(1, 8); //framing
+	packets.push_back(id.get_data());
+	_ogg_page(stream, packets, 0x02, 0, 0);
+	packets.clear();
+
+	VorbisBitWriter comment;
+	comment.write_header(3);
+	comment.write(0, 32); //vendor
+	comment.write(0, 32); //comments
+	comment.write(1, 8); //framing
+	packets.push_back(comment.get_data());
+
+	VorbisBitWriter setup;
+	setup.write_header(5);
+
+	setup.write(0, 8); //one codebook
+	setup.write(0x564342, 24);
+	setup.write(1, 16); //dimensions
+	setup.write(2, 24); //entries
+	setup.write(0, 1); //not ordered
+	setup.write(0, 1); //not sparse
+	setup.write(0, 5); //one bit each
+	setup.write(0, 5);
+	setup.write(1, 4); //lookup type
+	setup.write(0x80000000 | (788 << 21) | 1, 32); //minimum -1
+	setup.write((789 << 21) | 1, 32); //delta 2
+	setup.write(0, 4); //one bit multiplicands
+	setup.write(0, 1);
+	setup.write(0, 1);
+	setup.write(1, 1);
+
+	setup.write(0, 6); //time domain transforms, unused
+	setup.write(0, 16);
+
+	setup.write(0, 6); //one floor 1, without partitions
+	setup.write(1, 16);
+	setup.write(0, 5);
+	setup.write(0, 2); //multiplier
+	setup.write(7, 4); //range bits
+
+	setup.write(0, 6); //one residue 1, over the whole block
+	setup.write(1, 16);
+	setup.write(0, 24); //begin
+	setup.write(128, 24); //end
+	setup.write(31, 24); //partition size
+	setup.write(0, 6); //classifications
+	setup.write(0, 8); //class book
+	setup.write(1, 3); //cascade
+	setup.write(0, 1);
+	setup.write(0, 8); //book
+
+	setup.write(0, 6); //one mapping
+	setup.write(0, 16);
+	setup.write(0, 1); //submaps
+	setup.write(0, 1); //coupling
+	setup.write(0, 2);
+	setup.write(0, 8);
+	setup.write(0, 8); //floor
+	setup.write(0, 8); //residue
+
+	setup.write(0, 6); //one mode
+	setup.write(0, 1); //short blocks
+	setup.write(0, 16);
+	setup.write(0, 16);
+	setup.write(0, 8); //mapping
+
+	setup.write(1, 1); //framing
+	packets.push_back(setup.get_data());
+	_ogg_page(stream, packets, 0, 0, 1);
+	packets.clear();
+
+	uint32_t seed = 1;
+	uint32_t sequence = 2;
+
+	for (int i = 0; i < p_packets; i++) {
+
+		VorbisBitWriter audio;
+		audio.write(0, 1); //audio, the only mode takes no bits
+		audio.write(1, 1); //floor used
+		audio.write(180 + i % 60, 8);
+		audio.write(240 - i % 60, 8);
+		for (int j = 0; j < 4; j++) {
+			audio.write(0, 1); //class
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			audio.write(seed, 32);
+		}
+		packets.push_back(audio.get_data());
+
+		//a page ends with a packet, its granule is the frames decoded up to that one
+		bool last = i == p_packets - 1;
+		if (packets.size() == 50 || last) {
+			_ogg_page(stream, packets, last ? 0x04 : 0, uint64_t(i) * 128, sequence++);
+			packets.clear();
+		}
+	}
+
+	PoolVector<uint8_t> data;
+	data.resize(stream.size());
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		copymem(w.ptr(), stream.ptr(), stream.size());
+	}
+	return data;
+}
+
+// a streamed ogg seeks by bisecting the file for a page, it must decode the same frames as playing from the start
+bool test_ogg_seek() {
+
+	if (!ClassDB::class_exists("AudioStreamOGGVorbis")) {
+		OS::get_singleton()->print("\togg vorbis is not available, skipped\n");
+		return true;
+	}
+
+	Ref<AudioStream> stream = Object::cast_to<AudioStream>(ClassDB::instance("AudioStreamOGGVorbis"));
+	if (stream.is_null())
+		return false;
+
+	//about 70 kilobytes in pages of 50 packets, many times the precision the bisection stops at
+	const int length = 10 * MIX_RATE;
+	stream->set("data", _make_vorbis_stream(length / 128 + 2));
+	stream->set("streaming", true);
+
+	Ref<AudioStreamPlayback> playback = stream->instance_playback();
+	if (playback.is_null())
+		return false;
+
+	Vector<AudioFrame> reference;
+	reference.resize(length);
+	playback->start();
+	_wait_streamer();
+	for (int done = 0; done < length; done += BLOCK_LEN) {
+		playback->mix(reference.ptrw() + done, 1.0, MIN(BLOCK_LEN, length - done));
+		_wait_streamer();
+	}
+
+	AudioFrame buffer[BLOCK_LEN];
+
+	// times that convert to frames exactly, backwards too
+	float times[] = { 0.5, 7.25, 2.5, 9, 0.25 };
+	for (int t = 0; t < 5; t++) {
+
+		playback->start(times[t]);
+		if (playback->get_playback_position() != times[t])
+			return false;
+
+		_wait_streamer();
+		playback->mix(buffer, 1.0, BLOCK_LEN);
+
+		// the first frames interpolate from the silence before the seek
+		int from = times[t] * MIX_RATE;
+		int sound = 0;
+		for (int i = 4; i < BLOCK_LEN; i++) {
+			if (buffer[i].l != reference[from + i].l)
+				return false;
+			sound += buffer[i].l != 0;
+		}
+		if (sound == 0)
+			return false;
+	}
+
+	return true;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_no_mixing_thread_decode,
+	test_seek,
+	test_loop,
+	test_end,
+	test_sample_skip,
+	test_sidechain_schedule,
+	test_ogg_seek,
+	0
+
+};
+
+MainLoop *test() {
+
+	AudioStreamStreamer *streamer = NULL;
+	if (!AudioStreamStreamer::get_singleton()) {
+		//the audio server was not initialized
+		streamer = memnew(AudioStreamStreamer);
+	}
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	if (streamer) {
+		memdelete(streamer);
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestAudioStream
@@ -0,0 +1,2364 @@
+/*************************************************************************/
+/*  test_benchmark.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_benchmark.h"
+
+#include "benchmark_runner.h"
+#include "hash_map.h"
+#include "io/marshalls.h"
+#include "io/resource_loader.h"
+#include "io/resource_saver.h"
+#include "local_vector.h"
+#include "map.h"
+#include "math/a_star.h"
+#include "math/triangle_bvh.h"
+#include "math/triangle_mesh.h"
+#include "message_queue.h"
+#include "oa_hash_map.h"
+#include "os/dir_access.h"
+#include "os/os.h"
+#include "project_settings.h"
+#include "scene/2d/node_2d.h"
+#include "scene/audio/audio_player.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "scene/resources/box_shape.h"
+#include "scene/resources/mesh_library.h"
+#include "scene/resources/packed_scene.h"
+#include "scene/resources/primitive_meshes.h"
+#include "script_language.h"
+#include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/effects/audio_effect_chorus.h"
+#include "servers/audio/effects/audio_effect_compressor.h"
+#include "servers/audio/effects/audio_effect_eq.h"
+#include "servers/audio/effects/audio_effect_phaser.h"
+#include "servers/audio/effects/audio_effect_reverb.h"
+#include "servers/physics_server.h"
+#include "swiss_hash_map.h"
+#include "variant_parser.h"
+
+#ifndef _3D_DISABLED
+#include "scene/3d/navigation.h"
+#include "scene/3d/voxel_light_baker.h"
+#endif
+
+namespace TestBenchmark {
+
+// results are written here so the optimizer can't drop the workloads
+static volatile int64_t sink = 0;
+
+/* Variant */
+
+static void variant_add_int(int p_iterations) {
+
+	Variant a = 1;
+	Variant b = 2;
+	Variant r;
+	bool valid;
+	for (int i = 0; i < p_iterations; i++) {
+		Variant::evaluate(Variant::OP_ADD, a, b, r, valid);
+		a = r;
+	}
+	sink += (int64_t)a;
+}
+
+static void variant_mul_vector3(int p_iterations) {
+
+	Variant a = Vector3(1, 2, 3);
+	Variant b = 1.0001;
+	Variant r;
+	bool valid;
+	for (int i = 0; i < p_iterations; i++) {
+		Variant::evaluate(Variant::OP_MULTIPLY, a, b, r, valid);
+	}
+	sink += (int64_t)Vector3(r).x;
+}
+
+static void variant_call_method(int p_iterations) {
+
+	Variant v = Vector3(1, 2, 3);
+	StringName method = "length";
+	Variant::CallError ce;
+	real_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (real_t)v.call(method, NULL, 0, ce);
+	}
+	sink += (int64_t)total;
+}
+
+static void variant_copy_string(int p_iterations) {
+
+	String s = "benchmark string";
+	for (int i = 0; i < p_iterations; i++) {
+		Variant v = s;
+		sink += v.get_type();
+	}
+}
+
+/* StringName */
+
+static void string_name_from_string(int p_iterations) {
+
+	String names[8] = { "position", "rotation", "scale", "visible", "modulate", "name", "owner", "script" };
+	for (int i = 0; i < p_iterations; i++) {
+		StringName sn = names[i & 7];
+		sink += sn.hash();
+	}
+}
+
+static void string_name_compare(int p_iterations) {
+
+	StringName a = "position";
+	StringName b = "rotation";
+	for (int i = 0; i < p_iterations; i++) {
+		sink += (i & 1 ? a : b) == a;
+	}
+}
+
+static void string_name_search(int p_iterations) {
+
+	String names[8] = { "node_0", "node_1", "node_2", "node_3", "node_4", "node_5", "node_6", "node_7" };
+	StringName keep[8];
+	for (int i = 0; i < 8; i++) {
+		keep[i] = names[i];
+	}
+	for (int i = 0; i < p_iterations; i++) {
+		sink += StringName::search(names[i & 7].c_str()).hash();
+	}
+}
+
+/* String, 1000 characters per iteration */
+
+static void string_single_chars(int p_iterations) {
+
+	String text = "The quick brown fox jumps over the lazy dog. ";
+	for (int i = 0; i < p_iterations; i++) {
+		for (int j = 0; j < 1000; j++) {
+			String c = text.substr(j % text.length(), 1);
+			sink += c.length();
+		}
+	}
+}
+
+static void string_append_chars(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		String s;
+		for (int j = 0; j < 1000; j++) {
+			s += CharType('a' + j % 26);
+		}
+		sink += s.length();
+	}
+}
+
+static void string_to_upper(int p_iterations) {
+
+	String text;
+	for (int j = 0; j < 1000; j++) {
+		text += CharType('a' + j % 26);
+	}
+	for (int i = 0; i < p_iterations; i++) {
+		sink += text.to_upper().length();
+	}
+}
+
+static String _make_text(int p_length) {
+
+	String text;
+	for (int j = 0; j < p_length; j++) {
+		text += CharType('a' + j % 26);
+	}
+	return text;
+}
+
+static void string_compare(int p_iterations) {
+
+	String a = _make_text(1000);
+	String b = _make_text(1000);
+	for (int i = 0; i < p_iterations; i++) {
+		sink += a == b;
+	}
+}
+
+static void string_find(int p_iterations) {
+
+	String text = _make_text(1000) + "needle";
+	for (int i = 0; i < p_iterations; i++) {
+		sink += text.find("needle");
+	}
+}
+
+static void string_hash(int p_iterations) {
+
+	String text = _make_text(1000);
+	for (int i = 0; i < p_iterations; i++) {
+		sink += text.hash();
+	}
+}
+
+static void string_utf8(int p_iterations) {
+
+	String text = _make_text(1000);
+	for (int i = 0; i < p_iterations; i++) {
+		sink += text.utf8().length();
+	}
+}
+
+/* Containers, 1000 elements per iteration */
+
+static void containers_vector_push_back(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		Vector<int> v;
+		for (int j = 0; j < 1000; j++) {
+			v.push_back(j);
+		}
+		sink += v.size();
+	}
+}
+
+static void containers_local_vector_push_back(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		LocalVector<int> v;
+		for (int j = 0; j < 1000; j++) {
+			v.push_back(j);
+		}
+		sink += v.size();
+	}
+}
+
+static void containers_vector_index_write(int p_iterations) {
+
+	Vector<int> v;
+	v.resize(1000);
+	for (int i = 0; i < p_iterations; i++) {
+		for (int j = 0; j < 1000; j++) {
+			v[j] = i + j;
+		}
+		sink += v[i % 1000];
+	}
+}
+
+static void containers_vector_write_handle(int p_iterations) {
+
+	Vector<int> v;
+	v.resize(1000);
+	for (int i = 0; i < p_iterations; i++) {
+		Vector<int>::Write w = v.write();
+		for (int j = 0; j < 1000; j++) {
+			w[j] = i + j;
+		}
+		sink += v[i % 1000];
+	}
+}
+
+static void containers_hash_map(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		HashMap<int, int> map;
+		for (int j = 0; j < 1000; j++) {
+			map[j * 7] = j;
+		}
+		for (int j = 0; j < 1000; j++) {
+			sink += *map.getptr(j * 7);
+		}
+	}
+}
+
+static void containers_oa_hash_map(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		OAHashMap<int, int> map;
+		for (int j = 0; j < 1000; j++) {
+			map.set(j * 7, j);
+		}
+		int value;
+		for (int j = 0; j < 1000; j++) {
+			map.lookup(j * 7, &value);
+			sink += value;
+		}
+	}
+}
+
+static void containers_swiss_hash_map(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		SwissHashMap<int, int> map;
+		for (int j = 0; j < 1000; j++) {
+			map[j * 7] = j;
+		}
+		for (int j = 0; j < 1000; j++) {
+			sink += *map.getptr(j * 7);
+		}
+	}
+}
+
+static void containers_map(int p_iterations) {
+
+	for (int i = 0; i < p_iterations; i++) {
+		Map<int, int> map;
+		for (int j = 0; j < 1000; j++) {
+			map[j * 7] = j;
+		}
+		for (int j = 0; j < 1000; j++) {
+			sink += map[j * 7];
+		}
+	}
+}
+
+static void containers_dictionary(int p_iterations) {
+
+	Vector<Variant> keys;
+	for (int j = 0; j < 1000; j++) {
+		keys.push_back("key_" + itos(j));
+	}
+
+	for (int i = 0; i < p_iterations; i++) {
+		Dictionary d;
+		for (int j = 0; j < 1000; j++) {
+			d[keys[j]] = j;
+		}
+		for (int j = 0; j < 1000; j++) {
+			sink += (int)d[keys[j]];
+		}
+	}
+}
+
+/* Marshalls */
+
+static Dictionary _make_state(int p_entities) {
+
+	Dictionary state;
+	Array entities;
+	for (int i = 0; i < p_entities; i++) {
+		Dictionary e;
+		e["id"] = i;
+		e["position"] = Vector3(Math::randf(), Math::randf(), Math::randf());
+		e["health"] = Math::rand() % 100;
+		e["name"] = "entity_" + itos(i);
+		entities.push_back(e);
+	}
+	state["entities"] = entities;
+	return state;
+}
+
+static void marshalls_encode(int p_iterations) {
+
+	Dictionary state = _make_state(100);
+	Vector<uint8_t> buffer;
+	for (int i = 0; i < p_iterations; i++) {
+		int len;
+		encode_variant(state, NULL, len);
+		buffer.resize(len);
+		encode_variant(state, buffer.ptrw(), len);
+		sink += len;
+	}
+}
+
+static void marshalls_encode_compact(int p_iterations) {
+
+	Dictionary state = _make_state(100);
+	Vector<uint8_t> buffer;
+	for (int i = 0; i < p_iterations; i++) {
+		int len;
+		encode_variant_compact(state, buffer, len);
+		sink += len;
+	}
+}
+
+/* GDScript kernels */
+
+class ScriptBenchmark : public Benchmark {
+
+	String name;
+	String source;
+	Variant argument;
+
+	Ref<Script> script;
+	Ref<Reference> instance;
+
+public:
+	virtual String get_name() const { return name; }
+
+	virtual bool setup() {
+
+		ScriptLanguage *language = NULL;
+		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+			if (ScriptServer::get_language(i)->get_name() == "GDScript") {
+				language = ScriptServer::get_language(i);
+			}
+		}
+		if (!language)
+			return false;
+
+		script = Ref<Script>(language->create_script());
+		script->set_source_code(source);
+		if (script->reload() != OK)
+			return false;
+
+		instance.instance();
+		instance->set_script(script.get_ref_ptr());
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			sink += (int64_t)instance->call("run", argument);
+		}
+	}
+
+	virtual void teardown() {
+
+		instance = Ref<Reference>();
+		script = Ref<Script>();
+	}
+
+	ScriptBenchmark(const String &p_name, const String &p_source, const Variant &p_argument) {
+
+		name = p_name;
+		source = p_source;
+		argument = p_argument;
+	}
+};
+
+/* Signals, one iteration is one emission to every target */
+
+class SignalBenchmark : public Benchmark {
+
+	int target_count;
+	bool binds;
+
+	Object *source;
+	Vector<Node2D *> targets;
+
+public:
+	virtual String get_name() const { return "signals/emit_" + itos(target_count) + "_targets" + (binds ? "_binds" : ""); }
+
+	virtual bool setup() {
+
+		source = memnew(Object);
+		source->add_user_signal(MethodInfo("hit", PropertyInfo(Variant::REAL, "amount")));
+		source->add_user_signal(MethodInfo("poke"));
+
+		for (int i = 0; i < target_count; i++) {
+			Node2D *target = memnew(Node2D);
+			if (binds) {
+				Vector<Variant> bind_values;
+				bind_values.push_back(0.5);
+				source->connect("poke", target, "set_rotation", bind_values);
+			} else {
+				source->connect("hit", target, "set_rotation");
+			}
+			targets.push_back(target);
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			if (binds) {
+				source->emit_signal("poke");
+			} else {
+				source->emit_signal("hit", 0.5);
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		memdelete(source);
+		for (int i = 0; i < targets.size(); i++) {
+			memdelete(targets[i]);
+		}
+		targets.clear();
+	}
+
+	SignalBenchmark(int p_target_count, bool p_binds) {
+
+		target_count = p_target_count;
+		binds = p_binds;
+		source = NULL;
+	}
+};
+
+/* Physics */
+
+class PhysicsStepBenchmark : public Benchmark {
+
+public:
+	enum Ground {
+		GROUND_PLANE,
+		GROUND_HEIGHT_MAP, // 512x512 cells of terrain
+		GROUND_CONCAVE, // the same terrain as triangles
+	};
+
+private:
+	int body_count;
+	Ground ground_type;
+
+	RID space;
+	RID ground_shape;
+	RID sphere_shape;
+	RID ground;
+	Vector<RID> bodies;
+
+	Transform _initial_transform(int p_index) const {
+
+		int side = (int)Math::ceil(Math::sqrt((double)body_count));
+		return Transform(Basis(), Vector3((p_index % side) * 1.1, 2 + (p_index / side) % 4, (p_index / side) * 1.1));
+	}
+
+	Variant _make_terrain_data() const {
+
+		const int size = 513;
+
+		PoolVector<real_t> heights;
+		heights.resize(size * size);
+		{
+			PoolVector<real_t>::Write w = heights.write();
+			for (int z = 0; z < size; z++) {
+				for (int x = 0; x < size; x++) {
+					w[z * size + x] = Math::sin(x * 0.2) * Math::cos(z * 0.3) * 0.5 - 0.5;
+				}
+			}
+		}
+
+		if (ground_type == GROUND_HEIGHT_MAP) {
+			Dictionary d;
+			d["width"] = size;
+			d["depth"] = size;
+			d["cell_size"] = 1.0;
+			d["heights"] = heights;
+			return d;
+		}
+
+		// triangulated like the height map, centered on the origin
+		PoolVector<Vector3> faces;
+		faces.resize((size - 1) * (size - 1) * 6);
+		PoolVector<real_t>::Read r = heights.read();
+		PoolVector<Vector3>::Write w = faces.write();
+		int idx = 0;
+		for (int z = 0; z < size - 1; z++) {
+			for (int x = 0; x < size - 1; x++) {
+				Vector3 p[4];
+				for (int i = 0; i < 4; i++) {
+					int px = x + (i & 1);
+					int pz = z + (i >> 1);
+					p[i] = Vector3(px - (size - 1) * 0.5, r[pz * size + px], pz - (size - 1) * 0.5);
+				}
+				w[idx++] = p[0];
+				w[idx++] = p[3];
+				w[idx++] = p[2];
+				w[idx++] = p[0];
+				w[idx++] = p[1];
+				w[idx++] = p[3];
+			}
+		}
+		return faces;
+	}
+
+public:
+	virtual String get_name() const {
+
+		static const char *ground_names[] = { "", "_on_height_map", "_on_concave" };
+		return "physics/step_" + itos(body_count) + "_spheres" + ground_names[ground_type];
+	}
+
+	virtual bool setup() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		space = ps->space_create();
+		ps->space_set_active(space, true);
+
+		switch (ground_type) {
+			case GROUND_PLANE: {
+				ground_shape = ps->shape_create(PhysicsServer::SHAPE_PLANE);
+				ps->shape_set_data(ground_shape, Plane(0, 1, 0, 0));
+			} break;
+			case GROUND_HEIGHT_MAP: {
+				ground_shape = ps->shape_create(PhysicsServer::SHAPE_HEIGHTMAP);
+				ps->shape_set_data(ground_shape, _make_terrain_data());
+			} break;
+			case GROUND_CONCAVE: {
+				ground_shape = ps->shape_create(PhysicsServer::SHAPE_CONCAVE_POLYGON);
+				ps->shape_set_data(ground_shape, _make_terrain_data());
+			} break;
+		}
+		sphere_shape = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+		ps->shape_set_data(sphere_shape, 0.5);
+
+		ground = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+		ps->body_add_shape(ground, ground_shape);
+		ps->body_set_space(ground, space);
+
+		for (int i = 0; i < body_count; i++) {
+			RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+			ps->body_add_shape(body, sphere_shape);
+			ps->body_set_space(body, space);
+			bodies.push_back(body);
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		// every run simulates the same drop from the same start
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_TRANSFORM, _initial_transform(i));
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_LINEAR_VELOCITY, Vector3());
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_SLEEPING, false);
+		}
+
+		for (int i = 0; i < p_iterations; i++) {
+			ps->step(1.0 / 60.0);
+		}
+	}
+
+	virtual void teardown() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		bodies.clear();
+		ps->free(ground);
+		ps->free(sphere_shape);
+		ps->free(ground_shape);
+		ps->free(space);
+	}
+
+	PhysicsStepBenchmark(int p_body_count, Ground p_ground = GROUND_PLANE) {
+
+		body_count = p_body_count;
+		ground_type = p_ground;
+	}
+};
+
+/* Physics stacks, towers of resting boxes are where the solver spends most of its time */
+
+class PhysicsStackBenchmark : public Benchmark {
+
+	int tower_side;
+	int tower_height;
+	bool multithreaded;
+
+	RID space;
+	RID ground_shape;
+	RID box_shape;
+	RID ground;
+	Vector<RID> bodies;
+
+	Transform _initial_transform(int p_index) const {
+
+		int tower = p_index / tower_height;
+		int level = p_index % tower_height;
+		return Transform(Basis(), Vector3((tower % tower_side) * 2.0, 0.5 + level * 1.01, (tower / tower_side) * 2.0));
+	}
+
+public:
+	// the Bullet server reads the setting when a space is created (the multithreaded world also needs it enabled at startup), the other servers ignore it
+	virtual String get_name() const { return "physics/step_" + itos(tower_side * tower_side) + "_stacks_of_" + itos(tower_height) + "_boxes" + (multithreaded ? "_multithreaded" : ""); }
+
+	virtual bool setup() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+		ProjectSettings *settings = ProjectSettings::get_singleton();
+
+		Variant prev_multithreaded = settings->get("physics/3d/bullet/multithreaded");
+		settings->set("physics/3d/bullet/multithreaded", multithreaded);
+		space = ps->space_create();
+		settings->set("physics/3d/bullet/multithreaded", prev_multithreaded);
+		ps->space_set_active(space, true);
+
+		ground_shape = ps->shape_create(PhysicsServer::SHAPE_PLANE);
+		ps->shape_set_data(ground_shape, Plane(Vector3(0, 1, 0), 0));
+		box_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+
+		ground = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+		ps->body_add_shape(ground, ground_shape);
+		ps->body_set_space(ground, space);
+
+		for (int i = 0; i < tower_side * tower_side * tower_height; i++) {
+			RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+			ps->body_add_shape(body, box_shape);
+			ps->body_set_space(body, space);
+			bodies.push_back(body);
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		// restack every run, resting towers would otherwise fall asleep and cost nothing
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_TRANSFORM, _initial_transform(i));
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_LINEAR_VELOCITY, Vector3());
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_ANGULAR_VELOCITY, Vector3());
+			ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_SLEEPING, false);
+		}
+
+		for (int i = 0; i < p_iterations; i++) {
+			ps->step(1.0 / 60.0);
+		}
+	}
+
+	virtual void teardown() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		bodies.clear();
+		ps->free(ground);
+		ps->free(box_shape);
+		ps->free(ground_shape);
+		ps->free(space);
+	}
+
+	PhysicsStackBenchmark(int p_tower_side, int p_tower_height, bool p_multithreaded) {
+
+		tower_side = p_tower_side;
+		tower_height = p_tower_height;
+		multithreaded = p_multithreaded;
+	}
+};
+
+/* Physics queries, one iteration is 1000 queries against 2000 static boxes */
+
+class PhysicsQueryBenchmark : public Benchmark {
+
+public:
+	enum Query {
+		QUERY_RAY, // one intersect_ray() call per ray
+		QUERY_RAY_BATCH, // all rays in one intersect_rays() call
+		QUERY_SHAPE_BATCH, // a sphere at every ray origin in one intersect_shapes() call
+	};
+
+private:
+	Query query;
+
+	RID space;
+	RID box_shape;
+	RID sphere_shape;
+	Vector<RID> bodies;
+	Vector<PhysicsDirectSpaceState::RayQuery> rays;
+	Vector<PhysicsDirectSpaceState::ShapeQuery> shapes;
+	Vector<PhysicsDirectSpaceState::RayResult> ray_results;
+	Vector<PhysicsDirectSpaceState::ShapeResult> shape_results;
+
+public:
+	virtual String get_name() const {
+
+		static const char *query_names[] = { "rays_1000", "rays_1000_batched", "spheres_1000_batched" };
+		return String("physics/") + query_names[query];
+	}
+
+	virtual bool setup() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		space = ps->space_create();
+		ps->space_set_active(space, true);
+
+		box_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+		sphere_shape = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+		ps->shape_set_data(sphere_shape, 0.5);
+
+		for (int i = 0; i < 2000; i++) {
+			RID body = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+			ps->body_add_shape(body, box_shape);
+			ps->body_set_space(body, space);
+			ps->body_set_collision_layer(body, 1 << (i % 4));
+			ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(Math::randf(), Math::randf(), Math::randf()) * 50));
+			bodies.push_back(body);
+		}
+
+		rays.resize(1000);
+		shapes.resize(1000);
+		for (int i = 0; i < 1000; i++) {
+			rays[i].from = Vector3(Math::randf(), Math::randf(), Math::randf()) * 50;
+			rays[i].to = rays[i].from + Vector3(Math::randf() - 0.5, Math::randf() - 0.5, Math::randf() - 0.5) * 40;
+			rays[i].collision_mask = (i & 1) ? 0xFFFFFFFF : 0x3;
+			shapes[i].transform = Transform(Basis(), rays[i].from);
+			shapes[i].collision_mask = rays[i].collision_mask;
+		}
+		ray_results.resize(1000);
+		shape_results.resize(1000);
+
+		// the direct state is only accessible between a step and the next one
+		ps->step(1.0 / 60.0);
+		ps->sync();
+		ps->flush_queries();
+		return ps->space_get_direct_state(space) != NULL;
+	}
+
+	virtual void run(int p_iterations) {
+
+		PhysicsDirectSpaceState *state = PhysicsServer::get_singleton()->space_get_direct_state(space);
+
+		for (int i = 0; i < p_iterations; i++) {
+			switch (query) {
+				case QUERY_RAY: {
+					PhysicsDirectSpaceState::RayResult result;
+					for (int j = 0; j < rays.size(); j++) {
+						sink += state->intersect_ray(rays[j].from, rays[j].to, result, Set<RID>(), rays[j].collision_mask);
+					}
+				} break;
+				case QUERY_RAY_BATCH: {
+					sink += state->intersect_rays(rays.ptr(), rays.size(), ray_results.ptrw());
+				} break;
+				case QUERY_SHAPE_BATCH: {
+					sink += state->intersect_shapes(sphere_shape, 0, shapes.ptr(), shapes.size(), shape_results.ptrw());
+				} break;
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		bodies.clear();
+		ps->free(sphere_shape);
+		ps->free(box_shape);
+		ps->free(space);
+	}
+
+	PhysicsQueryBenchmark(Query p_query) {
+
+		query = p_query;
+	}
+};
+
+class TriangleMeshBenchmark : public Benchmark {
+
+public:
+	enum Test {
+		TEST_BVH_BUILD, // only the tree, over the bounds of the faces
+		TEST_MESH_BUILD, // TriangleMesh::create(), vertex welding included
+		TEST_SEGMENTS, // 1000 intersect_segment() calls from above the terrain
+	};
+
+private:
+	Test test;
+	int size;
+
+	PoolVector<Vector3> faces;
+	Vector<AABB> aabbs;
+	Vector<Vector3> segments;
+	Ref<TriangleMesh> mesh;
+
+public:
+	virtual String get_name() const {
+
+		static const char *test_names[] = { "bvh_build_", "build_", "segments_1000_faces_" };
+		return String("triangle_mesh/") + test_names[test] + itos(size * size * 2);
+	}
+
+	virtual bool setup() {
+
+		// a bumpy terrain, two triangles per cell
+		for (int z = 0; z < size; z++) {
+			for (int x = 0; x < size; x++) {
+
+				Vector3 p[4];
+				for (int i = 0; i < 4; i++) {
+					real_t px = x + (i & 1);
+					real_t pz = z + (i >> 1);
+					p[i] = Vector3(px, Math::sin(px * 0.3) * 4 + Math::cos(pz * 0.2) * 6, pz);
+				}
+
+				faces.push_back(p[0]);
+				faces.push_back(p[3]);
+				faces.push_back(p[2]);
+				faces.push_back(p[0]);
+				faces.push_back(p[1]);
+				faces.push_back(p[3]);
+			}
+		}
+
+		PoolVector<Vector3>::Read r = faces.read();
+		for (int i = 0; i < faces.size(); i += 3) {
+			aabbs.push_back(Face3(r[i], r[i + 1], r[i + 2]).get_aabb());
+		}
+
+		for (int i = 0; i < 1000; i++) {
+			Vector3 from(Math::randf() * size, 20, Math::randf() * size);
+			segments.push_back(from);
+			segments.push_back(from + Vector3(Math::randf() * 20 - 10, -40, Math::randf() * 20 - 10));
+		}
+
+		mesh.instance();
+		if (test == TEST_SEGMENTS) {
+			mesh->create(faces);
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			switch (test) {
+				case TEST_BVH_BUILD: {
+					TriangleBVH bvh;
+					bvh.build(aabbs.ptr(), aabbs.size());
+					sink += bvh.get_node_count();
+				} break;
+				case TEST_MESH_BUILD: {
+					mesh->create(faces);
+					sink += mesh->is_valid();
+				} break;
+				case TEST_SEGMENTS: {
+					Vector3 point, normal;
+					for (int j = 0; j < segments.size(); j += 2) {
+						sink += mesh->intersect_segment(segments[j], segments[j + 1], point, normal);
+					}
+				} break;
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		mesh.unref();
+		faces = PoolVector<Vector3>();
+		aabbs.clear();
+		segments.clear();
+	}
+
+	TriangleMeshBenchmark(int p_size, Test p_test) {
+
+		size = p_size;
+		test = p_test;
+	}
+};
+
+/* Scenes and resources */
+
+static Node *_make_scene(int p_node_count) {
+
+	Node2D *root = memnew(Node2D);
+	root->set_name("root");
+
+	Node *parent = root;
+	for (int i = 0; i < p_node_count - 1; i++) {
+
+		Node2D *n = memnew(Node2D);
+		n->set_name("node_" + itos(i));
+		n->set_position(Vector2(Math::randf() * 1000, Math::randf() * 1000));
+		n->set_rotation(Math::randf());
+		parent->add_child(n);
+		n->set_owner(root);
+
+		// a few levels of nesting, like a typical scene
+		if (i % 10 == 9)
+			parent = i % 100 == 99 ? (Node *)root : n;
+	}
+	return root;
+}
+
+class InstanceBenchmark : public Benchmark {
+
+	int node_count;
+	int instance_count;
+	Ref<PackedScene> scene;
+
+public:
+	virtual String get_name() const {
+
+		if (instance_count == 1)
+			return "scene/instance_" + itos(node_count) + "_nodes";
+		return "scene/instance_" + itos(instance_count) + "_scenes_of_" + itos(node_count) + "_nodes";
+	}
+
+	virtual bool setup() {
+
+		Node *root = _make_scene(node_count);
+		scene.instance();
+		Error err = scene->pack(root);
+		memdelete(root);
+		return err == OK;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+
+			for (int j = 0; j < instance_count; j++) {
+				Node *n = scene->instance();
+				sink += n->get_child_count();
+				memdelete(n);
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		scene = Ref<PackedScene>();
+	}
+
+	// one iteration instances the scene p_instance_count times, like spawning a wave of enemies in a frame
+	InstanceBenchmark(int p_node_count, int p_instance_count = 1) {
+
+		node_count = p_node_count;
+		instance_count = p_instance_count;
+	}
+};
+
+class LoadBenchmark : public Benchmark {
+
+	int node_count;
+	String extension;
+	String path;
+
+public:
+	virtual String get_name() const { return "resource/load_" + extension + "_" + itos(node_count) + "_nodes"; }
+
+	virtual bool setup() {
+
+		Node *root = _make_scene(node_count);
+		Ref<PackedScene> scene;
+		scene.instance();
+		Error err = scene->pack(root);
+		memdelete(root);
+		if (err != OK)
+			return false;
+
+		path = "user://benchmark_scene." + extension;
+		return ResourceSaver::save(path, scene) == OK;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			RES res = ResourceLoader::load(path, "", true);
+			sink += res.is_valid();
+		}
+	}
+
+	virtual void teardown() {
+
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+		da->remove(path);
+		memdelete(da);
+	}
+
+	LoadBenchmark(const String &p_extension, int p_node_count) {
+
+		extension = p_extension;
+		node_count = p_node_count;
+	}
+};
+
+// Pulls one byte per refill through FileAccess::get_8(), which is how text resources
+// were read before VariantParser streams were buffered. Kept as the reference point.
+struct StreamFileUnbuffered : public VariantParser::Stream {
+
+	FileAccess *f;
+
+protected:
+	virtual uint32_t _read_buffer(CharType *p_buffer, uint32_t p_num_chars) {
+
+		uint8_t c = f->get_8();
+		if (f->eof_reached())
+			return 0;
+		p_buffer[0] = c;
+		return 1;
+	}
+
+public:
+	virtual bool is_utf8() const { return true; }
+
+	StreamFileUnbuffered() { f = NULL; }
+};
+
+class TextParseBenchmark : public Benchmark {
+
+	int mesh_count;
+	bool buffered;
+	String path;
+
+public:
+	virtual String get_name() const { return String("resource/parse_text_") + (buffered ? "" : "unbuffered_") + itos(mesh_count) + "_meshes"; }
+
+	virtual bool setup() {
+
+		path = "user://benchmark_parse.tres";
+		FileAccess *f = FileAccess::open(path, FileAccess::WRITE);
+		if (!f)
+			return false;
+
+		f->store_line("[gd_resource type=\"Resource\" load_steps=" + itos(mesh_count + 1) + " format=2]\n");
+
+		// similar to what ArrayMesh surfaces look like in a saved scene
+		for (int i = 0; i < mesh_count; i++) {
+
+			PoolVector<Vector3> vertices;
+			PoolVector<Vector2> uvs;
+			PoolVector<int> indices;
+			for (int j = 0; j < 300; j++) {
+				vertices.push_back(Vector3(Math::randf() * 100.0, Math::randf() * 10.0, -Math::randf()));
+				uvs.push_back(Vector2(Math::randf(), Math::randf()));
+				indices.push_back(Math::rand() % 300);
+			}
+
+			Array arrays;
+			arrays.push_back(vertices);
+			arrays.push_back(uvs);
+			arrays.push_back(indices);
+			arrays.push_back("surface_" + itos(i));
+
+			String value;
+			VariantWriter::write_to_string(arrays, value);
+
+			f->store_line("[sub_resource type=\"ArrayMesh\" id=" + itos(i + 1) + "]\n");
+			f->store_line("surfaces/0 = " + value);
+			f->store_line("transform = Transform( 1, 0, 0, 0, 1, 0, 0, 0, 1, 2.5, -3, 4 )\n");
+		}
+
+		f->close();
+		memdelete(f);
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+
+			FileAccess *f = FileAccess::open(path, FileAccess::READ);
+			VariantParser::StreamFile stream_file;
+			StreamFileUnbuffered stream_unbuffered;
+			stream_file.f = f;
+			stream_unbuffered.f = f;
+			VariantParser::Stream *stream = buffered ? (VariantParser::Stream *)&stream_file : (VariantParser::Stream *)&stream_unbuffered;
+
+			int lines = 0;
+			String error;
+			while (true) {
+				VariantParser::Tag tag;
+				String assign;
+				Variant value;
+				if (VariantParser::parse_tag_assign_eof(stream, lines, error, tag, assign, value) != OK)
+					break;
+				sink += value.get_type();
+			}
+
+			memdelete(f);
+		}
+	}
+
+	virtual void teardown() {
+
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+		da->remove(path);
+		memdelete(da);
+	}
+
+	TextParseBenchmark(int p_mesh_count, bool p_buffered) {
+
+		mesh_count = p_mesh_count;
+		buffered = p_buffered;
+	}
+};
+
+/* Audio, mixed offline so the timing does not depend on the output device */
+
+static Ref<AudioStreamSample> make_audio_sample(bool p_stereo, float p_freq) {
+
+	// one second of 16 bits at half the usual mix rate, so it gets resampled
+	int frames = 22050;
+	int channels = p_stereo ? 2 : 1;
+
+	PoolVector<uint8_t> data;
+	data.resize(frames * channels * sizeof(int16_t));
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		int16_t *dst = (int16_t *)w.ptr();
+		for (int i = 0; i < frames; i++) {
+			for (int j = 0; j < channels; j++) {
+				dst[i * channels + j] = int16_t(Math::sin(i * (p_freq + j) * Math_PI * 2.0 / 22050.0) * 16000);
+			}
+		}
+	}
+
+	Ref<AudioStreamSample> sample;
+	sample.instance();
+	sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+	sample->set_mix_rate(22050);
+	sample->set_stereo(p_stereo);
+	sample->set_loop_mode(AudioStreamSample::LOOP_FORWARD);
+	sample->set_loop_end(frames);
+	sample->set_data(data);
+	return sample;
+}
+
+class AudioMixBenchmark : public Benchmark {
+
+	enum {
+		MIX_FRAMES = 1024,
+		MAX_OUTPUT_CHANNELS = 8 // 7.1 output, in case the driver is surround
+	};
+
+	int voice_count;
+	AudioMixKernels::Implementation implementation;
+	SceneTree *tree;
+	Vector<Ref<AudioStreamSample> > samples;
+	AudioDriverDummy offline_driver;
+	int32_t output[MIX_FRAMES * MAX_OUTPUT_CHANNELS];
+
+public:
+	virtual String get_name() const { return "audio/mix_" + itos(voice_count) + "_voices_" + String(AudioMixKernels::get_implementation_name(implementation)).to_lower(); }
+
+	virtual bool setup() {
+
+		if (!AudioMixKernels::is_implementation_supported(implementation))
+			return false;
+
+		samples.push_back(make_audio_sample(false, 440));
+		samples.push_back(make_audio_sample(true, 330));
+
+		tree = memnew(SceneTree);
+		tree->init();
+
+		for (int i = 0; i < voice_count; i++) {
+			AudioStreamPlayer *player = memnew(AudioStreamPlayer);
+			player->set_stream(samples[i % samples.size()]);
+			player->set_pitch_scale(0.5 + (i % 7) * 0.25);
+			player->set_volume_db(-20);
+			tree->get_root()->add_child(player);
+			player->play();
+		}
+		MessageQueue::get_singleton()->flush();
+
+		AudioMixKernels::set_implementation(implementation);
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		AudioServer::get_singleton()->lock();
+		for (int i = 0; i < p_iterations; i++) {
+			offline_driver.mix_audio(MIX_FRAMES, output);
+			sink += output[0];
+		}
+		AudioServer::get_singleton()->unlock();
+	}
+
+	virtual void teardown() {
+
+		if (tree) {
+			tree->finish();
+			memdelete(tree);
+			tree = NULL;
+		}
+		samples.clear();
+		AudioMixKernels::init(); // back to the best supported kernels
+	}
+
+	AudioMixBenchmark(int p_voice_count, AudioMixKernels::Implementation p_implementation) {
+
+		voice_count = p_voice_count;
+		implementation = p_implementation;
+		tree = NULL;
+	}
+};
+
+class AudioBusBenchmark : public Benchmark {
+
+	enum {
+		MIX_FRAMES = 1024,
+		MAX_OUTPUT_CHANNELS = 8,
+		VOICES_PER_BUS = 4,
+		GROUP_BUSES = 2 // the other buses send to these, which send to master
+	};
+
+	int bus_count;
+	int thread_count;
+	int prev_thread_count;
+	SceneTree *tree;
+	Ref<AudioBusLayout> prev_layout;
+	Ref<AudioStreamSample> sample;
+	AudioDriverDummy offline_driver;
+	int32_t output[MIX_FRAMES * MAX_OUTPUT_CHANNELS];
+
+public:
+	virtual String get_name() const { return "audio/bus_effects_" + itos(bus_count) + "_buses_" + itos(thread_count) + "_threads"; }
+
+	virtual bool setup() {
+
+		AudioServer *as = AudioServer::get_singleton();
+		prev_layout = as->generate_bus_layout();
+		prev_thread_count = as->get_bus_effect_thread_count();
+		as->set_bus_effect_thread_count(thread_count);
+
+		as->set_bus_count(bus_count + 1);
+		for (int i = 1; i <= bus_count; i++) {
+			as->set_bus_name(i, "Bench" + itos(i));
+		}
+
+		for (int i = 1; i <= bus_count; i++) {
+			as->set_bus_send(i, i <= GROUP_BUSES ? StringName("Master") : StringName("Bench" + itos(1 + i % GROUP_BUSES)));
+
+			Ref<AudioEffectEQ6> eq;
+			eq.instance();
+			eq->set_band_gain_db(1, 6);
+			as->add_bus_effect(i, eq);
+
+			Ref<AudioEffectChorus> chorus;
+			chorus.instance();
+			as->add_bus_effect(i, chorus);
+
+			Ref<AudioEffectPhaser> phaser;
+			phaser.instance();
+			as->add_bus_effect(i, phaser);
+
+			Ref<AudioEffectCompressor> compressor;
+			compressor.instance();
+			as->add_bus_effect(i, compressor);
+
+			Ref<AudioEffectReverb> reverb;
+			reverb.instance();
+			as->add_bus_effect(i, reverb);
+		}
+
+		sample = make_audio_sample(true, 330);
+
+		tree = memnew(SceneTree);
+		tree->init();
+
+		for (int i = 0; i < bus_count * VOICES_PER_BUS; i++) {
+			AudioStreamPlayer *player = memnew(AudioStreamPlayer);
+			player->set_stream(sample);
+			player->set_pitch_scale(0.5 + (i % 7) * 0.25);
+			player->set_volume_db(-20);
+			player->set_bus("Bench" + itos(1 + i % bus_count));
+			tree->get_root()->add_child(player);
+			player->play();
+		}
+		MessageQueue::get_singleton()->flush();
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		AudioServer::get_singleton()->lock();
+		for (int i = 0; i < p_iterations; i++) {
+			offline_driver.mix_audio(MIX_FRAMES, output);
+			sink += output[0];
+		}
+		AudioServer::get_singleton()->unlock();
+	}
+
+	virtual void teardown() {
+
+		if (tree) {
+			tree->finish();
+			memdelete(tree);
+			tree = NULL;
+		}
+		sample.unref();
+
+		AudioServer *as = AudioServer::get_singleton();
+		if (prev_layout.is_valid()) {
+			as->set_bus_layout(prev_layout);
+			prev_layout.unref();
+		}
+		as->set_bus_effect_thread_count(prev_thread_count);
+	}
+
+	AudioBusBenchmark(int p_bus_count, int p_thread_count) {
+
+		bus_count = p_bus_count;
+		thread_count = p_thread_count;
+		prev_thread_count = 0;
+		tree = NULL;
+	}
+};
+
+/* Macro benchmarks, one iteration is a full frame of a scripted scene */
+
+class SceneFrameBenchmark : public Benchmark {
+
+	int node_count;
+	SceneTree *tree;
+	Ref<Script> script;
+
+	static void _set_script_recursive(Node *p_node, const Ref<Script> &p_script) {
+
+		p_node->set_script(p_script.get_ref_ptr());
+		for (int i = 0; i < p_node->get_child_count(); i++) {
+			_set_script_recursive(p_node->get_child(i), p_script);
+		}
+	}
+
+public:
+	virtual String get_name() const { return "scene_tree/frame_" + itos(node_count) + "_scripted_nodes"; }
+
+	virtual bool setup() {
+
+		ScriptLanguage *language = NULL;
+		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+			if (ScriptServer::get_language(i)->get_name() == "GDScript") {
+				language = ScriptServer::get_language(i);
+			}
+		}
+		if (!language)
+			return false;
+
+		script = Ref<Script>(language->create_script());
+		script->set_source_code(
+				"extends Node2D\n"
+				"var velocity = Vector2(10, 5)\n"
+				"func _ready():\n"
+				"\tset_process(true)\n"
+				"\tset_physics_process(true)\n"
+				"func _process(delta):\n"
+				"\tposition += velocity * delta\n"
+				"func _physics_process(delta):\n"
+				"\trotation += delta\n");
+		if (script->reload() != OK)
+			return false;
+
+		tree = memnew(SceneTree);
+		tree->init();
+
+		Node *root = _make_scene(node_count);
+		_set_script_recursive(root, script);
+		tree->get_root()->add_child(root);
+		MessageQueue::get_singleton()->flush();
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			tree->iteration(1.0 / 60.0);
+			MessageQueue::get_singleton()->flush();
+			tree->idle(1.0 / 60.0);
+			MessageQueue::get_singleton()->flush();
+		}
+	}
+
+	virtual void teardown() {
+
+		if (tree) {
+			tree->finish();
+			memdelete(tree);
+			tree = NULL;
+		}
+		script = Ref<Script>();
+	}
+
+	SceneFrameBenchmark(int p_node_count) {
+
+		node_count = p_node_count;
+		tree = NULL;
+	}
+};
+
+/* Group calls, one iteration calls a method on every node of the group */
+
+class GroupCallBenchmark : public Benchmark {
+
+	int node_count;
+	bool parallel;
+	SceneTree *tree;
+
+	static void _add_to_group_recursive(Node *p_node) {
+
+		p_node->add_to_group("enemies");
+		for (int i = 0; i < p_node->get_child_count(); i++) {
+			_add_to_group_recursive(p_node->get_child(i));
+		}
+	}
+
+public:
+	virtual String get_name() const { return "scene_tree/call_group_" + itos(node_count) + "_nodes" + (parallel ? "_parallel" : ""); }
+
+	virtual bool setup() {
+
+		tree = memnew(SceneTree);
+		tree->init();
+
+		Node *root = _make_scene(node_count);
+		tree->get_root()->add_child(root);
+		_add_to_group_recursive(root);
+		MessageQueue::get_singleton()->flush();
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		uint32_t flags = SceneTree::GROUP_CALL_REALTIME;
+		if (parallel) {
+			flags |= SceneTree::GROUP_CALL_PARALLEL;
+		}
+		for (int i = 0; i < p_iterations; i++) {
+			tree->call_group_flags(flags, "enemies", "set_z_index", i % 100);
+		}
+	}
+
+	virtual void teardown() {
+
+		if (tree) {
+			tree->finish();
+			memdelete(tree);
+			tree = NULL;
+		}
+	}
+
+	GroupCallBenchmark(int p_node_count, bool p_parallel) {
+
+		node_count = p_node_count;
+		parallel = p_parallel;
+		tree = NULL;
+	}
+};
+
+class ProcessFrameBenchmark : public Benchmark {
+
+	int node_count;
+	int spawn_count;
+	SceneTree *tree;
+	Node *spawn_parent;
+
+	static void _set_process_recursive(Node *p_node) {
+
+		p_node->set_process(true);
+		p_node->set_physics_process(true);
+		for (int i = 0; i < p_node->get_child_count(); i++) {
+			_set_process_recursive(p_node->get_child(i));
+		}
+	}
+
+public:
+	virtual String get_name() const { return "scene_tree/frame_" + itos(node_count) + "_processing_nodes" + (spawn_count ? "_spawn_" + itos(spawn_count) : String()); }
+
+	virtual bool setup() {
+
+		tree = memnew(SceneTree);
+		tree->init();
+
+		Node *root = _make_scene(node_count);
+		tree->get_root()->add_child(root);
+		_set_process_recursive(root);
+		spawn_parent = root->get_child(root->get_child_count() / 2);
+		MessageQueue::get_singleton()->flush();
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+
+			// spawned nodes land in the middle of the tree, so the process groups have to merge them in order
+			Vector<Node *> spawned;
+			for (int j = 0; j < spawn_count; j++) {
+				Node2D *n = memnew(Node2D);
+				n->set_process(true);
+				spawn_parent->add_child(n);
+				spawned.push_back(n);
+			}
+
+			tree->iteration(1.0 / 60.0);
+			tree->idle(1.0 / 60.0);
+
+			for (int j = 0; j < spawned.size(); j++) {
+				memdelete(spawned[j]);
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		if (tree) {
+			tree->finish();
+			memdelete(tree);
+			tree = NULL;
+		}
+	}
+
+	ProcessFrameBenchmark(int p_node_count, int p_spawn_count) {
+
+		node_count = p_node_count;
+		spawn_count = p_spawn_count;
+		tree = NULL;
+		spawn_parent = NULL;
+	}
+};
+
+/* Node paths, one iteration resolves the path once, from C++ or through $Path in a script */
+
+class NodePathBenchmark : public Benchmark {
+
+	bool deep;
+	bool script;
+	Node *root;
+	NodePath path;
+	Ref<Script> script_res;
+
+public:
+	virtual String get_name() const { return String("scene_tree/get_node_") + (deep ? "deep_20" : "wide_1000") + (script ? "_gdscript" : ""); }
+
+	virtual bool setup() {
+
+		root = memnew(Node);
+		root->set_name("root");
+
+		String path_str;
+		if (deep) {
+			// a chain of 20 levels, each with a few siblings around the one on the path
+			Node *parent = root;
+			for (int i = 0; i < 20; i++) {
+				for (int j = 0; j < 4; j++) {
+					Node *sibling = memnew(Node);
+					sibling->set_name("sibling_" + itos(j));
+					parent->add_child(sibling);
+				}
+				Node *level = memnew(Node);
+				level->set_name("level_" + itos(i));
+				parent->add_child(level);
+				parent = level;
+				path_str += (i ? "/" : "") + String(level->get_name());
+			}
+		} else {
+			for (int i = 0; i < 1000; i++) {
+				Node *child = memnew(Node);
+				child->set_name("child_" + itos(i));
+				root->add_child(child);
+			}
+			path_str = "child_999";
+		}
+		path = NodePath(path_str);
+
+		if (script) {
+
+			ScriptLanguage *language = NULL;
+			for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+				if (ScriptServer::get_language(i)->get_name() == "GDScript") {
+					language = ScriptServer::get_language(i);
+				}
+			}
+			if (!language)
+				return false;
+
+			String source = "extends Node\n"
+							"func run(n):\n"
+							"\tvar c = 0\n"
+							"\tfor i in range(n):\n";
+			source += "\t\tif $" + path_str + " != null:\n";
+			source += "\t\t\tc += 1\n"
+					  "\treturn c\n";
+
+			script_res = Ref<Script>(language->create_script());
+			script_res->set_source_code(source);
+			if (script_res->reload() != OK)
+				return false;
+
+			root->set_script(script_res.get_ref_ptr());
+		}
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		if (script) {
+			sink += (int64_t)root->call("run", p_iterations);
+			return;
+		}
+
+		for (int i = 0; i < p_iterations; i++) {
+			sink += root->get_node(path)->get_index();
+		}
+	}
+
+	virtual void teardown() {
+
+		if (root) {
+			root->set_script(RefPtr());
+			memdelete(root);
+			root = NULL;
+		}
+		script_res = Ref<Script>();
+	}
+
+	NodePathBenchmark(bool p_deep, bool p_script) {
+
+		deep = p_deep;
+		script = p_script;
+		root = NULL;
+	}
+};
+
+/* GridMap, a terrain surface two cells thick spanning a 512x512x512 region */
+
+class GridMapBenchmark : public Benchmark {
+
+public:
+	enum Test {
+		TEST_FILL, // one iteration sets every cell and rebuilds every octant
+		TEST_EDIT, // one iteration carves a 16x16x16 hole in the filled map and fills it back
+	};
+
+private:
+	Test test;
+	Node *grid_map;
+	Ref<MeshLibrary> library;
+	PoolVector<Vector3> cells;
+	PoolVector<int> items;
+
+	static int _get_height(int p_x, int p_z) {
+
+		return 256 + int(Math::sin(p_x * 0.05) * Math::cos(p_z * 0.05) * 128.0);
+	}
+
+	void _edit(int p_x, int p_z, int p_item) {
+
+		PoolVector<Vector3> edit_cells;
+		PoolVector<int> edit_items;
+		for (int x = -8; x < 8; x++) {
+			for (int z = -8; z < 8; z++) {
+				int h = _get_height(p_x + x, p_z + z);
+				for (int y = h - 1; y <= h; y++) {
+					edit_cells.push_back(Vector3(p_x + x, y, p_z + z));
+					edit_items.push_back(p_item);
+				}
+			}
+		}
+		grid_map->call("set_cells", edit_cells, edit_items);
+		MessageQueue::get_singleton()->flush();
+	}
+
+public:
+	virtual String get_name() const { return String("gridmap/") + (test == TEST_FILL ? "fill" : "edit") + "_512"; }
+
+	virtual bool setup() {
+
+		// GridMap is a module, which may not be built
+		grid_map = Object::cast_to<Node>(ClassDB::instance("GridMap"));
+		if (!grid_map)
+			return false;
+
+		Ref<CubeMesh> mesh;
+		mesh.instance();
+		Ref<BoxShape> shape;
+		shape.instance();
+
+		Vector<MeshLibrary::ShapeData> shapes;
+		MeshLibrary::ShapeData sd;
+		sd.shape = shape;
+		shapes.push_back(sd);
+
+		library.instance();
+		library->create_item(0);
+		library->set_item_mesh(0, mesh);
+		library->set_item_shapes(0, shapes);
+
+		grid_map->set("theme", library);
+		grid_map->set("cell_octant_size", 16);
+
+		for (int x = 0; x < 512; x++) {
+			for (int z = 0; z < 512; z++) {
+				int h = _get_height(x, z);
+				cells.push_back(Vector3(x, h - 1, z));
+				cells.push_back(Vector3(x, h, z));
+			}
+		}
+		items.resize(cells.size());
+		{
+			PoolVector<int>::Write w = items.write();
+			for (int i = 0; i < items.size(); i++) {
+				w[i] = 0;
+			}
+		}
+
+		if (test == TEST_EDIT) {
+			grid_map->call("set_cells", cells, items);
+			MessageQueue::get_singleton()->flush();
+		}
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+
+			if (test == TEST_FILL) {
+				grid_map->call("clear");
+				grid_map->call("set_cells", cells, items);
+				MessageQueue::get_singleton()->flush();
+			} else {
+				int x = 16 + (i * 37) % 480;
+				int z = 16 + (i * 91) % 480;
+				_edit(x, z, -1);
+				_edit(x, z, 0);
+			}
+		}
+
+		sink += grid_map->call("get_cell_item", 0, _get_height(0, 0), 0).operator int();
+	}
+
+	virtual void teardown() {
+
+		if (grid_map) {
+			memdelete(grid_map);
+			grid_map = NULL;
+		}
+		library = Ref<MeshLibrary>();
+		cells = PoolVector<Vector3>();
+		items = PoolVector<int>();
+	}
+
+	GridMapBenchmark(Test p_test) {
+
+		test = p_test;
+		grid_map = NULL;
+	}
+};
+
+/* AStar, on 4-connected square grids with every tenth point weighted */
+
+class AStarBenchmark : public Benchmark {
+
+public:
+	enum Query {
+		QUERY_PATH, // one iteration is a path between opposite corners
+		QUERY_CLOSEST_POINT, // one iteration is a closest point lookup
+		QUERY_BATCH, // one iteration is 64 paths between random points
+	};
+
+private:
+	int side;
+	Query query;
+	Ref<AStar> astar;
+	PoolVector<int> batch_from;
+	PoolVector<int> batch_to;
+
+public:
+	virtual String get_name() const {
+
+		static const char *query_names[] = { "path", "closest_point", "batch_64_paths" };
+		return "astar/grid_" + itos(side * side) + "_" + query_names[query];
+	}
+
+	virtual bool setup() {
+
+		astar.instance();
+		for (int y = 0; y < side; y++) {
+			for (int x = 0; x < side; x++) {
+				int id = y * side + x;
+				astar->add_point(id, Vector3(x, 0, y), id % 10 == 0 ? 3 : 1);
+				if (x > 0)
+					astar->connect_points(id, id - 1);
+				if (y > 0)
+					astar->connect_points(id, id - side);
+			}
+		}
+
+		for (int i = 0; i < 64; i++) {
+			batch_from.push_back(Math::rand() % (side * side));
+			batch_to.push_back(Math::rand() % (side * side));
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			switch (query) {
+				case QUERY_PATH: {
+					sink += astar->get_id_path(0, side * side - 1).size();
+				} break;
+				case QUERY_CLOSEST_POINT: {
+					sink += astar->get_closest_point(Vector3(Math::randf() * side, 1, Math::randf() * side));
+				} break;
+				case QUERY_BATCH: {
+					sink += astar->get_id_paths(batch_from, batch_to).size();
+				} break;
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		astar.unref();
+		batch_from.resize(0);
+		batch_to.resize(0);
+	}
+
+	AStarBenchmark(int p_side, Query p_query) {
+
+		side = p_side;
+		query = p_query;
+	}
+};
+
+#ifndef _3D_DISABLED
+
+/* Navigation, on square grid navmeshes with a few holes */
+
+class NavigationBenchmark : public Benchmark {
+
+public:
+	enum Query {
+		QUERY_PATH, // one iteration is a path between opposite corners
+		QUERY_CLOSEST_POINT, // one iteration is a closest point lookup
+		QUERY_BATCH, // one iteration is 200 paths between random points
+	};
+
+private:
+	int side;
+	Query query;
+	Navigation *navigation;
+	PoolVector<Vector3> batch_starts;
+	PoolVector<Vector3> batch_ends;
+
+public:
+	virtual String get_name() const {
+
+		static const char *query_names[] = { "path", "closest_point", "batch_200_paths" };
+		return "navigation/grid_" + itos(side * side) + "_" + query_names[query];
+	}
+
+	virtual bool setup() {
+
+		Ref<NavigationMesh> navmesh;
+		navmesh.instance();
+
+		PoolVector<Vector3> vertices;
+		vertices.resize((side + 1) * (side + 1));
+		{
+			PoolVector<Vector3>::Write w = vertices.write();
+			for (int y = 0; y <= side; y++) {
+				for (int x = 0; x <= side; x++) {
+					w[y * (side + 1) + x] = Vector3(x, 0, y);
+				}
+			}
+		}
+		navmesh->set_vertices(vertices);
+
+		for (int y = 0; y < side; y++) {
+			for (int x = 0; x < side; x++) {
+				if (x % 7 == 3 && y % 5 != 0)
+					continue; // walls with gaps, so paths have to turn
+				Vector<int> polygon;
+				polygon.push_back(y * (side + 1) + x);
+				polygon.push_back(y * (side + 1) + x + 1);
+				polygon.push_back((y + 1) * (side + 1) + x + 1);
+				polygon.push_back((y + 1) * (side + 1) + x);
+				navmesh->add_polygon(polygon);
+			}
+		}
+
+		navigation = memnew(Navigation);
+		navigation->navmesh_add(navmesh, Transform());
+
+		for (int i = 0; i < 200; i++) {
+			batch_starts.push_back(Vector3(Math::randf() * side, 0, Math::randf() * side));
+			batch_ends.push_back(Vector3(Math::randf() * side, 0, Math::randf() * side));
+		}
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			switch (query) {
+				case QUERY_PATH: {
+					sink += navigation->get_simple_path(Vector3(0.5, 0, 0.5), Vector3(side - 0.5, 0, side - 0.5)).size();
+				} break;
+				case QUERY_CLOSEST_POINT: {
+					sink += int(navigation->get_closest_point(Vector3(Math::randf() * side, 1, Math::randf() * side)).x);
+				} break;
+				case QUERY_BATCH: {
+					sink += navigation->get_simple_paths(batch_starts, batch_ends).size();
+				} break;
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		memdelete(navigation);
+		navigation = NULL;
+		batch_starts.resize(0);
+		batch_ends.resize(0);
+	}
+
+	NavigationBenchmark(int p_side, Query p_query) {
+
+		side = p_side;
+		query = p_query;
+		navigation = NULL;
+	}
+};
+
+/* VoxelLightBaker, on 64 blocks of different heights over a tessellated ground */
+
+// keeps its arrays on the CPU, so the bake works with any visual server
+class LightBakeMesh : public Mesh {
+
+	PoolVector<Vector3> vertices;
+	PoolVector<Vector3> normals;
+	PoolVector<Vector2> uvs;
+
+public:
+	virtual int get_surface_count() const { return 1; }
+	virtual int surface_get_array_len(int p_idx) const { return vertices.size(); }
+	virtual int surface_get_array_index_len(int p_idx) const { return 0; }
+	virtual Array surface_get_arrays(int p_surface) const {
+
+		Array arrays;
+		arrays.resize(ARRAY_MAX);
+		arrays[ARRAY_VERTEX] = vertices;
+		arrays[ARRAY_NORMAL] = normals;
+		arrays[ARRAY_TEX_UV] = uvs;
+		arrays[ARRAY_TEX_UV2] = uvs;
+		arrays[ARRAY_INDEX] = PoolVector<int>();
+		return arrays;
+	}
+	virtual Array surface_get_blend_shape_arrays(int p_surface) const { return Array(); }
+	virtual uint32_t surface_get_format(int p_idx) const { return ARRAY_FORMAT_VERTEX | ARRAY_FORMAT_NORMAL | ARRAY_FORMAT_TEX_UV | ARRAY_FORMAT_TEX_UV2; }
+	virtual PrimitiveType surface_get_primitive_type(int p_idx) const { return PRIMITIVE_TRIANGLES; }
+	virtual Ref<Material> surface_get_material(int p_idx) const { return Ref<Material>(); }
+	virtual int get_blend_shape_count() const { return 0; }
+	virtual StringName get_blend_shape_name(int p_index) const { return StringName(); }
+	virtual AABB get_aabb() const { return AABB(); }
+
+	void add_quad(const Vector3 &p_origin, const Vector3 &p_u, const Vector3 &p_v, const Vector2 &p_uv, const Vector2 &p_uv_size) {
+
+		static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+		Vector3 points[4] = { p_origin, p_origin + p_u, p_origin + p_u + p_v, p_origin + p_v };
+		Vector2 point_uvs[4] = { p_uv, p_uv + Vector2(p_uv_size.x, 0), p_uv + p_uv_size, p_uv + Vector2(0, p_uv_size.y) };
+		Vector3 normal = p_u.cross(p_v).normalized();
+
+		for (int i = 0; i < 6; i++) {
+			vertices.push_back(points[order[i]]);
+			normals.push_back(normal);
+			uvs.push_back(point_uvs[order[i]]);
+		}
+	}
+
+	void add_box(const Vector3 &p_origin, const Vector3 &p_size) {
+
+		Vector3 x(p_size.x, 0, 0);
+		Vector3 y(0, p_size.y, 0);
+		Vector3 z(0, 0, p_size.z);
+		Vector2 uv_size(0.01, 0.01);
+
+		add_quad(p_origin, z, y, Vector2(), uv_size);
+		add_quad(p_origin + x, y, z, Vector2(), uv_size);
+		add_quad(p_origin, x, z, Vector2(), uv_size);
+		add_quad(p_origin + y, z, x, Vector2(), uv_size);
+		add_quad(p_origin, y, x, Vector2(), uv_size);
+		add_quad(p_origin + z, x, y, Vector2(), uv_size);
+	}
+};
+
+class LightBakeBenchmark : public Benchmark {
+
+public:
+	enum Pass {
+		PASS_PLOT, // one iteration voxelizes the scene, as a GIProbe bake does
+		PASS_LIGHTS, // one iteration plots a directional light, 4 omni lights and 4 spot lights
+		PASS_LIGHTMAP, // one iteration bakes the 256x256 lightmap of the ground
+	};
+
+private:
+	Pass pass;
+	Ref<LightBakeMesh> ground;
+	Ref<LightBakeMesh> blocks;
+	VoxelLightBaker *baker;
+
+	void _plot_scene(VoxelLightBaker *p_baker) {
+
+		Vector<Ref<Material> > materials;
+		Ref<Mesh> ground_mesh = ground;
+		Ref<Mesh> blocks_mesh = blocks;
+
+		p_baker->begin_bake(7, AABB(Vector3(-16, -1, -16), Vector3(32, 32, 32)));
+		p_baker->plot_mesh(Transform(), ground_mesh, materials, Ref<Material>());
+		p_baker->plot_mesh(Transform(), blocks_mesh, materials, Ref<Material>());
+	}
+
+	void _plot_lights(VoxelLightBaker *p_baker) {
+
+		p_baker->plot_light_directional(Vector3(-0.3, -1, -0.2).normalized(), Color(1, 1, 1), 1, 1, true);
+		for (int i = 0; i < 4; i++) {
+			p_baker->plot_light_omni(Vector3(-12 + i * 8, 3, 0), Color(1, 0.5, 0.2), 1, 1, 10, 1, true);
+			p_baker->plot_light_spot(Vector3(0, 10, -12 + i * 8), Vector3(0, -1, 0), Color(0.2, 0.5, 1), 1, 1, 12, 1, 45, 1, true);
+		}
+	}
+
+public:
+	virtual String get_name() const {
+
+		static const char *pass_names[] = { "plot", "lights", "lightmap_256" };
+		return String("light_baker/") + pass_names[pass];
+	}
+
+	virtual bool setup() {
+
+		ground.instance();
+		for (int x = 0; x < 16; x++) {
+			for (int z = 0; z < 16; z++) {
+				ground->add_quad(Vector3(-16 + x * 2, 0, -16 + z * 2), Vector3(0, 0, 2), Vector3(2, 0, 0), Vector2(x, z) / 16.0, Vector2(1, 1) / 16.0);
+			}
+		}
+		ground->set_lightmap_size_hint(Vector2(256, 256));
+
+		blocks.instance();
+		for (int x = 0; x < 8; x++) {
+			for (int z = 0; z < 8; z++) {
+				blocks->add_box(Vector3(-15 + x * 4, 0, -15 + z * 4), Vector3(2, 1 + (x * 7 + z * 3) % 9, 2));
+			}
+		}
+
+		if (pass != PASS_PLOT) {
+			baker = memnew(VoxelLightBaker);
+			_plot_scene(baker);
+			baker->begin_bake_light(VoxelLightBaker::BAKE_QUALITY_LOW);
+		}
+		if (pass == PASS_LIGHTMAP) {
+			_plot_lights(baker);
+			baker->end_bake();
+		}
+
+		return true;
+	}
+
+	virtual void run(int p_iterations) {
+
+		for (int i = 0; i < p_iterations; i++) {
+			switch (pass) {
+				case PASS_PLOT: {
+					VoxelLightBaker plot_baker;
+					_plot_scene(&plot_baker);
+					plot_baker.end_bake();
+					sink += plot_baker.create_gi_probe_data().size();
+				} break;
+				case PASS_LIGHTS: {
+					_plot_lights(baker);
+					sink += i;
+				} break;
+				case PASS_LIGHTMAP: {
+					Ref<Mesh> ground_mesh = ground;
+					VoxelLightBaker::LightMapData data;
+					baker->make_lightmap(Transform(), ground_mesh, data);
+					sink += data.light.size();
+				} break;
+			}
+		}
+	}
+
+	virtual void teardown() {
+
+		if (baker) {
+			memdelete(baker);
+			baker = NULL;
+		}
+		ground = Ref<LightBakeMesh>();
+		blocks = Ref<LightBakeMesh>();
+	}
+
+	LightBakeBenchmark(Pass p_pass) {
+
+		pass = p_pass;
+		baker = NULL;
+	}
+};
+
+#endif
+
+static void register_benchmarks(BenchmarkRunner &r_runner) {
+
+	r_runner.add_function("variant/add_int", variant_add_int);
+	r_runner.add_function("variant/mul_vector3", variant_mul_vector3);
+	r_runner.add_function("variant/call_method", variant_call_method);
+	r_runner.add_function("variant/copy_string", variant_copy_string);
+
+	r_runner.add_function("string_name/from_string", string_name_from_string);
+	r_runner.add_function("string_name/compare", string_name_compare);
+	r_runner.add_function("string_name/search", string_name_search);
+
+	r_runner.add_function("string/single_chars_1000", string_single_chars);
+	r_runner.add_function("string/append_chars_1000", string_append_chars);
+	r_runner.add_function("string/to_upper_1000", string_to_upper);
+	r_runner.add_function("string/compare_1000", string_compare);
+	r_runner.add_function("string/find_1000", string_find);
+	r_runner.add_function("string/hash_1000", string_hash);
+	r_runner.add_function("string/utf8_1000", string_utf8);
+
+	r_runner.add_function("containers/vector_push_back_1000", containers_vector_push_back);
+	r_runner.add_function("containers/local_vector_push_back_1000", containers_local_vector_push_back);
+	r_runner.add_function("containers/vector_index_write_1000", containers_vector_index_write);
+	r_runner.add_function("containers/vector_write_handle_1000", containers_vector_write_handle);
+	r_runner.add_function("containers/hash_map_1000", containers_hash_map);
+	r_runner.add_function("containers/oa_hash_map_1000", containers_oa_hash_map);
+	r_runner.add_function("containers/swiss_hash_map_1000", containers_swiss_hash_map);
+	r_runner.add_function("containers/map_1000", containers_map);
+	r_runner.add_function("containers/dictionary_1000", containers_dictionary);
+
+	r_runner.add_function("marshalls/encode_100_entities", marshalls_encode);
+	r_runner.add_function("marshalls/encode_compact_100_entities", marshalls_encode_compact);
+
+	r_runner.add_benchmark(memnew(ScriptBenchmark("gdscript/loop_sum_1000",
+			"extends Reference\n"
+			"func run(n):\n"
+			"\tvar s = 0\n"
+			"\tfor i in range(n):\n"
+			"\t\ts += i\n"
+			"\treturn s\n",
+			1000)));
+	r_runner.add_benchmark(memnew(ScriptBenchmark("gdscript/fibonacci_15",
+			"extends Reference\n"
+			"func fib(n):\n"
+			"\tif n < 2:\n"
+			"\t\treturn n\n"
+			"\treturn fib(n - 1) + fib(n - 2)\n"
+			"func run(n):\n"
+			"\treturn fib(n)\n",
+			15)));
+	r_runner.add_benchmark(memnew(ScriptBenchmark("gdscript/vector_math_1000",
+			"extends Reference\n"
+			"func run(n):\n"
+			"\tvar v = Vector3(1, 2, 3)\n"
+			"\tvar acc = Vector3()\n"
+			"\tfor i in range(n):\n"
+			"\t\tacc += v.cross(acc + Vector3(0, 1, 0)).normalized() * 0.5\n"
+			"\treturn int(acc.length())\n",
+			1000)));
+	r_runner.add_benchmark(memnew(ScriptBenchmark("gdscript/dictionary_1000",
+			"extends Reference\n"
+			"func run(n):\n"
+			"\tvar d = {}\n"
+			"\tfor i in range(n):\n"
+			"\t\td[str(i)] = i\n"
+			"\tvar s = 0\n"
+			"\tfor k in d:\n"
+			"\t\ts += d[k]\n"
+			"\treturn s\n",
+			1000)));
+
+	r_runner.add_benchmark(memnew(SignalBenchmark(1, false)));
+	r_runner.add_benchmark(memnew(SignalBenchmark(10, false)));
+	r_runner.add_benchmark(memnew(SignalBenchmark(10, true)));
+
+	r_runner.add_benchmark(memnew(PhysicsStepBenchmark(256)));
+	r_runner.add_benchmark(memnew(PhysicsStepBenchmark(256, PhysicsStepBenchmark::GROUND_HEIGHT_MAP)));
+	r_runner.add_benchmark(memnew(PhysicsStepBenchmark(256, PhysicsStepBenchmark::GROUND_CONCAVE)));
+	r_runner.add_benchmark(memnew(PhysicsStackBenchmark(16, 8, false)));
+	r_runner.add_benchmark(memnew(PhysicsStackBenchmark(16, 8, true)));
+	r_runner.add_benchmark(memnew(PhysicsQueryBenchmark(PhysicsQueryBenchmark::QUERY_RAY)));
+	r_runner.add_benchmark(memnew(PhysicsQueryBenchmark(PhysicsQueryBenchmark::QUERY_RAY_BATCH)));
+	r_runner.add_benchmark(memnew(PhysicsQueryBenchmark(PhysicsQueryBenchmark::QUERY_SHAPE_BATCH)));
+	r_runner.add_benchmark(memnew(TriangleMeshBenchmark(128, TriangleMeshBenchmark::TEST_BVH_BUILD)));
+	r_runner.add_benchmark(memnew(TriangleMeshBenchmark(512, TriangleMeshBenchmark::TEST_BVH_BUILD)));
+	r_runner.add_benchmark(memnew(TriangleMeshBenchmark(128, TriangleMeshBenchmark::TEST_MESH_BUILD)));
+	r_runner.add_benchmark(memnew(TriangleMeshBenchmark(512, TriangleMeshBenchmark::TEST_SEGMENTS)));
+
+	r_runner.add_benchmark(memnew(InstanceBenchmark(100)));
+	r_runner.add_benchmark(memnew(InstanceBenchmark(20, 500)));
+	r_runner.add_benchmark(memnew(LoadBenchmark("tscn", 500)));
+	r_runner.add_benchmark(memnew(LoadBenchmark("scn", 500)));
+	r_runner.add_benchmark(memnew(TextParseBenchmark(100, true)));
+	r_runner.add_benchmark(memnew(TextParseBenchmark(100, false)));
+
+	for (int i = 0; i < AudioMixKernels::IMPLEMENTATION_MAX; i++) {
+		r_runner.add_benchmark(memnew(AudioMixBenchmark(200, AudioMixKernels::Implementation(i))));
+	}
+
+	for (int i = 4; i <= 16; i *= 2) {
+		r_runner.add_benchmark(memnew(AudioBusBenchmark(i, 0)));
+		r_runner.add_benchmark(memnew(AudioBusBenchmark(i, 3)));
+	}
+
+	r_runner.add_benchmark(memnew(SceneFrameBenchmark(1000)));
+	r_runner.add_benchmark(memnew(SceneFrameBenchmark(10000)));
+	r_runner.add_benchmark(memnew(SceneFrameBenchmark(100000)));
+	r_runner.add_benchmark(memnew(GroupCallBenchmark(10000, false)));
+	r_runner.add_benchmark(memnew(GroupCallBenchmark(10000, true)));
+	r_runner.add_benchmark(memnew(ProcessFrameBenchmark(100000, 0)));
+	r_runner.add_benchmark(memnew(ProcessFrameBenchmark(100000, 100)));
+	r_runner.add_benchmark(memnew(NodePathBenchmark(false, false)));
+	r_runner.add_benchmark(memnew(NodePathBenchmark(true, false)));
+	r_runner.add_benchmark(memnew(NodePathBenchmark(false, true)));
+	r_runner.add_benchmark(memnew(NodePathBenchmark(true, true)));
+	r_runner.add_benchmark(memnew(GridMapBenchmark(GridMapBenchmark::TEST_FILL)));
+	r_runner.add_benchmark(memnew(GridMapBenchmark(GridMapBenchmark::TEST_EDIT)));
+
+	r_runner.add_benchmark(memnew(AStarBenchmark(100, AStarBenchmark::QUERY_PATH)));
+	r_runner.add_benchmark(memnew(AStarBenchmark(316, AStarBenchmark::QUERY_PATH)));
+	r_runner.add_benchmark(memnew(AStarBenchmark(1000, AStarBenchmark::QUERY_PATH)));
+	r_runner.add_benchmark(memnew(AStarBenchmark(316, AStarBenchmark::QUERY_CLOSEST_POINT)));
+	r_runner.add_benchmark(memnew(AStarBenchmark(1000, AStarBenchmark::QUERY_CLOSEST_POINT)));
+	r_runner.add_benchmark(memnew(AStarBenchmark(316, AStarBenchmark::QUERY_BATCH)));
+
+#ifndef _3D_DISABLED
+	r_runner.add_benchmark(memnew(NavigationBenchmark(100, NavigationBenchmark::QUERY_PATH)));
+	r_runner.add_benchmark(memnew(NavigationBenchmark(316, NavigationBenchmark::QUERY_PATH)));
+	r_runner.add_benchmark(memnew(NavigationBenchmark(316, NavigationBenchmark::QUERY_CLOSEST_POINT)));
+	r_runner.add_benchmark(memnew(NavigationBenchmark(316, NavigationBenchmark::QUERY_BATCH)));
+	r_runner.add_benchmark(memnew(LightBakeBenchmark(LightBakeBenchmark::PASS_PLOT)));
+	r_runner.add_benchmark(memnew(LightBakeBenchmark(LightBakeBenchmark::PASS_LIGHTS)));
+	r_runner.add_benchmark(memnew(LightBakeBenchmark(LightBakeBenchmark::PASS_LIGHTMAP)));
+#endif
+}
+
+MainLoop *test(const List<String> &p_args) {
+
+	BenchmarkRunner runner;
+	runner.parse_arguments(p_args);
+	register_benchmarks(runner);
+	runner.run();
+
+	return NULL;
+}
+} // namespace TestBenchmark
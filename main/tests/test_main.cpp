@@ -33,17 +33,23 @@
 
 #ifdef DEBUG_ENABLED
 
+#include "test_astar.h"
+#include "test_audio_stream.h"
+#include "test_benchmark.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_image.h"
 #include "test_io.h"
+#include "test_marshalls.h"
 #include "test_math.h"
+#include "test_node.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
 #include "test_shader_lang.h"
+#include "test_shapes.h"
 #include "test_string.h"
 
 const char **tests_get_names() {
@@ -59,6 +65,12 @@ const char **tests_get_names() {
 		"shaderlang",
 		"physics",
 		"oa_hash_map",
+		"marshalls",
+		"astar",
+		"shapes",
+		"node",
+		"audio_stream",
+		"benchmark",
 		NULL
 	};
 
@@ -97,6 +109,36 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestOAHashMap::test();
 	}
 
+	if (p_test == "marshalls") {
+
+		return TestMarshalls::test();
+	}
+
+	if (p_test == "astar") {
+
+		return TestAStar::test();
+	}
+
+	if (p_test == "shapes") {
+
+		return TestShapes::test();
+	}
+
+	if (p_test == "node") {
+
+		return TestNode::test();
+	}
+
+	if (p_test == "audio_stream") {
+
+		return TestAudioStream::test();
+	}
+
+	if (p_test == "benchmark") {
+
+		return TestBenchmark::test(p_args);
+	}
+
 #ifndef _3D_DISABLED
 	if (p_test == "gui") {
 
@@ -0,0 +1,293 @@
+/*************************************************************************/
+/*  test_marshalls.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_marshalls.h"
+
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+
+namespace TestMarshalls {
+
+static Dictionary _make_save_game() {
+
+	Dictionary save;
+	save["name"] = "Player";
+	save["level"] = 12;
+	save["gold"] = -4096;
+	save["play_time"] = 3723.25;
+	save["hardcore"] = true;
+	save["position"] = Vector3(10.5, 0, -3);
+	save["transform"] = Transform(Basis(Vector3(0, 1, 0), 0.5), Vector3(1, 2, 3));
+	save["tint"] = Color(1, 0.5, 0.25);
+	save["path"] = NodePath("Level/Enemies:position");
+
+	Array inventory;
+	for (int i = 0; i < 32; i++) {
+		Dictionary item;
+		item["id"] = i;
+		item["count"] = i * 3;
+		item["label"] = "item_" + itos(i);
+		item["equipped"] = (i % 4) == 0;
+		inventory.push_back(item);
+	}
+	save["inventory"] = inventory;
+
+	PoolVector<int> flags;
+	PoolVector<Vector2> waypoints;
+	PoolVector<String> unlocked;
+	for (int i = 0; i < 64; i++) {
+		flags.push_back(i * 37);
+		waypoints.push_back(Vector2(i, -i * 0.5));
+		unlocked.push_back("zone_" + itos(i));
+	}
+	save["flags"] = flags;
+	save["waypoints"] = waypoints;
+	save["unlocked"] = unlocked;
+
+	return save;
+}
+
+static bool _roundtrip(const Variant &p_value, const MarshallKeyTable *p_key_table = NULL) {
+
+	Vector<uint8_t> buffer;
+	int len = 0;
+	if (encode_variant_compact(p_value, buffer, len, 0, p_key_table) != OK)
+		return false;
+
+	Variant decoded;
+	int read = 0;
+	if (decode_variant_compact(decoded, buffer.ptr(), len, &read, p_key_table) != OK)
+		return false;
+
+	// containers compare by reference, so compare their text form
+	return read == len && decoded.get_type() == p_value.get_type() && String(decoded) == String(p_value);
+}
+
+bool test_scalars() {
+
+	bool ok = true;
+	ok = ok && _roundtrip(Variant());
+	ok = ok && _roundtrip(true);
+	ok = ok && _roundtrip(false);
+	ok = ok && _roundtrip(0);
+	ok = ok && _roundtrip(-1);
+	ok = ok && _roundtrip((int64_t)0x7FFFFFFFFFFFFFFFLL);
+	ok = ok && _roundtrip((int64_t)(-0x7FFFFFFFFFFFFFFFLL - 1));
+	ok = ok && _roundtrip(0.1);
+	ok = ok && _roundtrip(1.5);
+	ok = ok && _roundtrip(String());
+	ok = ok && _roundtrip(String::utf8("Godot \xe6\x97\xa5\xe6\x9c\xac"));
+	return ok;
+}
+
+bool test_math_types() {
+
+	bool ok = true;
+	ok = ok && _roundtrip(Vector2(1, -2));
+	ok = ok && _roundtrip(Rect2(1, 2, 3, 4));
+	ok = ok && _roundtrip(Vector3(1, 2, 3));
+	ok = ok && _roundtrip(Transform2D(0.3, Vector2(5, 6)));
+	ok = ok && _roundtrip(Plane(0, 1, 0, 4));
+	ok = ok && _roundtrip(Quat(0, 0, 0, 1));
+	ok = ok && _roundtrip(AABB(Vector3(1, 2, 3), Vector3(4, 5, 6)));
+	ok = ok && _roundtrip(Basis(Vector3(1, 0, 0), 0.25));
+	ok = ok && _roundtrip(Transform(Basis(), Vector3(7, 8, 9)));
+	ok = ok && _roundtrip(Color(0.1, 0.2, 0.3, 0.4));
+	ok = ok && _roundtrip(NodePath("/root/Node:property"));
+	return ok;
+}
+
+bool test_containers() {
+
+	return _roundtrip(_make_save_game());
+}
+
+bool test_key_table() {
+
+	MarshallKeyTable table;
+	table.add_key("name");
+	table.add_key("level");
+	table.add_key("inventory");
+	table.add_key("id");
+	table.add_key("count");
+
+	Dictionary save = _make_save_game();
+
+	Vector<uint8_t> plain;
+	Vector<uint8_t> keyed;
+	int plain_len = 0;
+	int keyed_len = 0;
+	encode_variant_compact(save, plain, plain_len);
+	encode_variant_compact(save, keyed, keyed_len, 0, &table);
+
+	return keyed_len < plain_len && _roundtrip(save, &table);
+}
+
+bool test_legacy_decode() {
+
+	// decode_variant must accept both formats
+	Dictionary save = _make_save_game();
+
+	Vector<uint8_t> buffer;
+	int len = 0;
+	encode_variant_compact(save, buffer, len, 4);
+
+	Variant decoded;
+	int read = 0;
+	Error err = decode_variant(decoded, buffer.ptr() + 4, len, &read);
+
+	return err == OK && read == len && String(decoded) == String(Variant(save));
+}
+
+bool test_truncated() {
+
+	Vector<uint8_t> buffer;
+	int len = 0;
+	encode_variant_compact(_make_save_game(), buffer, len);
+
+	// every prefix must fail cleanly instead of reading past the end
+	for (int i = 0; i < len; i++) {
+		Variant decoded;
+		if (decode_variant_compact(decoded, buffer.ptr(), i) == OK)
+			return false;
+	}
+	return true;
+}
+
+static Vector<uint8_t> _make_nested_arrays(int p_depth) {
+
+	Vector<uint8_t> buffer;
+	buffer.push_back(0xFF); // compact marker
+	for (int i = 0; i < p_depth; i++) {
+		buffer.push_back(Variant::ARRAY);
+		buffer.push_back(1); // element count
+	}
+	buffer.push_back(Variant::NIL);
+	return buffer;
+}
+
+bool test_nesting_limit() {
+
+	// reasonable nesting decodes, hostile nesting must fail instead of overflowing the stack
+	Vector<uint8_t> shallow = _make_nested_arrays(64);
+	Variant decoded;
+	if (decode_variant_compact(decoded, shallow.ptr(), shallow.size()) != OK)
+		return false;
+
+	Vector<uint8_t> deep = _make_nested_arrays(100000);
+	return decode_variant_compact(decoded, deep.ptr(), deep.size()) == ERR_INVALID_DATA;
+}
+
+bool test_benchmark() {
+
+	const int iterations = 2000;
+	Dictionary save = _make_save_game();
+
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	int legacy_len = 0;
+	Vector<uint8_t> legacy;
+	for (int i = 0; i < iterations; i++) {
+		encode_variant(save, NULL, legacy_len);
+		legacy.resize(legacy_len);
+		encode_variant(save, legacy.ptrw(), legacy_len);
+	}
+	uint64_t legacy_encode = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Variant v;
+		decode_variant(v, legacy.ptr(), legacy_len);
+	}
+	uint64_t legacy_decode = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	int compact_len = 0;
+	Vector<uint8_t> compact;
+	for (int i = 0; i < iterations; i++) {
+		encode_variant_compact(save, compact, compact_len);
+	}
+	uint64_t compact_encode = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Variant v;
+		decode_variant_compact(v, compact.ptr(), compact_len);
+	}
+	uint64_t compact_decode = OS::get_singleton()->get_ticks_usec() - t;
+
+	OS::get_singleton()->print("\tlegacy:  %d bytes, encode %d usec, decode %d usec\n", legacy_len, (int)legacy_encode, (int)legacy_decode);
+	OS::get_singleton()->print("\tcompact: %d bytes, encode %d usec, decode %d usec\n", compact_len, (int)compact_encode, (int)compact_decode);
+
+	return compact_len < legacy_len;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_scalars,
+	test_math_types,
+	test_containers,
+	test_key_table,
+	test_legacy_decode,
+	test_truncated,
+	test_nesting_limit,
+	test_benchmark,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestMarshalls
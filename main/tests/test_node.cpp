@@ -0,0 +1,134 @@
+/*************************************************************************/
+/*  test_node.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_node.h"
+
+#include "core/os/os.h"
+#include "scene/main/node.h"
+
+namespace TestNode {
+
+static Node *_make_node(const String &p_name) {
+
+	Node *node = memnew(Node);
+	node->set_name(p_name);
+	return node;
+}
+
+static bool _check_same_name_children(int p_siblings, bool p_readable) {
+
+	Node::set_human_readable_collision_renaming(p_readable);
+
+	// enough siblings make the parent look children up by name through its index
+	Node *parent = memnew(Node);
+	for (int i = 0; i < p_siblings; i++) {
+		parent->add_child(_make_node("Sibling" + itos(i)));
+	}
+
+	bool pass = true;
+	const StringName dup = "Dup";
+
+	Node *first = _make_node(dup);
+	Node *second = _make_node(dup);
+	parent->add_child(first);
+	parent->add_child(second);
+
+	pass = pass && first->get_name() == dup;
+	pass = pass && second->get_name() != dup;
+	pass = pass && parent->get_node(NodePath(dup)) == first;
+	pass = pass && parent->get_node(NodePath(String(second->get_name()))) == second;
+
+	// the first child with a name must not mistake itself for a duplicate
+	first->set_name(dup);
+	pass = pass && first->get_name() == dup;
+
+	second->set_name(dup);
+	pass = pass && second->get_name() != dup;
+	pass = pass && parent->get_node(NodePath(dup)) == first;
+
+	// once the name is free, the other child can take it
+	parent->remove_child(first);
+	second->set_name(dup);
+	pass = pass && second->get_name() == dup;
+	pass = pass && parent->get_node(NodePath(dup)) == second;
+
+	memdelete(first);
+	memdelete(parent);
+
+	Node::set_human_readable_collision_renaming(false);
+
+	return pass;
+}
+
+bool test_serial_child_names() {
+
+	bool pass = true;
+	pass = _check_same_name_children(0, false) && pass;
+	pass = _check_same_name_children(0, true) && pass;
+	pass = _check_same_name_children(40, false) && pass;
+	pass = _check_same_name_children(40, true) && pass;
+	return pass;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_serial_child_names,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestNode
@@ -32,7 +32,9 @@
 
 #include "core/os/os.h"
 
+#include "core/hash_map.h"
 #include "core/oa_hash_map.h"
+#include "core/swiss_hash_map.h"
 
 namespace TestOAHashMap {
 
@@ -92,6 +94,97 @@ MainLoop *test() {
 		}
 	}
 
+	// SwissHashMap: insertion, erase with tombstones, reinsertion
+	{
+		SwissHashMap<int, int> map;
+
+		for (int i = 0; i < 5000; i++) {
+			map[i] = i * 2;
+		}
+
+		for (int i = 0; i < 5000; i += 2) {
+			map.erase(i);
+		}
+
+		for (int i = 0; i < 5000; i += 4) {
+			map.set(i, i * 3);
+		}
+
+		uint32_t num_elems = 0;
+		bool values_ok = true;
+		for (int i = 0; i < 5000; i++) {
+			const int *value = map.getptr(i);
+			if (!value) {
+				values_ok = values_ok && (i % 2 == 0 && i % 4 != 0);
+				continue;
+			}
+			num_elems++;
+			values_ok = values_ok && *value == ((i % 4 == 0) ? i * 3 : i * 2);
+		}
+
+		uint32_t iterated = 0;
+		const int *k = NULL;
+		while ((k = map.next(k))) {
+			iterated++;
+		}
+
+		OS::get_singleton()->print("swiss elements %d == %d == %d, values %s, capacity %d.\n", map.size(), num_elems, iterated, values_ok ? "ok" : "WRONG", map.get_capacity());
+	}
+
+	// lookup speed of StringName keys, the ClassDB/Object::signal_map use case
+	{
+		const int key_count = 64;
+		const int rounds = 20000;
+
+		Vector<StringName> keys;
+		for (int i = 0; i < key_count; i++) {
+			keys.push_back(StringName("method_" + itos(i)));
+		}
+
+		HashMap<StringName, int, StringNameHasher> hash_map;
+		OAHashMap<StringName, int, 64, StringNameHasher> oa_hash_map;
+		SwissHashMap<StringName, int, StringNameHasher> swiss_hash_map;
+
+		for (int i = 0; i < key_count; i++) {
+			hash_map[keys[i]] = i;
+			oa_hash_map.set(keys[i], i);
+			swiss_hash_map[keys[i]] = i;
+		}
+
+		int64_t sum = 0;
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int r = 0; r < rounds; r++) {
+			for (int i = 0; i < key_count; i++) {
+				sum += *hash_map.getptr(keys[i]);
+			}
+		}
+		uint64_t hash_map_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int r = 0; r < rounds; r++) {
+			for (int i = 0; i < key_count; i++) {
+				int value;
+				oa_hash_map.lookup(keys[i], &value);
+				sum += value;
+			}
+		}
+		uint64_t oa_hash_map_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int r = 0; r < rounds; r++) {
+			for (int i = 0; i < key_count; i++) {
+				sum += *swiss_hash_map.getptr(keys[i]);
+			}
+		}
+		uint64_t swiss_hash_map_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		OS::get_singleton()->print("%d StringName lookups (checksum %d):\n", key_count * rounds, (int)(sum / 3));
+		OS::get_singleton()->print("\tHashMap      %d usec\n", (int)hash_map_usec);
+		OS::get_singleton()->print("\tOAHashMap    %d usec\n", (int)oa_hash_map_usec);
+		OS::get_singleton()->print("\tSwissHashMap %d usec\n", (int)swiss_hash_map_usec);
+	}
+
 	return NULL;
 }
 } // namespace TestOAHashMap
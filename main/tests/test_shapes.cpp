@@ -0,0 +1,543 @@
+/*************************************************************************/
+/*  test_shapes.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_shapes.h"
+
+#include "core/math/geometry.h"
+#include "core/math/triangle_bvh.h"
+#include "core/math/triangle_mesh.h"
+#include "core/os/os.h"
+#include "servers/physics/shape_sw.h"
+
+namespace TestShapes {
+
+static const int map_width = 67;
+static const int map_depth = 45;
+static const real_t map_cell_size = 1.5;
+
+static PoolVector<real_t> _make_heights() {
+
+	PoolVector<real_t> heights;
+	heights.resize(map_width * map_depth);
+	PoolVector<real_t>::Write w = heights.write();
+	for (int z = 0; z < map_depth; z++) {
+		for (int x = 0; x < map_width; x++) {
+			w[z * map_width + x] = Math::sin(x * 0.3) * 3 + Math::cos(z * 0.2) * 5 + Math::randf();
+		}
+	}
+	return heights;
+}
+
+static HeightMapShapeSW *_make_height_map(const PoolVector<real_t> &p_heights) {
+
+	Dictionary d;
+	d["width"] = map_width;
+	d["depth"] = map_depth;
+	d["cell_size"] = map_cell_size;
+	d["heights"] = p_heights;
+
+	HeightMapShapeSW *shape = memnew(HeightMapShapeSW);
+	shape->set_data(d);
+	return shape;
+}
+
+// the same terrain as triangles, centered and split the way the height map documents it
+static PoolVector<Vector3> _make_faces(const PoolVector<real_t> &p_heights) {
+
+	PoolVector<real_t>::Read r = p_heights.read();
+	PoolVector<Vector3> faces;
+
+	for (int z = 0; z < map_depth - 1; z++) {
+		for (int x = 0; x < map_width - 1; x++) {
+
+			Vector3 p[4];
+			for (int i = 0; i < 4; i++) {
+				int px = x + (i & 1);
+				int pz = z + (i >> 1);
+				p[i] = Vector3((px - (map_width - 1) * 0.5) * map_cell_size, r[pz * map_width + px], (pz - (map_depth - 1) * 0.5) * map_cell_size);
+			}
+
+			faces.push_back(p[0]);
+			faces.push_back(p[1]);
+			faces.push_back(p[2]);
+			faces.push_back(p[1]);
+			faces.push_back(p[3]);
+			faces.push_back(p[2]);
+		}
+	}
+
+	return faces;
+}
+
+static Vector3 _random_point(real_t p_margin) {
+
+	real_t w = (map_width - 1) * map_cell_size + p_margin * 2;
+	real_t d = (map_depth - 1) * map_cell_size + p_margin * 2;
+	return Vector3(Math::randf() * w - w * 0.5, Math::randf() * 24 - 12, Math::randf() * d - d * 0.5);
+}
+
+static void _collect_faces(void *p_userdata, ShapeSW *p_shape) {
+
+	FaceShapeSW *face = static_cast<FaceShapeSW *>(p_shape);
+	Vector<Face3> *faces = (Vector<Face3> *)p_userdata;
+	faces->push_back(Face3(face->vertex[0], face->vertex[1], face->vertex[2]));
+}
+
+bool test_height_map_cull() {
+
+	PoolVector<real_t> heights = _make_heights();
+	HeightMapShapeSW *height_map = _make_height_map(heights);
+	ConcavePolygonShapeSW *concave = memnew(ConcavePolygonShapeSW);
+	concave->set_data(_make_faces(heights));
+
+	bool pass = height_map->get_aabb() == concave->get_aabb();
+
+	for (int i = 0; i < 500 && pass; i++) {
+
+		AABB aabb(_random_point(5), Vector3(Math::randf() * 8, Math::randf() * 8, Math::randf() * 8));
+
+		Vector<Face3> found;
+		height_map->cull(aabb, _collect_faces, &found);
+		Vector<Face3> expected;
+		concave->cull(aabb, _collect_faces, &expected);
+
+		// the height map may report whole cells, but never misses a triangle
+		for (int j = 0; j < expected.size() && pass; j++) {
+
+			bool has = false;
+			for (int k = 0; k < found.size() && !has; k++) {
+				has = found[k].vertex[0] == expected[j].vertex[0] && found[k].vertex[1] == expected[j].vertex[1] && found[k].vertex[2] == expected[j].vertex[2];
+			}
+			pass = has;
+		}
+
+		for (int j = 0; j < found.size() && pass; j++) {
+			pass = found[j].get_plane().normal.y > 0;
+		}
+	}
+
+	memdelete(height_map);
+	memdelete(concave);
+	return pass;
+}
+
+bool test_height_map_segment() {
+
+	PoolVector<real_t> heights = _make_heights();
+	HeightMapShapeSW *height_map = _make_height_map(heights);
+	ConcavePolygonShapeSW *concave = memnew(ConcavePolygonShapeSW);
+	concave->set_data(_make_faces(heights));
+
+	bool pass = true;
+	int hits = 0;
+
+	for (int i = 0; i < 1000 && pass; i++) {
+
+		Vector3 from = _random_point(10);
+		Vector3 to = i % 2 ? _random_point(10) : from + Vector3(Math::randf() * 10 - 5, -40, Math::randf() * 10 - 5);
+		if (i % 2 == 0)
+			from.y = 30;
+
+		Vector3 point, normal;
+		Vector3 expected_point, expected_normal;
+		bool hit = height_map->intersect_segment(from, to, point, normal);
+		bool expected_hit = concave->intersect_segment(from, to, expected_point, expected_normal);
+
+		pass = hit == expected_hit;
+		if (pass && hit) {
+			hits++;
+			pass = point.distance_to(expected_point) < 0.001 && normal.distance_to(expected_normal) < 0.001;
+		}
+	}
+
+	memdelete(height_map);
+	memdelete(concave);
+	return pass && hits > 0;
+}
+
+bool test_height_map_closest_point() {
+
+	PoolVector<real_t> heights = _make_heights();
+	HeightMapShapeSW *height_map = _make_height_map(heights);
+	PoolVector<Vector3> faces = _make_faces(heights);
+	PoolVector<Vector3>::Read r = faces.read();
+
+	bool pass = true;
+
+	for (int i = 0; i < 200 && pass; i++) {
+
+		Vector3 point = _random_point(20);
+
+		real_t expected = 1e20;
+		for (int j = 0; j < faces.size(); j += 3) {
+			expected = MIN(expected, Face3(r[j], r[j + 1], r[j + 2]).get_closest_point_to(point).distance_to(point));
+		}
+
+		pass = Math::abs(height_map->get_closest_point_to(point).distance_to(point) - expected) < 0.001;
+	}
+
+	memdelete(height_map);
+	return pass;
+}
+
+bool test_height_map_point() {
+
+	PoolVector<real_t> heights = _make_heights();
+	HeightMapShapeSW *height_map = _make_height_map(heights);
+
+	bool pass = true;
+
+	for (int i = 0; i < 1000 && pass; i++) {
+
+		Vector3 point = _random_point(5);
+		AABB aabb = height_map->get_aabb();
+
+		// inside is under the surface, within the bounds of the height map
+		Vector3 hit, normal;
+		bool expected = aabb.has_point(point) && height_map->intersect_segment(point, Vector3(point.x, aabb.position.y + aabb.size.y + 1, point.z), hit, normal);
+		pass = height_map->intersect_point(point) == expected;
+	}
+
+	memdelete(height_map);
+	return pass;
+}
+
+bool test_height_map_data() {
+
+	PoolVector<real_t> heights = _make_heights();
+	HeightMapShapeSW *height_map = _make_height_map(heights);
+
+	Dictionary d = height_map->get_data();
+	PoolVector<real_t> data = d["heights"];
+	bool pass = int(d["width"]) == map_width && int(d["depth"]) == map_depth && real_t(d["cell_size"]) == map_cell_size && data.size() == heights.size();
+
+	// a single point still makes a valid, empty shape
+	PoolVector<real_t> single;
+	single.push_back(2);
+	d["width"] = 1;
+	d["depth"] = 1;
+	d["heights"] = single;
+	height_map->set_data(d);
+
+	Vector3 point, normal;
+	pass = pass && !height_map->intersect_segment(Vector3(0, 10, 0), Vector3(0, -10, 0), point, normal);
+	pass = pass && height_map->get_aabb().position.y == 2;
+
+	memdelete(height_map);
+	return pass;
+}
+
+// closest hit the way ConcavePolygonShapeSW reports it, by testing every face
+static bool _brute_force_segment(const PoolVector<Vector3> &p_faces, const Vector3 &p_from, const Vector3 &p_to, Vector3 &r_point) {
+
+	PoolVector<Vector3>::Read r = p_faces.read();
+	Vector3 dir = (p_to - p_from).normalized();
+	real_t min_d = 1e20;
+	bool found = false;
+
+	for (int i = 0; i < p_faces.size(); i += 3) {
+
+		Vector3 res;
+		if (Geometry::segment_intersects_triangle(p_from, p_to, r[i], r[i + 1], r[i + 2], &res)) {
+
+			real_t d = dir.dot(res) - dir.dot(p_from);
+			if (d > 0 && d < min_d) {
+				min_d = d;
+				r_point = res;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+bool test_concave_segment() {
+
+	PoolVector<Vector3> faces = _make_faces(_make_heights());
+	ConcavePolygonShapeSW *concave = memnew(ConcavePolygonShapeSW);
+	concave->set_data(faces);
+
+	bool pass = true;
+	int hits = 0;
+
+	for (int i = 0; i < 300 && pass; i++) {
+
+		Vector3 from = _random_point(10);
+		Vector3 to = i % 2 ? _random_point(10) : from + Vector3(Math::randf() * 10 - 5, -40, Math::randf() * 10 - 5);
+
+		Vector3 point, normal;
+		Vector3 expected_point;
+		bool hit = concave->intersect_segment(from, to, point, normal);
+		bool expected_hit = _brute_force_segment(faces, from, to, expected_point);
+
+		pass = hit == expected_hit;
+		if (pass && hit) {
+			hits++;
+			pass = point.distance_to(expected_point) < 0.001;
+		}
+	}
+
+	memdelete(concave);
+	return pass && hits > 0;
+}
+
+bool test_concave_cull() {
+
+	PoolVector<Vector3> faces = _make_faces(_make_heights());
+	ConcavePolygonShapeSW *concave = memnew(ConcavePolygonShapeSW);
+	concave->set_data(faces);
+	PoolVector<Vector3>::Read r = faces.read();
+
+	bool pass = true;
+
+	for (int i = 0; i < 300 && pass; i++) {
+
+		AABB aabb(_random_point(5), Vector3(Math::randf() * 8, Math::randf() * 8, Math::randf() * 8));
+
+		Vector<Face3> found;
+		concave->cull(aabb, _collect_faces, &found);
+
+		int expected = 0;
+		for (int j = 0; j < faces.size(); j += 3) {
+			if (Face3(r[j], r[j + 1], r[j + 2]).get_aabb().intersects(aabb))
+				expected++;
+		}
+
+		pass = found.size() == expected;
+	}
+
+	memdelete(concave);
+	return pass;
+}
+
+bool test_concave_bvh_data() {
+
+	PoolVector<Vector3> faces = _make_faces(_make_heights());
+	PoolVector<Vector3>::Read r = faces.read();
+
+	Vector<AABB> aabbs;
+	for (int i = 0; i < faces.size(); i += 3) {
+		aabbs.push_back(Face3(r[i], r[i + 1], r[i + 2]).get_aabb());
+	}
+	TriangleBVH bvh;
+	bvh.build(aabbs.ptr(), aabbs.size());
+	PoolVector<uint8_t> data = bvh.serialize();
+
+	TriangleBVH loaded;
+	bool pass = loaded.deserialize(data, aabbs.ptr(), aabbs.size()) && loaded.get_node_count() == bvh.get_node_count();
+
+	// the copy owns its own nodes
+	TriangleBVH copy = loaded;
+	loaded.clear();
+	pass = pass && copy.get_node_count() == bvh.get_node_count() && copy.get_primitive_count() == aabbs.size();
+
+	// data saved for other faces has to be rejected
+	Vector<AABB> moved = aabbs;
+	AABB shifted = moved[moved.size() / 2];
+	shifted.position.y += 10.0;
+	moved.set(moved.size() / 2, shifted);
+	pass = pass && !loaded.deserialize(data, moved.ptr(), moved.size());
+	pass = pass && !loaded.deserialize(data, aabbs.ptr(), aabbs.size() - 1);
+
+	// a stored tree and a broken one both have to give the same results as a built one
+	PoolVector<uint8_t> broken = data;
+	broken.set(broken.size() - 8, 0xFF);
+	broken.set(broken.size() - 5, 0x7F);
+
+	ConcavePolygonShapeSW *built = memnew(ConcavePolygonShapeSW);
+	built->set_data(faces);
+
+	ConcavePolygonShapeSW *stored = memnew(ConcavePolygonShapeSW);
+	Dictionary d;
+	d["faces"] = faces;
+	d["bvh"] = data;
+	stored->set_data(d);
+
+	ConcavePolygonShapeSW *rebuilt = memnew(ConcavePolygonShapeSW);
+	d["bvh"] = broken;
+	rebuilt->set_data(d);
+
+	for (int i = 0; i < 200 && pass; i++) {
+
+		Vector3 from = _random_point(10);
+		Vector3 to = _random_point(10);
+
+		Vector3 point, normal;
+		Vector3 stored_point, stored_normal;
+		Vector3 rebuilt_point, rebuilt_normal;
+		bool hit = built->intersect_segment(from, to, point, normal);
+		pass = stored->intersect_segment(from, to, stored_point, stored_normal) == hit;
+		pass = pass && rebuilt->intersect_segment(from, to, rebuilt_point, rebuilt_normal) == hit;
+		pass = pass && (!hit || (point == stored_point && point == rebuilt_point));
+	}
+
+	memdelete(built);
+	memdelete(stored);
+	memdelete(rebuilt);
+	return pass;
+}
+
+bool test_triangle_bvh_large() {
+
+	// enough primitives for the build to be split into tasks
+	Vector<AABB> aabbs;
+	for (int i = 0; i < 50000; i++) {
+		aabbs.push_back(AABB(Vector3(Math::randf() * 200, Math::randf() * 20, Math::randf() * 200), Vector3(Math::randf(), Math::randf(), Math::randf())));
+	}
+
+	TriangleBVH bvh;
+	bvh.build(aabbs.ptr(), aabbs.size());
+
+	struct Counter {
+
+		Vector<int> *found;
+		bool operator()(uint32_t p_index) {
+			found->push_back(p_index);
+			return true;
+		}
+	};
+
+	bool pass = bvh.get_primitive_count() == aabbs.size();
+
+	for (int i = 0; i < 50 && pass; i++) {
+
+		AABB query(Vector3(Math::randf() * 200, Math::randf() * 20, Math::randf() * 200), Vector3(10, 10, 10));
+
+		Vector<int> found;
+		Counter counter;
+		counter.found = &found;
+		bvh.cull_aabb(query, counter);
+
+		int expected = 0;
+		for (int j = 0; j < aabbs.size(); j++) {
+			if (aabbs[j].intersects_inclusive(query))
+				expected++;
+		}
+
+		// leaves may report a few more, never fewer, and never the same primitive twice
+		found.sort();
+		for (int j = 1; j < found.size() && pass; j++) {
+			pass = found[j] != found[j - 1];
+		}
+		int matches = 0;
+		for (int j = 0; j < found.size(); j++) {
+			if (aabbs[found[j]].intersects_inclusive(query))
+				matches++;
+		}
+		pass = pass && matches == expected;
+	}
+
+	return pass;
+}
+
+bool test_triangle_mesh_ray() {
+
+	PoolVector<Vector3> faces = _make_faces(_make_heights());
+	Ref<TriangleMesh> mesh;
+	mesh.instance();
+	mesh->create(faces);
+	PoolVector<Vector3>::Read r = faces.read();
+
+	bool pass = mesh->is_valid();
+	int hits = 0;
+
+	for (int i = 0; i < 300 && pass; i++) {
+
+		Vector3 from = _random_point(10);
+		Vector3 dir = _random_point(10) - from;
+
+		Vector3 expected_point;
+		real_t min_d = 1e20;
+		bool expected_hit = false;
+		for (int j = 0; j < faces.size(); j += 3) {
+			Vector3 res;
+			if (Face3(r[j], r[j + 1], r[j + 2]).intersects_ray(from, dir, &res) && dir.dot(res) < min_d) {
+				min_d = dir.dot(res);
+				expected_point = res;
+				expected_hit = true;
+			}
+		}
+
+		Vector3 point, normal;
+		bool hit = mesh->intersect_ray(from, dir, point, normal);
+		// the point is begin + dir * t, so its error grows with the length of dir
+		pass = hit == expected_hit && (!hit || point.distance_to(expected_point) < 0.001 * MAX(1.0, dir.length()));
+		if (hit)
+			hits++;
+	}
+
+	return pass && hits > 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_height_map_cull,
+	test_height_map_segment,
+	test_height_map_closest_point,
+	test_height_map_point,
+	test_height_map_data,
+	test_concave_segment,
+	test_concave_cull,
+	test_concave_bvh_data,
+	test_triangle_bvh_large,
+	test_triangle_mesh_ray,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestShapes
@@ -33,6 +33,7 @@
 //#include "math_funcs.h"
 #include "core/io/ip_address.h"
 #include "os/os.h"
+#include "string_db.h"
 #include <stdio.h>
 
 #include "test_string.h"
@@ -854,6 +855,81 @@ bool test_29() {
 	return state;
 };
 
+bool test_30() {
+
+	OS::get_singleton()->print("\n\nTest 30: Single character strings are shared, but copy on write\n");
+
+	String a = "x";
+	String b = String::chr('x');
+	String c = String("ab").substr(1, 1);
+	String d;
+	d += 'x';
+
+	bool state = a == "x" && b == "x" && c == "b" && d == "x";
+	state = state && a.c_str() == b.c_str(); // same static data
+
+	b += "yz";
+	d[0] = 'w';
+	String e = a;
+	e.resize(0);
+
+	state = state && a == "x" && b == "xyz" && d == "w" && e.empty() && String::chr('x') == "x";
+	state = state && String::chr(0x3A9).length() == 1 && String::chr(0x3A9)[0] == 0x3A9;
+
+	OS::get_singleton()->print("\t%ls %ls %ls %ls\n", a.c_str(), b.c_str(), c.c_str(), d.c_str());
+
+	return state;
+}
+
+bool test_31() {
+
+	OS::get_singleton()->print("\n\nTest 31: Compare, find, hash and utf8 across vector widths\n");
+
+	bool state = true;
+
+	for (int len = 1; len < 70 && state; len++) {
+
+		String s;
+		CharString cs;
+		for (int i = 0; i < len; i++) {
+			s += CharType('!' + i); // no repeats, so find has a single answer
+			cs.push_back('!' + i);
+		}
+		cs.push_back(0);
+
+		uint32_t hashv = 5381;
+		for (int i = 0; i < len; i++)
+			hashv = hashv * 33 + s[i];
+
+		String t = s;
+		t[len - 1] = '~';
+
+		state = state && s == cs.get_data() && !(t == cs.get_data()) && s == String(cs.get_data()) && !(s == t);
+		state = state && s.hash() == hashv && String::hash(s.c_str(), len) == hashv && String::hash(cs.get_data()) == hashv;
+		state = state && s.utf8().length() == len && strcmp(s.utf8().get_data(), cs.get_data()) == 0;
+		state = state && s.find(s.substr(len / 2, len - len / 2)) == len / 2 && t.find("~") == len - 1 && s.find("~") == -1;
+
+		String wide = s + String::chr(0x3A9) + s;
+		state = state && wide.utf8().length() == len * 2 + 2 && String::utf8(wide.utf8().get_data()) == wide;
+	}
+
+	String z = "abc";
+	z[1] = 0;
+	state = state && z.hash() == String::hash("a"); // hashing stops at an embedded zero
+
+	// runtime names are kept as bytes when they are plain ASCII
+	StringName a = String("test_31_runtime_name");
+	StringName b = String("test_31_") + String::chr(0x3A9);
+	state = state && a == "test_31_runtime_name" && a == String("test_31_runtime_name") && a == StringName("test_31_runtime_name");
+	state = state && String(a) == "test_31_runtime_name" && a.utf8().get_data() == a.utf8().get_data(); // shared, no conversion
+	state = state && b == String("test_31_") + String::chr(0x3A9) && String::utf8(b.utf8().get_data()) == String(b);
+	state = state && StringName::search(String("test_31_runtime_name").c_str()) == a;
+
+	OS::get_singleton()->print("\t%ls %ls\n", String(a).c_str(), String(b).c_str());
+
+	return state;
+}
+
 typedef bool (*TestFunc)(void);
 
 TestFunc test_funcs[] = {
@@ -887,6 +963,8 @@ TestFunc test_funcs[] = {
 	test_27,
 	test_28,
 	test_29,
+	test_30,
+	test_31,
 	0
 
 };
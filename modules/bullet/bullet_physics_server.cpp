@@ -38,6 +38,7 @@
 #include "generic_6dof_joint_bullet.h"
 #include "hinge_joint_bullet.h"
 #include "pin_joint_bullet.h"
+#include "project_settings.h"
 #include "shape_bullet.h"
 #include "slider_joint_bullet.h"
 
@@ -87,7 +88,8 @@ void BulletPhysicsServer::_bind_methods() {
 BulletPhysicsServer::BulletPhysicsServer() :
 		PhysicsServer(),
 		active(true),
-		active_spaces_count(0) {}
+		active_spaces_count(0),
+		task_scheduler(NULL) {}
 
 BulletPhysicsServer::~BulletPhysicsServer() {}
 
@@ -163,7 +165,9 @@ real_t BulletPhysicsServer::shape_get_custom_solver_bias(RID p_shape) const {
 }
 
 RID BulletPhysicsServer::space_create() {
-	SpaceBullet *space = bulletnew(SpaceBullet(false));
+	// the scheduler only exists when the setting was enabled at init, turning it off later gives single threaded spaces again
+	bool multithreaded = task_scheduler && GLOBAL_GET("physics/3d/bullet/multithreaded");
+	SpaceBullet *space = bulletnew(SpaceBullet(false, multithreaded));
 	CreateThenReturnRID(space_owner, space);
 }
 
@@ -1332,6 +1336,16 @@ void BulletPhysicsServer::free(RID p_rid) {
 
 void BulletPhysicsServer::init() {
 	BulletPhysicsDirectBodyState::initSingleton();
+
+	if (GLOBAL_DEF("physics/3d/bullet/multithreaded", false)) {
+#if BT_THREADSAFE
+		// Bullet takes the thread that installs the scheduler as its main thread, which is also the one stepping the spaces
+		task_scheduler = bulletnew(GodotTaskScheduler);
+		btSetTaskScheduler(task_scheduler);
+#else
+		WARN_PRINT("Bullet was built without BT_THREADSAFE (bullet_threadsafe=yes), the physics will run on a single thread.");
+#endif
+	}
 }
 
 void BulletPhysicsServer::step(float p_deltaTime) {
@@ -1354,6 +1368,12 @@ void BulletPhysicsServer::flush_queries() {
 
 void BulletPhysicsServer::finish() {
 	BulletPhysicsDirectBodyState::destroySingleton();
+
+	if (task_scheduler) {
+		btSetTaskScheduler(NULL);
+		bulletdelete(task_scheduler);
+		task_scheduler = NULL;
+	}
 }
 
 int BulletPhysicsServer::get_process_info(ProcessInfo p_info) {
@@ -32,6 +32,7 @@
 #define BULLET_PHYSICS_SERVER_H
 
 #include "area_bullet.h"
+#include "godot_task_scheduler.h"
 #include "joint_bullet.h"
 #include "rid.h"
 #include "rigid_body_bullet.h"
@@ -53,6 +54,9 @@ class BulletPhysicsServer : public PhysicsServer {
 	char active_spaces_count;
 	Vector<SpaceBullet *> active_spaces;
 
+	/// Installed at init when "physics/3d/bullet/multithreaded" is enabled, spaces created while it stays enabled use the multithreaded Bullet world
+	GodotTaskScheduler *task_scheduler;
+
 	mutable RID_Owner<SpaceBullet> space_owner;
 	mutable RID_Owner<ShapeBullet> shape_owner;
 	mutable RID_Owner<AreaBullet> area_owner;
@@ -33,6 +33,7 @@
 
 #include "int_types.h"
 
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <btBulletDynamicsCommon.h>
 
 /**
@@ -48,5 +49,16 @@ public:
 	GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration);
 	virtual bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1);
 	virtual bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1);
+
+	/// Only reads the collision objects, so it can be called from the narrowphase threads
+	static bool is_area_pair(const btCollisionObject *body0, const btCollisionObject *body1);
+};
+
+/// Same behaviour, with the pairs processed in parallel by the Bullet task scheduler
+class GodotCollisionDispatcherMt : public btCollisionDispatcherMt {
+public:
+	GodotCollisionDispatcherMt(btCollisionConfiguration *collisionConfiguration);
+	virtual bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1);
+	virtual bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1);
 };
 #endif
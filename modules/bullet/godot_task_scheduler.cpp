@@ -0,0 +1,102 @@
+/*************************************************************************/
+/*  godot_task_scheduler.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "godot_task_scheduler.h"
+
+#include "core/os/os.h"
+
+void GodotTaskScheduler::_run_grain(uint32_t p_index, Job *p_job) {
+
+	int begin = p_job->begin + p_index * p_job->grain_size;
+	p_job->body->forLoop(begin, MIN(begin + p_job->grain_size, p_job->end));
+}
+
+int GodotTaskScheduler::getMaxNumThreads() const {
+
+	return BT_MAX_THREAD_COUNT;
+}
+
+int GodotTaskScheduler::getNumThreads() const {
+
+	return thread_count;
+}
+
+void GodotTaskScheduler::setNumThreads(int numThreads) {
+
+	ERR_FAIL_COND(running);
+
+	pool.finish();
+	pool.init(CLAMP(numThreads, 1, int(BT_MAX_THREAD_COUNT)) - 1);
+	thread_count = pool.get_thread_count() + 1; // fewer if the threads couldn't be created
+
+	// all the workers are new, so Bullet can hand out their thread indices from the start again
+	m_savedThreadCounter = 0;
+	if (m_isActive) {
+		btResetThreadIndexCounter();
+	}
+}
+
+void GodotTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) {
+
+	if (iEnd <= iBegin)
+		return;
+
+	int grain_size = MAX(grainSize, 1);
+	int grains = (iEnd - iBegin + grain_size - 1) / grain_size;
+
+	// the pool can't take nested jobs, those run on the thread that asked for them
+	if (grains == 1 || running || pool.get_thread_count() == 0) {
+		body.forLoop(iBegin, iEnd);
+		return;
+	}
+
+	Job job;
+	job.begin = iBegin;
+	job.end = iEnd;
+	job.grain_size = grain_size;
+	job.body = &body;
+
+	running = true;
+	pool.do_work(grains, this, &GodotTaskScheduler::_run_grain, &job);
+	running = false;
+}
+
+GodotTaskScheduler::GodotTaskScheduler(int p_thread_count) :
+		btITaskScheduler("Godot"),
+		thread_count(1),
+		running(false) {
+
+	setNumThreads(p_thread_count > 0 ? p_thread_count : OS::get_singleton()->get_processor_count());
+}
+
+GodotTaskScheduler::~GodotTaskScheduler() {
+
+	pool.finish();
+}
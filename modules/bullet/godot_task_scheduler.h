@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  godot_task_scheduler.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GODOT_TASK_SCHEDULER_H
+#define GODOT_TASK_SCHEDULER_H
+
+#include "core/os/thread_work_pool.h"
+
+#include <LinearMath/btThreads.h>
+
+/// Runs the btParallelFor() calls of the multithreaded Bullet classes on a ThreadWorkPool.
+/// It has to be installed with btSetTaskScheduler() from the thread that steps the spaces,
+/// since Bullet treats the first thread that asks for its thread index as the main one.
+class GodotTaskScheduler : public btITaskScheduler {
+
+	struct Job {
+		int begin;
+		int end;
+		int grain_size;
+		const btIParallelForBody *body;
+	};
+
+	ThreadWorkPool pool;
+	int thread_count;
+	bool running;
+
+	void _run_grain(uint32_t p_index, Job *p_job);
+
+public:
+	virtual int getMaxNumThreads() const;
+	virtual int getNumThreads() const;
+	virtual void setNumThreads(int numThreads);
+	virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body);
+
+	GodotTaskScheduler(int p_thread_count = -1);
+	virtual ~GodotTaskScheduler();
+};
+
+#endif
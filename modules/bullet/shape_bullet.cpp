@@ -316,7 +316,14 @@ ConcavePolygonShapeBullet::~ConcavePolygonShapeBullet() {
 }
 
 void ConcavePolygonShapeBullet::set_data(const Variant &p_data) {
-	setup(p_data);
+	if (p_data.get_type() == Variant::DICTIONARY) {
+		// the stored tree is built for the SW server, Bullet makes its own
+		Dictionary d = p_data;
+		ERR_FAIL_COND(!d.has("faces"));
+		setup(d["faces"]);
+	} else {
+		setup(p_data);
+	}
 }
 
 Variant ConcavePolygonShapeBullet::get_data() const {
@@ -398,12 +405,17 @@ void HeightMapShapeBullet::set_data(const Variant &p_data) {
 	ERR_FAIL_COND(l_width <= 0);
 	ERR_FAIL_COND(l_depth <= 0);
 	ERR_FAIL_COND(l_cell_size <= CMP_EPSILON);
-	ERR_FAIL_COND(l_heights.size() != (width * depth));
-	setup(heights, width, depth, cell_size);
+	ERR_FAIL_COND(l_heights.size() != (l_width * l_depth));
+	setup(l_heights, l_width, l_depth, l_cell_size);
 }
 
 Variant HeightMapShapeBullet::get_data() const {
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"] = width;
+	d["depth"] = depth;
+	d["cell_size"] = cell_size;
+	d["heights"] = heights;
+	return d;
 }
 
 PhysicsServer::ShapeType HeightMapShapeBullet::get_type() const {
@@ -428,7 +440,8 @@ void HeightMapShapeBullet::setup(PoolVector<real_t> &p_heights, int p_width, int
 
 btCollisionShape *HeightMapShapeBullet::create_bt_shape(const btVector3 &p_implicit_scale, real_t p_margin) {
 	btCollisionShape *cs(ShapeBullet::create_shape_height_field(heights, width, depth, cell_size));
-	cs->setLocalScaling(p_implicit_scale);
+	// Bullet puts the points one unit apart
+	cs->setLocalScaling(p_implicit_scale * btVector3(cell_size, 1, cell_size));
 	prepare(cs);
 	cs->setMargin(p_margin);
 	return cs;
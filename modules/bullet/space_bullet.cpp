@@ -46,6 +46,7 @@
 #include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
 #include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
 #include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
 #include <btBulletDynamicsCommon.h>
@@ -325,7 +326,7 @@ Vector3 BulletPhysicsDirectSpaceState::get_closest_point_to_object_volume(RID p_
 	}
 }
 
-SpaceBullet::SpaceBullet(bool p_create_soft_world) :
+SpaceBullet::SpaceBullet(bool p_create_soft_world, bool p_multithreaded) :
 		broadphase(NULL),
 		dispatcher(NULL),
 		solver(NULL),
@@ -338,7 +339,7 @@ SpaceBullet::SpaceBullet(bool p_create_soft_world) :
 		gravityMagnitude(10),
 		contactDebugCount(0) {
 
-	create_empty_world(p_create_soft_world);
+	create_empty_world(p_create_soft_world, p_multithreaded);
 	direct_access = memnew(BulletPhysicsDirectSpaceState(this));
 }
 
@@ -529,6 +530,8 @@ void onBulletPreTickCallback(btDynamicsWorld *p_dynamicsWorld, btScalar timeStep
 	static_cast<SpaceBullet *>(p_dynamicsWorld->getWorldUserInfo())->flush_queries();
 }
 
+// Both tick callbacks run on the thread that steps the space, even in a multithreaded world
+// the narrowphase and the solver are done by then, so the areas and bodies can be updated without locks.
 void onBulletTickCallback(btDynamicsWorld *p_dynamicsWorld, btScalar timeStep) {
 
 	// Notify all Collision objects the collision checker is started
@@ -552,15 +555,20 @@ btScalar calculateGodotCombinedRestitution(const btCollisionObject *body0, const
 	return MAX(body0->getRestitution(), body1->getRestitution());
 }
 
-void SpaceBullet::create_empty_world(bool p_create_soft_world) {
+void SpaceBullet::create_empty_world(bool p_create_soft_world, bool p_multithreaded) {
 
 	gjk_epa_pen_solver = bulletnew(btGjkEpaPenetrationDepthSolver);
 	gjk_simplex_solver = bulletnew(btVoronoiSimplexSolver);
 	gjk_simplex_solver->setEqualVertexThreshold(0.f);
 
+	// The soft world has no multithreaded version
+	bool multithreaded = p_multithreaded && !p_create_soft_world && btGetTaskScheduler();
+
 	void *world_mem;
 	if (p_create_soft_world) {
 		world_mem = malloc(sizeof(btSoftRigidDynamicsWorld));
+	} else if (multithreaded) {
+		world_mem = malloc(sizeof(btDiscreteDynamicsWorldMt));
 	} else {
 		world_mem = malloc(sizeof(btDiscreteDynamicsWorld));
 	}
@@ -571,15 +579,24 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
 		collisionConfiguration = bulletnew(GodotCollisionConfiguration(static_cast<btDiscreteDynamicsWorld *>(world_mem)));
 	}
 
-	dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
 	broadphase = bulletnew(btDbvtBroadphase);
-	solver = bulletnew(btSequentialImpulseConstraintSolver);
 
-	if (p_create_soft_world) {
-		dynamicsWorld = new (world_mem) btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
-		soft_body_world_info = bulletnew(btSoftBodyWorldInfo);
+	if (multithreaded) {
+		// One solver for each thread that can solve an island at the same time
+		dispatcher = bulletnew(GodotCollisionDispatcherMt(collisionConfiguration));
+		btConstraintSolverPoolMt *solver_pool = bulletnew(btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads()));
+		solver = solver_pool;
+		dynamicsWorld = new (world_mem) btDiscreteDynamicsWorldMt(dispatcher, broadphase, solver_pool, collisionConfiguration);
 	} else {
-		dynamicsWorld = new (world_mem) btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+		dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
+		solver = bulletnew(btSequentialImpulseConstraintSolver);
+
+		if (p_create_soft_world) {
+			dynamicsWorld = new (world_mem) btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+			soft_body_world_info = bulletnew(btSoftBodyWorldInfo);
+		} else {
+			dynamicsWorld = new (world_mem) btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+		}
 	}
 
 	ghostPairCallback = bulletnew(btGhostPairCallback);
@@ -36,6 +36,7 @@
 
 #include "io/marshalls.h"
 #include "os/os.h"
+#include "os/thread_work_pool.h"
 #include "scene/resources/mesh_library.h"
 #include "scene/scene_string_names.h"
 
@@ -70,17 +71,18 @@ bool GridMap::_set(const StringName &p_name, const Variant &p_value) {
 			int amount = cells.size();
 			PoolVector<int>::Read r = cells.read();
 			ERR_FAIL_COND_V(amount % 3, false); // not even
-			cell_map.clear();
+			_clear_internal();
 			for (int i = 0; i < amount / 3; i++) {
 
 				IndexKey ik;
 				ik.key = decode_uint64((const uint8_t *)&r[i * 3]);
 				Cell cell;
 				cell.cell = decode_uint32((const uint8_t *)&r[i * 3 + 2]);
-				cell_map[ik] = cell;
+				_set_cell(ik, cell.item, cell.rot);
 			}
+		} else {
+			_recreate_octant_data();
 		}
-		_recreate_octant_data();
 	} else if (name == "baked_meshes") {
 
 		clear_baked_meshes();
@@ -117,15 +119,26 @@ bool GridMap::_get(const StringName &p_name, Variant &r_ret) const {
 
 		Dictionary d;
 
+		// sorted, so saving the same cells always gives the same data
+		LocalVector<IndexKey> keys;
+		keys.reserve(_get_cell_count());
+		for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+
+			const Octant *g = octant_map.get(*K);
+			for (const IndexKey *F = g->cells.next(NULL); F; F = g->cells.next(F)) {
+				keys.push_back(*F);
+			}
+		}
+		keys.sort();
+
 		PoolVector<int> cells;
-		cells.resize(cell_map.size() * 3);
+		cells.resize(keys.size() * 3);
 		{
 			PoolVector<int>::Write w = cells.write();
-			int i = 0;
-			for (Map<IndexKey, Cell>::Element *E = cell_map.front(); E; E = E->next(), i++) {
+			for (int i = 0; i < keys.size(); i++) {
 
-				encode_uint64(E->key().key, (uint8_t *)&w[i * 3]);
-				encode_uint32(E->get().cell, (uint8_t *)&w[i * 3 + 2]);
+				encode_uint64(keys[i].key, (uint8_t *)&w[i * 3]);
+				encode_uint32(_get_cell(keys[i])->cell, (uint8_t *)&w[i * 3 + 2]);
 			}
 		}
 
@@ -276,12 +289,77 @@ bool GridMap::get_center_z() const {
 	return center_z;
 }
 
+GridMap::Octant *GridMap::_create_octant(const OctantKey &p_key) {
+
+	Octant *g = memnew(Octant);
+	g->dirty = true;
+	g->static_body = PhysicsServer::get_singleton()->body_create(PhysicsServer::BODY_MODE_STATIC);
+	PhysicsServer::get_singleton()->body_attach_object_instance_id(g->static_body, get_instance_id());
+	PhysicsServer::get_singleton()->body_set_collision_layer(g->static_body, collision_layer);
+	PhysicsServer::get_singleton()->body_set_collision_mask(g->static_body, collision_mask);
+	SceneTree *st = SceneTree::get_singleton();
+
+	if (st && st->is_debugging_collisions_hint()) {
+
+		g->collision_debug = VisualServer::get_singleton()->mesh_create();
+		g->collision_debug_instance = VisualServer::get_singleton()->instance_create();
+		VisualServer::get_singleton()->instance_set_base(g->collision_debug_instance, g->collision_debug);
+	}
+
+	octant_map.set(p_key, g);
+
+	if (is_inside_world()) {
+		_octant_enter_world(p_key);
+		_octant_transform(p_key);
+	}
+
+	return g;
+}
+
+void GridMap::_set_cell(const IndexKey &p_key, int p_item, int p_rot) {
+
+	OctantKey octantkey = _get_octant_key(p_key);
+	Octant **gp = octant_map.getptr(octantkey);
+
+	if (p_item < 0) {
+		//erase
+		if (gp && (*gp)->cells.erase(p_key)) {
+			(*gp)->dirty = true;
+			_queue_octants_dirty();
+		}
+		return;
+	}
+
+	//create octant because it does not exist
+	Octant *g = gp ? *gp : _create_octant(octantkey);
+
+	Cell *existing = g->cells.getptr(p_key);
+	if (existing && existing->item == uint32_t(p_item) && existing->rot == uint32_t(p_rot))
+		return; // nothing to rebuild
+
+	Cell c;
+	c.item = p_item;
+	c.rot = p_rot;
+
+	g->cells.set(p_key, c);
+	g->dirty = true;
+	_queue_octants_dirty();
+}
+
+int GridMap::_get_cell_count() const {
+
+	int count = 0;
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+		count += octant_map.get(*K)->cells.size();
+	}
+	return count;
+}
+
 void GridMap::set_cell_item(int p_x, int p_y, int p_z, int p_item, int p_rot) {
 
-	if (baked_meshes.size() && !recreating_octants) {
+	if (baked_meshes.size()) {
 		//if you set a cell item, baked meshes go good bye
 		clear_baked_meshes();
-		_recreate_octant_data();
 	}
 
 	ERR_FAIL_INDEX(ABS(p_x), 1 << 20);
@@ -293,63 +371,40 @@ void GridMap::set_cell_item(int p_x, int p_y, int p_z, int p_item, int p_rot) {
 	key.y = p_y;
 	key.z = p_z;
 
-	OctantKey ok;
-	ok.x = p_x / octant_size;
-	ok.y = p_y / octant_size;
-	ok.z = p_z / octant_size;
-
-	if (p_item < 0) {
-		//erase
-		if (cell_map.has(key)) {
-			OctantKey octantkey = ok;
-
-			ERR_FAIL_COND(!octant_map.has(octantkey));
-			Octant &g = *octant_map[octantkey];
-			g.cells.erase(key);
-			g.dirty = true;
-			cell_map.erase(key);
-			_queue_octants_dirty();
-		}
-		return;
-	}
+	_set_cell(key, p_item, p_rot);
+}
 
-	OctantKey octantkey = ok;
+void GridMap::set_cells(const PoolVector<Vector3> &p_cells, const PoolVector<int> &p_items, const PoolVector<int> &p_orientations) {
 
-	if (!octant_map.has(octantkey)) {
-		//create octant because it does not exist
-		Octant *g = memnew(Octant);
-		g->dirty = true;
-		g->static_body = PhysicsServer::get_singleton()->body_create(PhysicsServer::BODY_MODE_STATIC);
-		PhysicsServer::get_singleton()->body_attach_object_instance_id(g->static_body, get_instance_id());
-		PhysicsServer::get_singleton()->body_set_collision_layer(g->static_body, collision_layer);
-		PhysicsServer::get_singleton()->body_set_collision_mask(g->static_body, collision_mask);
-		SceneTree *st = SceneTree::get_singleton();
+	int count = p_cells.size();
+	ERR_FAIL_COND(p_items.size() != count);
+	ERR_FAIL_COND(p_orientations.size() != 0 && p_orientations.size() != count);
 
-		if (st && st->is_debugging_collisions_hint()) {
+	if (baked_meshes.size()) {
+		clear_baked_meshes();
+	}
 
-			g->collision_debug = VisualServer::get_singleton()->mesh_create();
-			g->collision_debug_instance = VisualServer::get_singleton()->instance_create();
-			VisualServer::get_singleton()->instance_set_base(g->collision_debug_instance, g->collision_debug);
-		}
+	bool has_orientations = p_orientations.size() != 0;
+	PoolVector<Vector3>::Read r_cells = p_cells.read();
+	PoolVector<int>::Read r_items = p_items.read();
+	PoolVector<int>::Read r_orientations = p_orientations.read();
 
-		octant_map[octantkey] = g;
+	// the octants are only rebuilt once, in the update queued by the first change
+	for (int i = 0; i < count; i++) {
 
-		if (is_inside_world()) {
-			_octant_enter_world(octantkey);
-			_octant_transform(octantkey);
-		}
-	}
+		int x = Math::floor(r_cells[i].x);
+		int y = Math::floor(r_cells[i].y);
+		int z = Math::floor(r_cells[i].z);
 
-	Octant &g = *octant_map[octantkey];
-	g.cells.insert(key);
-	g.dirty = true;
-	_queue_octants_dirty();
+		ERR_CONTINUE(ABS(x) >= 1 << 20 || ABS(y) >= 1 << 20 || ABS(z) >= 1 << 20);
 
-	Cell c;
-	c.item = p_item;
-	c.rot = p_rot;
+		IndexKey key;
+		key.x = x;
+		key.y = y;
+		key.z = z;
 
-	cell_map[key] = c;
+		_set_cell(key, r_items[i], has_orientations ? r_orientations[i] : 0);
+	}
 }
 
 int GridMap::get_cell_item(int p_x, int p_y, int p_z) const {
@@ -363,9 +418,10 @@ int GridMap::get_cell_item(int p_x, int p_y, int p_z) const {
 	key.y = p_y;
 	key.z = p_z;
 
-	if (!cell_map.has(key))
+	const Cell *c = _get_cell(key);
+	if (!c)
 		return INVALID_CELL_ITEM;
-	return cell_map[key].item;
+	return c->item;
 }
 
 int GridMap::get_cell_item_orientation(int p_x, int p_y, int p_z) const {
@@ -379,9 +435,10 @@ int GridMap::get_cell_item_orientation(int p_x, int p_y, int p_z) const {
 	key.y = p_y;
 	key.z = p_z;
 
-	if (!cell_map.has(key))
+	const Cell *c = _get_cell(key);
+	if (!c)
 		return -1;
-	return cell_map[key].rot;
+	return c->rot;
 }
 
 Vector3 GridMap::world_to_map(const Vector3 &p_world_pos) const {
@@ -416,11 +473,44 @@ void GridMap::_octant_transform(const OctantKey &p_key) {
 	}
 }
 
-bool GridMap::_octant_update(const OctantKey &p_key) {
-	ERR_FAIL_COND_V(!octant_map.has(p_key), false);
-	Octant &g = *octant_map[p_key];
-	if (!g.dirty)
-		return false;
+void GridMap::_octant_build(uint32_t p_index, OctantUpdate *p_update) {
+
+	// runs on worker threads, so it only reads the octant and the item table, and doesn't call the servers
+	OctantUpdate::Build &build = p_update->builds[p_index];
+	const Octant &g = *build.octant;
+
+	Vector3 ofs = _get_offset();
+	bool use_multimesh = baked_meshes.size() == 0;
+
+	for (const IndexKey *K = g.cells.next(NULL); K; K = g.cells.next(K)) {
+
+		const Cell &c = g.cells.get(*K);
+		const OctantUpdate::Item *item = p_update->items.getptr(c.item);
+		if (!item)
+			continue;
+
+		OctantUpdate::CellInstance ci;
+		ci.key = *K;
+		ci.item = c.item;
+		ci.xform.basis.set_orthogonal_index(c.rot);
+		ci.xform.set_origin(Vector3(K->x, K->y, K->z) * cell_size + ofs);
+		ci.xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
+
+		if (use_multimesh && item->mesh.is_valid()) {
+			build.multimeshes[c.item].push_back(ci);
+		}
+		if (item->shapes.size()) {
+			build.shapes.push_back(ci);
+		}
+		if (item->navmesh.is_valid()) {
+			build.navmeshes.push_back(ci);
+		}
+	}
+}
+
+void GridMap::_octant_apply(OctantUpdate::Build &p_build, const OctantUpdate &p_update) {
+
+	Octant &g = *p_build.octant;
 
 	//erase body shapes
 	PhysicsServer::get_singleton()->body_clear_shapes(g.static_body);
@@ -436,8 +526,8 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 		for (Map<IndexKey, Octant::NavMesh>::Element *E = g.navmesh_ids.front(); E; E = E->next()) {
 			navigation->navmesh_remove(E->get().id);
 		}
-		g.navmesh_ids.clear();
 	}
+	g.navmesh_ids.clear();
 
 	//erase multimeshes
 
@@ -448,125 +538,78 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 	}
 	g.multimesh_instances.clear();
 
-	if (g.cells.size() == 0) {
-		//octant no longer needed
-		_octant_clean_up(p_key);
-		return true;
-	}
-
 	PoolVector<Vector3> col_debug;
 
-	/*
-	 * foreach item in this octant,
-	 * set item's multimesh's instance count to number of cells which have this item
-	 * and set said multimesh bounding box to one containing all cells which have this item
-	 */
-
-	Map<int, List<Pair<Transform, IndexKey> > > multimesh_items;
-
-	for (Set<IndexKey>::Element *E = g.cells.front(); E; E = E->next()) {
-
-		ERR_CONTINUE(!cell_map.has(E->get()));
-		const Cell &c = cell_map[E->get()];
-
-		if (!theme.is_valid() || !theme->has_item(c.item))
-			continue;
-
-		//print_line("OCTANT, CELLS: "+itos(ii.cells.size()));
+	// add the items' shapes at the cell xforms to octant's static_body
+	for (int i = 0; i < p_build.shapes.size(); i++) {
 
-		Vector3 cellpos = Vector3(E->get().x, E->get().y, E->get().z);
-		Vector3 ofs = _get_offset();
-
-		Transform xform;
-
-		if (clip && ((clip_above && cellpos[clip_axis] > clip_floor) || (!clip_above && cellpos[clip_axis] < clip_floor))) {
-
-		} else {
-		}
-
-		xform.basis.set_orthogonal_index(c.rot);
-		xform.set_origin(cellpos * cell_size + ofs);
-		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
-		if (baked_meshes.size() == 0) {
-			if (theme->get_item_mesh(c.item).is_valid()) {
-				if (!multimesh_items.has(c.item)) {
-					multimesh_items[c.item] = List<Pair<Transform, IndexKey> >();
-				}
-
-				Pair<Transform, IndexKey> p;
-				p.first = xform;
-				p.second = E->get();
-				multimesh_items[c.item].push_back(p);
-			}
-		}
+		const OctantUpdate::CellInstance &ci = p_build.shapes[i];
+		Vector<MeshLibrary::ShapeData> shapes = p_update.items[ci.item].shapes;
 
-		Vector<MeshLibrary::ShapeData> shapes = theme->get_item_shapes(c.item);
-		// add the item's shape at given xform to octant's static_body
-		for (int i = 0; i < shapes.size(); i++) {
-			// add the item's shape
-			if (!shapes[i].shape.is_valid())
+		for (int j = 0; j < shapes.size(); j++) {
+			if (!shapes[j].shape.is_valid())
 				continue;
-			PhysicsServer::get_singleton()->body_add_shape(g.static_body, shapes[i].shape->get_rid(), xform * shapes[i].local_transform);
+			PhysicsServer::get_singleton()->body_add_shape(g.static_body, shapes[j].shape->get_rid(), ci.xform * shapes[j].local_transform);
 			if (g.collision_debug.is_valid()) {
-				shapes[i].shape->add_vertices_to_array(col_debug, xform * shapes[i].local_transform);
+				shapes[j].shape->add_vertices_to_array(col_debug, ci.xform * shapes[j].local_transform);
 			}
-
-			//print_line("PHIS x: "+xform);
 		}
+	}
 
-		// add the item's navmesh at given xform to GridMap's Navigation ancestor
-		Ref<NavigationMesh> navmesh = theme->get_item_navmesh(c.item);
-		if (navmesh.is_valid()) {
-			Octant::NavMesh nm;
-			nm.xform = xform;
+	// add the items' navmeshes at the cell xforms to GridMap's Navigation ancestor
+	for (int i = 0; i < p_build.navmeshes.size(); i++) {
 
-			if (navigation) {
-				nm.id = navigation->navmesh_add(navmesh, xform, this);
-			} else {
-				nm.id = -1;
-			}
-			g.navmesh_ids[E->get()] = nm;
+		const OctantUpdate::CellInstance &ci = p_build.navmeshes[i];
+
+		Octant::NavMesh nm;
+		nm.xform = ci.xform;
+
+		if (navigation) {
+			nm.id = navigation->navmesh_add(p_update.items[ci.item].navmesh, ci.xform, this);
+		} else {
+			nm.id = -1;
 		}
+		g.navmesh_ids[ci.key] = nm;
 	}
 
-	//update multimeshes, only if not baked
-	if (baked_meshes.size() == 0) {
+	/*
+	 * foreach item in this octant,
+	 * set item's multimesh's instance count to number of cells which have this item
+	 */
+
+	for (Map<int, LocalVector<OctantUpdate::CellInstance> >::Element *E = p_build.multimeshes.front(); E; E = E->next()) {
 
-		for (Map<int, List<Pair<Transform, IndexKey> > >::Element *E = multimesh_items.front(); E; E = E->next()) {
-			Octant::MultimeshInstance mmi;
+		Octant::MultimeshInstance mmi;
+		const LocalVector<OctantUpdate::CellInstance> &cells = E->get();
 
-			RID mm = VS::get_singleton()->multimesh_create();
-			VS::get_singleton()->multimesh_allocate(mm, E->get().size(), VS::MULTIMESH_TRANSFORM_3D, VS::MULTIMESH_COLOR_NONE);
-			VS::get_singleton()->multimesh_set_mesh(mm, theme->get_item_mesh(E->key())->get_rid());
+		RID mm = VS::get_singleton()->multimesh_create();
+		VS::get_singleton()->multimesh_allocate(mm, cells.size(), VS::MULTIMESH_TRANSFORM_3D, VS::MULTIMESH_COLOR_NONE);
+		VS::get_singleton()->multimesh_set_mesh(mm, p_update.items[E->key()].mesh->get_rid());
 
-			int idx = 0;
-			for (List<Pair<Transform, IndexKey> >::Element *F = E->get().front(); F; F = F->next()) {
-				VS::get_singleton()->multimesh_instance_set_transform(mm, idx, F->get().first);
+		for (int i = 0; i < cells.size(); i++) {
+			VS::get_singleton()->multimesh_instance_set_transform(mm, i, cells[i].xform);
 #ifdef TOOLS_ENABLED
 
-				Octant::MultimeshInstance::Item it;
-				it.index = idx;
-				it.transform = F->get().first;
-				it.key = F->get().second;
-				mmi.items.push_back(it);
+			Octant::MultimeshInstance::Item it;
+			it.index = i;
+			it.transform = cells[i].xform;
+			it.key = cells[i].key;
+			mmi.items.push_back(it);
 #endif
+		}
 
-				idx++;
-			}
-
-			RID instance = VS::get_singleton()->instance_create();
-			VS::get_singleton()->instance_set_base(instance, mm);
+		RID instance = VS::get_singleton()->instance_create();
+		VS::get_singleton()->instance_set_base(instance, mm);
 
-			if (is_inside_tree()) {
-				VS::get_singleton()->instance_set_scenario(instance, get_world()->get_scenario());
-				VS::get_singleton()->instance_set_transform(instance, get_global_transform());
-			}
+		if (is_inside_tree()) {
+			VS::get_singleton()->instance_set_scenario(instance, get_world()->get_scenario());
+			VS::get_singleton()->instance_set_transform(instance, get_global_transform());
+		}
 
-			mmi.multimesh = mm;
-			mmi.instance = instance;
+		mmi.multimesh = mm;
+		mmi.instance = instance;
 
-			g.multimesh_instances.push_back(mmi);
-		}
+		g.multimesh_instances.push_back(mmi);
 	}
 
 	if (col_debug.size()) {
@@ -583,14 +626,13 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 	}
 
 	g.dirty = false;
-
-	return false;
 }
 
 void GridMap::_reset_physic_bodies_collision_filters() {
-	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
-		PhysicsServer::get_singleton()->body_set_collision_layer(E->get()->static_body, collision_layer);
-		PhysicsServer::get_singleton()->body_set_collision_mask(E->get()->static_body, collision_mask);
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+		Octant *g = octant_map.get(*K);
+		PhysicsServer::get_singleton()->body_set_collision_layer(g->static_body, collision_layer);
+		PhysicsServer::get_singleton()->body_set_collision_mask(g->static_body, collision_mask);
 	}
 }
 
@@ -615,8 +657,9 @@ void GridMap::_octant_enter_world(const OctantKey &p_key) {
 	if (navigation && theme.is_valid()) {
 		for (Map<IndexKey, Octant::NavMesh>::Element *F = g.navmesh_ids.front(); F; F = F->next()) {
 
-			if (cell_map.has(F->key()) && F->get().id < 0) {
-				Ref<NavigationMesh> nm = theme->get_item_navmesh(cell_map[F->key()].item);
+			const Cell *c = g.cells.getptr(F->key());
+			if (c && F->get().id < 0) {
+				Ref<NavigationMesh> nm = theme->get_item_navmesh(c->item);
 				if (nm.is_valid()) {
 					F->get().id = navigation->navmesh_add(nm, F->get().xform, this);
 				}
@@ -700,8 +743,8 @@ void GridMap::_notification(int p_what) {
 
 			last_transform = get_global_transform();
 
-			for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
-				_octant_enter_world(E->key());
+			for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+				_octant_enter_world(*K);
 			}
 
 			for (int i = 0; i < baked_meshes.size(); i++) {
@@ -716,8 +759,8 @@ void GridMap::_notification(int p_what) {
 			if (new_xform == last_transform)
 				break;
 			//update run
-			for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
-				_octant_transform(E->key());
+			for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+				_octant_transform(*K);
 			}
 
 			last_transform = new_xform;
@@ -729,8 +772,8 @@ void GridMap::_notification(int p_what) {
 		} break;
 		case NOTIFICATION_EXIT_WORLD: {
 
-			for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
-				_octant_exit_world(E->key());
+			for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+				_octant_exit_world(*K);
 			}
 
 			navigation = NULL;
@@ -755,8 +798,8 @@ void GridMap::_update_visibility() {
 
 	_change_notify("visible");
 
-	for (Map<OctantKey, Octant *>::Element *e = octant_map.front(); e; e = e->next()) {
-		Octant *octant = e->value();
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+		Octant *octant = octant_map.get(*K);
 		for (int i = 0; i < octant->multimesh_instances.size(); i++) {
 			Octant::MultimeshInstance &mi = octant->multimesh_instances[i];
 			VS::get_singleton()->instance_set_visible(mi.instance, is_visible());
@@ -775,28 +818,39 @@ void GridMap::_queue_octants_dirty() {
 
 void GridMap::_recreate_octant_data() {
 
-	recreating_octants = true;
-	Map<IndexKey, Cell> cell_copy = cell_map;
+	LocalVector<IndexKey> keys;
+	LocalVector<Cell> cells;
+	int cell_count = _get_cell_count();
+	keys.reserve(cell_count);
+	cells.reserve(cell_count);
+
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+
+		const Octant *g = octant_map.get(*K);
+		for (const IndexKey *F = g->cells.next(NULL); F; F = g->cells.next(F)) {
+			keys.push_back(*F);
+			cells.push_back(g->cells.get(*F));
+		}
+	}
+
 	_clear_internal();
-	for (Map<IndexKey, Cell>::Element *E = cell_copy.front(); E; E = E->next()) {
+	for (int i = 0; i < keys.size(); i++) {
 
-		set_cell_item(E->key().x, E->key().y, E->key().z, E->get().item, E->get().rot);
+		_set_cell(keys[i], cells[i].item, cells[i].rot);
 	}
-	recreating_octants = false;
 }
 
 void GridMap::_clear_internal() {
 
-	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
 		if (is_inside_world())
-			_octant_exit_world(E->key());
+			_octant_exit_world(*K);
 
-		_octant_clean_up(E->key());
-		memdelete(E->get());
+		_octant_clean_up(*K);
+		memdelete(octant_map.get(*K));
 	}
 
 	octant_map.clear();
-	cell_map.clear();
 }
 
 void GridMap::clear() {
@@ -815,17 +869,57 @@ void GridMap::_update_octants_callback() {
 	if (!awaiting_update)
 		return;
 
-	List<OctantKey> to_delete;
-	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
+	OctantUpdate update;
+	LocalVector<OctantKey> to_delete;
+
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
 
-		if (_octant_update(E->key())) {
-			to_delete.push_back(E->key());
+		Octant *g = octant_map.get(*K);
+		if (!g->dirty)
+			continue;
+
+		if (g->cells.empty()) {
+			//octant no longer needed
+			to_delete.push_back(*K);
+			continue;
+		}
+
+		OctantUpdate::Build build;
+		build.octant = g;
+		update.builds.push_back(build);
+	}
+
+	if (update.builds.size() && theme.is_valid()) {
+
+		// the library is looked up once here instead of once per cell in the builds
+		Vector<int> item_list = theme->get_item_list();
+		for (int i = 0; i < item_list.size(); i++) {
+
+			OctantUpdate::Item item;
+			item.mesh = theme->get_item_mesh(item_list[i]);
+			item.shapes = theme->get_item_shapes(item_list[i]);
+			item.navmesh = theme->get_item_navmesh(item_list[i]);
+			update.items[item_list[i]] = item;
+		}
+
+		ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+		if (update.builds.size() > 1 && pool) {
+			pool->do_work(update.builds.size(), this, &GridMap::_octant_build, &update);
+		} else {
+			for (int i = 0; i < update.builds.size(); i++) {
+				_octant_build(i, &update);
+			}
 		}
 	}
 
-	while (to_delete.front()) {
-		octant_map.erase(to_delete.front()->get());
-		to_delete.pop_back();
+	for (int i = 0; i < update.builds.size(); i++) {
+		_octant_apply(update.builds[i], update);
+	}
+
+	for (int i = 0; i < to_delete.size(); i++) {
+		_octant_clean_up(to_delete[i]);
+		memdelete(octant_map.get(to_delete[i]));
+		octant_map.erase(to_delete[i]);
 	}
 
 	_update_visibility();
@@ -859,6 +953,7 @@ void GridMap::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_octant_size"), &GridMap::get_octant_size);
 
 	ClassDB::bind_method(D_METHOD("set_cell_item", "x", "y", "z", "item", "orientation"), &GridMap::set_cell_item, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("set_cells", "cells", "items", "orientations"), &GridMap::set_cells, DEFVAL(PoolVector<int>()));
 	ClassDB::bind_method(D_METHOD("get_cell_item", "x", "y", "z"), &GridMap::get_cell_item);
 	ClassDB::bind_method(D_METHOD("get_cell_item_orientation", "x", "y", "z"), &GridMap::get_cell_item_orientation);
 
@@ -917,9 +1012,9 @@ void GridMap::set_clip(bool p_enabled, bool p_clip_above, int p_floor, Vector3::
 	clip_above = p_clip_above;
 
 	//make it all update
-	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
 
-		Octant *g = E->get();
+		Octant *g = octant_map.get(*K);
 		g->dirty = true;
 	}
 	awaiting_update = true;
@@ -940,11 +1035,15 @@ float GridMap::get_cell_scale() const {
 Array GridMap::get_used_cells() const {
 
 	Array a;
-	a.resize(cell_map.size());
+	a.resize(_get_cell_count());
 	int i = 0;
-	for (Map<IndexKey, Cell>::Element *E = cell_map.front(); E; E = E->next()) {
-		Vector3 p(E->key().x, E->key().y, E->key().z);
-		a[i++] = p;
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
+
+		const Octant *g = octant_map.get(*K);
+		for (const IndexKey *F = g->cells.next(NULL); F; F = g->cells.next(F)) {
+			Vector3 p(F->x, F->y, F->z);
+			a[i++] = p;
+		}
 	}
 
 	return a;
@@ -958,28 +1057,33 @@ Array GridMap::get_meshes() {
 	Vector3 ofs = _get_offset();
 	Array meshes;
 
-	for (Map<IndexKey, Cell>::Element *E = cell_map.front(); E; E = E->next()) {
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
 
-		int id = E->get().item;
-		if (!theme->has_item(id))
-			continue;
-		Ref<Mesh> mesh = theme->get_item_mesh(id);
-		if (mesh.is_null())
-			continue;
+		const Octant *g = octant_map.get(*K);
+		for (const IndexKey *F = g->cells.next(NULL); F; F = g->cells.next(F)) {
 
-		IndexKey ik = E->key();
+			const Cell &c = g->cells.get(*F);
+			int id = c.item;
+			if (!theme->has_item(id))
+				continue;
+			Ref<Mesh> mesh = theme->get_item_mesh(id);
+			if (mesh.is_null())
+				continue;
 
-		Vector3 cellpos = Vector3(ik.x, ik.y, ik.z);
+			IndexKey ik = *F;
 
-		Transform xform;
+			Vector3 cellpos = Vector3(ik.x, ik.y, ik.z);
 
-		xform.basis.set_orthogonal_index(E->get().rot);
+			Transform xform;
 
-		xform.set_origin(cellpos * cell_size + ofs);
-		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
+			xform.basis.set_orthogonal_index(c.rot);
 
-		meshes.push_back(xform);
-		meshes.push_back(mesh);
+			xform.set_origin(cellpos * cell_size + ofs);
+			xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
+
+			meshes.push_back(xform);
+			meshes.push_back(mesh);
+		}
 	}
 
 	return meshes;
@@ -1010,53 +1114,53 @@ void GridMap::make_baked_meshes(bool p_gen_lightmap_uv, float p_lightmap_uv_texe
 	//generate
 	Map<OctantKey, Map<Ref<Material>, Ref<SurfaceTool> > > surface_map;
 
-	for (Map<IndexKey, Cell>::Element *E = cell_map.front(); E; E = E->next()) {
+	for (const OctantKey *K = octant_map.next(NULL); K; K = octant_map.next(K)) {
 
-		IndexKey key = E->key();
+		const Octant *g = octant_map.get(*K);
+		for (const IndexKey *F = g->cells.next(NULL); F; F = g->cells.next(F)) {
 
-		int item = E->get().item;
-		if (!theme->has_item(item))
-			continue;
+			IndexKey key = *F;
+			const Cell &c = g->cells.get(key);
 
-		Ref<Mesh> mesh = theme->get_item_mesh(item);
-		if (!mesh.is_valid())
-			continue;
+			int item = c.item;
+			if (!theme->has_item(item))
+				continue;
 
-		Vector3 cellpos = Vector3(key.x, key.y, key.z);
-		Vector3 ofs = _get_offset();
+			Ref<Mesh> mesh = theme->get_item_mesh(item);
+			if (!mesh.is_valid())
+				continue;
 
-		Transform xform;
+			Vector3 cellpos = Vector3(key.x, key.y, key.z);
+			Vector3 ofs = _get_offset();
 
-		xform.basis.set_orthogonal_index(E->get().rot);
-		xform.set_origin(cellpos * cell_size + ofs);
-		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
+			Transform xform;
 
-		OctantKey ok;
-		ok.x = key.x / octant_size;
-		ok.y = key.y / octant_size;
-		ok.z = key.z / octant_size;
+			xform.basis.set_orthogonal_index(c.rot);
+			xform.set_origin(cellpos * cell_size + ofs);
+			xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
 
-		if (!surface_map.has(ok)) {
-			surface_map[ok] = Map<Ref<Material>, Ref<SurfaceTool> >();
-		}
+			if (!surface_map.has(*K)) {
+				surface_map[*K] = Map<Ref<Material>, Ref<SurfaceTool> >();
+			}
 
-		Map<Ref<Material>, Ref<SurfaceTool> > &mat_map = surface_map[ok];
+			Map<Ref<Material>, Ref<SurfaceTool> > &mat_map = surface_map[*K];
 
-		for (int i = 0; i < mesh->get_surface_count(); i++) {
+			for (int i = 0; i < mesh->get_surface_count(); i++) {
 
-			if (mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES)
-				continue;
+				if (mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES)
+					continue;
 
-			Ref<Material> surf_mat = mesh->surface_get_material(i);
-			if (!mat_map.has(surf_mat)) {
-				Ref<SurfaceTool> st;
-				st.instance();
-				st->begin(Mesh::PRIMITIVE_TRIANGLES);
-				st->set_material(surf_mat);
-				mat_map[surf_mat] = st;
-			}
+				Ref<Material> surf_mat = mesh->surface_get_material(i);
+				if (!mat_map.has(surf_mat)) {
+					Ref<SurfaceTool> st;
+					st.instance();
+					st->begin(Mesh::PRIMITIVE_TRIANGLES);
+					st->set_material(surf_mat);
+					mat_map[surf_mat] = st;
+				}
 
-			mat_map[surf_mat]->append_from(mesh, i, xform);
+				mat_map[surf_mat]->append_from(mesh, i, xform);
+			}
 		}
 	}
 
@@ -1132,7 +1236,6 @@ GridMap::GridMap() {
 
 	navigation = NULL;
 	set_notify_transform(true);
-	recreating_octants = false;
 }
 
 GridMap::~GridMap() {
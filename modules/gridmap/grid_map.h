@@ -31,10 +31,12 @@
 #ifndef GRID_MAP_H
 #define GRID_MAP_H
 
+#include "local_vector.h"
 #include "scene/3d/navigation.h"
 #include "scene/3d/spatial.h"
 #include "scene/resources/mesh_library.h"
 #include "scene/resources/multimesh.h"
+#include "swiss_hash_map.h"
 
 //heh heh, godotsphir!! this shares no code and the design is completely different with previous projects i've done..
 //should scale better with hardware that supports instancing
@@ -62,9 +64,19 @@ class GridMap : public Spatial {
 			return key < p_key.key;
 		}
 
+		_FORCE_INLINE_ bool operator==(const IndexKey &p_key) const {
+
+			return key == p_key.key;
+		}
+
 		IndexKey() { key = 0; }
 	};
 
+	struct IndexKeyHasher {
+
+		static _FORCE_INLINE_ uint32_t hash(const IndexKey &p_key) { return hash_one_uint64(p_key.key); }
+	};
+
 	/**
 	 * @brief A Cell is a single cell in the cube map space; it is defined by its coordinates and the populating Item, identified by int id.
 	 */
@@ -108,7 +120,7 @@ class GridMap : public Spatial {
 		};
 
 		Vector<MultimeshInstance> multimesh_instances;
-		Set<IndexKey> cells;
+		SwissHashMap<IndexKey, Cell, IndexKeyHasher> cells; // the cells are stored in their octant, which works as a chunk
 		RID collision_debug;
 		RID collision_debug_instance;
 
@@ -133,10 +145,49 @@ class GridMap : public Spatial {
 			return key < p_key.key;
 		}
 
+		_FORCE_INLINE_ bool operator==(const OctantKey &p_key) const {
+
+			return key == p_key.key;
+		}
+
 		//OctantKey(const IndexKey& p_k, int p_item) { indexkey=p_k.key; item=p_item; }
 		OctantKey() { key = 0; }
 	};
 
+	struct OctantKeyHasher {
+
+		static _FORCE_INLINE_ uint32_t hash(const OctantKey &p_key) { return hash_one_uint64(p_key.key); }
+	};
+
+	/**
+	 * @brief The work of an update of the dirty octants. The cell transforms are computed and grouped on worker threads,
+	 * then the multimeshes, shapes and navmeshes are created from them on the main thread.
+	 */
+	struct OctantUpdate {
+
+		struct Item {
+			Ref<Mesh> mesh;
+			Vector<MeshLibrary::ShapeData> shapes;
+			Ref<NavigationMesh> navmesh;
+		};
+
+		struct CellInstance {
+			IndexKey key;
+			int item;
+			Transform xform;
+		};
+
+		struct Build {
+			Octant *octant;
+			Map<int, LocalVector<CellInstance> > multimeshes;
+			LocalVector<CellInstance> shapes;
+			LocalVector<CellInstance> navmeshes;
+		};
+
+		HashMap<int, Item> items; // read only while building
+		LocalVector<Build> builds;
+	};
+
 	uint32_t collision_layer;
 	uint32_t collision_mask;
 
@@ -153,14 +204,11 @@ class GridMap : public Spatial {
 	bool clip_above;
 	int clip_floor;
 
-	bool recreating_octants;
-
 	Vector3::Axis clip_axis;
 
 	Ref<MeshLibrary> theme;
 
-	Map<OctantKey, Octant *> octant_map;
-	Map<IndexKey, Cell> cell_map;
+	SwissHashMap<OctantKey, Octant *, OctantKeyHasher> octant_map;
 
 	void _recreate_octant_data();
 
@@ -177,10 +225,30 @@ class GridMap : public Spatial {
 		return Vector3(p_key.x, p_key.y, p_key.z) * cell_size * octant_size;
 	}
 
+	_FORCE_INLINE_ OctantKey _get_octant_key(const IndexKey &p_key) const {
+
+		OctantKey ok;
+		ok.x = p_key.x / octant_size;
+		ok.y = p_key.y / octant_size;
+		ok.z = p_key.z / octant_size;
+		return ok;
+	}
+
+	_FORCE_INLINE_ const Cell *_get_cell(const IndexKey &p_key) const {
+
+		Octant *const *g = octant_map.getptr(_get_octant_key(p_key));
+		return g ? (*g)->cells.getptr(p_key) : NULL;
+	}
+
+	Octant *_create_octant(const OctantKey &p_key);
+	void _set_cell(const IndexKey &p_key, int p_item, int p_rot);
+	int _get_cell_count() const;
+
 	void _reset_physic_bodies_collision_filters();
 	void _octant_enter_world(const OctantKey &p_key);
 	void _octant_exit_world(const OctantKey &p_key);
-	bool _octant_update(const OctantKey &p_key);
+	void _octant_build(uint32_t p_index, OctantUpdate *p_update);
+	void _octant_apply(OctantUpdate::Build &p_build, const OctantUpdate &p_update);
 	void _octant_clean_up(const OctantKey &p_key);
 	void _octant_transform(const OctantKey &p_key);
 	bool awaiting_update;
@@ -244,6 +312,7 @@ public:
 	bool get_center_z() const;
 
 	void set_cell_item(int p_x, int p_y, int p_z, int p_item, int p_rot = 0);
+	void set_cells(const PoolVector<Vector3> &p_cells, const PoolVector<int> &p_items, const PoolVector<int> &p_orientations = PoolVector<int>());
 	int get_cell_item(int p_x, int p_y, int p_z) const;
 	int get_cell_item_orientation(int p_x, int p_y, int p_z) const;
 
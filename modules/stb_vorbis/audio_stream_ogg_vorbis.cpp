@@ -30,6 +30,8 @@
 
 #include "audio_stream_ogg_vorbis.h"
 
+#include "io/file_access_memory.h"
+#include "io/marshalls.h"
 #include "os/file_access.h"
 
 #pragma GCC diagnostic push
@@ -41,6 +43,12 @@ void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_fra
 
 	ERR_FAIL_COND(!active);
 
+	if (seek_pending) {
+		//skipped while virtual, the decoder catches up only when audio is needed again
+		stb_vorbis_seek(ogg_stream, frames_mixed);
+		seek_pending = false;
+	}
+
 	int todo = p_frames;
 
 	int start_buffer = 0;
@@ -121,6 +129,29 @@ void AudioStreamPlaybackOGGVorbis::seek(float p_time) {
 	frames_mixed = uint32_t(vorbis_stream->sample_rate * p_time);
 
 	stb_vorbis_seek(ogg_stream, frames_mixed);
+	seek_pending = false;
+}
+
+void AudioStreamPlaybackOGGVorbis::skip(float p_rate_scale, int p_frames) {
+
+	if (!active)
+		return;
+
+	uint64_t frames = frames_mixed + uint64_t(double(p_frames) * p_rate_scale * vorbis_stream->sample_rate / AudioServer::get_singleton()->get_mix_rate());
+	uint64_t length = uint64_t(vorbis_stream->get_length() * vorbis_stream->sample_rate);
+
+	if (frames >= length) {
+		uint64_t loop_begin = uint64_t(vorbis_stream->loop_offset * vorbis_stream->sample_rate);
+		if (!vorbis_stream->loop || loop_begin >= length) {
+			active = false;
+			return;
+		}
+		loops += (frames - loop_begin) / (length - loop_begin);
+		frames = loop_begin + (frames - loop_begin) % (length - loop_begin);
+	}
+
+	frames_mixed = frames;
+	seek_pending = true;
 }
 
 AudioStreamPlaybackOGGVorbis::~AudioStreamPlaybackOGGVorbis() {
@@ -130,8 +161,314 @@ AudioStreamPlaybackOGGVorbis::~AudioStreamPlaybackOGGVorbis() {
 	}
 }
 
+////////////////
+
+bool AudioStreamPlaybackOGGVorbisStreamed::_read_page() {
+
+	if (read_pos + PAGE_HEADER_LEN > file_len)
+		return false;
+
+	//keep the unconsumed data at the start, so a whole page always fits after it
+	if (page_begin > 0) {
+		movemem(page_buffer, page_buffer + page_begin, page_end - page_begin);
+		page_end -= page_begin;
+		page_begin = 0;
+	}
+
+	if (page_end + PAGE_MAX_LEN > page_buffer_len) {
+		page_buffer_len = page_end + PAGE_MAX_LEN;
+		page_buffer = (uint8_t *)memrealloc(page_buffer, page_buffer_len);
+	}
+
+	uint8_t *page = page_buffer + page_end;
+
+	f->seek(read_pos);
+	if (f->get_buffer(page, PAGE_HEADER_LEN) != PAGE_HEADER_LEN || page[0] != 'O' || page[1] != 'g' || page[2] != 'g' || page[3] != 'S')
+		return false;
+
+	int segments = page[PAGE_HEADER_LEN - 1];
+	if (f->get_buffer(page + PAGE_HEADER_LEN, segments) != segments)
+		return false;
+
+	int len = PAGE_HEADER_LEN + segments;
+	int body_len = 0;
+	for (int i = 0; i < segments; i++) {
+		body_len += page[PAGE_HEADER_LEN + i];
+	}
+
+	if (f->get_buffer(page + len, body_len) != body_len)
+		return false;
+
+	len += body_len;
+	page_end += len;
+	read_pos += len;
+	return true;
+}
+
+bool AudioStreamPlaybackOGGVorbisStreamed::_open_decoder() {
+
+	if (ogg_stream) {
+		stb_vorbis_close(ogg_stream);
+		ogg_stream = NULL;
+	}
+
+	read_pos = 0;
+	page_begin = 0;
+	page_end = 0;
+	pending_frames = 0;
+	seeking = false;
+
+	while (_read_page()) {
+
+		int used = 0;
+		int error = VORBIS__no_error;
+		ogg_stream = stb_vorbis_open_pushdata(page_buffer + page_begin, page_end - page_begin, &used, &error, &ogg_alloc);
+
+		if (ogg_stream) {
+			page_begin += used;
+			audio_begin = read_pos - (page_end - page_begin);
+			return true;
+		}
+
+		ERR_FAIL_COND_V(error != VORBIS_need_more_data, false);
+	}
+
+	return false;
+}
+
+bool AudioStreamPlaybackOGGVorbisStreamed::_find_page(size_t p_from, size_t p_to, size_t &r_pos, uint64_t &r_granule) {
+
+	uint8_t chunk[4096];
+	size_t pos = p_from;
+
+	while (pos < p_to) {
+
+		f->seek(pos);
+		int read = f->get_buffer(chunk, sizeof(chunk));
+		if (read < PAGE_HEADER_LEN)
+			return false;
+
+		for (int i = 0; i + PAGE_HEADER_LEN <= read && pos + i < p_to; i++) {
+
+			if (chunk[i] != 'O' || chunk[i + 1] != 'g' || chunk[i + 2] != 'g' || chunk[i + 3] != 'S' || chunk[i + 4] != 0)
+				continue;
+
+			uint64_t granule = decode_uint64(&chunk[i + 6]);
+			if (granule == uint64_t(-1))
+				continue; //no packet ends in this page
+
+			r_pos = pos + i;
+			r_granule = granule;
+			return true;
+		}
+
+		pos += read - PAGE_HEADER_LEN + 1;
+	}
+
+	return false;
+}
+
+size_t AudioStreamPlaybackOGGVorbisStreamed::_find_seek_page(uint64_t p_frame) {
+
+	if (p_frame < SEEK_PREROLL)
+		return audio_begin;
+
+	//bisect the file for the last page that ends before the target
+	uint64_t target = p_frame - SEEK_PREROLL;
+	size_t from = audio_begin;
+	size_t to = file_len;
+
+	while (to - from > SEEK_BISECT_MIN) {
+
+		size_t middle = from + (to - from) / 2;
+		size_t pos;
+		uint64_t granule;
+		if (_find_page(middle, to, pos, granule) && granule < target) {
+			from = pos;
+		} else {
+			to = middle;
+		}
+	}
+
+	return from;
+}
+
+float AudioStreamPlaybackOGGVorbisStreamed::get_stream_sampling_rate() {
+
+	return vorbis_stream->sample_rate;
+}
+
+void AudioStreamPlaybackOGGVorbisStreamed::_stream_seek(uint64_t p_frame) {
+
+	discard_to = p_frame;
+
+	size_t pos = _find_seek_page(p_frame);
+	if (pos == audio_begin) {
+		_open_decoder(); //decoding from the start is exact
+		return;
+	}
+
+	stb_vorbis_flush_pushdata(ogg_stream);
+	read_pos = pos;
+	page_begin = 0;
+	page_end = 0;
+	pending_frames = 0;
+	seeking = true;
+}
+
+int AudioStreamPlaybackOGGVorbisStreamed::_stream_decode(AudioFrame *p_buffer, int p_frames) {
+
+	if (!ogg_stream)
+		return 0;
+
+	int done = 0;
+
+	while (done < p_frames) {
+
+		if (pending_frames > 0) {
+
+			int todo = MIN(pending_frames, p_frames - done);
+			const float *l = pending_output[0] + pending_offset;
+			const float *r = pending_output[pending_channels > 1 ? 1 : 0] + pending_offset;
+			for (int i = 0; i < todo; i++) {
+				p_buffer[done + i] = AudioFrame(l[i], r[i]);
+			}
+			pending_offset += todo;
+			pending_frames -= todo;
+			done += todo;
+			continue;
+		}
+
+		int channels = 0;
+		int samples = 0;
+		float **output = NULL;
+		int used = stb_vorbis_decode_frame_pushdata(ogg_stream, page_buffer + page_begin, page_end - page_begin, &channels, &output, &samples);
+
+		if (used == 0) {
+			if (!_read_page())
+				break; //end of stream
+			continue;
+		}
+
+		page_begin += used;
+
+		int location = stb_vorbis_get_sample_offset(ogg_stream);
+		if (samples == 0 || location < 0)
+			continue;
+
+		uint64_t begin = uint64_t(location) - samples;
+
+		if (seeking) {
+			seeking = false;
+			if (begin > discard_to) {
+				//the page found was past the target, decode from the start instead
+				_open_decoder();
+				continue;
+			}
+		}
+
+		int skip = 0;
+		if (begin < discard_to) {
+			skip = MIN(uint64_t(samples), discard_to - begin);
+		}
+
+		pending_output = output;
+		pending_channels = channels;
+		pending_offset = skip;
+		pending_frames = samples - skip;
+	}
+
+	return done;
+}
+
+uint64_t AudioStreamPlaybackOGGVorbisStreamed::_stream_get_length() const {
+
+	return uint64_t(vorbis_stream->length * vorbis_stream->sample_rate + 0.5);
+}
+
+bool AudioStreamPlaybackOGGVorbisStreamed::_stream_has_loop() const {
+
+	return vorbis_stream->loop;
+}
+
+uint64_t AudioStreamPlaybackOGGVorbisStreamed::_stream_get_loop_begin() const {
+
+	uint64_t loop_begin = uint64_t(vorbis_stream->loop_offset * vorbis_stream->sample_rate);
+	return loop_begin < _stream_get_length() ? loop_begin : 0;
+}
+
+AudioStreamPlaybackOGGVorbisStreamed::AudioStreamPlaybackOGGVorbisStreamed() {
+
+	f = NULL;
+	file_len = 0;
+	ogg_stream = NULL;
+	ogg_alloc.alloc_buffer = NULL;
+	ogg_alloc.alloc_buffer_length_in_bytes = 0;
+	page_buffer = NULL;
+	page_buffer_len = 0;
+	page_begin = 0;
+	page_end = 0;
+	read_pos = 0;
+	audio_begin = 0;
+	pending_output = NULL;
+	pending_channels = 0;
+	pending_offset = 0;
+	pending_frames = 0;
+	discard_to = 0;
+	seeking = false;
+}
+
+AudioStreamPlaybackOGGVorbisStreamed::~AudioStreamPlaybackOGGVorbisStreamed() {
+
+	_stream_finish();
+
+	if (ogg_stream) {
+		stb_vorbis_close(ogg_stream);
+	}
+	if (ogg_alloc.alloc_buffer) {
+		AudioServer::get_singleton()->audio_data_free(ogg_alloc.alloc_buffer);
+	}
+	if (page_buffer) {
+		memfree(page_buffer);
+	}
+	if (f) {
+		memdelete(f);
+	}
+}
+
+Ref<AudioStreamPlayback> AudioStreamOGGVorbis::_instance_streamed_playback() {
+
+	Ref<AudioStreamPlaybackOGGVorbisStreamed> ovs;
+	ovs.instance();
+	ovs->vorbis_stream = Ref<AudioStreamOGGVorbis>(this);
+
+	if (file != "") {
+		ovs->f = FileAccess::open(file, FileAccess::READ);
+		ERR_FAIL_COND_V(!ovs->f, Ref<AudioStreamPlayback>());
+	} else {
+		ERR_FAIL_COND_V(data == NULL, Ref<AudioStreamPlayback>());
+		FileAccessMemory *fa = memnew(FileAccessMemory);
+		fa->open_custom((const uint8_t *)data, data_len);
+		ovs->f = fa;
+	}
+
+	ovs->file_len = ovs->f->get_len();
+	ovs->ogg_alloc.alloc_buffer = (char *)AudioServer::get_singleton()->audio_data_alloc(decode_mem_size);
+	ovs->ogg_alloc.alloc_buffer_length_in_bytes = decode_mem_size;
+
+	ERR_FAIL_COND_V(!ovs->_open_decoder(), Ref<AudioStreamPlayback>());
+
+	ovs->_stream_init();
+
+	return ovs;
+}
+
 Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 
+	if (streaming || file != "") {
+		return _instance_streamed_playback();
+	}
+
 	Ref<AudioStreamPlaybackOGGVorbis> ovs;
 
 	ERR_FAIL_COND_V(data == NULL, ovs);
@@ -143,6 +480,7 @@ Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 	ovs->frames_mixed = 0;
 	ovs->active = false;
 	ovs->loops = 0;
+	ovs->seek_pending = false;
 	int error;
 	ovs->ogg_stream = stb_vorbis_open_memory((const unsigned char *)data, data_len, &error, &ovs->ogg_alloc);
 	if (!ovs->ogg_stream) {
@@ -171,6 +509,10 @@ void AudioStreamOGGVorbis::clear_data() {
 void AudioStreamOGGVorbis::set_data(const PoolVector<uint8_t> &p_data) {
 
 	int src_data_len = p_data.size();
+	if (src_data_len == 0) {
+		clear_data(); //streams reading from a file have no data
+		return;
+	}
 #define MAX_TEST_MEM (1 << 20)
 
 	uint32_t alloc_try = 1024;
@@ -256,6 +598,102 @@ float AudioStreamOGGVorbis::get_loop_offset() const {
 	return loop_offset;
 }
 
+void AudioStreamOGGVorbis::set_streaming(bool p_enable) {
+	streaming = p_enable;
+}
+
+bool AudioStreamOGGVorbis::is_streaming() const {
+
+	return streaming;
+}
+
+void AudioStreamOGGVorbis::set_file(const String &p_file) {
+
+	file = p_file;
+	if (file == "")
+		return;
+
+	FileAccess *f = FileAccess::open(file, FileAccess::READ);
+	ERR_FAIL_COND(!f);
+
+	//open the decoder with growing amounts of data and memory, until the headers fit
+	size_t file_len = f->get_len();
+	size_t header_len = MIN(file_len, size_t(1 << 14));
+	uint32_t alloc_try = 1024;
+	Vector<uint8_t> header;
+	Vector<char> alloc_mem;
+	stb_vorbis *ogg_stream = NULL;
+
+	while (alloc_try < MAX_TEST_MEM) {
+
+		header.resize(header_len);
+		f->seek(0);
+		f->get_buffer(header.ptrw(), header_len);
+
+		alloc_mem.resize(alloc_try);
+		stb_vorbis_alloc ogg_alloc;
+		ogg_alloc.alloc_buffer = alloc_mem.ptrw();
+		ogg_alloc.alloc_buffer_length_in_bytes = alloc_try;
+
+		int used;
+		int error;
+		ogg_stream = stb_vorbis_open_pushdata(header.ptr(), header_len, &used, &error, &ogg_alloc);
+
+		if (ogg_stream) {
+			break;
+		} else if (error == VORBIS_outofmem) {
+			alloc_try *= 2;
+		} else if (error == VORBIS_need_more_data && header_len < file_len) {
+			header_len = MIN(file_len, header_len * 2);
+		} else {
+			break;
+		}
+	}
+
+	if (!ogg_stream) {
+		memdelete(f);
+		ERR_EXPLAIN("Not a valid OGG Vorbis file: " + file);
+		ERR_FAIL();
+	}
+
+	stb_vorbis_info info = stb_vorbis_get_info(ogg_stream);
+	channels = info.channels;
+	sample_rate = info.sample_rate;
+	decode_mem_size = alloc_try;
+	stb_vorbis_close(ogg_stream);
+
+	//the length is the granule position of the last page
+	uint8_t tail[4096];
+	size_t tail_pos = file_len > sizeof(tail) ? file_len - sizeof(tail) : 0;
+	length = 0;
+	while (true) {
+		f->seek(tail_pos);
+		int read = f->get_buffer(tail, sizeof(tail));
+		for (int i = read - 27; i >= 0; i--) {
+			if (tail[i] == 'O' && tail[i + 1] == 'g' && tail[i + 2] == 'g' && tail[i + 3] == 'S' && tail[i + 4] == 0) {
+				uint64_t granule = decode_uint64(&tail[i + 6]);
+				if (granule != uint64_t(-1)) {
+					length = granule / sample_rate;
+					break;
+				}
+			}
+		}
+		if (length > 0 || tail_pos == 0)
+			break;
+		tail_pos = tail_pos > sizeof(tail) - 27 ? tail_pos - (sizeof(tail) - 27) : 0;
+	}
+
+	memdelete(f);
+
+	//streamed from the file, the data is not needed
+	clear_data();
+}
+
+String AudioStreamOGGVorbis::get_file() const {
+
+	return file;
+}
+
 float AudioStreamOGGVorbis::get_length() const {
 
 	return length;
@@ -272,9 +710,17 @@ void AudioStreamOGGVorbis::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_loop_offset", "seconds"), &AudioStreamOGGVorbis::set_loop_offset);
 	ClassDB::bind_method(D_METHOD("get_loop_offset"), &AudioStreamOGGVorbis::get_loop_offset);
 
+	ClassDB::bind_method(D_METHOD("set_streaming", "enable"), &AudioStreamOGGVorbis::set_streaming);
+	ClassDB::bind_method(D_METHOD("is_streaming"), &AudioStreamOGGVorbis::is_streaming);
+
+	ClassDB::bind_method(D_METHOD("set_file", "file"), &AudioStreamOGGVorbis::set_file);
+	ClassDB::bind_method(D_METHOD("get_file"), &AudioStreamOGGVorbis::get_file);
+
 	ADD_PROPERTY(PropertyInfo(Variant::POOL_BYTE_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "_set_data", "_get_data");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_loop", "has_loop");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "loop_offset", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_loop_offset", "get_loop_offset");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "streaming", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_streaming", "is_streaming");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "file", PROPERTY_HINT_FILE, "*.ogg"), "set_file", "get_file");
 }
 
 AudioStreamOGGVorbis::AudioStreamOGGVorbis() {
@@ -286,6 +732,7 @@ AudioStreamOGGVorbis::AudioStreamOGGVorbis() {
 	loop_offset = 0;
 	decode_mem_size = 0;
 	loop = false;
+	streaming = false;
 }
 
 AudioStreamOGGVorbis::~AudioStreamOGGVorbis() {
@@ -32,7 +32,9 @@
 #define AUDIO_STREAM_STB_VORBIS_H
 
 #include "io/resource_loader.h"
+#include "os/file_access.h"
 #include "servers/audio/audio_stream.h"
+#include "servers/audio/audio_stream_streamer.h"
 
 #define STB_VORBIS_HEADER_ONLY
 #pragma GCC diagnostic push
@@ -51,6 +53,7 @@ class AudioStreamPlaybackOGGVorbis : public AudioStreamPlaybackResampled {
 	stb_vorbis_alloc ogg_alloc;
 	uint32_t frames_mixed;
 	bool active;
+	bool seek_pending;
 	int loops;
 
 	friend class AudioStreamOGGVorbis;
@@ -71,10 +74,69 @@ public:
 	virtual float get_playback_position() const;
 	virtual void seek(float p_time);
 
+	virtual void skip(float p_rate_scale, int p_frames);
+
 	AudioStreamPlaybackOGGVorbis() {}
 	~AudioStreamPlaybackOGGVorbis();
 };
 
+// decodes on the streamer thread, reading the compressed data one ogg page at a time
+class AudioStreamPlaybackOGGVorbisStreamed : public AudioStreamPlaybackStreamed {
+
+	GDCLASS(AudioStreamPlaybackOGGVorbisStreamed, AudioStreamPlaybackStreamed)
+
+	enum {
+		PAGE_HEADER_LEN = 27,
+		PAGE_MAX_LEN = PAGE_HEADER_LEN + 255 + 255 * 255,
+		SEEK_PREROLL = 8192, //frames, more than the largest vorbis block
+		SEEK_BISECT_MIN = 16384 //bytes, seeking decodes from the page found at this precision
+	};
+
+	FileAccess *f;
+	size_t file_len;
+	stb_vorbis *ogg_stream;
+	stb_vorbis_alloc ogg_alloc;
+
+	//pages read, but not yet consumed by the decoder
+	uint8_t *page_buffer;
+	int page_buffer_len;
+	int page_begin;
+	int page_end;
+	size_t read_pos;
+	size_t audio_begin;
+
+	//frames decoded, but not yet returned
+	float **pending_output;
+	int pending_channels;
+	int pending_offset;
+	int pending_frames;
+
+	uint64_t discard_to;
+	bool seeking; //the decoder resynchronized, position unknown until it finds a page with a granule position
+
+	friend class AudioStreamOGGVorbis;
+
+	Ref<AudioStreamOGGVorbis> vorbis_stream;
+
+	bool _read_page();
+	bool _open_decoder();
+	bool _find_page(size_t p_from, size_t p_to, size_t &r_pos, uint64_t &r_granule);
+	size_t _find_seek_page(uint64_t p_frame);
+
+protected:
+	virtual float get_stream_sampling_rate();
+
+	virtual void _stream_seek(uint64_t p_frame);
+	virtual int _stream_decode(AudioFrame *p_buffer, int p_frames);
+	virtual uint64_t _stream_get_length() const;
+	virtual bool _stream_has_loop() const;
+	virtual uint64_t _stream_get_loop_begin() const;
+
+public:
+	AudioStreamPlaybackOGGVorbisStreamed();
+	~AudioStreamPlaybackOGGVorbisStreamed();
+};
+
 class AudioStreamOGGVorbis : public AudioStream {
 
 	GDCLASS(AudioStreamOGGVorbis, AudioStream)
@@ -82,6 +144,7 @@ class AudioStreamOGGVorbis : public AudioStream {
 	RES_BASE_EXTENSION("oggstr");
 
 	friend class AudioStreamPlaybackOGGVorbis;
+	friend class AudioStreamPlaybackOGGVorbisStreamed;
 
 	void *data;
 	uint32_t data_len;
@@ -92,8 +155,12 @@ class AudioStreamOGGVorbis : public AudioStream {
 	float length;
 	bool loop;
 	float loop_offset;
+	bool streaming;
+	String file;
 	void clear_data();
 
+	Ref<AudioStreamPlayback> _instance_streamed_playback();
+
 protected:
 	static void _bind_methods();
 
@@ -104,6 +171,12 @@ public:
 	void set_loop_offset(float p_seconds);
 	float get_loop_offset() const;
 
+	void set_streaming(bool p_enable);
+	bool is_streaming() const;
+
+	void set_file(const String &p_file);
+	String get_file() const;
+
 	virtual Ref<AudioStreamPlayback> instance_playback();
 	virtual String get_stream_name() const;
 
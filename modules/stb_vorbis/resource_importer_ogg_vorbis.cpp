@@ -74,12 +74,14 @@ void ResourceImporterOGGVorbis::get_import_options(List<ImportOption> *r_options
 
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "loop"), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "loop_offset"), 0));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "streaming"), false));
 }
 
 Error ResourceImporterOGGVorbis::import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files) {
 
 	bool loop = p_options["loop"];
 	float loop_offset = p_options["loop_offset"];
+	bool streaming = p_options["streaming"];
 
 	FileAccess *f = FileAccess::open(p_source_file, FileAccess::READ);
 	if (!f) {
@@ -102,6 +104,7 @@ Error ResourceImporterOGGVorbis::import(const String &p_source_file, const Strin
 	ogg_stream->set_data(data);
 	ogg_stream->set_loop(loop);
 	ogg_stream->set_loop_offset(loop_offset);
+	ogg_stream->set_streaming(streaming);
 
 	return ResourceSaver::save(p_save_path + ".oggstr", ogg_stream);
 }
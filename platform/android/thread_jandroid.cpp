@@ -31,6 +31,7 @@
 #include "thread_jandroid.h"
 
 #include "core/safe_refcount.h"
+#include "frame_profiler.h"
 #include "os/memory.h"
 #include "script_language.h"
 
@@ -62,6 +63,7 @@ void *ThreadAndroid::thread_callback(void *userdata) {
 	pthread_setspecific(thread_id_key, (void *)t->id);
 	t->callback(t->user);
 	ScriptServer::thread_exit();
+	FrameProfiler::thread_exit();
 	return NULL;
 }
 
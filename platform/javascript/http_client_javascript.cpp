@@ -183,12 +183,26 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 	int to_read = MIN(read_limit, polled_response.size() - response_read_offset);
 	PoolByteArray chunk;
 	chunk.resize(to_read);
+	int read = 0;
 	PoolByteArray::Write write = chunk.write();
-	PoolByteArray::Read read = polled_response.read();
-	memcpy(write.ptr(), read.ptr() + response_read_offset, to_read);
+	read_response_body(write.ptr(), to_read, read);
 	write = PoolByteArray::Write();
+
+	return chunk;
+}
+
+Error HTTPClient::read_response_body(uint8_t *p_buffer, int p_max_bytes, int &r_read) {
+
+	r_read = 0;
+	ERR_FAIL_COND_V(status != STATUS_BODY, ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(p_max_bytes < 0, ERR_INVALID_PARAMETER);
+
+	int to_read = MIN(p_max_bytes, polled_response.size() - response_read_offset);
+	PoolByteArray::Read read = polled_response.read();
+	memcpy(p_buffer, read.ptr() + response_read_offset, to_read);
 	read = PoolByteArray::Read();
 	response_read_offset += to_read;
+	r_read = to_read;
 
 	if (response_read_offset == polled_response.size()) {
 		status = STATUS_CONNECTED;
@@ -196,7 +210,7 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 		godot_xhr_reset(xhr_id);
 	}
 
-	return chunk;
+	return OK;
 }
 
 void HTTPClient::set_blocking_mode(bool p_enable) {
@@ -215,6 +229,22 @@ void HTTPClient::set_read_chunk_size(int p_size) {
 	read_limit = p_size;
 }
 
+void HTTPClient::set_max_pipelined_requests(int p_max) {
+
+	ERR_EXPLAIN("HTTPClient request pipelining is not supported for the HTML5 platform");
+	ERR_FAIL_COND(p_max != 1);
+}
+
+int HTTPClient::get_max_pipelined_requests() const {
+
+	return 1;
+}
+
+int HTTPClient::get_pending_request_count() const {
+
+	return (status == STATUS_REQUESTING || status == STATUS_BODY) ? 1 : 0;
+}
+
 Error HTTPClient::poll() {
 
 	switch (status) {
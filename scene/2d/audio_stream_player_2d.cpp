@@ -33,8 +33,9 @@
 #include "engine.h"
 #include "scene/2d/area_2d.h"
 #include "scene/main/viewport.h"
+#include "servers/audio/audio_mix_kernels.h"
 
-void AudioStreamPlayer2D::_mix_audio() {
+void AudioStreamPlayer2D::_mix_audio(bool p_fadeout) {
 
 	if (!stream_playback.is_valid()) {
 		return;
@@ -60,6 +61,9 @@ void AudioStreamPlayer2D::_mix_audio() {
 	for (int i = 0; i < output_count; i++) {
 
 		Output current = outputs[i];
+		if (p_fadeout) {
+			current.vol = AudioFrame(0, 0);
+		}
 
 		//see if current output exists, to keep volume ramp
 		bool found = false;
@@ -82,42 +86,55 @@ void AudioStreamPlayer2D::_mix_audio() {
 			prev_outputs[i] = current;
 		}
 
+		if (voice.was_virtual) {
+			//audible again, fade in
+			prev_outputs[i].vol = AudioFrame(0, 0);
+		}
+
 		//mix!
 		AudioFrame vol_inc = (current.vol - prev_outputs[i].vol) / float(buffer_size);
-		AudioFrame vol = current.vol;
+		AudioFrame vol = prev_outputs[i].vol;
 
 		int cc = AudioServer::get_singleton()->get_channel_count();
 
-		if (cc == 1) {
-			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, 0);
+		for (int k = 0; k < cc; k++) {
+			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
+			AudioMixKernels::mix_ramp(target, buffer, buffer_size, vol, vol_inc);
+		}
 
-			for (int j = 0; j < buffer_size; j++) {
+		prev_outputs[i] = current;
+	}
 
-				target[j] += buffer[j] * vol;
-				vol += vol_inc;
-			}
+	prev_output_count = output_count;
 
-		} else {
-			AudioFrame *targets[4];
+	//stream is no longer active, disable this.
+	if (!stream_playback->is_playing()) {
+		active = false;
+	}
 
-			for (int k = 0; k < cc; k++) {
-				targets[k] = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
-			}
+	output_ready = false;
+}
 
-			for (int j = 0; j < buffer_size; j++) {
+void AudioStreamPlayer2D::_skip_audio() {
 
-				AudioFrame frame = buffer[j] * vol;
-				for (int k = 0; k < cc; k++) {
-					targets[k][j] += frame;
-				}
-				vol += vol_inc;
-			}
-		}
+	if (!stream_playback.is_valid()) {
+		return;
+	}
 
-		prev_outputs[i] = current;
+	if (!active) {
+		return;
 	}
 
-	prev_output_count = output_count;
+	if (setseek >= 0.0) {
+		stream_playback->start(setseek);
+		setseek = -1.0; //reset seek
+	} else if (!voice.was_virtual) {
+		//was mixed until now, fade out to avoid pops
+		_mix_audio(true);
+		return;
+	}
+
+	stream_playback->skip(pitch_scale, mix_buffer.size());
 
 	//stream is no longer active, disable this.
 	if (!stream_playback->is_playing()) {
@@ -131,7 +148,7 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_ENTER_TREE) {
 
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
+		AudioServer::get_singleton()->add_voice(&voice);
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
 		}
@@ -139,7 +156,7 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
 
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		AudioServer::get_singleton()->remove_voice(&voice);
 	}
 
 	if (p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS) {
@@ -219,6 +236,13 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 
 			output_count = new_output_count;
 			output_ready = true;
+
+			float loudest = 0;
+			for (int i = 0; i < new_output_count; i++) {
+				loudest = MAX(loudest, MAX(outputs[i].vol.l, outputs[i].vol.r));
+			}
+			voice.volume = loudest;
+			voice.bus_index = bus_index;
 		}
 
 		//start playing if requested
@@ -230,6 +254,8 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 			//_change_notify("playing"); //update property in editor
 		}
 
+		voice.playing = active;
+
 		//stop playing if no longer active
 		if (!active) {
 			set_physics_process_internal(false);
@@ -252,6 +278,7 @@ void AudioStreamPlayer2D::set_stream(Ref<AudioStream> p_stream) {
 		stream.unref();
 		active = false;
 		setseek = -1;
+		voice.playing = false;
 	}
 
 	stream = p_stream;
@@ -306,6 +333,7 @@ void AudioStreamPlayer2D::stop() {
 
 	if (stream_playback.is_valid()) {
 		active = false;
+		voice.playing = false;
 		set_physics_process_internal(false);
 		setplay = -1;
 	}
@@ -418,6 +446,16 @@ uint32_t AudioStreamPlayer2D::get_area_mask() const {
 	return area_mask;
 }
 
+void AudioStreamPlayer2D::set_voice_priority(int p_priority) {
+
+	voice.priority = p_priority;
+}
+
+int AudioStreamPlayer2D::get_voice_priority() const {
+
+	return voice.priority;
+}
+
 void AudioStreamPlayer2D::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_stream", "stream"), &AudioStreamPlayer2D::set_stream);
@@ -454,6 +492,9 @@ void AudioStreamPlayer2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_area_mask", "mask"), &AudioStreamPlayer2D::set_area_mask);
 	ClassDB::bind_method(D_METHOD("get_area_mask"), &AudioStreamPlayer2D::get_area_mask);
 
+	ClassDB::bind_method(D_METHOD("set_voice_priority", "priority"), &AudioStreamPlayer2D::set_voice_priority);
+	ClassDB::bind_method(D_METHOD("get_voice_priority"), &AudioStreamPlayer2D::get_voice_priority);
+
 	ClassDB::bind_method(D_METHOD("_bus_layout_changed"), &AudioStreamPlayer2D::_bus_layout_changed);
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "stream", PROPERTY_HINT_RESOURCE_TYPE, "AudioStream"), "set_stream", "get_stream");
@@ -465,6 +506,7 @@ void AudioStreamPlayer2D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "attenuation", PROPERTY_HINT_EXP_EASING), "set_attenuation", "get_attenuation");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "bus", PROPERTY_HINT_ENUM, ""), "set_bus", "get_bus");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "area_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_area_mask", "get_area_mask");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "voice_priority", PROPERTY_HINT_RANGE, "-128,127,1"), "set_voice_priority", "get_voice_priority");
 
 	ADD_SIGNAL(MethodInfo("finished"));
 }
@@ -483,6 +525,11 @@ AudioStreamPlayer2D::AudioStreamPlayer2D() {
 	setplay = -1;
 	output_ready = false;
 	area_mask = 1;
+
+	voice.mix_callback = _mix_audios;
+	voice.skip_callback = _skip_audios;
+	voice.userdata = this;
+
 	AudioServer::get_singleton()->connect("bus_layout_changed", this, "_bus_layout_changed");
 }
 
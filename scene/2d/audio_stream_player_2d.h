@@ -74,8 +74,12 @@ private:
 	bool autoplay;
 	StringName bus;
 
-	void _mix_audio();
-	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer2D *>(self)->_mix_audio(); }
+	AudioServer::Voice voice;
+
+	void _mix_audio(bool p_fadeout);
+	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer2D *>(self)->_mix_audio(false); }
+	void _skip_audio();
+	static void _skip_audios(void *self) { reinterpret_cast<AudioStreamPlayer2D *>(self)->_skip_audio(); }
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -123,6 +127,9 @@ public:
 	void set_area_mask(uint32_t p_mask);
 	uint32_t get_area_mask() const;
 
+	void set_voice_priority(int p_priority);
+	int get_voice_priority() const;
+
 	AudioStreamPlayer2D();
 	~AudioStreamPlayer2D();
 };
@@ -30,6 +30,8 @@
 
 #include "navigation2d.h"
 
+#include "os/thread_work_pool.h"
+
 #define USE_ENTRY_POINT
 
 void Navigation2D::_navpoly_link(int p_id) {
@@ -96,6 +98,13 @@ void Navigation2D::_navpoly_link(int p_id) {
 		}
 
 		p.center = center / plen;
+		p.index = -1;
+
+		p.rect = Rect2(_get_vertex(p.edges[0].point), Vector2());
+		for (int j = 1; j < plen; j++) {
+			p.rect.expand_to(_get_vertex(p.edges[j].point));
+		}
+		p.rect = p.rect.grow(cell_size);
 
 		//connect
 
@@ -136,6 +145,7 @@ void Navigation2D::_navpoly_link(int p_id) {
 	}
 
 	nm.linked = true;
+	index_dirty = true;
 }
 
 void Navigation2D::_navpoly_unlink(int p_id) {
@@ -204,10 +214,13 @@ void Navigation2D::_navpoly_unlink(int p_id) {
 	nm.polygons.clear();
 
 	nm.linked = false;
+	index_dirty = true;
 }
 
 int Navigation2D::navpoly_add(const Ref<NavigationPolygon> &p_mesh, const Transform2D &p_xform, Object *p_owner) {
 
+	RWLockWrite write_lock(index_lock);
+
 	int id = last_id++;
 	NavMesh nm;
 	nm.linked = false;
@@ -227,6 +240,9 @@ void Navigation2D::navpoly_set_transform(int p_id, const Transform2D &p_xform) {
 	NavMesh &nm = navpoly_map[p_id];
 	if (nm.xform == p_xform)
 		return; //bleh
+
+	RWLockWrite write_lock(index_lock);
+
 	_navpoly_unlink(p_id);
 	nm.xform = p_xform;
 	_navpoly_link(p_id);
@@ -234,20 +250,67 @@ void Navigation2D::navpoly_set_transform(int p_id, const Transform2D &p_xform) {
 void Navigation2D::navpoly_remove(int p_id) {
 
 	ERR_FAIL_COND(!navpoly_map.has(p_id));
+
+	RWLockWrite write_lock(index_lock);
+
 	_navpoly_unlink(p_id);
 	navpoly_map.erase(p_id);
 }
 
-Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
+struct _Navigation2DPolygonAxisCompare {
 
-	Polygon *begin_poly = NULL;
-	Polygon *end_poly = NULL;
-	Vector2 begin_point;
-	Vector2 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
+	int axis;
 
-	//look for point inside triangle
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T *p_a, const T *p_b) const { return p_a->center[axis] < p_b->center[axis]; }
+};
+
+int Navigation2D::_build_bvh(int p_from, int p_count) {
+
+	int index = bvh.size();
+	bvh.push_back(BVHNode());
+
+	Polygon **polygons = &bvh_polygons[p_from];
+
+	Rect2 rect = polygons[0]->rect;
+	Rect2 centers(polygons[0]->center, Vector2());
+	for (int i = 1; i < p_count; i++) {
+		rect = rect.merge(polygons[i]->rect);
+		centers.expand_to(polygons[i]->center);
+	}
+
+	if (p_count <= 4) {
+		BVHNode &leaf = bvh[index];
+		leaf.rect = rect;
+		leaf.children[0] = -1;
+		leaf.children[1] = -1;
+		leaf.from = p_from;
+		leaf.count = p_count;
+		return index;
+	}
+
+	// median split along the axis where the polygons are most spread
+	SortArray<Polygon *, _Navigation2DPolygonAxisCompare> sorter;
+	sorter.compare.axis = centers.size.x > centers.size.y ? 0 : 1;
+	int half = p_count / 2;
+	sorter.nth_element(0, p_count, half, polygons);
+
+	int left = _build_bvh(p_from, half);
+	int right = _build_bvh(p_from + half, p_count - half);
+
+	// children were pushed after this node, so it has to be looked up again
+	BVHNode &node = bvh[index];
+	node.rect = rect;
+	node.children[0] = left;
+	node.children[1] = right;
+	node.from = 0;
+	node.count = 0;
+	return index;
+}
+
+void Navigation2D::_update_index() {
+
+	polygon_list.clear();
 
 	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
 
@@ -256,85 +319,173 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
 
 			Polygon &p = F->get();
-			if (begin_d || end_d) {
-				for (int i = 2; i < p.edges.size(); i++) {
+			// the index keeps the navpoly order, so ties between polygons resolve like they used to
+			p.index = polygon_list.size();
+			polygon_list.push_back(&p);
+		}
+	}
 
-					if (begin_d > 0) {
+	bvh.clear();
+	bvh_polygons = polygon_list;
+	if (bvh_polygons.size()) {
+		_build_bvh(0, bvh_polygons.size());
+	}
 
-						if (Geometry::is_point_in_triangle(p_start, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+	index_dirty = false;
+}
 
-							begin_poly = &p;
-							begin_point = p_start;
-							begin_d = 0;
-							if (end_d == 0)
-								break;
-						}
-					}
+void Navigation2D::_lock_index() {
 
-					if (end_d > 0) {
+	while (true) {
 
-						if (Geometry::is_point_in_triangle(p_end, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+		if (index_lock)
+			index_lock->read_lock();
 
-							end_poly = &p;
-							end_point = p_end;
-							end_d = 0;
-							if (begin_d == 0)
-								break;
-						}
-					}
-				}
-			}
+		if (!index_dirty)
+			return;
 
-			p.prev_edge = -1;
+		// the index is only rebuilt while nothing else reads it
+		if (index_lock) {
+			index_lock->read_unlock();
+			index_lock->write_lock();
 		}
+
+		if (index_dirty) {
+			_update_index();
+		}
+
+		if (index_lock)
+			index_lock->write_unlock();
 	}
+}
+
+void Navigation2D::_unlock_index() {
+
+	if (index_lock)
+		index_lock->read_unlock();
+}
+
+static _FORCE_INLINE_ float _get_rect_distance_squared(const Rect2 &p_rect, const Vector2 &p_point) {
+
+	Vector2 closest;
+	closest.x = CLAMP(p_point.x, p_rect.position.x, p_rect.position.x + p_rect.size.x);
+	closest.y = CLAMP(p_point.y, p_rect.position.y, p_rect.position.y + p_rect.size.y);
+	return closest.distance_squared_to(p_point);
+}
+
+bool Navigation2D::_find_closest_point(const Vector2 &p_point, ClosestPoint &r_closest) const {
+
+	r_closest.polygon = NULL;
+	r_closest.distance = 1e20;
+
+	if (bvh.empty())
+		return false;
+
+	int stack[64];
+	int stack_size = 0;
+
+	//look for point inside triangle
+
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+		if (!node.rect.has_point(p_point))
+			continue;
+
+		if (node.children[0] >= 0) {
+			stack[stack_size++] = node.children[1];
+			stack[stack_size++] = node.children[0];
+			continue;
+		}
 
-	//start or end not inside triangle.. look for closest segment :|
-	if (begin_d || end_d) {
-		for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+		for (int j = 0; j < node.count; j++) {
 
-			if (!E->get().linked)
+			Polygon *p = bvh_polygons[node.from + j];
+			if (r_closest.polygon && r_closest.polygon->index < p->index)
 				continue;
-			for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-				Polygon &p = F->get();
-				int es = p.edges.size();
-				for (int i = 0; i < es; i++) {
-
-					Vector2 edge[2] = {
-						_get_vertex(p.edges[i].point),
-						_get_vertex(p.edges[(i + 1) % es].point)
-					};
-
-					if (begin_d > 0) {
-						Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_start, edge);
-						float d = spoint.distance_to(p_start);
-						if (d < begin_d) {
-							begin_poly = &p;
-							begin_point = spoint;
-							begin_d = d;
-						}
-					}
 
-					if (end_d > 0) {
-						Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_end, edge);
-						float d = spoint.distance_to(p_end);
-						if (d < end_d) {
-							end_poly = &p;
-							end_point = spoint;
-							end_d = d;
-						}
-					}
+			for (int i = 2; i < p->edges.size(); i++) {
+
+				if (Geometry::is_point_in_triangle(p_point, _get_vertex(p->edges[0].point), _get_vertex(p->edges[i - 1].point), _get_vertex(p->edges[i].point))) {
+
+					r_closest.polygon = p;
+					r_closest.point = p_point;
+					r_closest.distance = 0;
+					break;
+				}
+			}
+		}
+	}
+
+	if (r_closest.polygon)
+		return true;
+
+	//not inside triangle.. look for closest segment :|
+
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+
+		float closest_d = r_closest.distance;
+		if (r_closest.polygon && _get_rect_distance_squared(node.rect, p_point) > closest_d * closest_d)
+			continue;
+
+		if (node.children[0] >= 0) {
+			// nearest child on top of the stack, so it is searched first
+			int near_child = node.children[0];
+			int far_child = node.children[1];
+			if (_get_rect_distance_squared(bvh[near_child].rect, p_point) > _get_rect_distance_squared(bvh[far_child].rect, p_point)) {
+				SWAP(near_child, far_child);
+			}
+			stack[stack_size++] = far_child;
+			stack[stack_size++] = near_child;
+			continue;
+		}
+
+		for (int j = 0; j < node.count; j++) {
+
+			Polygon *p = bvh_polygons[node.from + j];
+			int es = p->edges.size();
+			for (int i = 0; i < es; i++) {
+
+				Vector2 edge[2] = {
+					_get_vertex(p->edges[i].point),
+					_get_vertex(p->edges[(i + 1) % es].point)
+				};
+
+				Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
+				float d = spoint.distance_to(p_point);
+				if (d < r_closest.distance || (d == r_closest.distance && r_closest.polygon && p->index < r_closest.polygon->index)) {
+					r_closest.polygon = p;
+					r_closest.point = spoint;
+					r_closest.distance = d;
 				}
 			}
 		}
 	}
 
-	if (!begin_poly || !end_poly) {
+	return r_closest.polygon != NULL;
+}
+
+Vector<Vector2> Navigation2D::_get_simple_path(SearchState &r_state, const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
+
+	ClosestPoint begin;
+	ClosestPoint end;
+
+	if (!_find_closest_point(p_start, begin) || !_find_closest_point(p_end, end)) {
 
 		return Vector<Vector2>(); //no path
 	}
 
+	Polygon *begin_poly = begin.polygon;
+	Polygon *end_poly = end.polygon;
+	Vector2 begin_point = begin.point;
+	Vector2 end_point = end.point;
+
 	if (begin_poly == end_poly) {
 
 		Vector<Vector2> path;
@@ -345,64 +496,61 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 		return path;
 	}
 
-	bool found_route = false;
-
-	List<Polygon *> open_list;
-
-	begin_poly->entry = p_start;
-
-	for (int i = 0; i < begin_poly->edges.size(); i++) {
-
-		if (begin_poly->edges[i].C) {
-
-			begin_poly->edges[i].C->prev_edge = begin_poly->edges[i].C_edge;
-#ifdef USE_ENTRY_POINT
-			Vector2 edge[2] = {
-				_get_vertex(begin_poly->edges[i].point),
-				_get_vertex(begin_poly->edges[(i + 1) % begin_poly->edges.size()].point)
-			};
-
-			Vector2 entry = Geometry::get_closest_point_to_segment_2d(begin_poly->entry, edge);
-			begin_poly->edges[i].C->distance = begin_poly->entry.distance_to(entry);
-			begin_poly->edges[i].C->entry = entry;
-#else
-			begin_poly->edges[i].C->distance = begin_poly->center.distance_to(begin_poly->edges[i].C->center);
-#endif
-			open_list.push_back(begin_poly->edges[i].C);
+	if (r_state.polygons.size() < polygon_list.size()) {
+		int from = r_state.polygons.size();
+		r_state.polygons.resize(polygon_list.size());
+		for (int i = from; i < polygon_list.size(); i++) {
+			r_state.polygons[i].pass = 0;
+		}
+	}
 
-			if (begin_poly->edges[i].C == end_poly) {
-				found_route = true;
-			}
+	r_state.pass++;
+	if (r_state.pass == 0) {
+		// wrapped around, old passes could be taken for this one
+		for (int i = 0; i < r_state.polygons.size(); i++) {
+			r_state.polygons[i].pass = 0;
 		}
+		r_state.pass = 1;
 	}
 
-	while (!found_route) {
+	uint32_t pass = r_state.pass;
+	SearchPolygon *sp = r_state.polygons.ptr();
+	LocalVector<OpenPolygon> &open_list = r_state.open_list;
+	SortArray<OpenPolygon, OpenPolygonComparator> heap;
 
-		if (open_list.size() == 0) {
-			//print_line("NOU OPEN LIST");
-			break;
-		}
-		//check open list
+	open_list.clear();
 
-		List<Polygon *>::Element *least_cost_poly = NULL;
-		float least_cost = 1e30;
+	SearchPolygon &begin_search = sp[begin_poly->index];
+	begin_search.pass = pass;
+	begin_search.entry = p_start;
+	begin_search.distance = 0;
+	begin_search.prev_edge = -1;
 
-		//this could be faster (cache previous results)
-		for (List<Polygon *>::Element *E = open_list.front(); E; E = E->next()) {
+	OpenPolygon begin_open;
+	begin_open.cost = begin_poly->center.distance_to(end_point);
+	begin_open.polygon = begin_poly;
+	open_list.push_back(begin_open);
 
-			Polygon *p = E->get();
+	bool found_route = false;
 
-			float cost = p->distance;
-			cost += p->center.distance_to(end_point);
+	while (open_list.size()) {
 
-			if (cost < least_cost) {
+		// least cost first, open_list is a binary heap
+		heap.pop_heap(0, open_list.size(), open_list.ptr());
+		OpenPolygon least_cost = open_list[open_list.size() - 1];
+		open_list.resize(open_list.size() - 1);
 
-				least_cost_poly = E;
-				least_cost = cost;
-			}
+		Polygon *p = least_cost.polygon;
+		SearchPolygon &ps = sp[p->index];
+
+		if (least_cost.cost > ps.distance + p->center.distance_to(end_point))
+			continue; // reached again after a cheaper route was found, that one is searched instead
+
+		if (p == end_poly) {
+			found_route = true;
+			break;
 		}
 
-		Polygon *p = least_cost_poly->get();
 		//open the neighbours for search
 		int es = p->edges.size();
 
@@ -419,49 +567,30 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 				_get_vertex(p->edges[(i + 1) % es].point)
 			};
 
-			Vector2 edge_entry = Geometry::get_closest_point_to_segment_2d(p->entry, edge);
-			float distance = p->entry.distance_to(edge_entry) + p->distance;
-
+			Vector2 edge_entry = Geometry::get_closest_point_to_segment_2d(ps.entry, edge);
+			float distance = ps.entry.distance_to(edge_entry) + ps.distance;
 #else
-
-			float distance = p->center.distance_to(e.C->center) + p->distance;
-
+			Vector2 edge_entry = e.C->center;
+			float distance = p->center.distance_to(e.C->center) + ps.distance;
 #endif
 
-			if (e.C->prev_edge != -1) {
-				//oh this was visited already, can we win the cost?
-
-				if (e.C->distance > distance) {
-
-					e.C->prev_edge = e.C_edge;
-					e.C->distance = distance;
-#ifdef USE_ENTRY_POINT
-					e.C->entry = edge_entry;
-#endif
-				}
-			} else {
-				//add to open neighbours
-
-				e.C->prev_edge = e.C_edge;
-				e.C->distance = distance;
-#ifdef USE_ENTRY_POINT
-				e.C->entry = edge_entry;
-#endif
+			// entry points move with the route, so a polygon can be opened again when a
+			// cheaper route reaches it after it was searched
+			SearchPolygon &cs = sp[e.C->index];
+			if (cs.pass == pass && cs.distance <= distance)
+				continue;
 
-				open_list.push_back(e.C);
+			cs.pass = pass;
+			cs.prev_edge = e.C_edge;
+			cs.distance = distance;
+			cs.entry = edge_entry;
 
-				if (e.C == end_poly) {
-					//oh my reached end! stop algorithm
-					found_route = true;
-					break;
-				}
-			}
+			OpenPolygon open;
+			open.cost = distance + e.C->center.distance_to(end_point);
+			open.polygon = e.C;
+			open_list.push_back(open);
+			heap.push_heap(0, open_list.size() - 1, 0, open, open_list.ptr());
 		}
-
-		if (found_route)
-			break;
-
-		open_list.erase(least_cost_poly);
 	}
 
 	if (found_route) {
@@ -490,8 +619,8 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 					left = begin_point;
 					right = begin_point;
 				} else {
-					int prev = p->prev_edge;
-					int prev_n = (p->prev_edge + 1) % p->edges.size();
+					int prev = sp[p->index].prev_edge;
+					int prev_n = (prev + 1) % p->edges.size();
 					left = _get_vertex(p->edges[prev].point);
 					right = _get_vertex(p->edges[prev_n].point);
 
@@ -505,22 +634,6 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 
 				bool skip = false;
 
-				/*
-				print_line("-----\nAPEX: "+(apex_point-end_point));
-				print_line("LEFT:");
-				print_line("\tPortal: "+(portal_left-end_point));
-				print_line("\tPoint: "+(left-end_point));
-				print_line("\tLeft Tangent: "+rtos(CLOCK_TANGENT(apex_point,portal_left,left)));
-				print_line("\tLeft Distance: "+rtos(portal_left.distance_squared_to(apex_point)));
-				print_line("\tLeft Test: "+rtos(CLOCK_TANGENT(apex_point,left,portal_right)));
-				print_line("RIGHT:");
-				print_line("\tPortal: "+(portal_right-end_point));
-				print_line("\tPoint: "+(right-end_point));
-				print_line("\tRight Tangent: "+rtos(CLOCK_TANGENT(apex_point,portal_right,right)));
-				print_line("\tRight Distance: "+rtos(portal_right.distance_squared_to(apex_point)));
-				print_line("\tRight Test: "+rtos(CLOCK_TANGENT(apex_point,right,portal_left)));
-				*/
-
 				if (CLOCK_TANGENT(apex_point, portal_left, left) >= 0) {
 					//process
 					if (portal_left.distance_squared_to(apex_point) < CMP_EPSILON || CLOCK_TANGENT(apex_point, left, portal_right) > 0) {
@@ -563,7 +676,7 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 				}
 
 				if (p != begin_poly)
-					p = p->edges[p->prev_edge].C;
+					p = p->edges[sp[p->index].prev_edge].C;
 				else
 					p = NULL;
 			}
@@ -573,8 +686,8 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 			Polygon *p = end_poly;
 
 			while (true) {
-				int prev = p->prev_edge;
-				int prev_n = (p->prev_edge + 1) % p->edges.size();
+				int prev = sp[p->index].prev_edge;
+				int prev_n = (prev + 1) % p->edges.size();
 				Vector2 point = (_get_vertex(p->edges[prev].point) + _get_vertex(p->edges[prev_n].point)) * 0.5;
 				path.push_back(point);
 				p = p->edges[prev].C;
@@ -603,108 +716,168 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 	return Vector<Vector2>();
 }
 
-Vector2 Navigation2D::get_closest_point(const Vector2 &p_point) {
-
-	Vector2 closest_point = Vector2();
-	float closest_point_d = 1e20;
+Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+	_lock_index();
+	Vector<Vector2> path;
+	if (search_mutex->try_lock() == OK) {
+		path = _get_simple_path(search, p_start, p_end, p_optimize);
+		search_mutex->unlock();
+	} else {
+		//another thread is using the shared state, search with a state of our own
+		SearchState state;
+		path = _get_simple_path(state, p_start, p_end, p_optimize);
+	}
+	_unlock_index();
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	return path;
+}
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
+void Navigation2D::_solve_batch(uint32_t p_state, PathBatch *p_batch) {
 
-				if (Geometry::is_point_in_triangle(p_point, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+	SearchState &state = p_batch->states[p_state];
 
-					return p_point; //inside triangle, nothing else to discuss
-				}
-			}
-		}
-	}
+	// each state takes paths until none are left, so a long path doesn't hold back a whole chunk
+	while (true) {
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+		uint32_t i = atomic_increment(&p_batch->next) - 1;
+		if (i >= uint32_t(p_batch->paths.size()))
+			break;
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+		Vector<Vector2> path = _get_simple_path(state, p_batch->starts[i], p_batch->ends[i], p_batch->optimize);
 
-			Polygon &p = F->get();
-			int es = p.edges.size();
-			for (int i = 0; i < es; i++) {
+		PoolVector<Vector2> &result = p_batch->paths[i];
+		result.resize(path.size());
+		PoolVector<Vector2>::Write w = result.write();
+		for (int j = 0; j < path.size(); j++) {
+			w[j] = path[j];
+		}
+	}
+}
 
-				Vector2 edge[2] = {
-					_get_vertex(p.edges[i].point),
-					_get_vertex(p.edges[(i + 1) % es].point)
-				};
+Array Navigation2D::_get_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize) {
 
-				Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
-				float d = spoint.distance_squared_to(p_point);
-				if (d < closest_point_d) {
+	int count = p_starts.size();
 
-					closest_point = spoint;
-					closest_point_d = d;
-				}
-			}
+	// copied out of the pool vectors so the workers don't lock them on every read
+	PathBatch batch;
+	batch.starts.resize(count);
+	batch.ends.resize(count);
+	{
+		PoolVector<Vector2>::Read r_starts = p_starts.read();
+		PoolVector<Vector2>::Read r_ends = p_ends.read();
+		for (int i = 0; i < count; i++) {
+			batch.starts[i] = r_starts[i];
+			batch.ends[i] = r_ends[i];
 		}
 	}
+	batch.optimize = p_optimize;
+	batch.paths.resize(count);
+	batch.next = 0;
+
+	//the shared pool does the work on this thread if it's busy, so the request thread can use it too
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (count > 1 && pool && pool->get_thread_count() > 0) {
+		int state_count = MIN(int(pool->get_thread_count()) + 1, count);
+		batch.states.resize(state_count);
+		pool->do_work(state_count, this, &Navigation2D::_solve_batch, &batch);
+	} else {
+		batch.states.resize(1);
+		_solve_batch(0, &batch);
+	}
+
+	Array paths;
+	paths.resize(count);
+	for (int i = 0; i < count; i++) {
+		paths[i] = batch.paths[i];
+	}
 
-	return closest_point;
+	return paths;
 }
 
-Object *Navigation2D::get_closest_point_owner(const Vector2 &p_point) {
+Array Navigation2D::get_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize) {
 
-	Object *owner = NULL;
-	Vector2 closest_point = Vector2();
-	float closest_point_d = 1e20;
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), Array());
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+	_lock_index();
+	Array paths = _get_simple_paths(p_starts, p_ends, p_optimize);
+	_unlock_index();
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	return paths;
+}
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
+void Navigation2D::_request_thread_func(void *p_self) {
 
-				if (Geometry::is_point_in_triangle(p_point, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+	Navigation2D *self = (Navigation2D *)p_self;
 
-					E->get().owner;
-				}
-			}
+	while (true) {
+
+		self->request_semaphore->wait();
+
+		self->request_mutex->lock();
+		if (self->request_exit) {
+			self->request_mutex->unlock();
+			break;
 		}
-	}
+		PathRequest request = self->requests.front()->get();
+		self->requests.pop_front();
+		self->request_mutex->unlock();
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+		self->_lock_index();
+		Array paths = self->_get_simple_paths(request.starts, request.ends, request.optimize);
+		self->_unlock_index();
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+		self->call_deferred("emit_signal", "simple_paths_completed", request.id, paths);
+	}
+}
 
-			Polygon &p = F->get();
-			int es = p.edges.size();
-			for (int i = 0; i < es; i++) {
+int Navigation2D::request_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize) {
 
-				Vector2 edge[2] = {
-					_get_vertex(p.edges[i].point),
-					_get_vertex(p.edges[(i + 1) % es].point)
-				};
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), -1);
 
-				Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
-				float d = spoint.distance_squared_to(p_point);
-				if (d < closest_point_d) {
+	PathRequest request;
+	request.id = ++last_request_id;
+	request.starts = p_starts;
+	request.ends = p_ends;
+	request.optimize = p_optimize;
 
-					closest_point = spoint;
-					closest_point_d = d;
-					owner = E->get().owner;
-				}
-			}
-		}
+	if (!request_thread && request_semaphore && request_mutex) {
+		request_thread = Thread::create(_request_thread_func, this);
 	}
 
-	return owner;
+	if (!request_thread) {
+		// no threads on this platform, still report the result like a thread would
+		Array paths = get_simple_paths(p_starts, p_ends, p_optimize);
+		call_deferred("emit_signal", "simple_paths_completed", request.id, paths);
+		return request.id;
+	}
+
+	request_mutex->lock();
+	requests.push_back(request);
+	request_mutex->unlock();
+	request_semaphore->post();
+
+	return request.id;
+}
+
+Vector2 Navigation2D::get_closest_point(const Vector2 &p_point) {
+
+	_lock_index();
+	ClosestPoint closest;
+	_find_closest_point(p_point, closest);
+	_unlock_index();
+
+	return closest.polygon ? closest.point : Vector2();
+}
+
+Object *Navigation2D::get_closest_point_owner(const Vector2 &p_point) {
+
+	_lock_index();
+	ClosestPoint closest;
+	_find_closest_point(p_point, closest);
+	_unlock_index();
+
+	return closest.polygon ? closest.polygon->owner->owner : NULL;
 }
 
 void Navigation2D::_bind_methods() {
@@ -714,8 +887,12 @@ void Navigation2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("navpoly_remove", "id"), &Navigation2D::navpoly_remove);
 
 	ClassDB::bind_method(D_METHOD("get_simple_path", "start", "end", "optimize"), &Navigation2D::get_simple_path, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("get_simple_paths", "starts", "ends", "optimize"), &Navigation2D::get_simple_paths, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("request_simple_paths", "starts", "ends", "optimize"), &Navigation2D::request_simple_paths, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("get_closest_point", "to_point"), &Navigation2D::get_closest_point);
 	ClassDB::bind_method(D_METHOD("get_closest_point_owner", "to_point"), &Navigation2D::get_closest_point_owner);
+
+	ADD_SIGNAL(MethodInfo("simple_paths_completed", PropertyInfo(Variant::INT, "request_id"), PropertyInfo(Variant::ARRAY, "paths")));
 }
 
 Navigation2D::Navigation2D() {
@@ -723,4 +900,36 @@ Navigation2D::Navigation2D() {
 	ERR_FAIL_COND(sizeof(Point) != 8);
 	cell_size = 1; // one pixel
 	last_id = 1;
+
+	index_dirty = false;
+	index_lock = RWLock::create();
+	search_mutex = Mutex::create();
+
+	request_thread = NULL;
+	request_semaphore = Semaphore::create();
+	request_mutex = Mutex::create();
+	request_exit = false;
+	last_request_id = 0;
+}
+
+Navigation2D::~Navigation2D() {
+
+	if (request_thread) {
+		request_mutex->lock();
+		request_exit = true;
+		request_mutex->unlock();
+		request_semaphore->post();
+		Thread::wait_to_finish(request_thread);
+		memdelete(request_thread);
+	}
+
+	if (request_semaphore)
+		memdelete(request_semaphore);
+	if (request_mutex)
+		memdelete(request_mutex);
+
+	if (index_lock)
+		memdelete(index_lock);
+	if (search_mutex)
+		memdelete(search_mutex);
 }
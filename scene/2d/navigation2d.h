@@ -31,6 +31,12 @@
 #ifndef NAVIGATION_2D_H
 #define NAVIGATION_2D_H
 
+#include "local_vector.h"
+#include "os/mutex.h"
+#include "os/rw_lock.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
 #include "scene/2d/navigation_polygon.h"
 #include "scene/2d/node_2d.h"
 
@@ -93,10 +99,8 @@ class Navigation2D : public Node2D {
 		Vector<Edge> edges;
 
 		Vector2 center;
-		Vector2 entry;
-
-		float distance;
-		int prev_edge;
+		Rect2 rect;
+		int index; // in polygon_list, also indexes the search state
 
 		bool clockwise;
 
@@ -155,6 +159,97 @@ class Navigation2D : public Node2D {
 	Map<int, NavMesh> navpoly_map;
 	int last_id;
 
+	// Index over the polygons of every linked navpoly, rebuilt by the first query
+	// after a navpoly changes. Queries can run on other threads, so they hold
+	// index_lock for reading and changes to the navpolys hold it for writing.
+	struct BVHNode {
+		Rect2 rect;
+		int children[2]; // -1 in leaves
+		int from; // leaves only, range of bvh_polygons
+		int count;
+	};
+
+	LocalVector<Polygon *> polygon_list;
+	LocalVector<BVHNode> bvh;
+	LocalVector<Polygon *> bvh_polygons;
+	bool index_dirty;
+	RWLock *index_lock;
+
+	int _build_bvh(int p_from, int p_count);
+	void _update_index();
+	void _lock_index();
+	void _unlock_index();
+
+	struct ClosestPoint {
+		Polygon *polygon;
+		Vector2 point;
+		float distance;
+	};
+
+	// The polygon containing the point, or the closest point on the polygon edges.
+	bool _find_closest_point(const Vector2 &p_point, ClosestPoint &r_closest) const;
+
+	// Per search data of the polygons, indexed by Polygon::index, so several paths
+	// can be searched at the same time.
+	struct SearchPolygon {
+		Vector2 entry;
+		float distance;
+		int prev_edge;
+		uint32_t pass;
+	};
+
+	struct OpenPolygon {
+		float cost;
+		Polygon *polygon;
+	};
+
+	struct OpenPolygonComparator {
+		// SortArray keeps the greatest on top of the heap, so the least cost is the greatest
+		_FORCE_INLINE_ bool operator()(const OpenPolygon &p_a, const OpenPolygon &p_b) const { return p_a.cost > p_b.cost; }
+	};
+
+	struct SearchState {
+		LocalVector<SearchPolygon> polygons;
+		LocalVector<OpenPolygon> open_list;
+		uint32_t pass;
+
+		SearchState() { pass = 0; }
+	};
+
+	// Reused by get_simple_path(), readers share the index lock so this has its own
+	SearchState search;
+	Mutex *search_mutex;
+
+	Vector<Vector2> _get_simple_path(SearchState &r_state, const Vector2 &p_start, const Vector2 &p_end, bool p_optimize);
+
+	struct PathBatch {
+		LocalVector<Vector2> starts;
+		LocalVector<Vector2> ends;
+		bool optimize;
+		LocalVector<PoolVector<Vector2> > paths;
+		LocalVector<SearchState> states;
+		uint32_t next;
+	};
+
+	struct PathRequest {
+		int id;
+		PoolVector<Vector2> starts;
+		PoolVector<Vector2> ends;
+		bool optimize;
+	};
+
+
+	Thread *request_thread;
+	Semaphore *request_semaphore;
+	Mutex *request_mutex;
+	List<PathRequest> requests;
+	bool request_exit;
+	int last_request_id;
+
+	void _solve_batch(uint32_t p_state, PathBatch *p_batch);
+	Array _get_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize);
+	static void _request_thread_func(void *p_self);
+
 protected:
 	static void _bind_methods();
 
@@ -165,10 +260,13 @@ public:
 	void navpoly_remove(int p_id);
 
 	Vector<Vector2> get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize = true);
+	Array get_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize = true);
+	int request_simple_paths(const PoolVector<Vector2> &p_starts, const PoolVector<Vector2> &p_ends, bool p_optimize = true);
 	Vector2 get_closest_point(const Vector2 &p_point);
 	Object *get_closest_point_owner(const Vector2 &p_point);
 
 	Navigation2D();
+	~Navigation2D();
 };
 
 #endif // Navigation2D2D_H
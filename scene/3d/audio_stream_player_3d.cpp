@@ -33,7 +33,23 @@
 #include "scene/3d/area.h"
 #include "scene/3d/camera.h"
 #include "scene/main/viewport.h"
-void AudioStreamPlayer3D::_mix_audio() {
+#include "servers/audio/audio_mix_kernels.h"
+
+float AudioStreamPlayer3D::_get_output_pitch_scale() const {
+
+	if (!output_count) {
+		return 1.0;
+	}
+
+	//used for doppler, not realistic but good enough
+	float output_pitch_scale = 0.0;
+	for (int i = 0; i < output_count; i++) {
+		output_pitch_scale += outputs[i].pitch_scale;
+	}
+	return output_pitch_scale / float(output_count);
+}
+
+void AudioStreamPlayer3D::_mix_audio(bool p_fadeout) {
 
 	if (!stream_playback.is_valid()) {
 		return;
@@ -57,24 +73,19 @@ void AudioStreamPlayer3D::_mix_audio() {
 	//mix
 	if (output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX) {
 
-		float output_pitch_scale = 0.0;
-		if (output_count) {
-			//used for doppler, not realistic but good enough
-			for (int i = 0; i < output_count; i++) {
-				output_pitch_scale += outputs[i].pitch_scale;
-			}
-			output_pitch_scale /= float(output_count);
-		} else {
-			output_pitch_scale = 1.0;
-		}
-
-		stream_playback->mix(buffer, pitch_scale * output_pitch_scale, buffer_size);
+		stream_playback->mix(buffer, pitch_scale * _get_output_pitch_scale(), buffer_size);
 	}
 
 	//write all outputs
 	for (int i = 0; i < output_count; i++) {
 
 		Output current = outputs[i];
+		if (p_fadeout) {
+			for (int k = 0; k < 4; k++) {
+				current.vol[k] = AudioFrame(0, 0);
+				current.reverb_vol[k] = AudioFrame(0, 0);
+			}
+		}
 
 		//see if current output exists, to keep volume ramp
 		bool found = false;
@@ -100,13 +111,21 @@ void AudioStreamPlayer3D::_mix_audio() {
 			interpolate_filter = false;
 		}
 
+		if (voice.was_virtual) {
+			//audible again, fade in
+			for (int k = 0; k < 4; k++) {
+				prev_outputs[i].vol[k] = AudioFrame(0, 0);
+				prev_outputs[i].reverb_vol[k] = AudioFrame(0, 0);
+			}
+		}
+
 		//mix!
 
 		int buffers = AudioServer::get_singleton()->get_channel_count();
 
 		for (int k = 0; k < buffers; k++) {
 			AudioFrame vol_inc = (current.vol[k] - prev_outputs[i].vol[k]) / float(buffer_size);
-			AudioFrame vol = current.vol[k];
+			AudioFrame vol = prev_outputs[i].vol[k];
 
 			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
 
@@ -159,20 +178,10 @@ void AudioStreamPlayer3D::_mix_audio() {
 
 				if (current.reverb_bus_index == prev_outputs[i].reverb_bus_index) {
 					AudioFrame rvol_inc = (current.reverb_vol[k] - prev_outputs[i].reverb_vol[k]) / float(buffer_size);
-					AudioFrame rvol = prev_outputs[i].reverb_vol[k];
-
-					for (int j = 0; j < buffer_size; j++) {
-
-						rtarget[j] += buffer[j] * rvol;
-						rvol += rvol_inc;
-					}
+					AudioMixKernels::mix_ramp(rtarget, buffer, buffer_size, prev_outputs[i].reverb_vol[k], rvol_inc);
 				} else {
 
-					AudioFrame rvol = current.reverb_vol[k];
-					for (int j = 0; j < buffer_size; j++) {
-
-						rtarget[j] += buffer[j] * rvol;
-					}
+					AudioMixKernels::mix_ramp(rtarget, buffer, buffer_size, current.reverb_vol[k], AudioFrame(0, 0));
 				}
 			}
 		}
@@ -190,6 +199,38 @@ void AudioStreamPlayer3D::_mix_audio() {
 	output_ready = false;
 }
 
+void AudioStreamPlayer3D::_skip_audio() {
+
+	if (!stream_playback.is_valid()) {
+		return;
+	}
+
+	if (!active) {
+		return;
+	}
+
+	if (setseek >= 0.0) {
+		stream_playback->start(setseek);
+		setseek = -1.0; //reset seek
+	} else if (!voice.was_virtual) {
+		//was mixed until now, fade out to avoid pops
+		_mix_audio(true);
+		return;
+	}
+
+	if (output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX) {
+
+		stream_playback->skip(pitch_scale * _get_output_pitch_scale(), mix_buffer.size());
+	}
+
+	//stream is no longer active, disable this.
+	if (!stream_playback->is_playing()) {
+		active = false;
+	}
+
+	output_ready = false;
+}
+
 float AudioStreamPlayer3D::_get_attenuation_db(float p_distance) const {
 
 	float att = 0;
@@ -227,7 +268,7 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 	if (p_what == NOTIFICATION_ENTER_TREE) {
 
 		velocity_tracker->reset(get_global_transform().origin);
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
+		AudioServer::get_singleton()->add_voice(&voice);
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
 		}
@@ -235,7 +276,7 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
 
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		AudioServer::get_singleton()->remove_voice(&voice);
 	}
 	if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
 
@@ -529,6 +570,17 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 
 			output_count = new_output_count;
 			output_ready = true;
+
+			float loudest = 0;
+			int channels = AudioServer::get_singleton()->get_channel_count();
+			for (int i = 0; i < new_output_count; i++) {
+				for (int k = 0; k < channels; k++) {
+					loudest = MAX(loudest, MAX(outputs[i].vol[k].l, outputs[i].vol[k].r));
+					loudest = MAX(loudest, MAX(outputs[i].reverb_vol[k].l, outputs[i].reverb_vol[k].r));
+				}
+			}
+			voice.volume = loudest;
+			voice.bus_index = new_output_count ? outputs[0].bus_index : bus_index;
 		}
 
 		//start playing if requested
@@ -540,6 +592,8 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 			///_change_notify("playing"); //update property in editor
 		}
 
+		voice.playing = active;
+
 		//stop playing if no longer active
 		if (!active) {
 			set_physics_process_internal(false);
@@ -562,6 +616,7 @@ void AudioStreamPlayer3D::set_stream(Ref<AudioStream> p_stream) {
 		stream.unref();
 		active = false;
 		setseek = -1;
+		voice.playing = false;
 	}
 
 	stream = p_stream;
@@ -634,6 +689,7 @@ void AudioStreamPlayer3D::stop() {
 
 	if (stream_playback.is_valid()) {
 		active = false;
+		voice.playing = false;
 		set_physics_process_internal(false);
 		setplay = -1;
 	}
@@ -825,6 +881,16 @@ AudioStreamPlayer3D::DopplerTracking AudioStreamPlayer3D::get_doppler_tracking()
 	return doppler_tracking;
 }
 
+void AudioStreamPlayer3D::set_voice_priority(int p_priority) {
+
+	voice.priority = p_priority;
+}
+
+int AudioStreamPlayer3D::get_voice_priority() const {
+
+	return voice.priority;
+}
+
 void AudioStreamPlayer3D::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_stream", "stream"), &AudioStreamPlayer3D::set_stream);
@@ -888,6 +954,9 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_doppler_tracking", "mode"), &AudioStreamPlayer3D::set_doppler_tracking);
 	ClassDB::bind_method(D_METHOD("get_doppler_tracking"), &AudioStreamPlayer3D::get_doppler_tracking);
 
+	ClassDB::bind_method(D_METHOD("set_voice_priority", "priority"), &AudioStreamPlayer3D::set_voice_priority);
+	ClassDB::bind_method(D_METHOD("get_voice_priority"), &AudioStreamPlayer3D::get_voice_priority);
+
 	ClassDB::bind_method(D_METHOD("_bus_layout_changed"), &AudioStreamPlayer3D::_bus_layout_changed);
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "stream", PROPERTY_HINT_RESOURCE_TYPE, "AudioStream"), "set_stream", "get_stream");
@@ -902,6 +971,7 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "out_of_range_mode", PROPERTY_HINT_ENUM, "Mix,Pause"), "set_out_of_range_mode", "get_out_of_range_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "bus", PROPERTY_HINT_ENUM, ""), "set_bus", "get_bus");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "area_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_area_mask", "get_area_mask");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "voice_priority", PROPERTY_HINT_RANGE, "-128,127,1"), "set_voice_priority", "get_voice_priority");
 	ADD_GROUP("Emission Angle", "emission_angle");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "emission_angle_enabled"), "set_emission_angle_enabled", "is_emission_angle_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "emission_angle_degrees", PROPERTY_HINT_RANGE, "0.1,90,0.1"), "set_emission_angle", "get_emission_angle");
@@ -950,6 +1020,10 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	out_of_range_mode = OUT_OF_RANGE_MIX;
 	doppler_tracking = DOPPLER_TRACKING_DISABLED;
 
+	voice.mix_callback = _mix_audios;
+	voice.skip_callback = _skip_audios;
+	voice.userdata = this;
+
 	velocity_tracker.instance();
 	AudioServer::get_singleton()->connect("bus_layout_changed", this, "_bus_layout_changed");
 }
@@ -110,8 +110,13 @@ private:
 	bool autoplay;
 	StringName bus;
 
-	void _mix_audio();
-	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_mix_audio(); }
+	AudioServer::Voice voice;
+
+	float _get_output_pitch_scale() const;
+	void _mix_audio(bool p_fadeout);
+	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_mix_audio(false); }
+	void _skip_audio();
+	static void _skip_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_skip_audio(); }
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -199,6 +204,9 @@ public:
 	void set_doppler_tracking(DopplerTracking p_tracking);
 	DopplerTracking get_doppler_tracking() const;
 
+	void set_voice_priority(int p_priority);
+	int get_voice_priority() const;
+
 	AudioStreamPlayer3D();
 	~AudioStreamPlayer3D();
 };
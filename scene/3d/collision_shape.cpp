@@ -37,7 +37,7 @@
 #include "scene/resources/ray_shape.h"
 #include "scene/resources/sphere_shape.h"
 #include "servers/visual_server.h"
-//TODO: Implement CylinderShape and HeightMapShape?
+//TODO: Implement CylinderShape?
 #include "mesh_instance.h"
 #include "physics_body.h"
 #include "quick_hull.h"
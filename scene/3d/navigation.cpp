@@ -30,6 +30,8 @@
 
 #include "navigation.h"
 
+#include "os/thread_work_pool.h"
+
 void Navigation::_navmesh_link(int p_id) {
 
 	ERR_FAIL_COND(!navmesh_map.has(p_id));
@@ -95,6 +97,14 @@ void Navigation::_navmesh_link(int p_id) {
 			p.center /= plen;
 		}
 
+		// grown by a cell, so queries exactly on the border still hit the polygon
+		p.aabb = AABB(_get_vertex(p.edges[0].point), Vector3());
+		for (int j = 1; j < plen; j++) {
+			p.aabb.expand_to(_get_vertex(p.edges[j].point));
+		}
+		p.aabb = p.aabb.grow(cell_size);
+		p.index = -1;
+
 		//connect
 
 		for (int j = 0; j < plen; j++) {
@@ -135,6 +145,7 @@ void Navigation::_navmesh_link(int p_id) {
 	}
 
 	nm.linked = true;
+	index_dirty = true;
 }
 
 void Navigation::_navmesh_unlink(int p_id) {
@@ -201,10 +212,13 @@ void Navigation::_navmesh_unlink(int p_id) {
 	nm.polygons.clear();
 
 	nm.linked = false;
+	index_dirty = true;
 }
 
 int Navigation::navmesh_add(const Ref<NavigationMesh> &p_mesh, const Transform &p_xform, Object *p_owner) {
 
+	RWLockWrite write_lock(index_lock);
+
 	int id = last_id++;
 	NavMesh nm;
 	nm.linked = false;
@@ -220,6 +234,8 @@ int Navigation::navmesh_add(const Ref<NavigationMesh> &p_mesh, const Transform &
 
 void Navigation::navmesh_set_transform(int p_id, const Transform &p_xform) {
 
+	RWLockWrite write_lock(index_lock);
+
 	ERR_FAIL_COND(!navmesh_map.has(p_id));
 	NavMesh &nm = navmesh_map[p_id];
 	if (nm.xform == p_xform)
@@ -230,12 +246,184 @@ void Navigation::navmesh_set_transform(int p_id, const Transform &p_xform) {
 }
 void Navigation::navmesh_remove(int p_id) {
 
+	RWLockWrite write_lock(index_lock);
+
 	ERR_FAIL_COND(!navmesh_map.has(p_id));
 	_navmesh_unlink(p_id);
 	navmesh_map.erase(p_id);
 }
 
-void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly) {
+struct _NavigationPolygonAxisCompare {
+
+	int axis;
+
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T *p_a, const T *p_b) const { return p_a->center[axis] < p_b->center[axis]; }
+};
+
+int Navigation::_build_bvh(int p_from, int p_count) {
+
+	int index = bvh.size();
+	bvh.push_back(BVHNode());
+
+	Polygon **polygons = &bvh_polygons[p_from];
+
+	AABB aabb = polygons[0]->aabb;
+	AABB centers(polygons[0]->center, Vector3());
+	for (int i = 1; i < p_count; i++) {
+		aabb.merge_with(polygons[i]->aabb);
+		centers.expand_to(polygons[i]->center);
+	}
+
+	if (p_count <= 4) {
+		BVHNode &leaf = bvh[index];
+		leaf.aabb = aabb;
+		leaf.children[0] = -1;
+		leaf.children[1] = -1;
+		leaf.from = p_from;
+		leaf.count = p_count;
+		return index;
+	}
+
+	// median split along the axis where the polygons are most spread
+	SortArray<Polygon *, _NavigationPolygonAxisCompare> sorter;
+	sorter.compare.axis = centers.get_longest_axis_index();
+	int half = p_count / 2;
+	sorter.nth_element(0, p_count, half, polygons);
+
+	int left = _build_bvh(p_from, half);
+	int right = _build_bvh(p_from + half, p_count - half);
+
+	// children were pushed after this node, so it has to be looked up again
+	BVHNode &node = bvh[index];
+	node.aabb = aabb;
+	node.children[0] = left;
+	node.children[1] = right;
+	node.from = 0;
+	node.count = 0;
+	return index;
+}
+
+void Navigation::_update_index() {
+
+	polygon_list.clear();
+
+	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+
+		if (!E->get().linked)
+			continue;
+		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+
+			Polygon &p = F->get();
+			// the index keeps the navmesh order, so ties between polygons resolve like they used to
+			p.index = polygon_list.size();
+			polygon_list.push_back(&p);
+		}
+	}
+
+	bvh.clear();
+	bvh_polygons = polygon_list;
+	if (bvh_polygons.size()) {
+		_build_bvh(0, bvh_polygons.size());
+	}
+
+	index_dirty = false;
+}
+
+void Navigation::_lock_index() {
+
+	while (true) {
+
+		if (index_lock)
+			index_lock->read_lock();
+
+		if (!index_dirty)
+			return;
+
+		// the index is only rebuilt while nothing else reads it
+		if (index_lock) {
+			index_lock->read_unlock();
+			index_lock->write_lock();
+		}
+
+		if (index_dirty) {
+			_update_index();
+		}
+
+		if (index_lock)
+			index_lock->write_unlock();
+	}
+}
+
+void Navigation::_unlock_index() {
+
+	if (index_lock)
+		index_lock->read_unlock();
+}
+
+static _FORCE_INLINE_ float _get_aabb_distance_squared(const AABB &p_aabb, const Vector3 &p_point) {
+
+	Vector3 closest = p_point;
+	for (int i = 0; i < 3; i++) {
+		closest[i] = CLAMP(closest[i], p_aabb.position[i], p_aabb.position[i] + p_aabb.size[i]);
+	}
+	return closest.distance_squared_to(p_point);
+}
+
+bool Navigation::_find_closest_point(const Vector3 &p_point, ClosestPoint &r_closest) const {
+
+	r_closest.polygon = NULL;
+	r_closest.distance = 1e20;
+
+	if (bvh.empty())
+		return false;
+
+	int stack[64];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+
+		float closest_d = r_closest.distance;
+		if (r_closest.polygon && _get_aabb_distance_squared(node.aabb, p_point) > closest_d * closest_d)
+			continue;
+
+		if (node.children[0] >= 0) {
+			// nearest child on top of the stack, so it is searched first
+			int near_child = node.children[0];
+			int far_child = node.children[1];
+			if (_get_aabb_distance_squared(bvh[near_child].aabb, p_point) > _get_aabb_distance_squared(bvh[far_child].aabb, p_point)) {
+				SWAP(near_child, far_child);
+			}
+			stack[stack_size++] = far_child;
+			stack[stack_size++] = near_child;
+			continue;
+		}
+
+		for (int j = 0; j < node.count; j++) {
+
+			Polygon *p = bvh_polygons[node.from + j];
+			for (int i = 2; i < p->edges.size(); i++) {
+
+				Face3 f(_get_vertex(p->edges[0].point), _get_vertex(p->edges[i - 1].point), _get_vertex(p->edges[i].point));
+				Vector3 spoint = f.get_closest_point_to(p_point);
+				float d = spoint.distance_to(p_point);
+				if (d < r_closest.distance || (d == r_closest.distance && r_closest.polygon && p->index < r_closest.polygon->index && r_closest.polygon != p)) {
+					r_closest.polygon = p;
+					r_closest.point = spoint;
+					r_closest.distance = d;
+					r_closest.normal = f.get_plane().normal;
+				}
+			}
+		}
+	}
+
+	return r_closest.polygon != NULL;
+}
+
+void Navigation::_clip_path(const SearchState &p_state, Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly) {
 
 	Vector3 from = path[path.size() - 1];
 
@@ -250,7 +438,7 @@ void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vec
 
 	while (from_poly != p_to_poly) {
 
-		int pe = from_poly->prev_edge;
+		int pe = p_state.polygons[from_poly->index].prev_edge;
 		Vector3 a = _get_vertex(from_poly->edges[pe].point);
 		Vector3 b = _get_vertex(from_poly->edges[(pe + 1) % from_poly->edges.size()].point);
 
@@ -269,52 +457,22 @@ void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vec
 	}
 }
 
-Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
+Vector<Vector3> Navigation::_get_simple_path(SearchState &r_state, const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
 
-	Polygon *begin_poly = NULL;
-	Polygon *end_poly = NULL;
-	Vector3 begin_point;
-	Vector3 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
+	ClosestPoint begin;
+	ClosestPoint end;
 
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
-
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 spoint = f.get_closest_point_to(p_start);
-				float dpoint = spoint.distance_to(p_start);
-				if (dpoint < begin_d) {
-					begin_d = dpoint;
-					begin_poly = &p;
-					begin_point = spoint;
-				}
-
-				spoint = f.get_closest_point_to(p_end);
-				dpoint = spoint.distance_to(p_end);
-				if (dpoint < end_d) {
-					end_d = dpoint;
-					end_poly = &p;
-					end_point = spoint;
-				}
-			}
-
-			p.prev_edge = -1;
-		}
-	}
-
-	if (!begin_poly || !end_poly) {
+	if (!_find_closest_point(p_start, begin) || !_find_closest_point(p_end, end)) {
 
 		//print_line("No Path Path");
 		return Vector<Vector3>(); //no path
 	}
 
+	Polygon *begin_poly = begin.polygon;
+	Polygon *end_poly = end.polygon;
+	Vector3 begin_point = begin.point;
+	Vector3 end_point = end.point;
+
 	if (begin_poly == end_poly) {
 
 		Vector<Vector3> path;
@@ -325,51 +483,61 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 		return path;
 	}
 
-	bool found_route = false;
-
-	List<Polygon *> open_list;
-
-	for (int i = 0; i < begin_poly->edges.size(); i++) {
-
-		if (begin_poly->edges[i].C) {
-
-			begin_poly->edges[i].C->prev_edge = begin_poly->edges[i].C_edge;
-			begin_poly->edges[i].C->distance = begin_poly->center.distance_to(begin_poly->edges[i].C->center);
-			open_list.push_back(begin_poly->edges[i].C);
+	if (r_state.polygons.size() < polygon_list.size()) {
+		int from = r_state.polygons.size();
+		r_state.polygons.resize(polygon_list.size());
+		for (int i = from; i < polygon_list.size(); i++) {
+			r_state.polygons[i].pass = 0;
+		}
+	}
 
-			if (begin_poly->edges[i].C == end_poly) {
-				found_route = true;
-			}
+	r_state.pass++;
+	if (r_state.pass == 0) {
+		// wrapped around, old passes could be taken for this one
+		for (int i = 0; i < r_state.polygons.size(); i++) {
+			r_state.polygons[i].pass = 0;
 		}
+		r_state.pass = 1;
 	}
 
-	while (!found_route) {
+	uint32_t pass = r_state.pass;
+	SearchPolygon *sp = r_state.polygons.ptr();
+	LocalVector<OpenPolygon> &open_list = r_state.open_list;
+	SortArray<OpenPolygon, OpenPolygonComparator> heap;
 
-		if (open_list.size() == 0) {
-			//print_line("NOU OPEN LIST");
-			break;
-		}
-		//check open list
+	open_list.clear();
 
-		List<Polygon *>::Element *least_cost_poly = NULL;
-		float least_cost = 1e30;
+	SearchPolygon &begin_search = sp[begin_poly->index];
+	begin_search.pass = pass;
+	begin_search.closed = false;
+	begin_search.distance = 0;
+	begin_search.prev_edge = -1;
 
-		//this could be faster (cache previous results)
-		for (List<Polygon *>::Element *E = open_list.front(); E; E = E->next()) {
+	OpenPolygon begin_open;
+	begin_open.cost = begin_poly->center.distance_to(end_point);
+	begin_open.polygon = begin_poly;
+	open_list.push_back(begin_open);
 
-			Polygon *p = E->get();
+	bool found_route = false;
 
-			float cost = p->distance;
-			cost += p->center.distance_to(end_point);
+	while (open_list.size()) {
 
-			if (cost < least_cost) {
+		// least cost first, open_list is a binary heap
+		heap.pop_heap(0, open_list.size(), open_list.ptr());
+		Polygon *p = open_list[open_list.size() - 1].polygon;
+		open_list.resize(open_list.size() - 1);
 
-				least_cost_poly = E;
-				least_cost = cost;
-			}
+		SearchPolygon &ps = sp[p->index];
+		if (ps.closed)
+			continue; // reached again after a cheaper route was found, already searched
+
+		ps.closed = true;
+
+		if (p == end_poly) {
+			found_route = true;
+			break;
 		}
 
-		Polygon *p = least_cost_poly->get();
 		//open the neighbours for search
 
 		for (int i = 0; i < p->edges.size(); i++) {
@@ -379,35 +547,27 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 			if (!e.C)
 				continue;
 
-			float distance = p->center.distance_to(e.C->center) + p->distance;
+			SearchPolygon &cs = sp[e.C->index];
+			float distance = p->center.distance_to(e.C->center) + ps.distance;
 
-			if (e.C->prev_edge != -1) {
-				//oh this was visited already, can we win the cost?
-
-				if (e.C->distance > distance) {
-
-					e.C->prev_edge = e.C_edge;
-					e.C->distance = distance;
-				}
+			if (cs.pass == pass) {
+				//visited already, can we win the cost?
+				if (cs.closed || cs.distance <= distance)
+					continue;
 			} else {
-				//add to open neighbours
-
-				e.C->prev_edge = e.C_edge;
-				e.C->distance = distance;
-				open_list.push_back(e.C);
-
-				if (e.C == end_poly) {
-					//oh my reached end! stop algorithm
-					found_route = true;
-					break;
-				}
+				cs.pass = pass;
+				cs.closed = false;
 			}
-		}
 
-		if (found_route)
-			break;
+			cs.prev_edge = e.C_edge;
+			cs.distance = distance;
 
-		open_list.erase(least_cost_poly);
+			OpenPolygon open;
+			open.cost = distance + e.C->center.distance_to(end_point);
+			open.polygon = e.C;
+			open_list.push_back(open);
+			heap.push_heap(0, open_list.size() - 1, 0, open, open_list.ptr());
+		}
 	}
 
 	if (found_route) {
@@ -437,8 +597,8 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 					left = begin_point;
 					right = begin_point;
 				} else {
-					int prev = p->prev_edge;
-					int prev_n = (p->prev_edge + 1) % p->edges.size();
+					int prev = sp[p->index].prev_edge;
+					int prev_n = (prev + 1) % p->edges.size();
 					left = _get_vertex(p->edges[prev].point);
 					right = _get_vertex(p->edges[prev_n].point);
 
@@ -457,7 +617,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 						portal_left = left;
 					} else {
 
-						_clip_path(path, apex_poly, portal_right, right_poly);
+						_clip_path(r_state, path, apex_poly, portal_right, right_poly);
 
 						apex_point = portal_right;
 						p = right_poly;
@@ -477,7 +637,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 						portal_right = right;
 					} else {
 
-						_clip_path(path, apex_poly, portal_left, left_poly);
+						_clip_path(r_state, path, apex_poly, portal_left, left_poly);
 
 						apex_point = portal_left;
 						p = left_poly;
@@ -490,7 +650,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 				}
 
 				if (p != begin_poly)
-					p = p->edges[p->prev_edge].C;
+					p = p->edges[sp[p->index].prev_edge].C;
 				else
 					p = NULL;
 			}
@@ -506,8 +666,8 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 
 			path.push_back(end_point);
 			while (true) {
-				int prev = p->prev_edge;
-				int prev_n = (p->prev_edge + 1) % p->edges.size();
+				int prev = sp[p->index].prev_edge;
+				int prev_n = (prev + 1) % p->edges.size();
 				Vector3 point = (_get_vertex(p->edges[prev].point) + _get_vertex(p->edges[prev_n].point)) * 0.5;
 				path.push_back(point);
 				p = p->edges[prev].C;
@@ -526,153 +686,269 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 	return Vector<Vector3>();
 }
 
-Vector3 Navigation::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool &p_use_collision) {
-
-	bool use_collision = p_use_collision;
-	Vector3 closest_point;
-	float closest_point_d = 1e20;
-	NavMesh *closest_navmesh = NULL;
-
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	_lock_index();
+	Vector<Vector3> path;
+	if (search_mutex->try_lock() == OK) {
+		path = _get_simple_path(search, p_start, p_end, p_optimize);
+		search_mutex->unlock();
+	} else {
+		//another thread is using the shared state, search with a state of our own
+		SearchState state;
+		path = _get_simple_path(state, p_start, p_end, p_optimize);
+	}
+	_unlock_index();
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
+	return path;
+}
 
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters;
-				if (f.intersects_segment(p_from, p_to, &inters)) {
+void Navigation::_solve_batch(uint32_t p_state, PathBatch *p_batch) {
 
-					if (!use_collision) {
-						closest_point = inters;
-						use_collision = true;
-						closest_point_d = p_from.distance_to(inters);
-						closest_navmesh = p.owner;
-					} else if (closest_point_d > inters.distance_to(p_from)) {
+	SearchState &state = p_batch->states[p_state];
 
-						closest_point = inters;
-						closest_point_d = p_from.distance_to(inters);
-						closest_navmesh = p.owner;
-					}
-				}
-			}
+	// each state takes paths until none are left, so a long path doesn't hold back a whole chunk
+	while (true) {
 
-			if (!use_collision) {
+		uint32_t i = atomic_increment(&p_batch->next) - 1;
+		if (i >= uint32_t(p_batch->paths.size()))
+			break;
 
-				for (int i = 0; i < p.edges.size(); i++) {
+		Vector<Vector3> path = _get_simple_path(state, p_batch->starts[i], p_batch->ends[i], p_batch->optimize);
 
-					Vector3 a, b;
+		PoolVector<Vector3> &result = p_batch->paths[i];
+		result.resize(path.size());
+		PoolVector<Vector3>::Write w = result.write();
+		for (int j = 0; j < path.size(); j++) {
+			w[j] = path[j];
+		}
+	}
+}
 
-					Geometry::get_closest_points_between_segments(p_from, p_to, _get_vertex(p.edges[i].point), _get_vertex(p.edges[(i + 1) % p.edges.size()].point), a, b);
+Array Navigation::_get_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize) {
 
-					float d = a.distance_to(b);
-					if (d < closest_point_d) {
+	int count = p_starts.size();
 
-						closest_point_d = d;
-						closest_point = b;
-						closest_navmesh = p.owner;
-					}
-				}
-			}
+	// copied out of the pool vectors so the workers don't lock them on every read
+	PathBatch batch;
+	batch.starts.resize(count);
+	batch.ends.resize(count);
+	{
+		PoolVector<Vector3>::Read r_starts = p_starts.read();
+		PoolVector<Vector3>::Read r_ends = p_ends.read();
+		for (int i = 0; i < count; i++) {
+			batch.starts[i] = r_starts[i];
+			batch.ends[i] = r_ends[i];
 		}
 	}
+	batch.optimize = p_optimize;
+	batch.paths.resize(count);
+	batch.next = 0;
+
+	//the shared pool does the work on this thread if it's busy, so the request thread can use it too
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (count > 1 && pool && pool->get_thread_count() > 0) {
+		int state_count = MIN(int(pool->get_thread_count()) + 1, count);
+		batch.states.resize(state_count);
+		pool->do_work(state_count, this, &Navigation::_solve_batch, &batch);
+	} else {
+		batch.states.resize(1);
+		_solve_batch(0, &batch);
+	}
 
-	if (closest_navmesh && closest_navmesh->owner) {
-		//print_line("navmesh is: "+Object::cast_to<Node>(closest_navmesh->owner)->get_name());
+	Array paths;
+	paths.resize(count);
+	for (int i = 0; i < count; i++) {
+		paths[i] = batch.paths[i];
 	}
 
-	return closest_point;
+	return paths;
 }
 
-Vector3 Navigation::get_closest_point(const Vector3 &p_point) {
+Array Navigation::get_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize) {
 
-	Vector3 closest_point;
-	float closest_point_d = 1e20;
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), Array());
 
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+	_lock_index();
+	Array paths = _get_simple_paths(p_starts, p_ends, p_optimize);
+	_unlock_index();
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	return paths;
+}
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-				}
-			}
+void Navigation::_request_thread_func(void *p_self) {
+
+	Navigation *self = (Navigation *)p_self;
+
+	while (true) {
+
+		self->request_semaphore->wait();
+
+		self->request_mutex->lock();
+		if (self->request_exit) {
+			self->request_mutex->unlock();
+			break;
 		}
+		PathRequest request = self->requests.front()->get();
+		self->requests.pop_front();
+		self->request_mutex->unlock();
+
+		self->_lock_index();
+		Array paths = self->_get_simple_paths(request.starts, request.ends, request.optimize);
+		self->_unlock_index();
+
+		self->call_deferred("emit_signal", "simple_paths_completed", request.id, paths);
 	}
+}
 
-	return closest_point;
+int Navigation::request_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize) {
+
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), -1);
+
+	PathRequest request;
+	request.id = ++last_request_id;
+	request.starts = p_starts;
+	request.ends = p_ends;
+	request.optimize = p_optimize;
+
+	if (!request_thread && request_semaphore && request_mutex) {
+		request_thread = Thread::create(_request_thread_func, this);
+	}
+
+	if (!request_thread) {
+		// no threads on this platform, still report the result like a thread would
+		Array paths = get_simple_paths(p_starts, p_ends, p_optimize);
+		call_deferred("emit_signal", "simple_paths_completed", request.id, paths);
+		return request.id;
+	}
+
+	request_mutex->lock();
+	requests.push_back(request);
+	request_mutex->unlock();
+	request_semaphore->post();
+
+	return request.id;
 }
 
-Vector3 Navigation::get_closest_point_normal(const Vector3 &p_point) {
+Vector3 Navigation::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool &p_use_collision) {
+
+	_lock_index();
 
 	Vector3 closest_point;
-	Vector3 closest_normal;
 	float closest_point_d = 1e20;
+	int closest_index = -1;
 
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+	int stack[64];
+	int stack_size = 0;
 
-		if (!E->get().linked)
+	// the intersection closest to the start of the segment wins
+	if (!bvh.empty()) {
+		stack[stack_size++] = 0;
+	}
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+		if (!node.aabb.intersects_segment(p_from, p_to))
 			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-					closest_normal = f.get_plane().normal;
+		if (node.children[0] >= 0) {
+			stack[stack_size++] = node.children[1];
+			stack[stack_size++] = node.children[0];
+			continue;
+		}
+
+		for (int j = 0; j < node.count; j++) {
+
+			Polygon *p = bvh_polygons[node.from + j];
+			for (int i = 2; i < p->edges.size(); i++) {
+
+				Face3 f(_get_vertex(p->edges[0].point), _get_vertex(p->edges[i - 1].point), _get_vertex(p->edges[i].point));
+				Vector3 inters;
+				if (f.intersects_segment(p_from, p_to, &inters)) {
+
+					float d = p_from.distance_to(inters);
+					if (d < closest_point_d || (d == closest_point_d && p->index < closest_index)) {
+						closest_point = inters;
+						closest_point_d = d;
+						closest_index = p->index;
+					}
 				}
 			}
 		}
 	}
 
-	return closest_normal;
-}
+	if (closest_index < 0 && !p_use_collision && !bvh.empty()) {
 
-Object *Navigation::get_closest_point_owner(const Vector3 &p_point) {
+		// no intersection, look for the closest point on the polygon borders
+		stack[stack_size++] = 0;
 
-	Vector3 closest_point;
-	Object *owner = NULL;
-	float closest_point_d = 1e20;
+		while (stack_size) {
 
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+			const BVHNode &node = bvh[stack[--stack_size]];
+			if (closest_index >= 0 && !node.aabb.grow(closest_point_d).intersects_segment(p_from, p_to))
+				continue;
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+			if (node.children[0] >= 0) {
+				stack[stack_size++] = node.children[1];
+				stack[stack_size++] = node.children[0];
+				continue;
+			}
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-					owner = E->get().owner;
+			for (int j = 0; j < node.count; j++) {
+
+				Polygon *p = bvh_polygons[node.from + j];
+				for (int i = 0; i < p->edges.size(); i++) {
+
+					Vector3 a, b;
+
+					Geometry::get_closest_points_between_segments(p_from, p_to, _get_vertex(p->edges[i].point), _get_vertex(p->edges[(i + 1) % p->edges.size()].point), a, b);
+
+					float d = a.distance_to(b);
+					if (d < closest_point_d || (d == closest_point_d && p->index < closest_index)) {
+
+						closest_point_d = d;
+						closest_point = b;
+						closest_index = p->index;
+					}
 				}
 			}
 		}
 	}
 
-	return owner;
+	_unlock_index();
+
+	return closest_point;
+}
+
+Vector3 Navigation::get_closest_point(const Vector3 &p_point) {
+
+	_lock_index();
+	ClosestPoint closest;
+	_find_closest_point(p_point, closest);
+	_unlock_index();
+
+	return closest.polygon ? closest.point : Vector3();
+}
+
+Vector3 Navigation::get_closest_point_normal(const Vector3 &p_point) {
+
+	_lock_index();
+	ClosestPoint closest;
+	_find_closest_point(p_point, closest);
+	_unlock_index();
+
+	return closest.polygon ? closest.normal : Vector3();
+}
+
+Object *Navigation::get_closest_point_owner(const Vector3 &p_point) {
+
+	_lock_index();
+	ClosestPoint closest;
+	_find_closest_point(p_point, closest);
+	_unlock_index();
+
+	return closest.polygon ? closest.polygon->owner->owner : NULL;
 }
 
 void Navigation::set_up_vector(const Vector3 &p_up) {
@@ -692,6 +968,8 @@ void Navigation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("navmesh_remove", "id"), &Navigation::navmesh_remove);
 
 	ClassDB::bind_method(D_METHOD("get_simple_path", "start", "end", "optimize"), &Navigation::get_simple_path, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("get_simple_paths", "starts", "ends", "optimize"), &Navigation::get_simple_paths, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("request_simple_paths", "starts", "ends", "optimize"), &Navigation::request_simple_paths, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("get_closest_point_to_segment", "start", "end", "use_collision"), &Navigation::get_closest_point_to_segment, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("get_closest_point", "to_point"), &Navigation::get_closest_point);
 	ClassDB::bind_method(D_METHOD("get_closest_point_normal", "to_point"), &Navigation::get_closest_point_normal);
@@ -701,6 +979,8 @@ void Navigation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_up_vector"), &Navigation::get_up_vector);
 
 	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "up_vector"), "set_up_vector", "get_up_vector");
+
+	ADD_SIGNAL(MethodInfo("simple_paths_completed", PropertyInfo(Variant::INT, "request_id"), PropertyInfo(Variant::ARRAY, "paths")));
 }
 
 Navigation::Navigation() {
@@ -709,4 +989,36 @@ Navigation::Navigation() {
 	cell_size = 0.01; //one centimeter
 	last_id = 1;
 	up = Vector3(0, 1, 0);
+
+	index_dirty = false;
+	index_lock = RWLock::create();
+	search_mutex = Mutex::create();
+
+	request_thread = NULL;
+	request_semaphore = Semaphore::create();
+	request_mutex = Mutex::create();
+	request_exit = false;
+	last_request_id = 0;
+}
+
+Navigation::~Navigation() {
+
+	if (request_thread) {
+		request_mutex->lock();
+		request_exit = true;
+		request_mutex->unlock();
+		request_semaphore->post();
+		Thread::wait_to_finish(request_thread);
+		memdelete(request_thread);
+	}
+
+	if (request_semaphore)
+		memdelete(request_semaphore);
+	if (request_mutex)
+		memdelete(request_mutex);
+
+	if (index_lock)
+		memdelete(index_lock);
+	if (search_mutex)
+		memdelete(search_mutex);
 }
@@ -31,6 +31,12 @@
 #ifndef NAVIGATION_H
 #define NAVIGATION_H
 
+#include "local_vector.h"
+#include "os/mutex.h"
+#include "os/rw_lock.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
 #include "scene/3d/navigation_mesh.h"
 #include "scene/3d/spatial.h"
 
@@ -94,9 +100,9 @@ class Navigation : public Spatial {
 		Vector<Edge> edges;
 
 		Vector3 center;
+		AABB aabb;
+		int index; // in polygon_list, also indexes the search state
 
-		float distance;
-		int prev_edge;
 		bool clockwise;
 
 		NavMesh *owner;
@@ -157,7 +163,98 @@ class Navigation : public Spatial {
 	int last_id;
 
 	Vector3 up;
-	void _clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly);
+
+	// Index over the polygons of every linked navmesh, rebuilt by the first query
+	// after a navmesh changes. Queries can run on other threads, so they hold
+	// index_lock for reading and changes to the navmeshes hold it for writing.
+	struct BVHNode {
+		AABB aabb;
+		int children[2]; // -1 in leaves
+		int from; // leaves only, range of bvh_polygons
+		int count;
+	};
+
+	LocalVector<Polygon *> polygon_list;
+	LocalVector<BVHNode> bvh;
+	LocalVector<Polygon *> bvh_polygons;
+	bool index_dirty;
+	RWLock *index_lock;
+
+	int _build_bvh(int p_from, int p_count);
+	void _update_index();
+	void _lock_index();
+	void _unlock_index();
+
+	struct ClosestPoint {
+		Polygon *polygon;
+		Vector3 point;
+		Vector3 normal;
+		float distance;
+	};
+
+	bool _find_closest_point(const Vector3 &p_point, ClosestPoint &r_closest) const;
+
+	// Per search data of the polygons, indexed by Polygon::index, so several paths
+	// can be searched at the same time.
+	struct SearchPolygon {
+		float distance;
+		int prev_edge;
+		uint32_t pass;
+		bool closed;
+	};
+
+	struct OpenPolygon {
+		float cost;
+		Polygon *polygon;
+	};
+
+	struct OpenPolygonComparator {
+		// SortArray keeps the greatest on top of the heap, so the least cost is the greatest
+		_FORCE_INLINE_ bool operator()(const OpenPolygon &p_a, const OpenPolygon &p_b) const { return p_a.cost > p_b.cost; }
+	};
+
+	struct SearchState {
+		LocalVector<SearchPolygon> polygons;
+		LocalVector<OpenPolygon> open_list;
+		uint32_t pass;
+
+		SearchState() { pass = 0; }
+	};
+
+	// Reused by get_simple_path(), readers share the index lock so this has its own
+	SearchState search;
+	Mutex *search_mutex;
+
+	void _clip_path(const SearchState &p_state, Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly);
+	Vector<Vector3> _get_simple_path(SearchState &r_state, const Vector3 &p_start, const Vector3 &p_end, bool p_optimize);
+
+	struct PathBatch {
+		LocalVector<Vector3> starts;
+		LocalVector<Vector3> ends;
+		bool optimize;
+		LocalVector<PoolVector<Vector3> > paths;
+		LocalVector<SearchState> states;
+		uint32_t next;
+	};
+
+	struct PathRequest {
+		int id;
+		PoolVector<Vector3> starts;
+		PoolVector<Vector3> ends;
+		bool optimize;
+	};
+
+
+	Thread *request_thread;
+	Semaphore *request_semaphore;
+	Mutex *request_mutex;
+	List<PathRequest> requests;
+	bool request_exit;
+	int last_request_id;
+
+	void _solve_batch(uint32_t p_state, PathBatch *p_batch);
+	Array _get_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize);
+	static void _request_thread_func(void *p_self);
 
 protected:
 	static void _bind_methods();
@@ -172,12 +269,15 @@ public:
 	void navmesh_remove(int p_id);
 
 	Vector<Vector3> get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize = true);
+	Array get_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize = true);
+	int request_simple_paths(const PoolVector<Vector3> &p_starts, const PoolVector<Vector3> &p_ends, bool p_optimize = true);
 	Vector3 get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool &p_use_collision = false);
 	Vector3 get_closest_point(const Vector3 &p_point);
 	Vector3 get_closest_point_normal(const Vector3 &p_point);
 	Object *get_closest_point_owner(const Vector3 &p_point);
 
 	Navigation();
+	~Navigation();
 };
 
 #endif // NAVIGATION_H
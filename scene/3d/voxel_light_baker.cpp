@@ -29,8 +29,9 @@
 /*************************************************************************/
 
 #include "voxel_light_baker.h"
+#include "hashfuncs.h"
 #include "os/os.h"
-#include "os/threaded_array_processor.h"
+#include "os/thread_work_pool.h"
 
 #include <stdlib.h>
 
@@ -258,118 +259,169 @@ static _FORCE_INLINE_ void get_uv_and_normal(const Vector3 &p_pos, const Vector3
 	r_normal = (p_normal[0] * u + p_normal[1] * v + p_normal[2] * w).normalized();
 }
 
-void VoxelLightBaker::_plot_face(int p_idx, int p_level, int p_x, int p_y, int p_z, const Vector3 *p_vtx, const Vector3 *p_normal, const Vector2 *p_uv, const MaterialCache &p_material, const AABB &p_aabb) {
+template <class M, class U>
+void VoxelLightBaker::_bake_work(uint32_t p_count, M p_method, U p_userdata) {
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (p_count > 1 && pool) {
+		pool->do_work(p_count, this, p_method, p_userdata);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, p_userdata);
+		}
+	}
+}
+
+void VoxelLightBaker::_plot_face(int p_idx, int p_level, int p_x, int p_y, int p_z, uint32_t p_face, const Vector3 *p_vtx, const AABB &p_aabb, LocalVector<PlotLeaf> &r_leaves) {
 
 	if (p_level == cell_subdiv - 1) {
-		//plot the face by guessing it's albedo and emission value
+		//colors are scanned later, in parallel
+		PlotLeaf leaf;
+		leaf.cell = p_idx;
+		leaf.face = p_face;
+		leaf.aabb = p_aabb;
+		r_leaves.push_back(leaf);
 
-		//find best axis to map to, for scanning values
-		int closest_axis = 0;
-		float closest_dot = 0;
+	} else {
+		//go down
+
+		int half = (1 << (cell_subdiv - 1)) >> (p_level + 1);
+		for (int i = 0; i < 8; i++) {
 
-		Plane plane = Plane(p_vtx[0], p_vtx[1], p_vtx[2]);
-		Vector3 normal = plane.normal;
+			AABB aabb = p_aabb;
+			aabb.size *= 0.5;
 
-		for (int i = 0; i < 3; i++) {
+			int nx = p_x;
+			int ny = p_y;
+			int nz = p_z;
 
-			Vector3 axis;
-			axis[i] = 1.0;
-			float dot = ABS(normal.dot(axis));
-			if (i == 0 || dot > closest_dot) {
-				closest_axis = i;
-				closest_dot = dot;
+			if (i & 1) {
+				aabb.position.x += aabb.size.x;
+				nx += half;
 			}
-		}
+			if (i & 2) {
+				aabb.position.y += aabb.size.y;
+				ny += half;
+			}
+			if (i & 4) {
+				aabb.position.z += aabb.size.z;
+				nz += half;
+			}
+			//make sure to not plot beyond limits
+			if (nx < 0 || nx >= axis_cell_size[0] || ny < 0 || ny >= axis_cell_size[1] || nz < 0 || nz >= axis_cell_size[2])
+				continue;
 
-		Vector3 axis;
-		axis[closest_axis] = 1.0;
-		Vector3 t1;
-		t1[(closest_axis + 1) % 3] = 1.0;
-		Vector3 t2;
-		t2[(closest_axis + 2) % 3] = 1.0;
+			{
+				AABB test_aabb = aabb;
+				//test_aabb.grow_by(test_aabb.get_longest_axis_size()*0.05); //grow a bit to avoid numerical error in real-time
+				Vector3 qsize = test_aabb.size * 0.5; //quarter size, for fast aabb test
 
-		t1 *= p_aabb.size[(closest_axis + 1) % 3] / float(color_scan_cell_width);
-		t2 *= p_aabb.size[(closest_axis + 2) % 3] / float(color_scan_cell_width);
+				if (!fast_tri_box_overlap(test_aabb.position + qsize, qsize, p_vtx)) {
+					//if (!Face3(p_vtx[0],p_vtx[1],p_vtx[2]).intersects_aabb2(aabb)) {
+					//does not fit in child, go on
+					continue;
+				}
+			}
+
+			if (bake_cells[p_idx].children[i] == CHILD_EMPTY) {
+				//sub cell must be created
 
-		Color albedo_accum;
-		Color emission_accum;
-		Vector3 normal_accum;
+				uint32_t child_idx = bake_cells.size();
+				bake_cells[p_idx].children[i] = child_idx;
+				bake_cells.resize(bake_cells.size() + 1);
+				bake_cells[child_idx].level = p_level + 1;
+			}
 
-		float alpha = 0.0;
+			_plot_face(bake_cells[p_idx].children[i], p_level + 1, nx, ny, nz, p_face, p_vtx, aabb, r_leaves);
+		}
+	}
+}
 
-		//map to a grid average in the best axis for this face
-		for (int i = 0; i < color_scan_cell_width; i++) {
+void VoxelLightBaker::_plot_leaf(uint32_t p_index, PlotBatch *p_batch) {
 
-			Vector3 ofs_i = float(i) * t1;
+	//plot the face by guessing it's albedo and emission value
+	PlotLeaf &leaf = p_batch->leaves[p_index];
+	const PlotFace &face = p_batch->faces[leaf.face];
+	const MaterialCache &material = *p_batch->material;
+	const Vector3 *vtx = face.vtx;
+	const AABB &aabb = leaf.aabb;
 
-			for (int j = 0; j < color_scan_cell_width; j++) {
+	//find best axis to map to, for scanning values
+	int closest_axis = 0;
+	float closest_dot = 0;
 
-				Vector3 ofs_j = float(j) * t2;
+	Plane plane = Plane(vtx[0], vtx[1], vtx[2]);
+	Vector3 normal = plane.normal;
 
-				Vector3 from = p_aabb.position + ofs_i + ofs_j;
-				Vector3 to = from + t1 + t2 + axis * p_aabb.size[closest_axis];
-				Vector3 half = (to - from) * 0.5;
+	for (int i = 0; i < 3; i++) {
 
-				//is in this cell?
-				if (!fast_tri_box_overlap(from + half, half, p_vtx)) {
-					continue; //face does not span this cell
-				}
+		Vector3 axis;
+		axis[i] = 1.0;
+		float dot = ABS(normal.dot(axis));
+		if (i == 0 || dot > closest_dot) {
+			closest_axis = i;
+			closest_dot = dot;
+		}
+	}
 
-				//go from -size to +size*2 to avoid skipping collisions
-				Vector3 ray_from = from + (t1 + t2) * 0.5 - axis * p_aabb.size[closest_axis];
-				Vector3 ray_to = ray_from + axis * p_aabb.size[closest_axis] * 2;
+	Vector3 axis;
+	axis[closest_axis] = 1.0;
+	Vector3 t1;
+	t1[(closest_axis + 1) % 3] = 1.0;
+	Vector3 t2;
+	t2[(closest_axis + 2) % 3] = 1.0;
 
-				if (normal.dot(ray_from - ray_to) < 0) {
-					SWAP(ray_from, ray_to);
-				}
+	t1 *= aabb.size[(closest_axis + 1) % 3] / float(color_scan_cell_width);
+	t2 *= aabb.size[(closest_axis + 2) % 3] / float(color_scan_cell_width);
 
-				Vector3 intersection;
+	Color albedo_accum;
+	Color emission_accum;
+	Vector3 normal_accum;
 
-				if (!plane.intersects_segment(ray_from, ray_to, &intersection)) {
-					if (ABS(plane.distance_to(ray_from)) < ABS(plane.distance_to(ray_to))) {
-						intersection = plane.project(ray_from);
-					} else {
+	float alpha = 0.0;
 
-						intersection = plane.project(ray_to);
-					}
-				}
+	//map to a grid average in the best axis for this face
+	for (int i = 0; i < color_scan_cell_width; i++) {
 
-				intersection = Face3(p_vtx[0], p_vtx[1], p_vtx[2]).get_closest_point_to(intersection);
+		Vector3 ofs_i = float(i) * t1;
 
-				Vector2 uv;
-				Vector3 lnormal;
-				get_uv_and_normal(intersection, p_vtx, p_uv, p_normal, uv, lnormal);
-				if (lnormal == Vector3()) //just in case normal as nor provided
-					lnormal = normal;
+		for (int j = 0; j < color_scan_cell_width; j++) {
 
-				int uv_x = CLAMP(Math::fposmod(uv.x, 1.0f) * bake_texture_size, 0, bake_texture_size - 1);
-				int uv_y = CLAMP(Math::fposmod(uv.y, 1.0f) * bake_texture_size, 0, bake_texture_size - 1);
+			Vector3 ofs_j = float(j) * t2;
 
-				int ofs = uv_y * bake_texture_size + uv_x;
-				albedo_accum.r += p_material.albedo[ofs].r;
-				albedo_accum.g += p_material.albedo[ofs].g;
-				albedo_accum.b += p_material.albedo[ofs].b;
-				albedo_accum.a += p_material.albedo[ofs].a;
+			Vector3 from = aabb.position + ofs_i + ofs_j;
+			Vector3 to = from + t1 + t2 + axis * aabb.size[closest_axis];
+			Vector3 half = (to - from) * 0.5;
 
-				emission_accum.r += p_material.emission[ofs].r;
-				emission_accum.g += p_material.emission[ofs].g;
-				emission_accum.b += p_material.emission[ofs].b;
+			//is in this cell?
+			if (!fast_tri_box_overlap(from + half, half, vtx)) {
+				continue; //face does not span this cell
+			}
 
-				normal_accum += lnormal;
+			//go from -size to +size*2 to avoid skipping collisions
+			Vector3 ray_from = from + (t1 + t2) * 0.5 - axis * aabb.size[closest_axis];
+			Vector3 ray_to = ray_from + axis * aabb.size[closest_axis] * 2;
 
-				alpha += 1.0;
+			if (normal.dot(ray_from - ray_to) < 0) {
+				SWAP(ray_from, ray_to);
 			}
-		}
 
-		if (alpha == 0) {
-			//could not in any way get texture information.. so use closest point to center
+			Vector3 intersection;
 
-			Face3 f(p_vtx[0], p_vtx[1], p_vtx[2]);
-			Vector3 inters = f.get_closest_point_to(p_aabb.position + p_aabb.size * 0.5);
+			if (!plane.intersects_segment(ray_from, ray_to, &intersection)) {
+				if (ABS(plane.distance_to(ray_from)) < ABS(plane.distance_to(ray_to))) {
+					intersection = plane.project(ray_from);
+				} else {
+
+					intersection = plane.project(ray_to);
+				}
+			}
+
+			intersection = Face3(vtx[0], vtx[1], vtx[2]).get_closest_point_to(intersection);
 
-			Vector3 lnormal;
 			Vector2 uv;
-			get_uv_and_normal(inters, p_vtx, p_uv, p_normal, uv, normal);
+			Vector3 lnormal;
+			get_uv_and_normal(intersection, vtx, face.uv, face.normal, uv, lnormal);
 			if (lnormal == Vector3()) //just in case normal as nor provided
 				lnormal = normal;
 
@@ -377,101 +429,106 @@ void VoxelLightBaker::_plot_face(int p_idx, int p_level, int p_x, int p_y, int p
 			int uv_y = CLAMP(Math::fposmod(uv.y, 1.0f) * bake_texture_size, 0, bake_texture_size - 1);
 
 			int ofs = uv_y * bake_texture_size + uv_x;
+			albedo_accum.r += material.albedo[ofs].r;
+			albedo_accum.g += material.albedo[ofs].g;
+			albedo_accum.b += material.albedo[ofs].b;
+			albedo_accum.a += material.albedo[ofs].a;
 
-			alpha = 1.0 / (color_scan_cell_width * color_scan_cell_width);
+			emission_accum.r += material.emission[ofs].r;
+			emission_accum.g += material.emission[ofs].g;
+			emission_accum.b += material.emission[ofs].b;
 
-			albedo_accum.r = p_material.albedo[ofs].r * alpha;
-			albedo_accum.g = p_material.albedo[ofs].g * alpha;
-			albedo_accum.b = p_material.albedo[ofs].b * alpha;
-			albedo_accum.a = p_material.albedo[ofs].a * alpha;
+			normal_accum += lnormal;
 
-			emission_accum.r = p_material.emission[ofs].r * alpha;
-			emission_accum.g = p_material.emission[ofs].g * alpha;
-			emission_accum.b = p_material.emission[ofs].b * alpha;
+			alpha += 1.0;
+		}
+	}
 
-			normal_accum = lnormal * alpha;
+	if (alpha == 0) {
+		//could not in any way get texture information.. so use closest point to center
 
-		} else {
+		Face3 f(vtx[0], vtx[1], vtx[2]);
+		Vector3 inters = f.get_closest_point_to(aabb.position + aabb.size * 0.5);
 
-			float accdiv = 1.0 / (color_scan_cell_width * color_scan_cell_width);
-			alpha *= accdiv;
+		Vector3 lnormal;
+		Vector2 uv;
+		get_uv_and_normal(inters, vtx, face.uv, face.normal, uv, normal);
+		if (lnormal == Vector3()) //just in case normal as nor provided
+			lnormal = normal;
 
-			albedo_accum.r *= accdiv;
-			albedo_accum.g *= accdiv;
-			albedo_accum.b *= accdiv;
-			albedo_accum.a *= accdiv;
+		int uv_x = CLAMP(Math::fposmod(uv.x, 1.0f) * bake_texture_size, 0, bake_texture_size - 1);
+		int uv_y = CLAMP(Math::fposmod(uv.y, 1.0f) * bake_texture_size, 0, bake_texture_size - 1);
 
-			emission_accum.r *= accdiv;
-			emission_accum.g *= accdiv;
-			emission_accum.b *= accdiv;
+		int ofs = uv_y * bake_texture_size + uv_x;
 
-			normal_accum *= accdiv;
-		}
+		alpha = 1.0 / (color_scan_cell_width * color_scan_cell_width);
 
-		//put this temporarily here, corrected in a later step
-		bake_cells[p_idx].albedo[0] += albedo_accum.r;
-		bake_cells[p_idx].albedo[1] += albedo_accum.g;
-		bake_cells[p_idx].albedo[2] += albedo_accum.b;
-		bake_cells[p_idx].emission[0] += emission_accum.r;
-		bake_cells[p_idx].emission[1] += emission_accum.g;
-		bake_cells[p_idx].emission[2] += emission_accum.b;
-		bake_cells[p_idx].normal[0] += normal_accum.x;
-		bake_cells[p_idx].normal[1] += normal_accum.y;
-		bake_cells[p_idx].normal[2] += normal_accum.z;
-		bake_cells[p_idx].alpha += alpha;
+		albedo_accum.r = material.albedo[ofs].r * alpha;
+		albedo_accum.g = material.albedo[ofs].g * alpha;
+		albedo_accum.b = material.albedo[ofs].b * alpha;
+		albedo_accum.a = material.albedo[ofs].a * alpha;
+
+		emission_accum.r = material.emission[ofs].r * alpha;
+		emission_accum.g = material.emission[ofs].g * alpha;
+		emission_accum.b = material.emission[ofs].b * alpha;
+
+		normal_accum = lnormal * alpha;
 
 	} else {
-		//go down
 
-		int half = (1 << (cell_subdiv - 1)) >> (p_level + 1);
-		for (int i = 0; i < 8; i++) {
+		float accdiv = 1.0 / (color_scan_cell_width * color_scan_cell_width);
+		alpha *= accdiv;
 
-			AABB aabb = p_aabb;
-			aabb.size *= 0.5;
+		albedo_accum.r *= accdiv;
+		albedo_accum.g *= accdiv;
+		albedo_accum.b *= accdiv;
+		albedo_accum.a *= accdiv;
 
-			int nx = p_x;
-			int ny = p_y;
-			int nz = p_z;
+		emission_accum.r *= accdiv;
+		emission_accum.g *= accdiv;
+		emission_accum.b *= accdiv;
 
-			if (i & 1) {
-				aabb.position.x += aabb.size.x;
-				nx += half;
-			}
-			if (i & 2) {
-				aabb.position.y += aabb.size.y;
-				ny += half;
-			}
-			if (i & 4) {
-				aabb.position.z += aabb.size.z;
-				nz += half;
-			}
-			//make sure to not plot beyond limits
-			if (nx < 0 || nx >= axis_cell_size[0] || ny < 0 || ny >= axis_cell_size[1] || nz < 0 || nz >= axis_cell_size[2])
-				continue;
+		normal_accum *= accdiv;
+	}
 
-			{
-				AABB test_aabb = aabb;
-				//test_aabb.grow_by(test_aabb.get_longest_axis_size()*0.05); //grow a bit to avoid numerical error in real-time
-				Vector3 qsize = test_aabb.size * 0.5; //quarter size, for fast aabb test
+	leaf.albedo = albedo_accum;
+	leaf.emission = emission_accum;
+	leaf.normal = normal_accum;
+	leaf.alpha = alpha;
+}
 
-				if (!fast_tri_box_overlap(test_aabb.position + qsize, qsize, p_vtx)) {
-					//if (!Face3(p_vtx[0],p_vtx[1],p_vtx[2]).intersects_aabb2(aabb)) {
-					//does not fit in child, go on
-					continue;
-				}
-			}
+void VoxelLightBaker::_plot_faces(const LocalVector<PlotFace> &p_faces, const MaterialCache &p_material) {
 
-			if (bake_cells[p_idx].children[i] == CHILD_EMPTY) {
-				//sub cell must be created
+	//creating cells can't be done in parallel, but it's cheap compared to scanning the colors of each leaf
+	LocalVector<PlotLeaf> leaves;
+	for (int i = 0; i < p_faces.size(); i++) {
+		_plot_face(0, 0, 0, 0, 0, i, p_faces[i].vtx, po2_bounds, leaves);
+	}
 
-				uint32_t child_idx = bake_cells.size();
-				bake_cells[p_idx].children[i] = child_idx;
-				bake_cells.resize(bake_cells.size() + 1);
-				bake_cells[child_idx].level = p_level + 1;
-			}
+	PlotBatch batch;
+	batch.faces = p_faces.ptr();
+	batch.material = &p_material;
+	batch.leaves = leaves.ptr();
+	_bake_work(leaves.size(), &VoxelLightBaker::_plot_leaf, &batch);
 
-			_plot_face(bake_cells[p_idx].children[i], p_level + 1, nx, ny, nz, p_vtx, p_normal, p_uv, p_material, aabb);
-		}
+	//accumulate in plot order, so the sums are the same no matter how the scans were scheduled
+	Cell *cells = bake_cells.ptrw();
+	for (int i = 0; i < leaves.size(); i++) {
+
+		const PlotLeaf &leaf = leaves[i];
+		Cell &cell = cells[leaf.cell];
+
+		//put this temporarily here, corrected in a later step
+		cell.albedo[0] += leaf.albedo.r;
+		cell.albedo[1] += leaf.albedo.g;
+		cell.albedo[2] += leaf.albedo.b;
+		cell.emission[0] += leaf.emission.r;
+		cell.emission[1] += leaf.emission.g;
+		cell.emission[2] += leaf.emission.b;
+		cell.normal[0] += leaf.normal.x;
+		cell.normal[1] += leaf.normal.y;
+		cell.normal[2] += leaf.normal.z;
+		cell.alpha += leaf.alpha;
 	}
 }
 
@@ -600,6 +657,7 @@ void VoxelLightBaker::plot_mesh(const Transform &p_xform, Ref<Mesh> &p_mesh, con
 
 		bool read_uv = false;
 		bool read_normals = false;
+		LocalVector<PlotFace> faces;
 
 		if (uv.size()) {
 
@@ -619,31 +677,33 @@ void VoxelLightBaker::plot_mesh(const Transform &p_xform, Ref<Mesh> &p_mesh, con
 
 			for (int j = 0; j < facecount; j++) {
 
-				Vector3 vtxs[3];
-				Vector2 uvs[3];
-				Vector3 normal[3];
+				PlotFace face;
 
 				for (int k = 0; k < 3; k++) {
-					vtxs[k] = p_xform.xform(vr[ir[j * 3 + k]]);
+					face.vtx[k] = p_xform.xform(vr[ir[j * 3 + k]]);
 				}
 
 				if (read_uv) {
 					for (int k = 0; k < 3; k++) {
-						uvs[k] = uvr[ir[j * 3 + k]];
+						face.uv[k] = uvr[ir[j * 3 + k]];
 					}
 				}
 
 				if (read_normals) {
 					for (int k = 0; k < 3; k++) {
-						normal[k] = nr[ir[j * 3 + k]];
+						face.normal[k] = nr[ir[j * 3 + k]];
 					}
 				}
 
 				//test against original bounds
-				if (!fast_tri_box_overlap(original_bounds.position + original_bounds.size * 0.5, original_bounds.size * 0.5, vtxs))
+				if (!fast_tri_box_overlap(original_bounds.position + original_bounds.size * 0.5, original_bounds.size * 0.5, face.vtx))
 					continue;
 				//plot
-				_plot_face(0, 0, 0, 0, 0, vtxs, normal, uvs, material, po2_bounds);
+				faces.push_back(face);
+				if (faces.size() == PLOT_FACE_BATCH_SIZE) {
+					_plot_faces(faces, material);
+					faces.clear();
+				}
 			}
 
 		} else {
@@ -652,33 +712,39 @@ void VoxelLightBaker::plot_mesh(const Transform &p_xform, Ref<Mesh> &p_mesh, con
 
 			for (int j = 0; j < facecount; j++) {
 
-				Vector3 vtxs[3];
-				Vector2 uvs[3];
-				Vector3 normal[3];
+				PlotFace face;
 
 				for (int k = 0; k < 3; k++) {
-					vtxs[k] = p_xform.xform(vr[j * 3 + k]);
+					face.vtx[k] = p_xform.xform(vr[j * 3 + k]);
 				}
 
 				if (read_uv) {
 					for (int k = 0; k < 3; k++) {
-						uvs[k] = uvr[j * 3 + k];
+						face.uv[k] = uvr[j * 3 + k];
 					}
 				}
 
 				if (read_normals) {
 					for (int k = 0; k < 3; k++) {
-						normal[k] = nr[j * 3 + k];
+						face.normal[k] = nr[j * 3 + k];
 					}
 				}
 
 				//test against original bounds
-				if (!fast_tri_box_overlap(original_bounds.position + original_bounds.size * 0.5, original_bounds.size * 0.5, vtxs))
+				if (!fast_tri_box_overlap(original_bounds.position + original_bounds.size * 0.5, original_bounds.size * 0.5, face.vtx))
 					continue;
 				//plot face
-				_plot_face(0, 0, 0, 0, 0, vtxs, normal, uvs, material, po2_bounds);
+				faces.push_back(face);
+				if (faces.size() == PLOT_FACE_BATCH_SIZE) {
+					_plot_faces(faces, material);
+					faces.clear();
+				}
 			}
 		}
+
+		if (faces.size()) {
+			_plot_faces(faces, material);
+		}
 	}
 
 	max_original_cells = bake_cells.size();
@@ -692,8 +758,7 @@ void VoxelLightBaker::_init_light_plot(int p_idx, int p_level, int p_x, int p_y,
 
 	if (p_level == cell_subdiv - 1) {
 
-		bake_light[p_idx].next_leaf = first_leaf;
-		first_leaf = p_idx;
+		leaf_cells.push_back(p_idx);
 	} else {
 
 		//go down
@@ -733,11 +798,10 @@ void VoxelLightBaker::_check_init_light() {
 	if (bake_light.size() == 0) {
 
 		direct_lights_baked = false;
-		leaf_voxel_count = 0;
-		_fixup_plot(0, 0); //pre fixup, so normal, albedo, emission, etc. work for lighting.
+		_fixup_tree(); //pre fixup, so normal, albedo, emission, etc. work for lighting.
 		bake_light.resize(bake_cells.size());
 		zeromem(bake_light.ptrw(), bake_light.size() * sizeof(Light));
-		first_leaf = -1;
+		leaf_cells.clear();
 		_init_light_plot(0, 0, 0, 0, 0, CHILD_EMPTY);
 	}
 }
@@ -818,383 +882,375 @@ uint32_t VoxelLightBaker::_find_cell_at_pos(const Cell *cells, int x, int y, int
 
 	return cell;
 }
-void VoxelLightBaker::plot_light_directional(const Vector3 &p_direction, const Color &p_color, float p_energy, float p_indirect_energy, bool p_direct) {
+void VoxelLightBaker::_plot_light_directional_leaf(uint32_t p_index, const LightPlot *p_light) {
 
-	_check_init_light();
+	int idx = leaf_cells[p_index];
+	Light *light = &p_light->light_data[idx];
+	const Cell *cells = p_light->cells;
+	const Vector3 &light_axis = p_light->axis;
+	const Vector3 &light_energy = p_light->energy;
+	float distance_adv = p_light->distance_adv;
 
-	float max_len = Vector3(axis_cell_size[0], axis_cell_size[1], axis_cell_size[2]).length() * 1.1;
+	Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
+	to += -light_axis.sign() * 0.47; //make it more likely to receive a ray
 
-	if (p_direct)
-		direct_lights_baked = true;
-
-	Vector3 light_axis = p_direction;
-	Plane clip[3];
-	int clip_planes = 0;
-
-	Light *light_data = bake_light.ptrw();
-	const Cell *cells = bake_cells.ptr();
-
-	for (int i = 0; i < 3; i++) {
-
-		if (ABS(light_axis[i]) < CMP_EPSILON)
-			continue;
-		clip[clip_planes].normal[i] = 1.0;
-
-		if (light_axis[i] < 0) {
+	Vector3 from = to - p_light->max_len * light_axis;
 
-			clip[clip_planes].d = axis_cell_size[i] + 1;
-		} else {
-			clip[clip_planes].d -= 1.0;
-		}
+	for (int j = 0; j < p_light->clip_planes; j++) {
 
-		clip_planes++;
+		p_light->clip[j].intersects_segment(from, to, &from);
 	}
 
-	float distance_adv = _get_normal_advance(light_axis);
-
-	int success_count = 0;
+	float distance = (to - from).length();
+	distance += distance_adv - Math::fmod(distance, distance_adv); //make it reach the center of the box always
+	from = to - light_axis * distance;
 
-	Vector3 light_energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+	uint32_t result = 0xFFFFFFFF;
 
-	int idx = first_leaf;
-	while (idx >= 0) {
+	while (distance > -distance_adv) { //use this to avoid precision errors
 
-		//print_line("plot idx " + itos(idx));
-		Light *light = &light_data[idx];
-
-		Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
-		to += -light_axis.sign() * 0.47; //make it more likely to receive a ray
-
-		Vector3 from = to - max_len * light_axis;
-
-		for (int j = 0; j < clip_planes; j++) {
-
-			clip[j].intersects_segment(from, to, &from);
+		result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
+		if (result != 0xFFFFFFFF) {
+			break;
 		}
 
-		float distance = (to - from).length();
-		distance += distance_adv - Math::fmod(distance, distance_adv); //make it reach the center of the box always
-		from = to - light_axis * distance;
-
-		uint32_t result = 0xFFFFFFFF;
+		from += light_axis * distance_adv;
+		distance -= distance_adv;
+	}
 
-		while (distance > -distance_adv) { //use this to avoid precision errors
+	if (result == idx) {
+		//cell hit itself! hooray!
 
-			result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
-			if (result != 0xFFFFFFFF) {
-				break;
+		Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
+		if (normal == Vector3()) {
+			for (int i = 0; i < 6; i++) {
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0];
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1];
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2];
 			}
 
-			from += light_axis * distance_adv;
-			distance -= distance_adv;
-		}
-
-		if (result == idx) {
-			//cell hit itself! hooray!
-
-			Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
-			if (normal == Vector3()) {
-				for (int i = 0; i < 6; i++) {
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0];
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1];
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2];
-				}
-
-			} else {
+		} else {
 
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-normal));
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s;
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s;
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s;
-				}
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-normal));
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s;
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s;
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s;
 			}
+		}
 
-			if (p_direct) {
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
-					light->direct_accum[i][0] += light_energy.x * s;
-					light->direct_accum[i][1] += light_energy.y * s;
-					light->direct_accum[i][2] += light_energy.z * s;
-				}
+		if (p_light->direct) {
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
+				light->direct_accum[i][0] += light_energy.x * s;
+				light->direct_accum[i][1] += light_energy.y * s;
+				light->direct_accum[i][2] += light_energy.z * s;
 			}
-			success_count++;
 		}
-
-		idx = light_data[idx].next_leaf;
 	}
 }
 
-void VoxelLightBaker::plot_light_omni(const Vector3 &p_pos, const Color &p_color, float p_energy, float p_indirect_energy, float p_radius, float p_attenutation, bool p_direct) {
+void VoxelLightBaker::plot_light_directional(const Vector3 &p_direction, const Color &p_color, float p_energy, float p_indirect_energy, bool p_direct) {
 
 	_check_init_light();
 
 	if (p_direct)
 		direct_lights_baked = true;
 
-	Plane clip[3];
-	int clip_planes = 0;
+	LightPlot plot;
+	plot.light_data = bake_light.ptrw();
+	plot.cells = bake_cells.ptr();
+	plot.axis = p_direction;
+	plot.energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+	plot.max_len = Vector3(axis_cell_size[0], axis_cell_size[1], axis_cell_size[2]).length() * 1.1;
+	plot.distance_adv = _get_normal_advance(plot.axis);
+	plot.clip_planes = 0;
+	plot.direct = p_direct;
 
-	// uint64_t us = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < 3; i++) {
 
-	Vector3 light_pos = to_cell_space.xform(p_pos) + Vector3(0.5, 0.5, 0.5);
-	//Vector3 spot_axis = -light_cache.transform.basis.get_axis(2).normalized();
+		if (ABS(plot.axis[i]) < CMP_EPSILON)
+			continue;
+		plot.clip[plot.clip_planes].normal[i] = 1.0;
 
-	float local_radius = to_cell_space.basis.xform(Vector3(0, 0, 1)).length() * p_radius;
+		if (plot.axis[i] < 0) {
 
-	Light *light_data = bake_light.ptrw();
-	const Cell *cells = bake_cells.ptr();
-	Vector3 light_energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+			plot.clip[plot.clip_planes].d = axis_cell_size[i] + 1;
+		} else {
+			plot.clip[plot.clip_planes].d -= 1.0;
+		}
 
-	int idx = first_leaf;
-	while (idx >= 0) {
+		plot.clip_planes++;
+	}
 
-		//print_line("plot idx " + itos(idx));
-		Light *light = &light_data[idx];
+	//every leaf only writes its own light, so they can be plotted in any order
+	_bake_work(leaf_cells.size(), &VoxelLightBaker::_plot_light_directional_leaf, (const LightPlot *)&plot);
+}
 
-		Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
-		to += (light_pos - to).sign() * 0.47; //make it more likely to receive a ray
+void VoxelLightBaker::_plot_light_omni_leaf(uint32_t p_index, const LightPlot *p_light) {
 
-		Vector3 light_axis = (to - light_pos).normalized();
-		float distance_adv = _get_normal_advance(light_axis);
+	int idx = leaf_cells[p_index];
+	Light *light = &p_light->light_data[idx];
+	const Cell *cells = p_light->cells;
+	const Vector3 &light_pos = p_light->pos;
+	const Vector3 &light_energy = p_light->energy;
 
-		Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
+	Plane clip[3];
+	int clip_planes = 0;
 
-		if (normal != Vector3() && normal.dot(-light_axis) < 0.001) {
-			idx = light_data[idx].next_leaf;
-			continue;
-		}
+	Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
+	to += (light_pos - to).sign() * 0.47; //make it more likely to receive a ray
 
-		float att = 1.0;
-		{
-			float d = light_pos.distance_to(to);
-			if (d + distance_adv > local_radius) {
-				idx = light_data[idx].next_leaf;
-				continue; // too far away
-			}
+	Vector3 light_axis = (to - light_pos).normalized();
+	float distance_adv = _get_normal_advance(light_axis);
 
-			float dt = CLAMP((d + distance_adv) / local_radius, 0, 1);
-			att *= powf(1.0 - dt, p_attenutation);
-		}
+	Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
+
+	if (normal != Vector3() && normal.dot(-light_axis) < 0.001) {
+		return;
+	}
 
-		clip_planes = 0;
+	float att = 1.0;
+	{
+		float d = light_pos.distance_to(to);
+		if (d + distance_adv > p_light->radius) {
+			return; // too far away
+		}
 
-		for (int c = 0; c < 3; c++) {
+		float dt = CLAMP((d + distance_adv) / p_light->radius, 0, 1);
+		att *= powf(1.0 - dt, p_light->attenuation);
+	}
 
-			if (ABS(light_axis[c]) < CMP_EPSILON)
-				continue;
-			clip[clip_planes].normal[c] = 1.0;
+	for (int c = 0; c < 3; c++) {
 
-			if (light_axis[c] < 0) {
+		if (ABS(light_axis[c]) < CMP_EPSILON)
+			continue;
+		clip[clip_planes].normal[c] = 1.0;
 
-				clip[clip_planes].d = (1 << (cell_subdiv - 1)) + 1;
-			} else {
-				clip[clip_planes].d -= 1.0;
-			}
+		if (light_axis[c] < 0) {
 
-			clip_planes++;
+			clip[clip_planes].d = (1 << (cell_subdiv - 1)) + 1;
+		} else {
+			clip[clip_planes].d -= 1.0;
 		}
 
-		Vector3 from = light_pos;
+		clip_planes++;
+	}
 
-		for (int j = 0; j < clip_planes; j++) {
+	Vector3 from = light_pos;
 
-			clip[j].intersects_segment(from, to, &from);
-		}
+	for (int j = 0; j < clip_planes; j++) {
 
-		float distance = (to - from).length();
+		clip[j].intersects_segment(from, to, &from);
+	}
 
-		distance -= Math::fmod(distance, distance_adv); //make it reach the center of the box always, but this tame make it closer
-		from = to - light_axis * distance;
-		to += (light_pos - to).sign() * 0.47; //make it more likely to receive a ray
+	float distance = (to - from).length();
 
-		uint32_t result = 0xFFFFFFFF;
+	distance -= Math::fmod(distance, distance_adv); //make it reach the center of the box always, but this tame make it closer
+	from = to - light_axis * distance;
+	to += (light_pos - to).sign() * 0.47; //make it more likely to receive a ray
 
-		while (distance > -distance_adv) { //use this to avoid precision errors
+	uint32_t result = 0xFFFFFFFF;
 
-			result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
-			if (result != 0xFFFFFFFF) {
-				break;
-			}
+	while (distance > -distance_adv) { //use this to avoid precision errors
 
-			from += light_axis * distance_adv;
-			distance -= distance_adv;
+		result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
+		if (result != 0xFFFFFFFF) {
+			break;
 		}
 
-		if (result == idx) {
-			//cell hit itself! hooray!
-
-			if (normal == Vector3()) {
-				for (int i = 0; i < 6; i++) {
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * att;
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * att;
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * att;
-				}
+		from += light_axis * distance_adv;
+		distance -= distance_adv;
+	}
 
-			} else {
+	if (result == idx) {
+		//cell hit itself! hooray!
 
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-normal));
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s * att;
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s * att;
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s * att;
-				}
+		if (normal == Vector3()) {
+			for (int i = 0; i < 6; i++) {
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * att;
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * att;
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * att;
 			}
 
-			if (p_direct) {
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
-					light->direct_accum[i][0] += light_energy.x * s * att;
-					light->direct_accum[i][1] += light_energy.y * s * att;
-					light->direct_accum[i][2] += light_energy.z * s * att;
-				}
+		} else {
+
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-normal));
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s * att;
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s * att;
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s * att;
 			}
 		}
 
-		idx = light_data[idx].next_leaf;
+		if (p_light->direct) {
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
+				light->direct_accum[i][0] += light_energy.x * s * att;
+				light->direct_accum[i][1] += light_energy.y * s * att;
+				light->direct_accum[i][2] += light_energy.z * s * att;
+			}
+		}
 	}
 }
 
-void VoxelLightBaker::plot_light_spot(const Vector3 &p_pos, const Vector3 &p_axis, const Color &p_color, float p_energy, float p_indirect_energy, float p_radius, float p_attenutation, float p_spot_angle, float p_spot_attenuation, bool p_direct) {
+void VoxelLightBaker::plot_light_omni(const Vector3 &p_pos, const Color &p_color, float p_energy, float p_indirect_energy, float p_radius, float p_attenutation, bool p_direct) {
 
 	_check_init_light();
 
 	if (p_direct)
 		direct_lights_baked = true;
 
-	Plane clip[3];
-	int clip_planes = 0;
+	LightPlot plot;
+	plot.light_data = bake_light.ptrw();
+	plot.cells = bake_cells.ptr();
+	plot.pos = to_cell_space.xform(p_pos) + Vector3(0.5, 0.5, 0.5);
+	plot.energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+	plot.radius = to_cell_space.basis.xform(Vector3(0, 0, 1)).length() * p_radius;
+	plot.attenuation = p_attenutation;
+	plot.direct = p_direct;
 
-	// uint64_t us = OS::get_singleton()->get_ticks_usec();
+	_bake_work(leaf_cells.size(), &VoxelLightBaker::_plot_light_omni_leaf, (const LightPlot *)&plot);
+}
 
-	Vector3 light_pos = to_cell_space.xform(p_pos) + Vector3(0.5, 0.5, 0.5);
-	Vector3 spot_axis = to_cell_space.basis.xform(p_axis).normalized();
+void VoxelLightBaker::_plot_light_spot_leaf(uint32_t p_index, const LightPlot *p_light) {
 
-	float local_radius = to_cell_space.basis.xform(Vector3(0, 0, 1)).length() * p_radius;
+	int idx = leaf_cells[p_index];
+	Light *light = &p_light->light_data[idx];
+	const Cell *cells = p_light->cells;
+	const Vector3 &light_pos = p_light->pos;
+	const Vector3 &light_energy = p_light->energy;
 
-	Light *light_data = bake_light.ptrw();
-	const Cell *cells = bake_cells.ptr();
-	Vector3 light_energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+	Plane clip[3];
+	int clip_planes = 0;
 
-	int idx = first_leaf;
-	while (idx >= 0) {
+	Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
 
-		//print_line("plot idx " + itos(idx));
-		Light *light = &light_data[idx];
+	Vector3 light_axis = (to - light_pos).normalized();
+	float distance_adv = _get_normal_advance(light_axis);
 
-		Vector3 to(light->x + 0.5, light->y + 0.5, light->z + 0.5);
+	Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
 
-		Vector3 light_axis = (to - light_pos).normalized();
-		float distance_adv = _get_normal_advance(light_axis);
+	if (normal != Vector3() && normal.dot(-light_axis) < 0.001) {
+		return;
+	}
 
-		Vector3 normal(cells[idx].normal[0], cells[idx].normal[1], cells[idx].normal[2]);
+	float angle = Math::rad2deg(Math::acos(light_axis.dot(-p_light->axis)));
+	if (angle > p_light->spot_angle) {
+		return; // too far away
+	}
 
-		if (normal != Vector3() && normal.dot(-light_axis) < 0.001) {
-			idx = light_data[idx].next_leaf;
-			continue;
-		}
+	float att = Math::pow(1.0f - angle / p_light->spot_angle, p_light->spot_attenuation);
 
-		float angle = Math::rad2deg(Math::acos(light_axis.dot(-spot_axis)));
-		if (angle > p_spot_angle) {
-			idx = light_data[idx].next_leaf;
-			continue; // too far away
+	{
+		float d = light_pos.distance_to(to);
+		if (d + distance_adv > p_light->radius) {
+			return; // too far away
 		}
 
-		float att = Math::pow(1.0f - angle / p_spot_angle, p_spot_attenuation);
+		float dt = CLAMP((d + distance_adv) / p_light->radius, 0, 1);
+		att *= powf(1.0 - dt, p_light->attenuation);
+	}
 
-		{
-			float d = light_pos.distance_to(to);
-			if (d + distance_adv > local_radius) {
-				idx = light_data[idx].next_leaf;
-				continue; // too far away
-			}
+	for (int c = 0; c < 3; c++) {
 
-			float dt = CLAMP((d + distance_adv) / local_radius, 0, 1);
-			att *= powf(1.0 - dt, p_attenutation);
+		if (ABS(light_axis[c]) < CMP_EPSILON)
+			continue;
+		clip[clip_planes].normal[c] = 1.0;
+
+		if (light_axis[c] < 0) {
+
+			clip[clip_planes].d = (1 << (cell_subdiv - 1)) + 1;
+		} else {
+			clip[clip_planes].d -= 1.0;
 		}
 
-		clip_planes = 0;
+		clip_planes++;
+	}
 
-		for (int c = 0; c < 3; c++) {
+	Vector3 from = light_pos;
 
-			if (ABS(light_axis[c]) < CMP_EPSILON)
-				continue;
-			clip[clip_planes].normal[c] = 1.0;
+	for (int j = 0; j < clip_planes; j++) {
 
-			if (light_axis[c] < 0) {
+		clip[j].intersects_segment(from, to, &from);
+	}
 
-				clip[clip_planes].d = (1 << (cell_subdiv - 1)) + 1;
-			} else {
-				clip[clip_planes].d -= 1.0;
-			}
+	float distance = (to - from).length();
 
-			clip_planes++;
-		}
+	distance -= Math::fmod(distance, distance_adv); //make it reach the center of the box always, but this tame make it closer
+	from = to - light_axis * distance;
 
-		Vector3 from = light_pos;
+	uint32_t result = 0xFFFFFFFF;
 
-		for (int j = 0; j < clip_planes; j++) {
+	while (distance > -distance_adv) { //use this to avoid precision errors
 
-			clip[j].intersects_segment(from, to, &from);
+		result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
+		if (result != 0xFFFFFFFF) {
+			break;
 		}
 
-		float distance = (to - from).length();
+		from += light_axis * distance_adv;
+		distance -= distance_adv;
+	}
 
-		distance -= Math::fmod(distance, distance_adv); //make it reach the center of the box always, but this tame make it closer
-		from = to - light_axis * distance;
+	if (result == idx) {
+		//cell hit itself! hooray!
 
-		uint32_t result = 0xFFFFFFFF;
+		if (normal == Vector3()) {
+			for (int i = 0; i < 6; i++) {
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * att;
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * att;
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * att;
+			}
 
-		while (distance > -distance_adv) { //use this to avoid precision errors
+		} else {
 
-			result = _find_cell_at_pos(cells, int(floor(from.x)), int(floor(from.y)), int(floor(from.z)));
-			if (result != 0xFFFFFFFF) {
-				break;
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-normal));
+				light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s * att;
+				light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s * att;
+				light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s * att;
 			}
-
-			from += light_axis * distance_adv;
-			distance -= distance_adv;
 		}
 
-		if (result == idx) {
-			//cell hit itself! hooray!
-
-			if (normal == Vector3()) {
-				for (int i = 0; i < 6; i++) {
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * att;
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * att;
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * att;
-				}
+		if (p_light->direct) {
+			for (int i = 0; i < 6; i++) {
+				float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
+				light->direct_accum[i][0] += light_energy.x * s * att;
+				light->direct_accum[i][1] += light_energy.y * s * att;
+				light->direct_accum[i][2] += light_energy.z * s * att;
+			}
+		}
+	}
+}
 
-			} else {
+void VoxelLightBaker::plot_light_spot(const Vector3 &p_pos, const Vector3 &p_axis, const Color &p_color, float p_energy, float p_indirect_energy, float p_radius, float p_attenutation, float p_spot_angle, float p_spot_attenuation, bool p_direct) {
 
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-normal));
-					light->accum[i][0] += light_energy.x * cells[idx].albedo[0] * s * att;
-					light->accum[i][1] += light_energy.y * cells[idx].albedo[1] * s * att;
-					light->accum[i][2] += light_energy.z * cells[idx].albedo[2] * s * att;
-				}
-			}
+	_check_init_light();
 
-			if (p_direct) {
-				for (int i = 0; i < 6; i++) {
-					float s = MAX(0.0, aniso_normal[i].dot(-light_axis)); //light depending on normal for direct
-					light->direct_accum[i][0] += light_energy.x * s * att;
-					light->direct_accum[i][1] += light_energy.y * s * att;
-					light->direct_accum[i][2] += light_energy.z * s * att;
-				}
-			}
-		}
+	if (p_direct)
+		direct_lights_baked = true;
 
-		idx = light_data[idx].next_leaf;
-	}
+	LightPlot plot;
+	plot.light_data = bake_light.ptrw();
+	plot.cells = bake_cells.ptr();
+	plot.pos = to_cell_space.xform(p_pos) + Vector3(0.5, 0.5, 0.5);
+	plot.axis = to_cell_space.basis.xform(p_axis).normalized();
+	plot.energy = Vector3(p_color.r, p_color.g, p_color.b) * p_energy * p_indirect_energy;
+	plot.radius = to_cell_space.basis.xform(Vector3(0, 0, 1)).length() * p_radius;
+	plot.attenuation = p_attenutation;
+	plot.spot_angle = p_spot_angle;
+	plot.spot_attenuation = p_spot_attenuation;
+	plot.direct = p_direct;
+
+	_bake_work(leaf_cells.size(), &VoxelLightBaker::_plot_light_spot_leaf, (const LightPlot *)&plot);
 }
 
-void VoxelLightBaker::_fixup_plot(int p_idx, int p_level) {
+void VoxelLightBaker::_fixup_plot(int p_idx, int p_level, int p_task_level, int &r_leaf_count) {
 
 	if (p_level == cell_subdiv - 1) {
 
-		leaf_voxel_count++;
+		r_leaf_count++;
 		float alpha = bake_cells[p_idx].alpha;
 
 		bake_cells[p_idx].albedo[0] /= alpha;
@@ -1262,7 +1318,9 @@ void VoxelLightBaker::_fixup_plot(int p_idx, int p_level) {
 			if (child == CHILD_EMPTY)
 				continue;
 
-			_fixup_plot(child, p_level + 1);
+			if (p_level + 1 != p_task_level) {
+				_fixup_plot(child, p_level + 1, p_task_level, r_leaf_count);
+			}
 			alpha_average += bake_cells[child].alpha;
 
 			if (bake_light.size() > 0) {
@@ -1294,6 +1352,52 @@ void VoxelLightBaker::_fixup_plot(int p_idx, int p_level) {
 	}
 }
 
+void VoxelLightBaker::_collect_fixup_tasks(int p_idx, int p_level, int p_task_level, LocalVector<FixupTask> &r_tasks) {
+
+	if (p_level == p_task_level) {
+
+		FixupTask task;
+		task.cell = p_idx;
+		task.level = p_level;
+		task.leaf_count = 0;
+		r_tasks.push_back(task);
+		return;
+	}
+
+	for (int i = 0; i < 8; i++) {
+
+		uint32_t child = bake_cells[p_idx].children[i];
+		if (child != CHILD_EMPTY) {
+			_collect_fixup_tasks(child, p_level + 1, p_task_level, r_tasks);
+		}
+	}
+}
+
+void VoxelLightBaker::_fixup_task(uint32_t p_index, FixupTask *p_tasks) {
+
+	_fixup_plot(p_tasks[p_index].cell, p_tasks[p_index].level, -1, p_tasks[p_index].leaf_count);
+}
+
+void VoxelLightBaker::_fixup_tree() {
+
+	//subtrees don't share cells, so they are fixed up in parallel, then the levels above them are averaged
+	int task_level = MIN(int(FIXUP_TASK_LEVEL), cell_subdiv - 1);
+
+	LocalVector<FixupTask> tasks;
+	_collect_fixup_tasks(0, 0, task_level, tasks);
+	_bake_work(tasks.size(), &VoxelLightBaker::_fixup_task, tasks.ptr());
+
+	leaf_voxel_count = 0;
+	for (int i = 0; i < tasks.size(); i++) {
+		leaf_voxel_count += tasks[i].leaf_count;
+	}
+
+	if (task_level > 0) {
+		int leaf_count = 0; //all leaves are below the task level
+		_fixup_plot(0, 0, task_level, leaf_count);
+	}
+}
+
 //make sure any cell (save for the root) has an empty cell previous to it, so it can be interpolated into
 
 void VoxelLightBaker::_plot_triangle(Vector2 *vertices, Vector3 *positions, Vector3 *normals, LightMap *pixels, int width, int height) {
@@ -1709,7 +1813,11 @@ Vector3 VoxelLightBaker::_compute_ray_trace_at_pos(const Vector3 &p_pos, const V
 	const Light *light = bake_light.ptr();
 	const Cell *cells = bake_cells.ptr();
 
-	uint32_t local_rng_state = rand(); //needs to be fixed again
+	//seeded from the position, so a texel gets the same samples no matter which thread bakes it
+	uint32_t local_rng_state = hash_djb2_one_float(p_pos.x, hash_djb2_one_float(p_pos.y, hash_djb2_one_float(p_pos.z)));
+	if (local_rng_state == 0) {
+		local_rng_state = 1; //xorshift never leaves zero
+	}
 
 	for (int i = 0; i < samples; i++) {
 
@@ -1815,6 +1923,65 @@ void VoxelLightBaker::_lightmap_bake_point(uint32_t p_x, LightMap *p_line) {
 	}
 }
 
+void VoxelLightBaker::_lightmap_direct_point(uint32_t p_x, LightMap *p_line) {
+
+	const Cell *cells = bake_cells.ptr();
+	const Light *light = bake_light.ptr();
+
+	LightMap *pixel = &p_line[p_x];
+	if (pixel->pos == Vector3())
+		return; //unused, skipe
+
+	int x = int(pixel->pos.x) - 1;
+	int y = int(pixel->pos.y) - 1;
+	int z = int(pixel->pos.z) - 1;
+	Color accum;
+	int size = 1 << (cell_subdiv - 1);
+
+	int found = 0;
+
+	for (int k = 0; k < 8; k++) {
+
+		int ofs_x = x;
+		int ofs_y = y;
+		int ofs_z = z;
+
+		if (k & 1)
+			ofs_x++;
+		if (k & 2)
+			ofs_y++;
+		if (k & 4)
+			ofs_z++;
+
+		if (x < 0 || x >= size)
+			continue;
+		if (y < 0 || y >= size)
+			continue;
+		if (z < 0 || z >= size)
+			continue;
+
+		uint32_t cell = _find_cell_at_pos(cells, ofs_x, ofs_y, ofs_z);
+
+		if (cell == CHILD_EMPTY)
+			continue;
+		for (int l = 0; l < 6; l++) {
+			float s = pixel->normal.dot(aniso_normal[l]);
+			if (s < 0)
+				s = 0;
+			accum.r += light[cell].direct_accum[l][0] * s;
+			accum.g += light[cell].direct_accum[l][1] * s;
+			accum.b += light[cell].direct_accum[l][2] * s;
+		}
+		found++;
+	}
+	if (found) {
+		accum /= found;
+		pixel->light.x += accum.r;
+		pixel->light.y += accum.g;
+		pixel->light.z += accum.b;
+	}
+}
+
 Error VoxelLightBaker::make_lightmap(const Transform &p_xform, Ref<Mesh> &p_mesh, LightMapData &r_lightmap, bool (*p_bake_time_func)(void *, float, float), void *p_bake_time_ud) {
 
 	//transfer light information to a lightmap
@@ -1874,20 +2041,21 @@ Error VoxelLightBaker::make_lightmap(const Transform &p_xform, Ref<Mesh> &p_mesh
 	{
 		LightMap *lightmap_ptr = lightmap.ptrw();
 		uint64_t begin_time = OS::get_singleton()->get_ticks_usec();
-		volatile int lines = 0;
 
-		// make sure our OS-level rng is seeded
+		//bake a few lines per job, so progress can still be reported (and the bake aborted) between jobs
+		int job_lines = MAX(1, LIGHTMAP_JOB_TEXELS / MAX(1, width));
 
-		for (int i = 0; i < height; i++) {
+		for (int i = 0; i < height; i += job_lines) {
 
-			thread_process_array(width, this, &VoxelLightBaker::_lightmap_bake_point, &lightmap_ptr[i * width]);
+			int lines = MIN(job_lines, height - i);
+			_bake_work(lines * width, &VoxelLightBaker::_lightmap_bake_point, &lightmap_ptr[i * width]);
 
-			lines = MAX(lines, i); //for multithread
 			if (p_bake_time_func) {
+				int done = i + lines;
 				uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin_time;
 				float elapsed_sec = double(elapsed) / 1000000.0;
-				float remaining = lines < 1 ? 0 : (elapsed_sec / lines) * (height - lines - 1);
-				if (p_bake_time_func(p_bake_time_ud, remaining, lines / float(height))) {
+				float remaining = (elapsed_sec / done) * (height - done);
+				if (p_bake_time_func(p_bake_time_ud, remaining, done / float(height))) {
 					return ERR_SKIP;
 				}
 			}
@@ -1952,78 +2120,7 @@ Error VoxelLightBaker::make_lightmap(const Transform &p_xform, Ref<Mesh> &p_mesh
 		}
 
 		//add directional light (do this after blur)
-		{
-			LightMap *lightmap_ptr = lightmap.ptrw();
-			const Cell *cells = bake_cells.ptr();
-			const Light *light = bake_light.ptr();
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-			for (int i = 0; i < height; i++) {
-
-			//print_line("bake line " + itos(i) + " / " + itos(height));
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
-				for (int j = 0; j < width; j++) {
-
-					//if (i == 125 && j == 280) {
-
-					LightMap *pixel = &lightmap_ptr[i * width + j];
-					if (pixel->pos == Vector3())
-						continue; //unused, skipe
-
-					int x = int(pixel->pos.x) - 1;
-					int y = int(pixel->pos.y) - 1;
-					int z = int(pixel->pos.z) - 1;
-					Color accum;
-					int size = 1 << (cell_subdiv - 1);
-
-					int found = 0;
-
-					for (int k = 0; k < 8; k++) {
-
-						int ofs_x = x;
-						int ofs_y = y;
-						int ofs_z = z;
-
-						if (k & 1)
-							ofs_x++;
-						if (k & 2)
-							ofs_y++;
-						if (k & 4)
-							ofs_z++;
-
-						if (x < 0 || x >= size)
-							continue;
-						if (y < 0 || y >= size)
-							continue;
-						if (z < 0 || z >= size)
-							continue;
-
-						uint32_t cell = _find_cell_at_pos(cells, ofs_x, ofs_y, ofs_z);
-
-						if (cell == CHILD_EMPTY)
-							continue;
-						for (int l = 0; l < 6; l++) {
-							float s = pixel->normal.dot(aniso_normal[l]);
-							if (s < 0)
-								s = 0;
-							accum.r += light[cell].direct_accum[l][0] * s;
-							accum.g += light[cell].direct_accum[l][1] * s;
-							accum.b += light[cell].direct_accum[l][2] * s;
-						}
-						found++;
-					}
-					if (found) {
-						accum /= found;
-						pixel->light.x += accum.r;
-						pixel->light.y += accum.g;
-						pixel->light.z += accum.b;
-					}
-				}
-			}
-		}
+		_bake_work(width * height, &VoxelLightBaker::_lightmap_direct_point, lightmap_ptr);
 
 		{
 			//fill gaps with neighbour vertices to avoid filter fades to black on edges
@@ -2162,7 +2259,7 @@ void VoxelLightBaker::begin_bake(int p_subdiv, const AABB &p_bounds) {
 }
 
 void VoxelLightBaker::end_bake() {
-	_fixup_plot(0, 0);
+	_fixup_tree();
 }
 
 //create the data for visual server
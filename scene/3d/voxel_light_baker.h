@@ -31,6 +31,7 @@
 #ifndef VOXEL_LIGHT_BAKER_H
 #define VOXEL_LIGHT_BAKER_H
 
+#include "local_vector.h"
 #include "scene/3d/mesh_instance.h"
 #include "scene/resources/multimesh.h"
 
@@ -91,12 +92,10 @@ private:
 		int x, y, z;
 		float accum[6][3]; //rgb anisotropic
 		float direct_accum[6][3]; //for direct bake
-		int next_leaf;
 	};
 
-	int first_leaf;
-
 	Vector<Light> bake_light;
+	LocalVector<int> leaf_cells; // lights are plotted on every leaf in parallel
 
 	struct MaterialCache {
 		//128x128 textures
@@ -125,18 +124,84 @@ private:
 
 	int max_original_cells;
 
+	template <class M, class U>
+	void _bake_work(uint32_t p_count, M p_method, U p_userdata);
+
 	void _init_light_plot(int p_idx, int p_level, int p_x, int p_y, int p_z, uint32_t p_parent);
 
 	Vector<Color> _get_bake_texture(Ref<Image> p_image, const Color &p_color_mul, const Color &p_color_add);
 	MaterialCache _get_material_cache(Ref<Material> p_material);
 
-	void _plot_face(int p_idx, int p_level, int p_x, int p_y, int p_z, const Vector3 *p_vtx, const Vector3 *p_normal, const Vector2 *p_uv, const MaterialCache &p_material, const AABB &p_aabb);
-	void _fixup_plot(int p_idx, int p_level);
+	enum {
+		PLOT_FACE_BATCH_SIZE = 4096, // faces descended before their leaves are scanned in parallel
+		FIXUP_TASK_LEVEL = 3, // subtrees at this level are fixed up in parallel
+		LIGHTMAP_JOB_TEXELS = 16384, // texels baked between progress reports
+	};
+
+	struct PlotFace {
+		Vector3 vtx[3];
+		Vector3 normal[3];
+		Vector2 uv[3];
+	};
+
+	// a face touching a leaf cell, with the colors the scan found there
+	struct PlotLeaf {
+		uint32_t cell;
+		uint32_t face;
+		AABB aabb;
+		Color albedo;
+		Color emission;
+		Vector3 normal;
+		float alpha;
+	};
+
+	struct PlotBatch {
+		const PlotFace *faces;
+		const MaterialCache *material;
+		PlotLeaf *leaves;
+	};
+
+	void _plot_face(int p_idx, int p_level, int p_x, int p_y, int p_z, uint32_t p_face, const Vector3 *p_vtx, const AABB &p_aabb, LocalVector<PlotLeaf> &r_leaves);
+	void _plot_leaf(uint32_t p_index, PlotBatch *p_batch);
+	void _plot_faces(const LocalVector<PlotFace> &p_faces, const MaterialCache &p_material);
+
+	struct FixupTask {
+		uint32_t cell;
+		int level;
+		int leaf_count;
+	};
+
+	void _collect_fixup_tasks(int p_idx, int p_level, int p_task_level, LocalVector<FixupTask> &r_tasks);
+	void _fixup_task(uint32_t p_index, FixupTask *p_tasks);
+	void _fixup_plot(int p_idx, int p_level, int p_task_level, int &r_leaf_count);
+	void _fixup_tree();
 	void _debug_mesh(int p_idx, int p_level, const AABB &p_aabb, Ref<MultiMesh> &p_multimesh, int &idx, DebugMode p_mode);
 	void _check_init_light();
 
 	uint32_t _find_cell_at_pos(const Cell *cells, int x, int y, int z);
 
+	// light parameters, already in cell space
+	struct LightPlot {
+		Light *light_data;
+		const Cell *cells;
+		Vector3 pos;
+		Vector3 axis;
+		Vector3 energy;
+		float max_len;
+		float distance_adv;
+		Plane clip[3];
+		int clip_planes;
+		float radius;
+		float attenuation;
+		float spot_angle;
+		float spot_attenuation;
+		bool direct;
+	};
+
+	void _plot_light_directional_leaf(uint32_t p_index, const LightPlot *p_light);
+	void _plot_light_omni_leaf(uint32_t p_index, const LightPlot *p_light);
+	void _plot_light_spot_leaf(uint32_t p_index, const LightPlot *p_light);
+
 	struct LightMap {
 		Vector3 light;
 		Vector3 pos;
@@ -151,6 +216,7 @@ private:
 	_FORCE_INLINE_ Vector3 _compute_ray_trace_at_pos(const Vector3 &p_pos, const Vector3 &p_normal);
 
 	void _lightmap_bake_point(uint32_t p_x, LightMap *p_line);
+	void _lightmap_direct_point(uint32_t p_x, LightMap *p_line);
 
 public:
 	void begin_bake(int p_subdiv, const AABB &p_bounds);
@@ -31,10 +31,12 @@
 #include "audio_player.h"
 
 #include "engine.h"
+#include "servers/audio/audio_mix_kernels.h"
 
 void AudioStreamPlayer::_mix_internal(bool p_fadeout) {
 
 	int bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus);
+	voice.bus_index = bus_index;
 
 	//get data
 	AudioFrame *buffer = mix_buffer.ptrw();
@@ -52,10 +54,7 @@ void AudioStreamPlayer::_mix_internal(bool p_fadeout) {
 	float vol = Math::db2linear(mix_volume_db);
 	float vol_inc = (Math::db2linear(target_volume) - vol) / float(buffer_size);
 
-	for (int i = 0; i < buffer_size; i++) {
-		buffer[i] *= vol;
-		vol += vol_inc;
-	}
+	AudioMixKernels::scale_ramp(buffer, buffer_size, vol, vol_inc);
 	//set volume for next mix
 	mix_volume_db = target_volume;
 
@@ -82,9 +81,7 @@ void AudioStreamPlayer::_mix_internal(bool p_fadeout) {
 	for (int c = 0; c < 4; c++) {
 		if (!targets[c])
 			break;
-		for (int i = 0; i < buffer_size; i++) {
-			targets[c][i] += buffer[i];
-		}
+		AudioMixKernels::mix(targets[c], buffer, buffer_size);
 	}
 }
 
@@ -98,6 +95,11 @@ void AudioStreamPlayer::_mix_audio() {
 		return;
 	}
 
+	if (voice.was_virtual) {
+		//audible again, fade in from where the playback was skipped to
+		mix_volume_db = -80.0;
+	}
+
 	if (setseek >= 0.0) {
 		if (stream_playback->is_playing()) {
 
@@ -112,11 +114,36 @@ void AudioStreamPlayer::_mix_audio() {
 	_mix_internal(false);
 }
 
+void AudioStreamPlayer::_skip_audio() {
+
+	if (!stream_playback.is_valid()) {
+		return;
+	}
+
+	if (!active) {
+		return;
+	}
+
+	int frames = mix_buffer.size();
+
+	if (setseek >= 0.0) {
+		stream_playback->start(setseek);
+		setseek = -1.0; //reset seek
+	} else if (!voice.was_virtual && stream_playback->is_playing()) {
+		//was mixed until now, fade out to avoid pops
+		_mix_internal(true);
+		frames -= MIN(frames, 16);
+	}
+
+	voice.bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus);
+	stream_playback->skip(pitch_scale, frames);
+}
+
 void AudioStreamPlayer::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_ENTER_TREE) {
 
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
+		AudioServer::get_singleton()->add_voice(&voice);
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
 		}
@@ -126,6 +153,7 @@ void AudioStreamPlayer::_notification(int p_what) {
 
 		if (!active || (setseek < 0 && !stream_playback->is_playing())) {
 			active = false;
+			voice.playing = false;
 			set_process_internal(false);
 			emit_signal("finished");
 		}
@@ -133,7 +161,7 @@ void AudioStreamPlayer::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
 
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		AudioServer::get_singleton()->remove_voice(&voice);
 	}
 }
 
@@ -148,6 +176,7 @@ void AudioStreamPlayer::set_stream(Ref<AudioStream> p_stream) {
 		stream.unref();
 		active = false;
 		setseek = -1;
+		voice.playing = false;
 	}
 
 	if (p_stream.is_valid()) {
@@ -171,6 +200,7 @@ Ref<AudioStream> AudioStreamPlayer::get_stream() const {
 void AudioStreamPlayer::set_volume_db(float p_volume) {
 
 	volume_db = p_volume;
+	voice.volume = Math::db2linear(volume_db);
 }
 float AudioStreamPlayer::get_volume_db() const {
 
@@ -190,6 +220,7 @@ void AudioStreamPlayer::play(float p_from_pos) {
 		//mix_volume_db = volume_db; do not reset volume ramp here, can cause clicks
 		setseek = p_from_pos;
 		active = true;
+		voice.playing = true;
 		set_process_internal(true);
 	}
 }
@@ -205,6 +236,7 @@ void AudioStreamPlayer::stop() {
 
 	if (stream_playback.is_valid()) {
 		active = false;
+		voice.playing = false;
 		set_process_internal(false);
 	}
 }
@@ -263,6 +295,16 @@ AudioStreamPlayer::MixTarget AudioStreamPlayer::get_mix_target() const {
 	return mix_target;
 }
 
+void AudioStreamPlayer::set_voice_priority(int p_priority) {
+
+	voice.priority = p_priority;
+}
+
+int AudioStreamPlayer::get_voice_priority() const {
+
+	return voice.priority;
+}
+
 void AudioStreamPlayer::_set_playing(bool p_enable) {
 
 	if (p_enable)
@@ -323,6 +365,9 @@ void AudioStreamPlayer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_mix_target", "mix_target"), &AudioStreamPlayer::set_mix_target);
 	ClassDB::bind_method(D_METHOD("get_mix_target"), &AudioStreamPlayer::get_mix_target);
 
+	ClassDB::bind_method(D_METHOD("set_voice_priority", "priority"), &AudioStreamPlayer::set_voice_priority);
+	ClassDB::bind_method(D_METHOD("get_voice_priority"), &AudioStreamPlayer::get_voice_priority);
+
 	ClassDB::bind_method(D_METHOD("_set_playing", "enable"), &AudioStreamPlayer::_set_playing);
 	ClassDB::bind_method(D_METHOD("_is_active"), &AudioStreamPlayer::_is_active);
 
@@ -335,6 +380,7 @@ void AudioStreamPlayer::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "autoplay"), "set_autoplay", "is_autoplay_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "mix_target", PROPERTY_HINT_ENUM, "Stereo,Surround,Center"), "set_mix_target", "get_mix_target");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "bus", PROPERTY_HINT_ENUM, ""), "set_bus", "get_bus");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "voice_priority", PROPERTY_HINT_RANGE, "-128,127,1"), "set_voice_priority", "get_voice_priority");
 
 	ADD_SIGNAL(MethodInfo("finished"));
 
@@ -353,6 +399,10 @@ AudioStreamPlayer::AudioStreamPlayer() {
 	active = false;
 	mix_target = MIX_TARGET_STEREO;
 
+	voice.mix_callback = _mix_audios;
+	voice.skip_callback = _skip_audios;
+	voice.userdata = this;
+
 	AudioServer::get_singleton()->connect("bus_layout_changed", this, "_bus_layout_changed");
 }
 
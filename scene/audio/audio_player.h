@@ -61,9 +61,13 @@ private:
 
 	MixTarget mix_target;
 
+	AudioServer::Voice voice;
+
 	void _mix_internal(bool p_fadeout);
 	void _mix_audio();
 	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer *>(self)->_mix_audio(); }
+	void _skip_audio();
+	static void _skip_audios(void *self) { reinterpret_cast<AudioStreamPlayer *>(self)->_skip_audio(); }
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -100,6 +104,9 @@ public:
 	void set_mix_target(MixTarget p_target);
 	MixTarget get_mix_target() const;
 
+	void set_voice_priority(int p_priority);
+	int get_voice_priority() const;
+
 	AudioStreamPlayer();
 	~AudioStreamPlayer();
 };
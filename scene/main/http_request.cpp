@@ -309,6 +309,7 @@ bool HTTPRequest::_update_connection() {
 				}
 				if (got_response && body_len < 0) {
 					// Chunked transfer is done
+					body.resize(downloaded);
 					call_deferred("_request_done", RESULT_SUCCESS, response_code, response_headers, body);
 					return true;
 				}
@@ -373,19 +374,34 @@ bool HTTPRequest::_update_connection() {
 
 			client->poll();
 
-			PoolByteArray chunk = client->read_response_body_chunk();
-			downloaded += chunk.size();
-
+			// Read straight into the destination storage, so no buffer is allocated per chunk
+			int read = 0;
 			if (file) {
-				PoolByteArray::Read r = chunk.read();
-				file->store_buffer(r.ptr(), chunk.size());
+				if (read_buffer.size() != READ_BUFFER_SIZE)
+					read_buffer.resize(READ_BUFFER_SIZE);
+				client->read_response_body(read_buffer.ptrw(), READ_BUFFER_SIZE, read);
+				file->store_buffer(read_buffer.ptr(), read);
 				if (file->get_error() != OK) {
 					call_deferred("_request_done", RESULT_DOWNLOAD_FILE_WRITE_ERROR, response_code, response_headers, PoolByteArray());
 					return true;
 				}
 			} else {
-				body.append_array(chunk);
+				// Grow with the data received instead of trusting Content-Length with the whole allocation up front
+				int capacity = downloaded + READ_BUFFER_SIZE;
+				if (body.size() < capacity) {
+					int new_size = MAX(capacity, body.size() * 2);
+					if (body_len >= 0) {
+						new_size = MIN(new_size, body_len);
+					}
+					if (body_size_limit >= 0) {
+						new_size = MIN(new_size, body_size_limit + 1); // one byte past the limit is enough to detect it
+					}
+					body.resize(new_size);
+				}
+				PoolByteArray::Write w = body.write();
+				client->read_response_body(w.ptr() + downloaded, body.size() - downloaded, read);
 			}
+			downloaded += read;
 
 			if (body_size_limit >= 0 && downloaded > body_size_limit) {
 				call_deferred("_request_done", RESULT_BODY_SIZE_LIMIT_EXCEEDED, response_code, response_headers, PoolByteArray());
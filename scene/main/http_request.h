@@ -58,6 +58,10 @@ public:
 	};
 
 private:
+	enum {
+		READ_BUFFER_SIZE = 65536
+	};
+
 	bool requesting;
 
 	String request_string;
@@ -72,6 +76,7 @@ private:
 	bool request_sent;
 	Ref<HTTPClient> client;
 	PoolByteArray body;
+	Vector<uint8_t> read_buffer;
 	volatile bool use_threads;
 
 	bool got_response;
@@ -39,6 +39,9 @@
 #include "scene/scene_string_names.h"
 #include "viewport.h"
 
+// with fewer children, scanning them is faster than keeping the name index
+#define CHILD_NAME_INDEX_MIN 32
+
 VARIANT_ENUM_CAST(Node::PauseMode);
 VARIANT_ENUM_CAST(Node::RPCMode);
 
@@ -157,6 +160,10 @@ void Node::_notification(int p_notification) {
 			}
 
 			// kill children as cleanly as possible
+			if (data.child_name_index) {
+				memdelete(data.child_name_index);
+				data.child_name_index = NULL;
+			}
 			while (data.children.size()) {
 
 				Node *child = data.children[0];
@@ -337,6 +344,11 @@ void Node::move_child(Node *p_child, int p_pos) {
 
 		data.children[i]->data.pos = i;
 	}
+	if (data.child_name_index && data.child_name_index->duplicates) {
+		// it may have moved past another child with the same name
+		_child_name_index_remove(p_child, p_child->data.name);
+		_child_name_index_add(p_child);
+	}
 	// notification second
 	move_child_notify(p_child);
 	for (int i = motion_from; i <= motion_to; i++) {
@@ -1074,6 +1086,31 @@ bool Node::is_processing_internal() const {
 	return data.idle_process_internal;
 }
 
+void Node::set_process_priority(int p_priority) {
+
+	if (data.process_priority == p_priority)
+		return;
+
+	data.process_priority = p_priority;
+
+	if (!data.tree)
+		return;
+
+	if (data.idle_process)
+		data.tree->make_group_changed("idle_process");
+	if (data.idle_process_internal)
+		data.tree->make_group_changed("idle_process_internal");
+	if (data.physics_process)
+		data.tree->make_group_changed("physics_process");
+	if (data.physics_process_internal)
+		data.tree->make_group_changed("physics_process_internal");
+}
+
+int Node::get_process_priority() const {
+
+	return data.process_priority;
+}
+
 void Node::set_process_input(bool p_enable) {
 
 	if (p_enable == data.input)
@@ -1136,7 +1173,12 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName &p_name) {
 
+	StringName old_name = data.name;
 	data.name = p_name;
+
+	if (data.parent) {
+		data.parent->_child_renamed(this, old_name);
+	}
 }
 
 void Node::set_name(const String &p_name) {
@@ -1144,11 +1186,13 @@ void Node::set_name(const String &p_name) {
 	String name = p_name.replace(":", "").replace("/", "").replace("@", "");
 
 	ERR_FAIL_COND(name == "");
+	StringName old_name = data.name;
 	data.name = name;
 
 	if (data.parent) {
 
 		data.parent->_validate_child_name(this);
+		data.parent->_child_renamed(this, old_name);
 	}
 
 	propagate_notification(NOTIFICATION_PATH_CHANGED);
@@ -1202,17 +1246,7 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 			unique = false;
 		} else {
 			//check if exists
-			Node **children = data.children.ptrw();
-			int cc = data.children.size();
-
-			for (int i = 0; i < cc; i++) {
-				if (children[i] == p_child)
-					continue;
-				if (children[i]->data.name == p_child->data.name) {
-					unique = false;
-					break;
-				}
-			}
+			unique = !_has_other_child_named(p_child->data.name, p_child);
 		}
 
 		if (!unique) {
@@ -1270,16 +1304,7 @@ String Node::_generate_serial_child_name(Node *p_child) {
 	int num_places = nums.length();
 	for (;;) {
 		String attempt = (name + (num > 0 || explicit_zero ? nnsep + itos(num).pad_zeros(num_places) : "")).strip_edges();
-		bool found = false;
-		for (int i = 0; i < data.children.size(); i++) {
-			if (data.children[i] == p_child)
-				continue;
-			if (data.children[i]->data.name == attempt) {
-				found = true;
-				break;
-			}
-		}
-		if (!found) {
+		if (!_has_other_child_named(attempt, p_child)) {
 			return attempt;
 		} else {
 			if (num == 0) {
@@ -1304,6 +1329,7 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 	p_child->data.pos = data.children.size();
 	data.children.push_back(p_child);
 	p_child->data.parent = this;
+	_child_name_index_add(p_child);
 	p_child->notification(NOTIFICATION_PARENTED);
 
 	if (data.tree) {
@@ -1395,12 +1421,16 @@ void Node::remove_child(Node *p_child) {
 	}
 
 	int idx = -1;
-	for (int i = 0; i < data.children.size(); i++) {
+	if (p_child->data.parent == this && p_child->data.pos >= 0 && p_child->data.pos < data.children.size() && data.children[p_child->data.pos] == p_child) {
+		idx = p_child->data.pos;
+	} else {
+		for (int i = 0; i < data.children.size(); i++) {
 
-		if (data.children[i] == p_child) {
+			if (data.children[i] == p_child) {
 
-			idx = i;
-			break;
+				idx = i;
+				break;
+			}
 		}
 	}
 
@@ -1422,6 +1452,8 @@ void Node::remove_child(Node *p_child) {
 		data.children[i]->data.pos = i;
 	}
 
+	_child_name_index_remove(p_child, p_child->data.name);
+
 	p_child->data.parent = NULL;
 	p_child->data.pos = -1;
 
@@ -1440,8 +1472,96 @@ Node *Node::get_child(int p_index) const {
 	return data.children[p_index];
 }
 
+void Node::_child_name_index_add(Node *p_child) {
+
+	if (!data.child_name_index) {
+
+		if (data.children.size() < CHILD_NAME_INDEX_MIN)
+			return;
+
+		data.child_name_index = memnew(ChildNameIndex);
+		data.child_name_index->duplicates = false;
+		data.child_name_index->first.reserve(data.children.size());
+
+		for (int i = 0; i < data.children.size(); i++) {
+			_child_name_index_add(data.children[i]);
+		}
+		return;
+	}
+
+	Node **E = data.child_name_index->first.getptr(p_child->data.name);
+	if (!E) {
+		data.child_name_index->first.set(p_child->data.name, p_child);
+	} else if (*E != p_child) {
+		data.child_name_index->duplicates = true;
+		if ((*E)->data.pos > p_child->data.pos) {
+			*E = p_child;
+		}
+	}
+}
+
+void Node::_child_name_index_remove(Node *p_child, const StringName &p_name) {
+
+	if (!data.child_name_index)
+		return;
+
+	if (data.children.size() < CHILD_NAME_INDEX_MIN / 2) {
+		memdelete(data.child_name_index);
+		data.child_name_index = NULL;
+		return;
+	}
+
+	Node **E = data.child_name_index->first.getptr(p_name);
+	if (!E || *E != p_child)
+		return;
+
+	data.child_name_index->first.erase(p_name);
+
+	if (data.child_name_index->duplicates) {
+		for (int i = 0; i < data.children.size(); i++) {
+			if (data.children[i] != p_child && data.children[i]->data.name == p_name) {
+				data.child_name_index->first.set(p_name, data.children[i]);
+				break;
+			}
+		}
+	}
+}
+
+void Node::_child_renamed(Node *p_child, const StringName &p_old_name) {
+
+	_child_name_index_remove(p_child, p_old_name);
+	_child_name_index_add(p_child);
+}
+
+bool Node::_has_other_child_named(const StringName &p_name, const Node *p_child) const {
+
+	if (data.child_name_index) {
+		Node *const *E = data.child_name_index->first.getptr(p_name);
+		if (!E)
+			return false;
+		if (*E != p_child || !data.child_name_index->duplicates)
+			return *E != p_child;
+		// p_child is only the first with this name, a later child may share it
+	}
+
+	int cc = data.children.size();
+	Node *const *cd = data.children.ptr();
+
+	for (int i = 0; i < cc; i++) {
+		if (cd[i] != p_child && cd[i]->data.name == p_name)
+			return true;
+	}
+
+	return false;
+}
+
 Node *Node::_get_child_by_name(const StringName &p_name) const {
 
+	if (data.child_name_index) {
+		Node *const *E = data.child_name_index->first.getptr(p_name);
+		return E ? *E : NULL;
+	}
+
 	int cc = data.children.size();
 	Node *const *cd = data.children.ptr();
 
@@ -1494,18 +1614,7 @@ Node *Node::_get_node(const NodePath &p_path) const {
 
 		} else {
 
-			next = NULL;
-
-			for (int j = 0; j < current->data.children.size(); j++) {
-
-				Node *child = current->data.children[j];
-
-				if (child->data.name == name) {
-
-					next = child;
-					break;
-				}
-			}
+			next = current->_get_child_by_name(name);
 			if (next == NULL) {
 				return NULL;
 			};
@@ -2847,6 +2956,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_process_delta_time"), &Node::get_process_delta_time);
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
+	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
+	ClassDB::bind_method(D_METHOD("get_process_priority"), &Node::get_process_priority);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
 	ClassDB::bind_method(D_METHOD("set_process_unhandled_input", "enable"), &Node::set_process_unhandled_input);
@@ -2963,6 +3074,9 @@ void Node::_bind_methods() {
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/unhandled_input" ), "set_process_unhandled_input","is_processing_unhandled_input" ) ;
 	ADD_GROUP("Pause", "pause_");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::INT, "pause_mode", PROPERTY_HINT_ENUM, "Inherit,Stop,Process"), "set_pause_mode", "get_pause_mode");
+	ADD_GROUP("Process", "process_");
+	ADD_PROPERTYNZ(PropertyInfo(Variant::INT, "process_priority"), "set_process_priority", "get_process_priority");
+	ADD_GROUP("", "");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::BOOL, "editor/display_folded", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "set_display_folded", "is_displayed_folded");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::STRING, "name", PROPERTY_HINT_NONE, "", 0), "set_name", "get_name");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::STRING, "filename", PROPERTY_HINT_NONE, "", 0), "set_filename", "get_filename");
@@ -2997,11 +3111,13 @@ Node::Node() {
 	data.depth = -1;
 	data.blocked = 0;
 	data.parent = NULL;
+	data.child_name_index = NULL;
 	data.tree = NULL;
 	data.physics_process = false;
 	data.idle_process = false;
 	data.physics_process_internal = false;
 	data.idle_process_internal = false;
+	data.process_priority = 0;
 	data.inside_tree = false;
 	data.ready_notified = false;
 
@@ -3028,6 +3144,10 @@ Node::~Node() {
 	data.owned.clear();
 	data.children.clear();
 
+	if (data.child_name_index) {
+		memdelete(data.child_name_index);
+	}
+
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
 }
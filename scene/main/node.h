@@ -38,6 +38,7 @@
 #include "project_settings.h"
 #include "scene/main/scene_tree.h"
 #include "script_language.h"
+#include "swiss_hash_map.h"
 
 class Viewport;
 class SceneState;
@@ -79,6 +80,11 @@ public:
 		bool operator()(const Node *p_a, const Node *p_b) const { return p_b->is_greater_than(p_a); }
 	};
 
+	struct ComparatorWithPriority {
+
+		bool operator()(const Node *p_a, const Node *p_b) const { return p_b->data.process_priority == p_a->data.process_priority ? p_b->is_greater_than(p_a) : p_b->data.process_priority > p_a->data.process_priority; }
+	};
+
 private:
 	struct GroupData {
 
@@ -87,6 +93,13 @@ private:
 		GroupData() { persistent = false; }
 	};
 
+	// children by name, only kept for nodes with many children, where scanning them costs more than hashing
+	struct ChildNameIndex {
+
+		SwissHashMap<StringName, Node *, StringNameHasher> first; // the first child in order with each name
+		bool duplicates; // set once two children had the same name, then removals have to look for the next one
+	};
+
 	struct Data {
 
 		String filename;
@@ -98,6 +111,7 @@ private:
 		Node *parent;
 		Node *owner;
 		Vector<Node *> children; // list of children
+		ChildNameIndex *child_name_index;
 		int pos;
 		int depth;
 		int blocked; // safeguard that throws an error when attempting to modify the tree in a harmful way while being traversed.
@@ -131,6 +145,8 @@ private:
 		bool physics_process_internal;
 		bool idle_process_internal;
 
+		int process_priority;
+
 		bool input;
 		bool unhandled_input;
 		bool unhandled_key_input;
@@ -155,12 +171,17 @@ private:
 
 	Node *_get_node(const NodePath &p_path) const;
 	Node *_get_child_by_name(const StringName &p_name) const;
+	bool _has_other_child_named(const StringName &p_name, const Node *p_child) const;
 
 	void _replace_connections_target(Node *p_new_target);
 
 	void _validate_child_name(Node *p_child, bool p_force_human_readable = false);
 	String _generate_serial_child_name(Node *p_child);
 
+	void _child_name_index_add(Node *p_child);
+	void _child_name_index_remove(Node *p_child, const StringName &p_name);
+	void _child_renamed(Node *p_child, const StringName &p_old_name);
+
 	void _propagate_reverse_notification(int p_notification);
 	void _propagate_deferred_notification(int p_notification, bool p_reverse);
 	void _propagate_enter_tree();
@@ -317,6 +338,9 @@ public:
 	void set_process_internal(bool p_idle_process_internal);
 	bool is_processing_internal() const;
 
+	void set_process_priority(int p_priority);
+	int get_process_priority() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
@@ -31,6 +31,7 @@
 #include "scene_tree.h"
 
 #include "editor/editor_node.h"
+#include "frame_profiler.h"
 #include "io/marshalls.h"
 #include "io/resource_loader.h"
 #include "message_queue.h"
@@ -115,9 +116,9 @@ SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_nod
 		ERR_EXPLAIN("Already in group: " + p_group);
 		ERR_FAIL_V(&E->get());
 	}
+	// appended nodes are sorted into the group lazily, see _update_group_order()
 	E->get().nodes.push_back(p_node);
 	//E->get().last_tree_version=0;
-	E->get().changed = true;
 	return &E->get();
 }
 
@@ -126,11 +127,25 @@ void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
 	ERR_FAIL_COND(!E);
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty())
+	Group &g = E->get();
+	int idx = g.nodes.find(p_node);
+	if (idx != -1) {
+		g.nodes.remove(idx);
+		// removing keeps the rest in order, only the sorted prefix shrinks
+		if (idx < g.sorted)
+			g.sorted--;
+	}
+	if (g.nodes.empty())
 		group_map.erase(E);
 }
 
+void SceneTree::make_group_changed(const StringName &p_group) {
+
+	Map<StringName, Group>::Element *E = group_map.find(p_group);
+	if (E)
+		E->get().changed = true;
+}
+
 void SceneTree::flush_transform_notifications() {
 
 	SelfList<Node> *n = xform_change_list.first();
@@ -164,19 +179,71 @@ void SceneTree::_flush_ugc() {
 	ugc_locked = false;
 }
 
-void SceneTree::_update_group_order(Group &g) {
+template <class C>
+static void _sort_group_nodes(Node **p_nodes, int p_count, int p_sorted) {
+
+	SortArray<Node *, C> node_sort;
 
-	if (!g.changed)
+	if (p_sorted <= 0) {
+		node_sort.sort(p_nodes, p_count);
 		return;
-	if (g.nodes.empty())
+	}
+
+	// only the appended tail is out of order, sort it and merge it back
+	// from the end so the sorted prefix is not moved unless it has to be.
+	int tail_count = p_count - p_sorted;
+	if (tail_count <= 0)
 		return;
+	Node **tail = &p_nodes[p_sorted];
+	node_sort.sort(tail, tail_count);
+
+	C compare;
+	if (!compare(tail[0], p_nodes[p_sorted - 1]))
+		return; // tail goes after everything already in the group, common when spawning
+
+	Vector<Node *> tail_copy;
+	tail_copy.resize(tail_count);
+	Node **t = tail_copy.ptrw();
+	for (int i = 0; i < tail_count; i++)
+		t[i] = tail[i];
+
+	int a = p_sorted - 1;
+	int b = tail_count - 1;
+	int to = p_count - 1;
+	while (b >= 0) {
+		if (a >= 0 && compare(t[b], p_nodes[a])) {
+			p_nodes[to--] = p_nodes[a--];
+		} else {
+			p_nodes[to--] = t[b--];
+		}
+	}
+}
+
+void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 
-	Node **nodes = &g.nodes[0];
 	int node_count = g.nodes.size();
+	if (node_count == 0)
+		return;
+
+	if (g.priority_order != p_use_priority) {
+		g.priority_order = p_use_priority;
+		g.changed = true;
+	}
+
+	if (!g.changed && g.sorted == node_count)
+		return;
+
+	Node **nodes = g.nodes.ptrw();
+	int sorted = g.changed ? 0 : g.sorted;
+
+	if (p_use_priority) {
+		_sort_group_nodes<Node::ComparatorWithPriority>(nodes, node_count, sorted);
+	} else {
+		_sort_group_nodes<Node::Comparator>(nodes, node_count, sorted);
+	}
 
-	SortArray<Node *, Node::Comparator> node_sort;
-	node_sort.sort(nodes, node_count);
 	g.changed = false;
+	g.sorted = node_count;
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
@@ -214,13 +281,42 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 
 	_update_group_order(g);
 
-	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = &nodes_copy[0];
+	const Vector<Node *> nodes_copy = g.nodes; // shared, the group copies on write if it changes during the calls
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
 
-	if (p_call_flags & GROUP_CALL_REVERSE) {
+	if ((p_call_flags & GROUP_CALL_REALTIME) && !(p_call_flags & GROUP_CALL_MULTILEVEL)) {
+
+		VARIANT_ARGPTRS;
+
+		GroupCall call;
+		call.nodes = nodes;
+		call.node_count = node_count;
+		call.function = p_function;
+		call.args = argptr;
+		call.argcount = 0;
+		call.reverse = p_call_flags & GROUP_CALL_REVERSE;
+		while (call.argcount < VARIANT_ARG_MAX && argptr[call.argcount]->get_type() != Variant::NIL) {
+			call.argcount++;
+		}
+
+		bool parallel = (p_call_flags & GROUP_CALL_PARALLEL) && !group_call_parallel && node_count > GROUP_CALL_CHUNK_SIZE;
+		if (parallel && !group_call_pool_initialized) {
+			group_call_pool.init();
+			group_call_pool_initialized = true;
+		}
+
+		if (parallel && group_call_pool.get_thread_count() > 0) {
+			group_call_parallel = true;
+			group_call_pool.do_work((node_count + GROUP_CALL_CHUNK_SIZE - 1) / GROUP_CALL_CHUNK_SIZE, this, &SceneTree::_call_group_chunk, &call);
+			group_call_parallel = false;
+		} else {
+			_call_group_realtime(call, 0, node_count, call.reverse);
+		}
+
+	} else if (p_call_flags & GROUP_CALL_REVERSE) {
 
 		for (int i = node_count - 1; i >= 0; i--) {
 
@@ -258,6 +354,53 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 		call_skip.clear();
 }
 
+void SceneTree::_call_group_realtime(const GroupCall &p_call, int p_from, int p_to, bool p_reverse) {
+
+	// groups usually hold nodes of a few classes, so the method is looked up once per run of the same class
+	StringName class_name;
+	MethodBind *method = NULL;
+
+	for (int j = p_from; j < p_to; j++) {
+
+		Node *node = p_call.nodes[p_reverse ? p_to - 1 - (j - p_from) : j];
+
+		if (call_skip.has(node))
+			continue;
+
+		Variant::CallError ce;
+
+		if (!node->get_script_instance()) {
+
+			if (node->get_class_name() != class_name) {
+				class_name = node->get_class_name();
+				method = ClassDB::get_method(class_name, p_call.function);
+			}
+
+			if (method) {
+				method->call(node, p_call.args, p_call.argcount, ce);
+				continue;
+			}
+		}
+
+		node->call(p_call.function, p_call.args, p_call.argcount, ce);
+	}
+}
+
+void SceneTree::_call_group_chunk(uint32_t p_index, GroupCall *p_call) {
+
+	int from = p_index * GROUP_CALL_CHUNK_SIZE;
+	int to = MIN(from + GROUP_CALL_CHUNK_SIZE, p_call->node_count);
+
+	if (p_call->reverse) {
+		// mirror the chunk, so the end of the group is handed out first and each chunk runs backwards
+		int count = to - from;
+		to = p_call->node_count - from;
+		from = to - count;
+	}
+
+	_call_group_realtime(*p_call, from, to, p_call->reverse);
+}
+
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
 
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
@@ -269,8 +412,8 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 
 	_update_group_order(g);
 
-	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = &nodes_copy[0];
+	const Vector<Node *> nodes_copy = g.nodes;
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -318,8 +461,8 @@ void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group
 
 	_update_group_order(g);
 
-	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = &nodes_copy[0];
+	const Vector<Node *> nodes_copy = g.nodes;
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -447,6 +590,8 @@ void SceneTree::init() {
 
 bool SceneTree::iteration(float p_time) {
 
+	FRAME_PROFILE_SCOPE("scene/physics_process");
+
 	root_lock++;
 
 	current_frame++;
@@ -474,6 +619,8 @@ bool SceneTree::iteration(float p_time) {
 
 bool SceneTree::idle(float p_time) {
 
+	FRAME_PROFILE_SCOPE("scene/idle");
+
 	//print_line("ram: "+itos(OS::get_singleton()->get_static_memory_usage())+" sram: "+itos(OS::get_singleton()->get_dynamic_memory_usage()));
 	//print_line("node count: "+itos(get_node_count()));
 	//print_line("TEXTURE RAM: "+itos(VS::get_singleton()->get_render_info(VS::INFO_TEXTURE_MEM_USED)));
@@ -861,12 +1008,13 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 
 	_update_group_order(g);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
+	//copy, so the list is not affected if something is added to or removed from the group while being called.
+	//this only references the data, nodes are copied only if the group is modified during the loop.
+	const Vector<Node *> nodes_copy = g.nodes;
 
 	int node_count = nodes_copy.size();
-	Node **nodes = &nodes_copy[0];
+	Node *const *nodes = nodes_copy.ptr();
+	bool check_process = pause;
 
 	Variant arg = p_input;
 	const Variant *v[1] = { &arg };
@@ -882,7 +1030,7 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 		if (call_lock && call_skip.has(n))
 			continue;
 
-		if (!n->can_process())
+		if (check_process && !n->can_process())
 			continue;
 
 		n->call_multilevel(p_method, (const Variant **)v, 1);
@@ -903,14 +1051,17 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 	if (g.nodes.empty())
 		return;
 
-	_update_group_order(g);
+	// process notifications honor Node.process_priority, other groups keep tree order
+	_update_group_order(g, true);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
+	//copy, so the list is not affected if something is added to or removed from the group while being called.
+	//this only references the data, nodes are copied only if the group is modified during the loop.
+	const Vector<Node *> nodes_copy = g.nodes;
 
 	int node_count = nodes_copy.size();
-	Node **nodes = &nodes_copy[0];
+	Node *const *nodes = nodes_copy.ptr();
+	// without pause every node inside the tree can process
+	bool check_process = pause;
 
 	call_lock++;
 
@@ -920,7 +1071,7 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 		if (call_lock && call_skip.has(n))
 			continue;
 
-		if (!n->can_process())
+		if (check_process && !n->can_process())
 			continue;
 
 		n->notification(p_notification);
@@ -1010,7 +1161,7 @@ Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 
 	ret.resize(nc);
 
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = E->get().nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		ret[i] = ptr[i];
@@ -1033,13 +1184,23 @@ void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_li
 	int nc = E->get().nodes.size();
 	if (nc == 0)
 		return;
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = E->get().nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		p_list->push_back(ptr[i]);
 	}
 }
 
+Vector<Node *> SceneTree::get_group_snapshot(const StringName &p_group) {
+
+	Map<StringName, Group>::Element *E = group_map.find(p_group);
+	if (!E)
+		return Vector<Node *>();
+
+	_update_group_order(E->get());
+	return E->get().nodes;
+}
+
 static void _fill_array(Node *p_node, Array &array, int p_level) {
 
 	array.push_back(p_level);
@@ -1734,6 +1895,21 @@ bool SceneTree::is_refusing_new_network_connections() const {
 	return network_peer->is_refusing_new_connections();
 }
 
+Error SceneTree::_encode_rpc_variant(const Variant &p_value, bool p_compact, int p_ofs, int &r_len) {
+
+	if (p_compact) {
+		//single pass straight into the cache
+		return encode_variant_compact(p_value, packet_cache, r_len, p_ofs);
+	}
+
+	Error err = encode_variant(p_value, NULL, r_len);
+	if (err != OK)
+		return err;
+	if (packet_cache.size() < p_ofs + r_len)
+		packet_cache.resize(p_ofs + r_len);
+	return encode_variant(p_value, &packet_cache[p_ofs], r_len);
+}
+
 void SceneTree::_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount) {
 
 	if (network_peer.is_null()) {
@@ -1802,12 +1978,14 @@ void SceneTree::_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, cons
 	encode_cstring(name.get_data(), &packet_cache[ofs]);
 	ofs += len;
 
+	//legacy encoding unless the peer opted in, compact values carry their own
+	//marker so decode_variant() on the receiving end reads either format
+	bool compact = network_peer->is_compact_encoding_enabled();
+
 	if (p_set) {
 		//set argument
-		Error err = encode_variant(*p_arg[0], NULL, len);
+		Error err = _encode_rpc_variant(*p_arg[0], compact, ofs, len);
 		ERR_FAIL_COND(err != OK);
-		MAKE_ROOM(ofs + len);
-		encode_variant(*p_arg[0], &packet_cache[ofs], len);
 		ofs += len;
 
 	} else {
@@ -1816,10 +1994,8 @@ void SceneTree::_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, cons
 		packet_cache[ofs] = p_argcount;
 		ofs += 1;
 		for (int i = 0; i < p_argcount; i++) {
-			Error err = encode_variant(*p_arg[i], NULL, len);
+			Error err = _encode_rpc_variant(*p_arg[i], compact, ofs, len);
 			ERR_FAIL_COND(err != OK);
-			MAKE_ROOM(ofs + len);
-			encode_variant(*p_arg[i], &packet_cache[ofs], len);
 			ofs += len;
 		}
 	}
@@ -2002,6 +2178,7 @@ void SceneTree::_network_process_packet(int p_from, const uint8_t *p_packet, int
 
 					ERR_FAIL_COND(ofs >= p_packet_len);
 					int vlen;
+					//legacy or compact, compact values are tagged so both decode here
 					Error err = decode_variant(args[i], &p_packet[ofs], p_packet_len - ofs, &vlen);
 					ERR_FAIL_COND(err != OK);
 					//args[i]=p_packet[3+i];
@@ -2244,6 +2421,7 @@ void SceneTree::_bind_methods() {
 	BIND_ENUM_CONSTANT(GROUP_CALL_REVERSE);
 	BIND_ENUM_CONSTANT(GROUP_CALL_REALTIME);
 	BIND_ENUM_CONSTANT(GROUP_CALL_UNIQUE);
+	BIND_ENUM_CONSTANT(GROUP_CALL_PARALLEL);
 
 	BIND_ENUM_CONSTANT(STRETCH_MODE_DISABLED);
 	BIND_ENUM_CONSTANT(STRETCH_MODE_2D);
@@ -2316,6 +2494,8 @@ SceneTree::SceneTree() {
 	node_removed_name = "node_removed";
 	ugc_locked = false;
 	call_lock = 0;
+	group_call_pool_initialized = false;
+	group_call_parallel = false;
 	root_lock = 0;
 	node_count = 0;
 	rpc_sender_id = 0;
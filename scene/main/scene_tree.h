@@ -34,6 +34,7 @@
 #include "io/networked_multiplayer_peer.h"
 #include "os/main_loop.h"
 #include "os/thread_safe.h"
+#include "os/thread_work_pool.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/world.h"
 #include "scene/resources/world_2d.h"
@@ -100,7 +101,13 @@ private:
 		Vector<Node *> nodes;
 		//uint64_t last_tree_version;
 		bool changed;
-		Group() { changed = false; };
+		int sorted; // leading nodes already in order, the rest were appended since the last sort
+		bool priority_order;
+		Group() {
+			changed = false;
+			sorted = 0;
+			priority_order = false;
+		};
 	};
 
 	Viewport *root;
@@ -148,6 +155,27 @@ private:
 	int call_lock;
 	Set<Node *> call_skip; //skip erased nodes
 
+	enum {
+		GROUP_CALL_CHUNK_SIZE = 64 // nodes per task of a parallel group call
+	};
+
+	struct GroupCall {
+
+		Node *const *nodes;
+		int node_count;
+		StringName function;
+		const Variant **args;
+		int argcount;
+		bool reverse;
+	};
+
+	ThreadWorkPool group_call_pool;
+	bool group_call_pool_initialized;
+	bool group_call_parallel; // a parallel group call is running, nested ones are done serially
+
+	void _call_group_realtime(const GroupCall &p_call, int p_from, int p_to, bool p_reverse);
+	void _call_group_chunk(uint32_t p_index, GroupCall *p_call);
+
 	StretchMode stretch_mode;
 	StretchAspect stretch_aspect;
 	Size2i stretch_min;
@@ -161,7 +189,7 @@ private:
 	bool ugc_locked;
 	void _flush_ugc();
 
-	_FORCE_INLINE_ void _update_group_order(Group &g);
+	void _update_group_order(Group &g, bool p_use_priority = false);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -233,6 +261,7 @@ private:
 	static SceneTree *singleton;
 	friend class Node;
 
+	Error _encode_rpc_variant(const Variant &p_value, bool p_compact, int p_ofs, int &r_len);
 	void _rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
 
 	void tree_changed();
@@ -241,6 +270,7 @@ private:
 
 	Group *add_to_group(const StringName &p_group, Node *p_node);
 	void remove_from_group(const StringName &p_group, Node *p_node);
+	void make_group_changed(const StringName &p_group);
 
 	void _notify_group_pause(const StringName &p_group, int p_notification);
 	void _call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input);
@@ -332,6 +362,7 @@ public:
 		GROUP_CALL_REALTIME = 2,
 		GROUP_CALL_UNIQUE = 4,
 		GROUP_CALL_MULTILEVEL = 8,
+		GROUP_CALL_PARALLEL = 16, // realtime calls only, the method must be safe to run on several nodes at once
 	};
 
 	_FORCE_INLINE_ Viewport *get_root() const { return root; }
@@ -418,6 +449,7 @@ public:
 	void queue_delete(Object *p_object);
 
 	void get_nodes_in_group(const StringName &p_group, List<Node *> *p_list);
+	Vector<Node *> get_group_snapshot(const StringName &p_group); // sorted, shares the group's array until it changes
 	bool has_group(const StringName &p_identifier) const;
 
 	void set_screen_stretch(StretchMode p_mode, StretchAspect p_aspect, const Size2 p_minsize, real_t p_shrink = 1);
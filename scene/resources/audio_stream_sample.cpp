@@ -30,6 +30,8 @@
 
 #include "audio_stream_sample.h"
 
+#include "servers/audio/audio_mix_kernels.h"
+
 void AudioStreamPlaybackSample::start(float p_from_pos) {
 
 	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
@@ -90,6 +92,12 @@ void AudioStreamPlaybackSample::seek(float p_time) {
 template <class Depth, bool is_stereo, bool is_ima_adpcm>
 void AudioStreamPlaybackSample::do_resample(const Depth *p_src, AudioFrame *p_dst, int64_t &offset, int32_t &increment, uint32_t amount, IMA_ADPCM_State *ima_adpcm) {
 
+	if (!is_ima_adpcm) {
+		// plain PCM is interpolated by the (vectorized) mixing kernels
+		AudioMixKernels::resample_linear(p_src, p_dst, amount, offset, increment, MIX_FRAC_BITS, is_stereo);
+		return;
+	}
+
 	// this function will be compiled branchless by any decent compiler
 
 	int32_t final, final_r, next, next_r;
@@ -219,9 +227,7 @@ void AudioStreamPlaybackSample::do_resample(const Depth *p_src, AudioFrame *p_ds
 void AudioStreamPlaybackSample::mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
 
 	if (!base->data || !active) {
-		for (int i = 0; i < p_frames; i++) {
-			p_buffer[i] = AudioFrame(0, 0);
-		}
+		AudioMixKernels::clear(p_buffer, p_frames);
 		return;
 	}
 
@@ -384,8 +390,67 @@ void AudioStreamPlaybackSample::mix(AudioFrame *p_buffer, float p_rate_scale, in
 	if (todo) {
 		//bit was missing from mix
 		int todo_ofs = p_frames - todo;
-		for (int i = todo_ofs; i < p_frames; i++) {
-			p_buffer[i] = AudioFrame(0, 0);
+		AudioMixKernels::clear(p_buffer + todo_ofs, todo);
+	}
+}
+
+void AudioStreamPlaybackSample::skip(float p_rate_scale, int p_frames) {
+
+	if (!base->data || !active) {
+		return;
+	}
+
+	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
+		//the decoder state depends on every previous nibble, so it must be decoded anyway
+		AudioStreamPlayback::skip(p_rate_scale, p_frames);
+		return;
+	}
+
+	int len = base->data_bytes;
+	if (base->format == AudioStreamSample::FORMAT_16_BITS) {
+		len /= 2;
+	}
+	if (base->stereo) {
+		len /= 2;
+	}
+
+	float fincrement = base->mix_rate * p_rate_scale / AudioServer::get_singleton()->get_mix_rate();
+	int64_t advance = int64_t(int32_t(fincrement * MIX_FRAC_LEN)) * p_frames;
+
+	int64_t loop_begin_fp = ((int64_t)base->loop_begin << MIX_FRAC_BITS);
+	int64_t loop_end_fp = ((int64_t)base->loop_end << MIX_FRAC_BITS);
+	int64_t loop_len_fp = loop_end_fp - loop_begin_fp;
+
+	if (base->loop_mode == AudioStreamSample::LOOP_DISABLED || loop_len_fp <= 0) {
+
+		offset += advance;
+		if (offset >= ((int64_t)len << MIX_FRAC_BITS)) {
+			active = false;
+		}
+
+	} else if (base->loop_mode == AudioStreamSample::LOOP_FORWARD) {
+
+		offset += advance;
+		if (offset >= loop_end_fp) {
+			offset = loop_begin_fp + (offset - loop_begin_fp) % loop_len_fp;
+		}
+
+	} else if (sign > 0 && offset + advance < loop_end_fp) {
+
+		offset += advance;
+
+	} else {
+
+		//ping pong, unfold the bounces into a single forward position within a period of two loop lengths
+		int64_t period = loop_len_fp * 2;
+		int64_t unfolded = (sign > 0 ? offset - loop_begin_fp : period - (offset - loop_begin_fp)) + advance;
+		unfolded %= period;
+		if (unfolded < loop_len_fp) {
+			offset = loop_begin_fp + unfolded;
+			sign = 1;
+		} else {
+			offset = loop_begin_fp + period - unfolded;
+			sign = -1;
 		}
 	}
 }
@@ -76,6 +76,7 @@ public:
 	virtual void seek(float p_time);
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames);
+	virtual void skip(float p_rate_scale, int p_frames);
 
 	AudioStreamPlaybackSample();
 };
@@ -30,6 +30,7 @@
 
 #include "concave_polygon_shape.h"
 
+#include "core/math/triangle_bvh.h"
 #include "servers/physics_server.h"
 
 Vector<Vector3> ConcavePolygonShape::_gen_debug_mesh_lines() {
@@ -69,7 +70,19 @@ void ConcavePolygonShape::_update_shape() {
 
 void ConcavePolygonShape::set_faces(const PoolVector<Vector3> &p_faces) {
 
-	PhysicsServer::get_singleton()->shape_set_data(get_shape(), p_faces);
+	if (bvh_pending && bvh_data.size()) {
+
+		Dictionary d;
+		d["faces"] = p_faces;
+		d["bvh"] = bvh_data;
+		PhysicsServer::get_singleton()->shape_set_data(get_shape(), d);
+	} else {
+
+		PhysicsServer::get_singleton()->shape_set_data(get_shape(), p_faces);
+		bvh_data = PoolVector<uint8_t>();
+	}
+
+	bvh_pending = false;
 	notify_change_to_owners();
 }
 
@@ -78,15 +91,80 @@ PoolVector<Vector3> ConcavePolygonShape::get_faces() const {
 	return PhysicsServer::get_singleton()->shape_get_data(get_shape());
 }
 
+void ConcavePolygonShape::set_store_bvh(bool p_enable) {
+
+	store_bvh = p_enable;
+	_change_notify();
+}
+
+bool ConcavePolygonShape::is_storing_bvh() const {
+
+	return store_bvh;
+}
+
+void ConcavePolygonShape::_set_bvh_data(const PoolVector<uint8_t> &p_data) {
+
+	bvh_data = p_data;
+	bvh_pending = true;
+}
+
+PoolVector<uint8_t> ConcavePolygonShape::_get_bvh_data() const {
+
+	if (!store_bvh)
+		return PoolVector<uint8_t>();
+
+	if (bvh_data.size() == 0) {
+
+		// same primitives the physics server builds its tree from, one per face
+		PoolVector<Vector3> faces = get_faces();
+		int face_count = faces.size() / 3;
+		if (face_count == 0)
+			return PoolVector<uint8_t>();
+
+		Vector<AABB> aabbs;
+		aabbs.resize(face_count);
+		PoolVector<Vector3>::Read r = faces.read();
+		for (int i = 0; i < face_count; i++) {
+			aabbs[i] = Face3(r[i * 3 + 0], r[i * 3 + 1], r[i * 3 + 2]).get_aabb();
+		}
+
+		TriangleBVH bvh;
+		bvh.build(aabbs.ptr(), face_count);
+		bvh_data = bvh.serialize();
+	}
+
+	return bvh_data;
+}
+
+void ConcavePolygonShape::_validate_property(PropertyInfo &property) const {
+
+	if (property.name == "bvh_data" && !store_bvh) {
+		property.usage = PROPERTY_USAGE_INTERNAL;
+	}
+}
+
 void ConcavePolygonShape::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_faces", "faces"), &ConcavePolygonShape::set_faces);
 	ClassDB::bind_method(D_METHOD("get_faces"), &ConcavePolygonShape::get_faces);
+
+	ClassDB::bind_method(D_METHOD("set_store_bvh", "enable"), &ConcavePolygonShape::set_store_bvh);
+	ClassDB::bind_method(D_METHOD("is_storing_bvh"), &ConcavePolygonShape::is_storing_bvh);
+
+	ClassDB::bind_method(D_METHOD("_set_bvh_data", "data"), &ConcavePolygonShape::_set_bvh_data);
+	ClassDB::bind_method(D_METHOD("_get_bvh_data"), &ConcavePolygonShape::_get_bvh_data);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "store_bvh"), "set_store_bvh", "is_storing_bvh");
+	// the tree has to be loaded before the faces it belongs to
+	ADD_PROPERTY(PropertyInfo(Variant::POOL_BYTE_ARRAY, "bvh_data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "_set_bvh_data", "_get_bvh_data");
 	ADD_PROPERTY(PropertyInfo(Variant::POOL_VECTOR3_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "set_faces", "get_faces");
 }
 
 ConcavePolygonShape::ConcavePolygonShape() :
 		Shape(PhysicsServer::get_singleton()->shape_create(PhysicsServer::SHAPE_CONCAVE_POLYGON)) {
 
+	store_bvh = false;
+	bvh_pending = false;
+
 	//set_planes(Vector3(1,1,1));
 }
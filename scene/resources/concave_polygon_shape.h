@@ -57,8 +57,16 @@ class ConcavePolygonShape : public Shape {
 		}
 	};
 
+	bool store_bvh;
+	bool bvh_pending; // loaded before the faces, consumed by the next set_faces()
+	mutable PoolVector<uint8_t> bvh_data; //cached
+
+	void _set_bvh_data(const PoolVector<uint8_t> &p_data);
+	PoolVector<uint8_t> _get_bvh_data() const;
+
 protected:
 	static void _bind_methods();
+	virtual void _validate_property(PropertyInfo &property) const;
 
 	virtual void _update_shape();
 	virtual Vector<Vector3> _gen_debug_mesh_lines();
@@ -67,6 +75,9 @@ public:
 	void set_faces(const PoolVector<Vector3> &p_faces);
 	PoolVector<Vector3> get_faces() const;
 
+	void set_store_bvh(bool p_enable);
+	bool is_storing_bvh() const;
+
 	ConcavePolygonShape();
 };
 
@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  height_map_shape.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "height_map_shape.h"
+
+#include "servers/physics_server.h"
+
+Vector<Vector3> HeightMapShape::_gen_debug_mesh_lines() {
+
+	Vector<Vector3> points;
+
+	if (map_width < 2 || map_depth < 2)
+		return points;
+
+	// centered on the origin, like the physics servers place it
+	Vector3 start((map_width - 1) * -0.5 * cell_size, 0, (map_depth - 1) * -0.5 * cell_size);
+
+	PoolRealArray::Read r = map_data.read();
+
+	for (int d = 0; d < map_depth; d++) {
+		for (int w = 0; w < map_width; w++) {
+
+			Vector3 point = start + Vector3(w * cell_size, r[d * map_width + w], d * cell_size);
+
+			if (w + 1 < map_width) {
+				points.push_back(point);
+				points.push_back(start + Vector3((w + 1) * cell_size, r[d * map_width + w + 1], d * cell_size));
+			}
+
+			if (d + 1 < map_depth) {
+				points.push_back(point);
+				points.push_back(start + Vector3(w * cell_size, r[(d + 1) * map_width + w], (d + 1) * cell_size));
+			}
+		}
+	}
+
+	return points;
+}
+
+void HeightMapShape::_update_shape() {
+
+	Dictionary d;
+	d["width"] = map_width;
+	d["depth"] = map_depth;
+	d["cell_size"] = cell_size;
+	d["heights"] = map_data;
+
+	PhysicsServer::get_singleton()->shape_set_data(get_shape(), d);
+}
+
+void HeightMapShape::set_map_width(int p_new) {
+
+	ERR_FAIL_COND(p_new < 1);
+	if (map_width == p_new)
+		return;
+
+	// keep the heights of the rows that are still there
+	PoolRealArray new_data;
+	new_data.resize(p_new * map_depth);
+	{
+		PoolRealArray::Read r = map_data.read();
+		PoolRealArray::Write w = new_data.write();
+		for (int d = 0; d < map_depth; d++) {
+			for (int i = 0; i < p_new; i++) {
+				w[d * p_new + i] = i < map_width ? r[d * map_width + i] : 0;
+			}
+		}
+	}
+
+	map_width = p_new;
+	map_data = new_data;
+
+	_update_shape();
+	notify_change_to_owners();
+	_change_notify("map_width");
+	_change_notify("map_data");
+}
+
+int HeightMapShape::get_map_width() const {
+
+	return map_width;
+}
+
+void HeightMapShape::set_map_depth(int p_new) {
+
+	ERR_FAIL_COND(p_new < 1);
+	if (map_depth == p_new)
+		return;
+
+	int old_size = map_data.size();
+	map_data.resize(p_new * map_width);
+	{
+		PoolRealArray::Write w = map_data.write();
+		for (int i = old_size; i < map_data.size(); i++) {
+			w[i] = 0;
+		}
+	}
+
+	map_depth = p_new;
+
+	_update_shape();
+	notify_change_to_owners();
+	_change_notify("map_depth");
+	_change_notify("map_data");
+}
+
+int HeightMapShape::get_map_depth() const {
+
+	return map_depth;
+}
+
+void HeightMapShape::set_map_data(PoolRealArray p_new) {
+
+	ERR_FAIL_COND(p_new.size() != map_width * map_depth);
+
+	map_data = p_new;
+
+	_update_shape();
+	notify_change_to_owners();
+	_change_notify("map_data");
+}
+
+PoolRealArray HeightMapShape::get_map_data() const {
+
+	return map_data;
+}
+
+void HeightMapShape::set_cell_size(real_t p_cell_size) {
+
+	ERR_FAIL_COND(p_cell_size <= CMP_EPSILON);
+
+	cell_size = p_cell_size;
+
+	_update_shape();
+	notify_change_to_owners();
+	_change_notify("cell_size");
+}
+
+real_t HeightMapShape::get_cell_size() const {
+
+	return cell_size;
+}
+
+void HeightMapShape::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_map_width", "width"), &HeightMapShape::set_map_width);
+	ClassDB::bind_method(D_METHOD("get_map_width"), &HeightMapShape::get_map_width);
+	ClassDB::bind_method(D_METHOD("set_map_depth", "depth"), &HeightMapShape::set_map_depth);
+	ClassDB::bind_method(D_METHOD("get_map_depth"), &HeightMapShape::get_map_depth);
+	ClassDB::bind_method(D_METHOD("set_map_data", "data"), &HeightMapShape::set_map_data);
+	ClassDB::bind_method(D_METHOD("get_map_data"), &HeightMapShape::get_map_data);
+	ClassDB::bind_method(D_METHOD("set_cell_size", "cell_size"), &HeightMapShape::set_cell_size);
+	ClassDB::bind_method(D_METHOD("get_cell_size"), &HeightMapShape::get_cell_size);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "map_width", PROPERTY_HINT_RANGE, "1,4096,1"), "set_map_width", "get_map_width");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "map_depth", PROPERTY_HINT_RANGE, "1,4096,1"), "set_map_depth", "get_map_depth");
+	ADD_PROPERTY(PropertyInfo(Variant::POOL_REAL_ARRAY, "map_data"), "set_map_data", "get_map_data");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "cell_size", PROPERTY_HINT_RANGE, "0.01,1024,0.01,or_greater"), "set_cell_size", "get_cell_size");
+}
+
+HeightMapShape::HeightMapShape() :
+		Shape(PhysicsServer::get_singleton()->shape_create(PhysicsServer::SHAPE_HEIGHTMAP)) {
+
+	map_width = 2;
+	map_depth = 2;
+	cell_size = 1;
+	map_data.resize(map_width * map_depth);
+	{
+		PoolRealArray::Write w = map_data.write();
+		for (int i = 0; i < map_data.size(); i++) {
+			w[i] = 0;
+		}
+	}
+
+	_update_shape();
+}
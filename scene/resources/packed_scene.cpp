@@ -45,6 +45,156 @@ bool SceneState::can_instance() const {
 	return nodes.size() > 0;
 }
 
+const SceneState::Program *SceneState::_get_program() const {
+
+	MutexLock lock(program_mutex);
+
+	if (program)
+		return program;
+
+	Program *prog = memnew(Program);
+
+	int nc = nodes.size();
+	prog->nodes.resize(nc);
+
+	for (int i = 0; i < nc; i++) {
+
+		const NodeData &n = nodes[i];
+		ProgramNode &pn = prog->nodes[i];
+		pn.create = NULL;
+
+		// nodes that come from other scenes are only known once instanced
+		if ((i == 0 && base_scene_idx >= 0) || n.instance >= 0 || n.type == TYPE_INSTANCED || n.type < 0 || n.type >= names.size())
+			continue;
+
+		StringName class_name;
+		if (ClassDB::is_class_enabled(names[n.type])) {
+			pn.create = ClassDB::get_creation_func(names[n.type], &class_name);
+		}
+		if (!pn.create || !ClassDB::is_parent_class(class_name, "Node")) {
+			//missing classes are replaced by a generic node, with a warning
+			pn.create = NULL;
+			continue;
+		}
+
+		pn.properties.resize(n.properties.size());
+
+		for (int j = 0; j < n.properties.size(); j++) {
+
+			ProgramProperty &pp = pn.properties[j];
+			pp.name = n.properties[j].name;
+			pp.value = n.properties[j].value;
+			pp.setter = NULL;
+			pp.index = -1;
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+			pp.ptr_type = Variant::NIL;
+#endif
+
+			if (pp.name < 0 || pp.name >= names.size() || pp.value < 0 || pp.value >= variants.size() || names[pp.name] == CoreStringNames::get_singleton()->_script)
+				continue;
+
+			// same lookup as ClassDB::set_property(), properties without a bound setter keep going through Object::set()
+			const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(class_name, names[pp.name]);
+			if (!psg || !psg->_setptr)
+				continue;
+
+			pp.setter = psg->_setptr;
+			pp.index = psg->index;
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+			// ptrcall() doesn't convert nor check its arguments, so it's only used when the value has exactly the argument type
+			const Variant &value = variants[pp.value];
+			int value_arg = pp.index >= 0 ? 1 : 0;
+			if (pp.setter->has_return() || pp.setter->is_vararg() || pp.setter->get_argument_count() != value_arg + 1)
+				continue;
+			if ((pp.index >= 0 && pp.setter->get_argument_type(0) != Variant::INT) || pp.setter->get_argument_type(value_arg) != value.get_type())
+				continue;
+
+			switch (value.get_type()) {
+				case Variant::BOOL: pp.ptr_value._bool = value; break;
+				case Variant::INT: pp.ptr_value._int = value; break;
+				case Variant::REAL: pp.ptr_value._real = value; break;
+				case Variant::STRING: pp.ptr_string = value; break;
+				case Variant::VECTOR2: *reinterpret_cast<Vector2 *>(pp.ptr_value._mem) = value; break;
+				case Variant::RECT2: *reinterpret_cast<Rect2 *>(pp.ptr_value._mem) = value; break;
+				case Variant::VECTOR3: *reinterpret_cast<Vector3 *>(pp.ptr_value._mem) = value; break;
+				case Variant::TRANSFORM2D: *reinterpret_cast<Transform2D *>(pp.ptr_value._mem) = value; break;
+				case Variant::PLANE: *reinterpret_cast<Plane *>(pp.ptr_value._mem) = value; break;
+				case Variant::QUAT: *reinterpret_cast<Quat *>(pp.ptr_value._mem) = value; break;
+				case Variant::AABB: *reinterpret_cast<AABB *>(pp.ptr_value._mem) = value; break;
+				case Variant::BASIS: *reinterpret_cast<Basis *>(pp.ptr_value._mem) = value; break;
+				case Variant::TRANSFORM: *reinterpret_cast<Transform *>(pp.ptr_value._mem) = value; break;
+				case Variant::COLOR: *reinterpret_cast<Color *>(pp.ptr_value._mem) = value; break;
+				case Variant::NODE_PATH: pp.ptr_node_path = value; break;
+				default: continue; // objects may be duplicated for the scene, the rest is not worth it
+			}
+			pp.ptr_type = value.get_type();
+#endif
+		}
+	}
+
+	int cc = connections.size();
+	prog->connection_binds.resize(cc);
+
+	for (int i = 0; i < cc; i++) {
+
+		const ConnectionData &c = connections[i];
+		Vector<Variant> &binds = prog->connection_binds[i];
+		binds.resize(c.binds.size());
+		for (int j = 0; j < c.binds.size(); j++) {
+			binds[j] = variants[c.binds[j]];
+		}
+	}
+
+	program = prog;
+	return program;
+}
+
+void SceneState::_clear_program() {
+
+	MutexLock lock(program_mutex);
+
+	if (program) {
+		memdelete(program);
+		program = NULL;
+	}
+}
+
+void SceneState::_set_program_property(Node *p_node, const ProgramProperty &p_property, const Variant &p_value) {
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	if (p_property.ptr_type != Variant::NIL) {
+
+		const void *value;
+		switch (p_property.ptr_type) {
+			case Variant::STRING: value = &p_property.ptr_string; break;
+			case Variant::NODE_PATH: value = &p_property.ptr_node_path; break;
+			default: value = &p_property.ptr_value; break;
+		}
+
+		if (p_property.index >= 0) {
+			int64_t index = p_property.index;
+			const void *args[2] = { &index, value };
+			p_property.setter->ptrcall(p_node, args, NULL);
+		} else {
+			const void *args[1] = { value };
+			p_property.setter->ptrcall(p_node, args, NULL);
+		}
+		return;
+	}
+#endif
+
+	Variant::CallError ce;
+	if (p_property.index >= 0) {
+		Variant index = p_property.index;
+		const Variant *args[2] = { &index, &p_value };
+		p_property.setter->call(p_node, args, 2, ce);
+	} else {
+		const Variant *args[1] = { &p_value };
+		p_property.setter->call(p_node, args, 1, ce);
+	}
+}
+
 Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	// nodes where instancing failed (because something is missing)
@@ -81,6 +231,9 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	bool gen_node_path_cache = p_edit_state != GEN_EDIT_STATE_DISABLED && node_path_cache.empty();
 
+	// edit states keep the generic path, they also have to fill the node path cache
+	const Program *prog = p_edit_state == GEN_EDIT_STATE_DISABLED ? _get_program() : NULL;
+
 	Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
 
 	for (int i = 0; i < nc; i++) {
@@ -150,6 +303,10 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 				}
 #endif
 			}
+		} else if (prog && prog->nodes[i].create) {
+			//created by the compiled program, the class is known to be a node
+			node = static_cast<Node *>(prog->nodes[i].create());
+
 		} else if (ClassDB::is_class_enabled(snames[n.type])) {
 			//print_line("created");
 			//node belongs to this scene and must be created
@@ -191,6 +348,7 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 			if (nprop_count) {
 
 				const NodeData::Property *nprops = &n.properties[0];
+				const ProgramProperty *pprops = prog && prog->nodes[i].create ? prog->nodes[i].properties.ptr() : NULL;
 
 				for (int j = 0; j < nprop_count; j++) {
 
@@ -250,9 +408,19 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 								}
 							}
 						}
-						node->set(snames[nprops[j].name], value, &valid);
+						if (pprops && pprops[j].setter && !node->get_script_instance()) {
+							_set_program_property(node, pprops[j], value);
+						} else {
+							node->set(snames[nprops[j].name], value, &valid);
+						}
 					}
 				}
+
+#ifdef TOOLS_ENABLED
+				if (pprops) {
+					node->set_edited(true); // what Object::set() does
+				}
+#endif
 			}
 
 			//name
@@ -320,7 +488,9 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 			continue;
 
 		Vector<Variant> binds;
-		if (c.binds.size()) {
+		if (prog) {
+			binds = prog->connection_binds[i];
+		} else if (c.binds.size()) {
 			binds.resize(c.binds.size());
 			for (int j = 0; j < c.binds.size(); j++)
 				binds[j] = props[c.binds[j]];
@@ -905,6 +1075,7 @@ String SceneState::get_path() const {
 
 void SceneState::clear() {
 
+	_clear_program();
 	names.clear();
 	variants.clear();
 	nodes.clear();
@@ -1072,6 +1243,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 	ERR_FAIL_COND(!p_dictionary.has("conns"));
 	//ERR_FAIL_COND( !p_dictionary.has("path"));
 
+	_clear_program();
+
 	int version = 1;
 	if (p_dictionary.has("version"))
 		version = p_dictionary["version"];
@@ -1513,6 +1686,7 @@ Vector<NodePath> SceneState::get_editable_instances() const {
 
 int SceneState::add_name(const StringName &p_name) {
 
+	_clear_program();
 	names.push_back(p_name);
 	return names.size() - 1;
 }
@@ -1529,6 +1703,7 @@ int SceneState::find_name(const StringName &p_name) const {
 
 int SceneState::add_value(const Variant &p_value) {
 
+	_clear_program();
 	variants.push_back(p_value);
 	return variants.size() - 1;
 }
@@ -1540,6 +1715,7 @@ int SceneState::add_node_path(const NodePath &p_path) {
 }
 int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int p_instance, int p_index) {
 
+	_clear_program();
 	NodeData nd;
 	nd.parent = p_parent;
 	nd.owner = p_owner;
@@ -1558,6 +1734,8 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	ERR_FAIL_INDEX(p_name, names.size());
 	ERR_FAIL_INDEX(p_value, variants.size());
 
+	_clear_program();
+
 	NodeData::Property prop;
 	prop.name = p_name;
 	prop.value = p_value;
@@ -1572,6 +1750,7 @@ void SceneState::add_node_group(int p_node, int p_group) {
 void SceneState::set_base_scene(int p_idx) {
 
 	ERR_FAIL_INDEX(p_idx, variants.size());
+	_clear_program();
 	base_scene_idx = p_idx;
 }
 void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags, const Vector<int> &p_binds) {
@@ -1590,6 +1769,7 @@ void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method
 	c.flags = p_flags;
 	c.binds = p_binds;
 	connections.push_back(c);
+	_clear_program();
 }
 void SceneState::add_editable_instance(const NodePath &p_path) {
 
@@ -1641,6 +1821,14 @@ SceneState::SceneState() {
 
 	base_scene_idx = -1;
 	last_modified_time = 0;
+	program = NULL;
+	program_mutex = Mutex::create();
+}
+
+SceneState::~SceneState() {
+
+	_clear_program();
+	memdelete(program_mutex);
 }
 
 ////////////////
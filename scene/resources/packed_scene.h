@@ -31,6 +31,7 @@
 #ifndef PACKED_SCENE_H
 #define PACKED_SCENE_H
 
+#include "os/mutex.h"
 #include "resource.h"
 #include "scene/main/node.h"
 
@@ -92,6 +93,45 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
+	struct ProgramProperty {
+
+		int name;
+		int value;
+		MethodBind *setter; // NULL when the property has to go through Object::set()
+		int index; // for indexed properties, passed to the setter before the value
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+		Variant::Type ptr_type; // NIL when the setter can't be ptrcall()ed with the value
+		union {
+			bool _bool;
+			int64_t _int;
+			double _real;
+			real_t _mem[12]; // large enough for a Transform
+		} ptr_value;
+		String ptr_string;
+		NodePath ptr_node_path;
+#endif
+	};
+
+	struct ProgramNode {
+
+		Object *(*create)(); // NULL for instanced or inherited nodes and missing classes
+		Vector<ProgramProperty> properties; // only compiled when create is set
+	};
+
+	// the node table resolved for instancing without edit state, so classes and setters are only looked up once
+	struct Program {
+
+		Vector<ProgramNode> nodes;
+		Vector<Vector<Variant> > connection_binds;
+	};
+
+	mutable Program *program;
+	Mutex *program_mutex;
+
+	const Program *_get_program() const;
+	void _clear_program();
+	static void _set_program_property(Node *p_node, const ProgramProperty &p_property, const Variant &p_value);
+
 	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
@@ -190,6 +230,7 @@ public:
 	uint64_t get_last_modified_time() const { return last_modified_time; }
 
 	SceneState();
+	~SceneState();
 };
 
 VARIANT_ENUM_CAST(SceneState::GenEditState)
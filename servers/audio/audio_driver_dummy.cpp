@@ -107,6 +107,13 @@ void AudioDriverDummy::unlock() {
 	mutex->unlock();
 };
 
+void AudioDriverDummy::mix_audio(int p_frames, int32_t *p_buffer) {
+
+	lock();
+	audio_server_process(p_frames, p_buffer, false);
+	unlock();
+}
+
 void AudioDriverDummy::finish() {
 
 	if (!thread)
@@ -68,6 +68,8 @@ public:
 	virtual void unlock();
 	virtual void finish();
 
+	void mix_audio(int p_frames, int32_t *p_buffer);
+
 	AudioDriverDummy();
 	~AudioDriverDummy();
 };
@@ -0,0 +1,625 @@
+/*************************************************************************/
+/*  audio_mix_kernels.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "audio_mix_kernels.h"
+
+#include "core/error_macros.h"
+#include "core/math/math_funcs.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86)
+#if defined(__GNUC__) || defined(__clang__)
+// compiled for SSE2 even when the rest of the build is not, and only used if the CPU has it
+#define AUDIO_MIX_SSE2_ENABLED
+#define AUDIO_MIX_SSE2_FUNC __attribute__((target("sse2")))
+#elif defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_MIX_SSE2_ENABLED
+#define AUDIO_MIX_SSE2_FUNC
+#endif
+#endif
+
+#ifdef AUDIO_MIX_SSE2_ENABLED
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUDIO_MIX_NEON_ENABLED
+#include <arm_neon.h>
+#endif
+
+/* Portable versions, these are also the reference for the vectorized ones */
+
+static void _mix_scalar(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) {
+
+	for (int i = 0; i < p_frames; i++) {
+		p_dst[i] += p_src[i];
+	}
+}
+
+static void _mix_ramp_scalar(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, AudioFrame p_vol, AudioFrame p_vol_inc) {
+
+	for (int i = 0; i < p_frames; i++) {
+		p_dst[i] += p_src[i] * p_vol;
+		p_vol += p_vol_inc;
+	}
+}
+
+static void _scale_ramp_scalar(AudioFrame *p_buffer, int p_frames, float p_vol, float p_vol_inc) {
+
+	for (int i = 0; i < p_frames; i++) {
+		p_buffer[i] *= p_vol;
+		p_vol += p_vol_inc;
+	}
+}
+
+static void _scale_peak_scalar(AudioFrame *p_buffer, int p_frames, float p_vol, AudioFrame &r_peak) {
+
+	AudioFrame peak = AudioFrame(0, 0);
+
+	for (int i = 0; i < p_frames; i++) {
+
+		p_buffer[i] *= p_vol;
+
+		float l = ABS(p_buffer[i].l);
+		if (l > peak.l) {
+			peak.l = l;
+		}
+		float r = ABS(p_buffer[i].r);
+		if (r > peak.r) {
+			peak.r = r;
+		}
+	}
+
+	r_peak = peak;
+}
+
+static void _output_int32_scalar(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride) {
+
+	for (int i = 0; i < p_frames; i++) {
+
+		float l = CLAMP(p_src[i].l, -1.0, 1.0);
+		int32_t vl = l * ((1 << 20) - 1);
+		p_dst[0] = vl << 11;
+
+		float r = CLAMP(p_src[i].r, -1.0, 1.0);
+		int32_t vr = r * ((1 << 20) - 1);
+		p_dst[1] = vr << 11;
+
+		p_dst += p_dst_stride;
+	}
+}
+
+static void _resample_cubic_scalar(const AudioFrame *p_src, AudioFrame *p_dst, int p_frames, uint64_t &r_offset, uint64_t p_increment, int p_frac_bits) {
+
+	uint64_t offset = r_offset;
+	const uint64_t frac_mask = (uint64_t(1) << p_frac_bits) - 1;
+	const float frac_len = float(uint64_t(1) << p_frac_bits);
+
+	for (int i = 0; i < p_frames; i++) {
+
+		uint64_t idx = offset >> p_frac_bits;
+		//standard cubic interpolation (great quality/performance ratio)
+		float mu = (offset & frac_mask) / frac_len;
+		AudioFrame y0 = p_src[idx - 3];
+		AudioFrame y1 = p_src[idx - 2];
+		AudioFrame y2 = p_src[idx - 1];
+		AudioFrame y3 = p_src[idx - 0];
+
+		float mu2 = mu * mu;
+		AudioFrame a0 = y3 - y2 - y0 + y1;
+		AudioFrame a1 = y0 - y1 - a0;
+		AudioFrame a2 = y2 - y0;
+		AudioFrame a3 = y1;
+
+		p_dst[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+
+		offset += p_increment;
+	}
+
+	r_offset = offset;
+}
+
+template <class Depth>
+static void _resample_linear_scalar(const Depth *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo) {
+
+	int64_t offset = r_offset;
+	const int64_t frac_mask = (int64_t(1) << p_frac_bits) - 1;
+	// 8 bits samples are scaled to the 16 bits range
+	const int shift = sizeof(Depth) == 1 ? 8 : 0;
+
+	if (p_stereo) {
+
+		for (int i = 0; i < p_frames; i++) {
+
+			int64_t pos = (offset >> p_frac_bits) << 1;
+			int32_t frac = int32_t(offset & frac_mask);
+
+			int32_t final = int32_t(p_src[pos]) << shift;
+			int32_t final_r = int32_t(p_src[pos + 1]) << shift;
+			int32_t next = int32_t(p_src[pos + 2]) << shift;
+			int32_t next_r = int32_t(p_src[pos + 3]) << shift;
+
+			final = final + ((next - final) * frac >> p_frac_bits);
+			final_r = final_r + ((next_r - final_r) * frac >> p_frac_bits);
+
+			p_dst[i].l = final / 32767.0;
+			p_dst[i].r = final_r / 32767.0;
+
+			offset += p_increment;
+		}
+	} else {
+
+		for (int i = 0; i < p_frames; i++) {
+
+			int64_t pos = offset >> p_frac_bits;
+			int32_t frac = int32_t(offset & frac_mask);
+
+			int32_t final = int32_t(p_src[pos]) << shift;
+			int32_t next = int32_t(p_src[pos + 1]) << shift;
+
+			final = final + ((next - final) * frac >> p_frac_bits);
+
+			p_dst[i].l = final / 32767.0;
+			p_dst[i].r = p_dst[i].l;
+
+			offset += p_increment;
+		}
+	}
+
+	r_offset = offset;
+}
+
+/* SSE2, two stereo frames per vector */
+
+#ifdef AUDIO_MIX_SSE2_ENABLED
+
+AUDIO_MIX_SSE2_FUNC static void _mix_sse2(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) {
+
+	float *dst = (float *)p_dst;
+	const float *src = (const float *)p_src;
+	int count = p_frames * 2;
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128 a = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i));
+		__m128 b = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_loadu_ps(src + i + 4));
+		_mm_storeu_ps(dst + i, a);
+		_mm_storeu_ps(dst + i + 4, b);
+	}
+	for (; i < count; i++) {
+		dst[i] += src[i];
+	}
+}
+
+AUDIO_MIX_SSE2_FUNC static void _mix_ramp_sse2(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, AudioFrame p_vol, AudioFrame p_vol_inc) {
+
+	float *dst = (float *)p_dst;
+	const float *src = (const float *)p_src;
+
+	__m128 vol = _mm_setr_ps(p_vol.l, p_vol.r, p_vol.l + p_vol_inc.l, p_vol.r + p_vol_inc.r);
+	__m128 vol_inc = _mm_setr_ps(p_vol_inc.l * 2.0, p_vol_inc.r * 2.0, p_vol_inc.l * 2.0, p_vol_inc.r * 2.0);
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		__m128 d = _mm_loadu_ps(dst + i * 2);
+		__m128 s = _mm_loadu_ps(src + i * 2);
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(d, _mm_mul_ps(s, vol)));
+		vol = _mm_add_ps(vol, vol_inc);
+	}
+
+	if (i < p_frames) {
+		float last[4];
+		_mm_storeu_ps(last, vol);
+		p_dst[i] += p_src[i] * AudioFrame(last[0], last[1]);
+	}
+}
+
+AUDIO_MIX_SSE2_FUNC static void _scale_ramp_sse2(AudioFrame *p_buffer, int p_frames, float p_vol, float p_vol_inc) {
+
+	float *buf = (float *)p_buffer;
+
+	__m128 vol = _mm_setr_ps(p_vol, p_vol, p_vol + p_vol_inc, p_vol + p_vol_inc);
+	__m128 vol_inc = _mm_set1_ps(p_vol_inc * 2.0);
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		_mm_storeu_ps(buf + i * 2, _mm_mul_ps(_mm_loadu_ps(buf + i * 2), vol));
+		vol = _mm_add_ps(vol, vol_inc);
+	}
+
+	if (i < p_frames) {
+		float last[4];
+		_mm_storeu_ps(last, vol);
+		p_buffer[i] *= last[0];
+	}
+}
+
+AUDIO_MIX_SSE2_FUNC static void _scale_peak_sse2(AudioFrame *p_buffer, int p_frames, float p_vol, AudioFrame &r_peak) {
+
+	float *buf = (float *)p_buffer;
+
+	const __m128 vol = _mm_set1_ps(p_vol);
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 peak = _mm_setzero_ps();
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		__m128 v = _mm_mul_ps(_mm_loadu_ps(buf + i * 2), vol);
+		_mm_storeu_ps(buf + i * 2, v);
+		peak = _mm_max_ps(peak, _mm_and_ps(v, abs_mask));
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, peak);
+	AudioFrame result = AudioFrame(MAX(lanes[0], lanes[2]), MAX(lanes[1], lanes[3]));
+
+	if (i < p_frames) {
+		p_buffer[i] *= p_vol;
+		result.l = MAX(result.l, ABS(p_buffer[i].l));
+		result.r = MAX(result.r, ABS(p_buffer[i].r));
+	}
+
+	r_peak = result;
+}
+
+AUDIO_MIX_SSE2_FUNC static void _output_int32_sse2(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride) {
+
+	const float *src = (const float *)p_src;
+
+	const __m128 one = _mm_set1_ps(1.0);
+	const __m128 minus_one = _mm_set1_ps(-1.0);
+	const __m128 scale = _mm_set1_ps(float((1 << 20) - 1));
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+
+		__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 2), minus_one), one);
+		__m128i s = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(v, scale)), 11);
+
+		if (p_dst_stride == 2) {
+			_mm_storeu_si128((__m128i *)p_dst, s);
+		} else {
+			int32_t lanes[4];
+			_mm_storeu_si128((__m128i *)lanes, s);
+			p_dst[0] = lanes[0];
+			p_dst[1] = lanes[1];
+			p_dst[p_dst_stride + 0] = lanes[2];
+			p_dst[p_dst_stride + 1] = lanes[3];
+		}
+
+		p_dst += p_dst_stride * 2;
+	}
+
+	if (i < p_frames) {
+		_output_int32_scalar(p_src + i, p_dst, p_frames - i, p_dst_stride);
+	}
+}
+
+AUDIO_MIX_SSE2_FUNC static void _resample_cubic_sse2(const AudioFrame *p_src, AudioFrame *p_dst, int p_frames, uint64_t &r_offset, uint64_t p_increment, int p_frac_bits) {
+
+	uint64_t offset = r_offset;
+	const uint64_t frac_mask = (uint64_t(1) << p_frac_bits) - 1;
+	const float frac_scale = 1.0 / float(uint64_t(1) << p_frac_bits);
+	float *dst = (float *)p_dst;
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+
+		uint64_t offset_b = offset + p_increment;
+
+		// y0 to y3 are consecutive, so each frame is two unaligned loads
+		const float *a = (const float *)&p_src[(offset >> p_frac_bits) - 3];
+		const float *b = (const float *)&p_src[(offset_b >> p_frac_bits) - 3];
+		__m128 a01 = _mm_loadu_ps(a);
+		__m128 a23 = _mm_loadu_ps(a + 4);
+		__m128 b01 = _mm_loadu_ps(b);
+		__m128 b23 = _mm_loadu_ps(b + 4);
+
+		// regroup as (first frame l, r, second frame l, r) for each history point
+		__m128 y0 = _mm_movelh_ps(a01, b01);
+		__m128 y1 = _mm_movehl_ps(b01, a01);
+		__m128 y2 = _mm_movelh_ps(a23, b23);
+		__m128 y3 = _mm_movehl_ps(b23, a23);
+
+		float mu_a = (offset & frac_mask) * frac_scale;
+		float mu_b = (offset_b & frac_mask) * frac_scale;
+		__m128 mu = _mm_setr_ps(mu_a, mu_a, mu_b, mu_b);
+
+		__m128 a0 = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(y3, y2), y0), y1);
+		__m128 a1 = _mm_sub_ps(_mm_sub_ps(y0, y1), a0);
+		__m128 a2 = _mm_sub_ps(y2, y0);
+
+		__m128 res = _mm_add_ps(_mm_mul_ps(a0, mu), a1);
+		res = _mm_add_ps(_mm_mul_ps(res, mu), a2);
+		res = _mm_add_ps(_mm_mul_ps(res, mu), y1);
+
+		_mm_storeu_ps(dst + i * 2, res);
+
+		offset = offset_b + p_increment;
+	}
+
+	if (i < p_frames) {
+		_resample_cubic_scalar(p_src, p_dst + i, p_frames - i, offset, p_increment, p_frac_bits);
+	}
+
+	r_offset = offset;
+}
+
+template <class Depth>
+AUDIO_MIX_SSE2_FUNC static void _resample_linear_sse2(const Depth *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo) {
+
+	int64_t offset = r_offset;
+	const int64_t frac_mask = (int64_t(1) << p_frac_bits) - 1;
+	const __m128 frac_scale = _mm_set1_ps(1.0 / float(int64_t(1) << p_frac_bits));
+	// 8 bits samples are scaled to the 16 bits range
+	const __m128 sample_scale = _mm_set1_ps((sizeof(Depth) == 1 ? 256.0 : 1.0) / 32767.0);
+	float *dst = (float *)p_dst;
+
+	int i = 0;
+
+	if (p_stereo) {
+
+		// two frames per iteration, lanes are (l, r, l, r)
+		for (; i + 2 <= p_frames; i += 2) {
+
+			int64_t pos_a = (offset >> p_frac_bits) << 1;
+			int32_t frac_a = int32_t(offset & frac_mask);
+			offset += p_increment;
+			int64_t pos_b = (offset >> p_frac_bits) << 1;
+			int32_t frac_b = int32_t(offset & frac_mask);
+			offset += p_increment;
+
+			__m128 s0 = _mm_cvtepi32_ps(_mm_setr_epi32(p_src[pos_a], p_src[pos_a + 1], p_src[pos_b], p_src[pos_b + 1]));
+			__m128 s1 = _mm_cvtepi32_ps(_mm_setr_epi32(p_src[pos_a + 2], p_src[pos_a + 3], p_src[pos_b + 2], p_src[pos_b + 3]));
+			__m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(frac_a, frac_a, frac_b, frac_b)), frac_scale);
+
+			__m128 res = _mm_add_ps(s0, _mm_mul_ps(_mm_sub_ps(s1, s0), frac));
+			_mm_storeu_ps(dst + i * 2, _mm_mul_ps(res, sample_scale));
+		}
+	} else {
+
+		// four frames per iteration, then duplicated to both channels
+		for (; i + 4 <= p_frames; i += 4) {
+
+			int32_t s0[4], s1[4], f[4];
+			for (int j = 0; j < 4; j++) {
+				int64_t pos = offset >> p_frac_bits;
+				s0[j] = p_src[pos];
+				s1[j] = p_src[pos + 1];
+				f[j] = int32_t(offset & frac_mask);
+				offset += p_increment;
+			}
+
+			__m128 v0 = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)s0));
+			__m128 v1 = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)s1));
+			__m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)f)), frac_scale);
+
+			__m128 res = _mm_mul_ps(_mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), frac)), sample_scale);
+			_mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(res, res));
+			_mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(res, res));
+		}
+	}
+
+	if (i < p_frames) {
+		_resample_linear_scalar<Depth>(p_src, p_dst + i, p_frames - i, offset, p_increment, p_frac_bits, p_stereo);
+	}
+
+	r_offset = offset;
+}
+
+#endif // AUDIO_MIX_SSE2_ENABLED
+
+/* NEON, the accumulation kernels only, resampling uses the portable versions */
+
+#ifdef AUDIO_MIX_NEON_ENABLED
+
+static void _mix_neon(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) {
+
+	float *dst = (float *)p_dst;
+	const float *src = (const float *)p_src;
+	int count = p_frames * 2;
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+	}
+	for (; i < count; i++) {
+		dst[i] += src[i];
+	}
+}
+
+static void _mix_ramp_neon(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, AudioFrame p_vol, AudioFrame p_vol_inc) {
+
+	float *dst = (float *)p_dst;
+	const float *src = (const float *)p_src;
+
+	const float vol_init[4] = { p_vol.l, p_vol.r, p_vol.l + p_vol_inc.l, p_vol.r + p_vol_inc.r };
+	const float vol_inc_init[4] = { p_vol_inc.l * 2.0f, p_vol_inc.r * 2.0f, p_vol_inc.l * 2.0f, p_vol_inc.r * 2.0f };
+	float32x4_t vol = vld1q_f32(vol_init);
+	float32x4_t vol_inc = vld1q_f32(vol_inc_init);
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		vst1q_f32(dst + i * 2, vmlaq_f32(vld1q_f32(dst + i * 2), vld1q_f32(src + i * 2), vol));
+		vol = vaddq_f32(vol, vol_inc);
+	}
+
+	if (i < p_frames) {
+		p_dst[i] += p_src[i] * AudioFrame(vgetq_lane_f32(vol, 0), vgetq_lane_f32(vol, 1));
+	}
+}
+
+static void _scale_ramp_neon(AudioFrame *p_buffer, int p_frames, float p_vol, float p_vol_inc) {
+
+	float *buf = (float *)p_buffer;
+
+	const float vol_init[4] = { p_vol, p_vol, p_vol + p_vol_inc, p_vol + p_vol_inc };
+	float32x4_t vol = vld1q_f32(vol_init);
+	float32x4_t vol_inc = vdupq_n_f32(p_vol_inc * 2.0f);
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		vst1q_f32(buf + i * 2, vmulq_f32(vld1q_f32(buf + i * 2), vol));
+		vol = vaddq_f32(vol, vol_inc);
+	}
+
+	if (i < p_frames) {
+		p_buffer[i] *= vgetq_lane_f32(vol, 0);
+	}
+}
+
+static void _scale_peak_neon(AudioFrame *p_buffer, int p_frames, float p_vol, AudioFrame &r_peak) {
+
+	float *buf = (float *)p_buffer;
+
+	float32x4_t vol = vdupq_n_f32(p_vol);
+	float32x4_t peak = vdupq_n_f32(0);
+
+	int i = 0;
+	for (; i + 2 <= p_frames; i += 2) {
+		float32x4_t v = vmulq_f32(vld1q_f32(buf + i * 2), vol);
+		vst1q_f32(buf + i * 2, v);
+		peak = vmaxq_f32(peak, vabsq_f32(v));
+	}
+
+	AudioFrame result = AudioFrame(MAX(vgetq_lane_f32(peak, 0), vgetq_lane_f32(peak, 2)), MAX(vgetq_lane_f32(peak, 1), vgetq_lane_f32(peak, 3)));
+
+	if (i < p_frames) {
+		p_buffer[i] *= p_vol;
+		result.l = MAX(result.l, ABS(p_buffer[i].l));
+		result.r = MAX(result.r, ABS(p_buffer[i].r));
+	}
+
+	r_peak = result;
+}
+
+#endif // AUDIO_MIX_NEON_ENABLED
+
+/////////////////////////////////////////
+
+static const AudioMixKernels::Functions _scalar_functions = {
+	_mix_scalar,
+	_mix_ramp_scalar,
+	_scale_ramp_scalar,
+	_scale_peak_scalar,
+	_output_int32_scalar,
+	_resample_cubic_scalar,
+	_resample_linear_scalar<int8_t>,
+	_resample_linear_scalar<int16_t>,
+};
+
+AudioMixKernels::Functions AudioMixKernels::functions = _scalar_functions;
+AudioMixKernels::Implementation AudioMixKernels::implementation = AudioMixKernels::IMPLEMENTATION_SCALAR;
+
+bool AudioMixKernels::is_implementation_supported(Implementation p_implementation) {
+
+	switch (p_implementation) {
+		case IMPLEMENTATION_SCALAR: {
+			return true;
+		} break;
+		case IMPLEMENTATION_SSE2: {
+#if defined(AUDIO_MIX_SSE2_ENABLED)
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__i386__)
+			return __builtin_cpu_supports("sse2");
+#else
+			return true; // part of every x86_64 CPU
+#endif
+#endif
+		} break;
+		case IMPLEMENTATION_NEON: {
+#if defined(AUDIO_MIX_NEON_ENABLED)
+			return true;
+#endif
+		} break;
+		default: {
+		}
+	}
+
+	return false;
+}
+
+void AudioMixKernels::set_implementation(Implementation p_implementation) {
+
+	ERR_FAIL_INDEX(p_implementation, IMPLEMENTATION_MAX);
+	ERR_FAIL_COND(!is_implementation_supported(p_implementation));
+
+	functions = _scalar_functions;
+
+	switch (p_implementation) {
+		case IMPLEMENTATION_SSE2: {
+#ifdef AUDIO_MIX_SSE2_ENABLED
+			functions.mix = _mix_sse2;
+			functions.mix_ramp = _mix_ramp_sse2;
+			functions.scale_ramp = _scale_ramp_sse2;
+			functions.scale_peak = _scale_peak_sse2;
+			functions.output_int32 = _output_int32_sse2;
+			functions.resample_cubic = _resample_cubic_sse2;
+			functions.resample_linear_8 = _resample_linear_sse2<int8_t>;
+			functions.resample_linear_16 = _resample_linear_sse2<int16_t>;
+#endif
+		} break;
+		case IMPLEMENTATION_NEON: {
+#ifdef AUDIO_MIX_NEON_ENABLED
+			functions.mix = _mix_neon;
+			functions.mix_ramp = _mix_ramp_neon;
+			functions.scale_ramp = _scale_ramp_neon;
+			functions.scale_peak = _scale_peak_neon;
+#endif
+		} break;
+		default: {
+		}
+	}
+
+	implementation = p_implementation;
+}
+
+const char *AudioMixKernels::get_implementation_name(Implementation p_implementation) {
+
+	static const char *names[IMPLEMENTATION_MAX] = {
+		"Scalar",
+		"SSE2",
+		"NEON"
+	};
+
+	ERR_FAIL_INDEX_V(p_implementation, IMPLEMENTATION_MAX, "");
+	return names[p_implementation];
+}
+
+void AudioMixKernels::init() {
+
+	Implementation best = IMPLEMENTATION_SCALAR;
+	if (is_implementation_supported(IMPLEMENTATION_NEON)) {
+		best = IMPLEMENTATION_NEON;
+	} else if (is_implementation_supported(IMPLEMENTATION_SSE2)) {
+		best = IMPLEMENTATION_SSE2;
+	}
+
+	set_implementation(best);
+}
@@ -0,0 +1,100 @@
+/*************************************************************************/
+/*  audio_mix_kernels.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef AUDIO_MIX_KERNELS_H
+#define AUDIO_MIX_KERNELS_H
+
+#include "core/math/audio_frame.h"
+#include "core/os/copymem.h"
+
+/**
+ * Inner loops of the mixer: resampling, volume ramps, accumulation into bus
+ * channels and conversion to the driver format.
+ *
+ * Every kernel has a portable version and, where it pays off, SSE2 and NEON
+ * versions. init() picks the best implementation the running CPU supports, and
+ * set_implementation() switches at runtime (used to compare them).
+ * The vectorized versions may differ from the portable ones in the last bits,
+ * as they compute volume ramps and interpolation in a different order.
+ */
+class AudioMixKernels {
+public:
+	enum Implementation {
+		IMPLEMENTATION_SCALAR,
+		IMPLEMENTATION_SSE2,
+		IMPLEMENTATION_NEON,
+		IMPLEMENTATION_MAX
+	};
+
+	struct Functions {
+		// p_dst[i] += p_src[i]
+		void (*mix)(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames);
+		// p_dst[i] += p_src[i] * (p_vol + p_vol_inc * i)
+		void (*mix_ramp)(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, AudioFrame p_vol, AudioFrame p_vol_inc);
+		// p_buffer[i] *= p_vol + p_vol_inc * i
+		void (*scale_ramp)(AudioFrame *p_buffer, int p_frames, float p_vol, float p_vol_inc);
+		// p_buffer[i] *= p_vol, r_peak is the largest absolute value after scaling
+		void (*scale_peak)(AudioFrame *p_buffer, int p_frames, float p_vol, AudioFrame &r_peak);
+		// clamps to [-1, 1] and converts to left aligned 32 bits integers, p_dst advances p_dst_stride integers per frame
+		void (*output_int32)(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride);
+		// cubic interpolation, frame i reads p_src[(offset >> p_frac_bits) - 3] to p_src[offset >> p_frac_bits]
+		void (*resample_cubic)(const AudioFrame *p_src, AudioFrame *p_dst, int p_frames, uint64_t &r_offset, uint64_t p_increment, int p_frac_bits);
+		// linear interpolation of 8 and 16 bits PCM, interleaved when p_stereo, reads one frame past the position
+		void (*resample_linear_8)(const int8_t *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo);
+		void (*resample_linear_16)(const int16_t *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo);
+	};
+
+private:
+	static Functions functions;
+	static Implementation implementation;
+
+public:
+	static void init();
+
+	static bool is_implementation_supported(Implementation p_implementation);
+	static void set_implementation(Implementation p_implementation);
+	static Implementation get_implementation() { return implementation; }
+	static const char *get_implementation_name(Implementation p_implementation);
+
+	_FORCE_INLINE_ static void clear(AudioFrame *p_dst, int p_frames) { zeromem(p_dst, p_frames * sizeof(AudioFrame)); }
+	_FORCE_INLINE_ static void copy(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) { copymem(p_dst, p_src, p_frames * sizeof(AudioFrame)); }
+
+	_FORCE_INLINE_ static void mix(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) { functions.mix(p_dst, p_src, p_frames); }
+	_FORCE_INLINE_ static void mix_ramp(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, const AudioFrame &p_vol, const AudioFrame &p_vol_inc) { functions.mix_ramp(p_dst, p_src, p_frames, p_vol, p_vol_inc); }
+	_FORCE_INLINE_ static void scale_ramp(AudioFrame *p_buffer, int p_frames, float p_vol, float p_vol_inc) { functions.scale_ramp(p_buffer, p_frames, p_vol, p_vol_inc); }
+	_FORCE_INLINE_ static void scale_peak(AudioFrame *p_buffer, int p_frames, float p_vol, AudioFrame &r_peak) { functions.scale_peak(p_buffer, p_frames, p_vol, r_peak); }
+	_FORCE_INLINE_ static void output_int32(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride) { functions.output_int32(p_src, p_dst, p_frames, p_dst_stride); }
+	_FORCE_INLINE_ static void resample_cubic(const AudioFrame *p_src, AudioFrame *p_dst, int p_frames, uint64_t &r_offset, uint64_t p_increment, int p_frac_bits) { functions.resample_cubic(p_src, p_dst, p_frames, r_offset, p_increment, p_frac_bits); }
+	_FORCE_INLINE_ static void resample_linear(const int8_t *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo) { functions.resample_linear_8(p_src, p_dst, p_frames, r_offset, p_increment, p_frac_bits, p_stereo); }
+	_FORCE_INLINE_ static void resample_linear(const int16_t *p_src, AudioFrame *p_dst, int p_frames, int64_t &r_offset, int32_t p_increment, int p_frac_bits, bool p_stereo) { functions.resample_linear_16(p_src, p_dst, p_frames, r_offset, p_increment, p_frac_bits, p_stereo); }
+};
+
+#endif // AUDIO_MIX_KERNELS_H
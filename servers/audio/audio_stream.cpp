@@ -30,8 +30,21 @@
 
 #include "audio_stream.h"
 
+#include "audio_mix_kernels.h"
+
 //////////////////////////////
 
+void AudioStreamPlayback::skip(float p_rate_scale, int p_frames) {
+
+	//generic version, decodes and discards; streams that can move their position directly should override it
+	AudioFrame buffer[256];
+	while (p_frames > 0 && is_playing()) {
+		int todo = MIN(p_frames, 256);
+		mix(buffer, p_rate_scale, todo);
+		p_frames -= todo;
+	}
+}
+
 void AudioStreamPlaybackResampled::_begin_resample() {
 
 	//clear cubic interpolation history
@@ -50,26 +63,19 @@ void AudioStreamPlaybackResampled::mix(AudioFrame *p_buffer, float p_rate_scale,
 
 	uint64_t mix_increment = uint64_t(((get_stream_sampling_rate() * p_rate_scale) / double(target_rate)) * double(FP_LEN));
 
-	for (int i = 0; i < p_frames; i++) {
-
-		uint32_t idx = CUBIC_INTERP_HISTORY + uint32_t(mix_offset >> FP_BITS);
-		//standard cubic interpolation (great quality/performance ratio)
-		//this used to be moved to a LUT for greater performance, but nowadays CPU speed is generally faster than memory.
-		float mu = (mix_offset & FP_MASK) / float(FP_LEN);
-		AudioFrame y0 = internal_buffer[idx - 3];
-		AudioFrame y1 = internal_buffer[idx - 2];
-		AudioFrame y2 = internal_buffer[idx - 1];
-		AudioFrame y3 = internal_buffer[idx - 0];
+	int done = 0;
 
-		float mu2 = mu * mu;
-		AudioFrame a0 = y3 - y2 - y0 + y1;
-		AudioFrame a1 = y0 - y1 - a0;
-		AudioFrame a2 = y2 - y0;
-		AudioFrame a3 = y1;
+	while (done < p_frames) {
 
-		p_buffer[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+		// frames that can be interpolated before the position leaves the internal buffer
+		int todo = p_frames - done;
+		if (mix_increment > 0) {
+			uint64_t available = (uint64_t(INTERNAL_BUFFER_LEN) << FP_BITS) - mix_offset;
+			todo = MIN(uint64_t(todo), (available + mix_increment - 1) / mix_increment);
+		}
 
-		mix_offset += mix_increment;
+		AudioMixKernels::resample_cubic(internal_buffer + CUBIC_INTERP_HISTORY, p_buffer + done, todo, mix_offset, mix_increment, FP_BITS);
+		done += todo;
 
 		while ((mix_offset >> FP_BITS) >= INTERNAL_BUFFER_LEN) {
 
@@ -81,9 +87,7 @@ void AudioStreamPlaybackResampled::mix(AudioFrame *p_buffer, float p_rate_scale,
 				_mix_internal(internal_buffer + 4, INTERNAL_BUFFER_LEN);
 			} else {
 				//fill with silence, not playing
-				for (int i = 0; i < INTERNAL_BUFFER_LEN; ++i) {
-					internal_buffer[i + 4] = AudioFrame(0, 0);
-				}
+				AudioMixKernels::clear(internal_buffer + 4, INTERNAL_BUFFER_LEN);
 			}
 			mix_offset -= (INTERNAL_BUFFER_LEN << FP_BITS);
 		}
@@ -224,6 +228,12 @@ void AudioStreamPlaybackRandomPitch::mix(AudioFrame *p_buffer, float p_rate_scal
 	}
 }
 
+void AudioStreamPlaybackRandomPitch::skip(float p_rate_scale, int p_frames) {
+	if (playing.is_valid()) {
+		playing->skip(p_rate_scale * pitch_scale, p_frames);
+	}
+}
+
 AudioStreamPlaybackRandomPitch::~AudioStreamPlaybackRandomPitch() {
 	random_pitch->playbacks.erase(this);
 }
@@ -50,6 +50,7 @@ public:
 	virtual void seek(float p_time) = 0;
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) = 0;
+	virtual void skip(float p_rate_scale, int p_frames); //advance as mix() would, without producing audio
 };
 
 class AudioStreamPlaybackResampled : public AudioStreamPlayback {
@@ -143,6 +144,7 @@ public:
 	virtual void seek(float p_time);
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames);
+	virtual void skip(float p_rate_scale, int p_frames);
 
 	~AudioStreamPlaybackRandomPitch();
 };
@@ -0,0 +1,480 @@
+/*************************************************************************/
+/*  audio_stream_streamer.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "audio_stream_streamer.h"
+
+#include "safe_refcount.h"
+
+// the mixing and streamer threads share counters that only ever have one writer,
+// so ordered loads and stores can be done with atomic adds (which are full barriers)
+
+static _FORCE_INLINE_ uint32_t _atomic_load(uint32_t *p_value) {
+
+	return atomic_add(p_value, 0);
+}
+
+static _FORCE_INLINE_ void _atomic_store(uint32_t *p_value, uint32_t p_new) {
+
+	atomic_add(p_value, p_new - *p_value);
+}
+
+static _FORCE_INLINE_ uint64_t _atomic_load(uint64_t *p_value) {
+
+	return atomic_add(p_value, 0);
+}
+
+static _FORCE_INLINE_ void _atomic_store(uint64_t *p_value, uint64_t p_new) {
+
+	//plain 64 bits loads and stores can tear on 32 bits platforms
+	atomic_add(p_value, p_new - *p_value);
+}
+
+void AudioStreamPlaybackStreamed::_fill(uint32_t p_max_frames) {
+
+	fill_requested = false;
+
+	uint32_t request = _atomic_load(&seek_request);
+	if (request != seek_done) {
+		//the mixing thread stops reading until the seek is done, so the ring can be reset here
+		uint64_t frame = _atomic_load(&seek_frame);
+		ring_read = 0;
+		ring_write = 0;
+		ring_frames = 0;
+		stream_ended = 0;
+		decode_ended = false;
+		_stream_seek(frame);
+		_atomic_store(&seek_done, request);
+	}
+
+	if (decode_ended)
+		return;
+
+	uint32_t todo = MIN(p_max_frames, RING_LEN - _atomic_load(&ring_frames));
+	bool looped = false;
+
+	while (todo > 0) {
+
+		if (_atomic_load(&seek_request) != seek_done) {
+			break; //frames would be thrown away, seek first
+		}
+
+		uint32_t pos = ring_write & RING_MASK;
+		int decoded = _stream_decode(&ring[pos], MIN(todo, RING_LEN - pos));
+
+		if (decoded == 0) {
+			if (_stream_has_loop() && !looped) {
+				_stream_seek(_stream_get_loop_begin());
+				looped = true; //a stream that still decodes nothing after looping is empty
+				continue;
+			}
+			decode_ended = true;
+			_atomic_store(&stream_ended, 1);
+			break;
+		}
+
+		looped = false;
+		ring_write += decoded;
+		atomic_add(&ring_frames, decoded);
+		todo -= decoded;
+	}
+}
+
+void AudioStreamPlaybackStreamed::_request_seek(uint64_t p_frame) {
+
+	_atomic_store(&seek_frame, p_frame);
+	atomic_increment(&seek_request);
+	prefilled = false;
+	_request_fill();
+}
+
+void AudioStreamPlaybackStreamed::_request_fill() {
+
+	AudioStreamStreamer *streamer = AudioStreamStreamer::get_singleton();
+	if (!fill_requested && streamer && streamer->is_threaded()) {
+		fill_requested = true;
+		streamer->request_fill();
+	}
+}
+
+void AudioStreamPlaybackStreamed::_advance(uint64_t p_frames) {
+
+	frames_mixed += p_frames;
+
+	uint64_t length = _stream_get_length();
+	if (length == 0 || frames_mixed < length)
+		return;
+
+	uint64_t loop_begin = _stream_get_loop_begin();
+	if (_stream_has_loop() && loop_begin < length) {
+		loops += (frames_mixed - loop_begin) / (length - loop_begin);
+		frames_mixed = loop_begin + (frames_mixed - loop_begin) % (length - loop_begin);
+	} else {
+		frames_mixed = length;
+	}
+}
+
+void AudioStreamPlaybackStreamed::_stream_init() {
+
+	ERR_FAIL_COND(registered);
+
+	stream_rate = get_stream_sampling_rate();
+	_fill(PREFILL_LEN);
+	prefilled = true;
+
+	if (AudioStreamStreamer::get_singleton()) {
+		AudioStreamStreamer::get_singleton()->add_playback(this);
+		registered = true;
+		_request_fill();
+	}
+}
+
+void AudioStreamPlaybackStreamed::_stream_finish() {
+
+	if (registered && AudioStreamStreamer::get_singleton()) {
+		AudioStreamStreamer::get_singleton()->remove_playback(this);
+		registered = false;
+	}
+}
+
+bool AudioStreamPlaybackStreamed::_is_seeking() {
+
+	AudioStreamStreamer *streamer = AudioStreamStreamer::get_singleton();
+	if (!streamer || !streamer->is_threaded()) {
+		//no streamer thread on this platform, decode here
+		_fill(RING_LEN);
+	}
+
+	return _atomic_load(&seek_done) != seek_request;
+}
+
+void AudioStreamPlaybackStreamed::_mix_internal(AudioFrame *p_buffer, int p_frames) {
+
+	ERR_FAIL_COND(!active);
+
+	if (_is_seeking()) {
+		//still decoding from the new position
+		for (int i = 0; i < p_frames; i++) {
+			p_buffer[i] = AudioFrame(0, 0);
+		}
+		return;
+	}
+
+	prefilled = false;
+
+	//check for the end before the frames, all frames are in the ring once it's set
+	bool ended = _atomic_load(&stream_ended);
+	uint32_t available = _atomic_load(&ring_frames);
+	uint32_t todo = MIN(available, uint32_t(p_frames));
+
+	uint32_t pos = ring_read & RING_MASK;
+	uint32_t first = MIN(todo, RING_LEN - pos);
+	copymem(p_buffer, &ring[pos], first * sizeof(AudioFrame));
+	copymem(p_buffer + first, ring, (todo - first) * sizeof(AudioFrame));
+	ring_read += todo;
+	atomic_sub(&ring_frames, todo);
+
+	_advance(todo);
+
+	if (todo < uint32_t(p_frames)) {
+		for (int i = todo; i < p_frames; i++) {
+			p_buffer[i] = AudioFrame(0, 0);
+		}
+		if (ended) {
+			active = false;
+			return;
+		}
+		underruns++;
+	}
+
+	if (available - todo < REFILL_THRESHOLD) {
+		_request_fill();
+	}
+}
+
+void AudioStreamPlaybackStreamed::start(float p_from_pos) {
+
+	uint64_t frame = uint64_t(p_from_pos * stream_rate);
+	if (frame >= _stream_get_length()) {
+		frame = 0;
+	}
+
+	active = true;
+	loops = 0;
+	seek_pending = false;
+	frames_mixed = frame;
+	if (!(prefilled && frame == 0)) {
+		_request_seek(frame);
+	}
+	resample_pending = true;
+}
+
+void AudioStreamPlaybackStreamed::stop() {
+
+	active = false;
+}
+
+bool AudioStreamPlaybackStreamed::is_playing() const {
+
+	return active;
+}
+
+int AudioStreamPlaybackStreamed::get_loop_count() const {
+
+	return loops;
+}
+
+float AudioStreamPlaybackStreamed::get_playback_position() const {
+
+	return float(frames_mixed) / stream_rate;
+}
+
+void AudioStreamPlaybackStreamed::seek(float p_time) {
+
+	if (!active)
+		return;
+
+	uint64_t frame = uint64_t(p_time * stream_rate);
+	if (frame >= _stream_get_length()) {
+		frame = 0;
+	}
+
+	frames_mixed = frame;
+	seek_pending = false;
+	_request_seek(frame);
+}
+
+void AudioStreamPlaybackStreamed::skip(float p_rate_scale, int p_frames) {
+
+	if (!active)
+		return;
+
+	uint64_t frames = uint64_t(double(p_frames) * p_rate_scale * stream_rate / AudioServer::get_singleton()->get_mix_rate());
+
+	if (!seek_pending && _atomic_load(&seek_done) == seek_request) {
+		//consume what was already decoded, so the ring stays valid if the voice comes back soon
+		bool ended = _atomic_load(&stream_ended);
+		uint32_t available = _atomic_load(&ring_frames);
+		uint32_t todo = MIN(uint64_t(available), frames);
+		ring_read += todo;
+		atomic_sub(&ring_frames, todo);
+		prefilled = false;
+		_advance(todo);
+		frames -= todo;
+
+		if (frames == 0) {
+			_request_fill();
+			return;
+		}
+		if (ended) {
+			active = false;
+			return;
+		}
+	}
+
+	uint64_t length = _stream_get_length();
+	_advance(frames);
+	if (!_stream_has_loop() && length > 0 && frames_mixed >= length) {
+		active = false;
+		return;
+	}
+	seek_pending = true;
+}
+
+void AudioStreamPlaybackStreamed::mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
+
+	if (seek_pending) {
+		//skipped while virtual, refill only when audio is needed again
+		_request_seek(frames_mixed);
+		seek_pending = false;
+		resample_pending = true;
+	}
+
+	if (resample_pending) {
+		if (active && _is_seeking()) {
+			for (int i = 0; i < p_frames; i++) {
+				p_buffer[i] = AudioFrame(0, 0);
+			}
+			return;
+		}
+		resample_pending = false;
+		_begin_resample();
+	}
+
+	AudioStreamPlaybackResampled::mix(p_buffer, p_rate_scale, p_frames);
+}
+
+uint32_t AudioStreamPlaybackStreamed::get_underrun_count() const {
+
+	return underruns;
+}
+
+AudioStreamPlaybackStreamed::AudioStreamPlaybackStreamed() {
+
+	ring = memnew_arr(AudioFrame, RING_LEN);
+	ring_read = 0;
+	seek_request = 0;
+	active = false;
+	seek_pending = false;
+	resample_pending = false;
+	prefilled = false;
+	frames_mixed = 0;
+	loops = 0;
+	underruns = 0;
+	fill_requested = false;
+	ring_frames = 0;
+	seek_done = 0;
+	stream_ended = 0;
+	seek_frame = 0;
+	ring_write = 0;
+	decode_ended = false;
+	registered = false;
+	stream_rate = 1;
+}
+
+AudioStreamPlaybackStreamed::~AudioStreamPlaybackStreamed() {
+
+	_stream_finish();
+	memdelete_arr(ring);
+}
+
+//////////////////////////////
+
+AudioStreamStreamer *AudioStreamStreamer::singleton = NULL;
+
+void AudioStreamStreamer::_thread_func(void *p_userdata) {
+
+	AudioStreamStreamer *streamer = (AudioStreamStreamer *)p_userdata;
+
+	while (true) {
+
+		streamer->semaphore->wait();
+		if (streamer->exit_thread)
+			break;
+
+		//flushes requested after this pass started wait for the next one
+		uint32_t flushes = _atomic_load(&streamer->flush_requests);
+
+		streamer->mutex->lock();
+		for (Set<AudioStreamPlaybackStreamed *>::Element *E = streamer->playbacks.front(); E; E = E->next()) {
+			E->get()->_fill(AudioStreamPlaybackStreamed::RING_LEN);
+		}
+		streamer->mutex->unlock();
+
+		if (flushes) {
+			atomic_sub(&streamer->flush_requests, flushes);
+			for (uint32_t i = 0; i < flushes; i++) {
+				streamer->flush_semaphore->post();
+			}
+		}
+	}
+}
+
+void AudioStreamStreamer::add_playback(AudioStreamPlaybackStreamed *p_playback) {
+
+	if (!thread && semaphore && mutex) {
+		//started on demand, most projects never stream
+		Thread::Settings settings;
+		settings.priority = Thread::PRIORITY_HIGH;
+		thread = Thread::create(_thread_func, this, settings);
+	}
+
+	if (mutex) {
+		mutex->lock();
+	}
+	playbacks.insert(p_playback);
+	if (mutex) {
+		mutex->unlock();
+	}
+}
+
+void AudioStreamStreamer::remove_playback(AudioStreamPlaybackStreamed *p_playback) {
+
+	if (mutex) {
+		mutex->lock();
+	}
+	playbacks.erase(p_playback);
+	if (mutex) {
+		mutex->unlock();
+	}
+}
+
+AudioStreamStreamer *AudioStreamStreamer::get_singleton() {
+
+	return singleton;
+}
+
+Thread::ID AudioStreamStreamer::get_thread_id() const {
+
+	return thread ? thread->get_id() : Thread::ID(0);
+}
+
+void AudioStreamStreamer::flush() {
+
+	if (!thread)
+		return; //playbacks decode when mixed
+
+	atomic_increment(&flush_requests);
+	semaphore->post();
+	flush_semaphore->wait();
+}
+
+AudioStreamStreamer::AudioStreamStreamer() {
+
+	singleton = this;
+	thread = NULL;
+	exit_thread = false;
+	flush_requests = 0;
+	semaphore = Semaphore::create();
+	flush_semaphore = Semaphore::create();
+	mutex = Mutex::create();
+}
+
+AudioStreamStreamer::~AudioStreamStreamer() {
+
+	if (thread) {
+		exit_thread = true;
+		semaphore->post();
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+	}
+
+	if (semaphore) {
+		memdelete(semaphore);
+	}
+	if (flush_semaphore) {
+		memdelete(flush_semaphore);
+	}
+	if (mutex) {
+		memdelete(mutex);
+	}
+
+	singleton = NULL;
+}
@@ -0,0 +1,168 @@
+/*************************************************************************/
+/*  audio_stream_streamer.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef AUDIO_STREAM_STREAMER_H
+#define AUDIO_STREAM_STREAMER_H
+
+#include "os/mutex.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "servers/audio/audio_stream.h"
+#include "set.h"
+
+class AudioStreamStreamer;
+
+/**
+ * Base for playbacks that decode on the streamer thread instead of the mixing thread.
+ *
+ * Decoded frames are kept in a ring buffer ahead of the mix position. The mixing
+ * thread only copies frames out of the ring, and asks the streamer to refill it
+ * once it's half empty. Seeking throws away the ring and the playback is silent
+ * until the streamer decoded from the new position (starting or coming back from
+ * being virtual delays the sound instead of cutting its beginning).
+ *
+ * The _stream_*() methods are only called from the streamer thread, except while
+ * the playback is being created (before _stream_init() returns).
+ */
+
+class AudioStreamPlaybackStreamed : public AudioStreamPlaybackResampled {
+
+	GDCLASS(AudioStreamPlaybackStreamed, AudioStreamPlaybackResampled)
+
+	friend class AudioStreamStreamer;
+
+	enum {
+		RING_BITS = 14,
+		RING_LEN = 1 << RING_BITS,
+		RING_MASK = RING_LEN - 1,
+		REFILL_THRESHOLD = RING_LEN / 2,
+		PREFILL_LEN = 4096 //decoded when the playback is created, so playing from the start has no latency
+	};
+
+	AudioFrame *ring;
+
+	//mixing thread
+	uint32_t ring_read;
+	uint32_t seek_request;
+	bool active;
+	bool seek_pending;
+	bool resample_pending; //the resampler starts once the frames from the new position are decoded
+	bool prefilled; //ring holds the stream from the start and nothing was read yet
+	uint64_t frames_mixed;
+	int loops;
+	uint32_t underruns;
+	volatile bool fill_requested;
+
+	//shared, only modified with atomics
+	uint32_t ring_frames;
+	uint32_t seek_done;
+	uint32_t stream_ended;
+	uint64_t seek_frame;
+
+	//streamer thread
+	uint32_t ring_write;
+	bool decode_ended;
+
+	bool registered;
+	float stream_rate;
+
+	void _fill(uint32_t p_max_frames);
+	void _request_seek(uint64_t p_frame);
+	void _request_fill();
+	void _advance(uint64_t p_frames);
+	bool _is_seeking();
+
+protected:
+	virtual void _stream_seek(uint64_t p_frame) = 0;
+	virtual int _stream_decode(AudioFrame *p_buffer, int p_frames) = 0; //returns 0 once the stream ended
+
+	virtual uint64_t _stream_get_length() const = 0; //in frames
+	virtual bool _stream_has_loop() const = 0;
+	virtual uint64_t _stream_get_loop_begin() const = 0;
+
+	void _stream_init(); //call once the decoder is ready to decode from the start
+	void _stream_finish(); //call before destroying the decoder
+
+	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames);
+
+public:
+	virtual void start(float p_from_pos = 0.0);
+	virtual void stop();
+	virtual bool is_playing() const;
+
+	virtual int get_loop_count() const;
+
+	virtual float get_playback_position() const;
+	virtual void seek(float p_time);
+
+	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames);
+	virtual void skip(float p_rate_scale, int p_frames);
+
+	uint32_t get_underrun_count() const; //times the mixing thread ran out of decoded frames
+
+	AudioStreamPlaybackStreamed();
+	~AudioStreamPlaybackStreamed();
+};
+
+class AudioStreamStreamer {
+
+	static AudioStreamStreamer *singleton;
+
+	Thread *thread;
+	Semaphore *semaphore;
+	Semaphore *flush_semaphore;
+	Mutex *mutex;
+	volatile bool exit_thread;
+	uint32_t flush_requests;
+
+	Set<AudioStreamPlaybackStreamed *> playbacks;
+
+	static void _thread_func(void *p_userdata);
+
+	friend class AudioStreamPlaybackStreamed;
+
+	void add_playback(AudioStreamPlaybackStreamed *p_playback);
+	void remove_playback(AudioStreamPlaybackStreamed *p_playback);
+	_FORCE_INLINE_ void request_fill() { semaphore->post(); }
+
+public:
+	static AudioStreamStreamer *get_singleton();
+
+	_FORCE_INLINE_ bool is_threaded() const { return thread != NULL; }
+	Thread::ID get_thread_id() const;
+
+	void flush(); //waits until the streamer thread refilled every playback, so tests don't depend on timing
+
+	AudioStreamStreamer();
+	~AudioStreamStreamer();
+};
+
+#endif // AUDIO_STREAM_STREAMER_H
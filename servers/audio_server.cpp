@@ -29,11 +29,15 @@
 /*************************************************************************/
 
 #include "audio_server.h"
+#include "frame_profiler.h"
 #include "io/resource_loader.h"
 #include "os/file_access.h"
 #include "os/os.h"
 #include "project_settings.h"
+#include "sort.h"
 #include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/audio_stream_streamer.h"
 #include "servers/audio/effects/audio_effect_compressor.h"
 #ifdef TOOLS_ENABLED
 
@@ -192,17 +196,7 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 			if (master->channels[k].active) {
 
 				const AudioFrame *buf = master->channels[k].buffer.ptr();
-
-				for (int j = 0; j < to_copy; j++) {
-
-					float l = CLAMP(buf[from + j].l, -1.0, 1.0);
-					int32_t vl = l * ((1 << 20) - 1);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 0] = vl << 11;
-
-					float r = CLAMP(buf[from + j].r, -1.0, 1.0);
-					int32_t vr = r * ((1 << 20) - 1);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 1] = vr << 11;
-				}
+				AudioMixKernels::output_int32(&buf[from], &p_buffer[from_buf * (cs * 2) + k * 2], to_copy, cs * 2);
 
 			} else {
 				for (int j = 0; j < to_copy; j++) {
@@ -243,6 +237,8 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 
 void AudioServer::_mix_step() {
 
+	FRAME_PROFILE_SCOPE("audio/mix");
+
 	bool solo_mode = false;
 
 	for (int i = 0; i < buses.size(); i++) {
@@ -283,130 +279,371 @@ void AudioServer::_mix_step() {
 	}
 
 	//make callbacks for mixing the audio
-	for (Set<CallbackItem>::Element *E = callbacks.front(); E; E = E->next()) {
+	{
+		FRAME_PROFILE_SCOPE("audio/mix_callbacks");
+		for (Set<CallbackItem>::Element *E = callbacks.front(); E; E = E->next()) {
 
-		E->get().callback(E->get().userdata);
+			E->get().callback(E->get().userdata);
+		}
+
+		_mix_voices(solo_mode);
+	}
+
+	mix_solo_mode = solo_mode;
+
+	int bus_count = buses.size();
+	if (bus_levels.size() != bus_count) {
+		bus_sends.resize(bus_count);
+		bus_levels.resize(bus_count);
+	}
+	if (bus_tasks.size() < bus_count * get_channel_count()) {
+		bus_tasks.resize(bus_count * get_channel_count());
 	}
 
-	for (int i = buses.size() - 1; i >= 0; i--) {
-		//go bus by bus
+	int *sends = bus_sends.ptr();
+	int *levels = bus_levels.ptr();
+	BusChannelTask *tasks = bus_tasks.ptr();
+
+	for (int i = 0; i < bus_count; i++) {
+
 		Bus *bus = buses[i];
+		int send = -1;
 
-		for (int k = 0; k < bus->channels.size(); k++) {
+		if (i > 0) {
+			//everything has a send save for master bus
+			const Map<StringName, Bus *>::Element *E = bus_map.find(bus->send);
+			if (!E || E->get()->index_cache >= bus->index_cache) { //invalid, send to master
+				send = 0;
+			} else {
+				send = E->get()->index_cache;
+			}
+		}
+
+		sends[i] = send;
+	}
+
+	//without effect threads, or with sidechain reads the levels can't reproduce, mix like serial mixing always did
+	if (effect_pool.get_thread_count() == 0 || !_schedule_bus_levels(sends, levels)) {
+
+		for (int i = bus_count - 1; i >= 0; i--) {
 
-			if (bus->channels[k].active && !bus->channels[k].used) {
-				//buffer was not used, but it's still active, so it must be cleaned
-				AudioFrame *buf = bus->channels[k].buffer.ptrw();
+			Bus *bus = buses[i];
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
+			for (int k = 0; k < bus->channels.size(); k++) {
 
-					buf[j] = AudioFrame(0, 0);
+				if (!bus->channels[k].active)
+					continue;
+
+				tasks[0].bus = bus;
+				tasks[0].channel = k;
+				_process_bus_channel(0, tasks);
+
+				if (i > 0 && bus->channels[k].active) {
+					AudioFrame *target_buf = thread_get_channel_mix_buffer(sends[i], k);
+					AudioMixKernels::mix(target_buf, bus->channels[k].buffer.ptr(), buffer_size);
 				}
 			}
 		}
 
-		//process effects
-		if (!bus->bypass) {
-			for (int j = 0; j < bus->effects.size(); j++) {
+		mix_frames += buffer_size;
+		to_mix = buffer_size;
+		return;
+	}
+
+	int level_count = levels[0] + 1;
 
-				if (!bus->effects[j].enabled)
+	for (int level = 0; level < level_count; level++) {
+
+		//mix the sends into this level, every target gets them in the order the buses are listed (last first), like serial mixing did
+		if (level > 0) {
+			for (int i = bus_count - 1; i > 0; i--) {
+
+				if (levels[sends[i]] != level)
 					continue;
 
+				Bus *bus = buses[i];
+
 				for (int k = 0; k < bus->channels.size(); k++) {
 
 					if (!bus->channels[k].active)
 						continue;
-					bus->channels[k].effect_instances[j]->process(bus->channels[k].buffer.ptr(), temp_buffer[k].ptrw(), buffer_size);
-				}
-
-				//swap buffers, so internal buffer always has the right data
-				for (int k = 0; k < bus->channels.size(); k++) {
 
-					if (!buses[i]->channels[k].active)
-						continue;
-					SWAP(bus->channels[k].buffer, temp_buffer[k]);
+					AudioFrame *target_buf = thread_get_channel_mix_buffer(sends[i], k);
+					AudioMixKernels::mix(target_buf, bus->channels[k].buffer.ptr(), buffer_size);
 				}
 			}
 		}
 
-		//process send
+		int task_count = 0;
+		int effect_task_count = 0;
 
-		Bus *send = NULL;
+		for (int i = bus_count - 1; i >= 0; i--) {
 
-		if (i > 0) {
-			//everything has a send save for master bus
-			if (!bus_map.has(bus->send)) {
-				send = buses[0];
-			} else {
-				send = bus_map[bus->send];
-				if (send->index_cache >= bus->index_cache) { //invalid, send to master
-					send = buses[0];
+			if (levels[i] != level)
+				continue;
+
+			Bus *bus = buses[i];
+			bool has_effects = !bus->bypass && bus->effects.size() > 0;
+			//effects reading other buses (compressor sidechain) run here, before the rest of the level is processed
+			bool serial = has_effects && _bus_effects_read_buses(bus);
+
+			for (int k = 0; k < bus->channels.size(); k++) {
+
+				if (!bus->channels[k].active)
+					continue;
+
+				tasks[task_count].bus = bus;
+				tasks[task_count].channel = k;
+
+				if (serial) {
+					_process_bus_channel(task_count, tasks);
+				} else {
+					task_count++;
+					if (has_effects) {
+						effect_task_count++;
+					}
 				}
 			}
 		}
 
-		for (int k = 0; k < bus->channels.size(); k++) {
+		//waking up the workers only pays off if several channels have effects to process
+		if (effect_task_count > 1 && effect_pool.get_thread_count() > 0) {
+			effect_pool.do_work(task_count, this, &AudioServer::_process_bus_channel, tasks);
+		} else {
+			for (int j = 0; j < task_count; j++) {
+				_process_bus_channel(j, tasks);
+			}
+		}
+	}
 
-			if (!bus->channels[k].active)
-				continue;
+	mix_frames += buffer_size;
+	to_mix = buffer_size;
+}
 
-			AudioFrame *buf = bus->channels[k].buffer.ptrw();
+bool AudioServer::_schedule_bus_levels(const int *p_sends, int *r_levels) {
 
-			AudioFrame peak = AudioFrame(0, 0);
+	int bus_count = buses.size();
+	for (int i = 0; i < bus_count; i++) {
+		r_levels[i] = 0;
+	}
 
-			float volume = Math::db2linear(bus->volume_db);
+	//sends only go to buses before them, so a bus is one level after the deepest bus sending to it,
+	//and all chains end in master, which is always the last level. sidechain reads can raise buses
+	//that were already visited, so walk the list again until nothing moves.
+	bool changed = true;
+	while (changed) {
 
-			if (solo_mode) {
-				if (!bus->soloed) {
-					volume = 0.0;
-				}
-			} else {
-				if (bus->mute) {
-					volume = 0.0;
-				}
+		changed = false;
+		for (int i = bus_count - 1; i >= 0; i--) {
+
+			if (!_schedule_bus_reads(i, p_sends, r_levels, changed))
+				return false;
+
+			if (i > 0 && r_levels[p_sends[i]] < r_levels[i] + 1) {
+				r_levels[p_sends[i]] = r_levels[i] + 1;
+				changed = true;
 			}
 
-			//apply volume and compute peak
-			for (uint32_t j = 0; j < buffer_size; j++) {
+			//no valid schedule needs more levels than buses, buses reading each other end up here
+			if (r_levels[i] >= bus_count)
+				return false;
+		}
+	}
 
-				buf[j] *= volume;
+	return true;
+}
 
-				float l = ABS(buf[j].l);
-				if (l > peak.l) {
-					peak.l = l;
-				}
-				float r = ABS(buf[j].r);
-				if (r > peak.r) {
-					peak.r = r;
-				}
-			}
+bool AudioServer::_schedule_bus_reads(int p_bus, const int *p_sends, int *r_levels, bool &r_changed) {
+
+	const Bus *bus = buses[p_bus];
+	if (bus->bypass)
+		return true;
 
-			bus->channels[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+	//keep what serial mixing let the compressor see. a bus listed later was already processed, so it
+	//goes in an earlier level. a bus listed earlier was not, but it already had the sends of every bus
+	//listed after the reader: the reader shares its level and runs once those sends are mixed in.
+	for (int i = 0; i < bus->effects.size(); i++) {
 
-			if (!bus->channels[k].used) {
-				//see if any audio is contained, because channel was not used
+		if (!bus->effects[i].enabled)
+			continue;
 
-				if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
-					bus->channels[k].last_mix_with_audio = mix_frames;
-				} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
-					bus->channels[k].active = false;
-					continue; //went inactive, don't mix.
-				}
+		const AudioEffectCompressor *compressor = Object::cast_to<AudioEffectCompressor>(*bus->effects[i].effect);
+		if (!compressor || compressor->get_sidechain() == StringName())
+			continue;
+
+		const Map<StringName, Bus *>::Element *E = bus_map.find(compressor->get_sidechain());
+		if (!E)
+			continue;
+
+		int read = E->get()->index_cache;
+		if (read > p_bus) {
+			if (r_levels[p_bus] < r_levels[read] + 1) {
+				r_levels[p_bus] = r_levels[read] + 1;
+				r_changed = true;
 			}
+		} else if (read < p_bus) {
 
-			if (send) {
-				//if not master bus, send
-				AudioFrame *target_buf = thread_get_channel_mix_buffer(send->index_cache, k);
+			//sends from the buses in between were mixed after the read, levels can't split them from the others
+			for (int j = read + 1; j < p_bus; j++) {
+				if (p_sends[j] == read)
+					return false;
+			}
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					target_buf[j] += buf[j];
-				}
+			int level = MAX(r_levels[p_bus], r_levels[read]);
+			if (r_levels[p_bus] != level || r_levels[read] != level) {
+				r_levels[p_bus] = level;
+				r_levels[read] = level;
+				r_changed = true;
 			}
 		}
 	}
 
-	mix_frames += buffer_size;
-	to_mix = buffer_size;
+	return true;
+}
+
+bool AudioServer::_bus_effects_read_buses(const Bus *p_bus) {
+
+	for (int i = 0; i < p_bus->effects.size(); i++) {
+
+		if (!p_bus->effects[i].enabled)
+			continue;
+
+		const AudioEffectCompressor *compressor = Object::cast_to<AudioEffectCompressor>(*p_bus->effects[i].effect);
+		if (compressor && compressor->get_sidechain() != StringName()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void AudioServer::_process_bus_channel(uint32_t p_index, BusChannelTask *p_tasks) {
+
+	Bus *bus = p_tasks[p_index].bus;
+	Bus::Channel &channel = bus->channels[p_tasks[p_index].channel];
+
+	if (!channel.used) {
+		//buffer was not used, but it's still active, so it must be cleaned
+		AudioMixKernels::clear(channel.buffer.ptrw(), buffer_size);
+	}
+
+	//process effects
+	if (!bus->bypass && bus->effects.size()) {
+		FRAME_PROFILE_SCOPE("audio/bus_effects");
+		for (int j = 0; j < bus->effects.size(); j++) {
+
+			if (!bus->effects[j].enabled)
+				continue;
+
+			channel.effect_instances[j]->process(channel.buffer.ptr(), channel.effect_buffer.ptrw(), buffer_size);
+
+			//swap buffers, so internal buffer always has the right data
+			SWAP(channel.buffer, channel.effect_buffer);
+		}
+	}
+
+	AudioFrame *buf = channel.buffer.ptrw();
+
+	AudioFrame peak = AudioFrame(0, 0);
+
+	float volume = Math::db2linear(bus->volume_db);
+
+	if (mix_solo_mode) {
+		if (!bus->soloed) {
+			volume = 0.0;
+		}
+	} else {
+		if (bus->mute) {
+			volume = 0.0;
+		}
+	}
+
+	//apply volume and compute peak
+	AudioMixKernels::scale_peak(buf, buffer_size, volume, peak);
+
+	channel.peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+
+	if (!channel.used) {
+		//see if any audio is contained, because channel was not used
+
+		if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
+			channel.last_mix_with_audio = mix_frames;
+		} else if (mix_frames - channel.last_mix_with_audio > channel_disable_frames) {
+			channel.active = false; //went inactive, don't send.
+		}
+	}
+}
+
+void AudioServer::_mix_voices(bool p_solo_mode) {
+
+	if (bus_gains.size() != buses.size()) {
+		bus_gains.resize(buses.size());
+	}
+
+	//gain of each bus all the way to the master, sends only go to buses before them
+	for (int i = 0; i < buses.size(); i++) {
+
+		Bus *bus = buses[i];
+		float gain = 0;
+		if (!bus->mute && (!p_solo_mode || bus->soloed)) {
+			gain = Math::db2linear(bus->volume_db);
+			if (i > 0) {
+				const Map<StringName, Bus *>::Element *E = bus_map.find(bus->send);
+				int send = E && E->get()->index_cache < i ? E->get()->index_cache : 0;
+				gain *= bus_gains[send];
+			}
+		}
+		bus_gains[i] = gain;
+	}
+
+	//inaudible voices are always virtual, the rest are real up to max_voices, by priority then audibility
+	Voice **sorted = voice_sort_buffer.ptr();
+	int audible_count = 0;
+	int playing_count = 0;
+
+	for (int i = 0; i < voices.size(); i++) {
+
+		Voice *voice = voices[i];
+		voice->was_virtual = voice->is_virtual;
+		voice->is_virtual = false;
+
+		if (!voice->playing)
+			continue;
+
+		playing_count++;
+
+		int bus_index = voice->bus_index >= 0 && voice->bus_index < buses.size() ? voice->bus_index : 0;
+		voice->audibility = voice->volume * bus_gains[bus_index];
+
+		if (voice->audibility < voice_virtual_threshold) {
+			voice->is_virtual = true;
+		} else {
+			sorted[audible_count++] = voice;
+		}
+	}
+
+	if (max_voices > 0 && audible_count > max_voices) {
+
+		SortArray<Voice *, VoiceSort> sorter;
+		sorter.nth_element(0, audible_count, max_voices, sorted);
+		for (int i = max_voices; i < audible_count; i++) {
+			sorted[i]->is_virtual = true;
+		}
+		audible_count = max_voices;
+	}
+
+	real_voice_count = audible_count;
+	virtual_voice_count = playing_count - audible_count;
+
+	for (int i = 0; i < voices.size(); i++) {
+
+		Voice *voice = voices[i];
+		if (voice->is_virtual) {
+			voice->skip_callback(voice->userdata);
+		} else {
+			voice->mix_callback(voice->userdata);
+		}
+	}
 }
 
 AudioFrame *AudioServer::thread_get_channel_mix_buffer(int p_bus, int p_buffer) {
@@ -420,9 +657,7 @@ AudioFrame *AudioServer::thread_get_channel_mix_buffer(int p_bus, int p_buffer)
 		buses[p_bus]->channels[p_buffer].used = true;
 		buses[p_bus]->channels[p_buffer].active = true;
 		buses[p_bus]->channels[p_buffer].last_mix_with_audio = mix_frames;
-		for (uint32_t i = 0; i < buffer_size; i++) {
-			data[i] = AudioFrame(0, 0);
-		}
+		AudioMixKernels::clear(data, buffer_size);
 	}
 
 	return data;
@@ -488,6 +723,7 @@ void AudioServer::set_bus_count(int p_count) {
 		buses[i]->channels.resize(get_channel_count());
 		for (int j = 0; j < get_channel_count(); j++) {
 			buses[i]->channels[j].buffer.resize(buffer_size);
+			buses[i]->channels[j].effect_buffer.resize(buffer_size);
 		}
 		buses[i]->name = attempt;
 		buses[i]->solo = false;
@@ -558,6 +794,7 @@ void AudioServer::add_bus(int p_at_pos) {
 	bus->channels.resize(get_channel_count());
 	for (int j = 0; j < get_channel_count(); j++) {
 		bus->channels[j].buffer.resize(buffer_size);
+		bus->channels[j].effect_buffer.resize(buffer_size);
 	}
 	bus->name = attempt;
 	bus->solo = false;
@@ -860,11 +1097,24 @@ void AudioServer::init() {
 	channel_disable_frames = float(GLOBAL_DEF("audio/channel_disable_time", 2.0)) * get_mix_rate();
 	buffer_size = 1024; //hardcoded for now
 
-	temp_buffer.resize(get_channel_count());
+	max_voices = GLOBAL_DEF("audio/max_voices", 128);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/max_voices", PropertyInfo(Variant::INT, "audio/max_voices", PROPERTY_HINT_RANGE, "0,4096,1"));
+	voice_virtual_threshold = Math::db2linear(float(GLOBAL_DEF("audio/voice_virtual_threshold_db", -60.0)));
+
+	AudioMixKernels::init();
+	if (OS::get_singleton()->is_stdout_verbose()) {
+		print_line("AudioServer: using " + String(AudioMixKernels::get_implementation_name(AudioMixKernels::get_implementation())) + " mixing kernels.");
+	}
 
-	for (int i = 0; i < temp_buffer.size(); i++) {
-		temp_buffer[i].resize(buffer_size);
+	bus_effect_threads = GLOBAL_DEF("audio/bus_effect_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/bus_effect_threads", PropertyInfo(Variant::INT, "audio/bus_effect_threads", PROPERTY_HINT_RANGE, "-1,16,1"));
+	if (bus_effect_threads < 0) {
+		//automatic, a few cores are plenty for the effects of most projects
+		bus_effect_threads = CLAMP(OS::get_singleton()->get_processor_count() - 1, 0, 4);
 	}
+	effect_pool.init(bus_effect_threads, Thread::PRIORITY_HIGH);
+
+	stream_streamer = memnew(AudioStreamStreamer);
 
 	mix_count = 0;
 	set_bus_count(1);
@@ -896,6 +1146,13 @@ void AudioServer::finish() {
 		AudioDriverManager::get_driver(i)->finish();
 	}
 
+	effect_pool.finish();
+
+	if (stream_streamer) {
+		memdelete(stream_streamer);
+		stream_streamer = NULL;
+	}
+
 	for (int i = 0; i < buses.size(); i++) {
 		memdelete(buses[i]);
 	}
@@ -1006,6 +1263,52 @@ void AudioServer::remove_callback(AudioCallback p_callback, void *p_userdata) {
 	unlock();
 }
 
+void AudioServer::add_voice(Voice *p_voice) {
+
+	ERR_FAIL_COND(!p_voice->mix_callback || !p_voice->skip_callback);
+
+	lock();
+	p_voice->is_virtual = false;
+	p_voice->was_virtual = false;
+	voices.push_back(p_voice);
+	voice_sort_buffer.resize(voices.size());
+	unlock();
+}
+
+void AudioServer::remove_voice(Voice *p_voice) {
+
+	lock();
+	voices.erase(p_voice);
+	voice_sort_buffer.resize(voices.size());
+	unlock();
+}
+
+int AudioServer::get_real_voice_count() const {
+
+	return real_voice_count;
+}
+
+int AudioServer::get_virtual_voice_count() const {
+
+	return virtual_voice_count;
+}
+
+void AudioServer::set_bus_effect_thread_count(int p_threads) {
+
+	ERR_FAIL_COND(p_threads < 0);
+
+	lock();
+	effect_pool.finish();
+	bus_effect_threads = p_threads;
+	effect_pool.init(bus_effect_threads, Thread::PRIORITY_HIGH);
+	unlock();
+}
+
+int AudioServer::get_bus_effect_thread_count() const {
+
+	return bus_effect_threads;
+}
+
 void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 
 	ERR_FAIL_COND(p_bus_layout.is_null() || p_bus_layout->buses.size() == 0);
@@ -1049,6 +1352,7 @@ void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 		buses[i]->channels.resize(get_channel_count());
 		for (int j = 0; j < get_channel_count(); j++) {
 			buses[i]->channels[j].buffer.resize(buffer_size);
+			buses[i]->channels[j].effect_buffer.resize(buffer_size);
 		}
 		_update_bus_effects(i);
 	}
@@ -1149,6 +1453,13 @@ AudioServer::AudioServer() {
 	audio_data_lock = Mutex::create();
 	mix_frames = 0;
 	to_mix = 0;
+	max_voices = 0;
+	voice_virtual_threshold = 0;
+	real_voice_count = 0;
+	virtual_voice_count = 0;
+	mix_solo_mode = false;
+	bus_effect_threads = 0;
+	stream_streamer = NULL;
 }
 
 AudioServer::~AudioServer() {
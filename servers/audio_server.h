@@ -32,11 +32,14 @@
 #define AUDIO_SERVER_H
 
 #include "audio_frame.h"
+#include "local_vector.h"
 #include "object.h"
+#include "os/thread_work_pool.h"
 #include "servers/audio/audio_effect.h"
 #include "variant.h"
 
 class AudioDriverDummy;
+class AudioStreamStreamer;
 
 class AudioDriver {
 
@@ -122,6 +125,40 @@ public:
 
 	typedef void (*AudioCallback)(void *p_userdata);
 
+	// A playing stream, which the server mixes for real or virtualizes
+	// (only advancing its playback position) when it can't be heard or
+	// there are more than audio/max_voices voices playing.
+	struct Voice {
+
+		AudioCallback mix_callback; //decode and mix into the buses
+		AudioCallback skip_callback; //advance the playback without mixing
+		void *userdata;
+
+		//set by the owner
+		int priority;
+		float volume; //linear, before the bus volumes
+		int bus_index;
+		bool playing;
+
+		//set by the server before calling either callback
+		bool is_virtual;
+		bool was_virtual; //state in the previous mix step
+		float audibility;
+
+		Voice() {
+			mix_callback = NULL;
+			skip_callback = NULL;
+			userdata = NULL;
+			priority = 0;
+			volume = 1.0;
+			bus_index = 0;
+			playing = false;
+			is_virtual = false;
+			was_virtual = false;
+			audibility = 0;
+		}
+	};
+
 private:
 	uint32_t buffer_size;
 	uint64_t mix_count;
@@ -147,6 +184,7 @@ private:
 			bool active;
 			AudioFrame peak_volume;
 			Vector<AudioFrame> buffer;
+			Vector<AudioFrame> effect_buffer; //effects write here, then it's swapped with buffer
 			Vector<Ref<AudioEffectInstance> > effect_instances;
 			uint64_t last_mix_with_audio;
 			Channel() {
@@ -170,12 +208,32 @@ private:
 		int index_cache;
 	};
 
-	Vector<Vector<AudioFrame> > temp_buffer; //temp_buffer for each level
 	Vector<Bus *> buses;
 	Map<StringName, Bus *> bus_map;
 
 	void _update_bus_effects(int p_bus);
 
+	struct BusChannelTask {
+		Bus *bus;
+		int channel;
+	};
+
+	//buses are processed in levels, all buses in a level only send to (or are read by) later levels
+	LocalVector<int> bus_sends;
+	LocalVector<int> bus_levels;
+	LocalVector<BusChannelTask> bus_tasks;
+	bool mix_solo_mode;
+
+	ThreadWorkPool effect_pool;
+	int bus_effect_threads;
+
+	AudioStreamStreamer *stream_streamer;
+
+	bool _schedule_bus_levels(const int *p_sends, int *r_levels);
+	bool _schedule_bus_reads(int p_bus, const int *p_sends, int *r_levels, bool &r_changed);
+	static bool _bus_effects_read_buses(const Bus *p_bus);
+	void _process_bus_channel(uint32_t p_index, BusChannelTask *p_tasks);
+
 	static AudioServer *singleton;
 
 	// TODO create an audiodata pool to optimize memory
@@ -200,6 +258,23 @@ private:
 
 	Set<CallbackItem> callbacks;
 
+	struct VoiceSort {
+
+		_FORCE_INLINE_ bool operator()(const Voice *p_a, const Voice *p_b) const {
+			return p_a->priority == p_b->priority ? p_a->audibility > p_b->audibility : p_a->priority > p_b->priority;
+		}
+	};
+
+	LocalVector<Voice *> voices;
+	LocalVector<Voice *> voice_sort_buffer;
+	LocalVector<float> bus_gains;
+	int max_voices;
+	float voice_virtual_threshold;
+	int real_voice_count;
+	int virtual_voice_count;
+
+	void _mix_voices(bool p_solo_mode);
+
 	friend class AudioDriver;
 	void _driver_process(int p_frames, int32_t *p_buffer);
 
@@ -294,6 +369,16 @@ public:
 	void add_callback(AudioCallback p_callback, void *p_userdata);
 	void remove_callback(AudioCallback p_callback, void *p_userdata);
 
+	void add_voice(Voice *p_voice);
+	void remove_voice(Voice *p_voice);
+
+	int get_real_voice_count() const;
+	int get_virtual_voice_count() const;
+
+	// worker threads used to process bus effects, 0 processes them all in the mixing thread
+	void set_bus_effect_thread_count(int p_threads);
+	int get_bus_effect_thread_count() const;
+
 	void set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout);
 	Ref<AudioBusLayout> generate_bus_layout() const;
 
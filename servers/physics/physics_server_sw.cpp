@@ -32,6 +32,7 @@
 
 #include "broad_phase_basic.h"
 #include "broad_phase_octree.h"
+#include "frame_profiler.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
 #include "joints/hinge_joint_sw.h"
@@ -1365,6 +1366,8 @@ void PhysicsServerSW::step(real_t p_step) {
 	if (!active)
 		return;
 
+	FRAME_PROFILE_SCOPE("physics/step");
+
 	_update_shapes();
 
 	doing_sync = false;
@@ -1393,6 +1396,8 @@ void PhysicsServerSW::flush_queries() {
 	if (!active)
 		return;
 
+	FRAME_PROFILE_SCOPE("physics/flush_queries");
+
 	doing_sync = true;
 
 	uint64_t time_beg = OS::get_singleton()->get_ticks_usec();
@@ -32,7 +32,6 @@
 
 #include "geometry.h"
 #include "quick_hull.h"
-#include "sort.h"
 
 #define _POINT_SNAP 0.001953125
 #define _EDGE_IS_VALID_SUPPORT_THRESHOLD 0.0002
@@ -1183,56 +1182,39 @@ Vector3 ConcavePolygonShapeSW::get_support(const Vector3 &p_normal) const {
 	return vptr[vert_support_idx];
 }
 
-void ConcavePolygonShapeSW::_cull_segment(int p_idx, _SegmentCullParams *p_params) const {
+bool ConcavePolygonShapeSW::_SegmentCullParams::operator()(uint32_t p_index, real_t &r_max_t) {
 
-	const BVH *bvh = &p_params->bvh[p_idx];
-
-	/*
-	if (p_params->dir.dot(bvh->aabb.get_support(-p_params->dir))>p_params->min_d)
-		return; //test against whole AABB, which isn't very costly
-	*/
-
-	//printf("addr: %p\n",bvh);
-	if (!bvh->aabb.intersects_segment(p_params->from, p_params->to)) {
-
-		return;
-	}
-
-	if (bvh->face_index >= 0) {
+	const Face &f = faces[p_index];
+	Vector3 face_vertices[3] = {
+		vertices[f.indices[0]],
+		vertices[f.indices[1]],
+		vertices[f.indices[2]]
+	};
 
-		Vector3 res;
-		Vector3 vertices[3] = {
-			p_params->vertices[p_params->faces[bvh->face_index].indices[0]],
-			p_params->vertices[p_params->faces[bvh->face_index].indices[1]],
-			p_params->vertices[p_params->faces[bvh->face_index].indices[2]]
-		};
+	Vector3 res;
 
-		if (Geometry::segment_intersects_triangle(
-					p_params->from,
-					p_params->to,
-					vertices[0],
-					vertices[1],
-					vertices[2],
-					&res)) {
+	if (Geometry::segment_intersects_triangle(
+				from,
+				to,
+				face_vertices[0],
+				face_vertices[1],
+				face_vertices[2],
+				&res)) {
 
-			real_t d = p_params->dir.dot(res) - p_params->dir.dot(p_params->from);
-			//TODO, seems segmen/triangle intersection is broken :(
-			if (d > 0 && d < p_params->min_d) {
+		real_t d = dir.dot(res) - dir.dot(from);
+		//TODO, seems segmen/triangle intersection is broken :(
+		if (d > 0 && d < min_d) {
 
-				p_params->min_d = d;
-				p_params->result = res;
-				p_params->normal = Plane(vertices[0], vertices[1], vertices[2]).normal;
-				p_params->collisions++;
-			}
+			min_d = d;
+			result = res;
+			normal = Plane(face_vertices[0], face_vertices[1], face_vertices[2]).normal;
+			collisions++;
+			// nothing past the closest hit can replace it
+			r_max_t = MIN(r_max_t, d / len);
 		}
-
-	} else {
-
-		if (bvh->left >= 0)
-			_cull_segment(bvh->left, p_params);
-		if (bvh->right >= 0)
-			_cull_segment(bvh->right, p_params);
 	}
+
+	return true;
 }
 
 bool ConcavePolygonShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_result, Vector3 &r_normal) const {
@@ -1240,24 +1222,27 @@ bool ConcavePolygonShapeSW::intersect_segment(const Vector3 &p_begin, const Vect
 	if (faces.size() == 0)
 		return false;
 
+	real_t len = p_begin.distance_to(p_end);
+	if (len == 0)
+		return false;
+
 	// unlock data
 	PoolVector<Face>::Read fr = faces.read();
 	PoolVector<Vector3>::Read vr = vertices.read();
-	PoolVector<BVH>::Read br = bvh.read();
 
 	_SegmentCullParams params;
 	params.from = p_begin;
 	params.to = p_end;
 	params.collisions = 0;
-	params.dir = (p_end - p_begin).normalized();
+	params.dir = (p_end - p_begin) / len;
+	params.len = len;
 
 	params.faces = fr.ptr();
 	params.vertices = vr.ptr();
-	params.bvh = br.ptr();
 
 	params.min_d = 1e20;
 	// cull
-	_cull_segment(0, &params);
+	bvh.cull_ray(p_begin, p_end - p_begin, 1, params);
 
 	if (params.collisions > 0) {
 
@@ -1280,35 +1265,27 @@ Vector3 ConcavePolygonShapeSW::get_closest_point_to(const Vector3 &p_point) cons
 	return Vector3();
 }
 
-void ConcavePolygonShapeSW::_cull(int p_idx, _CullParams *p_params) const {
-
-	const BVH *bvh = &p_params->bvh[p_idx];
-
-	if (!p_params->aabb.intersects(bvh->aabb))
-		return;
-
-	if (bvh->face_index >= 0) {
-
-		const Face *f = &p_params->faces[bvh->face_index];
-		FaceShapeSW *face = p_params->face;
-		face->normal = f->normal;
-		face->vertex[0] = p_params->vertices[f->indices[0]];
-		face->vertex[1] = p_params->vertices[f->indices[1]];
-		face->vertex[2] = p_params->vertices[f->indices[2]];
-		p_params->callback(p_params->userdata, face);
-
-	} else {
+bool ConcavePolygonShapeSW::_CullParams::operator()(uint32_t p_index) {
 
-		if (bvh->left >= 0) {
+	const Face &f = faces[p_index];
+	const Vector3 &v0 = vertices[f.indices[0]];
+	const Vector3 &v1 = vertices[f.indices[1]];
+	const Vector3 &v2 = vertices[f.indices[2]];
 
-			_cull(bvh->left, p_params);
-		}
+	// leaves hold several faces, so the face itself has to be checked against the box
+	AABB face_aabb(v0, Vector3());
+	face_aabb.expand_to(v1);
+	face_aabb.expand_to(v2);
+	if (!aabb.intersects(face_aabb))
+		return true;
 
-		if (bvh->right >= 0) {
+	face->normal = f.normal;
+	face->vertex[0] = v0;
+	face->vertex[1] = v1;
+	face->vertex[2] = v2;
+	callback(userdata, face);
 
-			_cull(bvh->right, p_params);
-		}
-	}
+	return true;
 }
 
 void ConcavePolygonShapeSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
@@ -1322,7 +1299,6 @@ void ConcavePolygonShapeSW::cull(const AABB &p_local_aabb, Callback p_callback,
 	// unlock data
 	PoolVector<Face>::Read fr = faces.read();
 	PoolVector<Vector3>::Read vr = vertices.read();
-	PoolVector<BVH>::Read br = bvh.read();
 
 	FaceShapeSW face; // use this to send in the callback
 
@@ -1331,12 +1307,11 @@ void ConcavePolygonShapeSW::cull(const AABB &p_local_aabb, Callback p_callback,
 	params.face = &face;
 	params.faces = fr.ptr();
 	params.vertices = vr.ptr();
-	params.bvh = br.ptr();
 	params.callback = p_callback;
 	params.userdata = p_userdata;
 
 	// cull
-	_cull(0, &params);
+	bvh.cull_aabb(local_aabb, params);
 }
 
 Vector3 ConcavePolygonShapeSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1350,134 +1325,14 @@ Vector3 ConcavePolygonShapeSW::get_moment_of_inertia(real_t p_mass) const {
 			(p_mass / 3.0) * (extents.y * extents.y + extents.y * extents.y));
 }
 
-struct _VolumeSW_BVH_Element {
-
-	AABB aabb;
-	Vector3 center;
-	int face_index;
-};
-
-struct _VolumeSW_BVH_CompareX {
-
-	_FORCE_INLINE_ bool operator()(const _VolumeSW_BVH_Element &a, const _VolumeSW_BVH_Element &b) const {
-
-		return a.center.x < b.center.x;
-	}
-};
-
-struct _VolumeSW_BVH_CompareY {
-
-	_FORCE_INLINE_ bool operator()(const _VolumeSW_BVH_Element &a, const _VolumeSW_BVH_Element &b) const {
-
-		return a.center.y < b.center.y;
-	}
-};
-
-struct _VolumeSW_BVH_CompareZ {
-
-	_FORCE_INLINE_ bool operator()(const _VolumeSW_BVH_Element &a, const _VolumeSW_BVH_Element &b) const {
-
-		return a.center.z < b.center.z;
-	}
-};
-
-struct _VolumeSW_BVH {
-
-	AABB aabb;
-	_VolumeSW_BVH *left;
-	_VolumeSW_BVH *right;
-
-	int face_index;
-};
-
-_VolumeSW_BVH *_volume_sw_build_bvh(_VolumeSW_BVH_Element *p_elements, int p_size, int &count) {
-
-	_VolumeSW_BVH *bvh = memnew(_VolumeSW_BVH);
-
-	if (p_size == 1) {
-		//leaf
-		bvh->aabb = p_elements[0].aabb;
-		bvh->left = NULL;
-		bvh->right = NULL;
-		bvh->face_index = p_elements->face_index;
-		count++;
-		return bvh;
-	} else {
-
-		bvh->face_index = -1;
-	}
-
-	AABB aabb;
-	for (int i = 0; i < p_size; i++) {
-
-		if (i == 0)
-			aabb = p_elements[i].aabb;
-		else
-			aabb.merge_with(p_elements[i].aabb);
-	}
-	bvh->aabb = aabb;
-	switch (aabb.get_longest_axis_index()) {
-
-		case 0: {
-
-			SortArray<_VolumeSW_BVH_Element, _VolumeSW_BVH_CompareX> sort_x;
-			sort_x.sort(p_elements, p_size);
-
-		} break;
-		case 1: {
-
-			SortArray<_VolumeSW_BVH_Element, _VolumeSW_BVH_CompareY> sort_y;
-			sort_y.sort(p_elements, p_size);
-		} break;
-		case 2: {
-
-			SortArray<_VolumeSW_BVH_Element, _VolumeSW_BVH_CompareZ> sort_z;
-			sort_z.sort(p_elements, p_size);
-		} break;
-	}
-
-	int split = p_size / 2;
-	bvh->left = _volume_sw_build_bvh(p_elements, split, count);
-	bvh->right = _volume_sw_build_bvh(&p_elements[split], p_size - split, count);
-
-	//printf("branch at %p - %i: %i\n",bvh,count,bvh->face_index);
-	count++;
-	return bvh;
-}
-
-void ConcavePolygonShapeSW::_fill_bvh(_VolumeSW_BVH *p_bvh_tree, BVH *p_bvh_array, int &p_idx) {
-
-	int idx = p_idx;
-
-	p_bvh_array[idx].aabb = p_bvh_tree->aabb;
-	p_bvh_array[idx].face_index = p_bvh_tree->face_index;
-	//printf("%p - %i: %i(%p)  -- %p:%p\n",%p_bvh_array[idx],p_idx,p_bvh_array[i]->face_index,&p_bvh_tree->face_index,p_bvh_tree->left,p_bvh_tree->right);
-
-	if (p_bvh_tree->left) {
-		p_bvh_array[idx].left = ++p_idx;
-		_fill_bvh(p_bvh_tree->left, p_bvh_array, p_idx);
-
-	} else {
-
-		p_bvh_array[p_idx].left = -1;
-	}
-
-	if (p_bvh_tree->right) {
-		p_bvh_array[idx].right = ++p_idx;
-		_fill_bvh(p_bvh_tree->right, p_bvh_array, p_idx);
-
-	} else {
-
-		p_bvh_array[p_idx].right = -1;
-	}
-
-	memdelete(p_bvh_tree);
-}
+void ConcavePolygonShapeSW::_setup(PoolVector<Vector3> p_faces, const PoolVector<uint8_t> &p_bvh) {
 
-void ConcavePolygonShapeSW::_setup(PoolVector<Vector3> p_faces) {
+	bvh.clear();
 
 	int src_face_count = p_faces.size();
 	if (src_face_count == 0) {
+		faces.resize(0);
+		vertices.resize(0);
 		configure(AABB());
 		return;
 	}
@@ -1487,11 +1342,8 @@ void ConcavePolygonShapeSW::_setup(PoolVector<Vector3> p_faces) {
 	PoolVector<Vector3>::Read r = p_faces.read();
 	const Vector3 *facesr = r.ptr();
 
-	PoolVector<_VolumeSW_BVH_Element> bvh_array;
-	bvh_array.resize(src_face_count);
-
-	PoolVector<_VolumeSW_BVH_Element>::Write bvhw = bvh_array.write();
-	_VolumeSW_BVH_Element *bvh_arrayw = bvhw.ptr();
+	LocalVector<AABB> face_aabbs;
+	face_aabbs.resize(src_face_count);
 
 	faces.resize(src_face_count);
 	PoolVector<Face>::Write w = faces.write();
@@ -1508,9 +1360,7 @@ void ConcavePolygonShapeSW::_setup(PoolVector<Vector3> p_faces) {
 
 		Face3 face(facesr[i * 3 + 0], facesr[i * 3 + 1], facesr[i * 3 + 2]);
 
-		bvh_arrayw[i].aabb = face.get_aabb();
-		bvh_arrayw[i].center = bvh_arrayw[i].aabb.position + bvh_arrayw[i].aabb.size * 0.5;
-		bvh_arrayw[i].face_index = i;
+		face_aabbs[i] = face.get_aabb();
 		facesw[i].indices[0] = i * 3 + 0;
 		facesw[i].indices[1] = i * 3 + 1;
 		facesw[i].indices[2] = i * 3 + 2;
@@ -1519,31 +1369,33 @@ void ConcavePolygonShapeSW::_setup(PoolVector<Vector3> p_faces) {
 		verticesw[i * 3 + 1] = face.vertex[1];
 		verticesw[i * 3 + 2] = face.vertex[2];
 		if (i == 0)
-			_aabb = bvh_arrayw[i].aabb;
+			_aabb = face_aabbs[i];
 		else
-			_aabb.merge_with(bvh_arrayw[i].aabb);
+			_aabb.merge_with(face_aabbs[i]);
 	}
 
 	w = PoolVector<Face>::Write();
 	vw = PoolVector<Vector3>::Write();
 
-	int count = 0;
-	_VolumeSW_BVH *bvh_tree = _volume_sw_build_bvh(bvh_arrayw, src_face_count, count);
-
-	bvh.resize(count + 1);
-
-	PoolVector<BVH>::Write bvhw2 = bvh.write();
-	BVH *bvh_arrayw2 = bvhw2.ptr();
-
-	int idx = 0;
-	_fill_bvh(bvh_tree, bvh_arrayw2, idx);
+	// a tree stored with the resource saves the build on load, anything that doesn't match the faces is rebuilt
+	if (p_bvh.size() == 0 || !bvh.deserialize(p_bvh, face_aabbs.ptr(), src_face_count)) {
+		bvh.build(face_aabbs.ptr(), src_face_count);
+	}
 
 	configure(_aabb); // this type of shape has no margin
 }
 
 void ConcavePolygonShapeSW::set_data(const Variant &p_data) {
 
-	_setup(p_data);
+	if (p_data.get_type() == Variant::DICTIONARY) {
+
+		Dictionary d = p_data;
+		ERR_FAIL_COND(!d.has("faces"));
+		_setup(d["faces"], d.has("bvh") ? PoolVector<uint8_t>(d["bvh"]) : PoolVector<uint8_t>());
+	} else {
+
+		_setup(p_data);
+	}
 }
 
 Variant ConcavePolygonShapeSW::get_data() const {
@@ -1585,21 +1437,337 @@ Vector3 HeightMapShapeSW::get_support(const Vector3 &p_normal) const {
 	return get_aabb().get_support(p_normal);
 }
 
+void HeightMapShapeSW::_get_cell_faces(const real_t *p_heights, int p_x, int p_z, Vector3 r_faces[2][3]) const {
+
+	// split along the same diagonal as Bullet, from (x, z + 1) to (x + 1, z), wound so the normals point up
+	Vector3 a = _get_point(p_heights, p_x, p_z);
+	Vector3 b = _get_point(p_heights, p_x + 1, p_z);
+	Vector3 c = _get_point(p_heights, p_x, p_z + 1);
+	Vector3 d = _get_point(p_heights, p_x + 1, p_z + 1);
+
+	r_faces[0][0] = a;
+	r_faces[0][1] = b;
+	r_faces[0][2] = c;
+
+	r_faces[1][0] = b;
+	r_faces[1][1] = d;
+	r_faces[1][2] = c;
+}
+
+AABB HeightMapShapeSW::_get_node_aabb(const Range &p_range, int p_level, int p_x, int p_z) const {
+
+	int from_x = p_x << p_level;
+	int from_z = p_z << p_level;
+	int cells_x = MIN(1 << p_level, width - 1 - from_x);
+	int cells_z = MIN(1 << p_level, depth - 1 - from_z);
+
+	AABB aabb;
+	aabb.position = Vector3((from_x - (width - 1) * 0.5) * cell_size, p_range.min, (from_z - (depth - 1) * 0.5) * cell_size);
+	aabb.size = Vector3(cells_x * cell_size, p_range.max - p_range.min, cells_z * cell_size);
+	return aabb;
+}
+
+static _FORCE_INLINE_ bool _segment_intersects_aabb(const AABB &p_aabb, const Vector3 &p_from, const Vector3 &p_inv_dir, real_t p_max_t, real_t &r_min_t) {
+
+	real_t min_t = 0;
+	real_t max_t = p_max_t;
+
+	for (int i = 0; i < 3; i++) {
+
+		real_t a = p_aabb.position[i];
+		real_t b = p_aabb.position[i] + p_aabb.size[i];
+
+		if (Math::is_inf(p_inv_dir[i])) {
+			// parallel to the slab
+			if (p_from[i] < a || p_from[i] > b)
+				return false;
+			continue;
+		}
+
+		real_t t0 = (a - p_from[i]) * p_inv_dir[i];
+		real_t t1 = (b - p_from[i]) * p_inv_dir[i];
+		if (t0 > t1)
+			SWAP(t0, t1);
+
+		min_t = MAX(min_t, t0);
+		max_t = MIN(max_t, t1);
+		if (min_t > max_t)
+			return false;
+	}
+
+	r_min_t = min_t;
+	return true;
+}
+
+void HeightMapShapeSW::_cull_segment(int p_level, int p_x, int p_z, _SegmentCullParams *p_params) const {
+
+	const Level &level = p_params->levels[p_level];
+	real_t entry_t;
+	if (!_segment_intersects_aabb(_get_node_aabb(p_params->ranges[level.offset + p_z * level.width + p_x], p_level, p_x, p_z), p_params->from, p_params->inv_dir, p_params->min_t, entry_t))
+		return;
+
+	if (p_level == 0) {
+
+		Vector3 faces[2][3];
+		_get_cell_faces(p_params->heights, p_x, p_z, faces);
+
+		Vector3 to = p_params->from + p_params->dir;
+		real_t dir_len_sq = p_params->dir.length_squared();
+
+		for (int i = 0; i < 2; i++) {
+
+			Vector3 res;
+			if (Geometry::segment_intersects_triangle(p_params->from, to, faces[i][0], faces[i][1], faces[i][2], &res)) {
+
+				real_t t = (res - p_params->from).dot(p_params->dir) / dir_len_sq;
+				if (t < p_params->min_t) {
+
+					p_params->min_t = t;
+					p_params->result = res;
+					p_params->normal = Plane(faces[i][0], faces[i][1], faces[i][2]).normal;
+					p_params->collided = true;
+				}
+			}
+		}
+		return;
+	}
+
+	// children in the order the segment goes through them, so the first hits prune the rest
+	const Level &child_level = p_params->levels[p_level - 1];
+	int near_x = p_params->dir.x < 0 ? 1 : 0;
+	int near_z = p_params->dir.z < 0 ? 1 : 0;
+	static const int order[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+
+	for (int i = 0; i < 4; i++) {
+
+		int x = p_x * 2 + (order[i][0] ^ near_x);
+		int z = p_z * 2 + (order[i][1] ^ near_z);
+		if (x < child_level.width && z < child_level.depth) {
+			_cull_segment(p_level - 1, x, z, p_params);
+		}
+	}
+}
+
 bool HeightMapShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
 
-	return false;
+	if (levels.size() == 0)
+		return false;
+
+	PoolVector<real_t>::Read r = heights.read();
+
+	_SegmentCullParams params;
+	params.from = p_begin;
+	params.dir = p_end - p_begin;
+	for (int i = 0; i < 3; i++) {
+		params.inv_dir[i] = params.dir[i] != 0 ? 1.0 / params.dir[i] : Math_INF;
+	}
+	params.heights = r.ptr();
+	params.ranges = ranges.ptr();
+	params.levels = levels.ptr();
+	params.min_t = 1.0;
+	params.collided = false;
+
+	_cull_segment(levels.size() - 1, 0, 0, &params);
+
+	if (params.collided) {
+		r_point = params.result;
+		r_normal = params.normal;
+	}
+
+	return params.collided;
 }
 
 bool HeightMapShapeSW::intersect_point(const Vector3 &p_point) const {
-	return false;
+
+	if (levels.size() == 0 || !get_aabb().has_point(p_point))
+		return false;
+
+	// below the surface counts as inside, down to the lowest height
+	real_t fx = p_point.x / cell_size + (width - 1) * 0.5;
+	real_t fz = p_point.z / cell_size + (depth - 1) * 0.5;
+	int x = CLAMP(int(Math::floor(fx)), 0, width - 2);
+	int z = CLAMP(int(Math::floor(fz)), 0, depth - 2);
+	fx -= x;
+	fz -= z;
+
+	PoolVector<real_t>::Read r = heights.read();
+	real_t ha = r[z * width + x];
+	real_t hb = r[z * width + x + 1];
+	real_t hc = r[(z + 1) * width + x];
+	real_t hd = r[(z + 1) * width + x + 1];
+
+	real_t h;
+	if (fx + fz <= 1) {
+		h = ha + fx * (hb - ha) + fz * (hc - ha);
+	} else {
+		h = hd + (1 - fx) * (hc - hd) + (1 - fz) * (hb - hd);
+	}
+
+	return p_point.y <= h;
+}
+
+static _FORCE_INLINE_ real_t _get_aabb_distance_squared(const AABB &p_aabb, const Vector3 &p_point) {
+
+	Vector3 closest;
+	for (int i = 0; i < 3; i++) {
+		closest[i] = CLAMP(p_point[i], p_aabb.position[i], p_aabb.position[i] + p_aabb.size[i]);
+	}
+	return closest.distance_squared_to(p_point);
+}
+
+void HeightMapShapeSW::_find_closest_point(int p_level, int p_x, int p_z, _ClosestPointParams *p_params) const {
+
+	if (p_level == 0) {
+
+		Vector3 faces[2][3];
+		_get_cell_faces(p_params->heights, p_x, p_z, faces);
+
+		for (int i = 0; i < 2; i++) {
+
+			Vector3 point = Face3(faces[i][0], faces[i][1], faces[i][2]).get_closest_point_to(p_params->point);
+			real_t d = point.distance_squared_to(p_params->point);
+			if (d < p_params->min_d) {
+				p_params->min_d = d;
+				p_params->result = point;
+			}
+		}
+		return;
+	}
+
+	const Level &child_level = p_params->levels[p_level - 1];
+
+	int children[4][2];
+	real_t distances[4];
+	int count = 0;
+
+	for (int i = 0; i < 4; i++) {
+
+		int x = p_x * 2 + (i & 1);
+		int z = p_z * 2 + (i >> 1);
+		if (x >= child_level.width || z >= child_level.depth)
+			continue;
+
+		real_t d = _get_aabb_distance_squared(_get_node_aabb(p_params->ranges[child_level.offset + z * child_level.width + x], p_level - 1, x, z), p_params->point);
+
+		// insertion sort, nearest first
+		int j = count;
+		while (j > 0 && distances[j - 1] > d) {
+			distances[j] = distances[j - 1];
+			children[j][0] = children[j - 1][0];
+			children[j][1] = children[j - 1][1];
+			j--;
+		}
+		distances[j] = d;
+		children[j][0] = x;
+		children[j][1] = z;
+		count++;
+	}
+
+	for (int i = 0; i < count; i++) {
+
+		if (distances[i] >= p_params->min_d)
+			break;
+		_find_closest_point(p_level - 1, children[i][0], children[i][1], p_params);
+	}
 }
 
 Vector3 HeightMapShapeSW::get_closest_point_to(const Vector3 &p_point) const {
 
-	return Vector3();
+	if (levels.size() == 0)
+		return Vector3();
+
+	PoolVector<real_t>::Read r = heights.read();
+
+	_ClosestPointParams params;
+	params.point = p_point;
+	params.heights = r.ptr();
+	params.ranges = ranges.ptr();
+	params.levels = levels.ptr();
+	params.min_d = 1e20;
+
+	_find_closest_point(levels.size() - 1, 0, 0, &params);
+
+	return params.result;
+}
+
+void HeightMapShapeSW::_cull(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+
+	int from_x = p_x << p_level;
+	int from_z = p_z << p_level;
+	int to_x = from_x + (1 << p_level) - 1;
+	int to_z = from_z + (1 << p_level) - 1;
+
+	if (to_x < p_params->from_x || from_x > p_params->to_x || to_z < p_params->from_z || from_z > p_params->to_z)
+		return;
+
+	const Level &level = p_params->levels[p_level];
+	const Range &range = p_params->ranges[level.offset + p_z * level.width + p_x];
+	if (range.max < p_params->aabb.position.y || range.min > p_params->aabb.position.y + p_params->aabb.size.y)
+		return;
+
+	if (p_level == 0) {
+
+		// triangles are only made for the cells that are hit
+		Vector3 faces[2][3];
+		_get_cell_faces(p_params->heights, p_x, p_z, faces);
+
+		FaceShapeSW *face = p_params->face;
+		for (int i = 0; i < 2; i++) {
+
+			face->vertex[0] = faces[i][0];
+			face->vertex[1] = faces[i][1];
+			face->vertex[2] = faces[i][2];
+			face->normal = Plane(faces[i][0], faces[i][1], faces[i][2]).normal;
+			p_params->callback(p_params->userdata, face);
+		}
+		return;
+	}
+
+	const Level &child_level = p_params->levels[p_level - 1];
+	for (int i = 0; i < 4; i++) {
+
+		int x = p_x * 2 + (i & 1);
+		int z = p_z * 2 + (i >> 1);
+		if (x < child_level.width && z < child_level.depth) {
+			_cull(p_level - 1, x, z, p_params);
+		}
+	}
 }
 
 void HeightMapShapeSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
+
+	if (levels.size() == 0)
+		return;
+
+	_CullParams params;
+	params.aabb = p_local_aabb;
+
+	// cells under the aabb
+	params.from_x = int(Math::floor(p_local_aabb.position.x / cell_size + (width - 1) * 0.5));
+	params.from_z = int(Math::floor(p_local_aabb.position.z / cell_size + (depth - 1) * 0.5));
+	params.to_x = int(Math::floor((p_local_aabb.position.x + p_local_aabb.size.x) / cell_size + (width - 1) * 0.5));
+	params.to_z = int(Math::floor((p_local_aabb.position.z + p_local_aabb.size.z) / cell_size + (depth - 1) * 0.5));
+
+	params.from_x = MAX(params.from_x, 0);
+	params.from_z = MAX(params.from_z, 0);
+	params.to_x = MIN(params.to_x, width - 2);
+	params.to_z = MIN(params.to_z, depth - 2);
+
+	if (params.from_x > params.to_x || params.from_z > params.to_z)
+		return;
+
+	PoolVector<real_t>::Read r = heights.read();
+
+	FaceShapeSW face; // use this to send in the callback
+
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+	params.heights = r.ptr();
+	params.ranges = ranges.ptr();
+	params.levels = levels.ptr();
+	params.face = &face;
+
+	_cull(levels.size() - 1, 0, 0, &params);
 }
 
 Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1620,21 +1788,78 @@ void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_d
 	depth = p_depth;
 	cell_size = p_cell_size;
 
+	ranges.clear();
+	levels.clear();
+
 	PoolVector<real_t>::Read r = heights.read();
 
+	min_height = r[0];
+	max_height = r[0];
+	for (int i = 1; i < width * depth; i++) {
+		min_height = MIN(min_height, r[i]);
+		max_height = MAX(max_height, r[i]);
+	}
+
 	AABB aabb;
+	aabb.position = Vector3(-(width - 1) * 0.5 * cell_size, min_height, -(depth - 1) * 0.5 * cell_size);
+	aabb.size = Vector3((width - 1) * cell_size, max_height - min_height, (depth - 1) * cell_size);
+
+	if (width > 1 && depth > 1) {
+
+		// cell ranges first
+		Level level;
+		level.width = width - 1;
+		level.depth = depth - 1;
+		level.offset = 0;
+		levels.push_back(level);
+
+		int range_count = level.width * level.depth;
+		Level top = level;
+		while (top.width > 1 || top.depth > 1) {
+			top.offset += top.width * top.depth;
+			top.width = (top.width + 1) / 2;
+			top.depth = (top.depth + 1) / 2;
+			levels.push_back(top);
+			range_count += top.width * top.depth;
+		}
+
+		ranges.resize(range_count);
+		Range *w = ranges.ptrw();
+
+		for (int z = 0; z < level.depth; z++) {
+			for (int x = 0; x < level.width; x++) {
+
+				real_t h[4] = { r[z * width + x], r[z * width + x + 1], r[(z + 1) * width + x], r[(z + 1) * width + x + 1] };
+				Range &range = w[z * level.width + x];
+				range.min = MIN(MIN(h[0], h[1]), MIN(h[2], h[3]));
+				range.max = MAX(MAX(h[0], h[1]), MAX(h[2], h[3]));
+			}
+		}
+
+		for (int i = 1; i < levels.size(); i++) {
+
+			const Level &below = levels[i - 1];
+			const Level &current = levels[i];
+
+			for (int z = 0; z < current.depth; z++) {
+				for (int x = 0; x < current.width; x++) {
 
-	for (int i = 0; i < depth; i++) {
+					Range &range = w[current.offset + z * current.width + x];
+					range = w[below.offset + z * 2 * below.width + x * 2];
 
-		for (int j = 0; j < width; j++) {
+					for (int j = 1; j < 4; j++) {
 
-			real_t h = r[i * width + j];
+						int bx = x * 2 + (j & 1);
+						int bz = z * 2 + (j >> 1);
+						if (bx >= below.width || bz >= below.depth)
+							continue;
 
-			Vector3 pos(j * cell_size, h, i * cell_size);
-			if (i == 0 || j == 0)
-				aabb.position = pos;
-			else
-				aabb.expand_to(pos);
+						const Range &child = w[below.offset + bz * below.width + bx];
+						range.min = MIN(range.min, child.min);
+						range.max = MAX(range.max, child.max);
+					}
+				}
+			}
 		}
 	}
 
@@ -1664,7 +1889,12 @@ void HeightMapShapeSW::set_data(const Variant &p_data) {
 
 Variant HeightMapShapeSW::get_data() const {
 
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"] = width;
+	d["depth"] = depth;
+	d["cell_size"] = cell_size;
+	d["heights"] = heights;
+	return d;
 }
 
 HeightMapShapeSW::HeightMapShapeSW() {
@@ -1672,4 +1902,6 @@ HeightMapShapeSW::HeightMapShapeSW() {
 	width = 0;
 	depth = 0;
 	cell_size = 0;
+	min_height = 0;
+	max_height = 0;
 }
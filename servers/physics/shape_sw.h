@@ -34,6 +34,7 @@
 #include "bsp_tree.h"
 #include "geometry.h"
 #include "servers/physics_server.h"
+#include "triangle_bvh.h"
 /*
 
 SHAPE_LINE, ///< plane:"plane"
@@ -285,7 +286,6 @@ public:
 	ConvexPolygonShapeSW();
 };
 
-struct _VolumeSW_BVH;
 struct FaceShapeSW;
 
 struct ConcavePolygonShapeSW : public ConcaveShapeSW {
@@ -300,16 +300,7 @@ struct ConcavePolygonShapeSW : public ConcaveShapeSW {
 	PoolVector<Face> faces;
 	PoolVector<Vector3> vertices;
 
-	struct BVH {
-
-		AABB aabb;
-		int left;
-		int right;
-
-		int face_index;
-	};
-
-	PoolVector<BVH> bvh;
+	TriangleBVH bvh;
 
 	struct _CullParams {
 
@@ -318,8 +309,9 @@ struct ConcavePolygonShapeSW : public ConcaveShapeSW {
 		void *userdata;
 		const Face *faces;
 		const Vector3 *vertices;
-		const BVH *bvh;
 		FaceShapeSW *face;
+
+		_FORCE_INLINE_ bool operator()(uint32_t p_index);
 	};
 
 	struct _SegmentCullParams {
@@ -328,21 +320,18 @@ struct ConcavePolygonShapeSW : public ConcaveShapeSW {
 		Vector3 to;
 		const Face *faces;
 		const Vector3 *vertices;
-		const BVH *bvh;
 		Vector3 dir;
+		real_t len;
 
 		Vector3 result;
 		Vector3 normal;
 		real_t min_d;
 		int collisions;
-	};
-
-	void _cull_segment(int p_idx, _SegmentCullParams *p_params) const;
-	void _cull(int p_idx, _CullParams *p_params) const;
 
-	void _fill_bvh(_VolumeSW_BVH *p_bvh_tree, BVH *p_bvh_array, int &p_idx);
+		_FORCE_INLINE_ bool operator()(uint32_t p_index, real_t &r_max_t);
+	};
 
-	void _setup(PoolVector<Vector3> p_faces);
+	void _setup(PoolVector<Vector3> p_faces, const PoolVector<uint8_t> &p_bvh = PoolVector<uint8_t>());
 
 public:
 	PoolVector<Vector3> get_faces() const;
@@ -372,9 +361,78 @@ struct HeightMapShapeSW : public ConcaveShapeSW {
 	int width;
 	int depth;
 	real_t cell_size;
+	real_t min_height;
+	real_t max_height;
+
+	// Min/max height tree over the cells, level 0 has one range per cell and
+	// every level above merges 2x2 ranges of the one below, up to a single range.
+	struct Range {
+		real_t min;
+		real_t max;
+	};
+
+	struct Level {
+		int width;
+		int depth;
+		int offset; // in ranges
+	};
+
+	Vector<Range> ranges;
+	Vector<Level> levels;
+
+	struct _CullParams {
+
+		AABB aabb;
+		int from_x;
+		int from_z;
+		int to_x; // inclusive
+		int to_z;
+		Callback callback;
+		void *userdata;
+		const real_t *heights;
+		const Range *ranges;
+		const Level *levels;
+		FaceShapeSW *face;
+	};
+
+	struct _SegmentCullParams {
+
+		Vector3 from;
+		Vector3 dir;
+		Vector3 inv_dir;
+		const real_t *heights;
+		const Range *ranges;
+		const Level *levels;
+
+		Vector3 result;
+		Vector3 normal;
+		real_t min_t;
+		bool collided;
+	};
+
+	struct _ClosestPointParams {
+
+		Vector3 point;
+		const real_t *heights;
+		const Range *ranges;
+		const Level *levels;
+
+		Vector3 result;
+		real_t min_d;
+	};
+
+	_FORCE_INLINE_ Vector3 _get_point(const real_t *p_heights, int p_x, int p_z) const {
+
+		// centered on the origin, the same way Bullet places height fields
+		return Vector3((p_x - (width - 1) * 0.5) * cell_size, p_heights[p_z * width + p_x], (p_z - (depth - 1) * 0.5) * cell_size);
+	}
+
+	_FORCE_INLINE_ void _get_cell_faces(const real_t *p_heights, int p_x, int p_z, Vector3 r_faces[2][3]) const;
+	_FORCE_INLINE_ AABB _get_node_aabb(const Range &p_range, int p_level, int p_x, int p_z) const;
 
-	//void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-	//void _cull(int p_idx,_CullParams *p_params) const;
+	void _cull(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+	void _cull_segment(int p_level, int p_x, int p_z, _SegmentCullParams *p_params) const;
+	void _find_closest_point(int p_level, int p_x, int p_z, _ClosestPointParams *p_params) const;
 
 	void _setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size);
 
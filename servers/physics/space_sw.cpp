@@ -31,8 +31,10 @@
 #include "space_sw.h"
 
 #include "collision_solver_sw.h"
+#include "os/thread_work_pool.h"
 #include "physics_server_sw.h"
 #include "project_settings.h"
+#include "sort.h"
 
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObjectSW *p_object, uint32_t p_collision_mask) {
 
@@ -500,6 +502,326 @@ Vector3 PhysicsDirectSpaceStateSW::get_closest_point_to_object_volume(RID p_obje
 	}
 }
 
+struct _SnapshotShapeAxisCompare {
+
+	int axis;
+
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T &p_a, const T &p_b) const { return p_a.aabb.position[axis] * 2.0 + p_a.aabb.size[axis] < p_b.aabb.position[axis] * 2.0 + p_b.aabb.size[axis]; }
+};
+
+int PhysicsDirectSpaceStateSW::_build_snapshot_node(Snapshot &r_snapshot, int p_from, int p_count) {
+
+	int index = r_snapshot.nodes.size();
+	r_snapshot.nodes.push_back(SnapshotNode());
+
+	SnapshotShape *shapes = &r_snapshot.shapes[p_from];
+
+	AABB aabb = shapes[0].aabb;
+	AABB centers(shapes[0].aabb.position + shapes[0].aabb.size * 0.5, Vector3());
+	for (int i = 1; i < p_count; i++) {
+		aabb.merge_with(shapes[i].aabb);
+		centers.expand_to(shapes[i].aabb.position + shapes[i].aabb.size * 0.5);
+	}
+
+	if (p_count <= 4) {
+		SnapshotNode &leaf = r_snapshot.nodes[index];
+		leaf.aabb = aabb;
+		leaf.first = p_from;
+		leaf.count = p_count;
+		return index;
+	}
+
+	// median split along the axis where the shapes are most spread
+	SortArray<SnapshotShape, _SnapshotShapeAxisCompare> sorter;
+	sorter.compare.axis = centers.get_longest_axis_index();
+	int half = p_count / 2;
+	sorter.nth_element(0, p_count, half, shapes);
+
+	_build_snapshot_node(r_snapshot, p_from, half);
+	int second = _build_snapshot_node(r_snapshot, p_from + half, p_count - half);
+
+	// children were pushed after this node, so it has to be looked up again
+	SnapshotNode &node = r_snapshot.nodes[index];
+	node.aabb = aabb;
+	node.first = second;
+	node.count = 0;
+	return index;
+}
+
+void PhysicsDirectSpaceStateSW::_build_snapshot(Snapshot &r_snapshot, const Set<RID> &p_exclude) const {
+
+	// every shape the broadphase knows about, so results match intersect_ray() and intersect_shape()
+	for (const Set<CollisionObjectSW *>::Element *E = space->get_objects().front(); E; E = E->next()) {
+
+		const CollisionObjectSW *col_obj = E->get();
+		if (p_exclude.has(col_obj->get_self()))
+			continue;
+
+		for (int i = 0; i < col_obj->get_shape_count(); i++) {
+			SnapshotShape shape;
+			shape.aabb = col_obj->get_shape_aabb(i);
+			shape.object = col_obj;
+			shape.shape = i;
+			shape.collision_layer = col_obj->get_collision_layer();
+			r_snapshot.shapes.push_back(shape);
+		}
+	}
+
+	if (r_snapshot.shapes.size()) {
+		_build_snapshot_node(r_snapshot, 0, r_snapshot.shapes.size());
+	}
+}
+
+#define QUERY_BATCH_CHUNK 32
+
+void PhysicsDirectSpaceStateSW::_run_batch(QueryBatch *p_batch, void (PhysicsDirectSpaceStateSW::*p_method)(uint32_t, QueryBatch *)) {
+
+	int chunks = (p_batch->count + QUERY_BATCH_CHUNK - 1) / QUERY_BATCH_CHUNK;
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (chunks > 1 && pool) {
+		pool->do_work(chunks, this, p_method, p_batch);
+	} else {
+		for (int i = 0; i < chunks; i++) {
+			(this->*p_method)(i, p_batch);
+		}
+	}
+}
+
+void PhysicsDirectSpaceStateSW::_intersect_ray_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+	int from = p_chunk * QUERY_BATCH_CHUNK;
+	int to = MIN(from + QUERY_BATCH_CHUNK, p_batch->count);
+
+	const Snapshot &snapshot = *p_batch->snapshot;
+	int stack[64];
+
+	for (int q = from; q < to; q++) {
+
+		const RayQuery &query = p_batch->rays[q];
+		RayResult &r_result = p_batch->ray_results[q];
+
+		Vector3 begin = query.from;
+		Vector3 end = query.to;
+		Vector3 normal = (end - begin).normalized();
+
+		// nodes are only tested up to the closest hit found so far
+		Vector3 cull_end = end;
+
+		Vector3 res_point, res_normal;
+		int res_shape = -1;
+		const CollisionObjectSW *res_obj = NULL;
+		real_t min_d = 1e10;
+
+		int stack_size = 0;
+		if (snapshot.nodes.size()) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size) {
+
+			const SnapshotNode &node = snapshot.nodes[stack[--stack_size]];
+			if (!node.aabb.intersects_segment(begin, cull_end))
+				continue;
+
+			if (node.count == 0) {
+				int first = &node - snapshot.nodes.ptr() + 1;
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = first;
+				continue;
+			}
+
+			for (int i = node.first; i < node.first + node.count; i++) {
+
+				const SnapshotShape &s = snapshot.shapes[i];
+				if (!(s.collision_layer & query.collision_mask))
+					continue;
+
+				const CollisionObjectSW *col_obj = s.object;
+				Transform inv_xform = col_obj->get_shape_inv_transform(s.shape) * col_obj->get_inv_transform();
+
+				Vector3 local_from = inv_xform.xform(begin);
+				Vector3 local_to = inv_xform.xform(end);
+
+				Vector3 shape_point, shape_normal;
+
+				if (col_obj->get_shape(s.shape)->intersect_segment(local_from, local_to, shape_point, shape_normal)) {
+
+					Transform xform = col_obj->get_transform() * col_obj->get_shape_transform(s.shape);
+					shape_point = xform.xform(shape_point);
+
+					real_t ld = normal.dot(shape_point);
+
+					if (ld < min_d) {
+
+						min_d = ld;
+						res_point = shape_point;
+						res_normal = inv_xform.basis.xform_inv(shape_normal).normalized();
+						res_shape = s.shape;
+						res_obj = col_obj;
+						cull_end = shape_point;
+					}
+				}
+			}
+		}
+
+		p_batch->hit_objects[q] = res_obj;
+		r_result.collider = NULL;
+		if (res_obj) {
+			r_result.collider_id = res_obj->get_instance_id();
+			r_result.normal = res_normal;
+			r_result.position = res_point;
+			r_result.rid = res_obj->get_self();
+			r_result.shape = res_shape;
+		} else {
+			r_result.collider_id = 0;
+			r_result.normal = Vector3();
+			r_result.position = Vector3();
+			r_result.rid = RID();
+			r_result.shape = -1;
+		}
+	}
+}
+
+void PhysicsDirectSpaceStateSW::_intersect_shape_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+	int from = p_chunk * QUERY_BATCH_CHUNK;
+	int to = MIN(from + QUERY_BATCH_CHUNK, p_batch->count);
+
+	const Snapshot &snapshot = *p_batch->snapshot;
+	int stack[64];
+
+	for (int q = from; q < to; q++) {
+
+		const ShapeQuery &query = p_batch->shapes[q];
+		ShapeResult &r_result = p_batch->shape_results[q];
+
+		AABB aabb = query.transform.xform(p_batch->shape->get_aabb());
+
+		const SnapshotShape *res = NULL;
+
+		int stack_size = 0;
+		if (snapshot.nodes.size()) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size && !res) {
+
+			const SnapshotNode &node = snapshot.nodes[stack[--stack_size]];
+			if (!node.aabb.intersects(aabb))
+				continue;
+
+			if (node.count == 0) {
+				int first = &node - snapshot.nodes.ptr() + 1;
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = first;
+				continue;
+			}
+
+			for (int i = node.first; i < node.first + node.count; i++) {
+
+				const SnapshotShape &s = snapshot.shapes[i];
+				if (!(s.collision_layer & query.collision_mask) || !s.aabb.intersects(aabb))
+					continue;
+
+				const CollisionObjectSW *col_obj = s.object;
+				if (!CollisionSolverSW::solve_static(p_batch->shape, query.transform, col_obj->get_shape(s.shape), col_obj->get_transform() * col_obj->get_shape_transform(s.shape), NULL, NULL, NULL, p_batch->margin, 0))
+					continue;
+
+				res = &s;
+				break;
+			}
+		}
+
+		p_batch->hit_objects[q] = res ? res->object : NULL;
+		r_result.collider = NULL;
+		if (res) {
+			r_result.collider_id = res->object->get_instance_id();
+			r_result.rid = res->object->get_self();
+			r_result.shape = res->shape;
+		} else {
+			r_result.collider_id = 0;
+			r_result.rid = RID();
+			r_result.shape = -1;
+		}
+	}
+}
+
+#undef QUERY_BATCH_CHUNK
+
+int PhysicsDirectSpaceStateSW::intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+
+	if (p_query_count <= 0)
+		return 0;
+
+	Snapshot snapshot;
+	_build_snapshot(snapshot, p_exclude);
+
+	LocalVector<const CollisionObjectSW *> hit_objects;
+	hit_objects.resize(p_query_count);
+
+	QueryBatch batch;
+	batch.snapshot = &snapshot;
+	batch.rays = p_queries;
+	batch.ray_results = r_results;
+	batch.hit_objects = hit_objects.ptr();
+	batch.count = p_query_count;
+	_run_batch(&batch, &PhysicsDirectSpaceStateSW::_intersect_ray_chunk);
+
+	// ObjectDB is not touched from the workers
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+		if (hit_objects[i]) {
+			if (r_results[i].collider_id != 0)
+				r_results[i].collider = ObjectDB::get_instance(r_results[i].collider_id);
+			hits++;
+		}
+	}
+
+	return hits;
+}
+
+int PhysicsDirectSpaceStateSW::intersect_shapes(const RID &p_shape, real_t p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+
+	if (p_query_count <= 0)
+		return 0;
+
+	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
+	ERR_FAIL_COND_V(!shape, 0);
+
+	Snapshot snapshot;
+	_build_snapshot(snapshot, p_exclude);
+
+	LocalVector<const CollisionObjectSW *> hit_objects;
+	hit_objects.resize(p_query_count);
+
+	QueryBatch batch;
+	batch.snapshot = &snapshot;
+	batch.shape = shape;
+	batch.margin = p_margin;
+	batch.shapes = p_queries;
+	batch.shape_results = r_results;
+	batch.hit_objects = hit_objects.ptr();
+	batch.count = p_query_count;
+	_run_batch(&batch, &PhysicsDirectSpaceStateSW::_intersect_shape_chunk);
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+		if (hit_objects[i]) {
+			if (r_results[i].collider_id != 0)
+				r_results[i].collider = ObjectDB::get_instance(r_results[i].collider_id);
+			hits++;
+		}
+	}
+
+	return hits;
+}
+
 PhysicsDirectSpaceStateSW::PhysicsDirectSpaceStateSW() {
 
 	space = NULL;
@@ -38,6 +38,7 @@
 #include "broad_phase_sw.h"
 #include "collision_object_sw.h"
 #include "hash_map.h"
+#include "local_vector.h"
 #include "project_settings.h"
 #include "typedefs.h"
 
@@ -45,12 +46,58 @@ class PhysicsDirectSpaceStateSW : public PhysicsDirectSpaceState {
 
 	GDCLASS(PhysicsDirectSpaceStateSW, PhysicsDirectSpaceState);
 
+	/* Batched queries run against a flat copy of the broadphase: the broadphase
+	 * and the space query buffers are not safe to share between threads. */
+
+	struct SnapshotShape {
+
+		AABB aabb;
+		const CollisionObjectSW *object;
+		int shape;
+		uint32_t collision_layer;
+	};
+
+	struct SnapshotNode {
+
+		AABB aabb;
+		int first; // first shape for leaves, second child for branches (the first child always follows its parent)
+		int count; // 0 for branches
+	};
+
+	// built per batch call, so batches from several threads don't share it
+	struct Snapshot {
+
+		LocalVector<SnapshotShape> shapes;
+		LocalVector<SnapshotNode> nodes;
+	};
+
+	struct QueryBatch {
+
+		const Snapshot *snapshot;
+		const RayQuery *rays;
+		RayResult *ray_results;
+		const ShapeSW *shape;
+		real_t margin;
+		const ShapeQuery *shapes;
+		ShapeResult *shape_results;
+		const CollisionObjectSW **hit_objects;
+		int count;
+	};
+
+	void _build_snapshot(Snapshot &r_snapshot, const Set<RID> &p_exclude) const;
+	static int _build_snapshot_node(Snapshot &r_snapshot, int p_from, int p_count);
+	void _run_batch(QueryBatch *p_batch, void (PhysicsDirectSpaceStateSW::*p_method)(uint32_t, QueryBatch *));
+	void _intersect_ray_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+	void _intersect_shape_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+
 public:
 	SpaceSW *space;
 
 	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
 	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false);
+	virtual int intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude = Set<RID>());
 	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual int intersect_shapes(const RID &p_shape, real_t p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude = Set<RID>());
 	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL);
 	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
 	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
@@ -31,6 +31,7 @@
 #include "step_sw.h"
 #include "joints_sw.h"
 
+#include "frame_profiler.h"
 #include "os/os.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
@@ -172,6 +173,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_INTEGRATE_FORCES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics/integrate_forces", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -225,6 +227,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_GENERATE_ISLANDS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics/generate_islands", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -243,6 +246,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics/setup_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -260,6 +264,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_SOLVE_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics/solve_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -286,10 +291,14 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics/integrate_velocities", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
-	p_space->update();
+	{
+		FRAME_PROFILE_SCOPE("physics/broadphase");
+		p_space->update();
+	}
 	p_space->unlock();
 	_step++;
 }
@@ -32,6 +32,7 @@
 #include "broad_phase_2d_basic.h"
 #include "broad_phase_2d_hash_grid.h"
 #include "collision_solver_2d_sw.h"
+#include "frame_profiler.h"
 #include "os/os.h"
 #include "project_settings.h"
 #include "script_language.h"
@@ -1233,6 +1234,8 @@ void Physics2DServerSW::step(real_t p_step) {
 	if (!active)
 		return;
 
+	FRAME_PROFILE_SCOPE("physics_2d/step");
+
 	doing_sync = false;
 
 	last_step = p_step;
@@ -1259,6 +1262,8 @@ void Physics2DServerSW::flush_queries() {
 	if (!active)
 		return;
 
+	FRAME_PROFILE_SCOPE("physics_2d/flush_queries");
+
 	uint64_t time_beg = OS::get_singleton()->get_ticks_usec();
 
 	for (Set<const Space2DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
@@ -31,8 +31,10 @@
 #include "space_2d_sw.h"
 
 #include "collision_solver_2d_sw.h"
+#include "os/thread_work_pool.h"
 #include "pair.h"
 #include "physics_2d_server_sw.h"
+#include "sort.h"
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject2DSW *p_object, uint32_t p_collision_mask) {
 
 	return p_object->get_collision_layer() & p_collision_mask;
@@ -442,6 +444,334 @@ bool Physics2DDirectSpaceStateSW::rest_info(RID p_shape, const Transform2D &p_sh
 	return true;
 }
 
+struct _SnapshotShapeAxisCompare {
+
+	int axis;
+
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T &p_a, const T &p_b) const { return p_a.aabb.position[axis] * 2.0 + p_a.aabb.size[axis] < p_b.aabb.position[axis] * 2.0 + p_b.aabb.size[axis]; }
+};
+
+int Physics2DDirectSpaceStateSW::_build_snapshot_node(Snapshot &r_snapshot, int p_from, int p_count) {
+
+	int index = r_snapshot.nodes.size();
+	r_snapshot.nodes.push_back(SnapshotNode());
+
+	SnapshotShape *shapes = &r_snapshot.shapes[p_from];
+
+	Rect2 aabb = shapes[0].aabb;
+	Rect2 centers(shapes[0].aabb.position + shapes[0].aabb.size * 0.5, Vector2());
+	for (int i = 1; i < p_count; i++) {
+		aabb = aabb.merge(shapes[i].aabb);
+		centers.expand_to(shapes[i].aabb.position + shapes[i].aabb.size * 0.5);
+	}
+
+	if (p_count <= 4) {
+		SnapshotNode &leaf = r_snapshot.nodes[index];
+		leaf.aabb = aabb;
+		leaf.first = p_from;
+		leaf.count = p_count;
+		return index;
+	}
+
+	// median split along the axis where the shapes are most spread
+	SortArray<SnapshotShape, _SnapshotShapeAxisCompare> sorter;
+	sorter.compare.axis = centers.size.x > centers.size.y ? 0 : 1;
+	int half = p_count / 2;
+	sorter.nth_element(0, p_count, half, shapes);
+
+	_build_snapshot_node(r_snapshot, p_from, half);
+	int second = _build_snapshot_node(r_snapshot, p_from + half, p_count - half);
+
+	// children were pushed after this node, so it has to be looked up again
+	SnapshotNode &node = r_snapshot.nodes[index];
+	node.aabb = aabb;
+	node.first = second;
+	node.count = 0;
+	return index;
+}
+
+void Physics2DDirectSpaceStateSW::_build_snapshot(Snapshot &r_snapshot, const Set<RID> &p_exclude) const {
+
+	// every shape the broadphase knows about, so results match intersect_ray() and intersect_shape()
+	for (const Set<CollisionObject2DSW *>::Element *E = space->get_objects().front(); E; E = E->next()) {
+
+		const CollisionObject2DSW *col_obj = E->get();
+		if (p_exclude.has(col_obj->get_self()))
+			continue;
+
+		for (int i = 0; i < col_obj->get_shape_count(); i++) {
+			SnapshotShape shape;
+			shape.aabb = col_obj->get_shape_aabb(i);
+			shape.object = col_obj;
+			shape.shape = i;
+			shape.collision_layer = col_obj->get_collision_layer();
+			r_snapshot.shapes.push_back(shape);
+		}
+	}
+
+	if (r_snapshot.shapes.size()) {
+		_build_snapshot_node(r_snapshot, 0, r_snapshot.shapes.size());
+	}
+}
+
+#define QUERY_BATCH_CHUNK 32
+
+void Physics2DDirectSpaceStateSW::_run_batch(QueryBatch *p_batch, void (Physics2DDirectSpaceStateSW::*p_method)(uint32_t, QueryBatch *)) {
+
+	int chunks = (p_batch->count + QUERY_BATCH_CHUNK - 1) / QUERY_BATCH_CHUNK;
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (chunks > 1 && pool) {
+		pool->do_work(chunks, this, p_method, p_batch);
+	} else {
+		for (int i = 0; i < chunks; i++) {
+			(this->*p_method)(i, p_batch);
+		}
+	}
+}
+
+void Physics2DDirectSpaceStateSW::_intersect_ray_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+	int from = p_chunk * QUERY_BATCH_CHUNK;
+	int to = MIN(from + QUERY_BATCH_CHUNK, p_batch->count);
+
+	const Snapshot &snapshot = *p_batch->snapshot;
+	int stack[64];
+
+	for (int q = from; q < to; q++) {
+
+		const RayQuery &query = p_batch->rays[q];
+		RayResult &r_result = p_batch->ray_results[q];
+
+		Vector2 begin = query.from;
+		Vector2 end = query.to;
+		Vector2 normal = (end - begin).normalized();
+
+		// nodes are only tested up to the closest hit found so far
+		Vector2 cull_end = end;
+
+		Vector2 res_point, res_normal;
+		int res_shape = -1;
+		const CollisionObject2DSW *res_obj = NULL;
+		real_t min_d = 1e10;
+
+		int stack_size = 0;
+		if (snapshot.nodes.size()) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size) {
+
+			const SnapshotNode &node = snapshot.nodes[stack[--stack_size]];
+			if (!node.aabb.intersects_segment(begin, cull_end))
+				continue;
+
+			if (node.count == 0) {
+				int first = &node - snapshot.nodes.ptr() + 1;
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = first;
+				continue;
+			}
+
+			for (int i = node.first; i < node.first + node.count; i++) {
+
+				const SnapshotShape &s = snapshot.shapes[i];
+				if (!(s.collision_layer & query.collision_layer))
+					continue;
+
+				const CollisionObject2DSW *col_obj = s.object;
+				Transform2D inv_xform = col_obj->get_shape_inv_transform(s.shape) * col_obj->get_inv_transform();
+
+				Vector2 local_from = inv_xform.xform(begin);
+				Vector2 local_to = inv_xform.xform(end);
+
+				Vector2 shape_point, shape_normal;
+
+				if (col_obj->get_shape(s.shape)->intersect_segment(local_from, local_to, shape_point, shape_normal)) {
+
+					Transform2D xform = col_obj->get_transform() * col_obj->get_shape_transform(s.shape);
+					shape_point = xform.xform(shape_point);
+
+					real_t ld = normal.dot(shape_point);
+
+					if (ld < min_d) {
+
+						min_d = ld;
+						res_point = shape_point;
+						res_normal = inv_xform.basis_xform_inv(shape_normal).normalized();
+						res_shape = s.shape;
+						res_obj = col_obj;
+						cull_end = shape_point;
+					}
+				}
+			}
+		}
+
+		p_batch->hit_objects[q] = res_obj;
+		r_result.collider = NULL;
+		if (res_obj) {
+			r_result.collider_id = res_obj->get_instance_id();
+			r_result.normal = res_normal;
+			r_result.position = res_point;
+			r_result.rid = res_obj->get_self();
+			r_result.shape = res_shape;
+		} else {
+			r_result.collider_id = 0;
+			r_result.normal = Vector2();
+			r_result.position = Vector2();
+			r_result.rid = RID();
+			r_result.shape = -1;
+		}
+	}
+}
+
+void Physics2DDirectSpaceStateSW::_intersect_shape_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+	int from = p_chunk * QUERY_BATCH_CHUNK;
+	int to = MIN(from + QUERY_BATCH_CHUNK, p_batch->count);
+
+	const Snapshot &snapshot = *p_batch->snapshot;
+	int stack[64];
+
+	for (int q = from; q < to; q++) {
+
+		const ShapeQuery &query = p_batch->shapes[q];
+		ShapeResult &r_result = p_batch->shape_results[q];
+
+		Rect2 aabb = query.transform.xform(p_batch->shape->get_aabb()).grow(p_batch->margin);
+		aabb = aabb.merge(Rect2(aabb.position + p_batch->motion, aabb.size));
+
+		const SnapshotShape *res = NULL;
+
+		int stack_size = 0;
+		if (snapshot.nodes.size()) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size && !res) {
+
+			const SnapshotNode &node = snapshot.nodes[stack[--stack_size]];
+			if (!node.aabb.intersects(aabb))
+				continue;
+
+			if (node.count == 0) {
+				int first = &node - snapshot.nodes.ptr() + 1;
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = first;
+				continue;
+			}
+
+			for (int i = node.first; i < node.first + node.count; i++) {
+
+				const SnapshotShape &s = snapshot.shapes[i];
+				if (!(s.collision_layer & query.collision_layer) || !s.aabb.intersects(aabb))
+					continue;
+
+				const CollisionObject2DSW *col_obj = s.object;
+				if (!CollisionSolver2DSW::solve(p_batch->shape, query.transform, p_batch->motion, col_obj->get_shape(s.shape), col_obj->get_transform() * col_obj->get_shape_transform(s.shape), Vector2(), NULL, NULL, NULL, p_batch->margin))
+					continue;
+
+				res = &s;
+				break;
+			}
+		}
+
+		p_batch->hit_objects[q] = res ? res->object : NULL;
+		r_result.collider = NULL;
+		if (res) {
+			r_result.collider_id = res->object->get_instance_id();
+			r_result.rid = res->object->get_self();
+			r_result.shape = res->shape;
+		} else {
+			r_result.collider_id = 0;
+			r_result.rid = RID();
+			r_result.shape = -1;
+		}
+	}
+}
+
+#undef QUERY_BATCH_CHUNK
+
+int Physics2DDirectSpaceStateSW::intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+
+	if (p_query_count <= 0)
+		return 0;
+
+	Snapshot snapshot;
+	_build_snapshot(snapshot, p_exclude);
+
+	LocalVector<const CollisionObject2DSW *> hit_objects;
+	hit_objects.resize(p_query_count);
+
+	QueryBatch batch;
+	batch.snapshot = &snapshot;
+	batch.rays = p_queries;
+	batch.ray_results = r_results;
+	batch.hit_objects = hit_objects.ptr();
+	batch.count = p_query_count;
+	_run_batch(&batch, &Physics2DDirectSpaceStateSW::_intersect_ray_chunk);
+
+	// ObjectDB and the shape metadata are not touched from the workers
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+		if (hit_objects[i]) {
+			if (r_results[i].collider_id != 0)
+				r_results[i].collider = ObjectDB::get_instance(r_results[i].collider_id);
+			r_results[i].metadata = hit_objects[i]->get_shape_metadata(r_results[i].shape);
+			hits++;
+		} else {
+			r_results[i].metadata = Variant();
+		}
+	}
+
+	return hits;
+}
+
+int Physics2DDirectSpaceStateSW::intersect_shapes(const RID &p_shape, const Vector2 &p_motion, real_t p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+
+	if (p_query_count <= 0)
+		return 0;
+
+	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
+	ERR_FAIL_COND_V(!shape, 0);
+
+	Snapshot snapshot;
+	_build_snapshot(snapshot, p_exclude);
+
+	LocalVector<const CollisionObject2DSW *> hit_objects;
+	hit_objects.resize(p_query_count);
+
+	QueryBatch batch;
+	batch.snapshot = &snapshot;
+	batch.shape = shape;
+	batch.motion = p_motion;
+	batch.margin = p_margin;
+	batch.shapes = p_queries;
+	batch.shape_results = r_results;
+	batch.hit_objects = hit_objects.ptr();
+	batch.count = p_query_count;
+	_run_batch(&batch, &Physics2DDirectSpaceStateSW::_intersect_shape_chunk);
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+		if (hit_objects[i]) {
+			if (r_results[i].collider_id != 0)
+				r_results[i].collider = ObjectDB::get_instance(r_results[i].collider_id);
+			r_results[i].metadata = hit_objects[i]->get_shape_metadata(r_results[i].shape);
+			hits++;
+		} else {
+			r_results[i].metadata = Variant();
+		}
+	}
+
+	return hits;
+}
+
 Physics2DDirectSpaceStateSW::Physics2DDirectSpaceStateSW() {
 
 	space = NULL;
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "step_2d_sw.h"
+#include "frame_profiler.h"
 #include "os/os.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
@@ -159,6 +160,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_FORCES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics_2d/integrate_forces", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -214,6 +216,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_GENERATE_ISLANDS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics_2d/generate_islands", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -260,6 +263,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics_2d/setup_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -277,6 +281,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SOLVE_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics_2d/solve_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -304,10 +309,14 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("physics_2d/integrate_velocities", profile_begtime, profile_endtime);
 		//profile_begtime=profile_endtime;
 	}
 
-	p_space->update();
+	{
+		FRAME_PROFILE_SCOPE("physics_2d/broadphase");
+		p_space->update();
+	}
 	p_space->unlock();
 	_step++;
 }
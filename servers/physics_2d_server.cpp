@@ -256,6 +256,77 @@ Dictionary Physics2DDirectSpaceState::_intersect_ray(const Vector2 &p_from, cons
 	return d;
 }
 
+Dictionary Physics2DDirectSpaceState::_intersect_rays(const PoolVector<Vector2> &p_from, const PoolVector<Vector2> &p_to, const PoolVector<int> &p_layers, const Vector<RID> &p_exclude) {
+
+	int count = p_from.size();
+	ERR_FAIL_COND_V(p_to.size() != count, Dictionary());
+	ERR_FAIL_COND_V(p_layers.size() != 0 && p_layers.size() != count, Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++)
+		exclude.insert(p_exclude[i]);
+
+	Vector<RayQuery> queries;
+	queries.resize(count);
+	{
+		PoolVector<Vector2>::Read r_from = p_from.read();
+		PoolVector<Vector2>::Read r_to = p_to.read();
+		PoolVector<int>::Read r_layers = p_layers.read();
+		RayQuery *w = queries.ptrw();
+		for (int i = 0; i < count; i++) {
+			w[i].from = r_from[i];
+			w[i].to = r_to[i];
+			w[i].collision_layer = p_layers.size() ? uint32_t(r_layers[i]) : 0x7FFFFFFF;
+		}
+	}
+
+	Vector<RayResult> results;
+	results.resize(count);
+	intersect_rays(queries.ptr(), count, results.ptrw(), exclude);
+
+	PoolVector<Vector2> positions;
+	PoolVector<Vector2> normals;
+	PoolVector<int> shapes;
+	PoolVector<int> collider_ids;
+	Array colliders;
+	Array rids;
+	Array metadata;
+	positions.resize(count);
+	normals.resize(count);
+	shapes.resize(count);
+	collider_ids.resize(count);
+	colliders.resize(count);
+	rids.resize(count);
+	metadata.resize(count);
+	{
+		PoolVector<Vector2>::Write w_positions = positions.write();
+		PoolVector<Vector2>::Write w_normals = normals.write();
+		PoolVector<int>::Write w_shapes = shapes.write();
+		PoolVector<int>::Write w_collider_ids = collider_ids.write();
+		for (int i = 0; i < count; i++) {
+			const RayResult &r = results[i];
+			w_positions[i] = r.position;
+			w_normals[i] = r.normal;
+			w_shapes[i] = r.shape;
+			w_collider_ids[i] = r.collider_id;
+			colliders[i] = r.collider;
+			rids[i] = r.rid;
+			metadata[i] = r.metadata;
+		}
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["shape"] = shapes;
+	d["collider_id"] = collider_ids;
+	d["collider"] = colliders;
+	d["rid"] = rids;
+	d["metadata"] = metadata;
+
+	return d;
+}
+
 Array Physics2DDirectSpaceState::_intersect_shape(const Ref<Physics2DShapeQueryParameters> &p_shape_query, int p_max_results) {
 
 	Vector<ShapeResult> sr;
@@ -277,6 +348,62 @@ Array Physics2DDirectSpaceState::_intersect_shape(const Ref<Physics2DShapeQueryP
 	return ret;
 }
 
+Dictionary Physics2DDirectSpaceState::_intersect_shapes(const Ref<Physics2DShapeQueryParameters> &p_shape_query, const PoolVector<Vector2> &p_positions, const PoolVector<int> &p_layers) {
+
+	ERR_FAIL_COND_V(p_shape_query.is_null(), Dictionary());
+	int count = p_positions.size();
+	ERR_FAIL_COND_V(p_layers.size() != 0 && p_layers.size() != count, Dictionary());
+
+	Vector<ShapeQuery> queries;
+	queries.resize(count);
+	{
+		PoolVector<Vector2>::Read r_positions = p_positions.read();
+		PoolVector<int>::Read r_layers = p_layers.read();
+		ShapeQuery *w = queries.ptrw();
+		for (int i = 0; i < count; i++) {
+			w[i].transform = p_shape_query->transform;
+			w[i].transform.set_origin(r_positions[i]);
+			w[i].collision_layer = p_layers.size() ? uint32_t(r_layers[i]) : p_shape_query->collision_mask;
+		}
+	}
+
+	Vector<ShapeResult> results;
+	results.resize(count);
+	intersect_shapes(p_shape_query->shape, p_shape_query->motion, p_shape_query->margin, queries.ptr(), count, results.ptrw(), p_shape_query->exclude);
+
+	PoolVector<int> shapes;
+	PoolVector<int> collider_ids;
+	Array colliders;
+	Array rids;
+	Array metadata;
+	shapes.resize(count);
+	collider_ids.resize(count);
+	colliders.resize(count);
+	rids.resize(count);
+	metadata.resize(count);
+	{
+		PoolVector<int>::Write w_shapes = shapes.write();
+		PoolVector<int>::Write w_collider_ids = collider_ids.write();
+		for (int i = 0; i < count; i++) {
+			const ShapeResult &r = results[i];
+			w_shapes[i] = r.shape;
+			w_collider_ids[i] = r.collider_id;
+			colliders[i] = r.collider;
+			rids[i] = r.rid;
+			metadata[i] = r.metadata;
+		}
+	}
+
+	Dictionary d;
+	d["shape"] = shapes;
+	d["collider_id"] = collider_ids;
+	d["collider"] = colliders;
+	d["rid"] = rids;
+	d["metadata"] = metadata;
+
+	return d;
+}
+
 Array Physics2DDirectSpaceState::_cast_motion(const Ref<Physics2DShapeQueryParameters> &p_shape_query) {
 
 	float closest_safe, closest_unsafe;
@@ -352,6 +479,44 @@ Dictionary Physics2DDirectSpaceState::_get_rest_info(const Ref<Physics2DShapeQue
 	return r;
 }
 
+int Physics2DDirectSpaceState::intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude) {
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+
+		RayResult &r = r_results[i];
+		if (intersect_ray(p_queries[i].from, p_queries[i].to, r, p_exclude, p_queries[i].collision_layer)) {
+			hits++;
+		} else {
+			r = RayResult();
+			r.collider_id = 0;
+			r.collider = NULL;
+			r.shape = -1;
+		}
+	}
+
+	return hits;
+}
+
+int Physics2DDirectSpaceState::intersect_shapes(const RID &p_shape, const Vector2 &p_motion, float p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude) {
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+
+		ShapeResult &r = r_results[i];
+		if (intersect_shape(p_shape, p_queries[i].transform, p_motion, p_margin, &r, 1, p_exclude, p_queries[i].collision_layer)) {
+			hits++;
+		} else {
+			r = ShapeResult();
+			r.collider_id = 0;
+			r.collider = NULL;
+			r.shape = -1;
+		}
+	}
+
+	return hits;
+}
+
 Physics2DDirectSpaceState::Physics2DDirectSpaceState() {
 }
 
@@ -359,7 +524,9 @@ void Physics2DDirectSpaceState::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("intersect_point", "point", "max_results", "exclude", "collision_layer"), &Physics2DDirectSpaceState::_intersect_point, DEFVAL(32), DEFVAL(Array()), DEFVAL(0x7FFFFFFF));
 	ClassDB::bind_method(D_METHOD("intersect_ray", "from", "to", "exclude", "collision_layer"), &Physics2DDirectSpaceState::_intersect_ray, DEFVAL(Array()), DEFVAL(0x7FFFFFFF));
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "collision_layers", "exclude"), &Physics2DDirectSpaceState::_intersect_rays, DEFVAL(PoolIntArray()), DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("intersect_shape", "shape", "max_results"), &Physics2DDirectSpaceState::_intersect_shape, DEFVAL(32));
+	ClassDB::bind_method(D_METHOD("intersect_shapes", "shape", "positions", "collision_layers"), &Physics2DDirectSpaceState::_intersect_shapes, DEFVAL(PoolIntArray()));
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape"), &Physics2DDirectSpaceState::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &Physics2DDirectSpaceState::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &Physics2DDirectSpaceState::_get_rest_info);
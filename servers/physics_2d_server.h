@@ -131,9 +131,11 @@ class Physics2DDirectSpaceState : public Object {
 	GDCLASS(Physics2DDirectSpaceState, Object);
 
 	Dictionary _intersect_ray(const Vector2 &p_from, const Vector2 &p_to, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_layers = 0);
+	Dictionary _intersect_rays(const PoolVector<Vector2> &p_from, const PoolVector<Vector2> &p_to, const PoolVector<int> &p_layers, const Vector<RID> &p_exclude = Vector<RID>());
 
 	Array _intersect_point(const Vector2 &p_point, int p_max_results = 32, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_layers = 0);
 	Array _intersect_shape(const Ref<Physics2DShapeQueryParameters> &p_shape_query, int p_max_results = 32);
+	Dictionary _intersect_shapes(const Ref<Physics2DShapeQueryParameters> &p_shape_query, const PoolVector<Vector2> &p_positions, const PoolVector<int> &p_layers);
 	Array _cast_motion(const Ref<Physics2DShapeQueryParameters> &p_shape_query);
 	Array _collide_shape(const Ref<Physics2DShapeQueryParameters> &p_shape_query, int p_max_results = 32);
 	Dictionary _get_rest_info(const Ref<Physics2DShapeQueryParameters> &p_shape_query);
@@ -155,6 +157,16 @@ public:
 
 	virtual bool intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
+	struct RayQuery {
+
+		Vector2 from;
+		Vector2 to;
+		uint32_t collision_layer;
+	};
+
+	// one result per query, misses have shape -1 and no rid; returns the amount of hits
+	virtual int intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude = Set<RID>());
+
 	struct ShapeResult {
 
 		RID rid;
@@ -168,6 +180,15 @@ public:
 
 	virtual int intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
+	struct ShapeQuery {
+
+		Transform2D transform;
+		uint32_t collision_layer;
+	};
+
+	// places p_shape at each query transform and reports the first object it overlaps, same conventions as intersect_rays()
+	virtual int intersect_shapes(const RID &p_shape, const Vector2 &p_motion, float p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude = Set<RID>());
+
 	virtual bool cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
 	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, float p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
@@ -283,6 +283,73 @@ Dictionary PhysicsDirectSpaceState::_intersect_ray(const Vector3 &p_from, const
 	return d;
 }
 
+Dictionary PhysicsDirectSpaceState::_intersect_rays(const PoolVector<Vector3> &p_from, const PoolVector<Vector3> &p_to, const PoolVector<int> &p_collision_masks, const Vector<RID> &p_exclude) {
+
+	int count = p_from.size();
+	ERR_FAIL_COND_V(p_to.size() != count, Dictionary());
+	ERR_FAIL_COND_V(p_collision_masks.size() != 0 && p_collision_masks.size() != count, Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++)
+		exclude.insert(p_exclude[i]);
+
+	Vector<RayQuery> queries;
+	queries.resize(count);
+	{
+		PoolVector<Vector3>::Read r_from = p_from.read();
+		PoolVector<Vector3>::Read r_to = p_to.read();
+		PoolVector<int>::Read r_masks = p_collision_masks.read();
+		RayQuery *w = queries.ptrw();
+		for (int i = 0; i < count; i++) {
+			w[i].from = r_from[i];
+			w[i].to = r_to[i];
+			w[i].collision_mask = p_collision_masks.size() ? uint32_t(r_masks[i]) : 0x7FFFFFFF;
+		}
+	}
+
+	Vector<RayResult> results;
+	results.resize(count);
+	intersect_rays(queries.ptr(), count, results.ptrw(), exclude);
+
+	PoolVector<Vector3> positions;
+	PoolVector<Vector3> normals;
+	PoolVector<int> shapes;
+	PoolVector<int> collider_ids;
+	Array colliders;
+	Array rids;
+	positions.resize(count);
+	normals.resize(count);
+	shapes.resize(count);
+	collider_ids.resize(count);
+	colliders.resize(count);
+	rids.resize(count);
+	{
+		PoolVector<Vector3>::Write w_positions = positions.write();
+		PoolVector<Vector3>::Write w_normals = normals.write();
+		PoolVector<int>::Write w_shapes = shapes.write();
+		PoolVector<int>::Write w_collider_ids = collider_ids.write();
+		for (int i = 0; i < count; i++) {
+			const RayResult &r = results[i];
+			w_positions[i] = r.position;
+			w_normals[i] = r.normal;
+			w_shapes[i] = r.shape;
+			w_collider_ids[i] = r.collider_id;
+			colliders[i] = r.collider;
+			rids[i] = r.rid;
+		}
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["shape"] = shapes;
+	d["collider_id"] = collider_ids;
+	d["collider"] = colliders;
+	d["rid"] = rids;
+
+	return d;
+}
+
 Array PhysicsDirectSpaceState::_intersect_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results) {
 
 	Vector<ShapeResult> sr;
@@ -303,6 +370,57 @@ Array PhysicsDirectSpaceState::_intersect_shape(const Ref<PhysicsShapeQueryParam
 	return ret;
 }
 
+Dictionary PhysicsDirectSpaceState::_intersect_shapes(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const PoolVector<Vector3> &p_positions, const PoolVector<int> &p_collision_masks) {
+
+	ERR_FAIL_COND_V(p_shape_query.is_null(), Dictionary());
+	int count = p_positions.size();
+	ERR_FAIL_COND_V(p_collision_masks.size() != 0 && p_collision_masks.size() != count, Dictionary());
+
+	Vector<ShapeQuery> queries;
+	queries.resize(count);
+	{
+		PoolVector<Vector3>::Read r_positions = p_positions.read();
+		PoolVector<int>::Read r_masks = p_collision_masks.read();
+		ShapeQuery *w = queries.ptrw();
+		for (int i = 0; i < count; i++) {
+			w[i].transform = Transform(p_shape_query->transform.basis, r_positions[i]);
+			w[i].collision_mask = p_collision_masks.size() ? uint32_t(r_masks[i]) : p_shape_query->collision_mask;
+		}
+	}
+
+	Vector<ShapeResult> results;
+	results.resize(count);
+	intersect_shapes(p_shape_query->shape, p_shape_query->margin, queries.ptr(), count, results.ptrw(), p_shape_query->exclude);
+
+	PoolVector<int> shapes;
+	PoolVector<int> collider_ids;
+	Array colliders;
+	Array rids;
+	shapes.resize(count);
+	collider_ids.resize(count);
+	colliders.resize(count);
+	rids.resize(count);
+	{
+		PoolVector<int>::Write w_shapes = shapes.write();
+		PoolVector<int>::Write w_collider_ids = collider_ids.write();
+		for (int i = 0; i < count; i++) {
+			const ShapeResult &r = results[i];
+			w_shapes[i] = r.shape;
+			w_collider_ids[i] = r.collider_id;
+			colliders[i] = r.collider;
+			rids[i] = r.rid;
+		}
+	}
+
+	Dictionary d;
+	d["shape"] = shapes;
+	d["collider_id"] = collider_ids;
+	d["collider"] = colliders;
+	d["rid"] = rids;
+
+	return d;
+}
+
 Array PhysicsDirectSpaceState::_cast_motion(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const Vector3 &p_motion) {
 
 	float closest_safe, closest_unsafe;
@@ -348,6 +466,44 @@ Dictionary PhysicsDirectSpaceState::_get_rest_info(const Ref<PhysicsShapeQueryPa
 	return r;
 }
 
+int PhysicsDirectSpaceState::intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude) {
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+
+		RayResult &r = r_results[i];
+		if (intersect_ray(p_queries[i].from, p_queries[i].to, r, p_exclude, p_queries[i].collision_mask)) {
+			hits++;
+		} else {
+			r = RayResult();
+			r.collider_id = 0;
+			r.collider = NULL;
+			r.shape = -1;
+		}
+	}
+
+	return hits;
+}
+
+int PhysicsDirectSpaceState::intersect_shapes(const RID &p_shape, float p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude) {
+
+	int hits = 0;
+	for (int i = 0; i < p_query_count; i++) {
+
+		ShapeResult &r = r_results[i];
+		if (intersect_shape(p_shape, p_queries[i].transform, p_margin, &r, 1, p_exclude, p_queries[i].collision_mask)) {
+			hits++;
+		} else {
+			r = ShapeResult();
+			r.collider_id = 0;
+			r.collider = NULL;
+			r.shape = -1;
+		}
+	}
+
+	return hits;
+}
+
 PhysicsDirectSpaceState::PhysicsDirectSpaceState() {
 }
 
@@ -357,7 +513,9 @@ void PhysicsDirectSpaceState::_bind_methods() {
 	//ClassDB::bind_method(D_METHOD("intersect_shape","shape","xform","result_max","exclude","umask"),&PhysicsDirectSpaceState::_intersect_shape,DEFVAL(Array()),DEFVAL(0));
 
 	ClassDB::bind_method(D_METHOD("intersect_ray", "from", "to", "exclude", "collision_layer"), &PhysicsDirectSpaceState::_intersect_ray, DEFVAL(Array()), DEFVAL(0x7FFFFFFF));
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "collision_masks", "exclude"), &PhysicsDirectSpaceState::_intersect_rays, DEFVAL(PoolIntArray()), DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("intersect_shape", "shape", "max_results"), &PhysicsDirectSpaceState::_intersect_shape, DEFVAL(32));
+	ClassDB::bind_method(D_METHOD("intersect_shapes", "shape", "positions", "collision_masks"), &PhysicsDirectSpaceState::_intersect_shapes, DEFVAL(PoolIntArray()));
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape", "motion"), &PhysicsDirectSpaceState::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &PhysicsDirectSpaceState::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &PhysicsDirectSpaceState::_get_rest_info);
@@ -135,7 +135,9 @@ class PhysicsDirectSpaceState : public Object {
 
 private:
 	Dictionary _intersect_ray(const Vector3 &p_from, const Vector3 &p_to, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_collision_mask = 0);
+	Dictionary _intersect_rays(const PoolVector<Vector3> &p_from, const PoolVector<Vector3> &p_to, const PoolVector<int> &p_collision_masks, const Vector<RID> &p_exclude = Vector<RID>());
 	Array _intersect_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results = 32);
+	Dictionary _intersect_shapes(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const PoolVector<Vector3> &p_positions, const PoolVector<int> &p_collision_masks);
 	Array _cast_motion(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const Vector3 &p_motion);
 	Array _collide_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results = 32);
 	Dictionary _get_rest_info(const Ref<PhysicsShapeQueryParameters> &p_shape_query);
@@ -166,8 +168,27 @@ public:
 
 	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false) = 0;
 
+	struct RayQuery {
+
+		Vector3 from;
+		Vector3 to;
+		uint32_t collision_mask;
+	};
+
+	// one result per query, misses have shape -1 and no rid; returns the amount of hits
+	virtual int intersect_rays(const RayQuery *p_queries, int p_query_count, RayResult *r_results, const Set<RID> &p_exclude = Set<RID>());
+
 	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
 
+	struct ShapeQuery {
+
+		Transform transform;
+		uint32_t collision_mask;
+	};
+
+	// places p_shape at each query transform and reports the first object it overlaps, same conventions as intersect_rays()
+	virtual int intersect_shapes(const RID &p_shape, float p_margin, const ShapeQuery *p_queries, int p_query_count, ShapeResult *r_results, const Set<RID> &p_exclude = Set<RID>());
+
 	struct ShapeRestInfo {
 
 		Vector3 point;
@@ -229,7 +250,7 @@ public:
 		SHAPE_BOX, ///< vec3:"extents"
 		SHAPE_CAPSULE, ///< dict( float:"radius", float:"height"):capsule
 		SHAPE_CONVEX_POLYGON, ///< array of planes:"planes"
-		SHAPE_CONCAVE_POLYGON, ///< vector3 array:"triangles" , or Dictionary with "indices" (int array) and "triangles" (Vector3 array)
+		SHAPE_CONCAVE_POLYGON, ///< vector3 array:"triangles" , or Dictionary with "faces" (Vector3 array) and optionally "bvh" (byte array, a serialized TriangleBVH of the faces)
 		SHAPE_HEIGHTMAP, ///< dict( int:"width", int:"depth",float:"cell_size", float_array:"heights"
 		SHAPE_CUSTOM, ///< Server-Implementation based custom shape, calling shape_create() with this value will result in an error
 	};
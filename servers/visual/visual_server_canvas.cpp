@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "visual_server_canvas.h"
+#include "frame_profiler.h"
 #include "visual_server_global.h"
 #include "visual_server_viewport.h"
 
@@ -174,6 +175,8 @@ void VisualServerCanvas::_light_mask_canvas_items(int p_z, RasterizerCanvas::Ite
 
 void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_transform, RasterizerCanvas::Light *p_lights, RasterizerCanvas::Light *p_masked_lights, const Rect2 &p_clip_rect) {
 
+	FRAME_PROFILE_SCOPE("visual/canvas");
+
 	VSG::canvas_render->canvas_begin();
 
 	if (p_canvas->children_order_dirty) {
@@ -31,6 +31,7 @@
 #include "visual_server_raster.h"
 
 #include "default_mouse_cursor.xpm"
+#include "frame_profiler.h"
 #include "io/marshalls.h"
 #include "os/os.h"
 #include "project_settings.h"
@@ -95,6 +96,8 @@ void VisualServerRaster::request_frame_drawn_callback(Object *p_where, const Str
 
 void VisualServerRaster::draw(bool p_swap_buffers) {
 
+	FRAME_PROFILE_SCOPE("visual/draw");
+
 	changes = 0;
 
 	VSG::rasterizer->begin_frame();
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "visual_server_scene.h"
+#include "frame_profiler.h"
 #include "os/os.h"
 #include "visual_server_global.h"
 #include "visual_server_raster.h"
@@ -1250,6 +1251,8 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 
 void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
 
+	FRAME_PROFILE_SCOPE("visual/shadows");
+
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
 	switch (VSG::storage->light_get_type(p_instance->base)) {
@@ -1693,6 +1696,8 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 
 void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
 
+	FRAME_PROFILE_SCOPE("visual/render_scene");
+
 	Scenario *scenario = scenario_owner.getornull(p_scenario);
 
 	render_pass++;
@@ -1708,7 +1713,11 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	int cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	int cull_count;
+	{
+		FRAME_PROFILE_SCOPE("visual/cull");
+		cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	}
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -2015,6 +2024,7 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 
 	/* STEP 6 - PROCESS GEOMETRY AND DRAW SCENE*/
 
+	FRAME_PROFILE_SCOPE("visual/draw_scene");
 	VSG::scene_render->render_scene(p_cam_transform, p_cam_projection, p_cam_orthogonal, (RasterizerScene::InstanceBase **)instance_cull_result, cull_count, light_instance_cull_result, light_cull_count + directional_light_count, reflection_probe_instance_cull_result, reflection_probe_cull_count, environment, p_shadow_atlas, scenario->reflection_atlas, p_reflection_probe, p_reflection_probe_pass);
 }
 
@@ -3261,6 +3271,8 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 
 void VisualServerScene::update_dirty_instances() {
 
+	FRAME_PROFILE_SCOPE("visual/update_instances");
+
 	VSG::storage->update_dirty_resources();
 
 	while (_instance_update_list.first()) {